@@ -178,6 +178,10 @@ namespace fgo::data {
     gtsam::Pose3 poseToECEF;
     gtsam::Pose3 poseRelativeECEF;
     gtsam::Vector6 noise;
+    // Hessian of the registration of poseToECEF in its IMU frame [rot, trans] for a unit residual variance, zero if
+    // not available
+    gtsam::Matrix6 registrationHessian = gtsam::Matrix6::Zero();
+    size_t numDegenerateDirections = 0;
     QueryStateOutput queryOutputPrevious;
     QueryStateOutput queryOutputCurrent;
   };
@@ -71,8 +71,16 @@ namespace fgo::data {
   };
 
   /** GNSS **/
+  // carrier of a GNSS signal, the signals of one satellite are kept apart by it in the cycle slip detection
+  enum class GNSSFrequency : uint32_t {
+    L1 = 0,  // GPS L1, Galileo E1
+    L2 = 1,  // GPS L2
+    L5 = 2,  // GPS L5, Galileo E5a
+  };
+
   struct GNSSObs {
     uint32_t satId{};
+    GNSSFrequency frequency = GNSSFrequency::L1;  // carrier of the signal
     gtsam::Vector3 satPos{};
     gtsam::Vector3 satVel{};
     //gtsam::Vector3 refSatPos{};
@@ -206,17 +214,6 @@ namespace fgo::data {
     //bool hasDDRTCM = false;
   };
 
-  struct CycleSlipStruct {
-    uint32_t satID{};
-    int N{}; //count of not sliped
-    double md{}; //mean
-    double md2{}; //squared mean
-    double sd2{}; //sigma
-    bool connection{}; //can sat be found in newest gnss meas
-    //double timeLastSlip = -1;
-    //bool cycleSlip{}; //sliped since last meas
-  };
-
   struct CSDataStruct {
     uint32_t satID{};
     gtsam::Vector3 satPos{};
@@ -233,6 +230,13 @@ namespace fgo::data {
     rclcpp::Time lastPPSTime;
   };
 
+  /** Ranging **/
+  struct UWBRange {
+    rclcpp::Time timestamp{0, 0, RCL_ROS_TIME};
+    uint16_t anchorID{};
+    double range{};  // [m] between the tag and the anchor
+  };
+
 }
 
 
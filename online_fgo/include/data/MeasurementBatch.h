@@ -0,0 +1,95 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_MEASUREMENTBATCH_H
+#define ONLINE_FGO_MEASUREMENTBATCH_H
+
+#pragma once
+
+#include <map>
+#include <span>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace fgo::data {
+
+  /***
+   * names of the channels filled by the offline datasets
+   */
+  namespace channel {
+    inline const std::string IMU = "imu";
+    inline const std::string ReferencePVA = "reference_pva";
+    inline const std::string ReferenceState = "reference_state";
+    inline const std::string GNSS = "gnss";
+    inline const std::string GNSSState = "gnss_state";
+    inline const std::string GNSSObservation = "gnss_obs";
+    inline const std::string Baseline = "baseline";
+    inline const std::string LiDAR = "lidar";
+    inline const std::string LiDARIMU = "lidar_imu";
+    inline const std::string LiDARPose = "lidar_pose";
+    inline const std::string Image = "image";
+    inline const std::string CameraPose = "camera_pose";
+    inline const std::string StereoPair = "stereo_pair";
+    inline const std::string Infrared = "infrared";
+    inline const std::string Radar = "radar";
+    inline const std::string UWB = "uwb";
+  }
+
+  /***
+   * Measurements of one offline replay epoch in named, typed channels. The batch only holds views into the
+   * containers of the dataset batch, which must outlive it. A channel is only returned for the type it was added
+   * with, so that integrators get their measurements without any cast on the integrator or the data.
+   */
+  class MeasurementBatch {
+  public:
+    template<typename DataType>
+    void add(const std::string &name, const std::vector<DataType> &data) {
+      channels_.insert_or_assign(name, Channel{std::type_index(typeid(DataType)), data.data(), data.size()});
+    }
+
+    /***
+     * @param name
+     * @return the measurements of the channel, empty if the channel doesn't exist or holds another type
+     */
+    template<typename DataType>
+    [[nodiscard]] std::span<const DataType> get(const std::string &name) const {
+      const auto iter = channels_.find(name);
+      if (iter == channels_.end() || iter->second.type != std::type_index(typeid(DataType)))
+        return {};
+      return {static_cast<const DataType *>(iter->second.data), iter->second.size};
+    }
+
+    template<typename DataType>
+    [[nodiscard]] bool has(const std::string &name) const {
+      const auto iter = channels_.find(name);
+      return iter != channels_.end() && iter->second.type == std::type_index(typeid(DataType));
+    }
+
+  private:
+    struct Channel {
+      std::type_index type;
+      const void *data;
+      size_t size;
+    };
+
+    std::map<std::string, Channel> channels_;
+  };
+}
+
+#endif //ONLINE_FGO_MEASUREMENTBATCH_H
@@ -24,7 +24,7 @@
 #define ONLINE_FGO_UNCENTEDSAMPLER_H
 
 #include <memory>
-#include <NumCpp.hpp>
+#include <Eigen/Cholesky>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/base/Value.h>
 #include <gtsam/nonlinear/Values.h>
@@ -32,25 +32,64 @@
 
 namespace fgo::data::sampler {
 
+  /***
+   * Generator of sigma points for a fixed state dimension. The weights and the scheme specific unit sigma points are
+   * computed once in the constructor, the Cholesky factor of the last covariance is kept and reused as long as the
+   * same covariance is passed again, e.g. for all factors connected to the same states.
+   * Sigma points are stored row-wise, for the Merwe and Julier schemes the first row is the mean.
+   */
   class SigmaPoints {
   public:
     typedef std::shared_ptr<SigmaPoints> SharedPtr;
 
-    size_t num_sigmas() const { return n_sigma_points_; }
+    virtual ~SigmaPoints() = default;
 
-    virtual gtsam::Matrix sigma_points(const gtsam::Vector &mean,
-                                       const gtsam::Matrix &cov,
-                                       bool isTrangularized = false) = 0;
+    [[nodiscard]] size_t num_sigmas() const { return n_sigma_points_; }
+
+    [[nodiscard]] size_t dim() const { return n_state_; }
+
+    [[nodiscard]] const gtsam::Vector &Wm() const { return Wm_; }
+
+    [[nodiscard]] const gtsam::Vector &Wc() const { return Wc_; }
+
+    /***
+     * write the sigma points into a preallocated matrix
+     * @param mean
+     * @param cov covariance, or its lower Cholesky factor if isTrangularized
+     * @param sigmas output of size num_sigmas() x dim(), resized only if the size doesn't match
+     * @param isTrangularized
+     */
+    virtual void sigma_points(const gtsam::Vector &mean,
+                              const gtsam::Matrix &cov,
+                              gtsam::Matrix &sigmas,
+                              bool isTrangularized = false) = 0;
+
+    gtsam::Matrix sigma_points(const gtsam::Vector &mean,
+                               const gtsam::Matrix &cov,
+                               bool isTrangularized = false) {
+      gtsam::Matrix sigmas(n_sigma_points_, n_state_);
+      this->sigma_points(mean, cov, sigmas, isTrangularized);
+      return sigmas;
+    }
 
   protected:
-    size_t n_state_;
-    size_t n_sigma_points_;
-    double lambda_;
-    gtsam::Vector weights_;
-    double kappa_;
+    /***
+     * lower Cholesky factor of cov, recomputed only if cov differs from the covariance of the last call
+     */
+    const gtsam::Matrix &sqrtCovariance(const gtsam::Matrix &cov, bool isTrangularized);
+
+    size_t n_state_ = 0;
+    size_t n_sigma_points_ = 0;
+    double lambda_ = 0.;
+    double kappa_ = 0.;
     gtsam::Vector Wc_;
     gtsam::Vector Wm_;
 
+  private:
+    Eigen::LLT<gtsam::Matrix> llt_;
+    gtsam::Matrix lastCov_;
+    gtsam::Matrix sqrtCov_;
+    bool hasSqrtCov_ = false;
   };
 
   class MerweScaledSigmaPoints final : public SigmaPoints {
@@ -59,9 +98,12 @@ namespace fgo::data::sampler {
 
     explicit MerweScaledSigmaPoints(size_t n, double alpha = 1e-3, double beta = 2., double kappa = 0.);
 
-    gtsam::Matrix sigma_points(const gtsam::Vector &mean,
-                               const gtsam::Matrix &cov,
-                               bool isTrangularized = false) override;
+    using SigmaPoints::sigma_points;
+
+    void sigma_points(const gtsam::Vector &mean,
+                      const gtsam::Matrix &cov,
+                      gtsam::Matrix &sigmas,
+                      bool isTrangularized = false) override;
 
   private:
     double alpha_;
@@ -75,11 +117,14 @@ namespace fgo::data::sampler {
 
     explicit JulierSigmaPoints(size_t n, double kappa);
 
-    gtsam::Matrix sigma_points(const gtsam::Vector &mean,
-                               const gtsam::Matrix &cov,
-                               bool isTrangularized = false) override;
+    using SigmaPoints::sigma_points;
 
-    ~JulierSigmaPoints() = default;
+    void sigma_points(const gtsam::Vector &mean,
+                      const gtsam::Matrix &cov,
+                      gtsam::Matrix &sigmas,
+                      bool isTrangularized = false) override;
+
+    ~JulierSigmaPoints() override = default;
   };
 
   class SimplexSigmaPoints final : public SigmaPoints {
@@ -88,14 +133,18 @@ namespace fgo::data::sampler {
 
     explicit SimplexSigmaPoints(size_t n, double alpha = 1.);
 
-    gtsam::Matrix sigma_points(const gtsam::Vector &mean,
-                               const gtsam::Matrix &cov,
-                               bool isTrangularized = false) override;
+    using SigmaPoints::sigma_points;
+
+    void sigma_points(const gtsam::Vector &mean,
+                      const gtsam::Matrix &cov,
+                      gtsam::Matrix &sigmas,
+                      bool isTrangularized = false) override;
 
-    ~SimplexSigmaPoints() = default;
+    ~SimplexSigmaPoints() override = default;
 
   private:
     double alpha_;
+    gtsam::Matrix unitSigmas_;  // (n + 1) x n, precomputed scaled unit simplex
 
   };
 
@@ -108,6 +157,14 @@ namespace fgo::data::sampler {
     double kappa = 0.;
   };
 
+  /***
+   * create the sigma point generator of the configured scheme for the state dimension n
+   * @param param
+   * @param n
+   * @return generator
+   */
+  SigmaPoints::SharedPtr createSigmaPoints(const SamplerConfig &param, size_t n);
+
   class UnscentedSampler final : public gtsam::Sampler {
   public:
     typedef std::shared_ptr<UnscentedSampler> SharedPtr;
@@ -129,6 +186,8 @@ namespace fgo::data::sampler {
 
     gtsam::Matrix samples() const;
 
+    void samples(gtsam::Matrix &sigmas) const;
+
     ~UnscentedSampler() = default;
 
   private:
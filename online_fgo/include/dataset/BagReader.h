@@ -183,16 +183,23 @@ namespace fgo::dataset {
       filter_.topics = topics;
       reader.set_filter(filter_);
 
+      // messages with the same receive time are kept in one chunk, the next chunk starts after them
+      int64_t budget_used_at = -1;
+      bool message_left = false;
       while (reader.has_next()) {
         const auto bag_message = reader.read_next();
         if (bag_message->time_stamp < start_time_nanosec)
           continue;
+        if (budget_used_at >= 0 && bag_message->time_stamp != budget_used_at) {
+          message_left = true;
+          break;
+        }
         memory_usage += bag_message->serialized_data->buffer_length * 1e-9;
         data_map[bag_message->topic_name].emplace_back(std::make_pair(bag_message->time_stamp, bag_message->serialized_data));
-        if (memory_usage > max_size)
-          break;
+        if (budget_used_at < 0 && memory_usage > max_size)
+          budget_used_at = bag_message->time_stamp;
       }
-      has_next = reader.has_next();
+      has_next = message_left || reader.has_next();
 
       reader.close();
       return data_map;
@@ -218,19 +225,26 @@ namespace fgo::dataset {
       filter_.topics.emplace_back(topic);
       reader->set_filter(filter_);
 
+      // messages with the same receive time are kept in one chunk, the next chunk starts after them
+      int64_t budget_used_at = -1;
+      bool message_left = false;
       while (reader->has_next()) {
         auto bag_message = reader->read_next();
         if (bag_message->time_stamp < start_time_nanosec)
           continue;
+        if (budget_used_at >= 0 && bag_message->time_stamp != budget_used_at) {
+          message_left = true;
+          break;
+        }
 
         memory_usage += bag_message->serialized_data->buffer_length * 1e-9;
         raw_data.emplace_back(std::make_pair(bag_message->time_stamp, bag_message->serialized_data));
-        if (memory_usage > max_size) {
+        if (budget_used_at < 0 && memory_usage > max_size) {
           RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), topic << " read raw buffer with the size of " << memory_usage << " GB. ");
-          break;
+          budget_used_at = bag_message->time_stamp;
         }
       }
-      has_next = reader->has_next();
+      has_next = message_left || reader->has_next();
       reader->close();
       return raw_data;
     }
@@ -126,12 +126,20 @@ namespace fgo::data {
     return pose;
   }
 
+  /***
+   * state carried from one IMU message to the next to calculate dt and the angular acceleration, every IMU stream
+   * needs its own
+   */
+  struct IMUMessageTrackingState {
+    bool firstMsg = true;
+    rclcpp::Time lastTimestamp{0, 0, RCL_ROS_TIME};
+    gtsam::Vector3 lastGyro = gtsam::Vector3::Zero();
+  };
+
   inline IMUMeasurement msg2IMUMeasurement(const sensor_msgs::msg::Imu &imuMsg,
                                            const rclcpp::Time &timestamp,
+                                           IMUMessageTrackingState &trackingState,
                                            const gtsam::Matrix33 &trans = gtsam::Matrix33::Identity()) {
-    static bool first_msg = true;
-    static auto last_timestamp = timestamp;
-    static auto last_gyro = gtsam::Vector3();
     IMUMeasurement imuMeasurement;
     imuMeasurement.timestamp = timestamp;
     imuMeasurement.accLin.x() = imuMsg.linear_acceleration.x;
@@ -152,16 +160,16 @@ namespace fgo::data {
     imuMeasurement.gyroCov = gtsam::Matrix33(imuMsg.angular_velocity_covariance.data());
     imuMeasurement.AHRSOriCov = gtsam::Matrix33(imuMsg.orientation_covariance.data());
     //dt and accrot
-    if (!first_msg) {
-      imuMeasurement.dt = imuMeasurement.timestamp.seconds() - last_timestamp.seconds();
-      imuMeasurement.accRot = (imuMeasurement.gyro - last_gyro) / imuMeasurement.dt;
+    if (!trackingState.firstMsg) {
+      imuMeasurement.dt = imuMeasurement.timestamp.seconds() - trackingState.lastTimestamp.seconds();
+      imuMeasurement.accRot = (imuMeasurement.gyro - trackingState.lastGyro) / imuMeasurement.dt;
     } else {
-      first_msg = false;
+      trackingState.firstMsg = false;
       imuMeasurement.dt = 0.005;
       imuMeasurement.accRot = gtsam::Vector3();
     }
-    last_timestamp = timestamp;
-    last_gyro = imuMeasurement.gyro;
+    trackingState.lastTimestamp = timestamp;
+    trackingState.lastGyro = imuMeasurement.gyro;
     return imuMeasurement;
   }
 
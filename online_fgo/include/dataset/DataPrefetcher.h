@@ -0,0 +1,95 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_DATAPREFETCHER_H
+#define ONLINE_FGO_DATAPREFETCHER_H
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace fgo::dataset {
+
+  /***
+   * Worker thread which loads the chunks of lazily loaded data blocks (bag reading, deserialization and decoding)
+   * in the background, so that the replay doesn't wait for I/O while an epoch is being optimized. The tasks are
+   * executed one after another in the order they were submitted.
+   */
+  class DataPrefetcher {
+  public:
+    DataPrefetcher() : worker_([this] { run(); }) {}
+
+    ~DataPrefetcher() {
+      {
+        std::lock_guard<std::mutex> lg(mutex_);
+        stop_ = true;
+        tasks_.clear();
+      }
+      cv_.notify_all();
+      worker_.join();
+    }
+
+    DataPrefetcher(const DataPrefetcher &) = delete;
+    DataPrefetcher &operator=(const DataPrefetcher &) = delete;
+
+    /***
+     * @param task
+     * @return future of the result, exceptions thrown by the task are rethrown by future::get()
+     */
+    template<typename Result>
+    std::future<Result> submit(std::function<Result()> task) {
+      auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+      auto future = packaged_task->get_future();
+      {
+        std::lock_guard<std::mutex> lg(mutex_);
+        tasks_.emplace_back([packaged_task] { (*packaged_task)(); });
+      }
+      cv_.notify_one();
+      return future;
+    }
+
+  private:
+    void run() {
+      while (true) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lk(mutex_);
+          cv_.wait(lk, [this] { return stop_ || !tasks_.empty(); });
+          if (stop_)
+            return;
+          task = std::move(tasks_.front());
+          tasks_.pop_front();
+        }
+        task();
+      }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+    std::thread worker_;  // started last, after the members it uses are constructed
+  };
+}
+
+#endif //ONLINE_FGO_DATAPREFETCHER_H
@@ -24,10 +24,12 @@
 #define ONLINE_FGO_DATASET_H
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <memory>
 #include <iterator>
+#include <span>
 #include <rclcpp/time.hpp>
 #include <irt_nav_msgs/msg/pva_geodetic.hpp>
 #include <irt_nav_msgs/msg/gnss_obs_pre_processed.hpp>
@@ -47,8 +49,11 @@
 #include "DatasetParam.h"
 #include "BagReader.h"
 #include "BagUtils.h"
+#include "DatasetCache.h"
+#include "DataPrefetcher.h"
 #include "utils/GNSSUtils.h"
 #include "utils/ROSUtils.h"
+#include "data/MeasurementBatch.h"
 
 
 //ToDo to be deleted
@@ -57,9 +62,34 @@
 namespace fgo::dataset {
   using namespace fgo::data;
 
+  /***
+   * chunk of a lazily loaded topic. The samples are keyed with their header stamps, while the loader reads the source
+   * in its own order, e.g. by the receive time of the bag. resume_nanosec is the position after the last message read
+   * for this chunk in that order and is handed back to the loader for the next chunk.
+   * @tparam DataType
+   */
+  template<typename DataType>
+  struct DataChunk {
+    bool has_next = false;
+    std::map<rclcpp::Time, DataType> data;
+    int64_t resume_nanosec = 0;
+  };
+
+  /***
+   * Time-sorted, contiguous storage of the samples of one topic. Consumed samples are dropped by moving the head index,
+   * the storage is compacted once the consumed part dominates, so that trimming and erasing are amortized O(1).
+   * Window queries are binary searches and return views into the storage, the views stay valid until the next call
+   * that modifies the block (setData, appendData, trimData, getDataBefore/getDataBetween, getNextData).
+   * Lazily loaded blocks can load their next chunk in the background with a DataPrefetcher, a chunk is requested as
+   * soon as the loaded samples don't cover the lookahead after the last query anymore.
+   * @tparam DataType
+   */
   template<typename DataType>
   struct DataBlock {
-    typedef std::map<rclcpp::Time, DataType> DataMap;
+    typedef std::map<rclcpp::Time, DataType> DataMap;  // used to hand over parsed or lazily loaded data
+    typedef std::span<const DataType> DataSpan;
+    static constexpr size_t MinCompactionSize = 256;
+
     bool excluded = false;
     std::string data_name;
     std::string data_topic;
@@ -67,8 +97,15 @@ namespace fgo::dataset {
     rclcpp::Time timestamp_end;
     bool fully_loaded = false;
     double max_loading_size = 0.;
-    DataMap data;
-    typename DataMap::iterator data_iter;
+    std::vector<rclcpp::Time> timestamps;  // timestamps[i] belongs to samples[i], sorted ascending
+    std::vector<DataType> samples;
+    size_t head = 0;  // first sample that hasn't been consumed
+    size_t data_iter = 0;  // next sample returned by getNextData
+    std::shared_ptr<DataPrefetcher> prefetcher;
+    double prefetch_lookahead = 0.;  // [s]
+    std::future<DataChunk<DataType>> prefetched_chunk;
+    int64_t prefetched_chunk_start = 0;
+    int64_t load_resume = -1;  // resume position of the last loaded chunk, -1 if none was loaded
 
     explicit DataBlock(std::string name,
                        std::string topic,
@@ -77,144 +114,281 @@ namespace fgo::dataset {
       : data_name(std::move(name)), data_topic(std::move(topic)), max_loading_size(max_loading_size),
         cb_get_timestamp(cb_time_getter) {};
 
-    std::function<std::tuple<bool, DataMap>(int64_t, double, const std::string &)> cb_load_data;
+    std::function<DataChunk<DataType>(int64_t, double, const std::string &)> cb_load_data;
     std::function<rclcpp::Time(DataType)> cb_get_timestamp;
-    std::function<void(const std::vector<DataType> &)> cb_on_data;
+    std::function<void(DataSpan)> cb_on_data;
 
     void setExcluded(bool ex) { excluded = ex; }
 
-    void setCbOnData(std::function<void(const std::vector<DataType> &)> on_data) {
+    void setCbOnData(std::function<void(DataSpan)> on_data) {
       cb_on_data = std::move(on_data);
     }
 
-    void setCbLoadData(std::function<std::tuple<bool, DataMap>(int64_t, double, const std::string &)> load_data) {
+    void setCbLoadData(std::function<DataChunk<DataType>(int64_t, double, const std::string &)> load_data) {
       cb_load_data = std::move(load_data);
     }
 
+    /***
+     * load the chunks of this block in the background, cb_load_data is then called from the prefetcher thread
+     * @param data_prefetcher
+     * @param lookahead the next chunk is requested if the loaded samples end less than lookahead seconds after the
+     *                  last query
+     */
+    void setPrefetcher(std::shared_ptr<DataPrefetcher> data_prefetcher, double lookahead) {
+      prefetcher = std::move(data_prefetcher);
+      prefetch_lookahead = lookahead;
+    }
+
     void setData(DataMap new_data, bool loaded = true) {
-      data = std::move(new_data);
-      data_iter = data.begin();
+      timestamps.clear();
+      samples.clear();
+      head = 0;
+      data_iter = 0;
+      load_resume = -1;
+      appendData(std::move(new_data));
       fully_loaded = loaded;
     }
 
+    /***
+     * appends a chunk of data in bulk, samples that aren't newer than the newest sample in the block are dropped
+     * @param new_data
+     */
+    void appendData(DataMap new_data) {
+      compact();
+      timestamps.reserve(timestamps.size() + new_data.size());
+      samples.reserve(samples.size() + new_data.size());
+      for (auto &[stamp, sample]: new_data) {
+        if (!timestamps.empty() && stamp <= timestamps.back())
+          continue;
+        timestamps.emplace_back(stamp);
+        samples.emplace_back(std::move(sample));
+      }
+    }
+
+    // copies the loaded data and its timing, callbacks of this block are kept
+    void copyDataFrom(const DataBlock<DataType> &other) {
+      timestamps.assign(other.timestamps.begin() + other.head, other.timestamps.end());
+      samples.assign(other.samples.begin() + other.head, other.samples.end());
+      head = 0;
+      data_iter = other.data_iter - std::min(other.data_iter, other.head);
+      fully_loaded = other.fully_loaded;
+      load_resume = other.load_resume;
+      timestamp_start = other.timestamp_start;
+      timestamp_end = other.timestamp_end;
+    }
+
+    [[nodiscard]] size_t size() const { return samples.size() - head; }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    [[nodiscard]] const DataType &front() const { return samples[head]; }
+
+    [[nodiscard]] const rclcpp::Time &frontTimestamp() const { return timestamps[head]; }
+
+    [[nodiscard]] const rclcpp::Time &backTimestamp() const { return timestamps.back(); }
+
+    // @return number of samples older than timestamp
+    [[nodiscard]] size_t countBefore(const rclcpp::Time &timestamp) const {
+      return lowerBound(timestamp) - head;
+    }
+
+    // drops the n oldest samples
+    void popFront(size_t n) {
+      head = std::min(head + n, samples.size());
+      data_iter = std::max(data_iter, head);
+    }
+
     void trimData(const rclcpp::Time &start,
                   const rclcpp::Time &end) {
-      const auto valid_end_time = end.nanoseconds() > 0;
-      auto iter = data.begin();
-      while (iter != data.end()) {
-        if (iter->first < start || (valid_end_time && iter->first > end))
-          iter = data.erase(iter);
-        else
-          iter++;
+      if (end.nanoseconds() > 0) {
+        const auto last = upperBound(end);
+        timestamps.erase(timestamps.begin() + last, timestamps.end());
+        samples.erase(samples.begin() + last, samples.end());
+        head = std::min(head, samples.size());
       }
-      data_iter = data.begin();
+      head = lowerBound(start);
+      data_iter = head;
+      compact();
       timestamp_start = start;
       if (timestamp_end.nanoseconds() && timestamp_end > end)
         timestamp_end = end;
     }
 
     bool hasNextMeasurement() {
-      return data_iter != data.end() || (data_iter + 1) != data.end();
+      return data_iter < samples.size() || !fully_loaded;
     }
 
     DataType getNextData() {
       if(excluded)
         return DataType();
 
-      if (data_iter != data.end()) {
-        auto result = data_iter->second;
-        if (cb_on_data) {
-          std::vector<DataType> data_vec = {result};
-          cb_on_data(data_vec);
-        }
-        data_iter++;
-        return result;
-      } else if (!fully_loaded) {
+      while (data_iter >= samples.size() && !fully_loaded) {
         RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
                             "OfflineFGO DataBlock of " << data_name << ": data empty reading ... ");
-        auto [has_next, new_data] = cb_load_data(timestamp_end.nanoseconds(), max_loading_size, data_topic);
-        setData(new_data, !has_next);
-        return getNextData();
-      } else {
-        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
-                            "OfflineFGO DataBlock of " << data_name << ": NO MORE DATA ");
-        return DataType();
+        if (!loadNextChunk())
+          break;
       }
-    }
-
-    std::vector<DataType> getDataBefore(const rclcpp::Time &timestamp,
-                                        bool erase = false) {
-      std::vector<DataType> measurement;
-      if(excluded)
-        return measurement;
-      auto iter = data.begin();
 
-      if (iter == data.end() && !fully_loaded) {
-        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
-                            "OfflineFGO DataBlock of " << data_name << ": data empty reading ... ");
-        auto [has_next, new_data] = cb_load_data(timestamp.nanoseconds(), max_loading_size, data_topic);
-        setData(new_data, !has_next);
-        getDataBefore(timestamp, erase);
+      if (data_iter < samples.size()) {
+        const auto &result = samples[data_iter];
+        if (cb_on_data)
+          cb_on_data(DataSpan(&result, 1));
+        prefetch(timestamps[data_iter]);
+        data_iter++;
+        return result;
       }
+      RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
+                          "OfflineFGO DataBlock of " << data_name << ": NO MORE DATA ");
+      return DataType();
+    }
 
-      while (iter != data.end()) {
-        const auto time = cb_get_timestamp(iter->second);
-        if (time <= timestamp) {
-          measurement.emplace_back(iter->second);
-          if (cb_on_data) {
-            cb_on_data(measurement);
-          }
-          if (erase) {
-            iter = data.erase(iter);
-          } else
-            iter++;
-          data_iter = iter;
-        } else
-          break;
-      }
+    /***
+     * @param timestamp
+     * @param erase the returned samples are consumed and won't be returned again
+     * @return view of all remaining samples with a timestamp not newer than timestamp
+     */
+    DataSpan getDataBefore(const rclcpp::Time &timestamp,
+                           bool erase = false) {
+      if(excluded)
+        return {};
+      compact();
+      loadUntil(timestamp, true);
+
+      const auto first = head;
+      const auto last = upperBound(timestamp);
+      if (erase) {
+        head = last;
+        data_iter = std::max(data_iter, head);
+      } else
+        data_iter = std::max(data_iter, last);
+      const auto measurement = view(first, last);
+      if (cb_on_data && !measurement.empty())
+        cb_on_data(measurement);
+      prefetch(timestamp);
       return measurement;
     }
 
-    std::vector<DataType> getDataBetween(const rclcpp::Time &lastStateTime,
-                                         const rclcpp::Time &currentStateTime) {
-      std::vector<DataType> measurement;
+    /***
+     * @param lastStateTime
+     * @param currentStateTime
+     * @return view of all samples in [lastStateTime, currentStateTime)
+     */
+    DataSpan getDataBetween(const rclcpp::Time &lastStateTime,
+                            const rclcpp::Time &currentStateTime) {
       if(excluded)
-        return measurement;
-      bool findMeasurement = false;
-      auto iter = data.begin();
+        return {};
+      compact();
+      loadUntil(currentStateTime, false);
+
+      const auto measurement = view(lowerBound(lastStateTime), lowerBound(currentStateTime));
+      if (cb_on_data && !measurement.empty())
+        cb_on_data(measurement);
+      prefetch(currentStateTime);
+      return measurement;
+    }
 
-      rclcpp::Time time_last = cb_get_timestamp(std::prev(data.end())->second);
-      if (time_last < currentStateTime) {
-        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
-                            "OfflineFGO bag_reader: data empty reading ... " << data_name);
-        auto [has_next, new_data] = cb_load_data(timestamp_end.nanoseconds(), max_loading_size, data_topic);
-        setData(new_data, !has_next);
+  protected:
+    [[nodiscard]] size_t lowerBound(const rclcpp::Time &timestamp) const {
+      return std::lower_bound(timestamps.begin() + head, timestamps.end(), timestamp) - timestamps.begin();
+    }
+
+    [[nodiscard]] size_t upperBound(const rclcpp::Time &timestamp) const {
+      return std::upper_bound(timestamps.begin() + head, timestamps.end(), timestamp) - timestamps.begin();
+    }
+
+    [[nodiscard]] DataSpan view(size_t first, size_t last) const {
+      return last > first ? DataSpan(samples.data() + first, last - first) : DataSpan();
+    }
+
+    // moves the remaining samples to the front once the consumed ones make up the larger part of the storage
+    void compact() {
+      if (head < MinCompactionSize || head < samples.size() / 2)
+        return;
+      timestamps.erase(timestamps.begin(), timestamps.begin() + head);
+      samples.erase(samples.begin(), samples.begin() + head);
+      data_iter -= std::min(data_iter, head);
+      head = 0;
+    }
+
+    // the first chunk starts at the start of the block, the following ones where the loader stopped
+    [[nodiscard]] int64_t nextLoadStart() const {
+      return load_resume < 0 ? timestamp_start.nanoseconds() : load_resume;
+    }
+
+    // requests the next chunk from the prefetcher if the loaded samples don't cover the lookahead after timestamp
+    void prefetch(const rclcpp::Time &timestamp) {
+      if (!prefetcher || excluded || fully_loaded || !cb_load_data || prefetched_chunk.valid())
+        return;
+      if (!empty() && backTimestamp() > timestamp + rclcpp::Duration::from_seconds(prefetch_lookahead))
+        return;
+      prefetched_chunk_start = nextLoadStart();
+      prefetched_chunk = prefetcher->submit<DataChunk<DataType>>(
+        [load_data = cb_load_data, load_start = prefetched_chunk_start, max_size = max_loading_size,
+          topic = data_topic]() { return load_data(load_start, max_size, topic); });
+    }
+
+    // loads one chunk with cb_load_data and appends it, @return new samples have been appended or more are left
+    bool loadNextChunk() {
+      if (fully_loaded || !cb_load_data) {
+        fully_loaded = true;
+        return false;
       }
+      const auto load_start = nextLoadStart();
+      DataChunk<DataType> chunk;
+      // a prefetched chunk is only used if the block wasn't modified in between, e.g. by trimData
+      if (prefetched_chunk.valid() && prefetched_chunk_start == load_start)
+        chunk = prefetched_chunk.get();
+      else {
+        if (prefetched_chunk.valid())
+          prefetched_chunk.get();
+        chunk = cb_load_data(load_start, max_loading_size, data_topic);
+      }
+      const auto size_before = samples.size();
+      appendData(std::move(chunk.data));
+      // a chunk of samples that were all dropped still moves the loader forward
+      fully_loaded = !chunk.has_next || chunk.resume_nanosec <= load_start;
+      if (chunk.resume_nanosec > load_start)
+        load_resume = chunk.resume_nanosec;
+      return samples.size() > size_before || !fully_loaded;
+    }
 
-      while (iter != data.end()) {
-        rclcpp::Time time = cb_get_timestamp(iter->second);
-        if (time < currentStateTime && time >= lastStateTime) {
-          measurement.emplace_back(iter->second);
-          findMeasurement = true;
-          if (cb_on_data) {
-            cb_on_data(measurement);
-          }
-        } else if (findMeasurement || time > lastStateTime) {
+    // lazily loads chunks until the samples cover the timestamp
+    void loadUntil(const rclcpp::Time &timestamp,
+                   bool inclusive) {
+      while (!fully_loaded && (empty() || backTimestamp() < timestamp || (inclusive && backTimestamp() == timestamp))) {
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                           "OfflineFGO DataBlock of " << data_name << ": loading next chunk ...");
+        if (!loadNextChunk())
           break;
-        }
-        iter++;
       }
-      return measurement;
     }
   };
 
 
+  // copies a view returned by a DataBlock into a batch that outlives the next query
+  template<typename DataType>
+  std::vector<DataType> toVector(std::span<const DataType> data) {
+    return {data.begin(), data.end()};
+  }
+
   struct DataBatch {
     double timestamp_start;
     double timestamp_end;
     std::vector<IMUMeasurement> imu;
     std::vector<PVASolution> reference_pva;
     std::vector<State> reference_state;
+
+    virtual ~DataBatch() = default;
+
+    /***
+     * registers the measurements of this batch as typed channels, the batch must outlive the measurement batch
+     * @param measurements
+     */
+    virtual void collect(MeasurementBatch &measurements) const {
+      measurements.add(channel::IMU, imu);
+      measurements.add(channel::ReferencePVA, reference_pva);
+      measurements.add(channel::ReferenceState, reference_state);
+    }
   };
 
   template<typename ReferenceType>
@@ -223,9 +397,13 @@ namespace fgo::dataset {
     std::string name;
     fgo::sensor::SensorCalibrationManager::Ptr sensor_calib_manager_;
     std::unique_ptr<BagReader> reader_;
+    std::shared_ptr<DatasetCacheReader> cache_reader_;
+    std::unique_ptr<DatasetCacheWriter> cache_writer_;
+    bool bag_loaded_ = false;
     DataBlock<IMUMeasurement> data_imu;
     DataBlock<State> data_reference_state;
     DataBlock<ReferenceType> data_reference;
+    std::shared_ptr<DataPrefetcher> prefetcher_;
 
     rclcpp::Time timestamp_start;
     rclcpp::Time timestamp_end;
@@ -240,7 +418,8 @@ namespace fgo::dataset {
                          const std::shared_ptr<DatasetParam> &param,
                          fgo::sensor::SensorCalibrationManager::Ptr sensor_calib_manager,
                          std::string imu_topic = "/imu/data",
-                         std::string reference_topic = "/reference")
+                         std::string reference_topic = "/reference",
+                         bool read_full_bag = true)
       : params_(param),
         name(std::move(name_)),
         sensor_calib_manager_(sensor_calib_manager),
@@ -250,53 +429,59 @@ namespace fgo::dataset {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": initializing DatasetBase ...");
       reader_ = std::make_unique<BagReader>(params_);
-      reader_->readFullDataFromBag();
+      // if the data blocks are copied from an already parsed dataset, the reader is only used for lazy loading
+      if (read_full_bag) {
+        if (!params_->cache_path.empty()) {
+          const auto source_stamp = cacheSourceStampOf(params_->bag_path);
+          cache_reader_ = DatasetCacheReader::open(params_->cache_path, source_stamp);
+          if (!cache_reader_) {
+            RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                               "OfflineFGO Dataset " << name << ": no valid cache found, writing the cache into "
+                                                     << params_->cache_path);
+            cache_writer_ = std::make_unique<DatasetCacheWriter>(params_->cache_path, source_stamp);
+          }
+        }
+        // with a valid cache, the bag is only read if a topic can't be served by the cache
+        if (!cache_reader_)
+          ensureBagLoaded();
+      }
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": DatasetBase initialized!");
     }
 
     // maybe unuseful
     virtual data::State referenceToState(const ReferenceType &reference) {
-      return data_reference_state.data.begin()->second;
+      return data_reference_state.front();
     };
 
     void setTimestampsFromReference(bool reset_first = false) {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), "OfflineFGO Dataset " << name
                                                                                       << ": Setting start and end timestamps based on the reference data ...");
       if (timestamp_start.nanoseconds() == 0 || reset_first) {
-        size_t first_pos = 0;
-        auto iter = data_reference.data.begin();
-        auto first_timestamp = iter->first;
-        iter = data_reference.data.erase(iter);
-        first_pos++;
-        if (params_->start_offset != 0.) {
-          while (iter != data_reference.data.end()) {
-            if ((iter->first - first_timestamp).seconds() >= params_->start_offset)
-              break;
-            iter = data_reference.data.erase(iter);
-            first_pos++;
-          }
-        }
-        first_timestamp = iter->first;
+        // the first reference is always dropped, the following ones within the start offset as well
+        size_t first_pos = 1;
+        if (params_->start_offset != 0.)
+          first_pos = std::max<size_t>(first_pos, data_reference.countBefore(
+            data_reference.frontTimestamp() + rclcpp::Duration::from_seconds(params_->start_offset)));
+        data_reference.popFront(first_pos);
+
+        const auto first_timestamp = data_reference.frontTimestamp();
         timestamp_start = first_timestamp;
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": setting start time " << timestamp_start.seconds());
-        prior_state = referenceToState(iter->second);
-        const auto imu_data_vec = data_imu.getDataBefore(first_timestamp);
-        prior_state.omega = imu_data_vec.end()->gyro;
-        prior_state.accMeasured = (gtsam::Vector6()
-          << imu_data_vec.end()->accRot, imu_data_vec.end()->accLin).finished();
-
-        if (data_reference_state.data.size() > first_pos) {
-          auto eraseIter = data_reference_state.data.begin();
-          std::advance(eraseIter, first_pos);
-          data_reference_state.data.erase(data_reference_state.data.begin(), eraseIter);
-          data_reference_state.data_iter = data_reference_state.data.begin();
+        prior_state = referenceToState(data_reference.front());
+        const auto imu_data = data_imu.getDataBefore(first_timestamp);
+        if (!imu_data.empty()) {
+          prior_state.omega = imu_data.back().gyro;
+          prior_state.accMeasured = (gtsam::Vector6() << imu_data.back().accRot, imu_data.back().accLin).finished();
         }
+
+        if (data_reference_state.size() > first_pos)
+          data_reference_state.popFront(first_pos);
       }
 
       if (params_->pre_defined_duration == 0.) {
-        timestamp_end = (--data_reference.data.end())->first;
+        timestamp_end = data_reference.backTimestamp();
       } else {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": setting the end time from parameter current");
@@ -316,6 +501,15 @@ namespace fgo::dataset {
 
     template<typename ROSMessageObject>
     std::vector<std::pair<rclcpp::Time, ROSMessageObject>> readROSMessages(const std::string &topic) {
+      if constexpr (CacheTraits<ROSMessageObject>::cacheable) {
+        if (isCached<ROSMessageObject>(topic))
+          return CacheTraits<ROSMessageObject>::read(*cache_reader_, topic);
+        if (cache_reader_)
+          RCLCPP_WARN_STREAM(rclcpp::get_logger("offline_process"),
+                             "OfflineFGO Dataset " << name << ": " << topic
+                                                   << " is not in the cache, reading the bag. Delete the cache to rebuild it.");
+      }
+      ensureBagLoaded();
       const auto raw = reader_->getAllMessageRAW(topic);
 
       std::vector<std::pair<rclcpp::Time, ROSMessageObject>> data;
@@ -324,9 +518,106 @@ namespace fgo::dataset {
                                                                                time_buffer_pair.first);
         data.emplace_back(std::make_pair(timestamp, msg));
       }
+
+      if constexpr (CacheTraits<ROSMessageObject>::cacheable) {
+        if (cache_writer_) {
+          typename CacheTraits<ROSMessageObject>::ColumnWriter column_writer(*cache_writer_, topic);
+          for (size_t i = 0; i < data.size(); i++)
+            column_writer.add(data[i].first, data[i].second, raw[i].first);
+          column_writer.finish();
+        }
+      }
       return data;
     }
 
+    /***
+     * copies the parsed data blocks and the timing of another dataset of the same type, so that the bag doesn't have
+     * to be read and parsed again. Lazily loaded blocks are not copied and will be loaded from the bag on demand.
+     * @param source dataset that has been parsed already
+     */
+    void copyDataBlocksFrom(const DatasetBase<ReferenceType> &source) {
+      data_imu.copyDataFrom(source.data_imu);
+      data_reference_state.copyDataFrom(source.data_reference_state);
+      data_reference.copyDataFrom(source.data_reference);
+      timestamp_start = source.timestamp_start;
+      timestamp_end = source.timestamp_end;
+      prior_state = source.prior_state;
+      cache_reader_ = source.cache_reader_;
+    }
+
+    /***
+     * loads the chunks of a lazily loaded block in the background, all blocks of the dataset share one worker thread
+     * @param block
+     */
+    template<typename DataType>
+    void enablePrefetch(DataBlock<DataType> &block) {
+      if (params_->prefetch_lookahead <= 0.)
+        return;
+      if (!prefetcher_)
+        prefetcher_ = std::make_shared<DataPrefetcher>();
+      block.setPrefetcher(prefetcher_, params_->prefetch_lookahead);
+    }
+
+    /***
+     * @param raw_buffers messages of one chunk read from the bag
+     * @param start where the chunk has been started
+     * @return where the next chunk starts, the receive time after the last message of the chunk
+     */
+    static int64_t bagResumeAfter(
+      const std::vector<std::pair<int64_t, std::shared_ptr<rcutils_uint8_array_t>>> &raw_buffers, int64_t start) {
+      return raw_buffers.empty() ? start : raw_buffers.back().first + 1;
+    }
+
+    void ensureBagLoaded() {
+      if (bag_loaded_)
+        return;
+      reader_->readFullDataFromBag();
+      bag_loaded_ = true;
+    }
+
+    // @return the topic can be served from the mapped cache
+    template<typename CachedType>
+    bool isCached(const std::string &topic) const {
+      return cache_reader_ && cache_reader_->hasColumn(CacheTraits<CachedType>::columnName(topic));
+    }
+
+    /***
+     * reads a lazily loaded topic chunk by chunk from the bag and writes it into the cache, so that later loads
+     * read the raw messages directly from the cache. Lazily loaded topics are only cached if enabled with
+     * cacheLazyTopics, as they make up most of the size of a bag
+     * @param topic
+     */
+    template<typename ROSMessageObject>
+    void writeLazyTopicToCache(const std::string &topic) {
+      if (!cache_writer_ || !params_->cache_lazy_topics)
+        return;
+      RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                         "OfflineFGO Dataset " << name << ": caching " << topic << " ...");
+      typename CacheTraits<ROSMessageObject>::ColumnWriter column_writer(*cache_writer_, topic);
+      int64_t time_start_nanosec = 0;
+      bool has_next = true;
+      while (has_next) {
+        const auto raw_buffers = reader_->readSinglePartialDataFromBag(topic, time_start_nanosec,
+                                                                       params_->max_bag_memory_usage, has_next);
+        if (raw_buffers.empty())
+          break;
+        for (const auto &timestamp_buffer_pair: raw_buffers) {
+          const auto [timestamp, msg] = readROSMessage<ROSMessageObject>(timestamp_buffer_pair);
+          column_writer.add(timestamp, msg, timestamp_buffer_pair.first);
+        }
+        time_start_nanosec = bagResumeAfter(raw_buffers, time_start_nanosec);
+      }
+      column_writer.finish();
+    }
+
+    // finalizes the cache if it has been written in this load
+    void writeCache() {
+      if (!cache_writer_)
+        return;
+      cache_writer_->finalize();
+      cache_writer_.reset();
+    }
+
     virtual void parseDataFromBag() = 0;
 
     virtual void trimDataBlocks() = 0;
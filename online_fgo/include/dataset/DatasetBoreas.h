@@ -35,14 +35,26 @@ namespace fgo::dataset {
     std::vector<PVASolution> gnss;
     std::vector<sensor_msgs::msg::PointCloud2::SharedPtr> lidar_raw;
     std::vector<cv_bridge::CvImagePtr> image;
+    std::vector<cv_bridge::CvImage> radar;
     std::vector<boreas_msgs::msg::SensorPose> camera_pose;
     std::vector<boreas_msgs::msg::SensorPose> lidar_pose;
+
+    void collect(MeasurementBatch &measurements) const override {
+      DataBatch::collect(measurements);
+      measurements.add(channel::GNSS, gnss);
+      measurements.add(channel::LiDAR, lidar_raw);
+      measurements.add(channel::Image, image);
+      measurements.add(channel::Radar, radar);
+      measurements.add(channel::CameraPose, camera_pose);
+      measurements.add(channel::LiDARPose, lidar_pose);
+    }
   };
 
 
   struct DatasetBoreas : DatasetBase<PVASolution> {
     DataBlock<PVASolution> data_pva_gps;
     DataBlock<cv_bridge::CvImagePtr> data_image;
+    DataBlock<cv_bridge::CvImage> data_radar;  // polar scans, one row per azimuth
     DataBlock<sensor_msgs::msg::PointCloud2::SharedPtr> data_lidar_raw;
     DataBlock<boreas_msgs::msg::SensorPose> data_camera_pose;
     DataBlock<boreas_msgs::msg::SensorPose> data_lidar_pose;
@@ -51,21 +63,29 @@ namespace fgo::dataset {
     rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pub_lidar_{};
     image_transport::ImageTransport it;
     image_transport::Publisher pub_image;
+    image_transport::Publisher pub_radar;
 
+    /***
+     * @param source if given, the parsed data blocks are copied from this dataset instead of reading the bag again,
+     * which allows several offline processes to share one parsed dataset
+     */
     explicit DatasetBoreas(rclcpp::Node &node,
                            const std::shared_ptr<DatasetParam> &param,
-                           fgo::sensor::SensorCalibrationManager::Ptr sensor_calib_manager)
-      : DatasetBase("Boreas", param, sensor_calib_manager, "/boreas/imu/data", "/boreas/gps_gt"),
+                           fgo::sensor::SensorCalibrationManager::Ptr sensor_calib_manager,
+                           const std::shared_ptr<const DatasetBoreas> &source = nullptr)
+      : DatasetBase("Boreas", param, sensor_calib_manager, "/boreas/imu/data", "/boreas/gps_gt", source == nullptr),
         data_pva_gps("PVAGNSS", "/boreas/gps_raw", params_->max_bag_memory_usage, PVADataTimeGetter),
         data_image("Image", "/boreas/compressed_image", params_->max_bag_memory_usage,
                    ROSMessagePtrTimeGetter<cv_bridge::CvImagePtr>),
+        data_radar("Radar", "/boreas/compressed_radar", params_->max_bag_memory_usage,
+                   ROSMessageTimeGetter<cv_bridge::CvImage>),
         data_lidar_raw("LiDAR", "/boreas/velodyne_points", params_->max_bag_memory_usage,
                        ROSMessagePtrTimeGetter<sensor_msgs::msg::PointCloud2::SharedPtr>),
         data_camera_pose("CameraPose", "/boreas/camera_pose", params_->max_bag_memory_usage,
                          ROSMessageTimeGetter<boreas_msgs::msg::SensorPose>),
         data_lidar_pose("LiDARPose", "/boreas/lidar_pose", params_->max_bag_memory_usage,
                         ROSMessageTimeGetter<boreas_msgs::msg::SensorPose>),
-        it(rclcpp::Node::SharedPtr(&node))
+        it(rclcpp::Node::SharedPtr(&node, [](rclcpp::Node *) {}))  // the node is not owned by the dataset
     //gnss_param_ptr(gnss_integrator_param)
     {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
@@ -75,6 +95,8 @@ namespace fgo::dataset {
         if (topic == data_image.data_topic)
           data_image.setExcluded(true);
 
+        if (topic == data_radar.data_topic)
+          data_radar.setExcluded(true);
 
         if (topic == data_lidar_raw.data_topic)
           data_lidar_raw.setExcluded(true);
@@ -91,8 +113,9 @@ namespace fgo::dataset {
       pub_gt_ = node.create_publisher<sensor_msgs::msg::NavSatFix>("/boreas/gps_gt_fix", rclcpp::SystemDefaultsQoS());
       pub_lidar_ = node.create_publisher<sensor_msgs::msg::PointCloud2>("/boreas/lidar", rclcpp::SystemDefaultsQoS());
       pub_image = it.advertise("boreas/image", 1);
+      pub_radar = it.advertise("boreas/radar", 1);
 
-      auto func_on_gt = [this](const std::vector<PVASolution> &data) -> void {
+      auto func_on_gt = [this](std::span<const PVASolution> data) -> void {
         for (const auto &pva: data) {
           sensor_msgs::msg::NavSatFix navfix;
           navfix.header.stamp = pva.timestamp;
@@ -103,7 +126,7 @@ namespace fgo::dataset {
         }
       };
 
-      auto func_on_gnss = [this](const std::vector<PVASolution> &data) -> void {
+      auto func_on_gnss = [this](std::span<const PVASolution> data) -> void {
         for (const auto &pva: data) {
           sensor_msgs::msg::NavSatFix navfix;
           navfix.header.stamp = pva.timestamp;
@@ -116,17 +139,27 @@ namespace fgo::dataset {
       data_reference.setCbOnData(func_on_gt);
       data_pva_gps.setCbOnData(func_on_gnss);
 
-      auto func_on_lidar = [this](const std::vector<sensor_msgs::msg::PointCloud2::SharedPtr> &data) -> void {
+      auto func_on_lidar = [this](std::span<const sensor_msgs::msg::PointCloud2::SharedPtr> data) -> void {
         for (const auto &pc: data)
           pub_lidar_->publish(*pc);
       };
       auto func_load_lidar_data = [this](int64_t time_start_nanosec,
                                          double max_size,
-                                         const std::string &data_topic) -> std::tuple<bool, std::map<rclcpp::Time, sensor_msgs::msg::PointCloud2::SharedPtr>> {
+                                         const std::string &data_topic) -> DataChunk<sensor_msgs::msg::PointCloud2::SharedPtr> {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": starting loading lidar data");
         std::map<rclcpp::Time, sensor_msgs::msg::PointCloud2::SharedPtr> data_map;
         bool bag_bas_next;
+        int64_t resume;
+        if (this->isCached<sensor_msgs::msg::PointCloud2>(data_topic)) {
+          auto cached = CacheTraits<sensor_msgs::msg::PointCloud2>::readWindow(*this->cache_reader_, data_topic,
+                                                                               time_start_nanosec, max_size,
+                                                                               bag_bas_next, resume);
+          for (auto &timestamp_pc_pair: cached)
+            data_map.insert(std::make_pair(timestamp_pc_pair.first, std::make_shared<sensor_msgs::msg::PointCloud2>(
+              std::move(timestamp_pc_pair.second))));
+          return {bag_bas_next, data_map, resume};
+        }
         const auto raw_buffer_map = this->reader_->readSinglePartialDataFromBag(data_topic,
                                                                                 time_start_nanosec,
                                                                                 max_size,
@@ -138,18 +171,30 @@ namespace fgo::dataset {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": got " << data_topic << " done. Is bag finished? "
                                                  << (!bag_bas_next ? "Yes" : "No"));
-        return {bag_bas_next, data_map};
+        return {bag_bas_next, data_map, this->bagResumeAfter(raw_buffer_map, time_start_nanosec)};
       };
       data_lidar_raw.setCbLoadData(func_load_lidar_data);
+      enablePrefetch(data_lidar_raw);
       data_lidar_raw.setCbOnData(func_on_lidar);
 
       auto func_load_cvImage_data = [this](int64_t time_start_nanosec,
                                            double max_size,
-                                           const std::string &data_topic) -> std::tuple<bool, std::map<rclcpp::Time, cv_bridge::CvImagePtr>> {
+                                           const std::string &data_topic) -> DataChunk<cv_bridge::CvImagePtr> {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": starting loading image data");
         std::map<rclcpp::Time, cv_bridge::CvImagePtr> data_map;
         bool bag_bas_next;
+        int64_t resume;
+        if (this->isCached<sensor_msgs::msg::CompressedImage>(data_topic)) {
+          // compressed images from the cache, only the loaded window is decoded
+          const auto cached = CacheTraits<sensor_msgs::msg::CompressedImage>::readWindow(*this->cache_reader_,
+                                                                                         data_topic,
+                                                                                         time_start_nanosec, max_size,
+                                                                                         bag_bas_next, resume);
+          for (const auto &[timestamp, img]: cached)
+            data_map.insert(std::make_pair(timestamp, cv_bridge::toCvCopy(img)));
+          return {bag_bas_next, data_map, resume};
+        }
         const auto raw_buffer_map = this->reader_->readSinglePartialDataFromBag(data_topic,
                                                                                 time_start_nanosec,
                                                                                 max_size,
@@ -162,9 +207,9 @@ namespace fgo::dataset {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": got " << data_topic << " done. Is bag finished? "
                                                  << (bag_bas_next ? "Yes" : "No"));
-        return {bag_bas_next, data_map};
+        return {bag_bas_next, data_map, this->bagResumeAfter(raw_buffer_map, time_start_nanosec)};
       };
-      auto func_on_image = [this](const std::vector<cv_bridge::CvImagePtr> &images) -> void {
+      auto func_on_image = [this](std::span<const cv_bridge::CvImagePtr> images) -> void {
         for (const auto &image: images) {
           //ToDo: @Jiandong, please adjust the color format in the infrared image in order to make it visualizable
           pub_image.publish(image->toImageMsg());
@@ -172,7 +217,62 @@ namespace fgo::dataset {
       };
       data_image.setCbOnData(func_on_image);
       data_image.setCbLoadData(func_load_cvImage_data);
-      parseDataFromBag();
+      enablePrefetch(data_image);
+
+      auto func_load_radar_data = [this](int64_t time_start_nanosec,
+                                         double max_size,
+                                         const std::string &data_topic) -> DataChunk<cv_bridge::CvImage> {
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                           "OfflineFGO Dataset " << name << ": starting loading radar data");
+        std::map<rclcpp::Time, cv_bridge::CvImage> data_map;
+        bool bag_bas_next;
+        int64_t resume;
+        if (this->isCached<sensor_msgs::msg::CompressedImage>(data_topic)) {
+          const auto cached = CacheTraits<sensor_msgs::msg::CompressedImage>::readWindow(*this->cache_reader_,
+                                                                                         data_topic,
+                                                                                         time_start_nanosec, max_size,
+                                                                                         bag_bas_next, resume);
+          for (const auto &[timestamp, img]: cached)
+            data_map.insert(std::make_pair(timestamp, *cv_bridge::toCvCopy(img)));
+          return {bag_bas_next, data_map, resume};
+        }
+        const auto raw_buffer_map = this->reader_->readSinglePartialDataFromBag(data_topic,
+                                                                                time_start_nanosec,
+                                                                                max_size,
+                                                                                bag_bas_next);
+        for (const auto &timestamp_buffer_pair: raw_buffer_map) {
+          const auto [timestamp, img] = this->readROSMessage<sensor_msgs::msg::CompressedImage>(timestamp_buffer_pair);
+          data_map.insert(std::make_pair(timestamp, *cv_bridge::toCvCopy(img)));
+        }
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                           "OfflineFGO Dataset " << name << ": got " << data_topic << " done. Is bag finished? "
+                                                 << (!bag_bas_next ? "Yes" : "No"));
+        return {bag_bas_next, data_map, this->bagResumeAfter(raw_buffer_map, time_start_nanosec)};
+      };
+      auto func_on_radar = [this](std::span<const cv_bridge::CvImage> scans) -> void {
+        for (const auto &scan: scans)
+          pub_radar.publish(scan.toImageMsg());
+      };
+      data_radar.setCbOnData(func_on_radar);
+      data_radar.setCbLoadData(func_load_radar_data);
+      enablePrefetch(data_radar);
+
+      if (source) {
+        copyDataBlocksFrom(*source);
+        data_pva_gps.copyDataFrom(source->data_pva_gps);
+        data_camera_pose.copyDataFrom(source->data_camera_pose);
+        data_lidar_pose.copyDataFrom(source->data_lidar_pose);
+        // the raw lidar, image and radar data are loaded lazily by each dataset using its own reader
+        data_lidar_raw.timestamp_start = source->data_lidar_raw.timestamp_start;
+        data_lidar_raw.timestamp_end = source->data_lidar_raw.timestamp_end;
+        data_image.timestamp_start = source->data_image.timestamp_start;
+        data_image.timestamp_end = source->data_image.timestamp_end;
+        data_radar.timestamp_start = source->data_radar.timestamp_start;
+        data_radar.timestamp_end = source->data_radar.timestamp_end;
+        RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                           "OfflineFGO Dataset " << name << ": data blocks copied from a parsed dataset");
+      } else
+        parseDataFromBag();
     }
 
     void parseDataFromBag() override {
@@ -190,13 +290,24 @@ namespace fgo::dataset {
       const auto raw_lidar_pose_msg = readROSMessages<boreas_msgs::msg::SensorPose>(data_lidar_pose.data_topic);
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), "OfflineFGO Dataset " << name << ": got lidar pose");
 
+      // lazily loaded topics are only cached if they are used at all
+      if (!data_lidar_raw.excluded)
+        writeLazyTopicToCache<sensor_msgs::msg::PointCloud2>(data_lidar_raw.data_topic);
+      if (!data_image.excluded)
+        writeLazyTopicToCache<sensor_msgs::msg::CompressedImage>(data_image.data_topic);
+      if (!data_radar.excluded)
+        writeLazyTopicToCache<sensor_msgs::msg::CompressedImage>(data_radar.data_topic);
+      writeCache();
+
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": start converting ...");
 
       const auto preRotationIMU = sensor_calib_manager_->getPreRotation("imu");
       DataBlock<IMUMeasurement>::DataMap imu_map;
+      IMUMessageTrackingState imu_tracking_state;
       for (const auto &time_msg_pair: raw_imu_msg) {
         imu_map.insert(std::make_pair(time_msg_pair.first, msg2IMUMeasurement(time_msg_pair.second, time_msg_pair.first,
+                                                                              imu_tracking_state,
                                                                               preRotationIMU.matrix())));
       }
       data_imu.setData(imu_map, true);
@@ -260,10 +371,11 @@ namespace fgo::dataset {
       data_camera_pose.trimData(timestamp_start, timestamp_end);
       data_lidar_raw.trimData(timestamp_start, timestamp_end);
       data_image.trimData(timestamp_start, timestamp_end);
+      data_radar.trimData(timestamp_start, timestamp_end);
     }
 
     data::State referenceToState(const PVASolution &reference) override {
-      static const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
+      const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
       return sensor::gnss::PVASolutionToState(reference, transReferenceFromBase.translation());
     }
 
@@ -274,14 +386,15 @@ namespace fgo::dataset {
       BoreasDataBatch batch;
       batch.timestamp_end = timestamp;
       const auto ros_timestamp = utils::secondsToROSTime(timestamp);
-      batch.imu = data_imu.getDataBefore(ros_timestamp, erase);
-      batch.reference_pva = data_reference.getDataBefore(ros_timestamp, erase);
-      batch.reference_state = data_reference_state.getDataBefore(ros_timestamp, erase);
-      batch.gnss = data_pva_gps.getDataBefore(ros_timestamp, erase);
-      batch.image = data_image.getDataBefore(ros_timestamp, erase);
-      batch.camera_pose = data_camera_pose.getDataBefore(ros_timestamp, erase);
-      batch.lidar_raw = data_lidar_raw.getDataBefore(ros_timestamp, erase);
-      batch.lidar_pose = data_lidar_pose.getDataBefore(ros_timestamp, erase);
+      batch.imu = toVector(data_imu.getDataBefore(ros_timestamp, erase));
+      batch.reference_pva = toVector(data_reference.getDataBefore(ros_timestamp, erase));
+      batch.reference_state = toVector(data_reference_state.getDataBefore(ros_timestamp, erase));
+      batch.gnss = toVector(data_pva_gps.getDataBefore(ros_timestamp, erase));
+      batch.image = toVector(data_image.getDataBefore(ros_timestamp, erase));
+      batch.radar = toVector(data_radar.getDataBefore(ros_timestamp, erase));
+      batch.camera_pose = toVector(data_camera_pose.getDataBefore(ros_timestamp, erase));
+      batch.lidar_raw = toVector(data_lidar_raw.getDataBefore(ros_timestamp, erase));
+      batch.lidar_pose = toVector(data_lidar_pose.getDataBefore(ros_timestamp, erase));
       return batch;
     }
 
@@ -291,14 +404,15 @@ namespace fgo::dataset {
       batch.timestamp_end = timestamp_end;
       const auto ros_timestamp_start = utils::secondsToROSTime(timestamp_start);
       const auto ros_timestamp_end = utils::secondsToROSTime(timestamp_end);
-      batch.imu = data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_pva = data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_state = data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.gnss = data_pva_gps.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.image = data_image.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.camera_pose = data_camera_pose.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.lidar_raw = data_lidar_raw.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.lidar_pose = data_lidar_pose.getDataBetween(ros_timestamp_start, ros_timestamp_end);
+      batch.imu = toVector(data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_pva = toVector(data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_state = toVector(data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.gnss = toVector(data_pva_gps.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.image = toVector(data_image.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.radar = toVector(data_radar.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.camera_pose = toVector(data_camera_pose.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.lidar_raw = toVector(data_lidar_raw.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.lidar_pose = toVector(data_lidar_pose.getDataBetween(ros_timestamp_start, ros_timestamp_end));
       return batch;
     }
   };
@@ -0,0 +1,872 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+
+#ifndef ONLINE_FGO_DATASETCACHE_H
+#define ONLINE_FGO_DATASETCACHE_H
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/imu.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+#include <geometry_msgs/msg/pose_stamped.hpp>
+#include <boreas_msgs/msg/sensor_pose.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+
+namespace fgo::dataset {
+
+  /**
+   * Design Idea: parsing a dataset means reading the bag through sqlite and deserializing every CDR buffer, which
+   * takes most of the start-up time of an offline process. The first load therefore writes the deserialized messages
+   * into a cache file, which is memory mapped by all later loads.
+   * The cache is columnar: every topic is stored as an array of fixed-size records in the receive order of the bag,
+   * variable sized payloads (point clouds, compressed images) are stored in an additional byte column referenced by
+   * the records. Images are cached compressed as in the bag and decoded on access, decoded pixels would inflate the
+   * cache by orders of magnitude.
+   * Only message contents are cached, everything calibration dependent is still calculated while parsing the data.
+   *
+   *  [CacheFileHeader][column 0]...[column n-1][CacheColumnEntry x n]   (columns aligned to CacheAlignment)
+   */
+
+  constexpr char CacheMagic[8] = {'F', 'G', 'O', 'D', 'S', 'C', '0', '1'};
+  constexpr uint32_t CacheVersion = 3;
+  constexpr size_t CacheAlignment = 64;
+  constexpr size_t CacheNameSize = 128;
+  constexpr size_t CacheFrameIdSize = 64;
+
+  enum class CacheRecordType : uint32_t {
+    Byte = 1,
+    IMU = 2,
+    Odometry = 3,
+    PoseStamped = 4,
+    SensorPose = 5,
+    PointCloud = 6,
+    PointField = 7,
+    CompressedImage = 8,
+  };
+
+  // identifies the bag a cache has been written from, a cache is invalid if the bag has been changed
+  struct CacheSourceStamp {
+    uint64_t size = 0;
+    int64_t modified = 0;
+
+    bool operator==(const CacheSourceStamp &other) const {
+      return size == other.size && modified == other.modified;
+    }
+  };
+
+  inline CacheSourceStamp cacheSourceStampOf(const std::string &bag_path) {
+    namespace fs = std::filesystem;
+    CacheSourceStamp stamp;
+    std::error_code ec;
+    auto add_file = [&stamp](const fs::path &file) {
+      std::error_code ec_file;
+      stamp.size += fs::file_size(file, ec_file);
+      const auto modified = fs::last_write_time(file, ec_file).time_since_epoch().count();
+      stamp.modified = std::max<int64_t>(stamp.modified, modified);
+    };
+    if (fs::is_directory(bag_path, ec)) {
+      for (const auto &entry: fs::directory_iterator(bag_path, ec))
+        if (entry.is_regular_file())
+          add_file(entry.path());
+    } else if (fs::exists(bag_path, ec))
+      add_file(bag_path);
+    return stamp;
+  }
+
+  struct CacheFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_columns;
+    uint64_t toc_offset;
+    CacheSourceStamp source;
+    uint8_t reserved[24];
+  };
+  static_assert(sizeof(CacheFileHeader) == CacheAlignment);
+
+  struct CacheColumnEntry {
+    char name[CacheNameSize];
+    CacheRecordType record_type;
+    uint32_t record_size;
+    uint64_t count;
+    uint64_t offset;
+  };
+
+  /*** Records, all records are trivially copyable ***/
+  struct CachedHeader {
+    int64_t time_ns;  // key of the message in the data block, header stamp or bag time
+    int64_t bag_time_ns;  // receive time in the bag, the records of a column are sorted by it
+    int32_t stamp_sec;
+    uint32_t stamp_nanosec;
+    char frame_id[CacheFrameIdSize];
+  };
+
+  struct CachedIMURecord {
+    static constexpr CacheRecordType Type = CacheRecordType::IMU;
+    CachedHeader header;
+    double orientation[4];
+    double orientation_covariance[9];
+    double angular_velocity[3];
+    double angular_velocity_covariance[9];
+    double linear_acceleration[3];
+    double linear_acceleration_covariance[9];
+  };
+
+  struct CachedOdometryRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::Odometry;
+    CachedHeader header;
+    char child_frame_id[CacheFrameIdSize];
+    double position[3];
+    double orientation[4];
+    double pose_covariance[36];
+    double linear[3];
+    double angular[3];
+    double twist_covariance[36];
+  };
+
+  struct CachedPoseStampedRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::PoseStamped;
+    CachedHeader header;
+    double position[3];
+    double orientation[4];
+  };
+
+  struct CachedSensorPoseRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::SensorPose;
+    CachedHeader header;
+    double values[13];  // in the order of boreas_msgs/SensorPose
+  };
+
+  struct CachedPointCloudRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::PointCloud;
+    CachedHeader header;
+    uint32_t height;
+    uint32_t width;
+    uint32_t point_step;
+    uint32_t row_step;
+    uint8_t is_bigendian;
+    uint8_t is_dense;
+    uint32_t field_begin;
+    uint32_t num_fields;
+    uint64_t data_offset;
+    uint64_t data_size;
+  };
+
+  struct CachedPointFieldRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::PointField;
+    char name[CacheFrameIdSize];
+    uint32_t offset;
+    uint8_t datatype;
+    uint32_t count;
+  };
+
+  struct CachedCompressedImageRecord {
+    static constexpr CacheRecordType Type = CacheRecordType::CompressedImage;
+    CachedHeader header;
+    char format[32];
+    uint64_t data_offset;
+    uint64_t data_size;
+  };
+
+  inline void copyCacheString(const std::string &str, char *dst, size_t size) {
+    std::memset(dst, 0, size);
+    std::memcpy(dst, str.data(), std::min(str.size(), size - 1));
+  }
+
+  inline std::string cacheString(const char *src, size_t size) {
+    return {src, strnlen(src, size)};
+  }
+
+  inline CachedHeader toCachedHeader(const rclcpp::Time &time, const std_msgs::msg::Header &header) {
+    CachedHeader cached{};
+    cached.time_ns = time.nanoseconds();
+    cached.stamp_sec = header.stamp.sec;
+    cached.stamp_nanosec = header.stamp.nanosec;
+    copyCacheString(header.frame_id, cached.frame_id, CacheFrameIdSize);
+    return cached;
+  }
+
+  inline std_msgs::msg::Header fromCachedHeader(const CachedHeader &cached) {
+    std_msgs::msg::Header header;
+    header.stamp.sec = cached.stamp_sec;
+    header.stamp.nanosec = cached.stamp_nanosec;
+    header.frame_id = cacheString(cached.frame_id, CacheFrameIdSize);
+    return header;
+  }
+
+  class DatasetCacheWriter {
+  public:
+    DatasetCacheWriter(std::string path, const CacheSourceStamp &source) : path_(std::move(path)) {
+      tmp_path_ = path_ + ".tmp." + std::to_string(::getpid());
+      file_.open(tmp_path_, std::ios::binary | std::ios::out | std::ios::trunc);
+      if (!file_.is_open()) {
+        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
+                            "OfflineFGO DatasetCache: can't create cache file " << tmp_path_);
+        return;
+      }
+      std::memcpy(header_.magic, CacheMagic, sizeof(CacheMagic));
+      header_.version = CacheVersion;
+      header_.source = source;
+      file_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+    }
+
+    ~DatasetCacheWriter() {
+      if (file_.is_open()) {
+        // not finalized, the partial file is dropped
+        file_.close();
+        std::error_code ec;
+        std::filesystem::remove(tmp_path_, ec);
+      }
+    }
+
+    [[nodiscard]] bool isOpen() const { return file_.is_open(); }
+
+    template<typename Record>
+    void writeColumn(const std::string &name, const std::vector<Record> &records) {
+      static_assert(std::is_trivially_copyable_v<Record>);
+      if (!isOpen() || blob_open_)
+        return;
+      auto entry = beginColumn(name, Record::Type, sizeof(Record));
+      file_.write(reinterpret_cast<const char *>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(Record)));
+      entry.count = records.size();
+      entries_.emplace_back(entry);
+    }
+
+    /***
+     * byte columns are streamed into the file, as they can be larger than the memory. No other column can be written
+     * until the byte column is closed.
+     */
+    void beginBlob(const std::string &name) {
+      if (!isOpen() || blob_open_)
+        return;
+      blob_entry_ = beginColumn(name, CacheRecordType::Byte, 1);
+      blob_open_ = true;
+    }
+
+    // @return offset of the data in the byte column
+    uint64_t appendBlob(const void *data, size_t size) {
+      const auto offset = blob_entry_.count;
+      file_.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+      blob_entry_.count += size;
+      return offset;
+    }
+
+    void endBlob() {
+      if (!blob_open_)
+        return;
+      entries_.emplace_back(blob_entry_);
+      blob_open_ = false;
+    }
+
+    /***
+     * writes the table of contents and moves the file to its destination, so that concurrent processes never map
+     * a partially written cache
+     * @return cache written successfully
+     */
+    bool finalize() {
+      if (!isOpen())
+        return false;
+      endBlob();
+      alignFile();
+      header_.toc_offset = static_cast<uint64_t>(file_.tellp());
+      header_.num_columns = static_cast<uint32_t>(entries_.size());
+      file_.write(reinterpret_cast<const char *>(entries_.data()),
+                  static_cast<std::streamsize>(entries_.size() * sizeof(CacheColumnEntry)));
+      file_.seekp(0);
+      file_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+      file_.close();
+      if (!file_) {
+        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
+                            "OfflineFGO DatasetCache: failed writing cache file " << tmp_path_);
+        return false;
+      }
+      std::error_code ec;
+      std::filesystem::rename(tmp_path_, path_, ec);
+      if (ec) {
+        RCLCPP_ERROR_STREAM(rclcpp::get_logger("offline_process"),
+                            "OfflineFGO DatasetCache: failed moving cache file to " << path_ << ": " << ec.message());
+        std::filesystem::remove(tmp_path_, ec);
+        return false;
+      }
+      RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                         "OfflineFGO DatasetCache: written " << entries_.size() << " columns into " << path_);
+      return true;
+    }
+
+  private:
+    std::string path_;
+    std::string tmp_path_;
+    std::ofstream file_;
+    CacheFileHeader header_{};
+    std::vector<CacheColumnEntry> entries_;
+    CacheColumnEntry blob_entry_{};
+    bool blob_open_ = false;
+
+    void alignFile() {
+      static const char zeros[CacheAlignment] = {};
+      const auto pos = static_cast<size_t>(file_.tellp());
+      const auto padding = (CacheAlignment - pos % CacheAlignment) % CacheAlignment;
+      file_.write(zeros, static_cast<std::streamsize>(padding));
+    }
+
+    CacheColumnEntry beginColumn(const std::string &name, CacheRecordType type, uint32_t record_size) {
+      alignFile();
+      CacheColumnEntry entry{};
+      copyCacheString(name, entry.name, CacheNameSize);
+      entry.record_type = type;
+      entry.record_size = record_size;
+      entry.offset = static_cast<uint64_t>(file_.tellp());
+      return entry;
+    }
+  };
+
+  class DatasetCacheReader {
+  public:
+    /***
+     * maps an existing cache file
+     * @param path cache file
+     * @param source stamp of the bag, the cache is rejected if it was written from another version of the bag
+     * @return reader or nullptr if the cache doesn't exist or is invalid
+     */
+    static std::shared_ptr<DatasetCacheReader> open(const std::string &path, const CacheSourceStamp &source) {
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        return nullptr;
+      struct stat st{};
+      if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CacheFileHeader)) {
+        ::close(fd);
+        return nullptr;
+      }
+      // read-only mapping, the messages are copied out of the cache and its pages are shared between processes
+      void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (addr == MAP_FAILED)
+        return nullptr;
+
+      auto reader = std::shared_ptr<DatasetCacheReader>(new DatasetCacheReader(addr, st.st_size));
+      if (!reader->parse(source)) {
+        RCLCPP_WARN_STREAM(rclcpp::get_logger("offline_process"),
+                           "OfflineFGO DatasetCache: ignoring outdated or invalid cache " << path);
+        return nullptr;
+      }
+      RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
+                         "OfflineFGO DatasetCache: mapped " << reader->columns_.size() << " columns from " << path);
+      return reader;
+    }
+
+    ~DatasetCacheReader() {
+      ::munmap(addr_, size_);
+    }
+
+    DatasetCacheReader(const DatasetCacheReader &) = delete;
+
+    DatasetCacheReader &operator=(const DatasetCacheReader &) = delete;
+
+    [[nodiscard]] bool hasColumn(const std::string &name) const {
+      return columns_.find(name) != columns_.end();
+    }
+
+    template<typename Record>
+    std::span<const Record> column(const std::string &name) const {
+      const auto iter = columns_.find(name);
+      if (iter == columns_.end() || iter->second.record_type != Record::Type ||
+          iter->second.record_size != sizeof(Record))
+        return {};
+      return {reinterpret_cast<const Record *>(static_cast<const uint8_t *>(addr_) + iter->second.offset),
+              iter->second.count};
+    }
+
+    [[nodiscard]] std::span<const uint8_t> blob(const std::string &name) const {
+      const auto iter = columns_.find(name);
+      if (iter == columns_.end() || iter->second.record_type != CacheRecordType::Byte)
+        return {};
+      return {static_cast<const uint8_t *>(addr_) + iter->second.offset, iter->second.count};
+    }
+
+  private:
+    void *addr_;
+    size_t size_;
+    std::map<std::string, CacheColumnEntry> columns_;
+
+    DatasetCacheReader(void *addr, size_t size) : addr_(addr), size_(size) {}
+
+    bool parse(const CacheSourceStamp &source) {
+      const auto &header = *static_cast<const CacheFileHeader *>(addr_);
+      if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.version != CacheVersion ||
+          !(header.source == source))
+        return false;
+      if (header.toc_offset + header.num_columns * sizeof(CacheColumnEntry) > size_)
+        return false;
+      const auto *entries = reinterpret_cast<const CacheColumnEntry *>(static_cast<const uint8_t *>(addr_) +
+                                                                       header.toc_offset);
+      for (uint32_t i = 0; i < header.num_columns; i++) {
+        const auto &entry = entries[i];
+        if (entry.offset + entry.count * entry.record_size > size_)
+          return false;
+        columns_.insert(std::make_pair(cacheString(entry.name, CacheNameSize), entry));
+      }
+      return true;
+    }
+  };
+
+  /***
+   * CacheTraits define how a message type is stored in the cache
+   *  ColumnWriter: collects the messages of one topic while parsing the bag
+   *  read(): all messages of a topic
+   *  readWindow(): messages of a topic starting at a receive time of the bag until a memory budget is used up, for
+   *                lazy loading. Messages with the same receive time are never split between two windows, resume_ns is
+   *                where the next window starts
+   */
+  template<typename ROSMessageObject>
+  struct CacheTraits {
+    static constexpr bool cacheable = false;
+  };
+
+  template<typename Record>
+  inline typename std::span<const Record>::iterator cacheLowerBound(std::span<const Record> records,
+                                                                    int64_t bag_time_ns) {
+    return std::lower_bound(records.begin(), records.end(), bag_time_ns,
+                            [](const Record &record, int64_t t) -> bool { return record.header.bag_time_ns < t; });
+  }
+
+  // @return the window is full and the record doesn't share the receive time of the last record in the window
+  template<typename Record>
+  inline bool cacheWindowFull(const Record *last, const Record &record, double memory_usage, double max_size) {
+    return memory_usage > max_size && last && last->header.bag_time_ns != record.header.bag_time_ns;
+  }
+
+  // traits for messages that can be stored as a single fixed-size record
+  template<typename ROSMessageObject, typename Record, typename Derived>
+  struct FixedRecordCacheTraits {
+    static constexpr bool cacheable = true;
+    typedef std::vector<std::pair<rclcpp::Time, ROSMessageObject>> Messages;
+
+    static std::string columnName(const std::string &topic) { return topic; }
+
+    class ColumnWriter {
+    public:
+      ColumnWriter(DatasetCacheWriter &writer, std::string topic) : writer_(writer), topic_(std::move(topic)) {}
+
+      void add(const rclcpp::Time &time, const ROSMessageObject &msg, int64_t bag_time_ns) {
+        auto &record = records_.emplace_back(Derived::toRecord(time, msg));
+        record.header.bag_time_ns = bag_time_ns;
+      }
+
+      void finish() { writer_.writeColumn(columnName(topic_), records_); }
+
+    private:
+      DatasetCacheWriter &writer_;
+      std::string topic_;
+      std::vector<Record> records_;
+    };
+
+    static Messages read(const DatasetCacheReader &reader, const std::string &topic) {
+      const auto records = reader.column<Record>(columnName(topic));
+      Messages messages;
+      messages.reserve(records.size());
+      for (const auto &record: records)
+        messages.emplace_back(rclcpp::Time(record.header.time_ns, RCL_ROS_TIME), Derived::fromRecord(record));
+      return messages;
+    }
+
+    static Messages readWindow(const DatasetCacheReader &reader, const std::string &topic, int64_t bag_time_start_ns,
+                               double max_size, bool &has_next, int64_t &resume_ns) {
+      const auto records = reader.column<Record>(columnName(topic));
+      Messages messages;
+      double memory_usage = 0.;
+      const Record *last = nullptr;
+      auto iter = cacheLowerBound(records, bag_time_start_ns);
+      for (; iter != records.end() && !cacheWindowFull(last, *iter, memory_usage, max_size); iter++) {
+        messages.emplace_back(rclcpp::Time(iter->header.time_ns, RCL_ROS_TIME), Derived::fromRecord(*iter));
+        memory_usage += sizeof(Record) * 1e-9;
+        last = &*iter;
+      }
+      has_next = iter != records.end();
+      resume_ns = last ? last->header.bag_time_ns + 1 : bag_time_start_ns;
+      return messages;
+    }
+  };
+
+  template<>
+  struct CacheTraits<sensor_msgs::msg::Imu>
+    : FixedRecordCacheTraits<sensor_msgs::msg::Imu, CachedIMURecord, CacheTraits<sensor_msgs::msg::Imu>> {
+    static CachedIMURecord toRecord(const rclcpp::Time &time, const sensor_msgs::msg::Imu &msg) {
+      CachedIMURecord record{};
+      record.header = toCachedHeader(time, msg.header);
+      record.orientation[0] = msg.orientation.x;
+      record.orientation[1] = msg.orientation.y;
+      record.orientation[2] = msg.orientation.z;
+      record.orientation[3] = msg.orientation.w;
+      record.angular_velocity[0] = msg.angular_velocity.x;
+      record.angular_velocity[1] = msg.angular_velocity.y;
+      record.angular_velocity[2] = msg.angular_velocity.z;
+      record.linear_acceleration[0] = msg.linear_acceleration.x;
+      record.linear_acceleration[1] = msg.linear_acceleration.y;
+      record.linear_acceleration[2] = msg.linear_acceleration.z;
+      std::copy(msg.orientation_covariance.begin(), msg.orientation_covariance.end(), record.orientation_covariance);
+      std::copy(msg.angular_velocity_covariance.begin(), msg.angular_velocity_covariance.end(),
+                record.angular_velocity_covariance);
+      std::copy(msg.linear_acceleration_covariance.begin(), msg.linear_acceleration_covariance.end(),
+                record.linear_acceleration_covariance);
+      return record;
+    }
+
+    static sensor_msgs::msg::Imu fromRecord(const CachedIMURecord &record) {
+      sensor_msgs::msg::Imu msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.orientation.x = record.orientation[0];
+      msg.orientation.y = record.orientation[1];
+      msg.orientation.z = record.orientation[2];
+      msg.orientation.w = record.orientation[3];
+      msg.angular_velocity.x = record.angular_velocity[0];
+      msg.angular_velocity.y = record.angular_velocity[1];
+      msg.angular_velocity.z = record.angular_velocity[2];
+      msg.linear_acceleration.x = record.linear_acceleration[0];
+      msg.linear_acceleration.y = record.linear_acceleration[1];
+      msg.linear_acceleration.z = record.linear_acceleration[2];
+      std::copy_n(record.orientation_covariance, 9, msg.orientation_covariance.begin());
+      std::copy_n(record.angular_velocity_covariance, 9, msg.angular_velocity_covariance.begin());
+      std::copy_n(record.linear_acceleration_covariance, 9, msg.linear_acceleration_covariance.begin());
+      return msg;
+    }
+  };
+
+  template<>
+  struct CacheTraits<nav_msgs::msg::Odometry>
+    : FixedRecordCacheTraits<nav_msgs::msg::Odometry, CachedOdometryRecord, CacheTraits<nav_msgs::msg::Odometry>> {
+    static CachedOdometryRecord toRecord(const rclcpp::Time &time, const nav_msgs::msg::Odometry &msg) {
+      CachedOdometryRecord record{};
+      record.header = toCachedHeader(time, msg.header);
+      copyCacheString(msg.child_frame_id, record.child_frame_id, CacheFrameIdSize);
+      const auto &pose = msg.pose.pose;
+      record.position[0] = pose.position.x;
+      record.position[1] = pose.position.y;
+      record.position[2] = pose.position.z;
+      record.orientation[0] = pose.orientation.x;
+      record.orientation[1] = pose.orientation.y;
+      record.orientation[2] = pose.orientation.z;
+      record.orientation[3] = pose.orientation.w;
+      const auto &twist = msg.twist.twist;
+      record.linear[0] = twist.linear.x;
+      record.linear[1] = twist.linear.y;
+      record.linear[2] = twist.linear.z;
+      record.angular[0] = twist.angular.x;
+      record.angular[1] = twist.angular.y;
+      record.angular[2] = twist.angular.z;
+      std::copy(msg.pose.covariance.begin(), msg.pose.covariance.end(), record.pose_covariance);
+      std::copy(msg.twist.covariance.begin(), msg.twist.covariance.end(), record.twist_covariance);
+      return record;
+    }
+
+    static nav_msgs::msg::Odometry fromRecord(const CachedOdometryRecord &record) {
+      nav_msgs::msg::Odometry msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.child_frame_id = cacheString(record.child_frame_id, CacheFrameIdSize);
+      auto &pose = msg.pose.pose;
+      pose.position.x = record.position[0];
+      pose.position.y = record.position[1];
+      pose.position.z = record.position[2];
+      pose.orientation.x = record.orientation[0];
+      pose.orientation.y = record.orientation[1];
+      pose.orientation.z = record.orientation[2];
+      pose.orientation.w = record.orientation[3];
+      auto &twist = msg.twist.twist;
+      twist.linear.x = record.linear[0];
+      twist.linear.y = record.linear[1];
+      twist.linear.z = record.linear[2];
+      twist.angular.x = record.angular[0];
+      twist.angular.y = record.angular[1];
+      twist.angular.z = record.angular[2];
+      std::copy_n(record.pose_covariance, 36, msg.pose.covariance.begin());
+      std::copy_n(record.twist_covariance, 36, msg.twist.covariance.begin());
+      return msg;
+    }
+  };
+
+  template<>
+  struct CacheTraits<geometry_msgs::msg::PoseStamped>
+    : FixedRecordCacheTraits<geometry_msgs::msg::PoseStamped, CachedPoseStampedRecord,
+      CacheTraits<geometry_msgs::msg::PoseStamped>> {
+    static CachedPoseStampedRecord toRecord(const rclcpp::Time &time, const geometry_msgs::msg::PoseStamped &msg) {
+      CachedPoseStampedRecord record{};
+      record.header = toCachedHeader(time, msg.header);
+      record.position[0] = msg.pose.position.x;
+      record.position[1] = msg.pose.position.y;
+      record.position[2] = msg.pose.position.z;
+      record.orientation[0] = msg.pose.orientation.x;
+      record.orientation[1] = msg.pose.orientation.y;
+      record.orientation[2] = msg.pose.orientation.z;
+      record.orientation[3] = msg.pose.orientation.w;
+      return record;
+    }
+
+    static geometry_msgs::msg::PoseStamped fromRecord(const CachedPoseStampedRecord &record) {
+      geometry_msgs::msg::PoseStamped msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.pose.position.x = record.position[0];
+      msg.pose.position.y = record.position[1];
+      msg.pose.position.z = record.position[2];
+      msg.pose.orientation.x = record.orientation[0];
+      msg.pose.orientation.y = record.orientation[1];
+      msg.pose.orientation.z = record.orientation[2];
+      msg.pose.orientation.w = record.orientation[3];
+      return msg;
+    }
+  };
+
+  template<>
+  struct CacheTraits<boreas_msgs::msg::SensorPose>
+    : FixedRecordCacheTraits<boreas_msgs::msg::SensorPose, CachedSensorPoseRecord,
+      CacheTraits<boreas_msgs::msg::SensorPose>> {
+    static CachedSensorPoseRecord toRecord(const rclcpp::Time &time, const boreas_msgs::msg::SensorPose &msg) {
+      CachedSensorPoseRecord record{};
+      record.header = toCachedHeader(time, msg.header);
+      record.values[0] = msg.gps_timestamp;
+      record.values[1] = msg.pos_easting;
+      record.values[2] = msg.pos_northing;
+      record.values[3] = msg.pos_altitude;
+      record.values[4] = msg.vel_north;
+      record.values[5] = msg.vel_east;
+      record.values[6] = msg.vel_up;
+      record.values[7] = msg.roll;
+      record.values[8] = msg.pitch;
+      record.values[9] = msg.heading;
+      record.values[10] = msg.ang_vel_x;
+      record.values[11] = msg.ang_vel_y;
+      record.values[12] = msg.ang_vel_z;
+      return record;
+    }
+
+    static boreas_msgs::msg::SensorPose fromRecord(const CachedSensorPoseRecord &record) {
+      boreas_msgs::msg::SensorPose msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.gps_timestamp = record.values[0];
+      msg.pos_easting = record.values[1];
+      msg.pos_northing = record.values[2];
+      msg.pos_altitude = record.values[3];
+      msg.vel_north = record.values[4];
+      msg.vel_east = record.values[5];
+      msg.vel_up = record.values[6];
+      msg.roll = record.values[7];
+      msg.pitch = record.values[8];
+      msg.heading = record.values[9];
+      msg.ang_vel_x = record.values[10];
+      msg.ang_vel_y = record.values[11];
+      msg.ang_vel_z = record.values[12];
+      return msg;
+    }
+  };
+
+  template<>
+  struct CacheTraits<sensor_msgs::msg::PointCloud2> {
+    static constexpr bool cacheable = true;
+    typedef std::vector<std::pair<rclcpp::Time, sensor_msgs::msg::PointCloud2>> Messages;
+
+    static std::string columnName(const std::string &topic) { return topic; }
+
+    static std::string fieldColumnName(const std::string &topic) { return topic + "#fields"; }
+
+    static std::string dataColumnName(const std::string &topic) { return topic + "#data"; }
+
+    // the point data is streamed into the byte column, only the small records are kept in memory
+    class ColumnWriter {
+    public:
+      ColumnWriter(DatasetCacheWriter &writer, std::string topic) : writer_(writer), topic_(std::move(topic)) {
+        writer_.beginBlob(dataColumnName(topic_));
+      }
+
+      void add(const rclcpp::Time &time, const sensor_msgs::msg::PointCloud2 &msg, int64_t bag_time_ns) {
+        CachedPointCloudRecord record{};
+        record.header = toCachedHeader(time, msg.header);
+        record.header.bag_time_ns = bag_time_ns;
+        record.height = msg.height;
+        record.width = msg.width;
+        record.point_step = msg.point_step;
+        record.row_step = msg.row_step;
+        record.is_bigendian = msg.is_bigendian;
+        record.is_dense = msg.is_dense;
+        record.field_begin = static_cast<uint32_t>(fields_.size());
+        record.num_fields = static_cast<uint32_t>(msg.fields.size());
+        for (const auto &field: msg.fields) {
+          CachedPointFieldRecord field_record{};
+          copyCacheString(field.name, field_record.name, CacheFrameIdSize);
+          field_record.offset = field.offset;
+          field_record.datatype = field.datatype;
+          field_record.count = field.count;
+          fields_.emplace_back(field_record);
+        }
+        record.data_size = msg.data.size();
+        record.data_offset = writer_.appendBlob(msg.data.data(), msg.data.size());
+        records_.emplace_back(record);
+      }
+
+      void finish() {
+        writer_.endBlob();
+        writer_.writeColumn(fieldColumnName(topic_), fields_);
+        writer_.writeColumn(columnName(topic_), records_);
+      }
+
+    private:
+      DatasetCacheWriter &writer_;
+      std::string topic_;
+      std::vector<CachedPointCloudRecord> records_;
+      std::vector<CachedPointFieldRecord> fields_;
+    };
+
+    static sensor_msgs::msg::PointCloud2 fromRecord(const CachedPointCloudRecord &record,
+                                                    std::span<const CachedPointFieldRecord> fields,
+                                                    std::span<const uint8_t> data) {
+      sensor_msgs::msg::PointCloud2 msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.height = record.height;
+      msg.width = record.width;
+      msg.point_step = record.point_step;
+      msg.row_step = record.row_step;
+      msg.is_bigendian = record.is_bigendian;
+      msg.is_dense = record.is_dense;
+      for (const auto &field_record: fields.subspan(record.field_begin, record.num_fields)) {
+        sensor_msgs::msg::PointField field;
+        field.name = cacheString(field_record.name, CacheFrameIdSize);
+        field.offset = field_record.offset;
+        field.datatype = field_record.datatype;
+        field.count = field_record.count;
+        msg.fields.emplace_back(std::move(field));
+      }
+      const auto payload = data.subspan(record.data_offset, record.data_size);
+      msg.data.assign(payload.begin(), payload.end());
+      return msg;
+    }
+
+    static Messages read(const DatasetCacheReader &reader, const std::string &topic) {
+      bool has_next;
+      int64_t resume_ns;
+      return readWindow(reader, topic, std::numeric_limits<int64_t>::min(), std::numeric_limits<double>::max(),
+                        has_next, resume_ns);
+    }
+
+    static Messages readWindow(const DatasetCacheReader &reader, const std::string &topic, int64_t bag_time_start_ns,
+                               double max_size, bool &has_next, int64_t &resume_ns) {
+      const auto records = reader.column<CachedPointCloudRecord>(columnName(topic));
+      const auto fields = reader.column<CachedPointFieldRecord>(fieldColumnName(topic));
+      const auto data = reader.blob(dataColumnName(topic));
+      Messages messages;
+      double memory_usage = 0.;
+      const CachedPointCloudRecord *last = nullptr;
+      auto iter = cacheLowerBound(records, bag_time_start_ns);
+      for (; iter != records.end() && !cacheWindowFull(last, *iter, memory_usage, max_size); iter++) {
+        messages.emplace_back(rclcpp::Time(iter->header.time_ns, RCL_ROS_TIME), fromRecord(*iter, fields, data));
+        memory_usage += iter->data_size * 1e-9;
+        last = &*iter;
+      }
+      has_next = iter != records.end();
+      resume_ns = last ? last->header.bag_time_ns + 1 : bag_time_start_ns;
+      return messages;
+    }
+  };
+
+  // compressed images: only the compressed payload is cached, the images are decoded by the consumer on access
+  template<>
+  struct CacheTraits<sensor_msgs::msg::CompressedImage> {
+    static constexpr bool cacheable = true;
+    typedef std::vector<std::pair<rclcpp::Time, sensor_msgs::msg::CompressedImage>> Messages;
+
+    static std::string columnName(const std::string &topic) { return topic; }
+
+    static std::string dataColumnName(const std::string &topic) { return topic + "#data"; }
+
+    class ColumnWriter {
+    public:
+      ColumnWriter(DatasetCacheWriter &writer, std::string topic) : writer_(writer), topic_(std::move(topic)) {
+        writer_.beginBlob(dataColumnName(topic_));
+      }
+
+      void add(const rclcpp::Time &time, const sensor_msgs::msg::CompressedImage &msg, int64_t bag_time_ns) {
+        CachedCompressedImageRecord record{};
+        record.header = toCachedHeader(time, msg.header);
+        record.header.bag_time_ns = bag_time_ns;
+        copyCacheString(msg.format, record.format, sizeof(record.format));
+        record.data_size = msg.data.size();
+        record.data_offset = writer_.appendBlob(msg.data.data(), msg.data.size());
+        records_.emplace_back(record);
+      }
+
+      void finish() {
+        writer_.endBlob();
+        writer_.writeColumn(columnName(topic_), records_);
+      }
+
+    private:
+      DatasetCacheWriter &writer_;
+      std::string topic_;
+      std::vector<CachedCompressedImageRecord> records_;
+    };
+
+    static sensor_msgs::msg::CompressedImage fromRecord(const CachedCompressedImageRecord &record,
+                                                        std::span<const uint8_t> data) {
+      sensor_msgs::msg::CompressedImage msg;
+      msg.header = fromCachedHeader(record.header);
+      msg.format = cacheString(record.format, sizeof(record.format));
+      const auto payload = data.subspan(record.data_offset, record.data_size);
+      msg.data.assign(payload.begin(), payload.end());
+      return msg;
+    }
+
+    static Messages read(const DatasetCacheReader &reader, const std::string &topic) {
+      bool has_next;
+      int64_t resume_ns;
+      return readWindow(reader, topic, std::numeric_limits<int64_t>::min(), std::numeric_limits<double>::max(),
+                        has_next, resume_ns);
+    }
+
+    static Messages readWindow(const DatasetCacheReader &reader, const std::string &topic, int64_t bag_time_start_ns,
+                               double max_size, bool &has_next, int64_t &resume_ns) {
+      const auto records = reader.column<CachedCompressedImageRecord>(columnName(topic));
+      const auto data = reader.blob(dataColumnName(topic));
+      Messages messages;
+      double memory_usage = 0.;
+      const CachedCompressedImageRecord *last = nullptr;
+      auto iter = cacheLowerBound(records, bag_time_start_ns);
+      for (; iter != records.end() && !cacheWindowFull(last, *iter, memory_usage, max_size); iter++) {
+        messages.emplace_back(rclcpp::Time(iter->header.time_ns, RCL_ROS_TIME), fromRecord(*iter, data));
+        memory_usage += iter->data_size * 1e-9;
+        last = &*iter;
+      }
+      has_next = iter != records.end();
+      resume_ns = last ? last->header.bag_time_ns + 1 : bag_time_start_ns;
+      return messages;
+    }
+  };
+}
+
+#endif //ONLINE_FGO_DATASETCACHE_H
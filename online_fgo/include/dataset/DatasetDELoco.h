@@ -32,6 +32,11 @@ namespace fgo::dataset {
   struct DELocoBatch : DataBatch
   {
     std::vector<GNSSMeasurement> gnss_obs_novatel;
+
+    void collect(MeasurementBatch &measurements) const override {
+      DataBatch::collect(measurements);
+      measurements.add(channel::GNSSObservation, gnss_obs_novatel);
+    }
   };
 
   struct DatasetDELoco : DatasetBase<PVASolution> {
@@ -51,7 +56,7 @@ namespace fgo::dataset {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), "OfflineFGO Dataset " << name << ": preparing dataset ...");
       pub_pvt_ = node.create_publisher<sensor_msgs::msg::NavSatFix>("/gt_nav_fix",
                                                                     rclcpp::SystemDefaultsQoS());
-      auto func_on_gt = [this](const std::vector<PVASolution> &data) -> void {
+      auto func_on_gt = [this](std::span<const PVASolution> data) -> void {
         for (const auto &pva: data) {
           sensor_msgs::msg::NavSatFix navfix;
           navfix.header.stamp = pva.timestamp;
@@ -70,9 +75,11 @@ namespace fgo::dataset {
                          "OfflineFGO Dataset " << name << ": Parsing raw data into data blocks ...");
       const auto raw_imu_msg = readROSMessages<sensor_msgs::msg::Imu>("/imu/data");
       DataBlock<IMUMeasurement>::DataMap imu_map;
+      IMUMessageTrackingState imu_tracking_state;
       for (const auto &time_msg_pair: raw_imu_msg) {
         imu_map.insert(
-            std::make_pair(time_msg_pair.first, msg2IMUMeasurement(time_msg_pair.second, time_msg_pair.first)));
+            std::make_pair(time_msg_pair.first, msg2IMUMeasurement(time_msg_pair.second, time_msg_pair.first,
+                                                                   imu_tracking_state)));
       }
       data_imu.setData(imu_map, true);
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), "OfflineFGO Dataset " << name << ": parsed IMU data ...");
@@ -95,12 +102,15 @@ namespace fgo::dataset {
       const auto raw_gnss = readROSMessages<irt_nav_msgs::msg::GNSSObsPreProcessed>(
           "/irt_gnss_preprocessing/gnss_obs_preprocessed");
       DataBlock<GNSSMeasurement>::DataMap gnss_map;
+      sensor::gnss::GNSSObservationTrackingState gnss_tracking_state;
       for (const auto &time_msg_pair: raw_gnss) {
         gnss_map.insert(std::make_pair(time_msg_pair.first,
-                                       sensor::gnss::convertGNSSObservationMsg(time_msg_pair.second, gnss_param_ptr)));
+                                       sensor::gnss::convertGNSSObservationMsg(time_msg_pair.second, gnss_param_ptr,
+                                                                               gnss_tracking_state)));
       }
       data_gnss.setData(gnss_map, true);
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"), "OfflineFGO Dataset " << name << ": parsed gnss data ...");
+      writeCache();
       setTimestampsFromReference();
       trimDataBlocks();
     }
@@ -117,7 +127,7 @@ namespace fgo::dataset {
     }
 
     data::State referenceToState(const PVASolution &reference) override {
-      static const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
+      const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
       return sensor::gnss::PVASolutionToState(reference, transReferenceFromBase.translation());
     }
 
@@ -126,10 +136,10 @@ namespace fgo::dataset {
       DELocoBatch batch;
       batch.timestamp_end = timestamp;
       const auto ros_timestamp = utils::secondsToROSTime(timestamp);
-      batch.imu = data_imu.getDataBefore(ros_timestamp, erase);
-      batch.reference_pva = data_reference.getDataBefore(ros_timestamp, erase);
-      batch.reference_state = data_reference_state.getDataBefore(ros_timestamp, erase);
-      batch.gnss_obs_novatel = data_gnss.getDataBefore(ros_timestamp, erase);
+      batch.imu = toVector(data_imu.getDataBefore(ros_timestamp, erase));
+      batch.reference_pva = toVector(data_reference.getDataBefore(ros_timestamp, erase));
+      batch.reference_state = toVector(data_reference_state.getDataBefore(ros_timestamp, erase));
+      batch.gnss_obs_novatel = toVector(data_gnss.getDataBefore(ros_timestamp, erase));
       return batch;
     }
 
@@ -139,10 +149,10 @@ namespace fgo::dataset {
       batch.timestamp_end = timestamp_end;
       const auto ros_timestamp_start = utils::secondsToROSTime(timestamp_start);
       const auto ros_timestamp_end = utils::secondsToROSTime(timestamp_end);
-      batch.imu = data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_pva = data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_state = data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.gnss_obs_novatel = data_gnss.getDataBetween(ros_timestamp_start, ros_timestamp_end);
+      batch.imu = toVector(data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_pva = toVector(data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_state = toVector(data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.gnss_obs_novatel = toVector(data_gnss.getDataBetween(ros_timestamp_start, ros_timestamp_end));
       return batch;
     }
   };
@@ -38,6 +38,9 @@ namespace fgo::dataset {
     bool autoLoading = false;
     double start_offset = 0.;
     double pre_defined_duration = 0.;
+    std::string cache_path;  // if given, the deserialized data are cached in this file to speed up later loads
+    bool cache_lazy_topics = false;  // also cache the lazily loaded point clouds and compressed images, large caches
+    double prefetch_lookahead = 5.;  // [s] lazily loaded topics are loaded this far ahead in the background, 0 disables
 
     std::map<std::string, fgo::data::DataType> topic_type_map;
 
@@ -63,6 +66,15 @@ namespace fgo::dataset {
       ::utils::RosParameter<double> pre_defined_duration_(dataset_name + ".preDefinedDuration", node);
       this->pre_defined_duration = pre_defined_duration_.value();
 
+      ::utils::RosParameter<std::string> cache_path_(dataset_name + ".cachePath", "", node);
+      this->cache_path = cache_path_.value();
+
+      ::utils::RosParameter<bool> cache_lazy_topics_(dataset_name + ".cacheLazyTopics", false, node);
+      this->cache_lazy_topics = cache_lazy_topics_.value();
+
+      ::utils::RosParameter<double> prefetch_lookahead_(dataset_name + ".prefetchLookahead", 5., node);
+      this->prefetch_lookahead = prefetch_lookahead_.value();
+
     }
   };
 }
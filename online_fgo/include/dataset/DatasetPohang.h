@@ -40,6 +40,18 @@ namespace fgo::dataset {
     std::vector<State> gnss_state;
     std::vector<IMUMeasurement> imu_lidar_front;
     std::vector<sensor_msgs::msg::PointCloud2> lidar_front;
+
+    void collect(MeasurementBatch &measurements) const override {
+      DataBatch::collect(measurements);
+      measurements.add(channel::Baseline, baseline);
+      measurements.add(channel::StereoPair, stereo_pair);
+      measurements.add(channel::Infrared, infrared);
+      measurements.add(channel::Radar, radar);
+      measurements.add(channel::GNSS, gnss);
+      measurements.add(channel::GNSSState, gnss_state);
+      measurements.add(channel::LiDARIMU, imu_lidar_front);
+      measurements.add(channel::LiDAR, lidar_front);
+    }
   };
 
   /*
@@ -100,7 +112,7 @@ namespace fgo::dataset {
         data_imu_lidar_front("IMULiDARFront", "/lidar_front/imu/data", 0, IMUDataTimeGetter),
         data_infrared("InfraRed", "/infrared/image", 0, ROSMessageTimeGetter<cv_bridge::CvImage>),
         data_radar("Radar", "/radar/image", 0, ROSMessageTimeGetter<cv_bridge::CvImage>),
-        it(rclcpp::Node::SharedPtr(&node)),
+        it(rclcpp::Node::SharedPtr(&node, [](rclcpp::Node *) {})),  // the node is not owned by the dataset
         gnss_param_ptr(gnss_integrator_param) {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": preparing dataset ...");
@@ -113,7 +125,7 @@ namespace fgo::dataset {
       pub_lidar_front = node.create_publisher<sensor_msgs::msg::PointCloud2>("/pohang/lidar/front",
                                                                              rclcpp::SystemDefaultsQoS());
 
-      auto func_on_gnss = [this](const std::vector<PVASolution> &data) -> void {
+      auto func_on_gnss = [this](std::span<const PVASolution> data) -> void {
         for (const auto &pva: data) {
           sensor_msgs::msg::NavSatFix navfix;
           navfix.header.stamp = pva.timestamp;
@@ -125,7 +137,7 @@ namespace fgo::dataset {
       };
       data_reference.setCbOnData(func_on_gnss);
 
-      auto func_on_baseline = [this](const std::vector<Pose> &data) -> void {
+      auto func_on_baseline = [this](std::span<const Pose> data) -> void {
         for (const auto &p: data) {
           sensor_msgs::msg::NavSatFix navfix;
           const auto llh = utils::xyz2llh(p.pose.translation());
@@ -142,7 +154,7 @@ namespace fgo::dataset {
       pub_left_raw = it.advertise("pohang/zed/left", 1);
       pub_right_raw = it.advertise("pohang/zed/right", 1);
       pub_infrared = it.advertise("pohang/infrared", 1);
-      auto func_on_stereopair = [this](const std::vector<StereoPair> &pairs) -> void {
+      auto func_on_stereopair = [this](std::span<const StereoPair> pairs) -> void {
         for (const auto &pair: pairs) {
           if (pair.left)
             pub_left_raw.publish(pair.left->toImageMsg());
@@ -156,7 +168,7 @@ namespace fgo::dataset {
 
       auto func_load_stereo_data = [this](int64_t time_start_nanosec,
                                           double max_size,
-                                          const std::string &data_topic) -> std::tuple<bool, std::map<rclcpp::Time, StereoPair>> {
+                                          const std::string &data_topic) -> DataChunk<StereoPair> {
 
         std::map<rclcpp::Time, StereoPair> data_map;
         static std::string topic_left = "/stereo_cam/left_img/compressed";
@@ -196,13 +208,16 @@ namespace fgo::dataset {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": got stereo pairs done. Is bag finished? "
                                                  << (bag_bas_next ? "Yes" : "No"));
-        return {bag_bas_next, data_map};
+        return {bag_bas_next, data_map,
+                std::max(this->bagResumeAfter(left_raw, time_start_nanosec),
+                         this->bagResumeAfter(right_raw, time_start_nanosec))};
       };
       data_stereo_pair.setCbLoadData(func_load_stereo_data);
+      enablePrefetch(data_stereo_pair);
 
       auto func_load_cvImage_data = [this](int64_t time_start_nanosec,
                                             double max_size,
-                                            const std::string &data_topic) -> std::tuple<bool, std::map<rclcpp::Time, cv_bridge::CvImage>> {
+                                            const std::string &data_topic) -> DataChunk<cv_bridge::CvImage> {
         std::map<rclcpp::Time, cv_bridge::CvImage> data_map;
         bool bag_bas_next;
         const auto raw_buffer_map = this->reader_->readSinglePartialDataFromBag(data_topic,
@@ -217,27 +232,29 @@ namespace fgo::dataset {
         RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                            "OfflineFGO Dataset " << name << ": got " << data_topic << " done. Is bag finished? "
                                                  << (bag_bas_next ? "Yes" : "No"));
-        return {bag_bas_next, data_map};
+        return {bag_bas_next, data_map, this->bagResumeAfter(raw_buffer_map, time_start_nanosec)};
       };
 
 
-      auto func_on_infrared = [this](const std::vector<cv_bridge::CvImage> &images) -> void {
+      auto func_on_infrared = [this](std::span<const cv_bridge::CvImage> images) -> void {
         for (const auto &image: images) {
           //ToDo: @Jiandong, please adjust the color format in the infrared image in order to make it visualizable
           pub_infrared.publish(image.toImageMsg());
         }
       };
       data_infrared.setCbLoadData(func_load_cvImage_data);
+      enablePrefetch(data_infrared);
       data_infrared.setCbOnData(func_on_infrared);
 
-      auto func_on_radar = [this](const std::vector<cv_bridge::CvImage> &images) -> void {
+      auto func_on_radar = [this](std::span<const cv_bridge::CvImage> images) -> void {
         for (const auto &image: images)
           pub_radar.publish(image.toImageMsg());
       };
       data_radar.setCbLoadData(func_load_cvImage_data);
+      enablePrefetch(data_radar);
       data_radar.setCbOnData(func_on_radar);
 
-      auto func_on_pointcloud = [this](const std::vector<sensor_msgs::msg::PointCloud2> &pcs) -> void {
+      auto func_on_pointcloud = [this](std::span<const sensor_msgs::msg::PointCloud2> pcs) -> void {
         for (const auto &pc: pcs)
           pub_lidar_front->publish(pc);
       };
@@ -263,10 +280,12 @@ namespace fgo::dataset {
 
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": start converting ...");
-      static const auto transIMUFromBase = sensor_calib_manager_->getTransformationFromBase("imu");
+      const auto transIMUFromBase = sensor_calib_manager_->getTransformationFromBase("imu");
       DataBlock<IMUMeasurement>::DataMap imu_map;
+      IMUMessageTrackingState imu_tracking_state;
       for (const auto &time_msg_pair: raw_imu_msg) {
         imu_map.insert(std::make_pair(time_msg_pair.first, msg2IMUMeasurement(time_msg_pair.second, time_msg_pair.first,
+                                                                              imu_tracking_state,
                                                                               transIMUFromBase.rotation().matrix())));
       }
       data_imu.setData(imu_map, true);
@@ -279,7 +298,7 @@ namespace fgo::dataset {
       }
       data_baseline.setData(baseline_map, true);
 
-      static const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
+      const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
       DataBlock<PVASolution>::DataMap gps_map;
       DataBlock<State>::DataMap state_map;
       for (const auto &time_msg_pair: raw_gps_pvt_msg) {
@@ -301,16 +320,19 @@ namespace fgo::dataset {
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": parsed lidar front data ...");
 
-      static const auto transLiDARFrontIMUFromBase = sensor_calib_manager_->getTransformationFromBase("lidar_front_imu");
+      const auto transLiDARFrontIMUFromBase = sensor_calib_manager_->getTransformationFromBase("lidar_front_imu");
       DataBlock<IMUMeasurement>::DataMap imu_lidarfront_map;
+      IMUMessageTrackingState imu_lidarfront_tracking_state;
       for (const auto &time_msg_pair: raw_imu_lidarfront_msg) {
         imu_lidarfront_map.insert(std::make_pair(time_msg_pair.first, msg2IMUMeasurement(time_msg_pair.second, time_msg_pair.first,
+                                                                                         imu_lidarfront_tracking_state,
                                                                                          transLiDARFrontIMUFromBase.rotation().matrix())));
       }
       data_imu_lidar_front.setData(imu_lidarfront_map, true);
       RCLCPP_INFO_STREAM(rclcpp::get_logger("offline_process"),
                          "OfflineFGO Dataset " << name << ": parsed IMU data ...");
 
+      writeCache();
       setTimestampsFromReference();
       trimDataBlocks();
     }
@@ -327,7 +349,7 @@ namespace fgo::dataset {
     }
 
     data::State referenceToState(const PVASolution &reference) override {
-      static const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
+      const auto transReferenceFromBase = sensor_calib_manager_->getTransformationFromBase("reference");
       return sensor::gnss::PVASolutionToState(reference, transReferenceFromBase.translation());
     }
 
@@ -336,15 +358,15 @@ namespace fgo::dataset {
       PohangDataBatch batch;
       batch.timestamp_end = timestamp;
       const auto ros_timestamp = utils::secondsToROSTime(timestamp);
-      batch.imu = data_imu.getDataBefore(ros_timestamp, erase);
-      batch.reference_pva = data_reference.getDataBefore(ros_timestamp, erase);
-      batch.reference_state = data_reference_state.getDataBefore(ros_timestamp, erase);
-      batch.stereo_pair = data_stereo_pair.getDataBefore(ros_timestamp, erase);
-      batch.baseline = data_baseline.getDataBefore(ros_timestamp, erase);
-      batch.lidar_front = data_lidar_front.getDataBefore(ros_timestamp, erase);
-      batch.imu_lidar_front = data_imu_lidar_front.getDataBefore(ros_timestamp, erase);
-      batch.infrared = data_infrared.getDataBefore(ros_timestamp, erase);
-      batch.radar = data_radar.getDataBefore(ros_timestamp, erase);
+      batch.imu = toVector(data_imu.getDataBefore(ros_timestamp, erase));
+      batch.reference_pva = toVector(data_reference.getDataBefore(ros_timestamp, erase));
+      batch.reference_state = toVector(data_reference_state.getDataBefore(ros_timestamp, erase));
+      batch.stereo_pair = toVector(data_stereo_pair.getDataBefore(ros_timestamp, erase));
+      batch.baseline = toVector(data_baseline.getDataBefore(ros_timestamp, erase));
+      batch.lidar_front = toVector(data_lidar_front.getDataBefore(ros_timestamp, erase));
+      batch.imu_lidar_front = toVector(data_imu_lidar_front.getDataBefore(ros_timestamp, erase));
+      batch.infrared = toVector(data_infrared.getDataBefore(ros_timestamp, erase));
+      batch.radar = toVector(data_radar.getDataBefore(ros_timestamp, erase));
       return batch;
     }
 
@@ -354,15 +376,15 @@ namespace fgo::dataset {
       batch.timestamp_end = timestamp_end;
       const auto ros_timestamp_start = utils::secondsToROSTime(timestamp_start);
       const auto ros_timestamp_end = utils::secondsToROSTime(timestamp_end);
-      batch.imu = data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_pva = data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.reference_state = data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.stereo_pair = data_stereo_pair.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.baseline = data_baseline.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.lidar_front = data_lidar_front.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.imu_lidar_front = data_imu_lidar_front.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.infrared = data_infrared.getDataBetween(ros_timestamp_start, ros_timestamp_end);
-      batch.radar = data_radar.getDataBetween(ros_timestamp_start, ros_timestamp_end);
+      batch.imu = toVector(data_imu.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_pva = toVector(data_reference.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.reference_state = toVector(data_reference_state.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.stereo_pair = toVector(data_stereo_pair.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.baseline = toVector(data_baseline.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.lidar_front = toVector(data_lidar_front.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.imu_lidar_front = toVector(data_imu_lidar_front.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.infrared = toVector(data_infrared.getDataBetween(ros_timestamp_start, ros_timestamp_end));
+      batch.radar = toVector(data_radar.getDataBetween(ros_timestamp_start, ros_timestamp_end));
       return batch;
     }
   };
@@ -60,6 +60,8 @@ namespace fgo::factor {
     ConstAngularVelocity = 34,
     ConstAcceleration = 35,
     GPSingerMotionPrior = 36,
+    UWBRange = 37,
+    GPUWBRange = 38,
   };
 
   static const std::map<std::string, unsigned int> FactorNameIDMap =
@@ -94,6 +96,8 @@ namespace fgo::factor {
       {"GPInterpolatedDDPrDrFactor",             FactorTypeID::GPDDPRDR},
       {"ConstAngularRateFactor",                 FactorTypeID::ConstAngularVelocity},
       {"ConstAccelerationFactor",                FactorTypeID::ConstAcceleration},
+      {"UWBRangeFactor",                         FactorTypeID::UWBRange},
+      {"GPInterpolatedUWBRangeFactor",           FactorTypeID::GPUWBRange},
     };
 
 }
@@ -37,7 +37,6 @@
 #include "factor/FactorType.h"
 #include "factor/FactorTypeID.h"
 
-#include "third_party/matlab_utils.h"
 
 namespace fgo::factor {
   class PVTFactor : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Vector3, gtsam::Vector3> {
@@ -116,28 +115,29 @@ namespace fgo::factor {
         if (H3) *H3 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), Hdrho_p).finished();  // Shape 6 x 3
 
       } else if (velocityFrame_ == MeasurementFrame::NED) {
-        const auto nRe = gtsam::Rot3(fgo::utils::nedRe_Matrix(pos_ant));
-        eVel = nRe.rotate(vel_ant) - velMeasured_;
-        const auto jac = matlab_utils::jacobianECEF2NED(pos_ant, vel_ant);
+        const auto frame = fgo::utils::geodesy::ecef2Frame(pos_ant);
+        const gtsam::Matrix33 nRe = frame.nedRe();
+        eVel = nRe * vel_ant - velMeasured_;
+        // the local frame also moves with the antenna position
+        const gtsam::Matrix33 jacRef = fgo::utils::geodesy::nedRotateJacobianWrtRef(frame, vel_ant);
 
         if (H1)
-          *H1 = (gtsam::Matrix66() << Hpose_P + Hpose_r * Hpose_Pr, jac.block<3, 3>(0, 0) *
-                                                                    (Hdrho_t * Hpose_Pr + Hdrho_p)).finished();
-        if (H2) *H2 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), jac.block<3, 3>(0, 0)).finished();  // Shape 6 x 3
+          *H1 = (gtsam::Matrix66() << Hpose_P + Hpose_r * Hpose_Pr,
+                 jacRef * (Hpose_P + Hpose_r * Hpose_Pr) + nRe * (Hdrho_t * Hpose_Pr + Hdrho_p)).finished();
+        if (H2) *H2 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), nRe).finished();  // Shape 6 x 3
         if (H3)
-          *H3 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), jac.block<3, 3>(0, 0) *
-                                                               Hdrho_p).finished();  // Shape 6 x 3
+          *H3 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), nRe * Hdrho_p).finished();  // Shape 6 x 3
       } else {
-        const auto nRe = gtsam::Rot3(fgo::utils::enuRe_Matrix(pos_ant));
-        eVel = nRe.rotate(vel_ant) - velMeasured_;
-        const auto jac = matlab_utils::jacobianECEF2ENU(pos_ant, vel_ant);
+        const auto frame = fgo::utils::geodesy::ecef2Frame(pos_ant);
+        const gtsam::Matrix33 nRe = frame.enuRe();
+        eVel = nRe * vel_ant - velMeasured_;
+        const gtsam::Matrix33 jacRef = fgo::utils::geodesy::enuRotateJacobianWrtRef(frame, vel_ant);
         if (H1)
-          *H1 = (gtsam::Matrix66() << Hpose_P + Hpose_r * Hpose_Pr, jac.block<3, 3>(0, 0) *
-                                                                    (Hdrho_t * Hpose_Pr + Hdrho_p)).finished();
-        if (H2) *H2 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), jac.block<3, 3>(0, 0)).finished();  // Shape 6 x 3
+          *H1 = (gtsam::Matrix66() << Hpose_P + Hpose_r * Hpose_Pr,
+                 jacRef * (Hpose_P + Hpose_r * Hpose_Pr) + nRe * (Hdrho_t * Hpose_Pr + Hdrho_p)).finished();
+        if (H2) *H2 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), nRe).finished();  // Shape 6 x 3
         if (H3)
-          *H3 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), jac.block<3, 3>(0, 0) *
-                                                               Hdrho_p).finished();  // Shape 6 x 3
+          *H3 = (gtsam::Matrix63() << gtsam::Matrix33::Zero(), nRe * Hdrho_p).finished();  // Shape 6 x 3
       }
       return (gtsam::Vector6() << ePos, eVel).finished();
       //}
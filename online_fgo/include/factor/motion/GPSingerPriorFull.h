@@ -144,82 +144,52 @@ namespace fgo::factor {
 
         Matrix63 H1v, H1w, H2v, H2w;
         Matrix6 H1p, H2p;
-        Matrix_18_6 Hv1, Hv2, Hacc1, Hacc2;
-
         Vector6 v1, v2;
 
-        if (H2 || H3 || H4 || H6 || H7 || H8) {
+        if (H1 || H2 || H3 || H5 || H6 || H7) {
           v1 = convertVwWbToVbWb(vel1, omega1, pose1, &H1v, &H1w, &H1p);
           v2 = convertVwWbToVbWb(vel2, omega2, pose2, &H2v, &H2w, &H2p);
-          Hv1 = (Matrix_18_6() << -delta_t_ * Matrix6::Identity(), -Matrix6::Identity(), Matrix6::Zero()).finished();
-          Hacc1 = (Matrix_18_6() << -c1_, -c2_, -c3_).finished();
         } else {
           v1 = convertVwWbToVbWb(vel1, omega1, pose1);
           v2 = convertVwWbToVbWb(vel2, omega2, pose2);
         }
 
         const gtsam::Vector6 JinvVel2 = Jinv * v2;
-        const gtsam::Vector3 omegaJinvVel2 = JinvVel2.head(3), rho2JinvVel2 = JinvVel2.tail(3);
-        const gtsam::Matrix3 X = gtsam::skewSymmetric(omegaJinvVel2), Y = gtsam::skewSymmetric(rho2JinvVel2);
-        const gtsam::Matrix6 JinvVel2SkewMatrix = (gtsam::Matrix6() << X, gtsam::Matrix3::Zero(), Y, X).finished();
-        const gtsam::Vector3 omegaV2 = v2.head(3), rhoV2 = v2.tail(3);
-        const gtsam::Matrix3 XV2 = gtsam::skewSymmetric(omegaV2), YV2 = gtsam::skewSymmetric(rhoV2);
-        const gtsam::Matrix6 V2SkewMatrix = (gtsam::Matrix6() << XV2, gtsam::Matrix3::Zero(), YV2, XV2).finished();
-        const gtsam::Matrix3 XA2 = gtsam::skewSymmetric(acc2.head(3)), YA2 = gtsam::skewSymmetric(acc2.tail(3));
-        const gtsam::Matrix6 A2SkewMatrix = (gtsam::Matrix6() << XA2, gtsam::Matrix3::Zero(), YA2, XA2).finished();
-
-        if (H7 || H8) {
-          const gtsam::Vector6 JinvAccJ = Jinv * acc2;
-          const gtsam::Vector3 omegaAccJ = JinvVel2.head(3), rhoAccJ = JinvVel2.tail(3);
-          const gtsam::Matrix3 XAccJ = gtsam::skewSymmetric(omegaAccJ), YAccJ = gtsam::skewSymmetric(rhoAccJ);
-          const gtsam::Matrix6 JinvAccJSkewMatrix = (gtsam::Matrix6()
-            << XAccJ, gtsam::Matrix3::Zero(), YAccJ, XAccJ).finished();
-
-          Hv2 = (Matrix_18_6() << Matrix6::Zero(),
-            Jinv,
-            -0.5 * JinvAccJSkewMatrix + 0.5 * V2SkewMatrix * Jinv).finished();
-
-          Hacc2 = (Matrix_18_6() << Matrix6::Zero(), Matrix6::Zero(), Jinv).finished();
-        }
+        const gtsam::Matrix6 JinvVel2SkewMatrix = fgo::utils::curlyhat(JinvVel2);
 
-        gtsam::Matrix6 JdiffV2 = gtsam::Matrix6::Zero();
-        if ((H1 || H5) && calcJacobian_)
-          JdiffV2 = jacobianMethodNumercialDiff(rightJacobianPose3inv, r, v2);
+        if (H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8) {
+          const gtsam::Matrix6 V2SkewMatrix = fgo::utils::curlyhat(v2);
 
-        if (H1) {
-          gtsam::Matrix6 J_Ti = Hlogmap * Hcomp1 * Hinv;
-          gtsam::Matrix6 Jdiff_Ti = gtsam::Matrix6::Zero();
-          if (calcJacobian_) {
-            Jdiff_Ti = JdiffV2 * J_Ti;
+          // d(Jinv * v2)/dr and d(Jinv * acc2)/dr, vanishing if Jinv is approximated by the identity
+          Matrix6 JdiffV2 = Matrix6::Zero(), JdiffAcc2 = Matrix6::Zero();
+          if ((H1 || H5) && calcJacobian_) {
+            JdiffV2 = jacobianRightJacobianPose3inv(r, v2);
+            JdiffAcc2 = jacobianRightJacobianPose3inv(r, acc2);
           }
-          // JinvVel2SkewMatrix * v2 = - v2SkewMatrix * Jinv * V2
-          *H1 = (fgo::utils::Matrix_18_6() << J_Ti - delta_t_ * H1p,  //
-            Jdiff_Ti - H1p,
-            (0.25 * V2SkewMatrix * V2SkewMatrix + 0.5 * A2SkewMatrix) * J_Ti).finished();
-          // checked on 28th. Aug.
-        }
 
-        if (H2) *H2 = Hv1 * H1v;
-        if (H3) *H3 = Hv1 * H1w;
-        if (H4) *H4 = Hacc1;
-
-        if (H5) {
-          gtsam::Matrix6 J_Tj = Hlogmap * Hcomp2;
-          gtsam::Matrix6 Jdiff_Ti = gtsam::Matrix6::Zero();
-          if (calcJacobian_) {
-            Jdiff_Ti = JdiffV2 * J_Tj;
-          }
-          *H5 = (fgo::utils::Matrix_18_6() << J_Tj,
-            Jdiff_Ti + Jinv * H2p,
-            (0.25 * V2SkewMatrix * V2SkewMatrix + 0.5 * A2SkewMatrix) * J_Tj).finished();
+          // Jacobians of the error w.r.t. r, v1 and v2, -0.5 * JinvVel2SkewMatrix * v2 = 0.5 * V2SkewMatrix * Jinv * v2
+          const Matrix_18_6 Hr = (Matrix_18_6() << Matrix6::Identity(),
+            JdiffV2,
+            0.5 * V2SkewMatrix * JdiffV2 + JdiffAcc2).finished();
+          const Matrix_18_6 Hv1 = (Matrix_18_6() << -delta_t_ * Matrix6::Identity(),
+            -Matrix6::Identity(),
+            Matrix6::Zero()).finished();
+          const Matrix_18_6 Hv2 = (Matrix_18_6() << Matrix6::Zero(),
+            Jinv,
+            -0.5 * JinvVel2SkewMatrix + 0.5 * V2SkewMatrix * Jinv).finished();
+
+          if (H1) *H1 = Hr * Hlogmap * Hcomp1 * Hinv + Hv1 * H1p;
+          if (H2) *H2 = Hv1 * H1v;
+          if (H3) *H3 = Hv1 * H1w;
+          if (H4) *H4 = (Matrix_18_6() << -c1_, -c2_, -c3_).finished();
+          if (H5) *H5 = Hr * Hlogmap * Hcomp2 + Hv2 * H2p;
+          if (H6) *H6 = Hv2 * H2v;
+          if (H7) *H7 = Hv2 * H2w;
+          if (H8) *H8 = (Matrix_18_6() << Matrix6::Zero(), Matrix6::Zero(), Jinv).finished();
         }
 
-        if (H6) *H6 = Hv2 * H2v;
-        if (H7) *H7 = Hv2 * H2w;
-        if (H8) *H8 = Hacc2;   // Jacobian for the linear acc2
-
         return (gtsam::Vector(18) << (r - v1 * delta_t_ - c1_ * acc1),
-          Jinv * v2 - v1 - c2_ * acc1,
+          JinvVel2 - v1 - c2_ * acc1,
           -0.5 * JinvVel2SkewMatrix * v2 + Jinv * acc2 - c3_ * acc1).finished();
       }
     }
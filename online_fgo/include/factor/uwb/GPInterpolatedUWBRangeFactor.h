@@ -0,0 +1,261 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_GPINTERPOLATEDUWBRANGEFACTOR_H
+#define ONLINE_FGO_GPINTERPOLATEDUWBRANGEFACTOR_H
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/base/numericalDerivative.h>
+
+#include "model/gp_interpolator/GPInterpolatorBase.h"
+#include "include/factor/FactorType.h"
+#include "factor/FactorTypeID.h"
+
+/*Inputs:
+* Keys: pose of time i&j X(i)&X(j), velocity of time i&j V(i)&V(j), angular velocity of time i&j W(i)&W(j),
+ * position of the anchor, range bias of the anchor
+* Range measurement between the tag and the anchor: measRange
+* Position of the tag with respect to the Body: lb
+ * interpolator: GP interpolator between state i and j at the time of the measurement
+* Covariance Matrix of the measurement: model*/
+/* measurement equation used:
+ * Range = Distance of Anchor and interpolated Tag + Range bias of the anchor */
+/*Jacobian: for X(i/j), V(i/j), W(i/j) = e_AT * (Hpos + R_eb * skew(lb_)) * GPJacobian, anchor = -e_AT, bias = 1
+ * */
+
+namespace fgo::factor {
+
+  class GPInterpolatedUWBRangeFactor : public fgo::NoiseModelFactor8<gtsam::Pose3, gtsam::Vector3, gtsam::Vector3,
+    gtsam::Pose3, gtsam::Vector3, gtsam::Vector3, gtsam::Point3, gtsam::Vector1> {
+  private:
+    double measRange_{};
+    gtsam::Point3 lb_;  // lever arm between the base and the tag in body frame
+    double tau_{};
+    bool useAutoDiff_ = false;
+
+    typedef GPInterpolatedUWBRangeFactor This;
+    typedef fgo::NoiseModelFactor8<gtsam::Pose3, gtsam::Vector3, gtsam::Vector3, gtsam::Pose3, gtsam::Vector3,
+      gtsam::Vector3, gtsam::Point3, gtsam::Vector1> Interpolator;
+    typedef std::shared_ptr<fgo::models::GPInterpolator> GPBase;
+
+    // interpolator
+    GPBase GPbase_;
+  public:
+
+    GPInterpolatedUWBRangeFactor() = default; /* Default constructor */
+
+    GPInterpolatedUWBRangeFactor(gtsam::Key pose_i, gtsam::Key vel_i, gtsam::Key omega_i,
+                                 gtsam::Key pose_j, gtsam::Key vel_j, gtsam::Key omega_j,
+                                 gtsam::Key anchor, gtsam::Key bias,
+                                 const double &measRange, const gtsam::Point3 &lb,
+                                 const gtsam::SharedNoiseModel &model,
+                                 const std::shared_ptr<fgo::models::GPInterpolator> &interpolator,
+                                 bool useAutoDiff = false) :
+      Interpolator(model, pose_i, vel_i, omega_i, pose_j, vel_j, omega_j, anchor, bias), measRange_(measRange),
+      lb_(lb), tau_(interpolator->getTau()), useAutoDiff_(useAutoDiff), GPbase_(interpolator) {
+      factorTypeID_ = FactorTypeID::GPUWBRange;
+      factorName_ = "GPInterpolatedUWBRangeFactor";
+    }
+
+    ~GPInterpolatedUWBRangeFactor() override = default;
+
+    /// @return a deep copy of this factor
+    [[nodiscard]] gtsam::NonlinearFactor::shared_ptr clone() const override {
+      return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    /** factor error */
+    [[nodiscard]] gtsam::Vector
+    evaluateError(const gtsam::Pose3 &pose1, const gtsam::Vector3 &vel1, const gtsam::Vector3 &omega1,
+                  const gtsam::Pose3 &pose2, const gtsam::Vector3 &vel2, const gtsam::Vector3 &omega2,
+                  const gtsam::Point3 &anchor, const gtsam::Vector1 &bias,
+                  boost::optional<gtsam::Matrix &> H1 = boost::none,
+                  boost::optional<gtsam::Matrix &> H2 = boost::none,
+                  boost::optional<gtsam::Matrix &> H3 = boost::none,
+                  boost::optional<gtsam::Matrix &> H4 = boost::none,
+                  boost::optional<gtsam::Matrix &> H5 = boost::none,
+                  boost::optional<gtsam::Matrix &> H6 = boost::none,
+                  boost::optional<gtsam::Matrix &> H7 = boost::none,
+                  boost::optional<gtsam::Matrix &> H8 = boost::none) const override {
+      using namespace gtsam;
+
+      if (useAutoDiff_) {
+        if (H1)
+          *H1 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Pose3>(
+            boost::bind(&This::evaluateError_, this, boost::placeholders::_1, vel1, omega1, pose2, vel2, omega2,
+                        anchor, bias), pose1);
+        if (H2)
+          *H2 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Vector3>(
+            boost::bind(&This::evaluateError_, this, pose1, boost::placeholders::_1, omega1, pose2, vel2, omega2,
+                        anchor, bias), vel1);
+        if (H3)
+          *H3 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Vector3>(
+            boost::bind(&This::evaluateError_, this, pose1, vel1, boost::placeholders::_1, pose2, vel2, omega2,
+                        anchor, bias), omega1);
+        if (H4)
+          *H4 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Pose3>(
+            boost::bind(&This::evaluateError_, this, pose1, vel1, omega1, boost::placeholders::_1, vel2, omega2,
+                        anchor, bias), pose2);
+        if (H5)
+          *H5 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Vector3>(
+            boost::bind(&This::evaluateError_, this, pose1, vel1, omega1, pose2, boost::placeholders::_1, omega2,
+                        anchor, bias), vel2);
+        if (H6)
+          *H6 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Vector3>(
+            boost::bind(&This::evaluateError_, this, pose1, vel1, omega1, pose2, vel2, boost::placeholders::_1,
+                        anchor, bias), omega2);
+        if (H7)
+          *H7 = gtsam::numericalDerivative11<gtsam::Vector1, gtsam::Point3>(
+            boost::bind(&This::evaluateError_, this, pose1, vel1, omega1, pose2, vel2, omega2,
+                        boost::placeholders::_1, bias), anchor);
+        if (H8)
+          *H8 = gtsam::I_1x1;
+
+        return evaluateError_(pose1, vel1, omega1, pose2, vel2, omega2, anchor, bias);
+      } else {
+        gtsam::Matrix Hint1_P, Hint2_P, Hint3_P, Hint4_P, Hint5_P, Hint6_P;
+        gtsam::Pose3 pose;
+
+        if (H1 || H2 || H3 || H4 || H5 || H6) {
+          pose = GPbase_->interpolatePose(pose1, vel1, omega1, pose2, vel2, omega2,
+                                          Hint1_P, Hint2_P, Hint3_P, Hint4_P, Hint5_P, Hint6_P);
+        } else {
+          pose = GPbase_->interpolatePose(pose1, vel1, omega1, pose2, vel2, omega2);
+        }
+
+        gtsam::Matrix Hpose_P, Hpose_Pr;
+        gtsam::Matrix3 Hrho_p;
+        gtsam::Matrix13 Hd_tag, Hd_anchor;
+
+        const gtsam::Point3 P_eT_e = pose.translation(&Hpose_P) + pose.rotation(&Hpose_Pr).rotate(lb_, &Hrho_p);
+        const double range = gtsam::distance3(P_eT_e, anchor, &Hd_tag, &Hd_anchor);
+
+        if (H1 || H2 || H3 || H4 || H5 || H6) {
+          const gtsam::Matrix H_rho = Hd_tag * (Hpose_P + Hrho_p * Hpose_Pr);
+          if (H1) *H1 = H_rho * Hint1_P;
+          if (H2) *H2 = H_rho * Hint2_P;
+          if (H3) *H3 = H_rho * Hint3_P;
+          if (H4) *H4 = H_rho * Hint4_P;
+          if (H5) *H5 = H_rho * Hint5_P;
+          if (H6) *H6 = H_rho * Hint6_P;
+        }
+        if (H7) *H7 = Hd_anchor;
+        if (H8) *H8 = gtsam::I_1x1;
+
+        return (gtsam::Vector1() << range + bias(0) - measRange_).finished();
+      }
+    }
+
+    [[nodiscard]] gtsam::Vector
+    evaluateError_(const gtsam::Pose3 &pose1, const gtsam::Vector3 &vel1, const gtsam::Vector3 &omega1,
+                   const gtsam::Pose3 &pose2, const gtsam::Vector3 &vel2, const gtsam::Vector3 &omega2,
+                   const gtsam::Point3 &anchor, const gtsam::Vector1 &bias) const {
+      const gtsam::Pose3 pose = GPbase_->interpolatePose(pose1, vel1, omega1, pose2, vel2, omega2);
+      const gtsam::Point3 P_eT_e = pose.translation() + pose.rotation().rotate(lb_);
+      return (gtsam::Vector1() << gtsam::distance3(P_eT_e, anchor) + bias(0) - measRange_).finished();
+    }
+
+    /** lifting all related state values in a vector after the ordering for evaluateError **/
+    gtsam::Vector liftValuesAsVector(const gtsam::Values &values) override {
+      const auto poseI = values.at<gtsam::Pose3>(key1());
+      const auto velI = values.at<gtsam::Vector3>(key2());
+      const auto omegaI = values.at<gtsam::Vector3>(key3());
+      const auto poseJ = values.at<gtsam::Pose3>(key4());
+      const auto velJ = values.at<gtsam::Vector3>(key5());
+      const auto omegaJ = values.at<gtsam::Vector3>(key6());
+      const auto anchor = values.at<gtsam::Point3>(key7());
+      const auto bias = values.at<gtsam::Vector1>(key8());
+      const auto liftedStates = (gtsam::Vector(28) << poseI.rotation().rpy(),
+        poseI.translation(),
+        velI, omegaI,
+        poseJ.rotation().rpy(),
+        poseJ.translation(),
+        velJ, omegaJ, anchor, bias).finished();
+      return liftedStates;
+    }
+
+    gtsam::Values generateValuesFromStateVector(const gtsam::Vector &state) override {
+      assert(state.size() != 28);
+      gtsam::Values values;
+      try {
+        values.insert(key1(), gtsam::Pose3(gtsam::Rot3::RzRyRx(state.block<3, 1>(0, 0)),
+                                           gtsam::Point3(state.block<3, 1>(3, 0))));
+        values.insert(key2(), gtsam::Vector3(state.block<3, 1>(6, 0)));
+        values.insert(key3(), gtsam::Vector3(state.block<3, 1>(9, 0)));
+        values.insert(key4(), gtsam::Pose3(gtsam::Rot3::RzRyRx(state.block<3, 1>(12, 0)),
+                                           gtsam::Point3(state.block<3, 1>(15, 0))));
+        values.insert(key5(), gtsam::Vector3(state.block<3, 1>(18, 0)));
+        values.insert(key6(), gtsam::Vector3(state.block<3, 1>(21, 0)));
+        values.insert(key7(), gtsam::Point3(state.block<3, 1>(24, 0)));
+        values.insert(key8(), gtsam::Vector1(state.block<1, 1>(27, 0)));
+      }
+      catch (std::exception &ex) {
+        std::cout << "Factor " << getName() << " cannot generate values from state vector " << state << " due to "
+                  << ex.what() << std::endl;
+      }
+      return values;
+    }
+
+    /** return the measured */
+    [[nodiscard]] gtsam::Vector1 measured() const {
+      return gtsam::Vector1(measRange_);
+    }
+
+    /** equals specialized to this factor */
+    [[nodiscard]] bool equals(const gtsam::NonlinearFactor &expected, double tol = 1e-9) const override {
+      const This *e = dynamic_cast<const This *> (&expected);
+      return e != nullptr && Base::equals(*e, tol)
+             && gtsam::equal_with_abs_tol((gtsam::Vector1() << this->measRange_).finished(),
+                                          (gtsam::Vector1() << e->measRange_).finished(), tol);
+    }
+
+    /** print contents */
+    void print(const std::string &s = "",
+               const gtsam::KeyFormatter &keyFormatter = gtsam::DefaultKeyFormatter) const override {
+      std::cout << s << "GPInterpolatedUWBRangeFactor" << std::endl;
+      Base::print("", keyFormatter);
+    }
+
+  private:
+    /** Serialization function */
+    friend class boost::serialization::access;
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE &ar, const unsigned int version) {
+      ar & boost::serialization::make_nvp("GPInterpolatedUWBRangeFactor",
+                                          boost::serialization::base_object<Base>(*this));
+      ar & BOOST_SERIALIZATION_NVP(measRange_);
+    }
+  }; // GPInterpolatedUWBRangeFactor
+} //namespace
+
+/// traits
+namespace gtsam {
+  template<>
+  struct traits<fgo::factor::GPInterpolatedUWBRangeFactor> :
+    public Testable<fgo::factor::GPInterpolatedUWBRangeFactor> {
+  };
+}
+
+#endif //ONLINE_FGO_GPINTERPOLATEDUWBRANGEFACTOR_H
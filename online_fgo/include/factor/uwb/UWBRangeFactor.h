@@ -0,0 +1,182 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_UWBRANGEFACTOR_H
+#define ONLINE_FGO_UWBRANGEFACTOR_H
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/base/numericalDerivative.h>
+#include "factor/FactorTypeID.h"
+
+/*Inputs:
+* Keys: pose of time i X(i), position of the anchor, range bias of the anchor
+* Range measurement between the tag and the anchor: measRange
+* Position of the tag with respect to the Body: lb
+* Covariance Matrix of the measurement: model*/
+/* measurement equation used:
+ * Range = Distance of Anchor and Tag + Range bias of the anchor */
+/*Jacobian: for X(i) = (e_AT * R_eb * skew(lb_), e_AT * R_eb), anchor = -e_AT, bias = 1
+ * */
+
+namespace fgo::factor {
+  class UWBRangeFactor : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Point3, gtsam::Vector1> {
+
+  protected:
+    double measRange_{};
+    gtsam::Point3 lb_;  // lever arm between the base and the tag in body frame
+    typedef UWBRangeFactor This;
+    typedef gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Point3, gtsam::Vector1> Base;
+    bool useAutoDiff_ = false;
+
+  public:
+    UWBRangeFactor() = default;  /* Default constructor */
+
+    UWBRangeFactor(gtsam::Key pose_i, gtsam::Key anchor, gtsam::Key bias, const double &measRange,
+                   const gtsam::Point3 &lb, const gtsam::SharedNoiseModel &model, bool useAutoDiff = false) :
+      Base(model, pose_i, anchor, bias), measRange_(measRange), lb_(lb), useAutoDiff_(useAutoDiff) {
+      factorTypeID_ = FactorTypeID::UWBRange;
+      factorName_ = "UWBRangeFactor";
+    }
+
+    ~UWBRangeFactor() override = default;
+
+    /// @return a deep copy of this factor
+    [[nodiscard]] gtsam::NonlinearFactor::shared_ptr clone() const override {
+      return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+    }
+
+    [[nodiscard]] gtsam::Vector evaluateError(const gtsam::Pose3 &pose, const gtsam::Point3 &anchor,
+                                              const gtsam::Vector1 &bias,
+                                              boost::optional<gtsam::Matrix &> H1 = boost::none,
+                                              boost::optional<gtsam::Matrix &> H2 = boost::none,
+                                              boost::optional<gtsam::Matrix &> H3 = boost::none) const override {
+      if (useAutoDiff_) {
+        if (H1)
+          *H1 = gtsam::numericalDerivative31<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+            boost::bind(&This::evaluateError_, this, boost::placeholders::_1, boost::placeholders::_2,
+                        boost::placeholders::_3), pose, anchor, bias, 1e-5);
+        if (H2)
+          *H2 = gtsam::numericalDerivative32<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+            boost::bind(&This::evaluateError_, this, boost::placeholders::_1, boost::placeholders::_2,
+                        boost::placeholders::_3), pose, anchor, bias, 1e-5);
+        if (H3)
+          *H3 = gtsam::numericalDerivative33<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+            boost::bind(&This::evaluateError_, this, boost::placeholders::_1, boost::placeholders::_2,
+                        boost::placeholders::_3), pose, anchor, bias, 1e-5);
+        return evaluateError_(pose, anchor, bias);
+      } else {
+        gtsam::Matrix Hpose_P, Hpose_Pr;
+        gtsam::Matrix3 Hrho_p;
+        gtsam::Matrix13 Hd_tag, Hd_anchor;
+
+        const gtsam::Point3 P_eT_e = pose.translation(&Hpose_P) + pose.rotation(&Hpose_Pr).rotate(lb_, &Hrho_p);
+        const double range = gtsam::distance3(P_eT_e, anchor, &Hd_tag, &Hd_anchor);
+
+        if (H1) {
+          const gtsam::Matrix H1_rho = Hd_tag * (Hpose_P + Hrho_p * Hpose_Pr);
+          *H1 = (gtsam::Matrix16() << H1_rho).finished();
+        }
+        if (H2) *H2 = Hd_anchor;
+        if (H3) *H3 = gtsam::I_1x1;
+
+        return (gtsam::Vector1() << range + bias(0) - measRange_).finished();
+      }
+    }
+
+    [[nodiscard]] gtsam::Vector evaluateError_(const gtsam::Pose3 &pose, const gtsam::Point3 &anchor,
+                                               const gtsam::Vector1 &bias) const {
+      const gtsam::Point3 P_eT_e = pose.translation() + pose.rotation().rotate(lb_);
+      return (gtsam::Vector1() << gtsam::distance3(P_eT_e, anchor) + bias(0) - measRange_).finished();
+    }
+
+    /** lifting all related state values in a vector after the ordering for evaluateError **/
+    gtsam::Vector liftValuesAsVector(const gtsam::Values &values) override {
+      const auto pose = values.at<gtsam::Pose3>(key1());
+      const auto anchor = values.at<gtsam::Point3>(key2());
+      const auto bias = values.at<gtsam::Vector1>(key3());
+      const auto liftedStates = (gtsam::Vector(10) << pose.rotation().rpy(),
+        pose.translation(),
+        anchor,
+        bias).finished();
+      return liftedStates;
+    }
+
+    gtsam::Values generateValuesFromStateVector(const gtsam::Vector &state) override {
+      assert(state.size() != 10);
+      gtsam::Values values;
+      try {
+        values.insert(key1(), gtsam::Pose3(gtsam::Rot3::RzRyRx(state.block<3, 1>(0, 0)),
+                                           gtsam::Point3(state.block<3, 1>(3, 0))));
+        values.insert(key2(), gtsam::Point3(state.block<3, 1>(6, 0)));
+        values.insert(key3(), gtsam::Vector1(state.block<1, 1>(9, 0)));
+      }
+      catch (std::exception &ex) {
+        std::cout << "Factor " << getName() << " cannot generate values from state vector " << state << " due to "
+                  << ex.what() << std::endl;
+      }
+      return values;
+    }
+
+    /** return the measured */
+    [[nodiscard]] gtsam::Vector1 measured() const {
+      return gtsam::Vector1(measRange_);
+    }
+
+    /** equals specialized to this factor */
+    bool equals(const gtsam::NonlinearFactor &expected, double tol = 1e-9) const override {
+      const This *e = dynamic_cast<const This *> (&expected);
+      return e != nullptr && Base::equals(*e, tol)
+             && gtsam::equal_with_abs_tol((gtsam::Vector1() << this->measRange_).finished(),
+                                          (gtsam::Vector1() << e->measRange_).finished(), tol);
+    }
+
+    /** print contents */
+    void print(const std::string &s = "",
+               const gtsam::KeyFormatter &keyFormatter = gtsam::DefaultKeyFormatter) const override {
+      std::cout << s << "UWBRangeFactor" << std::endl;
+      Base::print("", keyFormatter);
+    }
+
+  private:
+
+    /** Serialization function */
+    friend class boost::serialization::access;
+
+    template<class ARCHIVE>
+    void serialize(ARCHIVE &ar, const unsigned int version) {
+      ar & boost::serialization::make_nvp("UWBRangeFactor",
+                                          boost::serialization::base_object<Base>(*this));
+      ar & BOOST_SERIALIZATION_NVP(measRange_);
+    }
+  }; // UWBRangeFactor
+} // namespace fgo::factor
+
+/// traits
+namespace gtsam {
+  template<>
+  struct traits<fgo::factor::UWBRangeFactor> : public Testable<fgo::factor::UWBRangeFactor> {
+  };
+}
+
+#endif //ONLINE_FGO_UWBRANGEFACTOR_H
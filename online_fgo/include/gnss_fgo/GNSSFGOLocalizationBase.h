@@ -123,12 +123,19 @@ namespace gnss_fgo
         fgo::data::CircularDataBuffer<fgo::data::State> fgoOptStateBuffer_;
         fgo::data::State lastOptimizedState_;
         fgo::data::State currentPredState_;
+        std::vector<fgo::data::State> errorStateCache_;  // states waiting for the reference to calculate errors
 
         // Sensor utils
         std::unique_ptr<gtsam::PreintegratedCombinedMeasurements> currentIMUPreintegrator_;
+        fgo::graph::IMUPreintegrationService::Ptr imuPreintegration_ =
+          std::make_shared<fgo::graph::IMUPreintegrationService>();
         boost::shared_ptr<gtsam::PreintegratedCombinedMeasurements::Params> preIntegratorParams_;
         std::unique_ptr<InitGyroBias> gyroBiasInitializer_;
         fgo::sensor::SensorCalibrationManager::Ptr sensorCalibManager_;
+        fgo::sensor::SensorHandle imuHandle_ = fgo::sensor::InvalidSensorHandle;
+        fgo::sensor::SensorHandle referenceHandle_ = fgo::sensor::InvalidSensorHandle;
+        rclcpp::Time lastIMUTime_{0, 0, RCL_ROS_TIME};
+        gtsam::Vector3 lastGyro_ = gtsam::Z_3x1;
 
         // ROS
         rclcpp::Subscription<sensor_msgs::msg::Imu>::SharedPtr subIMU_;
@@ -202,6 +209,12 @@ namespace gnss_fgo
          */
         double optimize();
 
+        /***
+         * called if the graph diverged in optimize(), resets the graph and lets the IMU callback trigger a new
+         * initialization
+         */
+        virtual void handleDivergence();
+
         /***
          * calculate error metrics online using (linear) interpolated GNSS PVA solution if RTK-fixed mode is given
          * may be implemented differently
@@ -209,6 +222,13 @@ namespace gnss_fgo
          */
         virtual void calculateErrorOnState(const fgo::data::State& stateIn);
 
+        /***
+         * called for every error sample calculated in calculateErrorOnState(), after it has been published.
+         * applications may override this to accumulate accuracy metrics without subscribing to the error topic
+         * @param error: error of the fgo state w.r.t. the interpolated reference
+         */
+        virtual void onErrorToReference(const irt_nav_msgs::msg::Error2GT& error) {}
+
         /***
          * bypass the conditional waiting in timeCentricFGOonIMU(), if the imu is used as the timing reference
          */
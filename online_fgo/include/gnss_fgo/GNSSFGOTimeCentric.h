@@ -42,6 +42,9 @@ namespace gnss_fgo {
 
     // tools
     std::unique_ptr<fgo::utils::MeasurementDelayCalculator> PVTDelayCalculator_;
+    double lastPVADelay_ = 0.;
+    rclcpp::Time lastPVATime_{0, 0, RCL_ROS_TIME};
+    bool firstPVAMeasurement_ = true;
 
     //std::atomic_bool isFirstGNSSIMUSynchronized_; // For opt. on IMU, we use this bool to
   protected: //private functions
@@ -19,6 +19,7 @@
 #define ONLINE_FGO_GRAPHBASE_H
 #pragma once
 
+#include <functional>
 #include <tuple>
 
 //boost
@@ -41,6 +42,7 @@
 #include <gtsam/nonlinear/ISAM2.h>
 //internal
 #include "graph/GraphUtils.h"
+#include "graph/IMUPreintegrationService.h"
 #include "graph/param/GraphParams.h"
 #include "factor/FactorTypeID.h"
 //#include "factor/inertial/MagFactor_eRb.h"
@@ -57,8 +59,10 @@
 #include "solver/FixedLagSmoother.h"
 #include "solver/BatchFixedLagSmoother.h"
 #include "solver/IncrementalFixedLagSmoother.h"
+#include "solver/FullBatchSmoother.h"
 #include "data/DataTypesFGO.h"
 #include "data/Buffer.h"
+#include "data/sampling/UncentedSampler.h"
 #include "utils/NavigationTools.h"
 #include "utils/ROSParameter.h"
 #include "utils/Pose3Utils.h"
@@ -115,6 +119,7 @@ namespace fgo::graph {
 
     std::shared_ptr<std::thread> pubResidualsThread_;
     boost::shared_ptr<gtsam::PreintegratedCombinedMeasurements::Params> preIntegratorParams_;
+    IMUPreintegrationService::Ptr imuPreintegration_;
     pluginlib::ClassLoader<fgo::integrator::IntegratorBase> integratorLoader_; ///< Plugin loader
     GraphParamBasePtr graphBaseParamPtr_;
     sensor::SensorCalibrationManager::Ptr sensorCalibManager_;
@@ -127,7 +132,10 @@ namespace fgo::graph {
     gtsam::Values values_;
     uint64_t nState_ = 0; //counter for states
     std::atomic_bool isStateInited_{};
+    std::atomic_bool isDiverged_{};
     std::unique_ptr<fgo::solvers::FixedLagSmoother> solver_;
+    std::function<std::unique_ptr<fgo::solvers::FixedLagSmoother>()> solverFactory_;  // recreates the solver on reset
+    fgo::solvers::FullBatchSmoother::UniquePtr fullBatchSmoother_;  // only set for an offline full-batch pass
     fgo::data::CircularDataBuffer<fgo::data::State> fgoOptStateBuffer_;
     std::vector<fgo::data::IMUMeasurement> dataIMURest_;
 
@@ -139,6 +147,10 @@ namespace fgo::graph {
     fgo::data::CircularDataBuffer<std::pair<gtsam::Values, gtsam::Marginals>> resultMarginalBuffer_;
     gtsam::KeyVector relatedKeys_;
 
+    // sigma point generators per state dimension and the sigma point buffer, reused for the residual sampling
+    std::map<size_t, fgo::data::sampler::SigmaPoints::SharedPtr> residualSigmaPoints_;
+    gtsam::Matrix residualSigmaPointBuffer_;
+
     //lists
 
   protected: // protected functions
@@ -189,17 +201,18 @@ namespace fgo::graph {
     // TODO: @Haoming, move this to GNSSTCIntegrator
     inline void addConstDriftFactor(const gtsam::Key &cbd_i, const gtsam::Key &cbd_j, const double &dt,
                                     const gtsam::Vector2 &variance = gtsam::Vector2::Identity()) {
-      gtsam::Vector2 var;
+      gtsam::SharedNoiseModel noise_model_cbd;
       if (graphBaseParamPtr_->addEstimatedVarianceAfterInit)
-        var = variance;
+        noise_model_cbd = assignNoiseModel(graphBaseParamPtr_->noiseModelClockFactor,
+                                           variance,
+                                           graphBaseParamPtr_->robustParamClockFactor,
+                                           "ConstClockDriftFactor");
       else
-        var = gtsam::Vector2(std::pow(graphBaseParamPtr_->constBiasStd, 2),
-                             std::pow(graphBaseParamPtr_->constDriftStd, 2));
-
-      gtsam::SharedNoiseModel noise_model_cbd = assignNoiseModel(graphBaseParamPtr_->noiseModelClockFactor,
-                                                                 var,
-                                                                 graphBaseParamPtr_->robustParamClockFactor,
-                                                                 "ConstClockDriftFactor");
+        noise_model_cbd = assignConstantNoiseModel(graphBaseParamPtr_->noiseModelClockFactor,
+                                                   gtsam::Vector2(std::pow(graphBaseParamPtr_->constBiasStd, 2),
+                                                                  std::pow(graphBaseParamPtr_->constDriftStd, 2)),
+                                                   graphBaseParamPtr_->robustParamClockFactor,
+                                                   "ConstClockDriftFactor");
       this->emplace_shared<fgo::factor::ConstDriftFactor>(cbd_i, cbd_j, dt, noise_model_cbd);
     }
 
@@ -286,7 +299,10 @@ namespace fgo::graph {
      * @param params iSAM2 params
      */
     void initSolver(const gtsam::ISAM2Params &params) {
-      solver_ = std::make_unique<fgo::solvers::IncrementalFixedLagSmoother>(graphBaseParamPtr_->smootherLag, params);
+      solverFactory_ = [lag = graphBaseParamPtr_->smootherLag, params]() {
+        return std::make_unique<fgo::solvers::IncrementalFixedLagSmoother>(lag, params);
+      };
+      solver_ = solverFactory_();
     }
 
     /***
@@ -294,7 +310,41 @@ namespace fgo::graph {
      * @param batch params
      */
     void initSolver(const gtsam::LevenbergMarquardtParams &params) {
-      solver_ = std::make_unique<fgo::solvers::BatchFixedLagSmoother>(graphBaseParamPtr_->smootherLag, params);
+      solverFactory_ = [lag = graphBaseParamPtr_->smootherLag, params]() {
+        return std::make_unique<fgo::solvers::BatchFixedLagSmoother>(lag, params);
+      };
+      solver_ = solverFactory_();
+    }
+
+    /***
+     * record every graph extension for a full-batch optimization of the whole drive, see FullBatchSmoother
+     * @param params
+     */
+    void enableFullBatchSmoothing(const fgo::solvers::FullBatchSmootherParams &params) {
+      fullBatchSmoother_ = std::make_unique<fgo::solvers::FullBatchSmoother>(params);
+    }
+
+    [[nodiscard]] bool isFullBatchSmoothingEnabled() const { return fullBatchSmoother_ != nullptr; }
+
+    /***
+     * solve the graph recorded since enableFullBatchSmoothing() in one batch
+     * @return optimized values of all recorded variables, empty if the full-batch smoothing is disabled
+     */
+    gtsam::Values optimizeFullBatch() {
+      return fullBatchSmoother_ ? fullBatchSmoother_->optimize() : gtsam::Values();
+    }
+
+    [[nodiscard]] fgo::solvers::FixedLagSmoother::KeyTimestampMap getFullBatchKeyTimestamps() const {
+      return fullBatchSmoother_ ? fullBatchSmoother_->keyTimestamps() : fgo::solvers::FixedLagSmoother::KeyTimestampMap();
+    }
+
+    /***
+     * share the IMU preintegration of the application, the graph pulls the preintegrated segments between its states
+     * from it instead of integrating the IMU measurements again
+     * @param imuPreintegration
+     */
+    void setIMUPreintegrationService(IMUPreintegrationService::Ptr imuPreintegration) {
+      imuPreintegration_ = std::move(imuPreintegration);
     }
 
     /***
@@ -342,6 +392,40 @@ namespace fgo::graph {
       relatedKeys_.clear();
     }
 
+    /***
+     * bring the graph back to its state before initGraph() to restart the estimation after a divergence: the temporary
+     * graph, the solver, the state counter, the IMU preintegration and the working state carried from one graph
+     * extension to the next, including the state of all integrators. Must not be called while the graph is being
+     * constructed or optimized.
+     */
+    virtual void reset() {
+      isStateInited_ = false;
+      isDiverged_ = false;
+      this->resetGraph();
+      nState_ = 0;
+      currentKeyIndexTimestampMap_.clear();
+      if (solverFactory_)
+        solver_ = solverFactory_();
+      if (imuPreintegration_)
+        imuPreintegration_->reset();
+      dataIMURest_.clear();
+      fgoOptStateBuffer_.clean();
+      referenceSensorTimestampBuffer_.clean();
+      referenceStateBuffer_.clean();
+      accBuffer_.clean();
+      currentPredictedBuffer_.clean();
+      factorBuffer_.clean();
+      resultMarginalBuffer_.clean();
+      for (const auto &integrator: integratorMap_)
+        integrator.second->reset();
+    }
+
+    /***
+     * @return true if the last optimization failed or ended in a non-finite state, the graph must be reset and
+     * initialized again
+     */
+    [[nodiscard]] bool isDiverged() const { return isDiverged_; }
+
     [[nodiscard]] const gtsam::Values &getValues() const { return values_; }
 
     [[nodiscard]] fgo::solvers::FixedLagSmoother::KeyTimestampMap &getNewKeyTimestampMap() { return keyTimestampMap_; }
@@ -362,10 +446,14 @@ namespace fgo::graph {
       return referenceStateBuffer_.get_all_buffer_and_clean();
     };
 
+    [[nodiscard]] std::vector<std::pair<rclcpp::Time, fgo::data::State>> getPredictedStates() {
+      return currentPredictedBuffer_.get_all_time_buffer_pair();
+    };
+
     /**
-    * Get an integrator pointer of base class that can be reinterpreted as the target integrator
+    * Get an integrator pointer of base class, use getIntegrator<IntegratorType>() to access the derived integrator
     * @param name
-    * @return
+    * @return nullptr if no integrator with this name is loaded
     */
     [[nodiscard]] std::shared_ptr<integrator::IntegratorBase> getIntegrator(const std::string &name) {
       auto iter = integratorMap_.find(name);
@@ -375,6 +463,18 @@ namespace fgo::graph {
         return nullptr;
     }
 
+    /**
+    * Get an integrator as the target integrator type, the type is checked at runtime
+    * @param name
+    * @return nullptr if no integrator with this name is loaded or the integrator is of another type
+    */
+    template<typename IntegratorType>
+    [[nodiscard]] std::shared_ptr<IntegratorType> getIntegrator(const std::string &name) {
+      return std::dynamic_pointer_cast<IntegratorType>(getIntegrator(name));
+    }
+
+    [[nodiscard]] const fgo::integrator::IntegratorMap &getIntegrators() const { return integratorMap_; }
+
     [[nodiscard]] bool isGraphInitialized() const { return isStateInited_; };
 
     /***
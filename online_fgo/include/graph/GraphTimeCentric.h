@@ -31,6 +31,19 @@ namespace fgo::graph
         GraphTimeCentricParamPtr paramPtr_;
         rclcpp::Publisher<irt_nav_msgs::msg::SensorProcessingReport>::SharedPtr pubIMUFactorReport_;
 
+    protected:
+        /*
+         * working state carried between the graph extensions, cleared in reset()
+         */
+        boost::circular_buffer<std::pair<double, gtsam::Vector3>> timeGyroMap_;
+        boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> stateIDAccMap_;
+        gtsam::Vector6 lastAcc_ = gtsam::Vector6::Zero();
+        gtsam::Vector3 meanAccG_ = gtsam::Vector3::Zero();
+        uint64_t lastNState_ = 0;
+        bool skippedOpt_ = false;
+        double noOptimizationDuration_ = 0.;
+        rclcpp::Time firstNoOptimizationDecision_;
+
     public:
         typedef std::shared_ptr<GraphTimeCentric> Ptr;
 
@@ -53,6 +66,8 @@ namespace fgo::graph
 
 
         double optimize(fgo::data::State& new_state) override;
+
+        void reset() override;
     };
 }
 
@@ -24,6 +24,7 @@
 #include <rclcpp/rclcpp.hpp>
 #include <gtsam/linear/NoiseModel.h>
 #include "data/DataTypesFGO.h"
+#include "graph/NoiseModelPool.h"
 
 namespace fgo::graph {
 
@@ -66,7 +67,8 @@ namespace fgo::graph {
   }
 
   /***
-   *
+   * get a noise model of measurement specific variances from the NoiseModelPool. The variances are quantized, so that
+   * factors of similar variances share one model
    * @param modeType
    * @param variance
    * @param robustParam
@@ -77,36 +79,53 @@ namespace fgo::graph {
                                                   const gtsam::Vector &variance,
                                                   double robustParam,
                                                   const std::string &factor = "") {
-    gtsam::SharedNoiseModel model = gtsam::noiseModel::Diagonal::Variances(variance);
-    switch (modeType) {
-      case fgo::data::NoiseModel::GAUSSIAN: {
-        return model;
-      }
-      case fgo::data::NoiseModel::CAUCHY: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::Cauchy::Create(robustParam), model);
-      }
-      case fgo::data::NoiseModel::HUBER: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::Huber::Create(robustParam), model);
-      }
-      case fgo::data::NoiseModel::DCS: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::DCS::Create(robustParam), model);
-      }
-      case fgo::data::NoiseModel::Tukey: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::Tukey::Create(robustParam), model);
-      }
-      case fgo::data::NoiseModel::GemanMcClure: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::GemanMcClure::Create(robustParam),
-                                                 model);
-      }
-      case fgo::data::NoiseModel::Welsch: {
-        return gtsam::noiseModel::Robust::Create(gtsam::noiseModel::mEstimator::Welsch::Create(robustParam), model);
-      }
-      default: {
-        RCLCPP_WARN(rclcpp::get_logger("gnss_fgo"), "UNKNOWN noise model for factor %s", factor.c_str());
-        return model;
-      }
-    }
+    bool known = true;
+    auto model = NoiseModelPool::instance().getQuantizedNoiseModel(modeType, variance, robustParam, known);
+    if (!known)
+      RCLCPP_WARN(rclcpp::get_logger("gnss_fgo"), "UNKNOWN noise model for factor %s", factor.c_str());
+    return model;
+  }
+
+  /***
+   * get a noise model of constant variances, e.g. given in the parameters, from the NoiseModelPool. Factors with equal
+   * kernel and variances share one model
+   * @param modeType
+   * @param variance
+   * @param robustParam
+   * @param factor
+   * @return
+   */
+  inline gtsam::SharedNoiseModel assignConstantNoiseModel(fgo::data::NoiseModel modeType,
+                                                          const gtsam::Vector &variance,
+                                                          double robustParam,
+                                                          const std::string &factor = "") {
+    bool known = true;
+    auto model = NoiseModelPool::instance().getConstantNoiseModel(modeType, variance, robustParam, known);
+    if (!known)
+      RCLCPP_WARN(rclcpp::get_logger("gnss_fgo"), "UNKNOWN noise model for factor %s", factor.c_str());
+    return model;
+  }
 
+  /***
+   * get a noise model with a full information matrix, e.g. of a registration. These models are specific to one
+   * measurement and are not pooled, only the m-estimator is shared
+   * @param modeType
+   * @param information positive definite information matrix
+   * @param robustParam
+   * @param factor
+   * @return
+   */
+  inline gtsam::SharedNoiseModel assignNoiseModelFromInformation(fgo::data::NoiseModel modeType,
+                                                                 const gtsam::Matrix &information,
+                                                                 double robustParam,
+                                                                 const std::string &factor = "") {
+    gtsam::SharedNoiseModel model = gtsam::noiseModel::Gaussian::Information(information);
+    const auto estimator = NoiseModelPool::instance().getMEstimator(modeType, robustParam);
+    if (estimator)
+      model = gtsam::noiseModel::Robust::Create(estimator, model);
+    else if (modeType != fgo::data::NoiseModel::GAUSSIAN)
+      RCLCPP_WARN(rclcpp::get_logger("gnss_fgo"), "UNKNOWN noise model for factor %s", factor.c_str());
+    return model;
   }
 
 
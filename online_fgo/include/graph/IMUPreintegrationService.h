@@ -0,0 +1,146 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_IMUPREINTEGRATIONSERVICE_H
+#define ONLINE_FGO_IMUPREINTEGRATIONSERVICE_H
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <gtsam/navigation/CombinedImuFactor.h>
+
+#include "data/DataTypesFGO.h"
+
+namespace fgo::graph {
+
+  /***
+   * IMU preintegration shared by the IMU propagation and the graph construction. Every IMU measurement is integrated
+   * once into the segment of the state grid (origin + k * period) it falls into: segment k holds the measurements with
+   * timestamps in [origin + (k - 1) * period, origin + k * period), which is the same assignment the time-centric
+   * graph uses for its IMU factors. The graph pulls the preintegrated segment between two states instead of
+   * integrating the measurements again, and the propagation predicts the current state by chaining the segments
+   * after the last optimized state.
+   *
+   * When a new bias estimate arrives with setAnchor(), the segments before the anchor are dropped and the few
+   * segments after it are re-integrated once with the new bias, as the propagation did before.
+   */
+  class IMUPreintegrationService {
+  public:
+    typedef std::shared_ptr<IMUPreintegrationService> Ptr;
+    static constexpr size_t MaxSegments = 1000;      // bounds the memory if no new anchor arrives
+    static constexpr double GridTolerance = 1e-6;    // [s]
+
+    /***
+     * drop all measurements and start a new state grid
+     * @param params preintegration params shared with the graph
+     * @param bias bias to integrate the measurements with
+     * @param gridOrigin timestamp of the first state [s]
+     * @param gridPeriod time between two states [s]
+     * @param measurements measurements received before the initialization, measurements before the grid origin are
+     *                     integrated into the first segment
+     */
+    void initialize(const boost::shared_ptr<gtsam::PreintegratedCombinedMeasurements::Params> &params,
+                    const gtsam::imuBias::ConstantBias &bias,
+                    double gridOrigin,
+                    double gridPeriod,
+                    const std::vector<fgo::data::IMUMeasurement> &measurements = {});
+
+    /***
+     * integrate a measurement into its segment, measurements which are not newer than the last one are ignored
+     * @param meas
+     */
+    void addMeasurement(const fgo::data::IMUMeasurement &meas);
+
+    /***
+     * move the anchor to the last optimized state: drops the segments before the anchor and re-integrates the
+     * remaining ones with the new bias. If the anchor is not on the state grid, the grid is moved to start at the anchor.
+     * @param timestamp timestamp of the last optimized state [s]
+     * @param bias optimized bias
+     */
+    void setAnchor(double timestamp, const gtsam::imuBias::ConstantBias &bias);
+
+    /***
+     * predict the state at the newest measurement by chaining the segments after the anchor
+     * @param anchorState optimized state at the anchor
+     * @param bias optimized bias at the anchor
+     * @return predicted state
+     */
+    [[nodiscard]] gtsam::NavState predict(const gtsam::NavState &anchorState,
+                                          const gtsam::imuBias::ConstantBias &bias) const;
+
+    /***
+     * get the preintegrated measurements between two states on the grid. If states were skipped, the segments in
+     * between are merged. The segments are marked as consumed, so measurements arriving late for them are integrated
+     * into the next segment, as they are in the graph.
+     * @param start timestamp of state i [s]
+     * @param end timestamp of state j [s]
+     * @param pim preintegrated measurements including the bias Jacobians
+     * @return false if the states are not on the grid or the segments were dropped already
+     */
+    bool getSegment(double start, double end, gtsam::PreintegratedCombinedMeasurements &pim);
+
+    /***
+     * @return the newest integrated measurement or nullopt if there is none
+     */
+    [[nodiscard]] std::optional<fgo::data::IMUMeasurement> lastMeasurement() const;
+
+    [[nodiscard]] bool isInitialized() const;
+
+    void reset();
+
+  private:
+    struct Sample {
+      double timestamp;
+      double dt;
+      gtsam::Vector3 accLin;
+      gtsam::Vector3 gyro;
+    };
+
+    struct Segment {
+      int64_t index;
+      gtsam::PreintegratedCombinedMeasurements pim;
+      std::vector<Sample> samples;
+    };
+
+    [[nodiscard]] double gridTime(int64_t index) const { return gridOrigin_ + double(index) * gridPeriod_; }
+
+    [[nodiscard]] int64_t segmentIndexOf(double timestamp) const;
+
+    Segment &segmentAt(int64_t index);
+
+    void integrate(Segment &segment, const Sample &sample);
+
+    void add(const fgo::data::IMUMeasurement &meas);
+
+    mutable std::mutex mutex_;
+    boost::shared_ptr<gtsam::PreintegratedCombinedMeasurements::Params> params_;
+    gtsam::imuBias::ConstantBias bias_;
+    double gridOrigin_ = 0.;
+    double gridPeriod_ = 0.;
+    int64_t firstOpenIndex_ = 1;            // segments before this index were consumed by the graph
+    std::deque<Segment> segments_;          // consecutive segment indices
+    std::optional<fgo::data::IMUMeasurement> lastMeasurement_;
+  };
+}
+
+#endif //ONLINE_FGO_IMUPREINTEGRATIONSERVICE_H
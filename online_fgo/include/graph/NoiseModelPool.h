@@ -0,0 +1,248 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_NOISEMODELPOOL_H
+#define ONLINE_FGO_NOISEMODELPOOL_H
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <gtsam/linear/NoiseModel.h>
+#include "data/DataTypesFGO.h"
+
+namespace fgo::graph {
+
+  /***
+   * Per-thread pool of immutable noise models and m-estimators. The factors only hold shared pointers to their noise
+   * models, so all factors with the same (kernel, robust parameter, variances) can share one instance. Models of
+   * constant variances, e.g. given in the parameters, are pooled as they are. Measurement specific variances, e.g. of
+   * pseudoranges weighted by the elevation, rarely repeat exactly, they are quantized to a relative grid first, so
+   * that factors of similar variances share one model.
+   * Every thread owns its pool, so the lookups take no lock, and the keys hold the variances inline without allocation.
+   */
+  class NoiseModelPool {
+  public:
+    // models of more dimensions are not pooled
+    static constexpr size_t MaxPooledDimension = 6;
+    // the constant models are few, the pool stops growing at this size if it is misused for varying variances
+    static constexpr size_t MaxPooledModels = 1024;
+    // mantissa bits kept by the quantization, the variances change by at most 2^-bits relative
+    static constexpr int QuantizedMantissaBits = 7;
+    // quantized models of all measurement types, the pool stops growing at this size
+    static constexpr size_t MaxQuantizedModels = 16384;
+
+    static NoiseModelPool &instance() {
+      thread_local NoiseModelPool pool;
+      return pool;
+    }
+
+    /***
+     * get the shared m-estimator of a robust kernel
+     * @param modelType kernel type, nullptr for GAUSSIAN or unknown kernels
+     * @param robustParam parameter of the kernel
+     * @return m-estimator
+     */
+    gtsam::noiseModel::mEstimator::Base::shared_ptr getMEstimator(fgo::data::NoiseModel modelType,
+                                                                  double robustParam) {
+      const EstimatorKey key{modelType, robustParam};
+      const auto iter = estimators_.find(key);
+      if (iter != estimators_.end())
+        return iter->second;
+      return estimators_.emplace(key, createMEstimator(modelType, robustParam)).first->second;
+    }
+
+    /***
+     * create a noise model of measurement specific variances, only the m-estimator is shared
+     * @param modelType kernel type
+     * @param variance diagonal variances
+     * @param robustParam parameter of the kernel
+     * @param known set to false if the kernel type is not known, the model is gaussian in this case
+     * @return noise model
+     */
+    gtsam::SharedNoiseModel createNoiseModel(fgo::data::NoiseModel modelType,
+                                             const gtsam::Vector &variance,
+                                             double robustParam,
+                                             bool &known) {
+      const auto estimator = getMEstimator(modelType, robustParam);
+      known = modelType == fgo::data::NoiseModel::GAUSSIAN || estimator;
+      gtsam::SharedNoiseModel model = gtsam::noiseModel::Diagonal::Variances(variance);
+      if (estimator)
+        model = gtsam::noiseModel::Robust::Create(estimator, model);
+      return model;
+    }
+
+    /***
+     * get the shared noise model of constant variances
+     * @param modelType kernel type
+     * @param variance diagonal variances
+     * @param robustParam parameter of the kernel
+     * @param known set to false if the kernel type is not known, the model is gaussian in this case
+     * @return noise model
+     */
+    gtsam::SharedNoiseModel getConstantNoiseModel(fgo::data::NoiseModel modelType,
+                                                  const gtsam::Vector &variance,
+                                                  double robustParam,
+                                                  bool &known) {
+      const auto dim = static_cast<size_t>(variance.size());
+      if (dim > MaxPooledDimension)
+        return createNoiseModel(modelType, variance, robustParam, known);
+
+      ModelKey key{modelType, modelType == fgo::data::NoiseModel::GAUSSIAN ? 0. : robustParam, dim, {}};
+      std::copy(variance.data(), variance.data() + dim, key.variance.begin());
+      return getPooledModel(models_, MaxPooledModels, key, variance, robustParam, known);
+    }
+
+    /***
+     * get the shared noise model of measurement specific variances. The variances are rounded to QuantizedMantissaBits
+     * bits, i.e. changed by less than 1 %, which is far below the accuracy of any variance model of the measurements
+     * @param modelType kernel type
+     * @param variance diagonal variances
+     * @param robustParam parameter of the kernel
+     * @param known set to false if the kernel type is not known, the model is gaussian in this case
+     * @return noise model of the quantized variances
+     */
+    gtsam::SharedNoiseModel getQuantizedNoiseModel(fgo::data::NoiseModel modelType,
+                                                   const gtsam::Vector &variance,
+                                                   double robustParam,
+                                                   bool &known) {
+      const auto dim = static_cast<size_t>(variance.size());
+      if (dim > MaxPooledDimension)
+        return createNoiseModel(modelType, variance, robustParam, known);
+
+      ModelKey key{modelType, modelType == fgo::data::NoiseModel::GAUSSIAN ? 0. : robustParam, dim, {}};
+      std::transform(variance.data(), variance.data() + dim, key.variance.begin(), quantize);
+      const gtsam::Vector quantized = Eigen::Map<const gtsam::Vector>(key.variance.data(),
+                                                                      static_cast<Eigen::Index>(dim));
+      return getPooledModel(quantizedModels_, MaxQuantizedModels, key, quantized, robustParam, known);
+    }
+
+    // rounds the mantissa to QuantizedMantissaBits bits, zero, infinite and NaN values are kept
+    static double quantize(double value) {
+      int exponent = 0;
+      const double mantissa = std::frexp(value, &exponent);
+      if (mantissa == 0. || !std::isfinite(mantissa))
+        return value;
+      return std::ldexp(std::round(std::ldexp(mantissa, QuantizedMantissaBits)), exponent - QuantizedMantissaBits);
+    }
+
+    [[nodiscard]] size_t size() const {
+      return models_.size() + quantizedModels_.size();
+    }
+
+    void clear() {
+      models_.clear();
+      quantizedModels_.clear();
+    }
+
+  private:
+    struct EstimatorKey {
+      fgo::data::NoiseModel type;
+      double param;
+
+      bool operator==(const EstimatorKey &other) const {
+        return type == other.type && param == other.param;
+      }
+    };
+
+    struct ModelKey {
+      fgo::data::NoiseModel type;
+      double param;
+      size_t dim;
+      std::array<double, MaxPooledDimension> variance;  // unused entries are zero
+
+      bool operator==(const ModelKey &other) const {
+        return type == other.type && param == other.param && dim == other.dim && variance == other.variance;
+      }
+    };
+
+    struct PooledModel {
+      gtsam::SharedNoiseModel model;
+      bool known;
+    };
+
+    static size_t hashCombine(size_t seed, double value) {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return seed ^ (std::hash<uint64_t>()(bits) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    struct EstimatorKeyHash {
+      size_t operator()(const EstimatorKey &key) const {
+        return hashCombine(std::hash<int>()(key.type), key.param);
+      }
+    };
+
+    struct ModelKeyHash {
+      size_t operator()(const ModelKey &key) const {
+        auto seed = hashCombine(std::hash<int>()(key.type) ^ key.dim, key.param);
+        for (size_t i = 0; i < key.dim; i++)
+          seed = hashCombine(seed, key.variance[i]);
+        return seed;
+      }
+    };
+
+    typedef std::unordered_map<ModelKey, PooledModel, ModelKeyHash> ModelMap;
+
+    gtsam::SharedNoiseModel getPooledModel(ModelMap &models, size_t maxSize, const ModelKey &key,
+                                           const gtsam::Vector &variance, double robustParam, bool &known) {
+      const auto iter = models.find(key);
+      if (iter != models.end()) {
+        known = iter->second.known;
+        return iter->second.model;
+      }
+
+      auto model = createNoiseModel(key.type, variance, robustParam, known);
+      if (models.size() < maxSize)
+        models.emplace(key, PooledModel{model, known});
+      return model;
+    }
+
+    static gtsam::noiseModel::mEstimator::Base::shared_ptr createMEstimator(fgo::data::NoiseModel modelType,
+                                                                            double robustParam) {
+      using namespace gtsam::noiseModel;
+      switch (modelType) {
+        case fgo::data::NoiseModel::CAUCHY:
+          return mEstimator::Cauchy::Create(robustParam);
+        case fgo::data::NoiseModel::HUBER:
+          return mEstimator::Huber::Create(robustParam);
+        case fgo::data::NoiseModel::DCS:
+          return mEstimator::DCS::Create(robustParam);
+        case fgo::data::NoiseModel::Tukey:
+          return mEstimator::Tukey::Create(robustParam);
+        case fgo::data::NoiseModel::GemanMcClure:
+          return mEstimator::GemanMcClure::Create(robustParam);
+        case fgo::data::NoiseModel::Welsch:
+          return mEstimator::Welsch::Create(robustParam);
+        default:
+          return nullptr;
+      }
+    }
+
+    NoiseModelPool() = default;
+
+    std::unordered_map<EstimatorKey, gtsam::noiseModel::mEstimator::Base::shared_ptr, EstimatorKeyHash> estimators_;
+    ModelMap models_;
+    ModelMap quantizedModels_;
+  };
+}
+
+#endif //ONLINE_FGO_NOISEMODELPOOL_H
@@ -74,6 +74,14 @@ namespace fgo::integrator
 
         std::atomic_bool zeroVelocity_ = false;
 
+        /*
+         * working state carried between the epochs, cleared in reset()
+         */
+        rclcpp::Time firstCallTime_{0, 0, RCL_ROS_TIME};
+        uint64_t lastKeyIndex_ = 0;
+        boost::circular_buffer<Correvit> restCorrevit_{1000};
+        double sumVelocity_ = 0.;
+        uint calcZeroVelocityCounter_ = 1;
 
     public:
         explicit CorrevitIntegrator() = default;
@@ -121,6 +129,7 @@ namespace fgo::integrator
           bufferCorrevit_.clean();
         }
 
+        void reset() override;
 
     };
 }
@@ -87,6 +87,16 @@ namespace fgo::integrator {
 
     std::atomic_bool zeroVelocity_{};
 
+    /*
+     * working state carried between the epochs, cleared in reset()
+     */
+    boost::circular_buffer<fgo::data::PVASolution> restGNSSMeas_{100};
+    double lastPVADelay_ = 0.;
+    rclcpp::Time lastPVATime_{0, 0, RCL_ROS_TIME};
+    bool firstPVAMeasurement_ = true;
+    size_t calcZeroVelocityCounter_ = 1;
+    gtsam::Vector3 sumVelocity_ = gtsam::Z_3x1;
+
   public:
     explicit GNSSLCIntegrator() = default;
 
@@ -134,14 +144,11 @@ namespace fgo::integrator {
       return referencePVTBuffer_.size() != 0;
     }
 
+    void reset() override;
+
     void feedRAWData(data::PVASolution &pva,
                      data::State &state) {
       const auto thisPVATime = pva.timestamp;
-      static double lastDelay = 0.;
-      static auto lastPVATime = thisPVATime;
-      static bool first_measurement = true;
-      static size_t calcZeroVelocityCounter = 1;
-      static gtsam::Vector3 sumVelocity = gtsam::Z_3x1;
 
       irt_nav_msgs::msg::SensorProcessingReport thisProcessingReport;
       thisProcessingReport.ts_measurement = thisPVATime.seconds();
@@ -150,19 +157,19 @@ namespace fgo::integrator {
       thisProcessingReport.sensor_name = "GNSSLC";
       thisProcessingReport.observation_available = true;
 
-      sumVelocity += pva.vel_n;
+      sumVelocity_ += pva.vel_n;
       //rclcpp::sleep_for(std::chrono::nanoseconds(1000000));  // 10000000
       auto pvtDelay = 0; //this->PVTDelayCalculator_->getDelay()  + paramPtr_->pvtMeasTimeOffset;
-      auto delayFromMsg = (thisPVATime - lastPVATime).seconds() - 0.1;
+      auto delayFromMsg = (thisPVATime - lastPVATime_).seconds() - 0.1;
 
-      if (first_measurement) {
-        first_measurement = false;
+      if (firstPVAMeasurement_) {
+        firstPVAMeasurement_ = false;
         delayFromMsg = 0.;
         pvtDelay = 0.;
       }
 
-      if (delayFromMsg < -0.005 && lastDelay > 0)
-        delayFromMsg += lastDelay;
+      if (delayFromMsg < -0.005 && lastPVADelay_ > 0)
+        delayFromMsg += lastPVADelay_;
 
       if (delayFromMsg < 0.)
         delayFromMsg = 0.;
@@ -200,26 +207,26 @@ namespace fgo::integrator {
       GNSSPVABuffer_.update_buffer(pva, pva.timestamp);
 
       if (paramPtr_->NoOptimizationNearZeroVelocity) {
-        if (calcZeroVelocityCounter > 6) {
-          const auto avgVelocity = (gtsam::Vector3() << sumVelocity.x() / calcZeroVelocityCounter,
-            sumVelocity.y() / calcZeroVelocityCounter,
-            sumVelocity.z() / calcZeroVelocityCounter).finished();
+        if (calcZeroVelocityCounter_ > 6) {
+          const auto avgVelocity = (gtsam::Vector3() << sumVelocity_.x() / calcZeroVelocityCounter_,
+            sumVelocity_.y() / calcZeroVelocityCounter_,
+            sumVelocity_.z() / calcZeroVelocityCounter_).finished();
           RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), integratorName_ << " avg: velocity " << avgVelocity.norm());
           if (avgVelocity.norm() < paramPtr_->zeroVelocityThreshold) {
             zeroVelocity_ = true;
             GNSSPVABuffer_.clean();
           } else
             //zeroVelocity_ = false;
-            calcZeroVelocityCounter = 1;
-          sumVelocity.setZero();
+            calcZeroVelocityCounter_ = 1;
+          sumVelocity_.setZero();
         }
       }
-      calcZeroVelocityCounter++;
+      calcZeroVelocityCounter_++;
 
       if (abs(delayFromMsg) < 0.005 || delayFromMsg > 0.3)
-        lastDelay = 0.;
+        lastPVADelay_ = 0.;
       else
-        lastDelay = delayFromMsg;
+        lastPVADelay_ = delayFromMsg;
 
       if (paramPtr_->useForInitialization && !graphPtr_->isGraphInitialized()) {
         graphPtr_->updateReferenceMeasurementTimestamp(pva.tow, state.timestamp);
@@ -233,15 +240,19 @@ namespace fgo::integrator {
       if (pubSensorReport_)
         pubSensorReport_->publish(thisProcessingReport);
 
-      lastPVATime = thisPVATime;
+      lastPVATime_ = thisPVATime;
     }
 
-    void feedRAWData(std::vector<data::PVASolution> &pva_vec,
-                     std::vector<data::State> &state_vec) {
-      if (!state_vec.empty())
-        assert(pva_vec.size() != state_vec.size());
-      for (size_t i = 0; i < pva_vec.size(); i++) {
-        feedRAWData(pva_vec[i], state_vec[i]);
+    void feedOfflineData(const fgo::data::MeasurementBatch &batch) override {
+      const auto pvas = batch.get<data::PVASolution>(paramPtr_->offlineDataChannel);
+      const auto states = batch.get<data::State>(data::channel::ReferenceState);
+      if (!states.empty() && states.size() != pvas.size())
+        RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": got " << pvas.size() << " PVA but "
+                                                                      << states.size() << " reference states");
+      for (size_t i = 0; i < pvas.size(); i++) {
+        auto pva = pvas[i];
+        auto state = i < states.size() ? states[i] : data::State();
+        feedRAWData(pva, state);
       }
     }
 
@@ -303,7 +314,7 @@ namespace fgo::integrator {
   private:
 
     void onOdomMsgCb(const nav_msgs::msg::Odometry::ConstSharedPtr pva) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       // ATTENTION: here we use ENU as tangent frame
       rclcpp::Time ts = rclcpp::Time(pva->header.stamp.sec, pva->header.stamp.nanosec, RCL_ROS_TIME);
 
@@ -318,7 +329,7 @@ namespace fgo::integrator {
     }
 
     void onIRTPVTMsgCb(const irt_nav_msgs::msg::PVAGeodetic::ConstSharedPtr pvaMsg) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       if (pvaMsg->sol_age > 0.15) {
         RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(),
                             integratorName_ << " onIRTPVTMsgCb solution out of date: " << pvaMsg->sol_age);
@@ -330,7 +341,7 @@ namespace fgo::integrator {
     }
 
     void onINSPVAXMsgCb(novatel_oem7_msgs::msg::INSPVAX::ConstSharedPtr pva) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       rclcpp::Time msg_timestamp;
       if (paramPtr_->useHeaderTimestamp)
         msg_timestamp = rclcpp::Time(pva->header.stamp.sec, pva->header.stamp.nanosec, RCL_ROS_TIME);
@@ -362,7 +373,7 @@ namespace fgo::integrator {
       sol.xyz_ecef = fgo::utils::llh2xyz(sol.llh);
       sol.xyz_var = (gtsam::Vector3() << std::pow(bestpos->lat_stdev, 2), std::pow(bestpos->lon_stdev, 2), std::pow(
         bestpos->hgt_stdev, 2)).finished() * paramPtr_->posVarScale;
-      const auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix(sol.xyz_ecef).inverse());
+      const auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(sol.llh).inverse());
       sol.vel_n = (gtsam::Vector3() << bestvel->hor_speed * std::cos(bestvel->trk_gnd * fgo::constants::deg2rad),
         bestvel->hor_speed * std::sin(bestvel->trk_gnd * fgo::constants::deg2rad),
         -bestvel->ver_speed).finished();
@@ -399,7 +410,7 @@ namespace fgo::integrator {
 
     void onOEM7PVTMsgCb(const novatel_oem7_msgs::msg::BESTPOS::ConstSharedPtr bestpos,
                         const novatel_oem7_msgs::msg::BESTVEL::ConstSharedPtr bestvel) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       rclcpp::Time msg_timestamp;
       if (paramPtr_->useHeaderTimestamp)
         msg_timestamp = rclcpp::Time(bestpos->header.stamp.sec, bestpos->header.stamp.nanosec, RCL_ROS_TIME);
@@ -416,7 +427,7 @@ namespace fgo::integrator {
     }
 
     void onOEM7Bestpos(const novatel_oem7_msgs::msg::BESTPOS::ConstSharedPtr bestpos) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       rclcpp::Time msg_timestamp;
       if (paramPtr_->useHeaderTimestamp)
         msg_timestamp = rclcpp::Time(bestpos->header.stamp.sec, bestpos->header.stamp.nanosec, RCL_ROS_TIME);
@@ -432,9 +443,7 @@ namespace fgo::integrator {
 
     void onUbloxPVTMsgCb(const ublox_msgs::msg::NavPVT::ConstSharedPtr navpvt) {
 
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
-      static size_t calcZeroVelocityCounter = 1;
-      static gtsam::Vector3 sumVelocity = gtsam::Z_3x1;
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       const auto now = rosNodePtr_->now();
       rclcpp::Time msg_timestamp = rclcpp::Time(now.nanoseconds(), RCL_ROS_TIME);
       RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "on ubloxPVT at " << std::fixed << msg_timestamp.seconds());
@@ -442,13 +451,13 @@ namespace fgo::integrator {
       const auto [sol, state] = sensor::gnss::parseUbloxPVTMsg(*navpvt,
                                                                paramPtr_,
                                                                msg_timestamp);
-      sumVelocity += sol.vel_n;
+      sumVelocity_ += sol.vel_n;
       GNSSPVABuffer_.update_buffer(sol, msg_timestamp);
 
-      if (calcZeroVelocityCounter > 6) {
-        const auto avgVelocity = (gtsam::Vector3() << sumVelocity.x() / calcZeroVelocityCounter,
-          sumVelocity.y() / calcZeroVelocityCounter,
-          sumVelocity.z() / calcZeroVelocityCounter).finished();
+      if (calcZeroVelocityCounter_ > 6) {
+        const auto avgVelocity = (gtsam::Vector3() << sumVelocity_.x() / calcZeroVelocityCounter_,
+          sumVelocity_.y() / calcZeroVelocityCounter_,
+          sumVelocity_.z() / calcZeroVelocityCounter_).finished();
         //RCLCPP_ERROR_STREAM(appPtr_->get_logger(), integratorName_ << " avg: velocity " << avgVelocity.norm());
         if (avgVelocity.norm() < paramPtr_->zeroVelocityThreshold) {
           //RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), integratorName_ << " onIRTPVTMsgCb reported near zero velocity: " << sol.vel_n);
@@ -456,14 +465,14 @@ namespace fgo::integrator {
           GNSSPVABuffer_.clean();
         } else
           zeroVelocity_ = false;
-        calcZeroVelocityCounter = 0;
+        calcZeroVelocityCounter_ = 0;
 
-        sumVelocity.setZero();
+        sumVelocity_.setZero();
       }
     }
 
     void onNavFixMsgCb(const sensor_msgs::msg::NavSatFix::ConstSharedPtr msg) {
-      static const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      const auto transSensorFromBase = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
       rclcpp::Time msg_timestamp;
       if (paramPtr_->useHeaderTimestamp)
         msg_timestamp = rclcpp::Time(msg->header.stamp.sec, msg->header.stamp.nanosec, RCL_ROS_TIME);
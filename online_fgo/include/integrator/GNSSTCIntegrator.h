@@ -19,6 +19,8 @@
 #ifndef ONLINE_FGO_INTERGRATEGNSSTC_H
 #define ONLINE_FGO_INTERGRATEGNSSTC_H
 
+#include <array>
+#include <list>
 #include <boost/optional.hpp>
 #include <irt_nav_msgs/msg/gnss_obs_pre_processed.hpp>
 #include <irt_nav_msgs/msg/sat_label.hpp>
@@ -44,7 +46,8 @@
 
 #include "utils/GNSSUtils.h"
 #include "utils/LambdaAlgorithm.h"
-#include "utils/rapidcsv.h"
+#include "utils/AsyncLogger.h"
+#include "sensor/gnss/LOSLookUpTable.h"
 #include "sensor/gnss/GNSSDataParser.h"
 
 namespace fgo::integrator {
@@ -72,27 +75,63 @@ namespace fgo::integrator {
     fgo::data::CircularDataBuffer<irt_nav_msgs::msg::GNSSLabeling> gnssLabelingMsgBuffer_;
     std::atomic_bool zeroVelocity_{};
 
-    std::map<int, std::map<int, bool>> LOSLoopUpTable_;
+    sensor::gnss::LOSLookUpTable LOSLookUpTable_;
 
-    gtsam::Pose3 baseToAntMainTrans_;
+    sensor::SensorHandle antMainHandle_ = sensor::InvalidSensorHandle;
+    sensor::SensorHandle antAuxHandle_ = sensor::InvalidSensorHandle;
+    gtsam::Pose3 baseToAntMainTrans_;  // refreshed from the calibration manager in every addFactors
     gtsam::Pose3 baseToAntAuxTrans_;
 
+    /*
+     * working state carried between the epochs, cleared in reset()
+     */
+    std::list<std::pair<uint32_t, bool>> notSlippedSatellites_; //TODO not needed without DD
+    uint consecutiveSyncs_ = 1;
+    bool lastGNSSInterpolated_ = false;
+    gtsam::Key lastStateJ_ = -1;
+    boost::circular_buffer<fgo::data::GNSSMeasurement> restGNSSMeas_{10};
+    sensor::gnss::GNSSObservationTrackingState gnssTrackingState_;
+    rclcpp::Time lastGNSSTime_{0, 0, RCL_ROS_TIME};
+    rclcpp::Time firstGNSSProcessingTime_{0, 0, RCL_ROS_TIME};
+    double lastGNSSDelay_ = 0.;
+    bool firstGNSSMeasurement_ = true;
+    size_t calcZeroVelocityCounter_ = 1;
+    gtsam::Vector3 sumVelocity_ = gtsam::Z_3x1;
+
+    struct CarrierPhaseEpoch {
+      uint lastRefSatID = 0;
+      gtsam::Vector3 lastPosRefSat = gtsam::Z_3x1;
+      std::vector<fgo::data::CSDataStruct> lastMeasurement;
+      size_t lastState = 0;
+    };
+
+    struct TDNormalCPEpoch {
+      std::vector<fgo::data::GNSSObs> lastObsVector;
+      gtsam::Key lastAmb = N(0);
+      bool notCreatNewCycleSlipFactor = false;
+      bool syncAmbIndexWithState = false;
+      size_t lastlastObsSize = 0;
+    };
+
+    uint lastDDCPRefSatID_ = 0;
+    CarrierPhaseEpoch tdcpRTCMEpoch_;
+    CarrierPhaseEpoch tdcpAuxEpoch_;
+    CarrierPhaseEpoch gpTDCPEpoch_{static_cast<uint>(-1)};
+    TDNormalCPEpoch tdNormalCPEpoch_;
+
   private:
 
     void onIRTPVTMsgCb(const irt_nav_msgs::msg::PVAGeodetic::ConstSharedPtr pvtMsg) {
       auto thisPVTTime = rclcpp::Time(pvtMsg->header.stamp.sec, pvtMsg->header.stamp.nanosec, RCL_ROS_TIME);
 
-      static size_t calcZeroVelocityCounter = 1;
-      static gtsam::Vector3 sumVelocity = gtsam::Z_3x1;
-
       auto vel_ned = (gtsam::Vector3() << pvtMsg->vn, pvtMsg->ve, -pvtMsg->vu).finished();
 
-      sumVelocity += vel_ned;
+      sumVelocity_ += vel_ned;
 
-      if (calcZeroVelocityCounter > 4) {
-        const auto avgVelocity = (gtsam::Vector3() << sumVelocity.x() / calcZeroVelocityCounter,
-          sumVelocity.y() / calcZeroVelocityCounter,
-          sumVelocity.z() / calcZeroVelocityCounter).finished();
+      if (calcZeroVelocityCounter_ > 4) {
+        const auto avgVelocity = (gtsam::Vector3() << sumVelocity_.x() / calcZeroVelocityCounter_,
+          sumVelocity_.y() / calcZeroVelocityCounter_,
+          sumVelocity_.z() / calcZeroVelocityCounter_).finished();
         if (avgVelocity.norm() < paramPtr_->zeroVelocityThreshold) {
           RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
                              integratorName_ << " onIRTPVTMsgCb reported near zero velocity: " << vel_ned);
@@ -100,11 +139,11 @@ namespace fgo::integrator {
           gnssDataBuffer_.clean();
         } else
           zeroVelocity_ = false;
-        calcZeroVelocityCounter = 1;
-        sumVelocity.setZero();
+        calcZeroVelocityCounter_ = 1;
+        sumVelocity_.setZero();
       }
 
-      calcZeroVelocityCounter++;
+      calcZeroVelocityCounter_++;
     }
 
     void onGNSSMsgCb(irt_nav_msgs::msg::GNSSObsPreProcessed::ConstSharedPtr gnssMeasurement);
@@ -149,204 +188,236 @@ namespace fgo::integrator {
       gnssDataBuffer_.clean();
     }
 
-  protected:
-    inline void addGNSSPrFactor(const gtsam::Key &poseJ,
-                                const gtsam::Key &cbdJ,
-                                const std::vector<fgo::data::GNSSObs> &obsVector,
-                                const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-
-      for (const auto &obs: obsVector) {
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector1() << obs.prVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-
-        graphPtr_->emplace_shared<fgo::factor::PrFactor>(poseJ, cbdJ, obs.pr, obs.satPos, leverArm, noiseModel);
-      }
-    }
-
-    inline void addGPInterpolatedPrFactor(const gtsam::Key &pose_i, const gtsam::Key &vel_i, const gtsam::Key &omega_i,
-                                          const gtsam::Key &pose_j, const gtsam::Key &vel_j, const gtsam::Key &omega_j,
-                                          const gtsam::Key &cbd_i,
-                                          const std::vector<fgo::data::GNSSObs> &obsVector,
-                                          const std::shared_ptr<fgo::models::GPInterpolator> &interpolator,
-                                          const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-      for (auto &obs: obsVector) {
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector1() << obs.prVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-
-        graphPtr_->emplace_shared<fgo::factor::GPInterpolatedPrFactor>(pose_i, vel_i, omega_i,
-                                                                       pose_j, vel_j, omega_j,
-                                                                       cbd_i, obs.pr, obs.satPos, obs.satVel,
-                                                                       leverArm,
-                                                                       noiseModel, interpolator,
-                                                                       paramPtr_->AutoDiffGPInterpolatedFactor);
-
-      }
-    }
+    void reset() override;
 
-    inline void addGNSSDrFactor(gtsam::Key pose_i, gtsam::Key vel_i, gtsam::Key cbd_i,
-                                const std::vector<fgo::data::GNSSObs> &obsVector,
-                                const gtsam::Vector3 &omegaUnBiased,
-                                const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-      for (const auto &obs: obsVector) {
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector1() << obs.drVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-        graphPtr_->emplace_shared<fgo::factor::DrFactor>(pose_i, vel_i, cbd_i, obs.dr, obs.satPos, obs.satVel, leverArm,
-                                                         omegaUnBiased, noiseModel);
-      }
+  protected:
+    /*
+     * per-satellite pseudorange and doppler factors, see addFactors(): the epochs are planned serially, all satellite
+     * factors are built in one data-parallel pass and added to the graph serially in the order of the epochs afterwards
+     */
+    enum class SatelliteFactorType : uint8_t {
+      PR,
+      DR,
+      PRDR,
+      DDPRDR,
+    };
+
+    struct SatelliteFactorGroup {
+      SatelliteFactorType type = SatelliteFactorType::PRDR;
+      const std::vector<fgo::data::GNSSObs> *obs = nullptr;
+      gtsam::Vector3 leverArm = gtsam::Z_3x1;
+      gtsam::Key cbdKey = 0;
+      const fgo::data::RefSat *refSat = nullptr;  // double differences only
+      gtsam::Vector3 basePos = gtsam::Z_3x1;      // double differences only
+      size_t begin = 0;                           // range in satelliteFactorInputs_
+      size_t end = 0;
+    };
+
+    struct GNSSEpochPlan {
+      fgo::data::GNSSMeasurement *meas = nullptr;
+      StateMeasSyncResult syncResult;
+      double correctedTime = 0.;
+      gtsam::Vector3 omega = gtsam::Z_3x1;
+      uint32_t biasCbdKeyOffset = 0;
+      std::array<SatelliteFactorGroup, 4> groups;
+      size_t numGroups = 0;
+      // interpolated epochs only, recalculated for this epoch because the factors keep a reference to it
+      std::shared_ptr<fgo::models::GPInterpolator> interpolator;
+    };
+
+    struct SatelliteFactorInput {
+      const fgo::data::GNSSObs *obs = nullptr;
+      const GNSSEpochPlan *plan = nullptr;
+      const SatelliteFactorGroup *group = nullptr;
+      gtsam::NonlinearFactor::shared_ptr factor;  // stays empty if the observation is excluded
+    };
+
+    // below this number of satellite factors the parallel pass is not worth waking up the worker threads
+    static constexpr size_t MinParallelSatelliteFactors = 64;
+    std::vector<GNSSEpochPlan> gnssEpochPlans_;
+    std::vector<SatelliteFactorInput> satelliteFactorInputs_;
+
+    /***
+     * create an interpolator of the configured GP type
+     * @return interpolator, nullptr if no GP type is chosen
+     */
+    [[nodiscard]] std::shared_ptr<fgo::models::GPInterpolator> createInterpolator() const {
+      if (paramPtr_->gpType == fgo::data::GPModelType::WNOJ)
+        return std::make_shared<fgo::models::GPWNOJInterpolator>(
+          gtsam::noiseModel::Diagonal::Variances(paramPtr_->QcGPInterpolatorFull), 0, 0,
+          paramPtr_->AutoDiffGPInterpolatedFactor, paramPtr_->GPInterpolatedFactorCalcJacobian);
+      if (paramPtr_->gpType == fgo::data::GPModelType::WNOA)
+        return std::make_shared<fgo::models::GPWNOAInterpolator>(
+          gtsam::noiseModel::Diagonal::Variances(paramPtr_->QcGPInterpolatorFull), 0, 0,
+          paramPtr_->AutoDiffGPInterpolatedFactor, paramPtr_->GPInterpolatedFactorCalcJacobian);
+      return nullptr;
     }
 
-    inline void addGPInterpolatedDrFactor(const gtsam::Key &pose_i, const gtsam::Key &vel_i, const gtsam::Key &omega_i,
-                                          const gtsam::Key &pose_j, const gtsam::Key &vel_j, const gtsam::Key &omega_j,
-                                          const gtsam::Key &cbd_i,
-                                          const std::vector<fgo::data::GNSSObs> &obsVector,
-                                          const std::shared_ptr<fgo::models::GPInterpolator> &interpolator,
-                                          const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-      for (auto &obs: obsVector) {
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector1() << obs.drVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-        graphPtr_->emplace_shared<fgo::factor::GPInterpolatedDrFactor>(pose_i, vel_i, omega_i,
-                                                                       pose_j, vel_j, omega_j, cbd_i, obs.dr,
-                                                                       obs.satPos, obs.satVel, leverArm,
-                                                                       noiseModel, interpolator,
-                                                                       paramPtr_->AutoDiffGPInterpolatedFactor);
-      }
+    /***
+     * select the pseudorange/doppler factors of an epoch according to the configuration
+     * @param plan epoch to be planned, meas, syncResult, omega and biasCbdKeyOffset must be set
+     * @param numInputs number of satellite factor inputs of the epochs planned before
+     * @return number of satellite factor inputs including this epoch
+     */
+    size_t planSatelliteFactors(GNSSEpochPlan &plan, size_t numInputs) {
+      const auto &syncResult = plan.syncResult;
+      const bool interpolated = syncResult.status == StateMeasSyncStatus::INTERPOLATED;
+      const bool usePseudorangeTil =
+        paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ;
+      const gtsam::Key cbdKeyI = C(syncResult.keyIndexI);
+      const gtsam::Key cbdKeySync = syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ? cbdKeyI :
+                                    C(syncResult.keyIndexJ);
+      const auto &meas = *plan.meas;
+      plan.numGroups = 0;
+
+      const auto addGroup = [&](SatelliteFactorType type, const fgo::data::GNSSMeasurementEpoch &epoch,
+                                const gtsam::Vector3 &leverArm, gtsam::Key cbdKey) -> SatelliteFactorGroup & {
+        auto &group = plan.groups[plan.numGroups++];
+        group = SatelliteFactorGroup();
+        group.type = type;
+        group.obs = &epoch.obs;
+        group.leverArm = leverArm;
+        group.cbdKey = cbdKey;
+        group.begin = numInputs;
+        numInputs += epoch.obs.size();
+        group.end = numInputs;
+        return group;
+      };
+
+      const auto addAntenna = [&](const fgo::data::GNSSMeasurementEpoch &epoch, const gtsam::Vector3 &leverArm,
+                                  bool isMainAnt) {
+        // the GP interpolated pseudorange-doppler factor of the main antenna is the only one not using the key offset
+        const auto cbdKeyGP = cbdKeyI + plan.biasCbdKeyOffset;
+        if (paramPtr_->usePseudoRangeDoppler && usePseudorangeTil)
+          addGroup(SatelliteFactorType::PRDR, epoch, leverArm,
+                   interpolated ? (isMainAnt ? cbdKeyI : cbdKeyGP) : cbdKeySync);
+        else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->usePseudoRange && usePseudorangeTil)
+          addGroup(SatelliteFactorType::PR, epoch, leverArm, interpolated ? cbdKeyGP : cbdKeySync);
+        else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->useDopplerRange)
+          addGroup(SatelliteFactorType::DR, epoch, leverArm, interpolated ? cbdKeyGP : cbdKeySync);
+        else
+          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), (isMainAnt ? "" : "Aux ant: ") << "No Pr Dr integrated!");
+      };
+
+      const auto addDoubleDifference = [&](const fgo::data::GNSSMeasurementEpoch &epoch, const gtsam::Vector3 &leverArm,
+                                           const gtsam::Vector3 &basePos) {
+        auto &group = addGroup(SatelliteFactorType::DDPRDR, epoch, leverArm, 0);
+        group.refSat = &epoch.refSatGPS;
+        group.basePos = basePos;
+      };
+
+      addAntenna(meas.measMainAnt, baseToAntMainTrans_.translation(), true);
+      if (paramPtr_->useDualAntenna && meas.hasDualAntenna)
+        addAntenna(meas.measAuxAnt, baseToAntAuxTrans_.translation(), false);
+
+      const bool useDD = interpolated ? paramPtr_->useDDPseudoRange : paramPtr_->usePseudoRangeDoppler;
+      if (useDD && paramPtr_->useRTCMDD && meas.hasRTK)
+        addDoubleDifference(meas.measRTCMDD, baseToAntMainTrans_.translation(), meas.measRTCMDD.basePosRTCM);
+      if (useDD && paramPtr_->useDualAntenna && meas.hasDualAntennaDD)
+        addDoubleDifference(meas.measDualAntennaDD, baseToAntAuxTrans_.translation(), meas.measRTCMDD.basePosRTCM);
+      return numInputs;
     }
 
-    inline void addGNSSPrDrFactor(const gtsam::Key &poseJ,
-                                  const gtsam::Key &velJ,
-                                  const gtsam::Key &biasJ,
-                                  const gtsam::Key &cbdJ,
-                                  const std::vector<fgo::data::GNSSObs> &obsVector,
-                                  const gtsam::Vector3 &omegaUnbiased,
-                                  const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
+    /***
+     * build a satellite factor including its noise model, this is called concurrently
+     * @param input
+     */
+    void buildSatelliteFactor(SatelliteFactorInput &input) const {
+      const auto &obs = *input.obs;
+      const auto &plan = *input.plan;
+      const auto &group = *input.group;
+      gtsam::SharedNoiseModel noiseModel;
+      switch (group.type) {
+        case SatelliteFactorType::PR:
+          noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR, gtsam::Vector1(obs.prVar),
+                                               paramPtr_->robustParameterPRDR);
+          break;
+        case SatelliteFactorType::DR:
+          noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR, gtsam::Vector1(obs.drVar),
+                                               paramPtr_->robustParameterPRDR);
+          break;
+        case SatelliteFactorType::PRDR:
+          if (!obs.isLOS) {
+            FGO_LOG_DEBUG(fgo::utils::LogModule::GNSS, "skipping observation for NLOS exclusion",
+                          {"prn", double(obs.satId)});
+            input.factor.reset();
+            return;
+          }
+          noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR, gtsam::Vector2(obs.prVar, obs.drVar),
+                                               paramPtr_->robustParameterPRDR);
+          break;
+        case SatelliteFactorType::DDPRDR:
+          FGO_LOG_DEBUG(fgo::utils::LogModule::GNSS, "DD observation", {"prn", double(obs.satId)}, {"pr", obs.pr});
+          noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR, gtsam::Vector2(obs.prVar, obs.drVar),
+                                               paramPtr_->robustParameterPRDR);
+          break;
       }
 
-      for (const auto &obs: obsVector) {
-
-        if (!obs.isLOS) {
-          std::cout << "SKIPPING OBS prn: " << obs.satId << " FOR NLOS Exclusion" << std::endl;
-          continue;
+      const auto &syncResult = plan.syncResult;
+      if (syncResult.status == StateMeasSyncStatus::INTERPOLATED) {
+        const auto poseI = X(syncResult.keyIndexI), velI = V(syncResult.keyIndexI), omegaI = W(syncResult.keyIndexI);
+        const auto poseJ = X(syncResult.keyIndexJ), velJ = V(syncResult.keyIndexJ), omegaJ = W(syncResult.keyIndexJ);
+        switch (group.type) {
+          case SatelliteFactorType::PR:
+            input.factor = boost::make_shared<fgo::factor::GPInterpolatedPrFactor>(
+              poseI, velI, omegaI, poseJ, velJ, omegaJ, group.cbdKey, obs.pr, obs.satPos, obs.satVel,
+              group.leverArm, noiseModel, plan.interpolator, paramPtr_->AutoDiffGPInterpolatedFactor);
+            break;
+          case SatelliteFactorType::DR:
+            input.factor = boost::make_shared<fgo::factor::GPInterpolatedDrFactor>(
+              poseI, velI, omegaI, poseJ, velJ, omegaJ, group.cbdKey, obs.dr, obs.satPos, obs.satVel,
+              group.leverArm, noiseModel, plan.interpolator, paramPtr_->AutoDiffGPInterpolatedFactor);
+            break;
+          case SatelliteFactorType::PRDR:
+            input.factor = boost::make_shared<fgo::factor::GPInterpolatedPrDrFactor>(
+              poseI, velI, omegaI, poseJ, velJ, omegaJ, group.cbdKey, obs.pr, obs.dr, obs.satPos, obs.satVel,
+              group.leverArm, noiseModel, plan.interpolator, paramPtr_->AutoDiffGPInterpolatedFactor);
+            break;
+          case SatelliteFactorType::DDPRDR:
+            input.factor = boost::make_shared<fgo::factor::GPInterpolatedDDPrDrFactor>(
+              poseI, velI, omegaI, poseJ, velJ, omegaJ, obs.pr, obs.dr, group.refSat->refSatPos,
+              group.refSat->refSatVel, obs.satPos, obs.satVel, group.basePos, group.leverArm, noiseModel,
+              plan.interpolator);
+            break;
         }
-
-        //std::cout << "PositionWe: " << std::fixed << currentPredState_.state.t() << std::endl;
-        //std::cout << "satID: " << std::fixed << obs.satId << std::endl;
-        //std::cout << "satAltitude + Radius of earth: " << std::fixed << obs.satPos.norm() << std::endl;
-        //double distance = gtsam::distance3( fgo::utils::llh2xyz(gtsam::Vector3(pvtMeas.phi, pvtMeas.lambda, pvtMeas.h)), obs.satPos);
-        //std::cout << "Distance: " << std::fixed << distance << std::endl;
-        //std::cout << "PR: " << std::fixed << obs.pr << std::endl;
-        //gtsam::distance3(gtsam::Vector3(4018401,425592,4918225)
-        //std::cout << "error: " << std::fixed << distance - obs.pr << std::endl;
-
-        //std::cout << "SatId: " << obs.satId << " Ant: " << unsigned(antenna) << " pr: " << obs.pr << " : " << prVar << " : " << obs.prVarRaw <<" CN0 " << obs.cn0 <<std::endl;
-        //std::cout << "SatId: " << obs.satId << " Ant: " << unsigned(antenna) << " pr: " << obs.dr << " : " << drVar << " : " << obs.cpVarRaw << std::endl;
-
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector2() << obs.prVar, obs.drVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-
-        graphPtr_->emplace_shared<fgo::factor::PrDrFactor>(poseJ, velJ, biasJ, cbdJ, obs.pr, obs.dr,
-                                                           obs.satPos, obs.satVel, leverArm, omegaUnbiased, noiseModel,
-                                                           paramPtr_->AutoDiffNormalFactor);
-      }
-
-    }
-
-    inline void
-    addGPInterpolatedGNSSPrDrFactor(const gtsam::Key &pose_i, const gtsam::Key &vel_i, const gtsam::Key &omega_i,
-                                    const gtsam::Key &pose_j, const gtsam::Key &vel_j, const gtsam::Key &omega_j,
-                                    const gtsam::Key &cbd_i,
-                                    const std::vector<fgo::data::GNSSObs> &obsVector,
-                                    const std::shared_ptr<fgo::models::GPInterpolator> &interpolator,
-                                    const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-      for (auto &obs: obsVector) {
-        if (!obs.isLOS) {
-          std::cout << "SKIPPING OBS prn: " << obs.satId << " FOR NLOS Exclusion" << std::endl;
-          continue;
+      } else {
+        const auto stateSync = syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ? syncResult.keyIndexI :
+                               syncResult.keyIndexJ;
+        const auto poseSync = X(stateSync), velSync = V(stateSync), biasSync = B(stateSync);
+        switch (group.type) {
+          case SatelliteFactorType::PR:
+            input.factor = boost::make_shared<fgo::factor::PrFactor>(poseSync, group.cbdKey, obs.pr, obs.satPos,
+                                                                     group.leverArm, noiseModel);
+            break;
+          case SatelliteFactorType::DR:
+            input.factor = boost::make_shared<fgo::factor::DrFactor>(poseSync, velSync, group.cbdKey, obs.dr,
+                                                                     obs.satPos, obs.satVel, group.leverArm,
+                                                                     plan.omega, noiseModel);
+            break;
+          case SatelliteFactorType::PRDR:
+            input.factor = boost::make_shared<fgo::factor::PrDrFactor>(poseSync, velSync, biasSync, group.cbdKey,
+                                                                       obs.pr, obs.dr, obs.satPos, obs.satVel,
+                                                                       group.leverArm, plan.omega, noiseModel,
+                                                                       paramPtr_->AutoDiffNormalFactor);
+            break;
+          case SatelliteFactorType::DDPRDR:
+            input.factor = boost::make_shared<fgo::factor::DDPrDrFactor>(
+              poseSync, velSync, obs.pr, 0, group.refSat->refSatPos, group.refSat->refSatVel, obs.satPos,
+              obs.satVel, group.basePos, group.leverArm, plan.omega, noiseModel);
+            break;
         }
-
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        (gtsam::Vector2() << obs.prVar, obs.drVar).finished(),
-                                                        paramPtr_->robustParameterPRDR);
-        graphPtr_->emplace_shared<fgo::factor::GPInterpolatedPrDrFactor>(pose_i, vel_i, omega_i, pose_j,
-                                                                         vel_j, omega_j, cbd_i, obs.pr, obs.dr,
-                                                                         obs.satPos, obs.satVel, leverArm,
-                                                                         noiseModel, interpolator,
-                                                                         paramPtr_->AutoDiffGPInterpolatedFactor);
       }
     }
 
-    inline void addGNSSDDPrDrFactor(const gtsam::Key &pose_j, const gtsam::Key &vel_j,
-                                    const std::vector<fgo::data::GNSSObs> &obsVector,
-                                    const fgo::data::RefSat &refSat,
-                                    const gtsam::Vector3 &posBase, const gtsam::Vector3 &omegaUnbiased,
-                                    const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-
-      for (auto &obs: obsVector) {
-        RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "satID: " << obs.satId << " PR: " << obs.pr);
-        auto prVar = obs.prVar;
-
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        gtsam::Vector2(prVar, obs.drVar),
-                                                        paramPtr_->robustParameterPRDR);
-
-        graphPtr_->emplace_shared<fgo::factor::DDPrDrFactor>(
-          pose_j, vel_j, obs.pr, 0, refSat.refSatPos, refSat.refSatVel, obs.satPos, obs.satVel,
-          posBase, leverArm, omegaUnbiased, noiseModel);
-      }
-    }
-
-    inline void
-    addGPInterpolatedDDPrDrFactor(const gtsam::Key &pose_i, const gtsam::Key &vel_i, const gtsam::Key &omega_i,
-                                  const gtsam::Key &pose_j, const gtsam::Key &vel_j, const gtsam::Key &omega_j,
-                                  const std::vector<fgo::data::GNSSObs> &obsVector,
-                                  const fgo::data::RefSat &refSat, const gtsam::Vector3 &posBase,
-                                  const std::shared_ptr<fgo::models::GPInterpolator> &interpolator,
-                                  const int &antenna) {
-      auto leverArm = baseToAntMainTrans_.translation();
-      if (antenna == 2) {
-        leverArm = baseToAntAuxTrans_.translation();
-      }
-      for (const auto &obs: obsVector) {
-        const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelPRDR,
-                                                        gtsam::Vector2(obs.prVar, obs.drVar),
-                                                        paramPtr_->robustParameterPRDR);
-        graphPtr_->emplace_shared<fgo::factor::GPInterpolatedDDPrDrFactor>(
-          pose_i, vel_i, omega_i, pose_j, vel_j, omega_j,
-          obs.pr, obs.dr, refSat.refSatPos, refSat.refSatVel, obs.satPos, obs.satVel,
-          posBase, leverArm, noiseModel, interpolator);
+    /***
+     * add the built satellite factors of a group to the graph in the order of the observations
+     * @param group
+     */
+    void addSatelliteFactors(const SatelliteFactorGroup &group) {
+      for (auto i = group.begin; i < group.end; i++) {
+        if (satelliteFactorInputs_[i].factor)
+          graphPtr_->push_back(satelliteFactorInputs_[i].factor);
       }
-
     }
 
     inline void addGNSSDDCPFactor(const gtsam::Key &pose_j,
@@ -375,7 +446,7 @@ namespace fgo::integrator {
         }
 
         //TODO RTCM AND DDANTENNA DOESNT WORK TOGEHTER
-        static uint lastRefSatID = 0;
+        auto &lastRefSatID = lastDDCPRefSatID_;
         std::vector<bool> tempFixed;
         gtsam::Vector lastIntAmbVal = last_opt_state.ddIntAmb;
         uint newRefSatID = refSat.refSatSVID;
@@ -530,10 +601,7 @@ namespace fgo::integrator {
                                   const uint &refSatID,
                                   const gtsam::Point3 &posBase, const int &antenna, u_int64_t state) {
       if (antenna == 1) { //RTCM
-        static uint lastRefSatID = 0;
-        static gtsam::Vector3 lastPosRefSat = gtsam::Vector3(0, 0, 0);
-        static std::vector<fgo::data::CSDataStruct> lastMeasRTCM;
-        static u_int64_t lastState = 0;
+        auto &[lastRefSatID, lastPosRefSat, lastMeasRTCM, lastState] = tdcpRTCMEpoch_;
 
         int m = 0;
         if (lastRefSatID == refSatID && state - lastState < 11) { //if new ref sat just skip
@@ -548,7 +616,8 @@ namespace fgo::integrator {
               if (n != -1) {
                 if (paramPtr_->useDDCarrierPhase) {
                   //std::cout << "n: " << n << " m: " << m << std::endl;
-                  auto noise_model = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(0.001)); //TODO
+                  auto noise_model = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                                     gtsam::Vector1(0.001), 0.); //TODO
                   graphPtr_->emplace_shared<fgo::factor::AmbiguityLockFactor>(N(lastState), amb_j, n, m, noise_model);
 
                 } else {
@@ -589,9 +658,7 @@ namespace fgo::integrator {
         lastState = state;
       } else if (antenna == 2) { //DDDUAL
 
-        static uint lastRefSatID = 0;
-        static gtsam::Vector3 lastPosRefSat = gtsam::Vector3(0, 0, 0);
-        static std::vector<fgo::data::CSDataStruct> lastMeasAux;
+        auto &[lastRefSatID, lastPosRefSat, lastMeasAux, lastState] = tdcpAuxEpoch_;
 
         int m = 0;
         if (lastRefSatID == refSatID) { //if new ref sat just skip
@@ -606,7 +673,8 @@ namespace fgo::integrator {
               if (n != -1) {
                 if (paramPtr_->useDDCarrierPhase) {
 
-                  auto noise_model = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(0.001)); //TODO
+                  auto noise_model = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                                     gtsam::Vector1(0.001), 0.); //TODO
                   graphPtr_->emplace_shared<fgo::factor::AmbiguityLockFactor>(amb_i, n, amb_j, m, noise_model);
 
                 } else {
@@ -655,15 +723,10 @@ namespace fgo::integrator {
                                       bool lastGNSSInterpolated = false) {
       ///DEFINE AMBIGUITY COMPLETLY NEW DOESNOT BELONG TO STATE BUT TO MEASUREMENT, JUST GET INCREMENTED WITH NEW MEAS
       ///THEREFORE WE CAN IGNORE DRIFT IN MEASUREMENT
-      static double halfStateBetweenTime =
+      const double halfStateBetweenTime =
         (double) paramPtr_->optFrequency / (double) paramPtr_->IMUMeasurementFrequency / 2. * 0.8;  // 0.04s
-      static std::vector<fgo::data::GNSSObs> lastObsVector;
-      static gtsam::Key last_amb = N(0);
-      static bool notCreatNewCycleSlipFactor = false;
-      static bool syncAmbIndexWithState = false;
-      static size_t lastlastObsSize = 0;
-      static StateMeasSyncStatus lastMeasSyncStatus = status;
-      static size_t lastKeyIndex = 0;
+      auto &[lastObsVector, last_amb, notCreatNewCycleSlipFactor, syncAmbIndexWithState,
+             lastlastObsSize] = tdNormalCPEpoch_;
 
       // when no data do nothing
       if (lastObsVector.empty() && obsVector.empty()) {
@@ -678,7 +741,8 @@ namespace fgo::integrator {
                             "onTDCP: adding amb softlock factor for: " << lastObsVector.size() << " sat.");
 
         for (size_t i = 0; i < lastObsVector.size(); i++) {
-          auto noise_model = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(1000));
+          auto noise_model = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                             gtsam::Vector1(1000), 0.);
           graphPtr_->emplace_shared<fgo::factor::AmbiguitySoftLockFactor>(last_amb, i, noise_model);
         }
         notCreatNewCycleSlipFactor = false;
@@ -826,13 +890,15 @@ namespace fgo::integrator {
             }
             // calculate noise model for CSfactor
             if (!notCreatNewCycleSlipFactor) {
-              boost::shared_ptr<gtsam::noiseModel::Diagonal> noise_model2;
+              gtsam::SharedNoiseModel noise_model2;
               if (obs.cycleSlip) {
                 RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), "TDCP Factor on cycleSlip!");
-                noise_model2 = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(1000));
+                noise_model2 = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                               gtsam::Vector1(1000), 0.);
               } else {
                 //RCLCPP_WARN_STREAM(appPtr_->get_logger(), "TDCP Factor NO cycleSlip!");
-                noise_model2 = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(0.01));
+                noise_model2 = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                               gtsam::Vector1(0.01), 0.);
               }
               graphPtr_->emplace_shared<fgo::factor::CycleSlipFactor>(last_amb, this_amb, i, j, noise_model2);
             }
@@ -844,7 +910,8 @@ namespace fgo::integrator {
         }
         if (!found) {
           RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), "NEW Satellite: " << obs.satId << " at vec: " << j);
-          auto noise_model = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(10000));
+          auto noise_model = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                             gtsam::Vector1(10000), 0.);
           graphPtr_->emplace_shared<fgo::factor::AmbiguitySoftLockFactor>(this_amb, j, noise_model);
         }
         j++;
@@ -856,7 +923,8 @@ namespace fgo::integrator {
           RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
                              "Old Satellite " << obs.satId << " fell out of TDCP: " << gtsam::symbolIndex(last_amb)
                                               << " place in vec: " << j);
-          auto noise_model = gtsam::noiseModel::Diagonal::Variances(gtsam::Vector1(10000));
+          auto noise_model = graph::assignConstantNoiseModel(fgo::data::NoiseModel::GAUSSIAN,
+                                                             gtsam::Vector1(10000), 0.);
           graphPtr_->emplace_shared<fgo::factor::AmbiguitySoftLockFactor>(last_amb, j, noise_model);
         }
         j++;
@@ -874,10 +942,7 @@ namespace fgo::integrator {
                                 const gtsam::Point3 &posRefSat, const uint &refSatID, const gtsam::Point3 &posBase,
                                 const std::shared_ptr<fgo::models::GPInterpolator> &interpolator_i,
                                 const std::shared_ptr<fgo::models::GPInterpolator> &interpolator_j, size_t stateJ) {
-      static uint lastRefSatID = -1;
-      static gtsam::Vector3 lastPosRefSat = gtsam::Vector3(0, 0, 0);
-      static std::vector<fgo::data::CSDataStruct> lastMeasurement;
-      static size_t lastStateJ = 0;
+      auto &[lastRefSatID, lastPosRefSat, lastMeasurement, lastStateJ] = gpTDCPEpoch_;
 
       if (lastRefSatID == refSatID) {
         for (const auto &obs: obsVector) {
@@ -47,6 +47,7 @@
 #include "factor/odometry/GPInterpolatedNavPoseFactor.h"
 #include "solver/FixedLagSmoother.h"
 #include "sensor/SensorCalibrationManager.h"
+#include "data/MeasurementBatch.h"
 
 namespace fgo::integrator {
   using namespace fgo::integrator::param;
@@ -88,6 +89,7 @@ namespace fgo::integrator {
   protected:
     std::string integratorName_;
     std::string sensorName_;
+    sensor::SensorHandle sensorHandle_ = sensor::InvalidSensorHandle;
     bool isPrimarySensor_ = false;
 
     rclcpp::Node *rosNodePtr_{}; // ROS Node Handle.
@@ -374,6 +376,11 @@ namespace fgo::integrator {
                                                       poseVar,
                                                       integratorBaseParamPtr_->robustParamOdomPose,
                                                       "addNavPoseFactor");
+      addNavPoseFactor(poseKey, poseMeasured, noiseModel);
+    }
+
+    void addNavPoseFactor(const gtsam::Key &poseKey, const gtsam::Pose3 &poseMeasured,
+                          const gtsam::SharedNoiseModel &noiseModel) {
       graphPtr_->emplace_shared<fgo::factor::NavPoseFactor>(poseKey, poseMeasured, noiseModel);
     }
 
@@ -386,6 +393,15 @@ namespace fgo::integrator {
                                                       poseVar,
                                                       integratorBaseParamPtr_->robustParamOdomPose,
                                                       "addNavPoseFactor");
+      addGPinteporatedNavPoseFactor(poseKeyI, velKeyI, omegaKeyI, poseKeyJ, velKeyJ, omegaKeyJ, poseMeasured,
+                                    noiseModel, interpolator);
+    }
+
+    void
+    addGPinteporatedNavPoseFactor(const gtsam::Key &poseKeyI, const gtsam::Key &velKeyI, const gtsam::Key &omegaKeyI,
+                                  const gtsam::Key &poseKeyJ, const gtsam::Key &velKeyJ, const gtsam::Key &omegaKeyJ,
+                                  const gtsam::Pose3 &poseMeasured, const gtsam::SharedNoiseModel &noiseModel,
+                                  const std::shared_ptr<fgo::models::GPInterpolator> &interpolator) {
       graphPtr_->emplace_shared<fgo::factor::GPInterpolatedNavPoseFactor>(poseKeyI, velKeyI, omegaKeyI, poseKeyJ,
                                                                           velKeyJ, omegaKeyJ,
                                                                           poseMeasured,
@@ -394,6 +410,36 @@ namespace fgo::integrator {
     }
 
 
+    /***
+     * create an interpolator between two states, the interpolators are not shared between factors
+     * @param syncResult synchronization of the measurement timestamp
+     * @param stateIDAccMap accelerations of the states, WNOJ only
+     */
+    std::shared_ptr<fgo::models::GPInterpolator> createInterpolator(
+      const StateMeasSyncResult &syncResult,
+      const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap) {
+      const double deltaT = syncResult.timestampJ - syncResult.timestampI;
+      const double tau = syncResult.durationFromStateI;
+      const auto Qc = gtsam::noiseModel::Diagonal::Variances(integratorBaseParamPtr_->QcGPInterpolatorFull);
+
+      if (integratorBaseParamPtr_->gpType == fgo::data::GPModelType::WNOJ) {
+        auto interpolator = std::make_shared<fgo::models::GPWNOJInterpolator>(
+          Qc, deltaT, tau, integratorBaseParamPtr_->AutoDiffGPInterpolatedFactor,
+          integratorBaseParamPtr_->GPInterpolatedFactorCalcJacobian);
+        if (!stateIDAccMap.empty()) {
+          const auto [foundI, accI, foundJ, accJ] = findAccelerationToState(syncResult.keyIndexI, stateIDAccMap);
+          interpolator->recalculate(deltaT, tau, accI, accJ);
+        }
+        return interpolator;
+      } else if (integratorBaseParamPtr_->gpType == fgo::data::GPModelType::WNOA) {
+        return std::make_shared<fgo::models::GPWNOAInterpolator>(
+          Qc, deltaT, tau, integratorBaseParamPtr_->AutoDiffGPInterpolatedFactor,
+          integratorBaseParamPtr_->GPInterpolatedFactorCalcJacobian);
+      }
+      RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": NO gpType chosen. Please choose.");
+      return nullptr;
+    }
+
     /***
      * initialize the common integrator parameters
      */
@@ -470,6 +516,7 @@ namespace fgo::integrator {
                          "StateSensorSyncTimeThreshold: " << StateSensorSyncTimeThreshold.value());
 
       sensorCalibManager_ = graphPtr.getSensorCalibManagerPtr();
+      sensorHandle_ = sensorCalibManager_->registerSensor(sensorName_);
       pubSensorReport_ = rosNodePtr_->create_publisher<irt_nav_msgs::msg::SensorProcessingReport>(
         "sensor_processing_report/" + integratorName_,
         rclcpp::SystemDefaultsQoS());
@@ -515,6 +562,12 @@ namespace fgo::integrator {
 
     virtual void cleanBuffers() {};
 
+    /***
+     * drop the working state carried from one graph extension to the next, e.g. to restart the estimation after a
+     * divergence. Must not be called while the graph is being constructed.
+     */
+    virtual void reset() {};
+
     virtual void notifyOptimization(double noOptimizationDuration) {
       noOptimizationDuration_ = 0.;
     };
@@ -536,6 +589,12 @@ namespace fgo::integrator {
 
     virtual void dropMeasurementBefore(double timestamp) {};
 
+    /***
+     * feed the measurements of an offline replay epoch, the integrator takes the channels it is configured for
+     * @param batch measurements of the epoch in named, typed channels
+     */
+    virtual void feedOfflineData(const fgo::data::MeasurementBatch &batch) {};
+
     std::string getName() { return integratorName_; }
 
     [[nodiscard]] bool isPrimarySensor() const { return isPrimarySensor_; }
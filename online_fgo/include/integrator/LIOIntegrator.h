@@ -35,7 +35,7 @@ namespace fgo::integrator
     {
         std::shared_ptr<fgo::models::GPInterpolator> interpolatorI_;
         std::shared_ptr<fgo::models::GPInterpolator> interpolatorJ_;
-        IntegratorOdomParamsPtr integratorParamPtr_;
+        IntegratorLIOParamsPtr integratorParamPtr_;
         std::vector<fgo::data::OdomResult> odomResults_;
         std::shared_ptr<sensors::LiDAR::LIOSAM::LIOSAMOdometry> LIOSAM_;
 
@@ -78,6 +78,20 @@ namespace fgo::integrator
           noOptimizationDuration_ = noOptimizationDuration;
           LIOSAM_->notifyOptimization();
         }
+
+    protected:
+        /***
+         * noise model of a LiDAR pose weighted with the registration Hessian: the configured variances are lower bounds
+         * and are inflated up to degenerateVarScale in the weakly constrained directions, e.g. along tunnels and
+         * highways, so that these directions are left to the other sensors and the motion prior
+         * @param odom LiDAR odometry
+         * @param poseVar configured variances [rot, trans]
+         * @param factorName
+         * @return noise model with full information, diagonal if the Hessian is not used or not available
+         */
+        gtsam::SharedNoiseModel registrationNoiseModel(const fgo::data::Odom &odom,
+                                                       const gtsam::Vector6 &poseVar,
+                                                       const std::string &factorName) const;
     };
 }
 #endif //ONLINE_FGO_LIOINTEGRATOR_H
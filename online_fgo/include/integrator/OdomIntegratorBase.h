@@ -23,22 +23,237 @@
 #pragma once
 
 #include "IntegratorBase.h"
+#include "factor/odometry/BetweenFactor.h"
+#include "factor/odometry/GPInterpolatedDoublePose3BetweenFactor.h"
+#include "factor/odometry/GPInterpolatedSinglePose3BetweenFactor.h"
 
 namespace fgo::integrator
 {
+    /***
+     * relative pose of a sensor between two scans or frames, estimated by an odometry frontend
+     */
+    struct RelativePoseMeasurement
+    {
+        double timestampPrevious = 0.;
+        double timestampCurrent = 0.;
+        gtsam::Pose3 poseRelative;  // T^{sensor previous}_{sensor current}
+        gtsam::Matrix6 covariance = gtsam::Matrix6::Identity();  // in the local coordinates [omega, v] of poseRelative
+        bool scaleObservable = true;  // false if the translation is only a direction, e.g. monocular odometry
+    };
+
+    /***
+     * Base of the integrators of odometry frontends which run inside of the integrator: the frontends buffer relative
+     * poses of the sensor, which are resolved in the base frame and synchronized with the states at both timestamps.
+     * Depending on the synchronization, a between factor or a single or double GP interpolated between factor is
+     * added, as for the LiDAR odometry.
+     */
     class OdomIntegratorBase : public IntegratorBase
     {
     protected:
-        std::shared_ptr<fgo::models::GPInterpolator> interpolatorI_;
-        std::shared_ptr<fgo::models::GPInterpolator> interpolatorJ_;
-        IntegratorOdomParamsPtr paramPtr_;
-        std::vector<fgo::data_types::OdomResult> odomResults_;
+        IntegratorOdomParamsPtr odomParamPtr_;
+        fgo::data::CircularDataBuffer<RelativePoseMeasurement> odomBuffer_;
+        std::vector<RelativePoseMeasurement> restOdom_;
+        std::string factorName_ = "OdomBetweenFactor";
 
     public:
         explicit OdomIntegratorBase() = default;
+        ~OdomIntegratorBase() override = default;
+
+        bool checkHasMeasurements() override
+        {
+          return odomBuffer_.size() != 0 || !restOdom_.empty();
+        }
+
+        void cleanBuffers() override
+        {
+          odomBuffer_.clean();
+        }
+
+        void reset() override
+        {
+          odomBuffer_.clean();
+          restOdom_.clear();
+        }
+
+        void dropMeasurementBefore(double timestamp) override
+        {
+          odomBuffer_.cleanBeforeTime(timestamp);
+        }
+
+        bool fetchResult(
+            const gtsam::Values& result,
+            const gtsam::Marginals& martinals,
+            const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap& keyIndexTimestampMap,
+            fgo::data::State& optState
+        ) override { return true; }
+
+    protected:
+        /***
+         * read the parameters of the odometry factors shared by all odometry integrators
+         * @param paramPtr parameters of the derived integrator
+         */
+        void initializeOdomParams(const IntegratorOdomParamsPtr& paramPtr)
+        {
+          odomParamPtr_ = paramPtr;
+          odomBuffer_.resize_buffer(100);
+
+          ::utils::RosParameter<bool> notIntegrating("GNSSFGO." + integratorName_ + ".notIntegrating", false,
+                                                     *rosNodePtr_);
+          odomParamPtr_->notIntegrating = notIntegrating.value();
+
+          ::utils::RosParameter<bool> integrateBetweenPose("GNSSFGO." + integratorName_ + ".integrateBetweenPose",
+                                                           true, *rosNodePtr_);
+          odomParamPtr_->integrateBetweenPose = integrateBetweenPose.value();
+
+          ::utils::RosParameter<std::vector<double>> odomPoseVar("GNSSFGO." + integratorName_ + ".odomPoseVar",
+                                                                 std::vector<double>(6, 1e-4), *rosNodePtr_);
+          odomParamPtr_->odomPoseVar = gtsam::Vector6(odomPoseVar.value().data());
+
+          ::utils::RosParameter<std::string> noiseModelOdomPose("GNSSFGO." + integratorName_ + ".noiseModelOdomPose",
+                                                                "gaussian", *rosNodePtr_);
+          setNoiseModelFromParam(noiseModelOdomPose.value(), odomParamPtr_->noiseModelOdomPose, integratorName_);
+          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << " noiseModelOdomPose: "
+                                                                        << noiseModelOdomPose.value());
+
+          ::utils::RosParameter<double> robustParamOdomPose("GNSSFGO." + integratorName_ + ".robustParamOdomPose", 0.5,
+                                                            *rosNodePtr_);
+          odomParamPtr_->robustParamOdomPose = robustParamOdomPose.value();
+        }
+
+        /***
+         * add the factors of all buffered relative poses, relative poses in front of the last state are cached
+         * @param stateIDAccMap accelerations of the states, WNOJ only
+         * @param currentKeyIndexTimestampMap states in the current lag
+         * @param timePredStates predicted states, used to scale relative poses without an observable scale
+         * @param relatedKeys
+         * @param minSpeedUnscaled [m/s] relative poses without an observable scale are dropped below this speed
+         * @return number of integrated relative poses
+         */
+        size_t addRelativePoseFactors(
+          const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>>& stateIDAccMap,
+          const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap& currentKeyIndexTimestampMap,
+          const std::vector<std::pair<rclcpp::Time, fgo::data::State>>& timePredStates,
+          gtsam::KeyVector& relatedKeys,
+          double minSpeedUnscaled = 0.)
+        {
+          auto dataSensor = odomBuffer_.get_all_buffer_and_clean();
+          if (!restOdom_.empty()) {
+            dataSensor.insert(dataSensor.begin(), restOdom_.begin(), restOdom_.end());
+            restOdom_.clear();
+          }
+          if (dataSensor.empty() || !odomParamPtr_->integrateBetweenPose)
+            return 0;
+
+          // relative poses of the sensor are resolved in the base frame: T^b1_b2 = T^b_s T^s1_s2 T^s_b
+          const auto baseFromSensor = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
+          const gtsam::Matrix6 adjoint = baseFromSensor.AdjointMap();
+          const double predictedSpeed = timePredStates.empty() ? 0. :
+                                        timePredStates.back().second.state.velocity().norm();
+
+          size_t numOdom = 0;
+          for (const auto& odom : dataSensor) {
+            const auto syncPrevious = findStateForMeasurement(currentKeyIndexTimestampMap, odom.timestampPrevious,
+                                                              odomParamPtr_);
+            const auto syncCurrent = findStateForMeasurement(currentKeyIndexTimestampMap, odom.timestampCurrent,
+                                                             odomParamPtr_);
+
+            if (syncPrevious.status == StateMeasSyncStatus::CACHED || syncCurrent.status == StateMeasSyncStatus::CACHED) {
+              restOdom_.emplace_back(odom);
+              continue;
+            }
+            if (syncPrevious.status == StateMeasSyncStatus::DROPPED ||
+                syncCurrent.status == StateMeasSyncStatus::DROPPED) {
+              RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": dropping odom from " << std::fixed
+                                                                            << odom.timestampPrevious << " to "
+                                                                            << odom.timestampCurrent);
+              continue;
+            }
+            if (!checkStatePresentedInCurrentLag(syncPrevious.keyIndexI)) {
+              RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(),
+                                  integratorName_ << ": not integrating odom because previous state with id "
+                                                  << syncPrevious.keyIndexI << " is not presented in current lag!");
+              continue;
+            }
+
+            const bool previousSynchronized = syncPrevious.status != StateMeasSyncStatus::INTERPOLATED;
+            const bool currentSynchronized = syncCurrent.status != StateMeasSyncStatus::INTERPOLATED;
+            const auto keyPrevious = syncPrevious.status == StateMeasSyncStatus::SYNCHRONIZED_J ?
+                                     syncPrevious.keyIndexJ : syncPrevious.keyIndexI;
+            const auto keyCurrent = syncCurrent.status == StateMeasSyncStatus::SYNCHRONIZED_J ?
+                                    syncCurrent.keyIndexJ : syncCurrent.keyIndexI;
+            if ((previousSynchronized && currentSynchronized && keyPrevious == keyCurrent) ||
+                (!previousSynchronized && !currentSynchronized && syncPrevious.keyIndexI == syncCurrent.keyIndexI)) {
+              RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": odom from " << std::fixed
+                                                                            << odom.timestampPrevious << " to "
+                                                                            << odom.timestampCurrent
+                                                                            << " does not span two states, skipped.");
+              continue;
+            }
 
+            auto poseRelative = odom.poseRelative;
+            gtsam::Matrix6 covariance = odom.covariance;
+            if (!odom.scaleObservable) {
+              // the translation is a unit vector, the metric scale is taken from the predicted speed
+              if (predictedSpeed < minSpeedUnscaled)
+                continue;
+              const double scale = predictedSpeed * (odom.timestampCurrent - odom.timestampPrevious);
+              poseRelative = gtsam::Pose3(poseRelative.rotation(), poseRelative.translation() * scale);
+              gtsam::Matrix6 S = gtsam::Matrix6::Identity();
+              S.bottomRightCorner<3, 3>() *= scale;
+              covariance = S * covariance * S.transpose();
+            }
+            const auto poseRelativeBase = baseFromSensor * poseRelative * baseFromSensor.inverse();
+            const gtsam::Vector6 variance = (adjoint * covariance * adjoint.transpose()).diagonal().cwiseMax(
+              odomParamPtr_->odomPoseVar);
+            const auto noiseModel = graph::assignNoiseModel(odomParamPtr_->noiseModelOdomPose, variance,
+                                                            odomParamPtr_->robustParamOdomPose, factorName_);
 
+            relatedKeys.emplace_back(X(syncPrevious.keyIndexI));
+            relatedKeys.emplace_back(X(syncCurrent.keyIndexJ));
+            numOdom++;
+            if (odomParamPtr_->notIntegrating)
+              continue;
 
+            if (!previousSynchronized && !currentSynchronized) {
+              const auto interpolatorI = createInterpolator(syncPrevious, stateIDAccMap);
+              const auto interpolatorJ = createInterpolator(syncCurrent, stateIDAccMap);
+              if (!interpolatorI || !interpolatorJ)
+                continue;
+              graphPtr_->emplace_shared<fgo::factor::GPInterpolatedDoublePose3BetweenFactor>(
+                X(syncPrevious.keyIndexI), V(syncPrevious.keyIndexI), W(syncPrevious.keyIndexI),
+                X(syncPrevious.keyIndexJ), V(syncPrevious.keyIndexJ), W(syncPrevious.keyIndexJ),
+                X(syncCurrent.keyIndexI), V(syncCurrent.keyIndexI), W(syncCurrent.keyIndexI),
+                X(syncCurrent.keyIndexJ), V(syncCurrent.keyIndexJ), W(syncCurrent.keyIndexJ),
+                poseRelativeBase, interpolatorI, interpolatorJ, noiseModel);
+            } else if (!previousSynchronized && currentSynchronized) {
+              const auto interpolator = createInterpolator(syncPrevious, stateIDAccMap);
+              if (!interpolator)
+                continue;
+              graphPtr_->emplace_shared<fgo::factor::GPInterpolatedSinglePose3BetweenFactor>(
+                X(syncPrevious.keyIndexI), V(syncPrevious.keyIndexI), W(syncPrevious.keyIndexI),
+                X(syncPrevious.keyIndexJ), V(syncPrevious.keyIndexJ), W(syncPrevious.keyIndexJ),
+                X(keyCurrent), poseRelativeBase, false, interpolator, noiseModel);
+            } else if (previousSynchronized && !currentSynchronized) {
+              const auto interpolator = createInterpolator(syncCurrent, stateIDAccMap);
+              if (!interpolator)
+                continue;
+              graphPtr_->emplace_shared<fgo::factor::GPInterpolatedSinglePose3BetweenFactor>(
+                X(syncCurrent.keyIndexI), V(syncCurrent.keyIndexI), W(syncCurrent.keyIndexI),
+                X(syncCurrent.keyIndexJ), V(syncCurrent.keyIndexJ), W(syncCurrent.keyIndexJ),
+                X(keyPrevious), poseRelativeBase, true, interpolator, noiseModel);
+            } else {
+              auto betweenFactor = boost::make_shared<fgo::factor::BetweenFactor<gtsam::Pose3>>(
+                X(keyPrevious), X(keyCurrent), poseRelativeBase, noiseModel);
+              betweenFactor->setTypeID(fgo::factor::FactorTypeID::BetweenPose);
+              betweenFactor->setName(factorName_);
+              graphPtr_->push_back(betweenFactor);
+            }
+          }
+          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": integrated " << numOdom << " of "
+                                                                        << dataSensor.size() << " relative poses, "
+                                                                        << restOdom_.size() << " cached");
+          return numOdom;
+        }
     };
 }
 #endif //ONLINE_FGO_ODOMINTEGRATORBASE_H
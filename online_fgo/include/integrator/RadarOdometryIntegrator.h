@@ -0,0 +1,70 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_RADARODOMETRYINTEGRATOR_H
+#define ONLINE_FGO_RADARODOMETRYINTEGRATOR_H
+
+#pragma once
+
+#include <mutex>
+#include "OdomIntegratorBase.h"
+#include "sensor/radar/RadarOdometry.h"
+
+namespace fgo::integrator {
+
+  /***
+   * Integrates the relative poses of the CPU radar odometry on polar radar scans as between factors. The scans are
+   * motion compensated with the velocity of the last predicted state, so that the integrator can be used alongside
+   * of the LIOIntegrator. The scans are fed by the offline replay.
+   */
+  class RadarOdometryIntegrator : public OdomIntegratorBase {
+    IntegratorRadarOdometryParamsPtr paramPtr_;
+    std::unique_ptr<sensors::Radar::RadarOdometry> radarOdometry_;
+
+    std::mutex twistMutex_;
+    std::optional<gtsam::Vector6> twistPredicted_;  // body-centric [omega, v] of the radar
+
+  public:
+    explicit RadarOdometryIntegrator() = default;
+
+    ~RadarOdometryIntegrator() override = default;
+
+    void initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr, const std::string &integratorName,
+                    bool isPrimarySensor = false) override;
+
+    bool addFactors(
+      const boost::circular_buffer<std::pair<double, gtsam::Vector3>> &timestampGyroMap,
+      const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap,
+      const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &currentKeyIndexTimestampMap,
+      std::vector<std::pair<rclcpp::Time, fgo::data::State>> &timePredStates,
+      gtsam::Values &values,
+      fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
+      gtsam::KeyVector &relatedKeys) override;
+
+    void feedOfflineData(const fgo::data::MeasurementBatch &batch) override;
+
+    void reset() override {
+      OdomIntegratorBase::reset();
+      if (radarOdometry_)
+        radarOdometry_->reset();
+      std::lock_guard lg(twistMutex_);
+      twistPredicted_.reset();
+    }
+  };
+}
+#endif //ONLINE_FGO_RADARODOMETRYINTEGRATOR_H
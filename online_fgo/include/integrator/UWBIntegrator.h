@@ -0,0 +1,113 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_UWBINTEGRATOR_H
+#define ONLINE_FGO_UWBINTEGRATOR_H
+
+#pragma once
+
+#include <unordered_map>
+#include <gtsam/slam/PriorFactor.h>
+#include <robognss_msgs/msg/uwb.hpp>
+
+#include "IntegratorBase.h"
+#include "factor/uwb/UWBRangeFactor.h"
+#include "factor/uwb/GPInterpolatedUWBRangeFactor.h"
+
+namespace fgo::integrator {
+  using gtsam::symbol_shorthand::L;  // position of the UWB anchors
+  using gtsam::symbol_shorthand::U;  // range bias of the UWB anchors
+
+  /***
+   * Integrates the ranges between an UWB tag on the vehicle and static anchors (or beacons). Each anchor has a
+   * position and a range bias state, which are kept in the lag as long as the anchor is observed. Surveyed anchors
+   * get a tight prior on their position, the positions of the other anchors are estimated. Ranges which are not
+   * synchronized with states are integrated as GP interpolated range factors at the measurement timestamp.
+   */
+  class UWBIntegrator : public IntegratorBase {
+    struct AnchorState {
+      UWBAnchor anchor;
+      gtsam::Point3 position;        // latest estimate
+      gtsam::Vector1 bias = gtsam::Vector1::Zero();
+      double positionVar = 0.;
+      size_t generation = 0;         // increased each time the anchor states are marginalized
+      bool inGraph = false;
+      double lastTimestamp = 0.;
+
+      [[nodiscard]] size_t keyIndex() const { return (generation << 16) | anchor.id; }
+    };
+
+    IntegratorUWBParamsPtr paramPtr_;
+    std::unordered_map<uint16_t, AnchorState> anchorStates_;
+
+    fgo::data::CircularDataBuffer<fgo::data::UWBRange> uwbBuffer_;
+    std::vector<fgo::data::UWBRange> restUWB_;
+    rclcpp::Subscription<robognss_msgs::msg::UWB>::SharedPtr subUWB_;
+
+  public:
+    explicit UWBIntegrator() = default;
+
+    ~UWBIntegrator() override = default;
+
+    void initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr, const std::string &integratorName,
+                    bool isPrimarySensor = false) override;
+
+    bool addFactors(
+      const boost::circular_buffer<std::pair<double, gtsam::Vector3>> &timestampGyroMap,
+      const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap,
+      const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &currentKeyIndexTimestampMap,
+      std::vector<std::pair<rclcpp::Time, fgo::data::State>> &timePredStates,
+      gtsam::Values &values,
+      fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
+      gtsam::KeyVector &relatedKeys) override;
+
+    bool fetchResult(
+      const gtsam::Values &result,
+      const gtsam::Marginals &martinals,
+      const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
+      fgo::data::State &optState) override;
+
+    void feedOfflineData(const fgo::data::MeasurementBatch &batch) override;
+
+    bool checkHasMeasurements() override {
+      return uwbBuffer_.size() != 0 || !restUWB_.empty();
+    }
+
+    void cleanBuffers() override {
+      uwbBuffer_.clean();
+    }
+
+    void dropMeasurementBefore(double timestamp) override {
+      uwbBuffer_.cleanBeforeTime(timestamp);
+    }
+
+    void reset() override;
+
+  protected:
+    void onUWBMsgCb(robognss_msgs::msg::UWB::ConstSharedPtr msg);
+
+    /***
+     * insert the position and bias states of an anchor which is not in the lag (anymore)
+     * @param state anchor
+     * @param timestamp of the measurement
+     * @param values
+     */
+    void insertAnchorStates(AnchorState &state, double timestamp, gtsam::Values &values);
+  };
+}
+#endif //ONLINE_FGO_UWBINTEGRATOR_H
@@ -0,0 +1,71 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_VISUALODOMETRYINTEGRATOR_H
+#define ONLINE_FGO_VISUALODOMETRYINTEGRATOR_H
+
+#pragma once
+
+#include "OdomIntegratorBase.h"
+#include "sensor/camera/VisualOdometry.h"
+
+namespace fgo::integrator {
+
+  /***
+   * Integrates the relative poses of the CPU visual odometry frontend (stereo or monocular, e.g. infrared) as
+   * between factors. Relative poses whose timestamps are not synchronized with states are integrated as GP
+   * interpolated between factors. The images are fed by the offline replay.
+   */
+  class VisualOdometryIntegrator : public OdomIntegratorBase {
+    IntegratorVisualOdometryParamsPtr paramPtr_;
+    std::unique_ptr<sensors::Camera::VisualOdometry> visualOdometry_;
+
+  public:
+    explicit VisualOdometryIntegrator() = default;
+
+    ~VisualOdometryIntegrator() override = default;
+
+    void initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr, const std::string &integratorName,
+                    bool isPrimarySensor = false) override;
+
+    bool addFactors(
+      const boost::circular_buffer<std::pair<double, gtsam::Vector3>> &timestampGyroMap,
+      const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap,
+      const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &currentKeyIndexTimestampMap,
+      std::vector<std::pair<rclcpp::Time, fgo::data::State>> &timePredStates,
+      gtsam::Values &values,
+      fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
+      gtsam::KeyVector &relatedKeys) override {
+      addRelativePoseFactors(stateIDAccMap, currentKeyIndexTimestampMap, timePredStates, relatedKeys,
+                             paramPtr_->minSpeedMono);
+      return true;
+    }
+
+    void feedOfflineData(const fgo::data::MeasurementBatch &batch) override;
+
+    void reset() override {
+      OdomIntegratorBase::reset();
+      if (visualOdometry_)
+        visualOdometry_->reset();
+    }
+
+  protected:
+    void processImages(double timestamp, const cv::Mat &left, const cv::Mat &right = {});
+  };
+}
+#endif //ONLINE_FGO_VISUALODOMETRYINTEGRATOR_H
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <gtsam/geometry/Point3.h>
 #include "graph/param/GraphParams.h"
 
@@ -127,6 +128,8 @@ namespace fgo::integrator::param
         bool onlyRTKFixed = true;
         double robustParamPosition = 0.5;
 
+        std::string offlineDataChannel = "reference_pva";  // channel of the offline replay fed into the integrator
+
 
         IntegratorGNSSLCParams() = default;
         explicit IntegratorGNSSLCParams(const IntegratorBaseParamsPtr &baseParamPtr)  : IntegratorBaseParams(*baseParamPtr){}
@@ -144,6 +147,73 @@ namespace fgo::integrator::param
     };
     typedef std::shared_ptr<IntegratorOdomParams> IntegratorOdomParamsPtr;
 
+    struct IntegratorVisualOdometryParams : IntegratorOdomParams
+    {
+        std::string imageChannel = "stereo_pair";  // "stereo_pair" or "infrared" of the offline replay
+        std::string rightSensorName = "stereo_right";
+        bool stereo = true;
+        double minSpeedMono = 0.5;  // [m/s] monocular odometry is scaled with the predicted speed, skipped below
+
+        IntegratorVisualOdometryParams() = default;
+        explicit IntegratorVisualOdometryParams(const IntegratorBaseParamsPtr &baseParamPtr) : IntegratorOdomParams(baseParamPtr){}
+    };
+    typedef std::shared_ptr<IntegratorVisualOdometryParams> IntegratorVisualOdometryParamsPtr;
+
+    struct IntegratorRadarOdometryParams : IntegratorOdomParams
+    {
+        std::string radarChannel = "radar";
+        bool useVelocityPrior = true;  // motion compensation with the velocity of the last predicted state
+
+        IntegratorRadarOdometryParams() = default;
+        explicit IntegratorRadarOdometryParams(const IntegratorBaseParamsPtr &baseParamPtr) : IntegratorOdomParams(baseParamPtr){}
+    };
+    typedef std::shared_ptr<IntegratorRadarOdometryParams> IntegratorRadarOdometryParamsPtr;
+
+    struct IntegratorLIOParams : IntegratorOdomParams
+    {
+        // the scan-to-map registration Hessian weights the LiDAR poses, the configured variances are lower bounds
+        bool useRegistrationInformation = true;
+        double registrationPointVar = 0.04;  // [m^2] of the point-to-line and point-to-plane residuals
+        double degenerateVarScale = 1e4;     // max. inflation of the configured variances in degenerate directions
+
+        IntegratorLIOParams() = default;
+        explicit IntegratorLIOParams(const IntegratorBaseParamsPtr &baseParamPtr) : IntegratorOdomParams(baseParamPtr){}
+    };
+    typedef std::shared_ptr<IntegratorLIOParams> IntegratorLIOParamsPtr;
+
+    struct UWBAnchor
+    {
+        uint16_t id = 0;
+        gtsam::Point3 position = gtsam::Point3::Zero();  // in ECEF
+        bool estimated = false;  // the position is a prior only and is estimated in the graph
+    };
+
+    struct IntegratorUWBParams : IntegratorBaseParams
+    {
+        std::string offlineDataChannel = "uwb";
+        std::vector<UWBAnchor> anchors;
+
+        double rangeVar = 0.01;                 // [m^2]
+        double minRange = 0.1;                  // [m]
+        double maxRange = 200.;                 // [m]
+        data::NoiseModel noiseModelRange = data::NoiseModel::GAUSSIAN;
+        double robustParamRange = 0.5;
+
+        double anchorPositionVar = 1e-4;        // [m^2] prior of the surveyed anchors
+        double estimatedAnchorPositionVar = 4.; // [m^2] prior of the anchors which are estimated
+        bool estimateBias = true;
+        double biasVar = 0.09;                  // [m^2] prior of the per-anchor range bias
+
+        // NLOS ranges are biased positive, the innovation is calculated with the predicted state
+        double nlosInnovationThreshold = 0.5;   // [m] positive innovations above are weighted as NLOS
+        double nlosVarScale = 100.;
+        double maxInnovation = 10.;             // [m] ranges with larger innovations are dropped
+
+        IntegratorUWBParams() = default;
+        explicit IntegratorUWBParams(const IntegratorBaseParamsPtr &baseParamPtr) : IntegratorBaseParams(*baseParamPtr){}
+    };
+    typedef std::shared_ptr<IntegratorUWBParams> IntegratorUWBParamsPtr;
+
     struct IntegratorCorrevitParams : IntegratorBaseParams {
         //IntegratorCorrevitParams() = default;
 
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <array>
 #include "GPInterpolatorBase.h"
 
 
@@ -151,111 +152,20 @@ namespace fgo::models {
 
         return interpolatePose_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
       } else {
-        using namespace gtsam;
-        using namespace fgo::utils;
-
-        Matrix6 Hinv, Hcomp11, Hcomp12, Hlogmap1;
-        Vector6 r;
-        if (H1 || H5)
-          r = Pose3::Logmap(pose1.inverse(&Hinv).compose(pose2, &Hcomp11, &Hcomp12), &Hlogmap1);
-        else
-          r = Pose3::Logmap(pose1.inverse().compose(pose2));
-
-        Matrix63 H1v, H1w, H2v, H2w;
-        Matrix6 H1p, H2p;
-
-        Vector6 v1, v2;
-
-        if (H2 || H3 || H4 || H6 || H8) {
-          v1 = convertVwWbToVbWb(v1_n, omega1_b, pose1, &H1v, &H1w, &H1p);
-          v2 = convertVwWbToVbWb(v2_n, omega2_b, pose2, &H2v, &H2w, &H2p);
-        } else {
-          v1 = convertVwWbToVbWb(v1_n, omega1_b, pose1);
-          v2 = convertVwWbToVbWb(v2_n, omega2_b, pose2);
-        }
-        Matrix6 Jinv = gtsam::Matrix6::Identity();
-
-        if (calcJacobian_) {
-          Jinv = fgo::utils::rightJacobianPose3inv(r);
-        }
-
-        Matrix6 JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * v2);
-
-        const fgo::utils::Vector_18 r1 = (fgo::utils::Vector_18() << gtsam::Vector6::Zero(), v1, acc1).finished();
-        const fgo::utils::Vector_18 r2 = (fgo::utils::Vector_18() << r, Jinv * v2, -0.5 * JinvVel2SkewMatrix * v2 +
-                                                                                   Jinv * acc2).finished();
-
-        Pose3 pose;
-        if (H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8) {
-          const gtsam::Matrix6 V2SkewMatrix = fgo::utils::curlyhat(v2);
-          const gtsam::Matrix6 A2SkewMatrix = fgo::utils::curlyhat(acc2);
-          Matrix6 Hcomp21, Hcomp22, Hlogmap2;
-
-          const gtsam::Vector6 xi_i_tau = Lambda_.block<6, 18>(0, 0) * r1 + Psi_.block<6, 18>(0, 0) * r2;
-
-          Matrix6 JacXiTau = gtsam::Matrix6::Identity();
-          if (calcJacobian_) {
-            JacXiTau = fgo::utils::leftJacobianPose3(xi_i_tau);
-          }
-
-          pose = pose1.compose(Pose3::Expmap(xi_i_tau, &Hlogmap2), &Hcomp21, &Hcomp22);
-
-          Matrix6 Hexpr1 = Hcomp22 * Hlogmap2;
-          Matrix6 Hvel1 = Hexpr1 * Lambda_.block<6, 6>(0, 6) * JacXiTau;
-          Matrix6 Hvel2 = Hexpr1 * (Psi_.block<6, 6>(0, 6) * JacXiTau +
-                                    (-0.5) * Psi_.block<6, 6>(0, 12) * JacXiTau * (JinvVel2SkewMatrix - V2SkewMatrix)) *
-                          Jinv;
-          Matrix6 Hacc1 = Hexpr1 * Lambda_.block<6, 6>(0, 12) * JacXiTau;
-          Matrix6 Hacc2 = Hexpr1 * (Psi_.block<6, 6>(0, 12) * JacXiTau * Jinv);
-          // Matrix6 Hacc1 = Hexpr1 * Lambda_.block<6, 6>(0, 12);
-
-          if (H1) {
-            const Matrix6 J_Ti = Hlogmap1 * Hcomp11 * Hinv;
-            gtsam::Matrix6 Jdiff_Ti = gtsam::Matrix6::Zero();
-            gtsam::Matrix6 Jdiff_TAi = gtsam::Matrix6::Zero();
-
-            if (calcJacobian_) {
-              Matrix6 dr = jacobianMethodNumercialDiff(rightJacobianPose3inv, r, v2);
-              Matrix_12_6 dr_dT1 = (Matrix_12_6() << Matrix6::Identity(), dr).finished();
-              Matrix6 dJinv_dA2 =
-                0.5 * A2SkewMatrix; //jacobianMethodNumercialDiff(rightJacobianPose3inv, r, accJ_) * tmp;
-              Matrix6 dJinv_dV2 = 0.25 * V2SkewMatrix * V2SkewMatrix;
-              *H1 = Hcomp21 +
-                    Hvel1 * H1p +
-                    Hexpr1 * Psi_.block<6, 12>(0, 0) * dr_dT1 * J_Ti +
-                    Hexpr1 * Psi_.block<6, 6>(0, 12) * (dJinv_dV2 + dJinv_dA2) * J_Ti;
-            } else
-              *H1 = Hcomp21 + Hvel1 * H1p + Hexpr1 * Psi_.block<6, 6>(0, 0) * J_Ti;
-          }
-
-          if (H2) *H2 = Hvel1 * H1v;
-          if (H3) *H3 = Hvel1 * H1w;
-
-          if (H4) *H4 = Hacc1;
-
-          if (H5) {
-            const gtsam::Matrix6 J_Tj = Hlogmap1 * Hcomp12;
-            if (calcJacobian_) {
-              const Matrix6 dr_dV21 = jacobianMethodNumercialDiff(rightJacobianPose3inv, r, v2);
-              const Matrix_12_6 dr2_dT2 = (Matrix_12_6() << Matrix6::Identity(), dr_dV21).finished();
-              const Matrix6 dJinv_dA2 =
-                0.5 * A2SkewMatrix; //jacobianMethodNumercialDiff(rightJacobianPose3inv, r, accJ_) * J_Tj;
-              const Matrix6 dJinv_dV2 = 0.25 * V2SkewMatrix *
-                                        V2SkewMatrix; //0.5 * (V2SkewMatrix * (dr_dV21 + Jinv * H2p)); // H2p * A2SkewMatrix * Jinv +
-
-              *H5 = Hvel2 * H2p +
-                    Hexpr1 * Psi_.block<6, 12>(0, 0) * dr2_dT2 * J_Tj +
-                    Hexpr1 * Psi_.block<6, 6>(0, 12) * (dJinv_dV2 + dJinv_dA2) * J_Tj;
-            } else
-              *H5 = Hexpr1 * Psi_.block<6, 6>(0, 0) * J_Tj + Hvel2 * H2p;
-
-          }
-          if (H6) *H6 = Hvel2 * H2v;
-          if (H7) *H7 = Hvel2 * H2w;
-          if (H8) *H8 = Hacc2;
-
-        } else
-          pose = pose1.compose(gtsam::Pose3::Expmap(Lambda_.block<6, 18>(0, 0) * r1 + Psi_.block<6, 18>(0, 0) * r2));
+        const bool calcJacobians = H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8;
+        const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2,
+                                                      calcJacobians);
+        const gtsam::Vector6 xi_i_tau = interpolateXi_(terms, 0);
+        if (!calcJacobians)
+          return pose1.compose(gtsam::Pose3::Expmap(xi_i_tau));
+
+        gtsam::Matrix6 Hexp, Hcomp1, Hcomp2;
+        const auto pose = pose1.compose(gtsam::Pose3::Expmap(xi_i_tau, &Hexp), &Hcomp1, &Hcomp2);
+        auto Hxi = interpolateXiJacobians_(terms, 0);
+        for (auto &H: Hxi)
+          H = Hcomp2 * Hexp * H;
+        chainTermJacobians_(Hxi, terms, H1, H2, H3, H4, H5, H6, H7, H8);
+        if (H1) *H1 += Hcomp1;
         return pose;
       }
     }
@@ -265,25 +175,8 @@ namespace fgo::models {
                      const gtsam::Vector6 &acc1,
                      const gtsam::Pose3 &pose2, const gtsam::Vector3 &v2_n, const gtsam::Vector3 &omega2_b,
                      const gtsam::Vector6 &acc2) const override {
-
-      gtsam::Vector6 r = gtsam::Pose3::Logmap(pose1.inverse().compose(pose2));
-
-      gtsam::Vector6 v1 = fgo::utils::convertVwWbToVbWb(v1_n, omega1_b, pose1);
-      gtsam::Vector6 v2 = fgo::utils::convertVwWbToVbWb(v2_n, omega2_b, pose2);
-
-      gtsam::Matrix6 Jinv = (gtsam::Matrix6() << gtsam::I_3x3, gtsam::Z_3x3, gtsam::Z_3x3, gtsam::I_3x3).finished();
-      if (calcJacobian_) {
-        Jinv = fgo::utils::rightJacobianPose3inv(r);
-      }
-      // eq. (35) and (42) in https://arxiv.org/pdf/1809.06518.pdf
-      //gtsam::Matrix6  JinvVel2SkewMatrix = (gtsam::Matrix6() << X, Y, gtsam::Matrix3::Zero(), X).finished();
-      // here, we have v = [v_omega, v_lin]^T
-      const auto JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * v2);
-      const fgo::utils::Vector_18 r1 = (fgo::utils::Vector_18() << gtsam::Vector6::Zero(), v1, acc1).finished();
-      const fgo::utils::Vector_18 r2 = (fgo::utils::Vector_18() << r, Jinv * v2, -0.5 * JinvVel2SkewMatrix * v2 +
-                                                                                 Jinv * acc2).finished();
-
-      return pose1.compose(gtsam::Pose3::Expmap(Lambda_.block<6, 18>(0, 0) * r1 + Psi_.block<6, 18>(0, 0) * r2));
+      const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
+      return pose1.compose(gtsam::Pose3::Expmap(interpolateXi_(terms, 0)));
     }
 
 
@@ -369,100 +262,22 @@ namespace fgo::models {
 
         return interpolateVelocity_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
       } else {
-        using namespace gtsam;
-        using namespace fgo::utils;
-        Matrix6 Hinv, Hcomp11, Hcomp12, Hlogmap;
-        Vector6 r;
-        if (H1 || H6)
-          r = Pose3::Logmap(pose1.inverse(&Hinv).compose(pose2, &Hcomp11, &Hcomp12), &Hlogmap);
-        else
-          r = Pose3::Logmap(pose1.inverse().compose(pose2));
-
-        // vel
-        Matrix63 H1v, H1w, H2v, H2w;
-        Matrix6 H1p, H2p;
-        Vector6 vel1, vel2;
-        if (H2 || H3 || H5 || H6) {
-          vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1, &H1v, &H1w, &H1p);
-          vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2, &H2v, &H2w, &H2p);
-        } else {
-          vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1);
-          vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2);
-        }
-
-        Matrix6 Jinv = (gtsam::Matrix6() << gtsam::I_3x3, gtsam::Z_3x3, gtsam::Z_3x3, gtsam::I_3x3).finished();
-        Matrix6 JinvVel2SkewMatrix = gtsam::Matrix6::Identity();
-        if (calcJacobian_) {
-          Jinv = fgo::utils::rightJacobianPose3inv(r);
-          // JinvVel2SkewMatrix = (gtsam::Matrix6() <<X, Y, gtsam::Matrix3::Zero(), X).finished();  NOT THIS ONE
-          JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * vel2);
-        }
-
-        const gtsam::Vector6 xi_i_tau = Lambda_.block<6, 6>(0, 6) * vel1 + Lambda_.block<6, 6>(0, 12) * acc1 +
-                                        Psi_.block<6, 6>(0, 0) * r + Psi_.block<6, 6>(0, 6) * Jinv * vel2 +
-                                        Psi_.block<6, 6>(0, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-        const gtsam::Vector6 xi_j_tau = Lambda_.block<6, 6>(6, 6) * vel1 + Lambda_.block<6, 6>(6, 12) * acc1 +
-                                        Psi_.block<6, 6>(6, 0) * r + Psi_.block<6, 6>(6, 6) * Jinv * vel2 +
-                                        Psi_.block<6, 6>(6, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
+        const bool calcJacobians = H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8;
+        const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2,
+                                                      calcJacobians);
+        const gtsam::Vector6 xi_i_tau = interpolateXi_(terms, 0);
+        const gtsam::Vector6 xi_j_tau = interpolateXi_(terms, 6);
         const gtsam::Matrix6 Jac_xi_i_tau = fgo::utils::leftJacobianPose3(xi_i_tau);
-
-        Vector6 vel = Jac_xi_i_tau * xi_j_tau;
-        if (H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8) {
-          const gtsam::Matrix6 V2SkewMatrix = fgo::utils::curlyhat(vel2);
-          const gtsam::Matrix6 A2SkewMatrix = fgo::utils::curlyhat(acc2);
-
-          Matrix6 Hvel1 = Jac_xi_i_tau * Lambda_.block<6, 6>(6, 6);
-          Matrix6 Hvel2 = Jac_xi_i_tau * (Psi_.block<6, 6>(6, 6) * Jinv +
-                                          Psi_.block<6, 6>(6, 12) * -0.5 * (JinvVel2SkewMatrix - V2SkewMatrix * Jinv));
-          Matrix6 Hacc1 = Jac_xi_i_tau * Lambda_.block<6, 6>(6, 12);
-          Matrix6 Hacc2 = Jac_xi_i_tau * Psi_.block<6, 6>(6, 12) * Jinv;
-
-          Matrix6 JinvJacobianVel2 = Matrix6::Zero(), DJinvJacobianVel2 = Matrix6::Zero();
-          Matrix_18_6 dvel_dr = Matrix_18_6::Identity();
-
-          if (calcJacobian_) {
-            JinvJacobianVel2 =
-              0.5 * fgo::utils::curlyhat(vel2); //jacobianMethodNumercialDiff(rightJacobianPose3inv, r, vel2);
-            DJinvJacobianVel2 =
-              -0.5 * fgo::utils::curlyhat(xi_j_tau); //jacobianMethodNumercialDiff(rightJacobianPose3inv, r, xi_j_tau);
-            Hvel1 += DJinvJacobianVel2 * Lambda_.block<6, 6>(0, 6);
-            Hvel2 += DJinvJacobianVel2 * (Psi_.block<6, 6>(0, 6) * Jinv +
-                                          Psi_.block<6, 6>(0, 12) * -0.5 * (JinvVel2SkewMatrix - V2SkewMatrix * Jinv));
-            Hacc1 += DJinvJacobianVel2 * Lambda_.block<6, 6>(0, 12);
-            Hacc2 += DJinvJacobianVel2 * Psi_.block<6, 6>(0, 12) * Jinv;
-            dvel_dr = (Matrix_18_6() << Jinv, JinvJacobianVel2 * Jinv,
-              (0.25 * V2SkewMatrix * V2SkewMatrix + 0.5 * A2SkewMatrix) * Jinv).finished();
-          }
-
-          const gtsam::Matrix dV2Acc = 0.5 * V2SkewMatrix * JinvVel2SkewMatrix;
-
-          if (H1) {
-            const Matrix6 JTi = Hlogmap * Hcomp11 * Hinv;
-            if (calcJacobian_) {
-              *H1 = Jac_xi_i_tau * Psi_.block<6, 18>(6, 0) * dvel_dr * JTi +
-                    DJinvJacobianVel2 * Psi_.block<6, 18>(0, 0) * dvel_dr * JTi + Hvel1 * H1p;
-            } else
-              *H1 = Jac_xi_i_tau * Psi_.block<6, 6>(6, 0) * JTi + Hvel1 * H1p;
-          }
-
-          if (H2) *H2 = Hvel1 * H1v;
-          if (H3) *H3 = Hvel1 * H1w;
-          if (H4) *H4 = Hacc1;
-
-          if (H5) {
-            const gtsam::Matrix6 JTj = Hlogmap * Hcomp12;
-            if (calcJacobian_) {
-              *H5 = Hvel2 * H2p +
-                    Jac_xi_i_tau * Psi_.block<6, 18>(6, 0) * dvel_dr * JTj +
-                    DJinvJacobianVel2 * Psi_.block<6, 18>(0, 0) * dvel_dr * JTj;
-            } else
-              *H5 = Jac_xi_i_tau * Psi_.block<6, 6>(6, 0) * JTj + Hvel2 * H2p;
-          }
-
-          if (H6) *H6 = Hvel2 * H2v;
-          if (H7) *H7 = Hvel2 * H2w;
-          if (H8) *H8 = Hacc2;
-
+        const gtsam::Vector6 vel = Jac_xi_i_tau * xi_j_tau;
+
+        if (calcJacobians) {
+          const auto Hxi_i = interpolateXiJacobians_(terms, 0);
+          const auto Hxi_j = interpolateXiJacobians_(terms, 6);
+          const gtsam::Matrix6 HJac_xi_i = fgo::utils::jacobianLeftJacobianPose3(xi_i_tau, xi_j_tau);
+          TermJacobians Hvel;
+          for (size_t n = 0; n < Hvel.size(); n++)
+            Hvel[n] = Jac_xi_i_tau * Hxi_j[n] + HJac_xi_i * Hxi_i[n];
+          chainTermJacobians_(Hvel, terms, H1, H2, H3, H4, H5, H6, H7, H8);
         }
         return vel;
       }
@@ -473,32 +288,8 @@ namespace fgo::models {
                          const gtsam::Vector6 &acc1,
                          const gtsam::Pose3 &pose2, const gtsam::Vector3 &v2_n, const gtsam::Vector3 &omega2_b,
                          const gtsam::Vector6 &acc2) const override {
-
-      gtsam::Vector6 r = gtsam::Pose3::Logmap(pose1.inverse().compose(pose2));
-
-      gtsam::Vector6 vel1 = fgo::utils::convertVwWbToVbWb(v1_n, omega1_b, pose1);
-      gtsam::Vector6 vel2 = fgo::utils::convertVwWbToVbWb(v2_n, omega2_b, pose2);
-
-      gtsam::Matrix6 Jinv = gtsam::Matrix6::Identity();
-      if (calcJacobian_) {
-        Jinv = fgo::utils::rightJacobianPose3inv(r);
-      }
-
-      // eq. (35) and (42) in https://arxiv.org/pdf/1809.06518.pdf
-      //gtsam::Matrix6  JinvVel2SkewMatrix = (gtsam::Matrix6() << X, Y, gtsam::Matrix3::Zero(), X).finished();
-
-      const auto JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * vel2);
-
-      const gtsam::Vector6 xi_i_tau = Lambda_.block<6, 6>(0, 6) * vel1 + Lambda_.block<6, 6>(0, 12) * acc1 +
-                                      Psi_.block<6, 6>(0, 0) * r + Psi_.block<6, 6>(0, 6) * Jinv * vel2 +
-                                      Psi_.block<6, 6>(0, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-      const gtsam::Vector6 xi_j_tau = Lambda_.block<6, 6>(6, 6) * vel1 + Lambda_.block<6, 6>(6, 12) * acc1 +
-                                      Psi_.block<6, 6>(6, 0) * r + Psi_.block<6, 6>(6, 6) * Jinv * vel2 +
-                                      Psi_.block<6, 6>(6, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-      const gtsam::Matrix6 Jac_xi_i_tau = fgo::utils::leftJacobianPose3(xi_i_tau);
-
-      // const fgo::utils::Vector_18 r2 = (fgo::utils::Vector_18() << r, Jinv * v2, -0.5 * JinvVel2SkewMatrix * v2 + Jinv * accJ).finished();
-      return Jac_xi_i_tau * xi_j_tau;
+      const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
+      return fgo::utils::leftJacobianPose3(interpolateXi_(terms, 0)) * interpolateXi_(terms, 6);
     }
 
     [[nodiscard]] gtsam::Vector6 interpolateAcceleration(
@@ -566,116 +357,33 @@ namespace fgo::models {
 
         return interpolateAcceleration_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
       } else {
-        using namespace gtsam;
-        using namespace fgo::utils;
-        Matrix6 Hinv, Hcomp11, Hcomp12, Hlogmap;
-        Vector6 r;
-        if (H1 || H6)
-          r = Pose3::Logmap(pose1.inverse(&Hinv).compose(pose2, &Hcomp11, &Hcomp12), &Hlogmap);
-        else
-          r = Pose3::Logmap(pose1.inverse().compose(pose2));
-
-        // vel
-        Matrix63 H1v, H1w, H2v, H2w;
-        Matrix6 H1p, H2p;
-        Vector6 vel1, vel2;
-        if (H2 || H3 || H4 || H5 || H7 || H8) {
-          vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1, &H1v, &H1w, &H1p);
-          vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2, &H2v, &H2w, &H2p);
-        } else {
-          vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1);
-          vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2);
-        }
-
-        Matrix6 Jinv = gtsam::Matrix6::Identity();
-        Matrix6 JinvVel2SkewMatrix = gtsam::Matrix6::Identity();
-        if (calcJacobian_) {
-          Jinv = fgo::utils::rightJacobianPose3inv(r);
-          JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * vel2);
-        }
-
-        const gtsam::Vector6 xi_i_tau = Lambda_.block<6, 6>(0, 6) * vel1 + Lambda_.block<6, 6>(0, 12) * acc1 +
-                                        Psi_.block<6, 6>(0, 0) * r + Psi_.block<6, 6>(0, 6) * Jinv * vel2 +
-                                        Psi_.block<6, 6>(0, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-        const gtsam::Vector6 xi_j_tau = Lambda_.block<6, 6>(6, 6) * vel1 + Lambda_.block<6, 6>(6, 12) * acc1 +
-                                        Psi_.block<6, 6>(6, 0) * r + Psi_.block<6, 6>(6, 6) * Jinv * vel2 +
-                                        Psi_.block<6, 6>(6, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-        const gtsam::Vector6 xi_k_tau = Lambda_.block<6, 6>(12, 6) * vel1 + Lambda_.block<6, 6>(12, 12) * acc1 +
-                                        Psi_.block<6, 6>(12, 0) * r + Psi_.block<6, 6>(12, 6) * Jinv * vel2 +
-                                        Psi_.block<6, 6>(12, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-        const auto Jac_xi_i_tau = fgo::utils::leftJacobianPose3(xi_i_tau);
-        const auto curlyhat_xi_j_tau = fgo::utils::curlyhat(xi_j_tau);
-        const auto v_tau = Jac_xi_i_tau * xi_j_tau;
-        const auto curlyhat_v_tau = fgo::utils::curlyhat(v_tau);
-
-        //  const fgo::utils::Vector_18 r2 = (fgo::utils::Vector_18() << r, Jinv * v2, -0.5 * JinvVel2SkewMatrix * v2 + Jinv * accJ).finished();
-        Vector6 acc = Jac_xi_i_tau * (xi_k_tau + 0.5 * fgo::utils::curlyhat(xi_j_tau) * v_tau);
-
-        if (H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8) {
-          const gtsam::Matrix6 V2SkewMatrix = fgo::utils::curlyhat(vel2);
-          const gtsam::Matrix6 A2SkewMatrix = fgo::utils::curlyhat(acc2);
-
-          Matrix6 Hvel1 = Jac_xi_i_tau * Lambda_.block<6, 6>(12, 6);
-          Matrix6 Hvel2 = Jac_xi_i_tau * (Psi_.block<6, 6>(12, 6) * Jinv +
-                                          Psi_.block<6, 6>(12, 12) * -0.5 * (JinvVel2SkewMatrix - V2SkewMatrix * Jinv));
-          Matrix6 Hacc1 = Jac_xi_i_tau * Lambda_.block<6, 6>(12, 12);
-          Matrix6 Hacc2 = Jac_xi_i_tau * Psi_.block<6, 6>(12, 12) * Jinv;
-          //Matrix6 Hacc1 = Lambda_.block<6, 6>(12, 12);
-          //Matrix6 Hacc2 = Psi_.block<6, 6>(12, 12) * Jinv;
-
-          Matrix6 JinvJacobianVel2 = Matrix6::Zero(), J_prep_2 = Matrix6::Zero(), J_prep_3 = Matrix6::Zero();
-          Matrix_18_6 dvel_dr = Matrix_18_6::Identity();
-
-          if (calcJacobian_) {
-            JinvJacobianVel2 =
-              0.5 * fgo::utils::curlyhat(vel2); //jacobianMethodNumercialDiff(rightJacobianPose3inv, r, vel2);
-            J_prep_2 = Jac_xi_i_tau * (-0.5 * curlyhat_v_tau + 0.5 * curlyhat_xi_j_tau * Jac_xi_i_tau);
-            J_prep_3 = -0.25 * Jac_xi_i_tau * curlyhat_xi_j_tau * curlyhat_xi_j_tau -
-                       0.5 * fgo::utils::curlyhat(xi_k_tau + 0.5 * curlyhat_xi_j_tau * v_tau);
-            Hvel1 = Hvel1 + J_prep_2 * Lambda_.block<6, 6>(6, 6) + J_prep_3 * Lambda_.block<6, 6>(0, 6);
-            Hvel2 = Hvel2 + J_prep_2 * (Psi_.block<6, 6>(6, 6) * Jinv +
-                                        Psi_.block<6, 6>(6, 12) * -0.5 * (JinvVel2SkewMatrix - V2SkewMatrix * Jinv)) +
-                    J_prep_3 * (Psi_.block<6, 6>(0, 6) * Jinv +
-                                Psi_.block<6, 6>(0, 12) * -0.5 * (JinvVel2SkewMatrix - V2SkewMatrix * Jinv));
-            Hacc1 = Hacc1 + J_prep_2 * Lambda_.block<6, 6>(6, 12) + J_prep_3 * Lambda_.block<6, 6>(0, 12);
-            Hacc2 = Hacc2 + J_prep_2 * (Psi_.block<6, 6>(6, 12) * Jinv) + J_prep_3 * (Psi_.block<6, 6>(0, 12) * Jinv);
-            dvel_dr = (Matrix_18_6() << Jinv, JinvJacobianVel2 * Jinv,
-              (0.25 * V2SkewMatrix * V2SkewMatrix + 0.5 * A2SkewMatrix) * Jinv).finished();
-          }
-
-
-          const gtsam::Matrix dV2Acc = 0.5 * V2SkewMatrix * JinvVel2SkewMatrix;
-
-          if (H1) {
-            const Matrix6 JTi = Hlogmap * Hcomp11 * Hinv;
-            if (calcJacobian_) {
-              *H1 = Jac_xi_i_tau * Psi_.block<6, 18>(12, 0) * dvel_dr * JTi +
-                    J_prep_2 * Psi_.block<6, 18>(6, 0) * dvel_dr * JTi +
-                    J_prep_3 * Psi_.block<6, 18>(0, 0) * dvel_dr * JTi + Hvel1 * H1p;
-            } else
-              *H1 = Jac_xi_i_tau * Psi_.block<6, 6>(6, 0) * JTi + Hvel1 * H1p;
-          }
-
-          if (H2) *H2 = Hvel1 * H1v;
-          if (H3) *H3 = Hvel1 * H1w;
-
-          if (H4) *H4 = Hacc1;
-
-          if (H5) {
-            const gtsam::Matrix6 JTj = Hlogmap * Hcomp12;
-            if (calcJacobian_) {
-              *H5 = Hvel2 * H2p +
-                    Jac_xi_i_tau * Psi_.block<6, 18>(12, 0) * dvel_dr * JTj +
-                    J_prep_2 * Psi_.block<6, 18>(6, 0) * dvel_dr * JTj +
-                    J_prep_3 * Psi_.block<6, 18>(0, 0) * dvel_dr * JTj;
-            } else
-              *H5 = Jac_xi_i_tau * Psi_.block<6, 6>(6, 0) * JTj + Hvel2 * H2p;
+        const bool calcJacobians = H1 || H2 || H3 || H4 || H5 || H6 || H7 || H8;
+        const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2,
+                                                      calcJacobians);
+        const gtsam::Vector6 xi_i_tau = interpolateXi_(terms, 0);
+        const gtsam::Vector6 xi_j_tau = interpolateXi_(terms, 6);
+        const gtsam::Vector6 xi_k_tau = interpolateXi_(terms, 12);
+        const gtsam::Matrix6 Jac_xi_i_tau = fgo::utils::leftJacobianPose3(xi_i_tau);
+        const gtsam::Matrix6 curlyhat_xi_j_tau = fgo::utils::curlyhat(xi_j_tau);
+        const gtsam::Vector6 v_tau = Jac_xi_i_tau * xi_j_tau;
+        const gtsam::Vector6 a_tau = xi_k_tau + 0.5 * curlyhat_xi_j_tau * v_tau;
+        const gtsam::Vector6 acc = Jac_xi_i_tau * a_tau;
+
+        if (calcJacobians) {
+          const auto Hxi_i = interpolateXiJacobians_(terms, 0);
+          const auto Hxi_j = interpolateXiJacobians_(terms, 6);
+          const auto Hxi_k = interpolateXiJacobians_(terms, 12);
+          const gtsam::Matrix6 HJac_xi_i_v = fgo::utils::jacobianLeftJacobianPose3(xi_i_tau, xi_j_tau);
+          const gtsam::Matrix6 HJac_xi_i_a = fgo::utils::jacobianLeftJacobianPose3(xi_i_tau, a_tau);
+          const gtsam::Matrix6 curlyhat_v_tau = fgo::utils::curlyhat(v_tau);
+          TermJacobians Hacc;
+          for (size_t n = 0; n < Hacc.size(); n++) {
+            const gtsam::Matrix6 Hv_tau = Jac_xi_i_tau * Hxi_j[n] + HJac_xi_i_v * Hxi_i[n];
+            // curlyhat(xi_j_tau) * v_tau = -curlyhat(v_tau) * xi_j_tau
+            const gtsam::Matrix6 Ha_tau = Hxi_k[n] + 0.5 * (curlyhat_xi_j_tau * Hv_tau - curlyhat_v_tau * Hxi_j[n]);
+            Hacc[n] = Jac_xi_i_tau * Ha_tau + HJac_xi_i_a * Hxi_i[n];
           }
-
-          if (H6) *H6 = Hvel2 * H2v;
-          if (H7) *H7 = Hvel2 * H2w;
-          if (H8) *H8 = Hacc2;
-
+          chainTermJacobians_(Hacc, terms, H1, H2, H3, H4, H5, H6, H7, H8);
         }
         return acc;
       }
@@ -686,36 +394,11 @@ namespace fgo::models {
                              const gtsam::Vector6 &acc1,
                              const gtsam::Pose3 &pose2, const gtsam::Vector3 &v2_n, const gtsam::Vector3 &omega2_b,
                              const gtsam::Vector6 &acc2) const override {
-
-      gtsam::Vector6 r = gtsam::Pose3::Logmap(pose1.inverse().compose(pose2));
-
-      gtsam::Vector6 vel1 = fgo::utils::convertVwWbToVbWb(v1_n, omega1_b, pose1);
-      gtsam::Vector6 vel2 = fgo::utils::convertVwWbToVbWb(v2_n, omega2_b, pose2);
-
-      gtsam::Matrix6 Jinv = gtsam::Matrix6::Identity();
-      if (calcJacobian_) {
-        Jinv = fgo::utils::rightJacobianPose3inv(r);
-      }
-
-      // eq. (35) and (42) in https://arxiv.org/pdf/1809.06518.pdf
-      //gtsam::Matrix6  JinvVel2SkewMatrix = (gtsam::Matrix6() << X, Y, gtsam::Matrix3::Zero(), X).finished();
-
-      const auto JinvVel2SkewMatrix = fgo::utils::curlyhat(Jinv * vel2);
-
-      const gtsam::Vector6 xi_i_tau = Lambda_.block<6, 6>(0, 6) * vel1 + Lambda_.block<6, 6>(0, 12) * acc1 +
-                                      Psi_.block<6, 6>(0, 0) * r + Psi_.block<6, 6>(0, 6) * Jinv * vel2 +
-                                      Psi_.block<6, 6>(0, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-      const gtsam::Vector6 xi_j_tau = Lambda_.block<6, 6>(6, 6) * vel1 + Lambda_.block<6, 6>(6, 12) * acc1 +
-                                      Psi_.block<6, 6>(6, 0) * r + Psi_.block<6, 6>(6, 6) * Jinv * vel2 +
-                                      Psi_.block<6, 6>(6, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-      const gtsam::Vector6 xi_k_tau = Lambda_.block<6, 6>(12, 6) * vel1 + Lambda_.block<6, 6>(12, 12) * acc1 +
-                                      Psi_.block<6, 6>(12, 0) * r + Psi_.block<6, 6>(12, 6) * Jinv * vel2 +
-                                      Psi_.block<6, 6>(12, 12) * (-0.5 * JinvVel2SkewMatrix * vel2 + Jinv * acc2);
-      const gtsam::Matrix6 Jac_xi_i_tau = fgo::utils::leftJacobianPose3(xi_i_tau);
-
-      const auto v_tau = Jac_xi_i_tau * xi_j_tau;
-      // const fgo::utils::Vector_18 r2 = (fgo::utils::Vector_18() << r, Jinv * v2, -0.5 * JinvVel2SkewMatrix * v2 + Jinv * accJ).finished();
-      return Jac_xi_i_tau * (xi_k_tau + 0.5 * fgo::utils::curlyhat(xi_j_tau) * v_tau);
+      const auto terms = computeInterpolationTerms_(pose1, v1_n, omega1_b, acc1, pose2, v2_n, omega2_b, acc2);
+      const gtsam::Vector6 xi_j_tau = interpolateXi_(terms, 6);
+      const gtsam::Matrix6 Jac_xi_i_tau = fgo::utils::leftJacobianPose3(interpolateXi_(terms, 0));
+      const gtsam::Vector6 v_tau = Jac_xi_i_tau * xi_j_tau;
+      return Jac_xi_i_tau * (interpolateXi_(terms, 12) + 0.5 * fgo::utils::curlyhat(xi_j_tau) * v_tau);
     }
     /**
     * Testables
@@ -737,6 +420,95 @@ namespace fgo::models {
       //std::cout << "Qc = " << Qc_ << std::endl;
     }
 
+  protected:
+    /// local variables of the interpolation r1 = [0, v1, a1] and r2 = [r, Jinv * v2, -0.5 * curlyhat(Jinv * v2) * v2 +
+    /// Jinv * a2] together with their Jacobians, see eq. (35) and (42) in https://arxiv.org/pdf/1809.06518.pdf
+    struct InterpolationTerms {
+      gtsam::Vector6 r, vel1, vel2;
+      gtsam::Matrix6 Jinv;
+      fgo::utils::Vector_18 r1, r2;
+      // Jacobians of r w.r.t. pose1 and pose2, of vel1 and vel2 w.r.t. their pose, velocity and omega
+      gtsam::Matrix6 Hr_pose1, Hr_pose2, Hvel1_pose1, Hvel2_pose2;
+      gtsam::Matrix63 Hvel1_v1, Hvel1_omega1, Hvel2_v2, Hvel2_omega2;
+      // Jacobians of r2 w.r.t. r, vel2 and acc2
+      fgo::utils::Matrix_18_6 Hr2_r, Hr2_vel2, Hr2_acc2;
+    };
+
+    /// Jacobians of a 6-dim. quantity w.r.t. the local variables r, vel1, acc1, vel2 and acc2
+    typedef std::array<gtsam::Matrix6, 5> TermJacobians;
+
+    [[nodiscard]] InterpolationTerms computeInterpolationTerms_(
+      const gtsam::Pose3 &pose1, const gtsam::Vector3 &v1_n, const gtsam::Vector3 &omega1_b, const gtsam::Vector6 &acc1,
+      const gtsam::Pose3 &pose2, const gtsam::Vector3 &v2_n, const gtsam::Vector3 &omega2_b, const gtsam::Vector6 &acc2,
+      bool calcJacobians = false) const {
+      using namespace gtsam;
+      using namespace fgo::utils;
+      InterpolationTerms terms;
+      if (calcJacobians) {
+        Matrix6 Hinv, Hcomp1, Hcomp2, Hlogmap;
+        terms.r = Pose3::Logmap(pose1.inverse(&Hinv).compose(pose2, &Hcomp1, &Hcomp2), &Hlogmap);
+        terms.Hr_pose1 = Hlogmap * Hcomp1 * Hinv;
+        terms.Hr_pose2 = Hlogmap * Hcomp2;
+        terms.vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1,
+                                       &terms.Hvel1_v1, &terms.Hvel1_omega1, &terms.Hvel1_pose1);
+        terms.vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2,
+                                       &terms.Hvel2_v2, &terms.Hvel2_omega2, &terms.Hvel2_pose2);
+      } else {
+        terms.r = Pose3::Logmap(pose1.inverse().compose(pose2));
+        terms.vel1 = convertVwWbToVbWb(v1_n, omega1_b, pose1);
+        terms.vel2 = convertVwWbToVbWb(v2_n, omega2_b, pose2);
+      }
+
+      terms.Jinv = calcJacobian_ ? rightJacobianPose3inv(terms.r) : Matrix6::Identity();
+      const Vector6 JinvVel2 = terms.Jinv * terms.vel2;
+      const Matrix6 JinvVel2SkewMatrix = curlyhat(JinvVel2);
+      terms.r1 = (Vector_18() << Vector6::Zero(), terms.vel1, acc1).finished();
+      terms.r2 = (Vector_18() << terms.r, JinvVel2,
+        -0.5 * JinvVel2SkewMatrix * terms.vel2 + terms.Jinv * acc2).finished();
+
+      if (calcJacobians) {
+        const Matrix6 V2SkewMatrix = curlyhat(terms.vel2);
+        Matrix6 JdiffV2 = Matrix6::Zero(), JdiffAcc2 = Matrix6::Zero();
+        if (calcJacobian_) {
+          JdiffV2 = jacobianRightJacobianPose3inv(terms.r, terms.vel2);
+          JdiffAcc2 = jacobianRightJacobianPose3inv(terms.r, acc2);
+        }
+        terms.Hr2_r = (Matrix_18_6() << Matrix6::Identity(), JdiffV2,
+          0.5 * V2SkewMatrix * JdiffV2 + JdiffAcc2).finished();
+        terms.Hr2_vel2 = (Matrix_18_6() << Matrix6::Zero(), terms.Jinv,
+          -0.5 * JinvVel2SkewMatrix + 0.5 * V2SkewMatrix * terms.Jinv).finished();
+        terms.Hr2_acc2 = (Matrix_18_6() << Matrix6::Zero(), Matrix6::Zero(), terms.Jinv).finished();
+      }
+      return terms;
+    }
+
+    /// xi_i_tau (row 0), xi_j_tau (row 6) or xi_k_tau (row 12)
+    [[nodiscard]] gtsam::Vector6 interpolateXi_(const InterpolationTerms &terms, Eigen::Index row) const {
+      return Lambda_.block<6, 18>(row, 0) * terms.r1 + Psi_.block<6, 18>(row, 0) * terms.r2;
+    }
+
+    [[nodiscard]] TermJacobians interpolateXiJacobians_(const InterpolationTerms &terms, Eigen::Index row) const {
+      const auto Psi = Psi_.block<6, 18>(row, 0);
+      return {Psi * terms.Hr2_r, Lambda_.block<6, 6>(row, 6), Lambda_.block<6, 6>(row, 12),
+              Psi * terms.Hr2_vel2, Psi * terms.Hr2_acc2};
+    }
+
+    /// chain the Jacobians w.r.t. the local variables to the Jacobians w.r.t. the states
+    static void chainTermJacobians_(const TermJacobians &H, const InterpolationTerms &terms,
+                                    boost::optional<gtsam::Matrix &> H1, boost::optional<gtsam::Matrix &> H2,
+                                    boost::optional<gtsam::Matrix &> H3, boost::optional<gtsam::Matrix &> H4,
+                                    boost::optional<gtsam::Matrix &> H5, boost::optional<gtsam::Matrix &> H6,
+                                    boost::optional<gtsam::Matrix &> H7, boost::optional<gtsam::Matrix &> H8) {
+      if (H1) *H1 = H[0] * terms.Hr_pose1 + H[1] * terms.Hvel1_pose1;
+      if (H2) *H2 = H[1] * terms.Hvel1_v1;
+      if (H3) *H3 = H[1] * terms.Hvel1_omega1;
+      if (H4) *H4 = H[2];
+      if (H5) *H5 = H[0] * terms.Hr_pose2 + H[3] * terms.Hvel2_pose2;
+      if (H6) *H6 = H[3] * terms.Hvel2_v2;
+      if (H7) *H7 = H[3] * terms.Hvel2_omega2;
+      if (H8) *H8 = H[4];
+    }
+
   private:
 
     /** Serialization function */
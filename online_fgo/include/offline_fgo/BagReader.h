@@ -103,22 +103,6 @@ namespace offline_fgo {
             return imuIter_ != imuContainer_.end();
         }
 
-        template <typename Container>
-        typename Container::mapped_type getNextMeasurement(Container& container,
-                                                           const std::string& name = "") {
-            static auto iter = container.begin();
-            if(iter != container.end())
-            {
-                iter++;
-                return iter->second;
-            }
-            else
-            {
-                RCLCPP_ERROR_STREAM(rclcpp::get_logger("gnss_fgo"), "OfflineFGO bag_reader: at last measurement of " << name);
-                return container.end()->second;
-            }
-        }
-
         template<typename Container>
         std::vector<typename Container::mapped_type> getMeasurementsBefore(Container& container,
                                                                            double timestampBefore,
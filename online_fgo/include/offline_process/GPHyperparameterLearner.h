@@ -0,0 +1,129 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_GPHYPERPARAMETERLEARNER_H
+#define ONLINE_FGO_GPHYPERPARAMETERLEARNER_H
+
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <gtsam/geometry/Pose3.h>
+#include "data/DataTypesFGO.h"
+
+namespace offline_process {
+
+  /***
+   * one state of a reference trajectory, the velocity and acceleration are body-centric ([omega, v] as in the GP
+   * motion priors)
+   */
+  struct GPTrajectorySample {
+    double timestamp = 0.;
+    gtsam::Pose3 pose;
+    gtsam::Vector6 velocity = gtsam::Vector6::Zero();
+    gtsam::Vector6 acceleration = gtsam::Vector6::Zero();
+  };
+
+  struct GPHyperparameterLearnerParams {
+    fgo::data::GPModelType gpType = fgo::data::GPModelType::WNOA;
+    double stateInterval = 0.1;          // [s] time between two graph states, the dt of the GP priors
+    double differentiationWindow = 0.1;  // [s] half window of the central differences for velocity and acceleration
+    double segmentDuration = 10.;        // [s] transitions are grouped into segments, evaluated in parallel
+    size_t heldOutEvery = 5;             // every n-th segment is held out for validation, 0 for none
+    std::vector<double> adCandidates = {0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1., 2., 5., 10.};  // Singer only
+    double minQc = 1e-9;
+  };
+
+  struct GPHyperparameterLearnerResult {
+    bool valid = false;
+    gtsam::Vector6 qc = gtsam::Vector6::Ones();   // diagonal of Qc
+    gtsam::Vector6 ad = gtsam::Vector6::Ones();   // diagonal of Ad, Singer only
+    size_t numTrainingTransitions = 0;
+    size_t numHeldOutTransitions = 0;
+    double trainingNegLogLikelihood = 0.;  // per transition
+    double heldOutNegLogLikelihood = 0.;   // per transition
+  };
+
+  /***
+   * Learns the hyperparameters of the GP motion priors (diagonal of Qc and for the Singer prior also of Ad) by
+   * maximizing the likelihood of the prior errors of a reference trajectory sampled at the state interval. For a
+   * diagonal Qc the dimensions decouple and the maximum of Qc is in closed form given the (whitened) prior errors,
+   * so WNOA and WNOJ are learned in one pass; for Singer, Ad is searched over the candidates per dimension with the
+   * profile likelihood. The prior errors of the segments are accumulated in parallel with TBB. Every n-th segment is
+   * held out and only evaluated, so that over-fitting to one part of the drive is visible.
+   */
+  class GPHyperparameterLearner {
+  public:
+    explicit GPHyperparameterLearner(const GPHyperparameterLearnerParams &params) : params_(params) {}
+
+    /***
+     * differentiate a pose trajectory into body-centric velocities and accelerations with central differences
+     * @param timestamps sorted timestamps [s]
+     * @param poses poses at the timestamps
+     * @return samples, the samples without a full differentiation window at the borders are dropped
+     */
+    [[nodiscard]] std::vector<GPTrajectorySample> differentiate(const std::vector<double> &timestamps,
+                                                                const std::vector<gtsam::Pose3> &poses) const;
+
+    /***
+     * @param trajectory samples sorted by time
+     * @return learned hyperparameters, invalid if the trajectory is too short
+     */
+    [[nodiscard]] GPHyperparameterLearnerResult learn(const std::vector<GPTrajectorySample> &trajectory) const;
+
+    /***
+     * write the learned hyperparameters as a ROS 2 parameter file in the format of the config yaml files
+     * @param os
+     * @param result
+     */
+    void writeYAML(std::ostream &os, const GPHyperparameterLearnerResult &result) const;
+
+  private:
+    // states of two consecutive graph states resolved in the local frame of the first one
+    struct Transition {
+      double dt;
+      gtsam::Vector6 pose;  // Logmap of the relative pose
+      gtsam::Vector6 velocityI, accelerationI;
+      gtsam::Vector6 velocityJ, accelerationJ;  // mapped into the tangent space with the inverse right Jacobian
+    };
+
+    // per dimension sum of the whitened squared errors and of the log-determinants with qc = 1
+    struct Statistics {
+      gtsam::Vector6 mahalanobis = gtsam::Vector6::Zero();
+      gtsam::Vector6 logDet = gtsam::Vector6::Zero();
+      size_t count = 0;
+
+      Statistics &operator+=(const Statistics &other);
+    };
+
+    [[nodiscard]] std::vector<Transition> buildTransitions(const std::vector<GPTrajectorySample> &trajectory) const;
+
+    [[nodiscard]] gtsam::Vector priorError(const Transition &transition, size_t dim, double ad) const;
+
+    [[nodiscard]] Statistics accumulate(const std::vector<std::vector<Transition>> &segments,
+                                        bool heldOut, const gtsam::Vector6 &ad) const;
+
+    [[nodiscard]] gtsam::Matrix unitCovariance(double dt, double ad) const;
+
+    [[nodiscard]] size_t numBlocks() const;
+
+    GPHyperparameterLearnerParams params_;
+  };
+}
+
+#endif //ONLINE_FGO_GPHYPERPARAMETERLEARNER_H
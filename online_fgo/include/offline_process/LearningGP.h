@@ -26,6 +26,7 @@
 #pragma once
 
 #include "OfflineFGOBase.h"
+#include "GPHyperparameterLearner.h"
 #include "dataset/DatasetBoreas.h"
 #include "dataset/DatasetDELoco.h"
 
@@ -45,18 +46,45 @@ namespace offline_process {
         //fgo::graph::GraphTimeCentric::Ptr graph_;
         fgo::data::State getPriorState() override;
         StatusGraphConstruction feedDataOffline(const std::vector<double>& stateTimestamps) override;
+        void onOfflineProcessFinished() override;
 
     public:
         //function
-        explicit LearningGP(const rclcpp::NodeOptions &opt);
+        /***
+         * @param sharedDataset already parsed dataset whose data blocks are copied, e.g. in a parameter sweep.
+         * If not given, the dataset is read from the bag.
+         */
+        explicit LearningGP(const rclcpp::NodeOptions &opt,
+                            const std::shared_ptr<const DatasetBoreas> &sharedDataset = nullptr);
         ~LearningGP() override = default;
 
+        /***
+         * reads and parses the Boreas dataset once using the parameters of the given node
+         * @param node node holding the Boreas.* parameters
+         * @param sensorCalibManager calibration used to parse the data
+         * @param source dataset to copy the parsed data blocks from
+         * @return dataset
+         */
+        static std::unique_ptr<DatasetBoreas> loadDatasetBoreas(rclcpp::Node &node,
+                                                                const fgo::sensor::SensorCalibrationManager::Ptr &sensorCalibManager,
+                                                                const std::shared_ptr<const DatasetBoreas> &source = nullptr);
+
     private:
         std::unique_ptr<DatasetBoreas> data_boreas_;
         std::unique_ptr<DatasetDELoco> data_deloco_;
+        bool learnHyperparameters_ = true;
+        std::string learnedHyperparametersYAML_;
+        GPHyperparameterLearnerParams learnerParams_;
+        std::vector<fgo::data::PVASolution> learningReference_;
         StatusGraphConstruction feedDataBoreas(const std::vector<double>& stateTimestamps);
         StatusGraphConstruction feedDataDELoco(const std::vector<double>& stateTimestamps);
 
+        /***
+         * learn the hyperparameters of the configured GP motion prior from the reference collected during the replay,
+         * the result is logged and written to GNSSFGO.LearningGP.outputYAML
+         */
+        void learnHyperparameters();
+
     };
 
 }
@@ -24,12 +24,16 @@
 #define ONLINE_FGO_OFFLINEFGOBASE_H
 #pragma once
 
+#include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <mutex>
 #include <csignal>
 #include <keyboard_handler/keyboard_handler.hpp>
 
 #include "gnss_fgo/GNSSFGOLocalizationBase.h"
+#include "dataset/Dataset.h"
+#include "utils/TrajectoryEvaluator.h"
 //#include "utils/indicators/indicators.hpp"
 
 namespace offline_process {
@@ -57,6 +61,57 @@ namespace offline_process {
     STOPPED, // optimization done or terminated
   };
 
+  /***
+   * summary of an offline process, accumulated while processing the optimization epochs
+   * timing in seconds, errors in meter, m/s and degree respectively
+   */
+  struct OfflineRunStatistics {
+    bool finished = false;  // all planned epochs processed
+    bool failed = false;    // terminated due to an exception
+    double wallTime = 0.;
+    size_t numEpochs = 0;
+    size_t numOptimizations = 0;
+    double durationConstructionSum = 0.;
+    double durationConstructionMax = 0.;
+    double durationOptimizationSum = 0.;
+    double durationOptimizationMax = 0.;
+
+    size_t numErrorSamples = 0;  // only samples with RTK-fixed reference
+    double sqPos2DErrorSum = 0.;
+    double sqPos3DErrorSum = 0.;
+    double pos2DErrorMax = 0.;
+    double sqVel3DErrorSum = 0.;
+    size_t numYawErrorSamples = 0;
+    double sqYawErrorSum = 0.;
+
+    size_t numFullBatchStates = 0;
+    double durationFullBatch = 0.;
+
+    [[nodiscard]] double meanDurationConstruction() const {
+      return numEpochs ? durationConstructionSum / static_cast<double>(numEpochs) : 0.;
+    }
+
+    [[nodiscard]] double meanDurationOptimization() const {
+      return numOptimizations ? durationOptimizationSum / static_cast<double>(numOptimizations) : 0.;
+    }
+
+    [[nodiscard]] double rmsePos2D() const {
+      return numErrorSamples ? std::sqrt(sqPos2DErrorSum / static_cast<double>(numErrorSamples)) : 0.;
+    }
+
+    [[nodiscard]] double rmsePos3D() const {
+      return numErrorSamples ? std::sqrt(sqPos3DErrorSum / static_cast<double>(numErrorSamples)) : 0.;
+    }
+
+    [[nodiscard]] double rmseVel3D() const {
+      return numErrorSamples ? std::sqrt(sqVel3DErrorSum / static_cast<double>(numErrorSamples)) : 0.;
+    }
+
+    [[nodiscard]] double rmseYaw() const {
+      return numYawErrorSamples ? std::sqrt(sqYawErrorSum / static_cast<double>(numYawErrorSamples)) : 0.;
+    }
+  };
+
   using namespace fgo::integrator;
   using namespace fgo::graph;
 
@@ -74,6 +129,17 @@ namespace offline_process {
 
     ~OfflineFGOBase() override;
 
+    /***
+     * blocks until the process thread has finished, only meaningful if the keyboard control is disabled
+     * (GNSSFGO.Offline.interactive: false), otherwise the process waits for keyboard signals
+     */
+    void waitForOfflineProcess();
+
+    OfflineRunStatistics getRunStatistics() {
+      std::lock_guard<std::mutex> lg(run_statistics_mut_);
+      return run_statistics_;
+    }
+
 
   protected:
 
@@ -119,7 +185,22 @@ namespace offline_process {
       RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: Starting the process thread...");
       optThread_ = std::make_unique<std::thread>(
         [this](const double &timestamp_start, const double &timestamp_stop) -> void {
-          this->offlineTimeCentricFGO(timestamp_start, timestamp_stop);
+          const auto start = std::chrono::steady_clock::now();
+          try {
+            this->offlineTimeCentricFGO(timestamp_start, timestamp_stop);
+          }
+          catch (const std::exception &ex) {
+            // an interactive session should crash loudly, a headless one only reports its failure
+            if (interactive_)
+              throw;
+            RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineFGO: process terminated: " << ex.what());
+            std::lock_guard<std::mutex> lg(run_statistics_mut_);
+            run_statistics_.failed = true;
+          }
+          opt_status_ = STOPPED;
+          std::lock_guard<std::mutex> lg(run_statistics_mut_);
+          run_statistics_.wallTime = std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::steady_clock::now() - start).count();
         }, timestamp_start, timestamp_stop);
     };
 
@@ -131,10 +212,52 @@ namespace offline_process {
 
     void processSingleEpoch(const StateIDTimestampMap_t &state_id_timestamps);
 
+    /***
+     * solve the graph of the whole processed drive in one batch and write the smoothed trajectory, only called if
+     * GNSSFGO.Offline.fullBatchSmoothing is enabled
+     */
+    void processFullBatch();
+
+    /***
+     * the states of an offline process are planned from the start of the drive and can't be initialized again,
+     * the graph is reset and the process is terminated as failed
+     */
+    void handleDivergence() override;
+
+    /***
+     * write the smoothed states as csv: timestamp, position, orientation quaternion (w, x, y, z), velocity, imu bias
+     * @param result optimized values
+     * @param keyTimestamps timestamps of the optimized variables
+     * @return false if the file can't be opened
+     */
+    bool writeFullBatchTrajectory(const gtsam::Values &result,
+                                  const fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestamps) const;
+
+    /***
+     * evaluate an estimated trajectory against the reference collected during the replay, the summary is logged and
+     * appended to GNSSFGO.Offline.Evaluation.outputFile
+     * @param name name of the trajectory in the summary
+     * @param estimate states of the trajectory
+     */
+    void evaluateTrajectory(const std::string &name, const std::vector<fgo::data::State> &estimate);
+
+    /***
+     * resolve the states and the reference in a local NED frame at the first reference position, the states at the
+     * reference sensor
+     */
+    std::vector<fgo::utils::TrajectorySample> toLocalTrajectory(const std::vector<fgo::data::State> &states) const;
+
+    std::vector<fgo::utils::TrajectorySample> toLocalTrajectory(const std::vector<fgo::data::PVASolution> &pvas) const;
+
     virtual fgo::data::State getPriorState() = 0;
 
     virtual fgo::graph::StatusGraphConstruction feedDataOffline(const StateTimestamps_t &stateTimestamps) {};
 
+    /***
+     * called by the process thread after the drive has been processed, e.g. to evaluate the collected data
+     */
+    virtual void onOfflineProcessFinished() {};
+
 
   protected:
     void cb_kb_start_pause();
@@ -154,6 +277,18 @@ namespace offline_process {
 
     void propagate_imu(const std::vector<fgo::data::IMUMeasurement> &imus);
 
+    /***
+     * replays one epoch of a dataset: propagates the IMU, feeds the measurements of the batch into all integrators
+     * and extends the graph until the last state timestamp
+     * @param stateTimestamps
+     * @param batch data of the epoch queried from the dataset
+     * @return status of the graph construction
+     */
+    fgo::graph::StatusGraphConstruction feedDataBatch(const StateTimestamps_t &stateTimestamps,
+                                                      const fgo::dataset::DataBatch &batch);
+
+    void onErrorToReference(const irt_nav_msgs::msg::Error2GT &error) override;
+
   private:
     std::condition_variable opt_condition_;
     std::mutex opt_mut_;
@@ -165,6 +300,17 @@ namespace offline_process {
     ProcessOptimizationMode opt_mode_ = ProcessOptimizationMode::LOOP;
     ProcessStatus opt_status_ = ProcessStatus::IDLE;
     std::atomic_uint batch_budget_ = 0;
+    bool interactive_ = true;
+    bool fullBatchSmoothing_ = false;
+    std::string fullBatchOutputCSV_;
+    bool evaluation_ = true;
+    bool evaluationReferenceHasAttitude_ = true;
+    std::string evaluationOutputFile_;
+    fgo::utils::TrajectoryEvaluatorParams evaluationParams_;
+    std::vector<fgo::data::State> evaluationStates_;
+    std::vector<fgo::data::PVASolution> evaluationReference_;
+    std::mutex run_statistics_mut_;
+    OfflineRunStatistics run_statistics_;
 
   protected:
     static SignalHandlerType old_sigint_handler_;
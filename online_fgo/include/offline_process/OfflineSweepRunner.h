@@ -0,0 +1,91 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+//
+// Created by haoming on 18.10.26.
+//
+
+#ifndef ONLINE_FGO_OFFLINESWEEPRUNNER_H
+#define ONLINE_FGO_OFFLINESWEEPRUNNER_H
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+
+#include "OfflineFGOBase.h"
+
+namespace offline_process {
+
+  struct OfflineSweepRun {
+    std::string name;
+    std::vector<rclcpp::Parameter> overrides;  // parameters of the run that differ from the base configuration
+  };
+
+  struct OfflineSweepResult {
+    std::string name;
+    OfflineRunStatistics statistics;
+  };
+
+  /***
+   * Runs the same offline process with several configurations in parallel and collects the timing and accuracy of
+   * each run. The base configuration is given by all parameters of this node except Sweep.*, a run is defined by
+   *    Sweep.runs: ["run_a", "run_b"]
+   *    Sweep.run_a.<parameter>: value   -> overrides <parameter> of the base configuration in run_a
+   * Each run is an independent node living in <runner fully qualified name>/<run> which is created via a factory,
+   * so that the caller decides which application is swept and which data are shared between the runs.
+   * The node options of this node must allow automatically declaring parameters from overrides.
+   */
+  class OfflineSweepRunner : public rclcpp::Node {
+  public:
+    typedef std::function<std::shared_ptr<OfflineFGOBase>(const rclcpp::NodeOptions &)> ProcessFactory;
+
+    explicit OfflineSweepRunner(const rclcpp::NodeOptions &opt);
+
+    ~OfflineSweepRunner() override = default;
+
+    /***
+     * process all configured runs using Sweep.numWorkers threads, blocks until all runs are done
+     * @param factory creates and starts an offline process from the node options of a run
+     * @return results in the order of Sweep.runs
+     */
+    std::vector<OfflineSweepResult> run(const ProcessFactory &factory);
+
+    /***
+     * writes one row per run into the file given by Sweep.outputCSV
+     * @param results
+     * @return file written successfully
+     */
+    bool writeResultsToCSV(const std::vector<OfflineSweepResult> &results) const;
+
+    [[nodiscard]] const std::vector<OfflineSweepRun> &getRuns() const { return runs_; }
+
+  protected:
+    [[nodiscard]] rclcpp::NodeOptions makeRunNodeOptions(const OfflineSweepRun &run) const;
+
+  private:
+    std::vector<OfflineSweepRun> runs_;
+    std::vector<rclcpp::Parameter> baseParameters_;
+    size_t numWorkers_ = 1;
+    std::string outputCSV_;
+  };
+
+}
+#endif //ONLINE_FGO_OFFLINESWEEPRUNNER_H
@@ -24,9 +24,14 @@
 #define ONLINE_FGO_SENSORCALIBRATIONMANAGER_H
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <rclcpp/rclcpp.hpp>
-#include <shared_mutex>
 #include "utils/ROSParameter.h"
 #include "data/DataTypesFGO.h"
 
@@ -39,10 +44,65 @@ namespace fgo::sensor {
     gtsam::Pose3 fromBase;  // transformation w.r.t. of base frame i.a. T^sensor_base
     std::map<std::string, gtsam::Pose3> toOthersMap;  // transformation from this sensor's frame to other's i.a. T^other_sensor
     std::map<std::string, std::vector<double>> intrinsicsRawMap; // todo
+    std::vector<gtsam::Pose3> toOthers;  // same as toOthersMap, indexed by the handle of the other sensor
   };
 
+  // stable index of a sensor in the calibration manager, obtained once via registerSensor
+  using SensorHandle = int32_t;
+  constexpr SensorHandle InvalidSensorHandle = -1;
+
+  // immutable calibration of all sensors, indexed by the sensor handles
+  struct SensorCalibrationSnapshot {
+    std::vector<SensorParameter> sensors;
+  };
+
+  namespace detail {
+    /***
+     * hazard pointers of the calibration readers: a thread announces the snapshot it reads in a slot of its own block,
+     * writers don't free a snapshot that is announced in any slot. The blocks are shared by all managers, as a slot
+     * holds the address of a snapshot.
+     */
+    struct alignas(64) SnapshotHazardBlock {
+      static constexpr size_t NumSlots = 4;  // nested reads of one thread
+      std::array<std::atomic<const void *>, NumSlots> slots{};
+      std::atomic<bool> owned{false};
+    };
+
+    constexpr size_t MaxSnapshotReaders = 256;
+    inline std::array<SnapshotHazardBlock, MaxSnapshotReaders> snapshotHazardBlocks{};
+
+    // claims a block on the first read of a thread and returns it when the thread exits
+    struct SnapshotHazardOwner {
+      SnapshotHazardBlock *block = nullptr;  // none if all blocks are owned
+      size_t depth = 0;  // slots in use
+
+      SnapshotHazardOwner() {
+        for (auto &candidate: snapshotHazardBlocks) {
+          bool expected = false;
+          if (candidate.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            block = &candidate;
+            return;
+          }
+        }
+      }
+
+      ~SnapshotHazardOwner() {
+        if (block)
+          block->owned.store(false, std::memory_order_release);
+      }
+    };
+
+    inline thread_local SnapshotHazardOwner snapshotHazardOwner;
+  }
+
   /**
    * This class is used to manage all sensor calibration parameters including intrinsic and extrinsic
+   * The sensors are fixed after the initialization, hot paths should register a sensor once and query the calibration
+   * by its handle. The calibration is published as immutable snapshots behind an atomic pointer, writers copy the
+   * snapshot, modify it and swap it in under the writer lock. Readers are lock-free and don't touch a shared reference
+   * count: a reader announces the snapshot in a hazard pointer of its thread and re-checks that it is still current.
+   * A replaced snapshot is freed by a later writer once no hazard pointer refers to it. Threads beyond
+   * detail::MaxSnapshotReaders fall back to a shared reader counter, which defers the reclamation while it is non-zero.
    * ToDo: get tf2 involved:
    * ToDO: - publishing static tf links if the a link does not exist
    * ToDo: - reading from tf trees if links are given
@@ -59,58 +119,89 @@ namespace fgo::sensor {
 
       RCLCPP_INFO_STREAM(rosPtr_->get_logger(),
                          "SensorCalibrationManager: initializing sensor calibration parameter manager with "
-                           << sensorMap_.size() << " sensors is done ...");
+                           << handleMap_.size() << " sensors is done ...");
     };
 
-    ~SensorCalibrationManager() = default;
+    ~SensorCalibrationManager() {
+      // no reader is left once the manager is destroyed
+      delete snapshot_.load(std::memory_order_acquire);
+      for (const auto *retired: retired_)
+        delete retired;
+    }
+
+    SensorCalibrationManager(const SensorCalibrationManager &) = delete;
+
+    SensorCalibrationManager &operator=(const SensorCalibrationManager &) = delete;
+
+    /***
+     * @param sensor
+     * @return stable handle of the sensor, InvalidSensorHandle if the sensor is unknown
+     */
+    SensorHandle registerSensor(const std::string &sensor) const {
+      return findHandle(sensor, "registerSensor");
+    }
+
+    gtsam::Rot3 getPreRotation(SensorHandle sensor) const {
+      const auto snapshot = currentSnapshot();
+      if (!isValid(*snapshot, sensor))
+        return {};
+      return snapshot->sensors[sensor].preRotation;
+    }
 
     gtsam::Rot3 getPreRotation(const std::string &sensor) const {
-      std::shared_lock lock(mutex_);
-      const auto iter = sensorMap_.find(sensor);
-      if (iter != sensorMap_.end()) {
-        return sensorMap_.at(sensor).preRotation;
-      } else
-        RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                           "SensorCalibrationManager in getPreRotation: unknown sensor " << sensor);
-      return {};
+      const auto handle = findHandle(sensor, "getPreRotation");
+      return handle == InvalidSensorHandle ? gtsam::Rot3() : getPreRotation(handle);
     }
 
+    gtsam::Pose3 getTransformationFromBase(SensorHandle sensor) const {
+      const auto snapshot = currentSnapshot();
+      if (!isValid(*snapshot, sensor))
+        return {};
+      return snapshot->sensors[sensor].fromBase;
+    }
 
     gtsam::Pose3 getTransformationFromBase(const std::string &sensor) const {
-      std::shared_lock lock(mutex_);
-      const auto iter = sensorMap_.find(sensor);
-      if (iter != sensorMap_.end()) {
-        return sensorMap_.at(sensor).fromBase;
-      } else
-        RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                           "SensorCalibrationManager in getTransformationFromBase: unknown sensor " << sensor);
-      return {};
+      const auto handle = findHandle(sensor, "getTransformationFromBase");
+      return handle == InvalidSensorHandle ? gtsam::Pose3() : getTransformationFromBase(handle);
+    }
+
+    gtsam::Pose3 getTransformationFromBaseToTarget(SensorHandle base,
+                                                   SensorHandle target) const {
+      const auto snapshot = currentSnapshot();
+      if (!isValid(*snapshot, base) || !isValid(*snapshot, target) || base == target)
+        return {};
+      return snapshot->sensors[base].toOthers[target];
     }
 
     gtsam::Pose3 getTransformationFromBaseToTarget(const std::string &base,
                                                    const std::string &target) const {
-      gtsam::Pose3 trans;
-      std::shared_lock lock(mutex_);
-      const auto iter = sensorMap_.find(base);
-      if (iter != sensorMap_.end()) {
-        const auto &baseSensor = sensorMap_.at(base);
-        const auto iter_sub = baseSensor.toOthersMap.find(target);
-        if (iter_sub != baseSensor.toOthersMap.end())
-          trans = baseSensor.toOthersMap.at(target);
-        else
-          RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                             "SensorCalibrationManager in getTransformationFromBaseToTarget: unknown target sensor "
-                               << target);
-        return trans;
-      } else
-        RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                           "SensorCalibrationManager in getTransformationFromBaseToTarget: unknown base sensor "
-                             << target);
-      return trans;
+      const auto base_handle = findHandle(base, "getTransformationFromBaseToTarget");
+      const auto target_handle = findHandle(target, "getTransformationFromBaseToTarget");
+      if (base_handle == InvalidSensorHandle || target_handle == InvalidSensorHandle)
+        return {};
+      return getTransformationFromBaseToTarget(base_handle, target_handle);
+    }
+
+    /***
+     * updates the extrinsic of a sensor, e.g. from an online calibration, and publishes a new snapshot
+     * @param sensor
+     * @param fromBase T^sensor_base
+     */
+    void updateTransformationFromBase(SensorHandle sensor,
+                                      const gtsam::Pose3 &fromBase) {
+      std::lock_guard<std::mutex> lg(writerMutex_);
+      const auto *current = snapshot_.load(std::memory_order_relaxed);
+      if (!isValid(*current, sensor))
+        return;
+      auto next = std::make_unique<SensorCalibrationSnapshot>(*current);
+      next->sensors[sensor].fromBase = fromBase;
+      updateRelativeTransformations(*next);
+      publishSnapshot(std::move(next));
     }
 
     void initialize(const std::string &param_prefix) {
-      std::unique_lock<std::shared_mutex> ul(mutex_);
+      std::lock_guard<std::mutex> lg(writerMutex_);
+      std::map<std::string, SensorParameter> sensorMap;
       const auto param_ns = param_prefix + ".VehicleParameters";
 
       ::utils::RosParameter<std::vector<std::string>> sensors(param_ns + ".sensors", *rosPtr_);
@@ -171,7 +262,7 @@ namespace fgo::sensor {
         }
 
         sensor_param.fromBase = gtsam::Pose3(rot, trans);
-        sensorMap_.insert(std::make_pair(sensor, sensor_param));
+        sensorMap.insert(std::make_pair(sensor, sensor_param));
         RCLCPP_INFO_STREAM(rosPtr_->get_logger(),
                            "** param: " << std::fixed
                                         << "\n***  trans:" << sensor_param.fromBase.translation()
@@ -180,21 +271,13 @@ namespace fgo::sensor {
         RCLCPP_INFO(rosPtr_->get_logger(), "******");
       }
 
-      for (auto &[sen1_name, sen1_param]: sensorMap_) {
-        for (const auto &[sen2_name, sen2_param]: sensorMap_) {
-          if (sen1_name == sen2_name)
-            continue;
-
-          // T^sen2_sen1 = T^sen2_base * inverse(T_sen1_base);
-          const auto trans_between = sen2_param.fromBase.transformPoseFrom(sen1_param.fromBase.inverse());
-          sen1_param.toOthersMap.insert(std::make_pair(sen2_name, trans_between));
-          //RCLCPP_INFO_STREAM(rosPtr_->get_logger(),
-          //                   "** param from " << sen1_name << " to: " << sen2_name << std::fixed
-          //                                   << "\n***  trans:" << trans_between.translation()
-          //                                   << "\n*** rpy: " << trans_between.rotation().rpy() * constants::rad2deg);
-          //RCLCPP_INFO(rosPtr_->get_logger(), "******");
-        }
+      auto snapshot = std::make_unique<SensorCalibrationSnapshot>();
+      for (auto &[sensor_name, sensor_param]: sensorMap) {
+        handleMap_.insert(std::make_pair(sensor_name, static_cast<SensorHandle>(snapshot->sensors.size())));
+        snapshot->sensors.emplace_back(std::move(sensor_param));
       }
+      updateRelativeTransformations(*snapshot);
+      publishSnapshot(std::move(snapshot));
 
       ::utils::RosParameter<std::string> intrinsic_json(param_ns + ".intrinsic_json_path", "", *rosPtr_);
 
@@ -207,24 +290,19 @@ namespace fgo::sensor {
     }
 
     SensorParameter getSensorParameter(const std::string &sensor) const {
-      const auto iter = sensorMap_.find(sensor);
-      if (iter == sensorMap_.end()) {
-        RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                           "SensorCalibrationManager: getSensorParameter unknown sensor " << sensor);
+      const auto handle = findHandle(sensor, "getSensorParameter");
+      if (handle == InvalidSensorHandle)
         return {};
-      }
-      return sensorMap_.at(sensor);
+      return currentSnapshot()->sensors[handle];
     }
 
     void printSensorCalibParam(const std::string &sensor) {
-      const auto iter = sensorMap_.find(sensor);
-      if (iter == sensorMap_.end()) {
-        RCLCPP_WARN_STREAM(rosPtr_->get_logger(),
-                           "SensorCalibrationManager: printSensorCalibParam unknown sensor " << sensor);
+      const auto handle = findHandle(sensor, "printSensorCalibParam");
+      if (handle == InvalidSensorHandle)
         return;
-      }
 
-      const auto &sensorParam = sensorMap_.at(sensor);
+      const auto snapshot = currentSnapshot();
+      const auto &sensorParam = snapshot->sensors[handle];
       std::cout << "********************** PRINTING SENSOR CALIBRATION PARAMETER of " << sensor
                 << " **********************" << std::endl;
       std::cout << "********************** Extrinsic **********************" << std::endl;
@@ -254,10 +332,117 @@ namespace fgo::sensor {
 
 
   private:
+    SensorHandle findHandle(const std::string &sensor,
+                            const std::string &caller) const {
+      const auto iter = handleMap_.find(sensor);
+      if (iter != handleMap_.end())
+        return iter->second;
+      RCLCPP_WARN_STREAM(rosPtr_->get_logger(), "SensorCalibrationManager in " << caller << ": unknown sensor " << sensor);
+      return InvalidSensorHandle;
+    }
+
+    static bool isValid(const SensorCalibrationSnapshot &snapshot,
+                        SensorHandle sensor) {
+      return sensor >= 0 && static_cast<size_t>(sensor) < snapshot.sensors.size();
+    }
+
+    static void updateRelativeTransformations(SensorCalibrationSnapshot &snapshot) {
+      for (auto &sen1_param: snapshot.sensors) {
+        sen1_param.toOthersMap.clear();
+        sen1_param.toOthers.assign(snapshot.sensors.size(), gtsam::Pose3());
+        for (size_t j = 0; j < snapshot.sensors.size(); j++) {
+          const auto &sen2_param = snapshot.sensors[j];
+          if (sen1_param.sensorName == sen2_param.sensorName)
+            continue;
+
+          // T^sen2_sen1 = T^sen2_base * inverse(T_sen1_base);
+          const auto trans_between = sen2_param.fromBase.transformPoseFrom(sen1_param.fromBase.inverse());
+          sen1_param.toOthers[j] = trans_between;
+          sen1_param.toOthersMap.insert(std::make_pair(sen2_param.sensorName, trans_between));
+        }
+      }
+    }
+
+    // keeps the snapshot alive while it is read, even if a writer replaces it meanwhile
+    class SnapshotGuard {
+    public:
+      SnapshotGuard(const SensorCalibrationSnapshot *snapshot, std::atomic<const void *> *slot,
+                    std::atomic<uint32_t> *fallbackReaders)
+        : snapshot_(snapshot), slot_(slot), fallbackReaders_(fallbackReaders) {}
+
+      ~SnapshotGuard() {
+        if (slot_) {
+          slot_->store(nullptr, std::memory_order_release);
+          detail::snapshotHazardOwner.depth--;
+        } else
+          fallbackReaders_->fetch_sub(1, std::memory_order_release);
+      }
+
+      SnapshotGuard(const SnapshotGuard &) = delete;
+
+      SnapshotGuard &operator=(const SnapshotGuard &) = delete;
+
+      const SensorCalibrationSnapshot &operator*() const { return *snapshot_; }
+
+      const SensorCalibrationSnapshot *operator->() const { return snapshot_; }
+
+    private:
+      const SensorCalibrationSnapshot *snapshot_;
+      std::atomic<const void *> *slot_;
+      std::atomic<uint32_t> *fallbackReaders_;
+    };
+
+    /***
+     * lock-free read of the current snapshot, the snapshot is announced in a hazard pointer and re-loaded until the
+     * announced one is still the current one, so a writer that replaces it afterwards sees the announcement
+     */
+    SnapshotGuard currentSnapshot() const {
+      auto &owner = detail::snapshotHazardOwner;
+      if (owner.block && owner.depth < detail::SnapshotHazardBlock::NumSlots) {
+        auto &slot = owner.block->slots[owner.depth];
+        auto *snapshot = snapshot_.load(std::memory_order_seq_cst);
+        while (true) {
+          slot.store(snapshot, std::memory_order_seq_cst);
+          auto *current = snapshot_.load(std::memory_order_seq_cst);
+          if (current == snapshot)
+            break;
+          snapshot = current;
+        }
+        owner.depth++;
+        return {snapshot, &slot, nullptr};
+      }
+      fallbackReaders_.fetch_add(1, std::memory_order_seq_cst);
+      return {snapshot_.load(std::memory_order_seq_cst), nullptr, &fallbackReaders_};
+    }
+
+    /***
+     * swaps in a new snapshot and frees the retired ones that no reader announces anymore,
+     * must be called with writerMutex_ held
+     */
+    void publishSnapshot(std::unique_ptr<const SensorCalibrationSnapshot> snapshot) {
+      retired_.emplace_back(snapshot_.exchange(snapshot.release(), std::memory_order_seq_cst));
+      if (fallbackReaders_.load(std::memory_order_seq_cst) != 0)
+        return;
+      std::vector<const void *> hazards;
+      for (const auto &block: detail::snapshotHazardBlocks)
+        for (const auto &slot: block.slots)
+          if (const auto *hazard = slot.load(std::memory_order_seq_cst))
+            hazards.emplace_back(hazard);
+      const auto still_read = std::partition(retired_.begin(), retired_.end(), [&hazards](const auto *retired) {
+        return std::find(hazards.begin(), hazards.end(), retired) != hazards.end();
+      });
+      for (auto iter = still_read; iter != retired_.end(); iter++)
+        delete *iter;
+      retired_.erase(still_read, retired_.end());
+    }
+
     rclcpp::Node *rosPtr_;
-    mutable std::shared_mutex mutex_;
     std::string baseFrame_;
-    std::map<std::string, SensorParameter> sensorMap_;
+    std::map<std::string, SensorHandle> handleMap_;  // written only during the initialization
+    std::atomic<const SensorCalibrationSnapshot *> snapshot_{new SensorCalibrationSnapshot()};
+    mutable std::atomic<uint32_t> fallbackReaders_{0};  // readers without a hazard pointer
+    std::vector<const SensorCalibrationSnapshot *> retired_;  // replaced snapshots, guarded by writerMutex_
+    std::mutex writerMutex_;
   };
 }
 
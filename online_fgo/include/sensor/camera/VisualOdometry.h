@@ -0,0 +1,173 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_VISUALODOMETRY_H
+#define ONLINE_FGO_VISUALODOMETRY_H
+
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <tbb/task_arena.h>
+#include <gtsam/geometry/Pose3.h>
+
+namespace sensors::Camera {
+
+  enum class FeatureDetectorType {
+    FAST = 0,
+    ORB = 1,  // FAST corners ranked with the Harris score of ORB
+  };
+
+  struct CameraIntrinsics {
+    double fx = 0., fy = 0., cx = 0., cy = 0.;
+    std::vector<double> distortion;  // OpenCV order: k1, k2, p1, p2[, k3]
+
+    [[nodiscard]] cv::Matx33d K() const { return {fx, 0., cx, 0., fy, cy, 0., 0., 1.}; }
+
+    [[nodiscard]] bool valid() const { return fx > 0. && fy > 0.; }
+  };
+
+  struct VisualOdometryParams {
+    CameraIntrinsics left;
+    CameraIntrinsics right;        // stereo only
+    bool stereo = true;            // metric relative poses with PnP on triangulated points, else up to scale
+    gtsam::Pose3 rightFromLeft;    // T^right_left, stereo only
+
+    // detection, the image is split into a grid and the cells are detected in parallel
+    FeatureDetectorType detector = FeatureDetectorType::FAST;
+    int maxFeatures = 400;
+    int minTrackedFeatures = 200;  // features are replenished if less are tracked
+    int gridRows = 4;
+    int gridCols = 6;
+    int fastThreshold = 20;
+    double minFeatureDistance = 15.;  // [px]
+
+    // KLT tracking
+    int kltWindowSize = 21;
+    int kltPyramidLevels = 3;
+    double kltMaxForwardBackwardError = 1.;  // [px]
+
+    // stereo
+    double minDepth = 0.5;   // [m]
+    double maxDepth = 80.;   // [m]
+    double maxStereoReprojectionError = 2.;  // [px] of a triangulated point in both images
+
+    // relative pose
+    double ransacReprojectionThreshold = 2.;  // [px]
+    double ransacConfidence = 0.99;
+    int ransacIterations = 200;
+    int minInliers = 30;
+    double pixelSigma = 1.;   // [px] used for the covariance of the relative pose
+
+    int numThreads = 4;
+  };
+
+  struct VisualOdometryResult {
+    double timestampPrevious = 0.;
+    double timestampCurrent = 0.;
+    gtsam::Pose3 poseRelative;          // T^{camera previous}_{camera current}
+    gtsam::Matrix6 covariance = gtsam::Matrix6::Identity();  // of poseRelative in its local coordinates [omega, v]
+    bool scaleObservable = true;        // false for monocular odometry, translation and its covariance are for a unit baseline
+    size_t numTracked = 0;
+    size_t numInliers = 0;
+  };
+
+  /***
+   * CPU-only, feature-based visual odometry frontend: FAST (or ORB-scored FAST) corners are detected on a grid in
+   * parallel and tracked frame to frame with pyramidal KLT and a forward-backward check. With a stereo camera the
+   * features are triangulated from a KLT match into the right image, and the relative pose of the next frame is
+   * solved with PnP-RANSAC, so that it is metric. With a single camera (e.g. infrared), the relative pose is
+   * recovered from the essential matrix and its translation is only a direction.
+   */
+  class VisualOdometry {
+  public:
+    explicit VisualOdometry(const VisualOdometryParams &params);
+
+    /***
+     * process the next frame
+     * @param timestamp [s]
+     * @param left image of the (left) camera, 8 or 16 bit, gray or color
+     * @param right image of the right camera, ignored for monocular odometry
+     * @return relative pose to the previous frame, none for the first frame or if the pose can't be solved
+     */
+    std::optional<VisualOdometryResult> process(double timestamp, const cv::Mat &left, const cv::Mat &right = {});
+
+    void reset();
+
+    [[nodiscard]] size_t numFeatures() const { return features_.size(); }
+
+  private:
+    struct Feature {
+      cv::Point2f pixel;        // distorted pixel in the left image
+      cv::Point3f point;        // in the left camera frame, stereo only
+      bool hasPoint = false;
+    };
+
+    /***
+     * convert to 8 bit gray, 16 bit images (e.g. infrared) are stretched to their range
+     */
+    static cv::Mat toGray8(const cv::Mat &image);
+
+    [[nodiscard]] std::vector<cv::Point2f> detect(const cv::Mat &image, const std::vector<Feature> &existing) const;
+
+    /***
+     * KLT tracking with forward-backward check
+     * @return status per point
+     */
+    [[nodiscard]] std::vector<uchar> track(const std::vector<cv::Mat> &pyramidFrom, const std::vector<cv::Mat> &pyramidTo,
+                                           const std::vector<cv::Point2f> &from, std::vector<cv::Point2f> &to) const;
+
+    [[nodiscard]] std::vector<cv::Mat> buildPyramid(const cv::Mat &image) const;
+
+    /***
+     * @return normalized image coordinates of the pixels
+     */
+    [[nodiscard]] static std::vector<cv::Point2f> undistort(const std::vector<cv::Point2f> &pixels,
+                                                            const CameraIntrinsics &intrinsics);
+
+    /***
+     * covariance of the relative pose from the Gauss-Newton approximation of the reprojection errors
+     * @param points inlier points in the current camera frame
+     * @param sigma std of the reprojection error in normalized image coordinates
+     */
+    [[nodiscard]] static gtsam::Matrix6 reprojectionCovariance(const std::vector<gtsam::Point3> &points, double sigma);
+
+    void triangulate(const std::vector<cv::Mat> &pyramidLeft, const std::vector<cv::Mat> &pyramidRight);
+
+    [[nodiscard]] std::optional<VisualOdometryResult> solveStereo(const std::vector<Feature> &previous,
+                                                                  const std::vector<cv::Point2f> &tracked,
+                                                                  std::vector<uchar> &inliers) const;
+
+    [[nodiscard]] std::optional<VisualOdometryResult> solveMono(const std::vector<Feature> &previous,
+                                                                const std::vector<cv::Point2f> &tracked,
+                                                                std::vector<uchar> &inliers) const;
+
+    VisualOdometryParams params_;
+    mutable tbb::task_arena arena_;
+    cv::Matx33d KLeft_;
+    std::vector<double> distortionLeft_;
+
+    bool hasPrevious_ = false;
+    double timestampPrevious_ = 0.;
+    std::vector<cv::Mat> pyramidPrevious_;
+    std::vector<Feature> features_;
+  };
+}
+
+#endif //ONLINE_FGO_VISUALODOMETRY_H
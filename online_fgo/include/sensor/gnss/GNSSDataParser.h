@@ -21,6 +21,7 @@
 #define ONLINE_FGO_GNSSTRANSUTILS_H
 #pragma once
 
+#include <array>
 #include <boost/optional.hpp>
 #include <irt_nav_msgs/msg/gnss_obs_pre_processed.hpp>
 #include <irt_nav_msgs/msg/pva_geodetic.hpp>
@@ -39,8 +40,10 @@
 #include "data/DataTypesFGO.h"
 #include "utils/NavigationTools.h"
 #include "utils/GNSSUtils.h"
+#include "utils/AsyncLogger.h"
 #include "integrator/param/IntegratorParams.h"
 #include "utils/MeasurmentDelayCalculator.h"
+#include "sensor/gnss/LOSLookUpTable.h"
 #include "integrator/GNSSTCIntegrator.h"
 
 
@@ -70,7 +73,7 @@ namespace fgo::sensor::gnss {
     pva.error = pvaMsg.error;
     pva.llh = (gtsam::Vector3() << pvaMsg.phi_geo, pvaMsg.lambda_geo, pvaMsg.h_geo).finished();
     pva.xyz_ecef = fgo::utils::llh2xyz(pva.llh);
-    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix(pva.xyz_ecef)).inverse();
+    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(pva.llh)).inverse();
     pva.xyz_var = (gtsam::Vector3() << std::pow(pvaMsg.phi_geo_var, 2), std::pow(pvaMsg.lambda_geo_var, 2), std::pow(
       pvaMsg.h_geo_var, 2)).finished();
     //pva.xyz_var = eRn.rotate(pva.xyz_var);
@@ -121,7 +124,7 @@ namespace fgo::sensor::gnss {
     sol.xyz_var = (gtsam::Vector3() << pva.latitude_stdev, pva.longitude_stdev, pva.height_stdev).finished();
     sol.vel_n = (gtsam::Vector3() << pva.north_velocity, pva.east_velocity, -pva.up_velocity).finished();
 
-    const auto eRned = gtsam::Rot3(fgo::utils::nedRe_Matrix(sol.xyz_ecef)).inverse();
+    const auto eRned = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(sol.llh)).inverse();
     sol.vel_ecef = eRned.rotate(sol.vel_n);
     sol.rot_n = gtsam::Rot3::Yaw(pva.azimuth * fgo::constants::deg2rad);
 
@@ -153,7 +156,7 @@ namespace fgo::sensor::gnss {
     sol.xyz_ecef = fgo::utils::llh2xyz(sol.llh);
     sol.xyz_var = (gtsam::Vector3() << std::pow(bestpos.lat_stdev, 2), std::pow(bestpos.lon_stdev, 2), std::pow(
       bestpos.hgt_stdev, 2)).finished();
-    const auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix(sol.xyz_ecef).inverse());
+    const auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(sol.llh).inverse());
     sol.vel_n = (gtsam::Vector3() << bestvel.hor_speed * std::cos(bestvel.trk_gnd * fgo::constants::deg2rad),
       bestvel.hor_speed * std::sin(bestvel.trk_gnd * fgo::constants::deg2rad),
       -bestvel.ver_speed).finished();
@@ -180,7 +183,7 @@ namespace fgo::sensor::gnss {
     sol.xyz_var = (gtsam::Vector3() << std::pow(bestpos.lat_stdev, 2), std::pow(bestpos.lon_stdev, 2), std::pow(
       bestpos.hgt_stdev, 2)).finished();
 
-    //auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix(sol.xyz_ecef).inverse());
+    //auto ecef_R_ned = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(sol.llh).inverse());
     sol.type = fgo::utils::GNSS::getOEM7PVTSolutionType(bestpos.pos_type.type);
     sol.num_sat = bestpos.num_sol_svs;
     return {sol, PVASolutionToState(sol, leverArm)};
@@ -202,7 +205,7 @@ namespace fgo::sensor::gnss {
     sol.xyz_var = (gtsam::Vector3() << std::pow(navpvt.h_acc * 1e-3, 2), std::pow(navpvt.h_acc * 1e-3, 2),
       std::pow(navpvt.v_acc * 1e-3, 2) * 2).finished();
     sol.vel_n = (gtsam::Vector3() << navpvt.vel_n * 1e-3, navpvt.vel_e * 1e-3, navpvt.vel_d * 1e-3).finished();
-    const auto ned_R_e = gtsam::Rot3(fgo::utils::nedRe_Matrix(sol.xyz_ecef));
+    const auto ned_R_e = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(sol.llh));
     const auto ecef_R_ned = ned_R_e.inverse();
 
     //sol.xyz_var = ecef_R_ned.rotate(sol.xyz_var);
@@ -297,7 +300,7 @@ namespace fgo::sensor::gnss {
                              const integrator::param::IntegratorGNSSTCParamsPtr &paramPtr,
                              bool isMainAnt = true,
                              boost::optional<std::vector<irt_nav_msgs::msg::SatLabel> &> satLabels = boost::none,
-                             boost::optional<std::map<int, bool> &> LOSLoopUp = boost::none) {
+                             const LOSLookUpTable::Epoch *losEpoch = nullptr) {
     //RCLCPP_INFO(this->get_logger(), "/////////////////////////////////////////////");
     //std::list<int> alreadyin;
     for (size_t i = 0; i < gnssObsMsg.prn.size(); i++) {
@@ -309,6 +312,8 @@ namespace fgo::sensor::gnss {
       fgo::data::GNSSObs gnssObs;
       //RCLCPP_INFO_STREAM(this->get_logger(), "PRN: " << gnssObsMsg.prn[i]);
       gnssObs.satId = gnssObsMsg.prn[i];
+      // the message carries no signal type, its carrier phases are L1 observations as they are scaled with lambdaL1
+      gnssObs.frequency = fgo::data::GNSSFrequency::L1;
       //RCLCPP_INFO_STREAM(this->get_logger(), "SatPos: x: " << std::fixed << gnssObsMsg.satelite_pos[i].x << " y: " <<  gnssObsMsg.satelite_pos[i].y << " z: " << gnssObsMsg.satelite_pos[i].z);
       gnssObs.satPos = gtsam::Vector3(gnssObsMsg.satelite_pos[i].x,
                                       gnssObsMsg.satelite_pos[i].y,
@@ -331,15 +336,12 @@ namespace fgo::sensor::gnss {
           gnssObs.prVar = pow(gnssObsMsg.pseudorange_var_measured[i], 2) * paramPtr->pseudorangeVarScaleAntMain;
         }
 
-        if (LOSLoopUp) {
-          auto LOSIter = LOSLoopUp->find(gnssObs.satId);
-          if (LOSIter != LOSLoopUp->end()) {
-            RCLCPP_ERROR_STREAM(rclcpp::get_logger("gnss_fgo"),
-                                "PRN " << gnssObs.satId << " is LOS? " << LOSIter->second);
-            gnssObs.isLOS = LOSIter->second;
-          } else
-            RCLCPP_ERROR_STREAM(rclcpp::get_logger("gnss_fgo"), "PRN " << gnssObs.satId << " NOT IN LOOPUP Table");
-
+        if (losEpoch) {
+          if (const auto isLOS = losEpoch->lookUp(gnssObs.satId))
+            gnssObs.isLOS = *isLOS;
+          else
+            FGO_LOG_DEBUG(fgo::utils::LogModule::GNSS, "PRN not in the LOS look up table",
+                          {"prn", double(gnssObs.satId)});
         }
 
       } else {
@@ -392,20 +394,58 @@ namespace fgo::sensor::gnss {
     }
   }
 
+  /***
+   * cycle slip detection state carried from one GNSS observation to the next, every observation stream needs its own
+   */
+  struct GNSSObservationTrackingState {
+    fgo::utils::GNSS::DefaultSatelliteStateTable locktimeAntMain;
+    fgo::utils::GNSS::DefaultSatelliteStateTable locktimeAntAux;
+    fgo::utils::GNSS::DefaultSatelliteStateTable cycleSlipAux;
+    fgo::utils::GNSS::DefaultSatelliteStateTable cycleSlipRTCM;
+    uint lastRTCMRefSatID = 0;
+    uint lastAuxRefSatID = 0;
+
+    void reset() {
+      // the tables are reset in place, they are too large to be copied around
+      locktimeAntMain.reset();
+      locktimeAntAux.reset();
+      cycleSlipAux.reset();
+      cycleSlipRTCM.reset();
+      lastRTCMRefSatID = 0;
+      lastAuxRefSatID = 0;
+    }
+  };
+
+  /***
+   * copy the cycle slip flags of the observations into the satellite labels
+   * @param obs
+   * @param labels
+   */
+  inline void setCycleSlipLabels(const std::vector<fgo::data::GNSSObs> &obs,
+                                 std::vector<irt_nav_msgs::msg::SatLabel> &labels) {
+    fgo::utils::GNSS::SatelliteIndex<> labelIndex;
+    labelIndex.build(labels, [](const auto &label) { return label.prn; });
+    for (const auto &o: obs) {
+      const auto i = labelIndex.find(o.satId);
+      if (i >= 0)
+        labels[i].cycle_slip = o.cycleSlip;
+    }
+  }
+
+  /***
+   * convert the preprocessed GNSS observations and check them for cycle slips
+   * @param gnssMsg
+   * @param paramPtr
+   * @param trackingState cycle slip detection state of the observation stream, updated in place
+   * @param satLabel
+   * @param losTable line-of-sight labels of the satellites of the main antenna
+   * @return
+   */
   inline fgo::data::GNSSMeasurement convertGNSSObservationMsg(const irt_nav_msgs::msg::GNSSObsPreProcessed &gnssMsg,
                                                               const integrator::param::IntegratorGNSSTCParamsPtr &paramPtr,
-                                                              boost::optional<irt_nav_msgs::msg::GNSSLabeling &> satLabel = boost::none) {
-    static std::map<uint32_t, double> PRNLocktimeMapAntMain = fgo::utils::GNSS::GetInitPRNLocktimeMap();
-    static std::map<uint32_t, double> PRNLocktimeMapAntAux = fgo::utils::GNSS::GetInitPRNLocktimeMap();
-    static std::vector<uint32_t> lastPRNAntMain;
-    static std::vector<uint32_t> lastPRNAntAux;
-    static std::vector<fgo::data::CycleSlipStruct> cycleSlipAux;
-    static std::vector<fgo::data::CycleSlipStruct> cycleSlipRTCM;
-    static std::vector<fgo::data::CycleSlipStruct> cycleSlipMain;
-    static uint lastRTCMRefSatID;
-    static uint lastAuxRefSatID;
-    static uint lastMainRefSatID;
-
+                                                              GNSSObservationTrackingState &trackingState,
+                                                              boost::optional<irt_nav_msgs::msg::GNSSLabeling &> satLabel = boost::none,
+                                                              const LOSLookUpTable *losTable = nullptr) {
     const auto thisGNSSTime = rclcpp::Time(gnssMsg.header.stamp.sec, gnssMsg.header.stamp.nanosec, RCL_ROS_TIME);
     fgo::data::GNSSMeasurement gnssMeas;
 
@@ -416,28 +456,22 @@ namespace fgo::sensor::gnss {
     gnssMeas.measMainAnt.isGGTOValid = gnssMsg.is_ggto_valid;
     gnssMeas.measMainAnt.integrityFlag = gnssMsg.gnss_obs_ant_main.integrity_flag;
 
+    const auto losEpoch = losTable ? losTable->findEpoch(gnssMsg.gnss_obs_ant_main.time_receive) : nullptr;
     if (satLabel) {
-      extractGNSSObs(gnssMsg.gnss_obs_ant_main, gnssMeas.measMainAnt.obs, paramPtr, true, satLabel->ant_main_labels);
+      extractGNSSObs(gnssMsg.gnss_obs_ant_main, gnssMeas.measMainAnt.obs, paramPtr, true, satLabel->ant_main_labels,
+                     losEpoch);
       fgo::utils::GNSS::getRTKCorrectionsFromROSMsg(gnssMsg.gnss_corrections, satLabel->ant_main_labels);
       for (const auto &prn: gnssMsg.faulty_prn_main) {
         if (prn)
           satLabel->faulty_prn_main.emplace_back(prn);
       }
     } else {
-      extractGNSSObs(gnssMsg.gnss_obs_ant_main, gnssMeas.measMainAnt.obs, paramPtr);
+      extractGNSSObs(gnssMsg.gnss_obs_ant_main, gnssMeas.measMainAnt.obs, paramPtr, true, boost::none, losEpoch);
     }
 
-    fgo::utils::GNSS::checkCycleSlipByLocktime(gnssMeas.measMainAnt, PRNLocktimeMapAntMain, lastPRNAntMain);
-    if (satLabel) {
-      for (const auto &obs: gnssMeas.measMainAnt.obs) {
-        for (auto &label: satLabel->ant_main_labels) {
-          if (label.prn == obs.satId) {
-            label.cycle_slip = obs.cycleSlip;
-            break;
-          }
-        }
-      }
-    }
+    fgo::utils::GNSS::checkCycleSlipByLocktime(gnssMeas.measMainAnt, trackingState.locktimeAntMain);
+    if (satLabel)
+      setCycleSlipLabels(gnssMeas.measMainAnt.obs, satLabel->ant_main_labels);
     // RCLCPP_WARN_STREAM(this->get_logger(), "------- Main Ant LockTime Start: --------");
     //for(const auto& obs : gnssMeas.measMainAnt.obs)
     //{
@@ -473,17 +507,9 @@ namespace fgo::sensor::gnss {
       } else
         extractGNSSObs(gnssMsg.gnss_obs_ant_aux, gnssMeas.measAuxAnt.obs, paramPtr, false);
 
-      fgo::utils::GNSS::checkCycleSlipByLocktime(gnssMeas.measAuxAnt, PRNLocktimeMapAntAux, lastPRNAntAux);
-      if (satLabel) {
-        for (const auto &obs: gnssMeas.measAuxAnt.obs) {
-          for (auto &label: satLabel->ant_aux_labels) {
-            if (label.prn == obs.satId) {
-              label.cycle_slip = obs.cycleSlip;
-              break;
-            }
-          }
-        }
-      }
+      fgo::utils::GNSS::checkCycleSlipByLocktime(gnssMeas.measAuxAnt, trackingState.locktimeAntAux);
+      if (satLabel)
+        setCycleSlipLabels(gnssMeas.measAuxAnt.obs, satLabel->ant_aux_labels);
     }
 
     if (gnssMsg.has_dualantenna_dd && paramPtr->useDualAntennaDD) {
@@ -535,7 +561,8 @@ namespace fgo::sensor::gnss {
       }
 
       extractGNSSObs(gnssMsg.dd_gnss_obs_dualantenna, gnssMeas.measDualAntennaDD.obs, paramPtr);
-      fgo::utils::GNSS::checkCycleSlip(gnssMeas.measDualAntennaDD, lastAuxRefSatID, cycleSlipAux, false);
+      fgo::utils::GNSS::checkCycleSlip(gnssMeas.measDualAntennaDD, trackingState.lastAuxRefSatID,
+                                       trackingState.cycleSlipAux, false);
     }
 
     gnssMeas.hasRTK = gnssMsg.has_rtk;
@@ -599,12 +626,15 @@ namespace fgo::sensor::gnss {
         gnssMeas.hasRTCMDD = false;
 
       if (gnssMeas.hasRTCMDD) {
-        RCLCPP_INFO(rclcpp::get_logger("gnss_fgo"), "CycleSlip Start..");
-        fgo::utils::GNSS::checkCycleSlip(gnssMeas.measRTCMDD, lastRTCMRefSatID, cycleSlipRTCM, false);
-        for (fgo::data::CycleSlipStruct &x: cycleSlipRTCM) {
-          RCLCPP_INFO_STREAM(rclcpp::get_logger("gnss_fgo"),
-                             "satID: " << x.satID << " md: " << x.md << " md2: " << x.md2 << " sd2: " << x.sd2 << " N:"
-                                       << x.N);
+        fgo::utils::GNSS::checkCycleSlip(gnssMeas.measRTCMDD, trackingState.lastRTCMRefSatID,
+                                         trackingState.cycleSlipRTCM, false);
+        for (const auto &obs: gnssMeas.measRTCMDD.obs) {
+          const auto state = trackingState.cycleSlipRTCM.find(obs.satId, static_cast<uint32_t>(obs.frequency));
+          if (!state)
+            continue;
+          FGO_LOG_DEBUG(fgo::utils::LogModule::GNSS, "RTCM cycle slip detector", {"satID", double(obs.satId)},
+                        {"md", state->md}, {"md2", state->md2}, {"sd2", state->sd2}, {"N", double(state->N)},
+                        {"cycleSlip", double(obs.cycleSlip)});
         }
       }
     }
@@ -0,0 +1,147 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_LOSLOOKUPTABLE_H
+#define ONLINE_FGO_LOSLOOKUPTABLE_H
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fgo::sensor::gnss {
+
+  /***
+   * Line-of-sight labels of the satellites for a whole dataset. The epochs are stored sorted by time in one contiguous
+   * array, each epoch holds two PRN bitsets (labeled, line-of-sight). An epoch is found through a bucket index over
+   * the time, so a query costs two array accesses.
+   *
+   * The table is either parsed from a CSV file (columns: tow [s], prn, isLOS) or memory mapped from the binary format
+   * written by saveBinary(). When a CSV file is loaded, the binary file <path>.bin is used if it has been converted
+   * from the CSV file of the same size and modification time, otherwise it is created for the next run.
+   */
+  class LOSLookUpTable {
+  public:
+    static constexpr uint32_t MaxPRN = 256;
+    static constexpr double TimeResolution = 0.1;   // resolution of the time of week in the table [s]
+    static constexpr int32_t BucketWidth = 10;      // width of a bucket in TimeResolution ticks
+
+    struct Epoch {
+      int32_t tick = 0;                              // time of week in TimeResolution ticks
+      uint32_t reserved = 0;
+      uint64_t labeled[MaxPRN / 64]{};
+      uint64_t los[MaxPRN / 64]{};
+
+      [[nodiscard]] bool hasLabel(uint32_t prn) const {
+        return prn < MaxPRN && (labeled[prn / 64] >> (prn % 64)) & 1u;
+      }
+
+      [[nodiscard]] bool isLOS(uint32_t prn) const {
+        return prn < MaxPRN && (los[prn / 64] >> (prn % 64)) & 1u;
+      }
+
+      /***
+       * @param prn
+       * @return LOS label of the satellite or nullopt if the satellite is not labeled in this epoch
+       */
+      [[nodiscard]] std::optional<bool> lookUp(uint32_t prn) const {
+        if (!hasLabel(prn))
+          return std::nullopt;
+        return isLOS(prn);
+      }
+    };
+
+    LOSLookUpTable() = default;
+    ~LOSLookUpTable();
+    LOSLookUpTable(const LOSLookUpTable &) = delete;
+    LOSLookUpTable &operator=(const LOSLookUpTable &) = delete;
+
+    /***
+     * load the table from a CSV or binary file, the format is detected by the file header
+     * @param path
+     * @return false if the file can't be read
+     */
+    bool load(const std::string &path);
+
+    /***
+     * parse a CSV file with the columns tow [s], prn, isLOS and a header line
+     * @param path
+     * @return false if the file can't be read
+     */
+    bool loadCSV(const std::string &path);
+
+    /***
+     * memory map a binary table written by saveBinary()
+     * @param path
+     * @return false if the file can't be mapped or is not a valid table, e.g. truncated or with unsorted epochs
+     */
+    bool loadBinary(const std::string &path);
+
+    /***
+     * write the table in the binary format
+     * @param path
+     * @param sourcePath CSV file the table has been parsed from, its size and modification time are stored so that
+     *                   load() ignores the binary table once the CSV file is changed
+     * @return false if the file can't be written
+     */
+    [[nodiscard]] bool saveBinary(const std::string &path, const std::string &sourcePath = "") const;
+
+    void clear();
+
+    [[nodiscard]] bool empty() const { return numEpochs_ == 0; }
+
+    [[nodiscard]] size_t size() const { return numEpochs_; }
+
+    static int32_t toTick(double tow) { return static_cast<int32_t>(std::lround(tow / TimeResolution)); }
+
+    /***
+     * @param tow time of week [s]
+     * @return the labels of the epoch or nullptr if the epoch is not in the table
+     */
+    [[nodiscard]] const Epoch *findEpoch(double tow) const;
+
+    /***
+     * @param tow time of week [s]
+     * @param prn
+     * @return LOS label of the satellite or nullopt if it's not in the table
+     */
+    [[nodiscard]] std::optional<bool> lookUp(double tow, uint32_t prn) const {
+      const auto epoch = findEpoch(tow);
+      return epoch ? epoch->lookUp(prn) : std::nullopt;
+    }
+
+  private:
+    void buildIndex();
+
+    void unmap();
+
+    std::vector<Epoch> storage_;          // owned epochs if parsed from CSV
+    const Epoch *epochs_ = nullptr;       // points into storage_ or into the mapped file
+    size_t numEpochs_ = 0;
+    void *mappedData_ = nullptr;
+    size_t mappedSize_ = 0;
+
+    int32_t firstBucket_ = 0;
+    std::vector<uint32_t> bucketBegin_;   // first epoch of bucket i, bucketBegin_[i + 1] is the end of bucket i
+  };
+}
+
+#endif //ONLINE_FGO_LOSLOOKUPTABLE_H
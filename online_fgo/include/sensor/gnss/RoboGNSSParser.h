@@ -57,7 +57,7 @@ namespace fgo::sensor::gnss {
                                    pvaMsg.lon_deg * fgo::constants::deg2rad,
                                    pvaMsg.height + pva.undulation).finished();
     pva.xyz_ecef = fgo::utils::llh2xyz(pva.llh);
-    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix(pva.xyz_ecef)).inverse();
+    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(pva.llh)).inverse();
     pva.xyz_var = (gtsam::Vector3() << std::pow(pvaMsg.pos_std.x, 2),
                                        std::pow(pvaMsg.pos_std.y, 2),
                                        std::pow(pvaMsg.pos_std.z, 2)).finished();
@@ -161,7 +161,7 @@ namespace fgo::sensor::gnss {
       pvtMsg.lon_deg * fgo::constants::deg2rad,
       pvtMsg.height + pva.undulation).finished();
     pva.xyz_ecef = fgo::utils::llh2xyz(pva.llh);
-    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix(pva.xyz_ecef)).inverse();
+    const auto eRn = gtsam::Rot3(fgo::utils::nedRe_Matrix_asLLH(pva.llh)).inverse();
     pva.xyz_var = (gtsam::Vector3() << std::pow(pvtMsg.pos_std.x, 2),
       std::pow(pvtMsg.pos_std.y, 2),
       std::pow(pvtMsg.pos_std.z, 2)).finished();
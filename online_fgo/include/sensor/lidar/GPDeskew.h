@@ -0,0 +1,155 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_GPDESKEW_H
+#define ONLINE_FGO_GPDESKEW_H
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <vector>
+#include <tbb/task_arena.h>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <lio_sam/msg/cloud_info.hpp>
+
+#include "sensor/lidar/LIOSAMUtils.h"
+#include "data/DataTypesFGO.h"
+#include "integrator/param/IntegratorParams.h"
+#include "model/gp_interpolator/GPInterpolatorBase.h"
+
+struct VelodynePointXYZIRT
+{
+  PCL_ADD_POINT4D
+  PCL_ADD_INTENSITY
+  uint16_t ring;
+  float time;  // [s] relative to the timestamp of the scan
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+} EIGEN_ALIGN16;
+
+POINT_CLOUD_REGISTER_POINT_STRUCT(VelodynePointXYZIRT,
+                                  (float, x, x) (float, y, y) (float, z, z) (float, intensity, intensity)
+                                    (uint16_t, ring, ring) (float, time, time));
+
+struct OusterPointXYZIRT
+{
+  PCL_ADD_POINT4D
+  float intensity;
+  uint32_t t;  // [ns] relative to the timestamp of the scan
+  uint16_t reflectivity;
+  uint8_t ring;
+  uint16_t noise;
+  uint32_t range;
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+} EIGEN_ALIGN16;
+
+POINT_CLOUD_REGISTER_POINT_STRUCT(OusterPointXYZIRT,
+                                  (float, x, x) (float, y, y) (float, z, z) (float, intensity, intensity)
+                                    (uint32_t, t, t) (uint16_t, reflectivity, reflectivity)
+                                    (uint8_t, ring, ring) (uint16_t, noise, noise) (uint32_t, range, range));
+
+namespace sensors::LiDAR::LIOSAM
+{
+  struct GPDeskewParams {
+    SensorType sensor = SensorType::VELODYNE;
+    int N_SCAN = 16;
+    int Horizon_SCAN = 1800;
+    int downsampleRate = 1;
+    float lidarMinRange = 1.;
+    float lidarMaxRange = 1000.;
+    std::string lidarFrame = "velodyne";
+
+    double binDuration = 0.005;  // [s] poses are evaluated on the edges of the bins, points are blended in between
+    double maxExtrapolation = 0.1;  // [s] beyond the last propagated state
+    int numThreads = 4;
+  };
+
+  // states of the estimator the scan is deskewed with
+  struct GPDeskewStates {
+    std::map<double, fgo::data::QueryStateInput> optimized;               // timestamp -> optimized state in ECEF
+    std::vector<std::pair<rclcpp::Time, fgo::data::State>> propagated;  // IMU propagated states in ECEF
+    std::optional<gtsam::Pose3> localWorldInECEF;  // anchor of the map of LIO-SAM, none before the first scan
+  };
+
+  struct GPDeskewReport {
+    size_t numPoints = 0;
+    size_t numBins = 0;
+    size_t numBinsOptimized = 0;   // poses interpolated between optimized states
+    size_t numBinsPropagated = 0;  // poses of the IMU propagation at the head of the window
+  };
+
+  /***
+   * In-process replacement of the image projection of LIO-SAM: the raw cloud is projected into the range image and
+   * motion compensated to the timestamp of the scan. The time of the scan is split into bins, the LiDAR pose is
+   * evaluated on the edges of the bins with the GP interpolator between the optimized states, or with the IMU
+   * propagated states at the head of the window where no optimized state is available yet. The points of each bin
+   * are transformed as one batch and blended linearly between both edges. The result is the deskewed cloud info
+   * which is consumed by the feature extraction of LIO-SAM.
+   */
+  class GPDeskew {
+  public:
+    /***
+     * @param params
+     * @param gpParamPtr GP type and Qc of the interpolators
+     * @param imuTl pose of the LiDAR in the IMU frame
+     */
+    GPDeskew(const GPDeskewParams &params, fgo::integrator::param::IntegratorBaseParamsPtr gpParamPtr,
+             const gtsam::Pose3 &imuTl);
+
+    /***
+     * project and deskew a raw cloud
+     * @param cloud raw cloud with per point timestamps and rings
+     * @param states current states of the estimator
+     * @param report
+     * @return deskewed cloud info, none if the cloud is invalid or the states don't cover the scan
+     */
+    std::optional<lio_sam::msg::CloudInfo> process(const sensor_msgs::msg::PointCloud2 &cloud,
+                                                   const GPDeskewStates &states,
+                                                   GPDeskewReport &report) const;
+
+  private:
+    struct RawPoint {
+      Eigen::Vector3f point;
+      float intensity;
+      float range;
+      int index;    // in the range image
+      double time;  // [s] relative to the timestamp of the scan
+    };
+
+    [[nodiscard]] std::vector<RawPoint> projectCloud(const sensor_msgs::msg::PointCloud2 &cloud) const;
+
+    /***
+     * pose of the IMU at the timestamp
+     * @param timestamp
+     * @param states
+     * @param fromOptimized set if the pose is interpolated between optimized states
+     * @return pose in ECEF, none if the states don't cover the timestamp
+     */
+    [[nodiscard]] std::optional<gtsam::Pose3> queryPose(double timestamp, const GPDeskewStates &states,
+                                                        bool &fromOptimized) const;
+
+    [[nodiscard]] std::shared_ptr<fgo::models::GPInterpolator> createInterpolator() const;
+
+    GPDeskewParams params_;
+    fgo::integrator::param::IntegratorBaseParamsPtr gpParamPtr_;
+    gtsam::Pose3 imuTl_;
+    mutable tbb::task_arena arena_;
+  };
+}
+
+#endif //ONLINE_FGO_GPDESKEW_H
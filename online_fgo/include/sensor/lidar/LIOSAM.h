@@ -45,6 +45,7 @@
 #include <opencv2/opencv.hpp>
 #include <opencv4/opencv2/core/mat.hpp>
 #include "sensor/lidar/LIOSAMUtils.h"
+#include "sensor/lidar/GPDeskew.h"
 #include "data/Buffer.h"
 #include "utils/Constants.h"
 #include "data/DataTypesFGO.h"
@@ -87,6 +88,10 @@ namespace sensors::LiDAR::LIOSAM
         rclcpp::Publisher<irt_nav_msgs::msg::SensorProcessingReport>::SharedPtr pubSensorReport_;
 
         rclcpp::Subscription<lio_sam::msg::CloudInfo>::SharedPtr subCloud_;
+        rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr subRawCloud_;
+        rclcpp::Publisher<lio_sam::msg::CloudInfo>::SharedPtr pubDeskewedCloudInfo_;
+        std::unique_ptr<GPDeskew> deskew_;
+        std::function<std::vector<std::pair<rclcpp::Time, fgo::data::State>>()> propagatedStatesQuery_;
 
         rclcpp::TimerBase::SharedPtr timerLoopDetection_;
         rclcpp::TimerBase::SharedPtr timerMapVisualization_;
@@ -109,6 +114,7 @@ namespace sensors::LiDAR::LIOSAM
         fgo::data::CircularDataBuffer<lio_sam::msg::CloudInfo> lidarInputBuffer_;
         std::shared_ptr<std::thread> odomMainThread_;
         std::atomic_uint64_t keyPoseCounter_ = 1;
+        size_t scanCounter_ = 1;
 
         fgo::data::QueryStateOutput lastQueryStateOutput_;
         double timestampLastKeyPose_ = -1.;
@@ -121,6 +127,8 @@ namespace sensors::LiDAR::LIOSAM
         std::shared_ptr<fgo::models::GPInterpolator> interpolator_;
 
         bool isDegenerate_ = false;
+        size_t numDegenerateDirections_ = 0;
+        gtsam::Matrix6 registrationHessian_ = gtsam::Matrix6::Zero();  // of transformTobeMapped_ in the last iteration
         std::atomic_bool lastOptFinished_ = true;
 
         size_t laserCloudCornerFromMapDSNum_ = 0;
@@ -309,8 +317,17 @@ namespace sensors::LiDAR::LIOSAM
 
         std::tuple<bool, double, double> LiDARLMOptimization(size_t iterCount);
 
+        /***
+         * Hessian of the scan-to-map registration in the local coordinates of the IMU pose
+         * @param lTimu pose of the IMU in the LiDAR frame
+         * @return Hessian [rot, trans] for a unit residual variance, zero if it can't be transformed
+         */
+        [[nodiscard]] gtsam::Matrix6 registrationHessianInIMU(const gtsam::Pose3 &lTimu) const;
+
         void laserCloudInfoHandler(const lio_sam::msg::CloudInfo::SharedPtr msg);
 
+        void rawCloudHandler(const sensor_msgs::msg::PointCloud2::SharedPtr msg);
+
         void loopClosureThread();
 
         void performLoopClosure();
@@ -603,7 +620,7 @@ namespace sensors::LiDAR::LIOSAM
             //RCLCPP_WARN_STREAM(node_.get_logger(), "LIO: pose interpolated: " << std::fixed << poseQueried );
           }
 
-          static const auto imuTl = params_.T_lidar_in_IMU;
+          const auto imuTl = params_.T_lidar_in_IMU;
           const auto poseLiDARECEF = poseQueried.transformPoseFrom(imuTl);
 
           output.poseIMUECEF = poseQueried;
@@ -700,6 +717,26 @@ namespace sensors::LiDAR::LIOSAM
           node_.declare_parameter("OnlineFGO."+ integratorName +".maxPosePriorLiDARMsgAging", 1000.0);
           node_.get_parameter("OnlineFGO."+ integratorName +".maxPosePriorLiDARMsgAging", params_.maxPosePriorLiDARMsgAging);
 
+          std::string sensorType = "velodyne";
+          node_.declare_parameter("OnlineFGO."+ integratorName +".sensor", sensorType);
+          node_.get_parameter("OnlineFGO."+ integratorName +".sensor", sensorType);
+          params_.sensor = sensorType == "ouster" ? SensorType::OUSTER : SensorType::VELODYNE;
+
+          node_.declare_parameter("OnlineFGO."+ integratorName +".deskewInProcess", false);
+          node_.get_parameter("OnlineFGO."+ integratorName +".deskewInProcess", params_.deskewInProcess);
+
+          node_.declare_parameter("OnlineFGO."+ integratorName +".deskewedCloudInfoTopic", "lio_sam/deskew/cloud_info");
+          node_.get_parameter("OnlineFGO."+ integratorName +".deskewedCloudInfoTopic", params_.deskewedCloudInfoTopic);
+
+          node_.declare_parameter("OnlineFGO."+ integratorName +".deskewBinDuration", 0.005);
+          node_.get_parameter("OnlineFGO."+ integratorName +".deskewBinDuration", params_.deskewBinDuration);
+
+          node_.declare_parameter("OnlineFGO."+ integratorName +".deskewMaxExtrapolation", 0.1);
+          node_.get_parameter("OnlineFGO."+ integratorName +".deskewMaxExtrapolation", params_.deskewMaxExtrapolation);
+
+          node_.declare_parameter("OnlineFGO."+ integratorName +".deskewNumThreads", 4);
+          node_.get_parameter("OnlineFGO."+ integratorName +".deskewNumThreads", params_.deskewNumThreads);
+
           node_.declare_parameter("OnlineFGO."+ integratorName +".edgeFeatureMinValidNum", 10);
           node_.get_parameter("OnlineFGO."+ integratorName +".edgeFeatureMinValidNum", params_.edgeFeatureMinValidNum);
 
@@ -736,6 +773,9 @@ namespace sensors::LiDAR::LIOSAM
 
           RCLCPP_INFO_STREAM(node_.get_logger(), "LIOSAM PARAM odom var: \n" << params_.LiDAROdomVariance);
 
+          node_.declare_parameter("OnlineFGO."+ integratorName +".degeneracyEigenThreshold", 100.);
+          node_.get_parameter("OnlineFGO."+ integratorName +".degeneracyEigenThreshold", params_.degeneracyEigenThreshold);
+
           node_.declare_parameter("OnlineFGO."+ integratorName +".surroundingKeyframeSearchRadius", 50.0);
           node_.get_parameter("OnlineFGO."+ integratorName +".surroundingKeyframeSearchRadius", params_.surroundingKeyframeSearchRadius);
 
@@ -867,6 +907,35 @@ namespace sensors::LiDAR::LIOSAM
                                                                              this->laserCloudInfoHandler(msg);
                                                                          },
                                                                          subCloudOpt);
+
+          if(params_.deskewInProcess)
+          {
+            GPDeskewParams deskewParams;
+            deskewParams.sensor = params_.sensor;
+            deskewParams.N_SCAN = params_.N_SCAN;
+            deskewParams.Horizon_SCAN = params_.Horizon_SCAN;
+            deskewParams.downsampleRate = params_.downsampleRate;
+            deskewParams.lidarMinRange = params_.lidarMinRange;
+            deskewParams.lidarMaxRange = params_.lidarMaxRange;
+            deskewParams.lidarFrame = params_.lidarFrame;
+            deskewParams.binDuration = params_.deskewBinDuration;
+            deskewParams.maxExtrapolation = params_.deskewMaxExtrapolation;
+            deskewParams.numThreads = params_.deskewNumThreads;
+            deskew_ = std::make_unique<GPDeskew>(deskewParams, integratorParamPtr_, params_.T_lidar_in_IMU);
+
+            pubDeskewedCloudInfo_ = node_.create_publisher<lio_sam::msg::CloudInfo>(params_.deskewedCloudInfoTopic,
+                                                                                     utils::ros::QoSGeneral);
+            subRawCloud_ = node_.create_subscription<sensor_msgs::msg::PointCloud2>(params_.pointCloudTopic,
+                                                                                   utils::ros::QoSLiDAR,
+                                                                                   [this](const sensor_msgs::msg::PointCloud2::SharedPtr msg)->void
+                                                                                   {
+                                                                                       this->rawCloudHandler(msg);
+                                                                                   },
+                                                                                   subCloudOpt);
+            RCLCPP_INFO_STREAM(node_.get_logger(), "LIOSAM: deskewing " << params_.pointCloudTopic << " in process to "
+                                                   << params_.deskewedCloudInfoTopic);
+          }
+
           if(0 && params_.loopClosureEnableFlag)
           {
             timerLoopDetection_ = node_.create_wall_timer(std::chrono::seconds(params_.freqLoopDetectionInSec),
@@ -926,6 +995,15 @@ namespace sensors::LiDAR::LIOSAM
           }
         }
 
+        /**
+         * set the query of the IMU propagated states, which deskew the head of the scan after the last optimized state
+         * @param query
+         */
+        void setPropagatedStatesQuery(std::function<std::vector<std::pair<rclcpp::Time, fgo::data::State>>()> query)
+        {
+          propagatedStatesQuery_ = std::move(query);
+        }
+
         void updateKeyIndexTimestampMap(const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap& currentKeyIndexTimestampMap)
         {
           currentOptPoseIndexTimestampMap_ = currentKeyIndexTimestampMap;
@@ -957,7 +1035,7 @@ namespace sensors::LiDAR::LIOSAM
                                 boost::optional<nav_msgs::msg::Odometry&> odomMsg = boost::none,
                                 bool loopClosed = false)
         {
-          static const auto imuTl = params_.T_lidar_in_IMU;
+          const auto imuTl = params_.T_lidar_in_IMU;
           ExcutiveLockGuard lg(mutex_);
 
           if(scanIndexI != 0) {
@@ -226,6 +226,13 @@ namespace sensors::LiDAR::LIOSAM
 
     double maxPosePriorLiDARMsgAging = 0.1;  // in sec
 
+    // in-process deskewing of the raw cloud instead of the image projection of LIO-SAM
+    bool deskewInProcess = false;
+    std::string deskewedCloudInfoTopic = "lio_sam/deskew/cloud_info";
+    double deskewBinDuration = 0.005;  // in sec
+    double deskewMaxExtrapolation = 0.1;  // in sec
+    int deskewNumThreads = 4;
+
     // IMU
     //float imuAccNoise;
     //float imuGyrNoise;
@@ -265,6 +272,7 @@ namespace sensors::LiDAR::LIOSAM
     float rotation_tollerance;
 
     gtsam::Vector6 LiDAROdomVariance = (gtsam::Vector6() << 0.1, 0.1, 0.1, 0.09, 0.16, 0.16).finished();
+    double degeneracyEigenThreshold = 100.;  // eigenvalues of the scan-to-map Hessian below are degenerate
 
     // CPU Params
     int numberOfCores = 8;
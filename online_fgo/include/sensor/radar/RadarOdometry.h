@@ -0,0 +1,137 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_RADARODOMETRY_H
+#define ONLINE_FGO_RADARODOMETRY_H
+
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <tbb/task_arena.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+
+namespace sensors::Radar {
+
+  struct RadarOdometryParams {
+    // polar image of one revolution
+    bool azimuthAlongRows = true;     // rows are azimuths and columns range bins, else transposed
+    double rangeResolution = 0.0596;  // [m] per range bin
+    int firstRangeBin = 0;            // leading columns holding metadata instead of range bins
+    double azimuthOffset = 0.;        // [rad] azimuth of the first row
+    bool clockwise = true;            // direction of the rotation seen from above
+    double scanPeriod = 0.25;         // [s] duration of one revolution
+    double timestampFraction = 0.;    // fraction of the revolution at the timestamp of the image, 0 start, 1 end
+
+    // features, the k strongest returns per azimuth
+    int kStrongest = 12;
+    double minIntensity = 0.3;  // intensities are scaled to [0, 1]
+    double minRange = 2.;       // [m]
+    double maxRange = 100.;     // [m]
+    double voxelSize = 0.5;     // [m] the strongest return is kept per voxel
+
+    // scan matching
+    int maxIterations = 30;
+    double maxCorrespondenceDistance = 2.;  // [m]
+    double robustScale = 0.5;               // [m] of the Cauchy weights
+    double convergenceThreshold = 1e-4;
+    int motionCompensationIterations = 2;   // the scan is deskewed again with the matched motion
+    size_t minCorrespondences = 50;
+    double unobservedVar = 1e2;             // variance of z, roll and pitch of the planar relative pose
+
+    int numThreads = 4;
+  };
+
+  struct RadarOdometryResult {
+    double timestampPrevious = 0.;
+    double timestampCurrent = 0.;
+    gtsam::Pose3 poseRelative;  // T^{radar previous}_{radar current}
+    gtsam::Matrix6 covariance = gtsam::Matrix6::Identity();  // of poseRelative in its local coordinates [omega, v]
+    gtsam::Vector6 twist = gtsam::Vector6::Zero();           // body-centric [omega, v] of the radar
+    size_t numFeatures = 0;
+    size_t numCorrespondences = 0;
+    double rmse = 0.;  // [m] of the correspondences
+  };
+
+  /***
+   * CPU radar odometry on polar scans of a spinning radar (e.g. Navtech or marine radars): the k strongest returns
+   * of each azimuth are extracted in parallel and downsampled on a voxel grid. Since the azimuths are measured over a
+   * whole revolution, each of them is motion compensated to the timestamp of the scan with the GP (WNOA) interpolator
+   * of the constant body-centric velocity. The scan is then matched to the previous one with a planar, robust
+   * point-to-point ICP. The velocity used for the compensation is either given (e.g. from the predicted states of the
+   * graph) or taken from the last match, and is refined with the matched motion.
+   */
+  class RadarOdometry {
+  public:
+    explicit RadarOdometry(const RadarOdometryParams &params);
+
+    /***
+     * process the next scan
+     * @param timestamp [s]
+     * @param polar polar image, 8 or 16 bit or float
+     * @param twistPrior body-centric velocity [omega, v] of the radar for the motion compensation
+     * @return relative pose to the previous scan, none for the first scan or if the matching failed
+     */
+    std::optional<RadarOdometryResult> process(double timestamp, const cv::Mat &polar,
+                                               const std::optional<gtsam::Vector6> &twistPrior = std::nullopt);
+
+    void reset();
+
+  private:
+    struct Return {
+      Eigen::Vector2d point;  // in the radar frame at the time of the azimuth
+      size_t azimuth;
+      float intensity;
+    };
+
+    [[nodiscard]] std::vector<Return> extractReturns(const cv::Mat &polar) const;
+
+    /***
+     * motion compensation of the returns to the timestamp of the scan
+     * @param returns
+     * @param twist body-centric velocity [omega, v]
+     * @return points in the radar frame at the timestamp of the scan
+     */
+    [[nodiscard]] std::vector<Eigen::Vector2d> deskew(const std::vector<Return> &returns,
+                                                      const gtsam::Vector6 &twist) const;
+
+    struct Alignment {
+      gtsam::Pose2 pose;  // T^target_source
+      gtsam::Matrix3 covariance;  // in the local coordinates [x, y, theta] of pose
+      size_t numCorrespondences = 0;
+      double rmse = 0.;
+    };
+
+    [[nodiscard]] std::optional<Alignment> align(const std::vector<Eigen::Vector2d> &source,
+                                                 const std::vector<Eigen::Vector2d> &target,
+                                                 const gtsam::Pose2 &initial) const;
+
+    RadarOdometryParams params_;
+    mutable tbb::task_arena arena_;
+    size_t numAzimuths_ = 0;
+
+    bool hasPrevious_ = false;
+    double timestampPrevious_ = 0.;
+    std::vector<Eigen::Vector2d> pointsPrevious_;
+    gtsam::Vector6 twist_ = gtsam::Vector6::Zero();
+  };
+}
+
+#endif //ONLINE_FGO_RADARODOMETRY_H
@@ -0,0 +1,93 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_FULLBATCHSMOOTHER_H
+#define ONLINE_FGO_FULLBATCHSMOOTHER_H
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include "solver/FixedLagSmoother.h"
+
+namespace fgo::solvers {
+
+  struct FullBatchSmootherParams {
+    bool useGaussNewton = false;       // Gauss-Newton instead of Levenberg-Marquardt
+    bool nestedDissection = true;      // METIS ordering if GTSAM supports it, COLAMD otherwise
+    size_t maxIterations = 100;
+    double relativeErrorTol = 1e-5;
+    double absoluteErrorTol = 1e-5;
+    double lambdaInitial = 1e-5;
+    bool verbose = false;
+  };
+
+  /***
+   * Records every factor and variable handed to the fixed-lag smoother over a whole drive and solves the complete
+   * graph in one sparse batch optimization afterwards. The fixed-lag estimates of the variables replace their
+   * initial values while they are inside the lag, so the batch solve starts from the online solution and usually
+   * converges in a few iterations. The elimination is multifrontal, which GTSAM parallelizes over the cliques of the
+   * elimination tree if it is built with TBB; a nested-dissection ordering keeps the tree balanced and the fill-in low
+   * for long trajectories.
+   */
+  class FullBatchSmoother {
+  public:
+    typedef std::unique_ptr<FullBatchSmoother> UniquePtr;
+
+    explicit FullBatchSmoother(const FullBatchSmootherParams &params = FullBatchSmootherParams()) : params_(params) {}
+
+    /***
+     * append the factors and variables of one graph extension
+     * @param newFactors factors handed to the fixed-lag smoother
+     * @param newValues initial values of the new variables
+     * @param newTimestamps timestamps of the new variables
+     */
+    void record(const gtsam::NonlinearFactorGraph &newFactors,
+                const gtsam::Values &newValues,
+                const FixedLagSmoother::KeyTimestampMap &newTimestamps);
+
+    /***
+     * overwrite the initial values of the recorded variables with the current fixed-lag estimate
+     * @param estimate
+     */
+    void updateEstimate(const gtsam::Values &estimate);
+
+    /***
+     * solve the recorded graph, the result is also kept as the new estimate
+     * @return optimized values of all recorded variables
+     */
+    gtsam::Values optimize();
+
+    [[nodiscard]] const FixedLagSmoother::KeyTimestampMap &keyTimestamps() const { return timestamps_; }
+
+    [[nodiscard]] size_t numFactors() const { return graph_.size(); }
+
+    [[nodiscard]] size_t numVariables() const { return estimate_.size(); }
+
+  private:
+    FullBatchSmootherParams params_;
+    std::mutex mutex_;
+    gtsam::NonlinearFactorGraph graph_;
+    gtsam::Values estimate_;
+    FixedLagSmoother::KeyTimestampMap timestamps_;
+  };
+}
+
+#endif //ONLINE_FGO_FULLBATCHSMOOTHER_H
@@ -0,0 +1,200 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_ASYNCLOGGER_H
+#define ONLINE_FGO_ASYNCLOGGER_H
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+
+namespace fgo::utils {
+
+  enum class LogLevel : uint8_t {
+    DEBUG = 0,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+  };
+
+  enum class LogModule : uint8_t {
+    GENERAL = 0,
+    GRAPH,
+    SOLVER,
+    IMU,
+    GNSS,
+    LIDAR,
+    INTEGRATOR,
+    NUM_MODULES
+  };
+
+  /***
+   * a named numeric field of a log record, the name must be a string literal
+   */
+  struct LogField {
+    const char *name = "";
+    double value = 0.;
+
+    LogField() = default;
+
+    LogField(const char *n, double v) : name(n), value(v) {}
+  };
+
+  struct LogRecord {
+    static constexpr size_t MaxFields = 8;
+    static constexpr size_t MaxTagLength = 31;
+
+    int64_t timestampNs = 0;   // wall clock when the record was enqueued
+    LogModule module = LogModule::GENERAL;
+    LogLevel level = LogLevel::INFO;
+    uint8_t numFields = 0;
+    const char *what = "";     // string literal, never formatted on the calling thread
+    char tag[MaxTagLength + 1] = {};  // optional copy of a runtime name, e.g. the integrator name
+    std::array<LogField, MaxFields> fields{};
+  };
+
+  /***
+   * Logging facade for the estimator hot paths. The caller checks the level of the module with one relaxed atomic
+   * load and, only if enabled, copies a pre-typed record into a bounded lock-free queue. A background thread formats
+   * the records into the ROS logger and optionally writes them into a binary file for offline analysis.
+   * If the queue is full, the record is dropped and counted instead of blocking the caller.
+   */
+  class AsyncLogger {
+  public:
+    static constexpr size_t QueueCapacity = 4096;  // must be a power of two
+
+    static AsyncLogger &instance();
+
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger &) = delete;
+
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+    [[nodiscard]] bool isEnabled(LogModule module, LogLevel level) const {
+      return level >= levels_[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+    }
+
+    void setLevel(LogModule module, LogLevel level) {
+      levels_[static_cast<size_t>(module)].store(level, std::memory_order_relaxed);
+    }
+
+    /***
+     * read GNSSFGO.Logging.<module>Level and GNSSFGO.Logging.binarySink from the node
+     * @param node
+     */
+    void configure(rclcpp::Node &node);
+
+    /***
+     * open a binary sink, all records passing the level check are appended to it
+     * @param path file path, an empty path closes the current sink
+     * @return true if the sink could be opened
+     */
+    bool openBinarySink(const std::string &path);
+
+    /***
+     * enqueue a record, use the FGO_LOG macro so that the fields are only evaluated if the level is enabled
+     * @param module
+     * @param level
+     * @param what string literal describing the record
+     * @param tag runtime name copied into the record, truncated to LogRecord::MaxTagLength characters
+     * @param fields at most LogRecord::MaxFields numeric fields, additional fields are ignored
+     */
+    void log(LogModule module, LogLevel level, const char *what, std::string_view tag,
+             std::initializer_list<LogField> fields = {});
+
+    /***
+     * block until the background thread has written all records enqueued so far
+     */
+    void flush();
+
+    [[nodiscard]] uint64_t droppedRecords() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static const char *moduleName(LogModule module);
+
+    static std::string formatRecord(const LogRecord &record);
+
+  private:
+    AsyncLogger();
+
+    bool tryPush(const LogRecord &record);
+
+    bool tryPop(LogRecord &record);
+
+    void run();
+
+    void writeBinary(const LogRecord &record);
+
+    // bounded multi-producer queue after D. Vyukov, each cell carries a sequence number that tells producers and the
+    // consumer whether the cell is free or holds a record of the current lap
+    struct Cell {
+      std::atomic<size_t> sequence;
+      LogRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    std::array<std::atomic<LogLevel>, static_cast<size_t>(LogModule::NUM_MODULES)> levels_;
+
+    std::atomic_bool running_{true};
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> enqueued_{0};
+
+    std::mutex sinkMutex_;
+    std::FILE *binarySink_ = nullptr;
+
+    std::thread thread_;
+  };
+}
+
+#define FGO_LOG(module, level, what, ...)                                                       \
+  do {                                                                                          \
+    auto &fgo_async_logger_ = fgo::utils::AsyncLogger::instance();                              \
+    if (fgo_async_logger_.isEnabled(module, level))                                             \
+      fgo_async_logger_.log(module, level, what, {}, {__VA_ARGS__});                            \
+  } while (false)
+
+#define FGO_LOG_TAGGED(module, level, what, tag, ...)                                           \
+  do {                                                                                          \
+    auto &fgo_async_logger_ = fgo::utils::AsyncLogger::instance();                              \
+    if (fgo_async_logger_.isEnabled(module, level))                                             \
+      fgo_async_logger_.log(module, level, what, tag, {__VA_ARGS__});                           \
+  } while (false)
+
+#define FGO_LOG_DEBUG(module, what, ...) FGO_LOG(module, fgo::utils::LogLevel::DEBUG, what, __VA_ARGS__)
+#define FGO_LOG_INFO(module, what, ...) FGO_LOG(module, fgo::utils::LogLevel::INFO, what, __VA_ARGS__)
+#define FGO_LOG_WARN(module, what, ...) FGO_LOG(module, fgo::utils::LogLevel::WARN, what, __VA_ARGS__)
+#define FGO_LOG_ERROR(module, what, ...) FGO_LOG(module, fgo::utils::LogLevel::ERROR, what, __VA_ARGS__)
+
+#endif //ONLINE_FGO_ASYNCLOGGER_H
@@ -33,33 +33,23 @@
 #include "data/DataTypesFGO.h"
 #include "utils/NavigationTools.h"
 #include "utils/LambdaAlgorithm.h"
+#include "utils/SatelliteStateTable.h"
 
 namespace fgo::utils::GNSS {
 
     inline void getRTKCorrectionsFromROSMsg(const std::vector<irt_nav_msgs::msg::GNSSCorrection>& corrections,
                                             std::vector<irt_nav_msgs::msg::SatLabel>& labels)
     {
+      SatelliteIndex<> correctionIndex;
+      correctionIndex.build(corrections, [](const auto& corr) { return corr.prn; });
       for(auto& label : labels)
       {
-        for (const auto& corr : corrections)
-        {
-          if(corr.prn == label.prn)
-          {
-            label.psr_correction = corr.psr_correction;
-            break;
-          }
-        }
+        const auto i = correctionIndex.find(label.prn);
+        if(i >= 0)
+          label.psr_correction = corrections[i].psr_correction;
       }
     }
 
-    inline std::map<uint32_t, double> GetInitPRNLocktimeMap(size_t size = 40)
-    {
-      std::map<uint32_t, double> map;
-      for(size_t i = 0; i < size; i++)
-        map.insert(std::make_pair(i + 1, -1.));
-      return map;
-    }
-
     /**
      *
      * @param method
@@ -94,129 +84,91 @@ namespace fgo::utils::GNSS {
        }
      }
 
+     /***
+      * check the observations of an epoch for cycle slips by the receiver-reported locktime, a signal that is observed
+      * continuously has a locktime that increases by the measurement interval
+      * @param measEpoch epoch to be checked, the cycle slip flag of the observations is set in place
+      * @param satTable tracking state of the antenna, updated in place
+      * @param locktimeIncrement expected locktime increment between two epochs
+      */
+     template<class SatTable>
      inline void checkCycleSlipByLocktime(fgo::data::GNSSMeasurementEpoch& measEpoch,
-                                          std::map<uint32_t, double>& PRNLocktimeMap,
-                                          std::vector<uint32_t>& lastPRNList)
+                                          SatTable& satTable,
+                                          double locktimeIncrement = .1)
      {
-       std::vector<uint32_t> currentPRNs;
-       for(const auto& obs : measEpoch.obs)
+       static constexpr double LocktimeTolerance = 1e-3;
+       satTable.beginEpoch();
+       for(auto& obs : measEpoch.obs)
        {
-         currentPRNs.emplace_back(obs.satId);
+         auto state = satTable.find(obs.satId, static_cast<uint32_t>(obs.frequency));
+         // a signal observed twice in one epoch can't be told apart from the first observation
+         if(!state || satTable.isSeenInEpoch(*state))
+         {
+           obs.cycleSlip = true;
+           continue;
+         }
+         // a satellite that was lost in the last epoch has to be considered as slipped
+         obs.cycleSlip = !satTable.isContinuous(*state) || state->locktime < 0. ||
+                         std::abs(obs.locktime - (state->locktime + locktimeIncrement)) > LocktimeTolerance;
+         state->locktime = obs.locktime;
+         state->lastPhase = obs.cp;
+         state->ambiguityLocked = !obs.cycleSlip;
+         satTable.markSeen(*state);
        }
-      if(!lastPRNList.empty())
-      {
-        for(const auto& prn : lastPRNList)
-        {
-          auto prnIter = std::find(currentPRNs.begin(), currentPRNs.end(), prn);
-          if(prnIter == currentPRNs.end())
-          {
-            // this prn is not in the current prn list, sat lost
-            PRNLocktimeMap[prn - 1] = -1.;
-          }
-        }
-      }
-
-      for(auto& obs : measEpoch.obs)
-      {
-        if(PRNLocktimeMap[obs.satId - 1] == -1.0)
-        {
-          obs.cycleSlip = true;
-          PRNLocktimeMap[obs.satId - 1] = obs.locktime;
-          continue;
-        }
-        if(obs.locktime == PRNLocktimeMap[obs.satId - 1] + .1)
-        {
-          // this obs was kept tracked
-          obs.cycleSlip = false;
-        }
-        else
-        {
-          obs.cycleSlip = true;
-        }
-        PRNLocktimeMap[obs.satId - 1] = obs.locktime;
-      }
-
-       lastPRNList = currentPRNs;
      }
+
      /**
       * https://gssc.esa.int/navipedia/index.php/Examples_of_single_frequency_Cycle-Slip_Detectors
-      * @param data
-      * @param structRTCM
-      * @param structAux
-      * @param reset
+      * @param measEpoch epoch to be checked, the cycle slip flag of the observations is set in place
+      * @param lastRefSatID reference satellite of the last epoch
+      * @param satTable tracking state of the observation stream, updated in place
+      * @param reset forget the history of all satellites
       */
+     template<class SatTable>
      inline void checkCycleSlip(fgo::data::GNSSMeasurementEpoch& measEpoch,
-                         uint& lastRefSatID,
-                         std::vector <fgo::data::CycleSlipStruct> &cycleSlipStruct,
-                         bool reset)
-                         {
-       if (lastRefSatID != measEpoch.refSatGPS.refSatSVID || reset)
+                                uint& lastRefSatID,
+                                SatTable& satTable,
+                                bool reset)
+     {
+       // the double differences are formed on the first signal of the reference satellite
+       const uint refSatID = measEpoch.refSatGPS.refSatSVID;
+       if (lastRefSatID != refSatID || reset)
        {
-         for (auto &&item: measEpoch.obs)
-         {
-           item.cycleSlip = true;
-         }
-         cycleSlipStruct.clear();
+         // all double differences changed, none of the satellites can be continuous
+         if (auto lastRefState = satTable.find(lastRefSatID))
+           lastRefState->isReferenceSatellite = false;
+         satTable.invalidate();
        }
-       lastRefSatID = measEpoch.refSatGPS.refSatSVID;
+       lastRefSatID = refSatID;
+       if (auto refState = satTable.find(refSatID))
+         refState->isReferenceSatellite = true;
 
+       satTable.beginEpoch();
        for (auto &&obs: measEpoch.obs)
        {
-         bool cycleSlip = true;
-         bool foundinCS = false; //double timeLastSlip = data.timestamp.seconds() - data.delay;
-         auto satIDi = obs.satId;
-         for (auto &cs: cycleSlipStruct)
+         auto state = satTable.find(obs.satId, static_cast<uint32_t>(obs.frequency));
+         if (!state || satTable.isSeenInEpoch(*state))
          {
-           if (satIDi == cs.satID)
-           {
-             foundinCS = true;
-             cs.connection = true;
-             double diffCpPr = obs.pr - fgo::constants::lambda_L1 * obs.cp;
-             if (abs(diffCpPr - cs.md) > 1.5 * sqrt(cs.sd2) || cs.N == 0)
-             {
-               //Reset
-               cs.N = 0;
-               cs.md = 0;
-               cs.md2 = 0;
-               cs.sd2 = 0;
-               //.timeLastSlip = timeLastSlip;
-             } else
-             {
-               cycleSlip = false;
-             }
-              //timeLastSlip = cs.timeLastSlip;
-              cs.N++;
-              int N = cs.N;
-              cs.md = 1.0 / N * (diffCpPr + (N - 1) * cs.md);
-              cs.md2 = 1.0 / N * (pow(diffCpPr, 2) + (N - 1) * cs.md2);
-              cs.sd2 = 1.0 / N * ((N - 1) * (cs.md2 - pow(cs.md, 2)) + 0.5); //weighted average
-              break;
-           }
-         }
-         if (!foundinCS)
-         {
-           fgo::data::CycleSlipStruct ns; //new Satellite
-           ns.satID = satIDi;
-           ns.N = 1;
-           ns.md = fgo::constants::lambda_L1 * obs.cp - obs.pr;
-           ns.md2 = pow(ns.md, 2);
-           ns.sd2 = 0.5;
-           ns.connection = true;
-           cycleSlipStruct.push_back(ns);
+           obs.cycleSlip = true;
+           continue;
          }
+         bool cycleSlip = true;
+         const double diffCpPr = obs.pr - fgo::constants::lambda_L1 * obs.cp;
+         if (!satTable.isContinuous(*state) || state->N == 0 ||
+             std::abs(diffCpPr - state->md) > 1.5 * std::sqrt(state->sd2))
+           state->resetStatistics();
+         else
+           cycleSlip = false;
+
+         state->N++;
+         const int N = state->N;
+         state->md = 1.0 / N * (diffCpPr + (N - 1) * state->md);
+         state->md2 = 1.0 / N * (std::pow(diffCpPr, 2) + (N - 1) * state->md2);
+         state->sd2 = 1.0 / N * ((N - 1) * (state->md2 - std::pow(state->md, 2)) + 0.5); //weighted average
+         state->lastPhase = obs.cp;
+         state->ambiguityLocked = !cycleSlip;
+         satTable.markSeen(*state);
          obs.cycleSlip = cycleSlip;
-         //obs.timeLastSlip = timeLastSlip;
-       }
-       for (auto &&cs: cycleSlipStruct)
-       {
-         if (!cs.connection && cs.N != 0)
-         {
-           cs.N = 0;
-           cs.md = 0;
-           cs.md2 = 0;
-           cs.sd2 = 0;
-         }
-         cs.connection = false;
        }
      }
 
@@ -237,40 +189,36 @@ namespace fgo::utils::GNSS {
                                  const std::string& logger_name)
      {
         long n = fgo_state.ddIntAmb.rows();
-        int m = 2; //number of sol generated
-        VectorXd s = VectorXd::Zero(m);
-        MatrixXd F = MatrixXd::Zero(n, m);
         VectorXd floatA = fgo_state.ddIntAmb;
         MatrixXd Q = marginalCovariance.block(0, 0, n, n);
-        //Q = MatrixXd::Identity(n,n) * 1e-1;
-        //std::cout << Q << std::endl;
-        std::cout << "Ready for solveIntAmb" << std::endl;
-        if (fgo::utils::lambda(floatA, Q, F, s, m) == 0)
-        {
-          if(s(0)==0.0){
-            RCLCPP_INFO(rclcpp::get_logger(logger_name), "s(0) = 0, in solveIntAmb");
-            return false;
-          }
-          RCLCPP_INFO_STREAM(rclcpp::get_logger(logger_name), "0: " << F.col(0).transpose());
-          RCLCPP_INFO_STREAM(rclcpp::get_logger(logger_name), "1: " << F.col(1).transpose());
-
-          if (s(1) / s(0) > 1.5) { //1.5
-            RCLCPP_INFO(rclcpp::get_logger(logger_name), "solveIntegerAmbiguity successful");
-            //stateb = statebfloat - QbaQa^-1(afloat - ainteger)
-            gtsam::Point3 correctionTerm =
-                marginalCovariance.block(n+3, 0, 3, n) * Q * (floatA - F.col(0));
-            fixedPosition = fgo_state.state.position() - correctionTerm;
-            fixedIntegers = F.col(0);
-            return true;
-          } else {
-            RCLCPP_WARN_STREAM(rclcpp::get_logger(logger_name), "S1/S0 ratio smaller 1.5. S1: " << s(1) << " S0: " << s(0));
-            return false;
-          }
-        } else {
+        fgo::utils::LambdaParams params;
+        params.ratioThreshold = 1.5;
+        params.partialFixing = false;  // only integers are returned here
+        fgo::utils::LambdaSolver solver(params);
+        const auto solution = solver.solve(floatA, Q);
+        if (solution.status != 0) {
           //lambda algorithm wasnt successful
           RCLCPP_WARN(rclcpp::get_logger(logger_name), "LAMBDA-Algorithm wasn't successful.");
           return false;
         }
+        if (solution.residuals.size() > 0 && solution.residuals(0) == 0.0) {
+          RCLCPP_INFO(rclcpp::get_logger(logger_name), "s(0) = 0, in solveIntAmb");
+          return false;
+        }
+        if (!solution.fixed) {
+          RCLCPP_WARN_STREAM(rclcpp::get_logger(logger_name), "S1/S0 ratio smaller 1.5: " << solution.ratio
+                                                              << (solution.truncated ? ", search truncated" : ""));
+          return false;
+        }
+        RCLCPP_INFO_STREAM(rclcpp::get_logger(logger_name), "0: " << solution.candidates.col(0).transpose());
+        RCLCPP_INFO_STREAM(rclcpp::get_logger(logger_name), "1: " << solution.candidates.col(1).transpose());
+        RCLCPP_INFO(rclcpp::get_logger(logger_name), "solveIntegerAmbiguity successful");
+        //stateb = statebfloat - QbaQa^-1(afloat - ainteger)
+        gtsam::Point3 correctionTerm =
+            marginalCovariance.block(n+3, 0, 3, n) * Q * (floatA - solution.ambiguities);
+        fixedPosition = fgo_state.state.position() - correctionTerm;
+        fixedIntegers = solution.ambiguities;
+        return true;
      }
 
      inline data::GNSSSolutionType getOEM7PVTSolutionType(uint32_t type)
@@ -236,14 +236,14 @@ namespace fgo::utils {
           + 0.00295139 * dt8 * ad4
         );
         Q(i, i + 12) = Q(i + 12, i) = qc * (
-          (1 / 6) * dt3
-          - (1 / 6) * dt4 * ad
+          (1.0 / 6.0) * dt3
+          - (1.0 / 6.0) * dt4 * ad
           + 0.0916667 * dt5 * ad2
           - 0.0361111 * dt6 * ad3
           + 0.0113095 * dt7 * ad4
         );
         Q(i + 6, i + 6) = qc * (
-          (1 / 3) * dt3
+          (1.0 / 3.0) * dt3
           - 0.25 * dt4 * ad
           + 0.116667 * dt5 * ad2
           - 0.0416667 * dt6 * ad3
@@ -259,8 +259,8 @@ namespace fgo::utils {
         Q(i + 12, i + 12) = qc * (
           dt
           - dt2 * ad
-          + (2 / 3) * dt3 * ad2
-          - (1 / 3) * dt4 * ad3
+          + (2.0 / 3.0) * dt3 * ad2
+          - (1.0 / 3.0) * dt4 * ad3
           + 0.133333 * dt5 * ad4
         );
       }
@@ -0,0 +1,306 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_GEODESY_H
+#define ONLINE_FGO_GEODESY_H
+
+#pragma once
+
+#include <cmath>
+#include <Eigen/Core>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+
+namespace fgo::utils::geodesy {
+
+  // WGS84 ellipsoid, identical to constants::semiMajor and constants::semiMinor
+  constexpr double a = 6378137.0;
+  constexpr double b = 6356752.31424518;
+  constexpr double e2 = 1. - (b * b) / (a * a);        // first eccentricity squared
+  constexpr double ep2 = (a * a) / (b * b) - 1.;       // second eccentricity squared
+
+  // Groves (2.142), the J2 gravity model used by gravity_ecef
+  constexpr double gravR0 = 6378137.;
+  constexpr double gravMu = 3.986004418e+14;
+  constexpr double gravJ2 = 1.082627e-3;
+  constexpr double gravOmegaIE = 7.292115e-5;
+
+  /***
+   * Geodetic coordinates of one ECEF position together with the sines and cosines of latitude and longitude, so that
+   * the local rotation matrices and Jacobians don't evaluate trigonometric functions again.
+   */
+  struct GeodeticFrame {
+    gtsam::Point3 llh;   // latitude, longitude [rad], height [m]
+    double sinLat = 0.;
+    double cosLat = 1.;
+    double sinLon = 0.;
+    double cosLon = 1.;
+
+    [[nodiscard]] gtsam::Matrix33 nedRe() const {
+      return (gtsam::Matrix33() << -sinLat * cosLon, -sinLat * sinLon, cosLat,
+        -sinLon, cosLon, 0.,
+        -cosLat * cosLon, -cosLat * sinLon, -sinLat).finished();
+    }
+
+    [[nodiscard]] gtsam::Matrix33 enuRe() const {
+      return (gtsam::Matrix33() << -sinLon, cosLon, 0.,
+        -sinLat * cosLon, -sinLat * sinLon, cosLat,
+        cosLat * cosLon, cosLat * sinLon, sinLat).finished();
+    }
+
+    // prime vertical radius of curvature
+    [[nodiscard]] double radiusN() const { return a / std::sqrt(1. - e2 * sinLat * sinLat); }
+
+    // meridian radius of curvature
+    [[nodiscard]] double radiusM() const {
+      const double w2 = 1. - e2 * sinLat * sinLat;
+      return a * (1. - e2) / (w2 * std::sqrt(w2));
+    }
+  };
+
+  /***
+   * ECEF to geodetic with Bowring's formula and a fixed number of two iterations. The result agrees with the closed
+   * form solution of Heikkinen to machine precision in latitude and to 1e-8 m in height from the earth surface up to
+   * GNSS orbits. The latitude is carried as a normalized (cos, sin) pair, so no trigonometric function is evaluated
+   * except the final atan2 calls.
+   * @param xyz ECEF position [m]
+   * @return geodetic frame
+   */
+  inline GeodeticFrame ecef2Frame(const gtsam::Point3 &xyz) {
+    GeodeticFrame frame;
+    const double x = xyz.x(), y = xyz.y(), z = xyz.z();
+    const double p = std::sqrt(x * x + y * y);
+
+    // parametric latitude as initial guess
+    double cb = b * p, sb = a * z;
+    double norm = std::sqrt(cb * cb + sb * sb);
+    cb /= norm;
+    sb /= norm;
+    double cl = 1., sl = 0.;
+    for (size_t i = 0; i < 2; i++) {
+      cl = p - e2 * a * cb * cb * cb;
+      sl = z + ep2 * b * sb * sb * sb;
+      norm = std::sqrt(cl * cl + sl * sl);
+      cl /= norm;
+      sl /= norm;
+      cb = a * cl;
+      sb = b * sl;
+      norm = std::sqrt(cb * cb + sb * sb);
+      cb /= norm;
+      sb /= norm;
+    }
+    frame.sinLat = sl;
+    frame.cosLat = cl;
+    if (p > 0.) {
+      frame.sinLon = y / p;
+      frame.cosLon = x / p;
+    }
+    frame.llh = gtsam::Point3(std::atan2(sl, cl), std::atan2(y, x),
+                              p * cl + z * sl - a * std::sqrt(1. - e2 * sl * sl));
+    return frame;
+  }
+
+  inline GeodeticFrame llh2Frame(const gtsam::Point3 &llh) {
+    GeodeticFrame frame;
+    frame.llh = llh;
+    frame.sinLat = std::sin(llh.x());
+    frame.cosLat = std::cos(llh.x());
+    frame.sinLon = std::sin(llh.y());
+    frame.cosLon = std::cos(llh.y());
+    return frame;
+  }
+
+  inline gtsam::Point3 frame2ECEF(const GeodeticFrame &frame) {
+    const double N = frame.radiusN();
+    const double h = frame.llh.z();
+    return {(N + h) * frame.cosLat * frame.cosLon,
+            (N + h) * frame.cosLat * frame.sinLon,
+            (N * (1. - e2) + h) * frame.sinLat};
+  }
+
+  /***
+   * J2 gravity including the centrifugal term, resolved in ECEF
+   * @param r_eb_e ECEF position [m]
+   * @return gravity [m/s^2], zero at the earth center
+   */
+  inline gtsam::Vector3 gravityECEF(const gtsam::Point3 &r_eb_e) {
+    const double r2 = r_eb_e.squaredNorm();
+    if (r2 == 0.)
+      return gtsam::Vector3::Zero();
+    const double invR2 = 1. / r2;
+    const double invR = std::sqrt(invR2);
+    const double zScale = 5. * r_eb_e.z() * r_eb_e.z() * invR2;
+    const double j2 = 1.5 * gravJ2 * gravR0 * gravR0 * invR2;
+    const double muR3 = -gravMu * invR2 * invR;
+    const double omega2 = gravOmegaIE * gravOmegaIE;
+    return {muR3 * (r_eb_e.x() + j2 * (1. - zScale) * r_eb_e.x()) + omega2 * r_eb_e.x(),
+            muR3 * (r_eb_e.y() + j2 * (1. - zScale) * r_eb_e.y()) + omega2 * r_eb_e.y(),
+            muR3 * (r_eb_e.z() + j2 * (3. - zScale) * r_eb_e.z())};
+  }
+
+  /***
+   * Jacobian of eRn(t_ref) * t w.r.t. t_ref, with eRn the ENU (rows east, north, up) rotation at t_ref.
+   * With the local unit vectors e, n, u and the components v_e, v_n, v_u of t,
+   * d(lat) = n^T / (M + h) and d(lon) = e^T / ((N + h) cos(lat)), which gives
+   *   d(e^T t) = (sin(lat) v_n - cos(lat) v_u) d(lon)
+   *   d(n^T t) = -v_u d(lat) - sin(lat) v_e d(lon)
+   *   d(u^T t) = v_n d(lat) + cos(lat) v_e d(lon)
+   * @param frame geodetic frame of t_ref
+   * @param t vector resolved in ECEF
+   * @return 3x3 Jacobian
+   */
+  inline gtsam::Matrix33 enuRotateJacobianWrtRef(const GeodeticFrame &frame, const gtsam::Vector3 &t) {
+    const auto enuRe = frame.enuRe();
+    const gtsam::Vector3 v = enuRe * t;
+    const double h = frame.llh.z();
+    const Eigen::RowVector3d dLat = enuRe.row(1) / (frame.radiusM() + h);
+    const Eigen::RowVector3d dLon = enuRe.row(0) / ((frame.radiusN() + h) * frame.cosLat);
+
+    gtsam::Matrix33 J;
+    J.row(0) = (frame.sinLat * v.y() - frame.cosLat * v.z()) * dLon;
+    J.row(1) = -v.z() * dLat - frame.sinLat * v.x() * dLon;
+    J.row(2) = v.y() * dLat + frame.cosLat * v.x() * dLon;
+    return J;
+  }
+
+  /***
+   * Jacobian of nRe(t_ref) * t w.r.t. t_ref, the NED rows are a permutation of the ENU rows
+   * @param frame geodetic frame of t_ref
+   * @param t vector resolved in ECEF
+   * @return 3x3 Jacobian
+   */
+  inline gtsam::Matrix33 nedRotateJacobianWrtRef(const GeodeticFrame &frame, const gtsam::Vector3 &t) {
+    const auto J = enuRotateJacobianWrtRef(frame, t);
+    return (gtsam::Matrix33() << J.row(1), J.row(0), -J.row(2)).finished();
+  }
+
+  /***
+   * Jacobian of eRn(t_ref) * t w.r.t. (t_ref, t), replaces the MATLAB generated genJacobianECEF2ENU
+   * @param t_ref ECEF position defining the local frame
+   * @param t vector resolved in ECEF
+   * @return [d/dt_ref, d/dt]
+   */
+  inline gtsam::Matrix36 jacobianECEF2ENU(const gtsam::Point3 &t_ref, const gtsam::Vector3 &t) {
+    const auto frame = ecef2Frame(t_ref);
+    return (gtsam::Matrix36() << enuRotateJacobianWrtRef(frame, t), frame.enuRe()).finished();
+  }
+
+  /***
+   * Jacobian of nRe(t_ref) * t w.r.t. (t_ref, t), replaces the MATLAB generated genJacobianECEF2NED
+   * @param t_ref ECEF position defining the local frame
+   * @param t vector resolved in ECEF
+   * @return [d/dt_ref, d/dt]
+   */
+  inline gtsam::Matrix36 jacobianECEF2NED(const gtsam::Point3 &t_ref, const gtsam::Vector3 &t) {
+    const auto frame = ecef2Frame(t_ref);
+    return (gtsam::Matrix36() << nedRotateJacobianWrtRef(frame, t), frame.nedRe()).finished();
+  }
+
+  /***
+   * Batched conversions on 3xN arrays of positions. Columns are processed with Eigen array expressions, so the
+   * arithmetic of all positions is vectorized and only the final atan2 calls are evaluated per element.
+   */
+  struct GeodeticBatch {
+    Eigen::Matrix3Xd llh;
+    Eigen::ArrayXd sinLat, cosLat, sinLon, cosLon;
+
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(llh.cols()); }
+
+    [[nodiscard]] GeodeticFrame frame(Eigen::Index i) const {
+      GeodeticFrame frame;
+      frame.llh = llh.col(i);
+      frame.sinLat = sinLat(i);
+      frame.cosLat = cosLat(i);
+      frame.sinLon = sinLon(i);
+      frame.cosLon = cosLon(i);
+      return frame;
+    }
+  };
+
+  inline GeodeticBatch ecef2FrameBatch(const Eigen::Ref<const Eigen::Matrix3Xd> &xyz) {
+    const auto n = xyz.cols();
+    GeodeticBatch batch;
+    batch.llh.resize(3, n);
+    const Eigen::ArrayXd x = xyz.row(0).transpose().array();
+    const Eigen::ArrayXd y = xyz.row(1).transpose().array();
+    const Eigen::ArrayXd z = xyz.row(2).transpose().array();
+    const Eigen::ArrayXd p = (x.square() + y.square()).sqrt();
+
+    Eigen::ArrayXd cb = b * p, sb = a * z;
+    Eigen::ArrayXd norm = (cb.square() + sb.square()).sqrt();
+    cb /= norm;
+    sb /= norm;
+    Eigen::ArrayXd cl(n), sl(n);
+    for (size_t i = 0; i < 2; i++) {
+      cl = p - e2 * a * cb.cube();
+      sl = z + ep2 * b * sb.cube();
+      norm = (cl.square() + sl.square()).sqrt();
+      cl /= norm;
+      sl /= norm;
+      cb = a * cl;
+      sb = b * sl;
+      norm = (cb.square() + sb.square()).sqrt();
+      cb /= norm;
+      sb /= norm;
+    }
+
+    batch.sinLat = sl;
+    batch.cosLat = cl;
+    batch.sinLon = (p > 0.).select(y / p, 0.);
+    batch.cosLon = (p > 0.).select(x / p, 1.);
+    batch.llh.row(0) = sl.binaryExpr(cl, [](double s, double c) { return std::atan2(s, c); }).transpose().matrix();
+    batch.llh.row(1) = y.binaryExpr(x, [](double s, double c) { return std::atan2(s, c); }).transpose().matrix();
+    batch.llh.row(2) = (p * cl + z * sl - a * (1. - e2 * sl.square()).sqrt()).transpose().matrix();
+    return batch;
+  }
+
+  inline Eigen::Matrix3Xd llh2ECEFBatch(const Eigen::Ref<const Eigen::Matrix3Xd> &llh) {
+    const Eigen::ArrayXd lat = llh.row(0).transpose().array();
+    const Eigen::ArrayXd lon = llh.row(1).transpose().array();
+    const Eigen::ArrayXd h = llh.row(2).transpose().array();
+    const Eigen::ArrayXd sLat = lat.sin(), cLat = lat.cos();
+    const Eigen::ArrayXd N = a / (1. - e2 * sLat.square()).sqrt();
+    Eigen::Matrix3Xd xyz(3, llh.cols());
+    xyz.row(0) = ((N + h) * cLat * lon.cos()).transpose().matrix();
+    xyz.row(1) = ((N + h) * cLat * lon.sin()).transpose().matrix();
+    xyz.row(2) = ((N * (1. - e2) + h) * sLat).transpose().matrix();
+    return xyz;
+  }
+
+  inline Eigen::Matrix3Xd gravityECEFBatch(const Eigen::Ref<const Eigen::Matrix3Xd> &xyz) {
+    const Eigen::ArrayXd x = xyz.row(0).transpose().array();
+    const Eigen::ArrayXd y = xyz.row(1).transpose().array();
+    const Eigen::ArrayXd z = xyz.row(2).transpose().array();
+    const Eigen::ArrayXd r2 = x.square() + y.square() + z.square();
+    const Eigen::ArrayXd invR2 = (r2 > 0.).select(r2.inverse(), 0.);
+    const Eigen::ArrayXd zScale = 5. * z.square() * invR2;
+    const Eigen::ArrayXd j2 = 1.5 * gravJ2 * gravR0 * gravR0 * invR2;
+    const Eigen::ArrayXd muR3 = -gravMu * invR2 * invR2.sqrt();
+    const double omega2 = gravOmegaIE * gravOmegaIE;
+    // zero gravity at the earth center as in gravityECEF
+    const Eigen::ArrayXd centrifugal = (r2 > 0.).select(Eigen::ArrayXd::Constant(r2.size(), omega2), 0.);
+    Eigen::Matrix3Xd g(3, xyz.cols());
+    g.row(0) = (muR3 * x * (1. + j2 * (1. - zScale)) + centrifugal * x).transpose().matrix();
+    g.row(1) = (muR3 * y * (1. + j2 * (1. - zScale)) + centrifugal * y).transpose().matrix();
+    g.row(2) = (muR3 * z * (1. + j2 * (3. - zScale))).transpose().matrix();
+    return g;
+  }
+}
+
+#endif //ONLINE_FGO_GEODESY_H
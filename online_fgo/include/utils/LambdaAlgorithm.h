@@ -30,6 +30,10 @@
 #ifndef ONLINE_FGO_LAMBDAALGORITHM_H
 #define ONLINE_FGO_LAMBDAALGORITHM_H
 
+#include <chrono>
+#include <cmath>
+#include <Eigen/Dense>
+
 #define LOOPMAX      10000
 
 using namespace std;
@@ -254,6 +258,253 @@ namespace fgo::utils{
         return 0;
     }
     /*--------------------------------------------------------------------------*/
+
+    /*Vectorized MLAMBDA with partial ambiguity resolution-----------------------------------------------------------*/
+    struct LambdaParams {
+        int numCandidates = 2;                      // number of integer candidates, at least 2 for the ratio test
+        double ratioThreshold = 3.;                 // minimal ratio between the second best and the best candidate
+        bool partialFixing = true;                  // fix the most precise subset if the full set fails the ratio test
+        int minNumFixed = 4;                        // smallest subset which is tried in the partial fixing
+        long maxSearchLoops = LOOPMAX;              // search budget shared by all subsets
+        std::chrono::microseconds timeBudget{0};    // wall time budget for the whole resolution, 0 disables it
+    };
+
+    struct LambdaSolution {
+        int status = -1;            // 0 if the search has been carried out, -1 for invalid input or non-positive Q
+        bool fixed = false;         // the ratio test has been passed for numFixed ambiguities
+        bool partial = false;       // only a subset of the decorrelated ambiguities has been fixed
+        bool truncated = false;     // at least one search ran out of its budget
+        int numFixed = 0;
+        double ratio = 0.;
+        VectorXd ambiguities;       // fixed integers if fully fixed, conditioned on the fixed subset if partially fixed
+        MatrixXd candidates;        // candidates of the last search, in the original space only for a full search
+        VectorXd residuals;         // squared norms of the candidates, ascending
+    };
+
+    /***
+     * MLAMBDA implemented on Eigen blocks. The decorrelation Z and its inverse transpose are updated with the integer
+     * Gauss transforms and permutations of the reduction, so that no inversion is required. The search shrinks the
+     * ellipsoid as soon as enough candidates are found and stops at the loop or time budget. If the full set of
+     * ambiguities fails the ratio test, the least precise decorrelated ambiguities are dropped one by one.
+     * The working matrices are members, so a solver reused for the same number of ambiguities doesn't allocate them
+     * again.
+     */
+    class LambdaSolver {
+    public:
+        explicit LambdaSolver(const LambdaParams &params = LambdaParams()) : params_(params) {}
+
+        [[nodiscard]] LambdaSolution solve(const VectorXd &a, const MatrixXd &Q) {
+            LambdaSolution solution;
+            const int n = static_cast<int>(a.size());
+            if (n == 0 || Q.rows() != n || Q.cols() != n || params_.numCandidates < 2)
+                return solution;
+
+            n_ = n;
+            Z_.setIdentity(n, n);
+            Zit_.setIdentity(n, n);
+            if (!factorize(Q))
+                return solution;
+            reduction();
+            const VectorXd z = Z_.transpose() * a;
+
+            loopsLeft_ = params_.maxSearchLoops;
+            deadline_ = std::chrono::steady_clock::now() + params_.timeBudget;
+            solution.status = 0;
+            solution.ambiguities = a;
+
+            const int min_fixed = params_.partialFixing ? std::min(n, std::max(1, params_.minNumFixed)) : n;
+            for (int p = n; p >= min_fixed && loopsLeft_ > 0; p--) {
+                const int offset = n - p;
+                bool truncated = false;
+                const int found = search(offset, z.tail(p), solution.candidates, solution.residuals, truncated);
+                solution.truncated |= truncated;
+                if (found < params_.numCandidates)
+                    continue;
+                solution.ratio = solution.residuals(0) > 0. ? solution.residuals(1) / solution.residuals(0) : 0.;
+                // a truncated search doesn't guarantee the best candidate, the ratio is not meaningful then
+                if (truncated || solution.ratio < params_.ratioThreshold)
+                    continue;
+
+                solution.fixed = true;
+                solution.partial = p < n;
+                solution.numFixed = p;
+                if (!solution.partial) {
+                    solution.candidates = Zit_ * solution.candidates;
+                    solution.ambiguities = solution.candidates.col(0);
+                } else {
+                    // a_cond = a - Q Z_p (Z_p' Q Z_p)^-1 (Z_p' a - z_p)
+                    const MatrixXd QZp = Q * Z_.rightCols(p);
+                    const MatrixXd Qzp = Z_.rightCols(p).transpose() * QZp;
+                    const VectorXd dz = z.tail(p) - solution.candidates.col(0);
+                    solution.ambiguities = a - QZp * Qzp.ldlt().solve(dz);
+                }
+                break;
+            }
+            return solution;
+        }
+
+    private:
+        // Q = L' * diag(D) * L
+        bool factorize(const MatrixXd &Q) {
+            MatrixXd QC = Q;
+            L_.setZero(n_, n_);
+            D_.setZero(n_);
+            for (int i = n_ - 1; i >= 0; i--) {
+                D_(i) = QC(i, i);
+                if (D_(i) <= 0.0)
+                    return false;
+                L_.row(i).head(i + 1) = QC.row(i).head(i + 1) / std::sqrt(D_(i));
+                for (int j = 0; j < i; j++)
+                    QC.row(j).head(j + 1) -= L_(i, j) * L_.row(i).head(j + 1);
+                L_.row(i).head(i + 1) /= L_(i, i);
+            }
+            return true;
+        }
+
+        void gauss(int i, int j) {
+            const double mu = fgo::utils::round(L_(i, j));
+            if (mu == 0.)
+                return;
+            L_.col(j).tail(n_ - i) -= mu * L_.col(i).tail(n_ - i);
+            Z_.col(j) -= mu * Z_.col(i);
+            // (Z G)^-T = Z^-T G^-T with G = I - mu e_i e_j'
+            Zit_.col(i) += mu * Zit_.col(j);
+        }
+
+        void permute(int j, double del) {
+            const double eta = D_(j) / del;
+            const double lam = D_(j + 1) * L_(j + 1, j) / del;
+            D_(j) = eta * D_(j + 1);
+            D_(j + 1) = del;
+            if (j > 0) {
+                const VectorXd a0 = L_.row(j).head(j).transpose();
+                const VectorXd a1 = L_.row(j + 1).head(j).transpose();
+                L_.row(j).head(j) = (-L_(j + 1, j) * a0 + a1).transpose();
+                L_.row(j + 1).head(j) = (eta * a0 + lam * a1).transpose();
+            }
+            L_(j + 1, j) = lam;
+            if (n_ - j - 2 > 0)
+                L_.col(j).tail(n_ - j - 2).swap(L_.col(j + 1).tail(n_ - j - 2));
+            Z_.col(j).swap(Z_.col(j + 1));
+            Zit_.col(j).swap(Zit_.col(j + 1));
+        }
+
+        void reduction() {
+            int j(n_ - 2), k(n_ - 2);
+            while (j >= 0) {
+                if (j <= k) {
+                    for (int i = j + 1; i < n_; i++)
+                        gauss(i, j);
+                }
+                const double del = D_(j) + L_(j + 1, j) * L_(j + 1, j) * D_(j + 1);
+                if (del + 1E-6 < D_(j + 1)) {
+                    permute(j, del);
+                    k = j;
+                    j = n_ - 2;
+                } else
+                    j--;
+            }
+        }
+
+        /***
+         * searches the trailing block of the decorrelated ambiguities, which is independent of the leading ones
+         * @param offset index of the first ambiguity of the block
+         * @param zs float solution of the block
+         * @param zn best candidates, column wise
+         * @param s squared norms of the candidates in ascending order
+         * @param truncated the budget ran out before the ellipsoid has been exhausted
+         * @return number of candidates found
+         */
+        int search(int offset, const VectorXd &zs, MatrixXd &zn, VectorXd &s, bool &truncated) {
+            const int n = n_ - offset;
+            const int m = params_.numCandidates;
+            const auto L = L_.bottomRightCorner(n, n);
+            const auto D = D_.tail(n);
+
+            zn.setZero(n, m);
+            s.setZero(m);
+            MatrixXd S = MatrixXd::Zero(n, n);
+            VectorXd dist = VectorXd::Zero(n), zb = VectorXd::Zero(n), z = VectorXd::Zero(n), step = VectorXd::Zero(n);
+
+            int k = n - 1;
+            zb(k) = zs(k);
+            z(k) = fgo::utils::round(zb(k));
+            double y = zb(k) - z(k);
+            step(k) = sign(y);
+
+            int nn = 0, imax = 0;
+            double maxdist = 1E99;
+            truncated = true;
+            for (long c = 0; loopsLeft_ > 0; c++, loopsLeft_--) {
+                if (params_.timeBudget.count() > 0 && (c & 0xff) == 0 && std::chrono::steady_clock::now() > deadline_) {
+                    loopsLeft_ = 0;
+                    break;
+                }
+                const double newdist = dist(k) + y * y / D(k);
+                if (newdist < maxdist) {
+                    if (k != 0) {
+                        dist(--k) = newdist;
+                        S.row(k).head(k + 1) = S.row(k + 1).head(k + 1) +
+                                               (z(k + 1) - zb(k + 1)) * L.row(k + 1).head(k + 1);
+                        zb(k) = zs(k) + S(k, k);
+                        z(k) = fgo::utils::round(zb(k));
+                        y = zb(k) - z(k);
+                        step(k) = sign(y);
+                    } else {
+                        if (nn < m) {
+                            if (nn == 0 || newdist > s(imax))
+                                imax = nn;
+                            zn.col(nn) = z;
+                            s(nn++) = newdist;
+                        } else {
+                            if (newdist < s(imax)) {
+                                zn.col(imax) = z;
+                                s(imax) = newdist;
+                                s.maxCoeff(&imax);
+                            }
+                            // the ellipsoid shrinks to the worst of the best m candidates
+                            maxdist = s(imax);
+                        }
+                        z(0) += step(0);
+                        y = zb(0) - z(0);
+                        step(0) = -step(0) - sign(step(0));
+                    }
+                } else {
+                    if (k == n - 1) {
+                        truncated = false;
+                        break;
+                    }
+                    k++;
+                    z(k) += step(k);
+                    y = zb(k) - z(k);
+                    step(k) = -step(k) - sign(step(k));
+                }
+            }
+
+            // sort the candidates ascending
+            for (int i = 0; i < nn - 1; i++) {
+                for (int j = i + 1; j < nn; j++) {
+                    if (s(i) < s(j))
+                        continue;
+                    std::swap(s(i), s(j));
+                    zn.col(i).swap(zn.col(j));
+                }
+            }
+            zn.conservativeResize(n, nn);
+            s.conservativeResize(nn);
+            return nn;
+        }
+
+        LambdaParams params_;
+        int n_ = 0;
+        MatrixXd L_;
+        VectorXd D_;
+        MatrixXd Z_;    // z = Z' a
+        MatrixXd Zit_;  // inverse transpose of Z, a = Z^-T z
+        long loopsLeft_ = 0;
+        std::chrono::steady_clock::time_point deadline_;
+    };
+    /*--------------------------------------------------------------------------*/
 }
 
 #endif //ONLINE_FGO_LAMBDAALGORITHM_H
@@ -36,6 +36,7 @@
 #include <GeographicLib/MagneticModel.hpp>
 
 #include "utils/Constants.h"
+#include "utils/Geodesy.h"
 
 #define P_T                50  /* T */
 #define P_A                30  /* A */
@@ -59,8 +60,7 @@ namespace fgo::utils {
 
     //// Convert WGS-84 ECEF coordinates to LLH
     ////
-    //// REF :: Groves, Paul. Principles of GNSS, Inertial, and Multisensor Integrated
-    ////        Navigation Systems. Artech House, 2008
+    //// Bowring's method with a fixed number of iterations, see geodesy::ecef2Frame
 
     inline gtsam::Point3 xyz2llh(const gtsam::Point3 &p1)
     {
@@ -70,47 +70,7 @@ namespace fgo::utils {
         output ::
         posLLH --> latitude, longitude, height [rad,rad,meter]
         */
-
-        double x2 = pow(p1.x(), 2);
-        double y2 = pow(p1.y(), 2);
-        double z2 = pow(p1.z(), 2);
-
-        double e = sqrt(1.0 - ((semiMinor / semiMajor) * (semiMinor / semiMajor)));
-        double b2 = pow(semiMinor, 2);
-        double e2 = pow(e, 2);
-        double ep = e * (semiMajor / semiMinor);
-        double r = sqrt(x2 + y2);
-        double r2 = pow(r, 2);
-        double E2 = pow(semiMajor, 2) - pow(semiMinor, 2);
-        double F = 54 * b2 * z2;
-        double G = r2 + (1 - e2) * z2 - e2 * E2;
-        double c = (pow(e2, 2) * F * r2) / (pow(G, 3));
-        double s = pow((1.0 + c + sqrt(c * c + 2 * c)), 1.0 / 3.0);
-
-        double P = F / (3.0 * (s + 1 / s + 1) * (s + 1 / s + 1) * G * G);
-        double Q = sqrt(1.0 + 2 * e2 * e2 * P);
-        double ro = -(P * e2 * r) / (1 + Q) +
-                    sqrt((semiMajor * semiMajor / 2) * (1 + 1 / Q) - (P * (1 - e2) * z2) / (Q * (1 + Q)) -
-                         P * r2 / 2);
-        double tmp = pow((r - e2 * ro), 2);
-        double U = sqrt(tmp + z2);
-        double V = sqrt(tmp + (1 - e2) * z2);
-        double zo = (b2 * p1.z()) / (semiMajor * V);
-
-        double height = U * (1.0 - b2 / (semiMajor * V));
-        double lat = std::atan((p1.z() + ep * ep * zo) / r);
-        double temp = std::atan(p1.y() / p1.x());
-        double longitude;
-        if (p1.x() >= 0.0) {
-            longitude = temp;
-        } else if ((p1.x() < 0.0) && (p1.y() >= 0.0)) {
-            longitude = temp + M_PI;
-        } else {
-            longitude = temp - M_PI;
-
-        }
-        gtsam::Point3 llh(lat, longitude, height);
-        return llh;
+        return geodesy::ecef2Frame(p1).llh;
     }
 
     inline gtsam::Point3 llh2xyz(const gtsam::Point3 &llh)
@@ -121,51 +81,23 @@ namespace fgo::utils {
         output ::
         pos_ecef --> ECEF xyz receiver coordinates [meter]
         */
-        double b = llh.x();
-        double l = llh.y();
-        double h = llh.z();
-        auto a = semiMajor;
-        double f = 1 - semiMinor / semiMajor;
-        double ex2 = (2 - f) * f / (pow((1 - f), 2));
-        double c = a * sqrt(1 + ex2);
-        double N = c / sqrt(1 + ex2 * pow(cos(b), 2));
-        double x = (N + h) * cos(b) * cos(l);
-        double y = (N + h) * cos(b) * sin(l);
-        double z = (pow((1 - f), 2) * N + h) * sin(b);
-        gtsam::Point3 pos_ecef(x, y, z);
-        return pos_ecef;
+        return geodesy::frame2ECEF(geodesy::llh2Frame(llh));
       }
 
     inline gtsam::Matrix33 nedRe_Matrix_asLLH(const gtsam::Point3 &llh) {
-      double sLat = sin(llh(0));
-      double sLon = sin(llh(1));
-      double cLat = cos(llh(0));
-      double cLon = cos(llh(1));
-
-      gtsam::Matrix R = (gtsam::Matrix33() << -sLat * cLon, -sLat * sLon, cLat,
-          -sLon, cLon, 0.0,
-          -cLat * cLon, -cLat * sLon, -sLat).finished();
-      return R;
+      return geodesy::llh2Frame(llh).nedRe();
     }
 
     //// Generate rotation matrix from Earth-to-Navigation frame
     // n navigation frame refers to ned frame
     inline gtsam::Matrix33 nedRe_Matrix(const gtsam::Point3 &ECEFxyz)
     {
-        gtsam::Vector3 llh = xyz2llh(ECEFxyz);
-        return nedRe_Matrix_asLLH(llh);
+        return geodesy::ecef2Frame(ECEFxyz).nedRe();
     }
 
     inline gtsam::Matrix33 enuRe_Matrix_asLLH(const gtsam::Point3 &llh)
     {
-      double sinPhi = sin(llh(0));
-      double cosPhi = cos(llh(0));
-      double sinLam = sin(llh(1));
-      double cosLam = cos(llh(1));
-      gtsam::Matrix R = (gtsam::Matrix33() << -1 * sinLam, cosLam, 0,
-          -1 * sinPhi * cosLam, -1 * sinPhi * sinLam, cosPhi,
-          cosPhi * cosLam, cosPhi * sinLam, sinPhi).finished();
-      return R;
+      return geodesy::llh2Frame(llh).enuRe();
     }
 
     inline gtsam::Matrix33 enuRe_Matrix(const gtsam::Point3 &base)
@@ -176,8 +108,7 @@ namespace fgo::utils {
          outputs ::
           R ---> RotationMatrix xyz 2 enu [meters]
        */
-      gtsam::Vector3 orgLLH = xyz2llh(base);
-      return enuRe_Matrix_asLLH(orgLLH);
+      return geodesy::ecef2Frame(base).enuRe();
     }
 
     inline gtsam::Matrix33 nedRenu_llh(const gtsam::Point3& llh)
@@ -190,8 +121,9 @@ namespace fgo::utils {
 
     inline gtsam::Matrix33 nedRenu_xyz(const gtsam::Point3& xyz)
     {
-      const auto nedRe = nedRe_Matrix(xyz);
-      const auto enuRe = enuRe_Matrix(xyz);
+      const auto frame = geodesy::ecef2Frame(xyz);
+      const auto nedRe = frame.nedRe();
+      const auto enuRe = frame.enuRe();
 
       return nedRe * enuRe.transpose();
     }
@@ -214,19 +146,7 @@ namespace fgo::utils {
                   posENU --> ENU position coordinates [meters]
          */
 
-        gtsam::Vector3 posDiff = p1 - p2;
-        gtsam::Vector3 orgLLH = xyz2llh(p2);
-        double sinPhi = sin(orgLLH(0));
-        double cosPhi = cos(orgLLH(0));
-        double sinLam = sin(orgLLH(1));
-        double cosLam = cos(orgLLH(1));
-        gtsam::Matrix R = (gtsam::Matrix33() << (-1 * sinLam), cosLam, 0,
-                ((-1 * sinPhi) * cosLam), ((-1 * sinPhi) * sinLam), cosPhi,
-                (cosPhi * cosLam), (cosPhi * sinLam), sinPhi).finished();
-        //gtsam::Vector3 pos;
-        //pos = R*posDiff;
-        //gtsam::Point3 posENU;
-        gtsam::Point3 posENU = R * posDiff;
+        gtsam::Point3 posENU = geodesy::ecef2Frame(p2).enuRe() * (p1 - p2);
         return posENU;
     }
 
@@ -238,15 +158,7 @@ namespace fgo::utils {
            outputs ::
             posXYZ ---> ECEF XYZ position vector [meters]
          */
-        gtsam::Vector3 orgLLH = xyz2llh(p2);
-        double sinPhi = sin(orgLLH(0));
-        double cosPhi = cos(orgLLH(0));
-        double sinLam = sin(orgLLH(1));
-        double cosLam = cos(orgLLH(1));
-        gtsam::Matrix R = (gtsam::Matrix33() << -1 * sinLam, cosLam, 0,
-                -1 * sinPhi * cosLam, -1 * sinPhi * sinLam, cosPhi,
-                cosPhi * cosLam, cosPhi * sinLam, sinPhi).finished();
-        gtsam::Point3 deltaXYZ = R.inverse() * p1;
+        gtsam::Point3 deltaXYZ = geodesy::ecef2Frame(p2).enuRe().transpose() * p1;
         return p2 + deltaXYZ;
     }
 
@@ -259,15 +171,7 @@ namespace fgo::utils {
          outputs ::
           deltaXYZ ---> a rotated vector in ECEF coords [meters]
        */
-      gtsam::Vector3 orgLLH = xyz2llh(base);
-      double sinPhi = sin(orgLLH(0));
-      double cosPhi = cos(orgLLH(0));
-      double sinLam = sin(orgLLH(1));
-      double cosLam = cos(orgLLH(1));
-      gtsam::Matrix R = (gtsam::Matrix33() << -1 * sinLam, cosLam, 0,
-              -1 * sinPhi * cosLam, -1 * sinPhi * sinLam, cosPhi,
-              cosPhi * cosLam, cosPhi * sinLam, sinPhi).finished();
-      gtsam::Point3 deltaXYZ = R.inverse() * p1;
+      gtsam::Point3 deltaXYZ = geodesy::ecef2Frame(base).enuRe().transpose() * p1;
       return deltaXYZ;
     }
 
@@ -299,30 +203,9 @@ namespace fgo::utils {
          output ::
          g_e --> acceleration due to gravity w.r.t ECEF frame (m/s^2)
        */
-      //parameters
-      double R_0 = 6378137; //WGS84 Equatorial radius in meters
-      double mu = 3.986004418e+14; //WGS84 Earth gravitational constant (m^3 s^-2)
-      double J_2 = 1.082627e-3; //WGS84 Earth's second gravitational constant
-      double omega_ie = 7.292115e-5;  // Earth rotation rate (rad/s)
-      gtsam::Vector3 g_e;
-      // distance from center of the earth
-      double mag_r = gtsam::norm3(r_eb_e);
-      // dummy output when the input position is 0,0,0
-      if (mag_r == 0) { g_e = gtsam::Vector3(0, 0, 0); }
-          // calculate gravitational acceleration using (2.142) in "Groves,Principles of GNSS, Inertial, and Multisensor
-          //% Integrated Navigation Systems"
-      else {
-          double z_scale = 5 * pow(r_eb_e.z() / mag_r, 2);
-          gtsam::Vector3 tmp = gtsam::Vector3((1 - z_scale) * r_eb_e.x(),
-                                              (1 - z_scale) * r_eb_e.y(),
-                                              (3 - z_scale) * r_eb_e.z());
-          tmp = r_eb_e + (1.5 * J_2 * pow(R_0 / mag_r, 2)) * tmp;
-
-          gtsam::Vector3 gamma = (-mu / pow(mag_r, 3)) * tmp;
-          g_e = gamma + pow(omega_ie, 2) *
-                        gtsam::Vector3(r_eb_e.x(), r_eb_e.y(), 0);
-      }
-      return g_e;
+      // (2.142) in "Groves, Principles of GNSS, Inertial, and Multisensor Integrated Navigation Systems",
+      // zero when the input position is 0,0,0
+      return geodesy::gravityECEF(r_eb_e);
     }
 
     inline gtsam::Vector3 gravity_ned(const gtsam::Point3 &r_eb_e)
@@ -102,6 +102,12 @@ namespace fgo::utils {
     const gtsam::Vector6 &)> func, const gtsam::Vector6 &xi,
                                              const gtsam::Vector6 &x, double dxi = 1e-6);
 
+/// analytic d(rightJacobianPose3inv(xi)*x)/dxi
+  gtsam::Matrix6 jacobianRightJacobianPose3inv(const gtsam::Vector6 &xi, const gtsam::Vector6 &x);
+
+/// analytic d(leftJacobianPose3(xi)*x)/dxi
+  gtsam::Matrix6 jacobianLeftJacobianPose3(const gtsam::Vector6 &xi, const gtsam::Vector6 &x);
+
 /// left Jacobian for Rot3 Expmap
   gtsam::Matrix3 leftJacobianRot3(const gtsam::Vector3 &omega);
 
@@ -0,0 +1,148 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_SATELLITESTATETABLE_H
+#define ONLINE_FGO_SATELLITESTATETABLE_H
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace fgo::utils::GNSS {
+
+  /***
+   * tracking state of one satellite signal carried from one GNSS epoch to the next
+   */
+  struct SatelliteState {
+    double locktime = -1.;        // locktime reported by the receiver in the last epoch, -1 if not tracked
+    double lastPhase = 0.;        // carrier phase of the last epoch [cycle]
+    // running statistics of the code-minus-carrier cycle slip detector
+    double md = 0.;               // mean
+    double md2 = 0.;              // squared mean
+    double sd2 = 0.;              // variance
+    int32_t N = 0;                // number of epochs without slip
+    uint32_t lastEpoch = 0;       // epoch counter of the table when the signal was last seen, 0 if never
+    bool ambiguityLocked = false; // the carrier phase ambiguity can be carried over from the last epoch
+    bool isReferenceSatellite = false;
+
+    void resetStatistics() {
+      md = md2 = sd2 = 0.;
+      N = 0;
+    }
+  };
+
+  /***
+   * Fixed-capacity table of satellite tracking states indexed by satellite ID and carrier, replacing the
+   * per-epoch scans over the satellite lists of the last epoch. Satellite IDs are the receiver SVIDs, so all
+   * constellations share one ID space. A signal that was not seen in the directly preceding epoch is recognized by
+   * its epoch counter, hence satellites that were lost don't need to be searched for.
+   * @tparam MaxSatelliteID exclusive upper bound of the satellite IDs
+   * @tparam NumFrequencies number of carriers per satellite, see fgo::data::GNSSFrequency
+   */
+  template<uint32_t MaxSatelliteID = 256, uint32_t NumFrequencies = 3>
+  class SatelliteStateTable {
+  public:
+    static constexpr uint32_t Capacity = MaxSatelliteID * NumFrequencies;
+
+    /***
+     * start a new epoch, must be called once before the observations of the epoch are processed
+     */
+    void beginEpoch() { epoch_++; }
+
+    /***
+     * forget the history of all signals in O(1), no signal will be continuous in the next epoch
+     */
+    void invalidate() { epoch_++; }
+
+    /***
+     * @param satID
+     * @param frequency carrier of the signal
+     * @return state of the signal or nullptr if the ID is out of the range of the table
+     */
+    SatelliteState *find(uint32_t satID, uint32_t frequency = 0) {
+      if (satID >= MaxSatelliteID || frequency >= NumFrequencies)
+        return nullptr;
+      return &states_[frequency * MaxSatelliteID + satID];
+    }
+
+    /***
+     * @param state
+     * @return true if the signal was also seen in the epoch before the current one
+     */
+    [[nodiscard]] bool isContinuous(const SatelliteState &state) const {
+      return state.lastEpoch != 0 && state.lastEpoch + 1 == epoch_;
+    }
+
+    void markSeen(SatelliteState &state) const { state.lastEpoch = epoch_; }
+
+    /***
+     * @param state
+     * @return true if the signal has already been processed in the current epoch, e.g. a repeated observation
+     */
+    [[nodiscard]] bool isSeenInEpoch(const SatelliteState &state) const {
+      return state.lastEpoch != 0 && state.lastEpoch == epoch_;
+    }
+
+    void reset() {
+      states_.fill(SatelliteState());
+      epoch_ = 0;
+    }
+
+    [[nodiscard]] uint32_t epoch() const { return epoch_; }
+
+  private:
+    std::array<SatelliteState, Capacity> states_{};
+    uint32_t epoch_ = 0;
+  };
+
+  typedef SatelliteStateTable<> DefaultSatelliteStateTable;
+
+  /***
+   * maps satellite IDs to the position of an element in a list, e.g. of the satellite labels, to replace nested
+   * searches by one linear pass
+   */
+  template<uint32_t MaxSatelliteID = 256>
+  class SatelliteIndex {
+  public:
+    template<class Container, class GetID>
+    void build(const Container &container, GetID &&getID) {
+      index_.fill(-1);
+      int32_t i = 0;
+      for (const auto &item: container) {
+        const uint32_t id = getID(item);
+        if (id < MaxSatelliteID && index_[id] < 0)
+          index_[id] = i;
+        i++;
+      }
+    }
+
+    /***
+     * @param satID
+     * @return position in the container or -1 if not found
+     */
+    [[nodiscard]] int32_t find(uint32_t satID) const {
+      return satID < MaxSatelliteID ? index_[satID] : -1;
+    }
+
+  private:
+    std::array<int32_t, MaxSatelliteID> index_{};
+  };
+}
+
+#endif //ONLINE_FGO_SATELLITESTATETABLE_H
@@ -0,0 +1,139 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#ifndef ONLINE_FGO_TRAJECTORYEVALUATOR_H
+#define ONLINE_FGO_TRAJECTORYEVALUATOR_H
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <gtsam/geometry/Pose3.h>
+
+// no ROS dependency, so that the evaluation can be used in tests and tools outside of a node
+namespace fgo::utils {
+
+  /***
+   * one sample of a trajectory resolved in a local-level frame (NED or ENU), the 2D errors are taken in the x-y plane
+   * and the heading is the yaw of the attitude
+   */
+  struct TrajectorySample {
+    double timestamp = 0.;
+    gtsam::Pose3 pose;
+    gtsam::Vector3 velocity = gtsam::Vector3::Zero();
+    bool hasAttitude = true;
+    bool hasVelocity = true;
+    int solutionType = -1;  // solution type of the reference, used for the breakdown
+  };
+
+  struct ErrorStatistics {
+    size_t count = 0;
+    double mean = 0.;
+    double rmse = 0.;
+    double median = 0.;
+    double max = 0.;
+
+    static ErrorStatistics fromSamples(std::vector<double> samples);
+  };
+
+  struct RelativeErrorStatistics {
+    ErrorStatistics translation;  // [m]
+    ErrorStatistics rotation;     // [deg]
+    double driftPercent = 0.;     // mean translation error over the segment length
+  };
+
+  struct SolutionTypeStatistics {
+    ErrorStatistics position2D;
+    ErrorStatistics position3D;
+    ErrorStatistics heading;
+    ErrorStatistics velocity;
+  };
+
+  struct TrajectoryEvaluation {
+    size_t numEstimated = 0;
+    size_t numAssociated = 0;
+    gtsam::Rot3 alignmentRotation;
+    gtsam::Point3 alignmentTranslation = gtsam::Point3::Zero();
+    double alignmentScale = 1.;
+
+    ErrorStatistics position2D;  // absolute trajectory error [m]
+    ErrorStatistics position3D;
+    ErrorStatistics rotation;    // [deg]
+    ErrorStatistics heading;     // [deg]
+    ErrorStatistics velocity;    // [m/s]
+    std::map<double, RelativeErrorStatistics> relative;  // per segment length [m]
+    std::map<int, SolutionTypeStatistics> bySolutionType;
+
+    /***
+     * write a human-readable summary
+     * @param os
+     * @param solutionTypeName name of a solution type for the breakdown, the number is printed if not given
+     */
+    void writeSummary(std::ostream &os, const std::function<std::string(int)> &solutionTypeName = {}) const;
+  };
+
+  enum class TrajectoryAlignment {
+    NONE = 0,
+    SE3 = 1,
+    SIM3 = 2,  // SE(3) with scale
+  };
+
+  struct TrajectoryEvaluatorParams {
+    double maxTimeDifference = 0.05;    // [s] max. distance of a reference sample for the association
+    double maxReferenceGap = 0.5;       // [s] reference samples further apart are not interpolated
+    TrajectoryAlignment alignment = TrajectoryAlignment::SE3;
+    std::vector<double> segmentLengths = {100., 200., 400., 800.};  // [m] along the reference
+  };
+
+  /***
+   * Trajectory evaluation against a reference: the estimated samples are associated with the reference by a binary
+   * search in time and the reference is interpolated in between. The estimate is then aligned to the reference with
+   * Umeyama's method and the absolute (ATE) and relative (RPE) errors as well as the heading and velocity errors are
+   * computed, overall and per solution type of the reference.
+   */
+  class TrajectoryEvaluator {
+  public:
+    explicit TrajectoryEvaluator(const TrajectoryEvaluatorParams &params = TrajectoryEvaluatorParams()) :
+      params_(params) {}
+
+    /***
+     * @param estimate samples sorted by time
+     * @param reference samples sorted by time
+     * @return evaluation, empty if no sample could be associated
+     */
+    [[nodiscard]] TrajectoryEvaluation evaluate(const std::vector<TrajectorySample> &estimate,
+                                                const std::vector<TrajectorySample> &reference) const;
+
+    /***
+     * find the reference at the timestamp of each estimated sample
+     * @param estimate samples sorted by time
+     * @param reference samples sorted by time
+     * @return pairs of estimated and interpolated reference samples
+     */
+    [[nodiscard]] std::vector<std::pair<TrajectorySample, TrajectorySample>>
+    associate(const std::vector<TrajectorySample> &estimate, const std::vector<TrajectorySample> &reference) const;
+
+  private:
+    TrajectoryEvaluatorParams params_;
+  };
+}
+
+#endif //ONLINE_FGO_TRAJECTORYEVALUATOR_H
@@ -0,0 +1,39 @@
+import os
+from ament_index_python.packages import get_package_share_directory
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import Node
+from launch import LaunchDescription
+
+
+def generate_launch_description():
+    config_dir = os.path.join(get_package_share_directory('online_fgo'), 'config/learning_gp')
+
+    config_sweep_path = LaunchConfiguration('config_sweep_path')
+    declare_config_sweep_path_cmd = DeclareLaunchArgument(
+        'config_sweep_path',
+        default_value=os.path.join(config_dir, 'sweep.yaml'),
+        description='SweepParameters')
+
+    # the runner is named as the learning_gp node, so that all learning_gp configurations apply as base configuration
+    offline_sweep_node = Node(
+        package='online_fgo',
+        executable='offline_sweep_node',
+        name="learning_gp",
+        namespace="offline_process",
+        output='screen',
+        emulate_tty=True,
+        parameters=[
+            os.path.join(config_dir, 'common.yaml'),
+            os.path.join(config_dir, 'integrator.yaml'),
+            os.path.join(config_dir, 'optimizer.yaml'),
+            os.path.join(config_dir, 'dataset.yaml'),
+            os.path.join(config_dir, 'sensor_parameters.yaml'),
+            config_sweep_path,
+        ],
+    )
+
+    ld = LaunchDescription()
+    ld.add_action(declare_config_sweep_path_cmd)
+    ld.add_action(offline_sweep_node)
+    return ld
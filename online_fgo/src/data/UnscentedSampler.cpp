@@ -20,9 +20,23 @@
 // Created by haoming on 22.05.24.
 //
 
+
 #include "data/sampling/UncentedSampler.h"
 
 namespace fgo::data::sampler {
+  const gtsam::Matrix &SigmaPoints::sqrtCovariance(const gtsam::Matrix &cov, bool isTrangularized) {
+    if (isTrangularized)
+      return cov;
+    if (hasSqrtCov_ && lastCov_.rows() == cov.rows() && lastCov_.cols() == cov.cols() && lastCov_ == cov)
+      return sqrtCov_;
+    // the storage of the decomposition and of the cached matrices is reused as long as the dimension is unchanged
+    llt_.compute(cov);
+    lastCov_ = cov;
+    sqrtCov_ = llt_.matrixL();
+    hasSqrtCov_ = true;
+    return sqrtCov_;
+  }
+
   MerweScaledSigmaPoints::MerweScaledSigmaPoints(size_t n, double alpha, double beta, double kappa)
     : alpha_(alpha), beta_(beta) {
     kappa_ = kappa;
@@ -37,33 +51,17 @@ namespace fgo::data::sampler {
     Wc_[0] = lambda_ / (n_state_ + lambda_) + (1 - alpha_ * alpha_ + beta_);
   }
 
-  gtsam::Matrix MerweScaledSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
-                                                     bool isTrangularized) {
-    gtsam::Matrix A;
-    if (!isTrangularized) {
-      A = cov.llt().matrixL();
-    } else
-      A = cov;
-    // std::cout << A << std::endl;
+  void MerweScaledSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
+                                            gtsam::Matrix &sigmas, bool isTrangularized) {
+    const auto &A = sqrtCovariance(cov, isTrangularized);
+    const auto n = static_cast<Eigen::Index>(n_state_);
     const auto s = sqrt(lambda_ + n_state_);
-    gtsam::Matrix sigmas = gtsam::Matrix::Zero(n_sigma_points_, n_state_);
-    sigmas.row(0) = mean;
-    for (size_t i = 0; i < n_state_; i++) {
-      sigmas.block(i + 1, 0, 1, n_state_) = (s * A.row(i)) + mean.transpose();
-      sigmas.block(n_state_ + i + 1, 0, 1, n_state_) = (-1 * s * A.row(i)) + mean.transpose();
-    }
-
-    /*
-    std::cout << "rows: " << sigmas.rows() << " cols: " << sigmas.cols() << std::endl;
-
-    for(size_t i = 0; i < sigmas.rows(); i++)
-    {
-        std::cout << sigmas.row(i) << std::endl;
-    }
-
-    std::cout << std::endl;
-    */
-    return sigmas;
+    sigmas.resize(n_sigma_points_, n_state_);
+    sigmas.row(0) = mean.transpose();
+    // the columns of the lower Cholesky factor are the principal directions, A * A^T = cov
+    sigmas.middleRows(1, n).noalias() = s * A.transpose();
+    sigmas.middleRows(n + 1, n).noalias() = -s * A.transpose();
+    sigmas.bottomRows(2 * n).rowwise() += mean.transpose();
   }
 
   JulierSigmaPoints::JulierSigmaPoints(size_t n, double kappa) {
@@ -75,113 +73,75 @@ namespace fgo::data::sampler {
     Wc_ = Wm_;
   }
 
-  gtsam::Matrix JulierSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
-                                                bool isTrangularized) {
-    gtsam::Matrix A;
-    if (!isTrangularized) {
-      A = cov.llt().matrixL();
-    } else
-      A = cov;
+  void JulierSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
+                                       gtsam::Matrix &sigmas, bool isTrangularized) {
+    const auto &A = sqrtCovariance(cov, isTrangularized);
+    const auto n = static_cast<Eigen::Index>(n_state_);
     const auto s = sqrt(kappa_ + n_state_);
-    gtsam::Matrix sigmas = gtsam::Matrix::Zero(n_sigma_points_, n_state_);
-    sigmas.row(0) = mean;
-
-    for (size_t i = 0; i < n_state_; i++) {
-      sigmas.block(i + 1, 0, 1, n_state_) = (s * A.row(i)) + mean;
-      sigmas.block(n_state_ + i + 1, 0, 1, n_state_) = (-1 * s * A.row(i)) + mean;
-    }
-    std::cout << "rows: " << sigmas.rows() << " cols: " << sigmas.cols() << std::endl;
-    return sigmas;
+    sigmas.resize(n_sigma_points_, n_state_);
+    sigmas.row(0) = mean.transpose();
+    sigmas.middleRows(1, n).noalias() = s * A.transpose();
+    sigmas.middleRows(n + 1, n).noalias() = -s * A.transpose();
+    sigmas.bottomRows(2 * n).rowwise() += mean.transpose();
   }
 
   SimplexSigmaPoints::SimplexSigmaPoints(size_t n, double alpha) : alpha_(alpha) {
     n_state_ = n;
     n_sigma_points_ = n_state_ + 1;
-    lambda_ = n_state_ / n_sigma_points_;
+    lambda_ = static_cast<double>(n_state_) / static_cast<double>(n_sigma_points_);
     const auto c = 1. / n_sigma_points_;
     Wm_ = gtsam::Vector::Ones(n_sigma_points_) * c;
     Wc_ = Wm_;
-  }
 
-  gtsam::Matrix SimplexSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
-                                                 bool isTrangularized) {
-    gtsam::Matrix A;
-    if (!isTrangularized) {
-      A = cov.llt().matrixL();
-    } else
-      A = cov;
-    const auto Istar = nc::NdArray<double>();
-
-    for (size_t i = 1; i < n_state_ + 1; i++) {
-      const auto vf = 1. / sqrt(lambda_ * i * (i + 1));
-      const auto vb = -n_state_ * vf;
-      auto row = nc::ones<double>(1, n_state_) * vf;
-      row = nc::append(row, nc::asarray({vb}));
-      for (size_t k = 0; k < n_state_ + 1 - row.shape().cols; k++) {
-        row = nc::append(row, nc::zeros<double>(1));
-      }
-      nc::append(Istar, row, nc::Axis::ROW);
+    // unit simplex after Julier, row d - 1 holds the d-th dimension of the n + 1 points
+    gtsam::Matrix Istar = gtsam::Matrix::Zero(n_state_, n_sigma_points_);
+    if (n_state_ > 0) {
+      Istar(0, 0) = -1. / sqrt(2. * lambda_);
+      Istar(0, 1) = 1. / sqrt(2. * lambda_);
+    }
+    for (size_t d = 2; d <= n_state_; d++) {
+      const auto vf = 1. / sqrt(lambda_ * d * (d + 1));
+      Istar.block(d - 1, 0, 1, d).setConstant(vf);
+      Istar(d - 1, d) = -static_cast<double>(d) * vf;
     }
+    unitSigmas_ = sqrt(static_cast<double>(n_state_)) * Istar.transpose();
+  }
 
-    const auto I = nc::sqrt(n_state_) * Istar;
-    const auto I_ = gtsam::Matrix::Map(I.data(), I.numRows(), I.numCols());
-    const auto scaled_unitary = A.transpose() * I_;
-    return scaled_unitary.colwise() + mean;
+  void SimplexSigmaPoints::sigma_points(const gtsam::Vector &mean, const gtsam::Matrix &cov,
+                                        gtsam::Matrix &sigmas, bool isTrangularized) {
+    const auto &A = sqrtCovariance(cov, isTrangularized);
+    sigmas.resize(n_sigma_points_, n_state_);
+    sigmas.noalias() = unitSigmas_ * A.transpose();
+    sigmas.rowwise() += mean.transpose();
   }
 
+  SigmaPoints::SharedPtr createSigmaPoints(const SamplerConfig &param, size_t n) {
+    if (param.sigmaType == "Merwe")
+      return std::make_shared<MerweScaledSigmaPoints>(n, param.alpha, param.beta, param.kappa);
+    else if (param.sigmaType == "Julier")
+      return std::make_shared<JulierSigmaPoints>(n, param.kappa);
+    else if (param.sigmaType == "Simplex")
+      return std::make_shared<SimplexSigmaPoints>(n, param.alpha);
+    else
+      throw std::runtime_error("UnscentedSampler::sigma type " + param.sigmaType + " not supported!");
+  }
 
   UnscentedSampler::UnscentedSampler(const SamplerConfig::SharedPtr &param,
                                      const gtsam::Vector &mean,
                                      const gtsam::noiseModel::Base::shared_ptr &model)
     : gtsam::Sampler(mean, model), param_(param) {
-    if (param_->sigmaType == "Merwe")
-      sigma_generator_ = std::make_shared<MerweScaledSigmaPoints>(mean.size(),
-                                                                  param_->alpha,
-                                                                  param_->beta,
-                                                                  param_->kappa);
-    else if (param_->sigmaType == "Julier")
-      sigma_generator_ = std::make_shared<JulierSigmaPoints>(mean.size(), param_->kappa);
-
-    else if (param_->sigmaType == "Simplex")
-      sigma_generator_ = std::make_shared<SimplexSigmaPoints>(mean.size(), param_->alpha);
-
-    else
-      throw std::runtime_error("UnscentedSampler::sigma type " + param_->sigmaType + " not supported!");
+    sigma_generator_ = createSigmaPoints(*param_, mean.size());
   }
 
   UnscentedSampler::UnscentedSampler(const SamplerConfig::SharedPtr &param, const gtsam::Vector &sigmas)
     : gtsam::Sampler(sigmas), param_(param) {
-    if (param_->sigmaType == "Merwe")
-      sigma_generator_ = std::make_shared<MerweScaledSigmaPoints>(sigmas.size(),
-                                                                  param_->alpha,
-                                                                  param_->beta,
-                                                                  param_->kappa);
-    else if (param_->sigmaType == "Julier")
-      sigma_generator_ = std::make_shared<JulierSigmaPoints>(sigmas.size(), param_->kappa);
-
-    else if (param_->sigmaType == "Simplex")
-      sigma_generator_ = std::make_shared<SimplexSigmaPoints>(sigmas.size(), param_->alpha);
-
-    else
-      throw std::runtime_error("UnscentedSampler::sigma type " + param_->sigmaType + " not supported!");
+    sigma_generator_ = createSigmaPoints(*param_, sigmas.size());
   }
 
   UnscentedSampler::UnscentedSampler(const SamplerConfig::SharedPtr &param, const gtsam::Vector &mean,
                                      const gtsam::Matrix &cov)
     : gtsam::Sampler(mean, gtsam::noiseModel::Gaussian::Covariance(cov, false)), param_(param), cov_(cov) {
-    if (param_->sigmaType == "Merwe")
-      sigma_generator_ = std::make_shared<MerweScaledSigmaPoints>(mean.size(),
-                                                                  param_->alpha,
-                                                                  param_->beta,
-                                                                  param_->kappa);
-    else if (param_->sigmaType == "Julier")
-      sigma_generator_ = std::make_shared<JulierSigmaPoints>(mean.size(), param_->kappa);
-
-    else if (param_->sigmaType == "Simplex")
-      sigma_generator_ = std::make_shared<SimplexSigmaPoints>(mean.size(), param_->alpha);
-
-    else
-      throw std::runtime_error("UnscentedSampler::sigma type " + param_->sigmaType + " not supported!");
+    sigma_generator_ = createSigmaPoints(*param_, mean.size());
   }
 
   /*
@@ -198,9 +158,14 @@ namespace fgo::data::sampler {
 
 
   gtsam::Matrix UnscentedSampler::samples() const {
-    const auto sigma_points = sigma_generator_->sigma_points(this->mean(), cov_, false);
+    gtsam::Matrix sigma_points;
+    this->samples(sigma_points);
     return sigma_points;
   }
 
+  void UnscentedSampler::samples(gtsam::Matrix &sigmas) const {
+    sigma_generator_->sigma_points(this->mean(), cov_, sigmas, false);
+  }
+
 
-}
\ No newline at end of file
+}
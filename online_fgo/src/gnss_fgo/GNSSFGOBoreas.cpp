@@ -41,7 +41,7 @@ namespace gnss_fgo {
   }
 
   void GNSSFGOBoreasNode::onPVAGTMsgCb(nav_msgs::msg::Odometry::ConstSharedPtr pva) {
-    static const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
+    const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
     rclcpp::Time ts = rclcpp::Time(pva->header.stamp.sec, pva->header.stamp.nanosec, RCL_ROS_TIME);
     fgo::data::PVASolution this_pva{};
 
@@ -95,8 +95,8 @@ namespace gnss_fgo {
   }
 
   void GNSSFGOBoreasNode::calculateErrorOnState(const fgo::data::State &stateIn) {
-    static const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
-    static std::vector<fgo::data::State> stateCached;
+    const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
+    auto &stateCached = errorStateCache_;
 
     //auto labelBuffer = gnssLabelingMsgBuffer_.get_all_buffer();
 
@@ -163,8 +163,9 @@ namespace gnss_fgo {
         const auto fgo_bias_std = stateIter->imuBiasVar.diagonal().cwiseSqrt();
 
         const auto pos_ant_main = fgo_pos_ecef + fgo_ori_ecef.rotate(transReferenceFromBase.translation());
-        const auto pos_ant_llh = fgo::utils::xyz2llh(pos_ant_main);
-        const gtsam::Rot3 nRe(fgo::utils::nedRe_Matrix(pos_ant_main));
+        const auto antFrame = fgo::utils::geodesy::ecef2Frame(pos_ant_main);
+        const auto &pos_ant_llh = antFrame.llh;
+        const gtsam::Rot3 nRe(antFrame.nedRe());
 
         const auto fgo_pose_std_ned = (gtsam::Vector6() << nRe.rotate(fgo_pose_ecef_std.block<3, 1>(0, 0)), nRe.rotate(
           fgo_pose_ecef_std.block<3, 1>(3, 0))).finished();
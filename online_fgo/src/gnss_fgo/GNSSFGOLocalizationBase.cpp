@@ -17,6 +17,7 @@
 //
 
 #include "gnss_fgo/GNSSFGOLocalizationBase.h"
+#include "utils/AsyncLogger.h"
 
 namespace gnss_fgo {
   bool GNSSFGOLocalizationBase::initializeCommon() {
@@ -27,6 +28,9 @@ namespace gnss_fgo {
     utils::RosParameter<std::string> sensor_param_prefix("GNSSFGO.VehicleParameterPrefix", "GNSSFGO", *this);
     RCLCPP_WARN_STREAM(get_logger(), "VehicleParameterPrefix:" << sensor_param_prefix.value());
     sensorCalibManager_ = std::make_shared<fgo::sensor::SensorCalibrationManager>(*this, sensor_param_prefix.value());
+    imuHandle_ = sensorCalibManager_->registerSensor("imu");
+    referenceHandle_ = sensorCalibManager_->registerSensor("reference");
+    utils::AsyncLogger::instance().configure(*this);
 
     utils::RosParameter<bool> offlineProcess("GNSSFGO.offlineProcess", false, *this);
     paramsPtr_->offlineProcess = offlineProcess.value();
@@ -340,7 +344,7 @@ namespace gnss_fgo {
       std::cout << std::fixed << "init_cbd: " << lastOptimizedState_.cbd << std::endl;
 
       //initialization
-      static const auto reference_trans = sensorCalibManager_->getTransformationFromBase("reference");
+      const auto reference_trans = sensorCalibManager_->getTransformationFromBase(referenceHandle_);
       const auto init_imu_pos = foundPVA.xyz_ecef - foundPVA.rot_ecef.rotate(reference_trans.translation());
       const auto vecGrav = /*init_nedRe * */fgo::utils::gravity_ecef(init_imu_pos);
       const auto gravity_b = foundPVA.rot_ecef.unrotate(vecGrav);
@@ -381,6 +385,9 @@ namespace gnss_fgo {
 
       graph_->initGraph(lastOptimizedState_, initTime.seconds(), preIntegratorParams_);
       lastInitROSTimestamp_ = lastOptimizedState_.timestamp;
+      imuPreintegration_->initialize(preIntegratorParams_, lastOptimizedState_.imuBias, initTime.seconds(),
+                                     1. / paramsPtr_->optFrequency, imuDataBuffer_.get_all_buffer());
+      graph_->setIMUPreintegrationService(imuPreintegration_);
 
       currentPredState_ = lastOptimizedState_;
       fgoPredStateBuffer_.update_buffer(currentPredState_, initTime, this->get_clock()->now());
@@ -405,11 +412,9 @@ namespace gnss_fgo {
   }
 
   void GNSSFGOLocalizationBase::onIMUMsgCb(const sensor_msgs::msg::Imu::ConstSharedPtr &imuMeasurement) {
-    static const auto preRotateIMU = sensorCalibManager_->getPreRotation("imu");
-    static const auto reference_trans = sensorCalibManager_->getTransformationFromBase("reference");
-    static rclcpp::Time lastIMUTime{0, 0, RCL_ROS_TIME};
-    static gtsam::Vector3 lastGyro{};
-    static uint notifyCounter = paramsPtr_->IMUMeasurementFrequency / paramsPtr_->optFrequency;
+    const auto preRotateIMU = sensorCalibManager_->getPreRotation(imuHandle_);
+    const auto reference_trans = sensorCalibManager_->getTransformationFromBase(referenceHandle_);
+    const uint notifyCounter = paramsPtr_->IMUMeasurementFrequency / paramsPtr_->optFrequency;
 
     auto start_time = std::chrono::system_clock::now();
 
@@ -461,23 +466,24 @@ namespace gnss_fgo {
     fgoIMUMeasurement.AHRSOriCov =
       preRotateIMU.matrix() * gtsam::Matrix33(imuMeasurement->orientation_covariance.data());
 
-    if (!lastIMUTime.nanoseconds()) // we got first measurement
+    if (!lastIMUTime_.nanoseconds()) // we got first measurement
     {
       fgoIMUMeasurement.dt = 1. / paramsPtr_->IMUMeasurementFrequency;
       // calculate the angular acceleration
       fgoIMUMeasurement.accRot = gtsam::Vector3();
     } else {
-      fgoIMUMeasurement.dt = fgoIMUMeasurement.timestamp.seconds() - lastIMUTime.seconds();
-      fgoIMUMeasurement.accRot = (fgoIMUMeasurement.gyro - lastGyro) / fgoIMUMeasurement.dt;
+      fgoIMUMeasurement.dt = fgoIMUMeasurement.timestamp.seconds() - lastIMUTime_.seconds();
+      fgoIMUMeasurement.accRot = (fgoIMUMeasurement.gyro - lastGyro_) / fgoIMUMeasurement.dt;
     }
     imuDataBuffer_.update_buffer(fgoIMUMeasurement, fgoIMUMeasurement.timestamp);
+    imuPreintegration_->addMeasurement(fgoIMUMeasurement);
 
     if (!this->isStateInited_) {
-      lastIMUTime = ts;
-      lastGyro = (gtsam::Vector3() << imuMeasurement->angular_velocity.x,
+      lastIMUTime_ = ts;
+      lastGyro_ = (gtsam::Vector3() << imuMeasurement->angular_velocity.x,
         imuMeasurement->angular_velocity.y,
         imuMeasurement->angular_velocity.z).finished();
-      lastGyro = preRotateIMU.rotate(lastGyro);
+      lastGyro_ = preRotateIMU.rotate(lastGyro_);
       if (lastInitFinished_) {
         triggeredInit_ = true;
         conDoInit_.notify_one();
@@ -488,9 +494,8 @@ namespace gnss_fgo {
     if (paramsPtr_->useIMUAsTimeReference) {
       if ((imuDataBuffer_.size() % notifyCounter) == 0) {
         if (lastOptFinished_) {
-          RCLCPP_INFO_STREAM(this->get_logger(),
-                             "onIMU: Notify by IMU with imuBuffer: " << imuDataBuffer_.size() << " and notifycounter: "
-                                                                     << notifyCounter);
+          FGO_LOG_INFO(utils::LogModule::IMU, "onIMU: Notify by IMU", {"imuBuffer", double(imuDataBuffer_.size())},
+                       {"notifyCounter", double(notifyCounter)});
           this->notifyOptimization();
         } else {
           RCLCPP_ERROR(this->get_logger(), "onIMU: last optimization not finished! not triggering new optimization");
@@ -514,16 +519,10 @@ namespace gnss_fgo {
       fgoIMUMeasurement.accLin + gravity_b)).finished();
 
     if (isDoingPropagation_) {
-      currentIMUPreIntMutex_.lock();
-      //preintegrate till time of newest IMU meas| dt is for the future, but we dont know when the next data will arrive
-      currentIMUPreintegrator_->integrateMeasurement(fgoIMUMeasurement.accLin,
-                                                     fgoIMUMeasurement.gyro,
-                                                     fgoIMUMeasurement.dt);
+      // the measurement is already integrated into the shared preintegration, we only chain its segments
       lastOptimizedState_.mutex.lock_shared();
-      const auto new_state = currentIMUPreintegrator_->predict(lastOptimizedState_.state,
-                                                               lastOptimizedState_.imuBias);
+      const auto new_state = imuPreintegration_->predict(lastOptimizedState_.state, lastOptimizedState_.imuBias);
       lastOptimizedState_.mutex.unlock_shared();
-      currentIMUPreIntMutex_.unlock();
       // currentPredState_.timestamp += rclcpp::Duration::from_nanoseconds(fgoIMUMeasurement.dt * fgo::constants::sec2nanosec);
       currentPredState_.state = new_state;
     }
@@ -548,23 +547,25 @@ namespace gnss_fgo {
       calculateErrorOnState(currentPredState_);
     }
 
-    lastIMUTime = fgoIMUMeasurement.timestamp;
-    lastGyro = fgoIMUMeasurement.gyro;
+    lastIMUTime_ = fgoIMUMeasurement.timestamp;
+    lastGyro_ = fgoIMUMeasurement.gyro;
 
     double duration_cb = std::chrono::duration_cast<std::chrono::duration<double>>(
       std::chrono::system_clock::now() - start_time).count();
     if (duration_cb > 0.011) {
-      RCLCPP_WARN_STREAM(this->get_logger(), "onIMUMsgCb: cb takes " << duration_cb << "s, more than expected 0.01s");
+      FGO_LOG_WARN(utils::LogModule::IMU, "onIMUMsgCb: cb takes more than expected 0.01s", {"duration", duration_cb});
     }
   }
 
   void GNSSFGOLocalizationBase::timeCentricFGO() {
     RCLCPP_INFO(this->get_logger(), "Time centric graph optimization started in a different Thread... ");
+    const double betweenOptimizationTime = 1. / paramsPtr_->optFrequency;
+    const uint notifyCounter = paramsPtr_->IMUMeasurementFrequency * betweenOptimizationTime;
+    auto lastNotInitializedTimestamp = std::chrono::system_clock::now();
+    double lastGraphTimestamp = 0;
+    uint64_t numGraphStates = 0;
+    auto firstRun = true;
     while (rclcpp::ok()) {
-      static const double betweenOptimizationTime = 1. / paramsPtr_->optFrequency;
-      static auto lastNotInitializedTimestamp = std::chrono::system_clock::now();
-      static double lastGraphTimestamp = 0;
-      static auto firstRun = true;
 
       if (!this->isStateInited_) {
         lastNotInitializedTimestamp = std::chrono::system_clock::now();
@@ -574,7 +575,7 @@ namespace gnss_fgo {
 
       if (firstRun) {
         lastGraphTimestamp = lastInitROSTimestamp_.seconds();
-        static uint notifyCounter = paramsPtr_->IMUMeasurementFrequency * betweenOptimizationTime;
+        numGraphStates = 0;
         const auto imuSize = imuDataBuffer_.size();
         if (imuSize < notifyCounter) {
           //RCLCPP_WARN_STREAM(this->get_logger(), "onTimer: no sufficient imu data received, current imu size " << imuSize);
@@ -593,8 +594,7 @@ namespace gnss_fgo {
       double timeDiff = currentROSTime.seconds() - lastGraphTimestamp;
 
       if (timeDiff >= betweenOptimizationTime) {
-        RCLCPP_INFO_STREAM(this->get_logger(), "onTimer: notify new optimization after: " << std::fixed << timeDiff
-                                                                                          << " seconds since last notification.");
+        FGO_LOG_INFO(utils::LogModule::GRAPH, "onTimer: notify new optimization", {"sinceLastNotification", timeDiff});
 
         std::chrono::time_point<std::chrono::system_clock> start;
         start = std::chrono::system_clock::now();
@@ -607,17 +607,15 @@ namespace gnss_fgo {
         std::vector<double> newStateTimestamps;
 
         while (timeDiff >= betweenOptimizationTime) {
-          lastGraphTimestamp += betweenOptimizationTime;
-          RCLCPP_WARN_STREAM(this->get_logger(),
-                             "Time-Centric Graph: create state at " << std::fixed << lastGraphTimestamp);
+          // the states are placed on the grid of the IMU preintegration
+          lastGraphTimestamp = lastInitROSTimestamp_.seconds() + double(++numGraphStates) * betweenOptimizationTime;
+          FGO_LOG_INFO(utils::LogModule::GRAPH, "Time-Centric Graph: create state", {"at", lastGraphTimestamp});
           newStateTimestamps.emplace_back(lastGraphTimestamp);
           timeDiff -= betweenOptimizationTime;
         }
 
-        RCLCPP_WARN_STREAM(this->get_logger(),
-                           "Time-Centric Graph: updated new state timestamps, remaining time diff: " << std::fixed
-                                                                                                     << timeDiff);
-        RCLCPP_WARN_STREAM(this->get_logger(), "Time-Centric Graph: current IMU size " << imuData.size());
+        FGO_LOG_INFO(utils::LogModule::GRAPH, "Time-Centric Graph: updated new state timestamps",
+                     {"remainingTimeDiff", timeDiff}, {"imuSize", double(imuData.size())});
 
         const auto constructGraphStatus = graph_->constructFactorGraphOnTime(newStateTimestamps, imuData);
 
@@ -639,7 +637,7 @@ namespace gnss_fgo {
           double timeOpt = this->optimize();
           isDoingPropagation_ = true;
           //double timeOpt = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
-          RCLCPP_INFO_STREAM(this->get_logger(), "Finished  optimization with a duration:" << timeOpt);
+          FGO_LOG_INFO(utils::LogModule::SOLVER, "Finished optimization", {"duration", timeOpt});
           elapsedTimeFGO.header.stamp = this->now();
           elapsedTimeFGO.duration_optimization = timeOpt;
           timerPub_->publish(elapsedTimeFGO);
@@ -663,7 +661,7 @@ namespace gnss_fgo {
       const auto start_fgo_construction = this->now();
       std::vector<fgo::data::IMUMeasurement> imuData = imuDataBuffer_.get_all_buffer_and_clean();
 
-      RCLCPP_WARN_STREAM(this->get_logger(), "Triggered Optimization with " << imuData.size() << " IMU data");
+      FGO_LOG_INFO(utils::LogModule::GRAPH, "Triggered Optimization", {"imuSize", double(imuData.size())});
 
       const auto constructGraphStatus = graph_->constructFactorGraphOnIMU(imuData);
 
@@ -685,7 +683,7 @@ namespace gnss_fgo {
         double timeOpt = this->optimize();
         isDoingPropagation_ = true;
         //double timeOpt = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
-        RCLCPP_INFO_STREAM(this->get_logger(), "Finished  optimization with a duration:" << timeOpt);
+        FGO_LOG_INFO(utils::LogModule::SOLVER, "Finished optimization", {"duration", timeOpt});
         elapsedTimeFGO.header.stamp = this->now();
         elapsedTimeFGO.duration_optimization = timeOpt;
         timerPub_->publish(elapsedTimeFGO);
@@ -698,51 +696,47 @@ namespace gnss_fgo {
   }
 
   double GNSSFGOLocalizationBase::optimize() {
-    static const auto reference_trans = sensorCalibManager_->getTransformationFromBase("reference");
+    const auto reference_trans = sensorCalibManager_->getTransformationFromBase(referenceHandle_);
     fgo::data::State newOptState;
     double optTime = graph_->optimize(newOptState);
+    if (graph_->isDiverged()) {
+      this->handleDivergence();
+      return optTime;
+    }
     fgoOptStateBuffer_.update_buffer(newOptState, newOptState.timestamp);
     auto fgoStateMsg = this->convertFGOStateToMsg(newOptState);
     fgoStateOptPub_->publish(fgoStateMsg);
     fgoStateOptNavFixPub_->publish(
       convertPositionToNavFixMsg(newOptState.state, newOptState.timestamp, reference_trans.translation()));
 
+    // the optimized state and the anchor of the IMU preintegration are switched together for the IMU thread
     lastOptimizedState_.mutex.lock();
     lastOptimizedState_ = newOptState;
+    imuPreintegration_->setAnchor(newOptState.timestamp.seconds(), newOptState.imuBias);
     lastOptimizedState_.mutex.unlock();
 
-    std::vector<fgo::data::IMUMeasurement> dataIMU = imuDataBuffer_.get_all_buffer();
-    auto restIMUData = graph_->getRestIMUData();
-
-    currentIMUPreIntMutex_.lock();
-    // Because the optimization took sometime, after the optimization, we again need to get the imu measurements, which are received while optimizing
     preIntegratorParams_->n_gravity = /*fgo::utils::nedRe_Matrix(lastOptimizedState_.state.position()) * */
       fgo::utils::gravity_ecef(newOptState.state.position());
+    currentIMUPreIntMutex_.lock();
     currentIMUPreintegrator_ = std::make_unique<gtsam::PreintegratedCombinedMeasurements>(preIntegratorParams_,
                                                                                           newOptState.imuBias);
-    //first measurement only needs to be integrated from state to next meas
-    double dt = 0.0;
-    for (const auto &meas_imu: dataIMU) {
-      currentIMUPreintegrator_->integrateMeasurement(meas_imu.accLin,
-                                                     meas_imu.gyro,
-                                                     meas_imu.dt);
-
-      //std::cout << "Intergrated IMU: " << std::fixed << meas_imu.timestamp.seconds() << std::endl;
-      dt += meas_imu.dt;
-    }
-    auto currentState = currentIMUPreintegrator_->predict(newOptState.state, newOptState.imuBias);
     currentIMUPreIntMutex_.unlock();
+
+    // Because the optimization took sometime, the imu measurements received while optimizing are already
+    // preintegrated after the optimized state
+    const auto lastIMU = imuPreintegration_->lastMeasurement();
+    auto currentState = imuPreintegration_->predict(newOptState.state, newOptState.imuBias);
     //refresh state
 
     currentPredState_.mutex.lock();
-    currentPredState_.timestamp =
-      newOptState.timestamp + rclcpp::Duration::from_nanoseconds(dt * fgo::constants::sec2nanosec);
+    currentPredState_.timestamp = lastIMU && lastIMU->timestamp > newOptState.timestamp ? lastIMU->timestamp
+                                                                                       : newOptState.timestamp;
     //std::cout << "current state after opt: " << newOptState.timestamp.seconds() << newOptState.state << std::endl;
     //std::cout << "current state after opt updated: " << currentPredState_.timestamp.seconds() << currentState << std::endl;
     currentPredState_.state = currentState;
     if (paramsPtr_->addGPPriorFactor || paramsPtr_->addGPInterpolatedFactor) {
-      if (!dataIMU.empty()) {
-        currentPredState_.omega = newOptState.imuBias.correctGyroscope(dataIMU.back().gyro);
+      if (lastIMU) {
+        currentPredState_.omega = newOptState.imuBias.correctGyroscope(lastIMU->gyro);
       } else
         currentPredState_.omega = newOptState.omega;
       currentPredState_.omegaVar = newOptState.omegaVar;
@@ -764,9 +758,15 @@ namespace gnss_fgo {
     return optTime;
   }
 
+  void GNSSFGOLocalizationBase::handleDivergence() {
+    RCLCPP_ERROR(this->get_logger(), "FGO diverged! Resetting the graph and re-initializing ...");
+    isStateInited_ = false;
+    graph_->reset();
+  }
+
   void GNSSFGOLocalizationBase::calculateErrorOnState(const fgo::data::State &stateIn) {
-    static const auto reference_trans = sensorCalibManager_->getTransformationFromBase("reference");
-    static std::vector<fgo::data::State> stateCached;
+    const auto reference_trans = sensorCalibManager_->getTransformationFromBase("reference");
+    auto &stateCached = errorStateCache_;
 
     //auto labelBuffer = gnssLabelingMsgBuffer_.get_all_buffer();
 
@@ -774,8 +774,17 @@ namespace gnss_fgo {
     const auto lastPVTTime = pvaBuffer.back().timestamp.seconds();
     stateCached.emplace_back(stateIn);
 
+    // convert the antenna positions of all cached states in one batch
+    Eigen::Matrix3Xd posAntECEF(3, stateCached.size());
+    Eigen::Index stateIndex = 0;
+    for (const auto &state: stateCached)
+      posAntECEF.col(stateIndex++) = state.state.position() + state.state.attitude().rotate(reference_trans.translation());
+    const auto antFrames = fgo::utils::geodesy::ecef2FrameBatch(posAntECEF);
+
+    stateIndex = 0;
     auto stateIter = stateCached.begin();
     while (stateIter != stateCached.end()) {
+      const auto thisStateIndex = stateIndex++;
       double stateTime = stateIter->timestamp.seconds();
       auto stateTimeNanoSec = stateIter->timestamp.nanoseconds();
       if (stateTime < lastPVTTime) {
@@ -837,9 +846,10 @@ namespace gnss_fgo {
         const auto fgo_cbd_std = stateIter->cbdVar.diagonal().cwiseSqrt();
         const auto fgo_bias_std = stateIter->imuBiasVar.diagonal().cwiseSqrt();
 
-        const auto pos_ant_main_ecef = fgo_pos_ecef + fgo_ori_ecef.rotate(reference_trans.translation());
-        const auto pos_ant_llh = fgo::utils::xyz2llh(pos_ant_main_ecef);
-        const gtsam::Rot3 nRe(fgo::utils::nedRe_Matrix(pos_ant_main_ecef));
+        const gtsam::Point3 pos_ant_main_ecef = posAntECEF.col(thisStateIndex);
+        const auto antFrame = antFrames.frame(thisStateIndex);
+        const auto &pos_ant_llh = antFrame.llh;
+        const gtsam::Rot3 nRe(antFrame.nedRe());
         const auto fgo_pose_std_ned = (gtsam::Vector6() << nRe.rotate(fgo_pose_ecef_std.block<3, 1>(0, 0)), nRe.rotate(
           fgo_pose_ecef_std.block<3, 1>(3, 0))).finished();
         const auto fgo_vel_ned = nRe.rotate(
@@ -852,8 +862,9 @@ namespace gnss_fgo {
         const auto fgo_pitch = nRb_rpy(1) * 180. / M_PI;
         const auto fgo_roll = nRb_rpy(0) * 180. / M_PI;
 
-        const auto ref_pos_ecef = fgo::utils::llh2xyz(ref_pos_llh);
-        const gtsam::Rot3 nReGT(fgo::utils::nedRe_Matrix_asLLH(ref_pos_llh));
+        const auto refFrame = fgo::utils::geodesy::llh2Frame(ref_pos_llh);
+        const auto ref_pos_ecef = fgo::utils::geodesy::frame2ECEF(refFrame);
+        const gtsam::Rot3 nReGT(refFrame.nedRe());
 
         fgo::utils::eigenMatrix2stdVector(ref_pos_llh, error2Gt.ref_llh);
         fgo::utils::eigenMatrix2stdVector(ref_pos_llh_std, error2Gt.ref_llh_std);
@@ -925,6 +936,7 @@ namespace gnss_fgo {
         error2Gt.ref_pitch_roll_std = sqrt(itAfter->roll_pitch_var);
         error2Gt.header.stamp = stateIter->timestamp;
         pvtErrorPub_->publish(error2Gt);
+        this->onErrorToReference(error2Gt);
 
         stateIter = stateCached.erase(stateIter);
         continue;
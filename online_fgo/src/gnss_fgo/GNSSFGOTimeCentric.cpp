@@ -87,9 +87,6 @@ namespace gnss_fgo {
     void GNSSFGOTimeCentricNode::onPVAMsgCb(const irt_nav_msgs::msg::PVAGeodetic::ConstSharedPtr pvaMsg)
     {
         auto thisPVATime = rclcpp::Time(pvaMsg->header.stamp.sec, pvaMsg->header.stamp.nanosec, RCL_ROS_TIME);
-        static double lastDelay = 0.;
-        static auto lastPVATime = thisPVATime;
-        static bool first_measurement = true;
         sensor_msgs::msg::NavSatFix pvtNavMsg;
         pvtNavMsg.header.stamp = thisPVATime;
         pvtNavMsg.latitude = pvaMsg->phi_geo * fgo::constants::rad2deg;
@@ -144,17 +141,17 @@ namespace gnss_fgo {
         //rclcpp::sleep_for(std::chrono::nanoseconds(1000000));  // 10000000
         auto pvaDelay = this->PVTDelayCalculator_->getDelay()  + paramsPtr_->pvtMeasTimeOffset;
 
-        auto delayFromMsg = (thisPVATime - lastPVATime).seconds() - 0.1;
+        auto delayFromMsg = (thisPVATime - lastPVATime_).seconds() - 0.1;
 
-        if(first_measurement)
+        if(firstPVAMeasurement_)
         {
-            first_measurement = false;
+            firstPVAMeasurement_ = false;
             delayFromMsg = 0.;
             pvaDelay = 0.;
         }
 
-        if (delayFromMsg < -0.005 && lastDelay > 0)
-            delayFromMsg += lastDelay;
+        if (delayFromMsg < -0.005 && lastPVADelay_ > 0)
+            delayFromMsg += lastPVADelay_;
 
         if (delayFromMsg < 0.)
             delayFromMsg = 0.;
@@ -174,10 +171,10 @@ namespace gnss_fgo {
         referenceBuffer_.update_buffer(pva, pvaTime);
 
         if(abs(delayFromMsg) < 0.005 || delayFromMsg > 0.3)
-            lastDelay = 0.;
+            lastPVADelay_ = 0.;
         else
-            lastDelay = delayFromMsg;
-        lastPVATime = thisPVATime;
+            lastPVADelay_ = delayFromMsg;
+        lastPVATime_ = thisPVATime;
     }
 
 
@@ -20,8 +20,9 @@
 #include "graph/GraphBase.h"
 #include "integrator/IntegratorBase.h"
 #include "gnss_fgo/GNSSFGOLocalizationBase.h"
-#include "data/sampling/UncentedSampler.h"
 #include "utils/AlgorithmicUtils.h"
+#include "factor/uwb/UWBRangeFactor.h"
+#include "factor/uwb/GPInterpolatedUWBRangeFactor.h"
 
 namespace fgo::graph {
   using namespace std::chrono_literals;
@@ -213,7 +214,10 @@ namespace fgo::graph {
       std::cout << "#################################################################" << std::endl;
     } else if (graphBaseParamPtr_->gpType == fgo::data::GPModelType::Singer) {
 
-      // ToDo @ Zirui, please try to read the Ad matrix for configuration and make a screening here
+      RosParameter<std::vector<double>> adGPSinger("GNSSFGO.Optimizer.adGPSinger", std::vector<double>(6, 1.), node);
+      graphBaseParamPtr_->ad = gtsam::Vector6(adGPSinger.value().data()).asDiagonal();
+      RCLCPP_INFO_STREAM(appPtr_->get_logger(), "adGPSinger:" << graphBaseParamPtr_->ad.diagonal());
+
       RosParameter<std::vector<double>> QcGPMotionPriorFull("GNSSFGO.Optimizer.QcGPSingerMotionPriorFull", node);
       graphBaseParamPtr_->QcGPMotionPriorFull = gtsam::Vector6(QcGPMotionPriorFull.value().data());
       RCLCPP_INFO_STREAM(appPtr_->get_logger(), "QcGPSingerMotionPrior:" << graphBaseParamPtr_->QcGPMotionPriorFull);
@@ -452,6 +456,17 @@ namespace fgo::graph {
                             factor);
                           break;
                         }
+                        case fgo::factor::FactorTypeID::UWBRange: {
+                          sampleResiduals = true;
+                          thisFactorCasted = boost::dynamic_pointer_cast<fgo::factor::UWBRangeFactor>(factor);
+                          break;
+                        }
+                        case fgo::factor::FactorTypeID::GPUWBRange: {
+                          sampleResiduals = true;
+                          thisFactorCasted = boost::dynamic_pointer_cast<fgo::factor::GPInterpolatedUWBRangeFactor>(
+                            factor);
+                          break;
+                        }
                         case fgo::factor::FactorTypeID::NavAttitude: {
                           thisFactorCasted = boost::dynamic_pointer_cast<fgo::factor::NavAttitudeFactor>(factor);
                           break;
@@ -527,11 +542,12 @@ namespace fgo::graph {
                             keyIndicesAfterSorting);
                           // and use this matrix to create a noise model. When using the noise model, the information matrix has been already trangularized using e.g., cholesky
                           const auto mean = thisFactorCasted->liftValuesAsVector(values);
-                          auto sampleParam = std::make_shared<fgo::data::sampler::SamplerConfig>();
-                          auto residualSampler = boost::make_shared<fgo::data::sampler::UnscentedSampler>(sampleParam,
-                                                                                                          mean,
-                                                                                                          jointCovNotOrdered);
-                          const auto sigma_points = residualSampler->samples();
+                          auto &sigmaGenerator = residualSigmaPoints_[mean.size()];
+                          if (!sigmaGenerator)
+                            sigmaGenerator = fgo::data::sampler::createSigmaPoints(
+                              fgo::data::sampler::SamplerConfig(), mean.size());
+                          auto &sigma_points = residualSigmaPointBuffer_;
+                          sigmaGenerator->sigma_points(mean, jointCovNotOrdered, sigma_points);
 
                           for (size_t i = 0; i < sigma_points.rows(); i++) {
                             irt_nav_msgs::msg::ResidualSample sample;
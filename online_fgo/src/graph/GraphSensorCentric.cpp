@@ -33,13 +33,6 @@ namespace fgo::graph
 
     StatusGraphConstruction GraphSensorCentric::constructFactorGraphOnIMU(std::vector<fgo::data::IMUMeasurement> &dataIMU) {
 
-        static boost::circular_buffer<std::pair<double, gtsam::Vector3>> timeGyroMap(20 * graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency);
-        static boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> stateIDAccMap(50 * graphBaseParamPtr_->smootherLag * graphBaseParamPtr_->optFrequency);
-        static gtsam::Vector6 lastAcc = gtsam::Vector6::Zero();
-        static gtsam::Vector3 meanAccA, meanAccG = gtsam::Vector3();
-        static uint64_t lastNState = 0;
-        static bool skippedOpt = false;
-
         if (!dataIMURest_.empty()) {
             dataIMU.insert(dataIMU.begin(),dataIMURest_.begin(),dataIMURest_.end());
             dataIMURest_.clear();
@@ -91,8 +84,8 @@ namespace fgo::graph
                                                                     imu_meas_iter->gyro,
                                                                     imu_meas_iter->dt);
                         sum_imu_dt += imu_meas_iter->dt;
-                        timeGyroMap.push_back(std::pair<double, gtsam::Vector3>(imu_meas_iter->timestamp.seconds(), imu_meas_iter->gyro));
-                        meanAccG += imu_meas_iter->accRot;
+                        timeGyroMap_.push_back(std::pair<double, gtsam::Vector3>(imu_meas_iter->timestamp.seconds(), imu_meas_iter->gyro));
+                        meanAccG_ += imu_meas_iter->accRot;
                         imu_meas_iter = dataIMU.erase(imu_meas_iter);
                     } else
                     {
@@ -111,9 +104,9 @@ namespace fgo::graph
                         currentPredState.imuBias.correctAccelerometer(imu_tmp.accLin + gravity_b)).finished();
 
                 //const auto stateAccPair = std::make_pair(nState_, currentAcc);
-                stateIDAccMap.push_back(std::make_pair(nState_, currentAcc));
+                stateIDAccMap_.push_back(std::make_pair(nState_, currentAcc));
                 accBuffer_.update_buffer(currentAcc, imu_tmp.timestamp);
-                meanAccG.setZero();
+                meanAccG_.setZero();
 
                 pose_key_j  = X(id);
                 vel_key_j   = V(id);
@@ -164,8 +157,8 @@ namespace fgo::graph
                 if (paramPtr_->addGPPriorFactor) {
                     if(paramPtr_->gpType == data::GPModelType::WNOJ) {
                         this->addGPMotionPrior(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j, sum_imu_dt,
-                                               lastAcc, currentAcc);
-                        lastAcc = currentAcc;
+                                               lastAcc_, currentAcc);
+                        lastAcc_ = currentAcc;
                     }
                     else
                         this->addGPMotionPrior(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j, sum_imu_dt);
@@ -197,8 +190,8 @@ namespace fgo::graph
 
             RCLCPP_INFO_STREAM(appPtr_->get_logger(), "GraphTimeCentric: starting integrating measurement from " << sensor.first);
 
-            integrationSuccessfully &= sensor.second->addFactors(timeGyroMap,
-                                                                 stateIDAccMap,
+            integrationSuccessfully &= sensor.second->addFactors(timeGyroMap_,
+                                                                 stateIDAccMap_,
                                                                  currentKeyIndexTimestampMap_,
                                                                  statePair,
                                                                  values_,
@@ -19,9 +19,13 @@
 
 #include "graph/GraphTimeCentric.h"
 #include "gnss_fgo/GNSSFGOLocalizationBase.h"
+#include "utils/AsyncLogger.h"
 
 
 namespace fgo::graph {
+  using fgo::utils::LogLevel;
+  using fgo::utils::LogModule;
+
   GraphTimeCentric::GraphTimeCentric(gnss_fgo::GNSSFGOLocalizationBase &node) : GraphBase(node) {
     RCLCPP_INFO(appPtr_->get_logger(), "---------------------  GraphTimeCentric initializing! --------------------- ");
     paramPtr_ = std::make_shared<GraphTimeCentricParam>(graphBaseParamPtr_);
@@ -30,20 +34,27 @@ namespace fgo::graph {
       "sensor_processing_report/imu",
       rclcpp::SystemDefaultsQoS());
 
+    timeGyroMap_.set_capacity(20 * graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency);
+    stateIDAccMap_.set_capacity(50 * graphBaseParamPtr_->smootherLag * graphBaseParamPtr_->optFrequency);
+
     RCLCPP_INFO(appPtr_->get_logger(), "--------------------- GraphTimeCentric initialized! ---------------------");
   }
 
+  void GraphTimeCentric::reset() {
+    GraphBase::reset();
+    timeGyroMap_.clear();
+    stateIDAccMap_.clear();
+    lastAcc_.setZero();
+    meanAccG_.setZero();
+    lastNState_ = 0;
+    skippedOpt_ = false;
+    noOptimizationDuration_ = 0.;
+    firstNoOptimizationDecision_ = rclcpp::Time();
+  }
+
   StatusGraphConstruction GraphTimeCentric::constructFactorGraphOnIMU(std::vector<fgo::data::IMUMeasurement> &dataIMU) {
     // example: imu on 100Hz and we optimize on 10 Hz, then we should count 10 imu measurements
-    static uint notifyCounter = graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency;
-    static boost::circular_buffer<std::pair<double, gtsam::Vector3>> timeGyroMap(
-      20 * graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency);
-    static boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> stateIDAccMap(
-      50 * graphBaseParamPtr_->smootherLag * graphBaseParamPtr_->optFrequency);
-    static gtsam::Vector6 lastAcc = gtsam::Vector6::Zero();
-    static gtsam::Vector3 meanAccA, meanAccG = gtsam::Vector3();
-    static uint64_t lastNState = 0;
-    static bool skippedOpt = false;
+    const uint notifyCounter = graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency;
 
     gtsam::Key pose_key_j, vel_key_j, bias_key_j, cbd_key_j, omega_key_j, acc_key_j,
       pose_key_i, vel_key_i, bias_key_i, cbd_key_i, omega_key_i, acc_key_i;
@@ -66,23 +77,21 @@ namespace fgo::graph {
       }
     }
 
-    static double noOptimizationDuration = 0.;
-    static rclcpp::Time firstNoOptimizationDecision;
-    if (paramPtr_->NoOptimizationNearZeroVelocity && (nState_ - lastNState) > paramPtr_->NoOptimizationAfterStates) {
+    if (paramPtr_->NoOptimizationNearZeroVelocity && (nState_ - lastNState_) > paramPtr_->NoOptimizationAfterStates) {
       if (voteZeroVelocity / integratorMap_.size() > paramPtr_->VoteNearZeroVelocity) {
         RCLCPP_ERROR_STREAM(appPtr_->get_logger(),
                             "Near zero velocity with " << voteZeroVelocity << " integrator of " << integratorMap_.size()
                                                        << " not optimizing...");
 
-        if (!skippedOpt)
-          firstNoOptimizationDecision = appPtr_->now();
-        noOptimizationDuration = (appPtr_->now() - firstNoOptimizationDecision).seconds();
+        if (!skippedOpt_)
+          firstNoOptimizationDecision_ = appPtr_->now();
+        noOptimizationDuration_ = (appPtr_->now() - firstNoOptimizationDecision_).seconds();
         for (const auto &integrator: integratorMap_) {
           integrator.second->cleanBuffers();
         }
-        RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "Near zero velocity duration " << noOptimizationDuration);
+        RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "Near zero velocity duration " << noOptimizationDuration_);
 
-        skippedOpt = true;
+        skippedOpt_ = true;
         solver_->setNotMarginalizing();
         return StatusGraphConstruction::NO_OPTIMIZATION;
       }
@@ -90,16 +99,16 @@ namespace fgo::graph {
 
     auto currentPredState = currentPredictedBuffer_.get_last_buffer(); //graph::querryCurrentPredictedState(timePredStates, currentStateTimestamp);
 
-    if (skippedOpt) {
-      skippedOpt = false;
-      lastNState = nState_;
-      solver_->setSmootherLagInflation(noOptimizationDuration);
+    if (skippedOpt_) {
+      skippedOpt_ = false;
+      lastNState_ = nState_;
+      solver_->setSmootherLagInflation(noOptimizationDuration_);
 
       //solver_->setMarginalizing();
       for (const auto &integrator: integratorMap_) {
-        integrator.second->notifyOptimization(noOptimizationDuration);
+        integrator.second->notifyOptimization(noOptimizationDuration_);
       }
-      noOptimizationDuration = 0.;
+      noOptimizationDuration_ = 0.;
     }
 
     if (paramPtr_->NoOptimizationWhileNoMeasurement && !hasMeasurements &&
@@ -140,13 +149,13 @@ namespace fgo::graph {
       auto current_imu_meas = dataIMU[i];
       sum_imu_dt += current_imu_meas.dt;
       counter_imu++;
-      timeGyroMap.push_back(std::make_pair(current_imu_meas.timestamp.seconds(), current_imu_meas.gyro));
-      //timeGyroMap[current_imu_meas.timestamp.seconds()] = current_imu_meas.gyro;
+      timeGyroMap_.push_back(std::make_pair(current_imu_meas.timestamp.seconds(), current_imu_meas.gyro));
+      //timeGyroMap_[current_imu_meas.timestamp.seconds()] = current_imu_meas.gyro;
       imuPreIntegrationOPT_->integrateMeasurement(current_imu_meas.accLin,
                                                   current_imu_meas.gyro,
                                                   current_imu_meas.dt);
       //meanAccA += current_imu_meas.accLin;
-      meanAccG += current_imu_meas.accRot;
+      meanAccG_ += current_imu_meas.accRot;
       if (((i + 1) % notifyCounter) == 0) {
         // TODO: @haoming if this condition could be run several times, the currentPredState maybe outdated!
         // TODO: @haoming better way to do so is query the currentPredState instead of feeding the whole last data!
@@ -166,7 +175,7 @@ namespace fgo::graph {
         omega_key_i = W(nState_ - 1);
         acc_key_i = A(nState_ - 1);
 
-        meanAccG /= notifyCounter;
+        meanAccG_ /= notifyCounter;
         //meanAccA /= notifyCounter;
 
         currentPredState = currentPredictedBuffer_.get_last_buffer(); //graph::querryCurrentPredictedState(timePredStates, currentStateTimestamp);
@@ -181,9 +190,9 @@ namespace fgo::graph {
         auto currentAcc = (gtsam::Vector6() << current_imu_meas.accRot,
           currentPredState.imuBias.correctAccelerometer(current_imu_meas.accLin + gravity_b)).finished();
         //const auto stateAccPair = std::make_pair(nState_, currentAcc);
-        stateIDAccMap.push_back(std::make_pair(nState_, currentAcc));
+        stateIDAccMap_.push_back(std::make_pair(nState_, currentAcc));
         accBuffer_.update_buffer(currentAcc, current_imu_meas.timestamp);
-        meanAccG.setZero();
+        meanAccG_.setZero();
         //meanAccA.setZero();
 
         RCLCPP_INFO_STREAM(appPtr_->get_logger(), "FGConIMU: creating state variable " << nState_
@@ -244,12 +253,11 @@ namespace fgo::graph {
 
         //GP prior
         if (paramPtr_->addGPPriorFactor) {
-          gtsam::Matrix6 ad = gtsam::Matrix6::Identity();
           this->addGPMotionPrior(
             pose_key_i, vel_key_i, omega_key_i, acc_key_i,
             pose_key_j, vel_key_j, omega_key_j, acc_key_j, sum_imu_dt,
-            lastAcc, currentAcc, ad);
-          lastAcc = currentAcc;
+            lastAcc_, currentAcc, paramPtr_->ad);
+          lastAcc_ = currentAcc;
         }
 
         if (paramPtr_->gpType == WNOJFull || paramPtr_->gpType == SingerFull || paramPtr_->addConstantAccelerationFactor) {
@@ -278,20 +286,19 @@ namespace fgo::graph {
 
     auto statePair = currentPredictedBuffer_.get_all_time_buffer_pair();
     for (const auto &integrator: integratorMap_) {
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: starting integrating measurement from " << integrator.first);
+      FGO_LOG_TAGGED(LogModule::GRAPH, LogLevel::INFO, "GraphTimeCentric: starting integrating measurement",
+                     integrator.first);
 
-      integrationSuccessfully &= integrator.second->addFactors(timeGyroMap,
-                                                               stateIDAccMap,
+      integrationSuccessfully &= integrator.second->addFactors(timeGyroMap_,
+                                                               stateIDAccMap_,
                                                                currentKeyIndexTimestampMap_,
                                                                statePair,
                                                                values_,
                                                                keyTimestampMap_,
                                                                relatedKeys_);
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: integrating measurement from " << integrator.first << " was "
-                                                                           << (integrationSuccessfully ? "successful"
-                                                                                                       : "failed!"));
+      FGO_LOG_TAGGED(LogModule::GRAPH, integrationSuccessfully ? LogLevel::INFO : LogLevel::ERROR,
+                     "GraphTimeCentric: integrated measurement", integrator.first,
+                     {"successful", double(integrationSuccessfully)});
     }
 
     if (paramPtr_->verbose)
@@ -306,15 +313,7 @@ namespace fgo::graph {
   StatusGraphConstruction GraphTimeCentric::constructFactorGraphOnTime(const vector<double> &stateTimestamps,
                                                                        std::vector<fgo::data::IMUMeasurement> &dataIMU) {
     // example: imu on 100Hz and we optimize on 10 Hz, then we should count 10 imu measurements
-    static const double betweenOptimizationTime = 1. / paramPtr_->optFrequency;
-    static boost::circular_buffer<std::pair<double, gtsam::Vector3>> timeGyroMap(
-      20 * graphBaseParamPtr_->IMUMeasurementFrequency / graphBaseParamPtr_->optFrequency);
-    static boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> stateIDAccMap(
-      50 * graphBaseParamPtr_->smootherLag * graphBaseParamPtr_->optFrequency);
-    static gtsam::Vector6 lastAcc = gtsam::Vector6::Zero();
-    static gtsam::Vector3 meanAccA, meanAccG = gtsam::Vector3();
-    static uint64_t lastNState = 0;
-    static bool skippedOpt = false;
+    const double betweenOptimizationTime = 1. / paramPtr_->optFrequency;
 
     gtsam::Key pose_key_j, vel_key_j, bias_key_j, cbd_key_j, omega_key_j, acc_key_j,
       pose_key_i, vel_key_i, bias_key_i, cbd_key_i, omega_key_i, acc_key_i;
@@ -331,9 +330,7 @@ namespace fgo::graph {
       }
     }
 
-    static double noOptimizationDuration = 0.;
-    static rclcpp::Time firstNoOptimizationDecision;
-    if (paramPtr_->NoOptimizationNearZeroVelocity && (nState_ - lastNState) > paramPtr_->NoOptimizationAfterStates) {
+    if (paramPtr_->NoOptimizationNearZeroVelocity && (nState_ - lastNState_) > paramPtr_->NoOptimizationAfterStates) {
       if (voteZeroVelocity / integratorMap_.size() > paramPtr_->VoteNearZeroVelocity) {
         RCLCPP_ERROR_STREAM(appPtr_->get_logger(),
                             "constructFactorGraphOnTime: Near zero velocity with " << voteZeroVelocity
@@ -341,16 +338,16 @@ namespace fgo::graph {
                                                                                    << integratorMap_.size()
                                                                                    << " not optimizing...");
 
-        if (!skippedOpt)
-          firstNoOptimizationDecision = appPtr_->now();
-        noOptimizationDuration = (appPtr_->now() - firstNoOptimizationDecision).seconds();
+        if (!skippedOpt_)
+          firstNoOptimizationDecision_ = appPtr_->now();
+        noOptimizationDuration_ = (appPtr_->now() - firstNoOptimizationDecision_).seconds();
         for (const auto &integrator: integratorMap_) {
           integrator.second->cleanBuffers();
         }
         RCLCPP_ERROR_STREAM(appPtr_->get_logger(),
-                            "constructFactorGraphOnTime: Near zero velocity duration " << noOptimizationDuration);
+                            "constructFactorGraphOnTime: Near zero velocity duration " << noOptimizationDuration_);
 
-        skippedOpt = true;
+        skippedOpt_ = true;
         solver_->setNotMarginalizing();
         return StatusGraphConstruction::NO_OPTIMIZATION;
       }
@@ -358,16 +355,16 @@ namespace fgo::graph {
 
     auto currentPredState = currentPredictedBuffer_.get_last_buffer(); //graph::queryCurrentPredictedState(timePredStates, currentStateTimestamp);
 
-    if (skippedOpt) {
-      skippedOpt = false;
-      lastNState = nState_;
-      solver_->setSmootherLagInflation(noOptimizationDuration);
+    if (skippedOpt_) {
+      skippedOpt_ = false;
+      lastNState_ = nState_;
+      solver_->setSmootherLagInflation(noOptimizationDuration_);
 
       //solver_->setMarginalizing();
       for (const auto &integrator: integratorMap_) {
-        integrator.second->notifyOptimization(noOptimizationDuration);
+        integrator.second->notifyOptimization(noOptimizationDuration_);
       }
-      noOptimizationDuration = 0.;
+      noOptimizationDuration_ = 0.;
     }
 
     if (paramPtr_->NoOptimizationWhileNoMeasurement && !hasMeasurements &&
@@ -404,20 +401,28 @@ namespace fgo::graph {
       omega_key_i = W(nState_ - 1);
       acc_key_i = A(nState_ - 1);
 
+      // the segment between two states is usually preintegrated already by the shared IMU preintegration
+      const auto lastStateTimestampIter = currentKeyIndexTimestampMap_.find(nState_ - 1);
+      const bool hasPreintegratedSegment = imuPreintegration_ &&
+                                           lastStateTimestampIter != currentKeyIndexTimestampMap_.end() &&
+                                           imuPreintegration_->getSegment(lastStateTimestampIter->second, ts,
+                                                                          *imuPreIntegrationOPT_);
+
       double imuCounter = 0;
       auto currentIMU = dataIMU.back();
       while (imuIter != dataIMU.end() && imuIter->timestamp.seconds() < ts) {
         currentIMU = *imuIter;
-        timeGyroMap.push_back(std::make_pair(currentIMU.timestamp.seconds(), currentIMU.gyro));
-        imuPreIntegrationOPT_->integrateMeasurement(currentIMU.accLin,
-                                                    currentIMU.gyro,
-                                                    currentIMU.dt);
-        meanAccG += currentIMU.accRot;
+        timeGyroMap_.push_back(std::make_pair(currentIMU.timestamp.seconds(), currentIMU.gyro));
+        if (!hasPreintegratedSegment)
+          imuPreIntegrationOPT_->integrateMeasurement(currentIMU.accLin,
+                                                      currentIMU.gyro,
+                                                      currentIMU.dt);
+        meanAccG_ += currentIMU.accRot;
         imuCounter += 1.;
         imuIter = dataIMU.erase(imuIter);
       }
 
-      meanAccG /= imuCounter;
+      meanAccG_ /= imuCounter;
       //meanAccA /= notifyCounter;
 
       currentPredState = graph::queryCurrentPredictedState(currentPredictedBuffer_.get_all_time_buffer_pair(), ts);
@@ -431,19 +436,14 @@ namespace fgo::graph {
       auto currentAcc = (gtsam::Vector6() << currentIMU.accRot,
         currentPredState.imuBias.correctAccelerometer(currentIMU.accLin + gravity_b)).finished();
       //const auto stateAccPair = std::make_pair(nState_, currentAcc);
-      stateIDAccMap.push_back(std::make_pair(nState_, currentAcc));
+      stateIDAccMap_.push_back(std::make_pair(nState_, currentAcc));
       accBuffer_.update_buffer(currentAcc, currentIMU.timestamp);
-      meanAccG.setZero();
+      meanAccG_.setZero();
       //meanAccA.setZero();
 
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(), "constructFactorGraphOnTime:  creating state variable " << nState_
-                                                                                                        << " at: "
-                                                                                                        << std::fixed
-                                                                                                        << ts
-                                                                                                        << " current IMU time "
-                                                                                                        << currentIMU.timestamp.seconds()
-                                                                                                        << " queried predicted state at "
-                                                                                                        << currentPredState.timestamp.seconds());
+      FGO_LOG_INFO(LogModule::GRAPH, "constructFactorGraphOnTime: creating state variable",
+                   {"state", double(nState_)}, {"at", ts}, {"currentIMUTime", currentIMU.timestamp.seconds()},
+                   {"predictedStateTime", currentPredState.timestamp.seconds()});
 
       currentKeyIndexTimestampMap_.insert(std::make_pair(nState_, ts));
       // auto predictedState = imuPreIntegrationOPTTmp_->predict(current_pred_state.state, current_pred_state.imuBias);
@@ -491,20 +491,18 @@ namespace fgo::graph {
 
       //const vel prior factor
       if (paramPtr_->useMMFactor) {
-        RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                           "constructFactorGraphOnTime:  state variable " << nState_ << " with MM factor.");
+        FGO_LOG_INFO(LogModule::GRAPH, "constructFactorGraphOnTime: state variable with MM factor",
+                     {"state", double(nState_)});
         this->addMotionModelFactor(pose_key_i, vel_key_i, pose_key_j, vel_key_j, betweenOptimizationTime);
       }
 
       //GP prior
       if (paramPtr_->addGPPriorFactor) {
-        //ToDo @zirui,
-        gtsam::Matrix6 ad = gtsam::Matrix6::Identity();
         this->addGPMotionPrior(
           pose_key_i, vel_key_i, omega_key_i, acc_key_i,
           pose_key_j, vel_key_j, omega_key_j, acc_key_j, betweenOptimizationTime,
-          lastAcc, currentAcc, ad);
-        lastAcc = currentAcc;
+          lastAcc_, currentAcc, paramPtr_->ad);
+        lastAcc_ = currentAcc;
       }
 
       if (paramPtr_->gpType == WNOJFull || paramPtr_->gpType == SingerFull || paramPtr_->addConstantAccelerationFactor) {
@@ -524,8 +522,8 @@ namespace fgo::graph {
     // if there are still imu measurements left over, we back them up
 
     if (!dataIMU.empty()) {
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(), "constructFactorGraphOnTime: " << dataIMU.size()
-                                                                               << " imu measurements are left. Backing up...");
+      FGO_LOG_INFO(LogModule::GRAPH, "constructFactorGraphOnTime: backing up left imu measurements",
+                   {"numIMU", double(dataIMU.size())});
       dataIMURest_.resize(dataIMU.size());
       std::copy(dataIMU.begin(), dataIMU.end(), dataIMURest_.begin());
     }
@@ -538,20 +536,19 @@ namespace fgo::graph {
 
     auto statePair = currentPredictedBuffer_.get_all_time_buffer_pair();
     for (const auto &integrator: integratorMap_) {
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: starting integrating measurement from " << integrator.first);
+      FGO_LOG_TAGGED(LogModule::GRAPH, LogLevel::INFO, "GraphTimeCentric: starting integrating measurement",
+                     integrator.first);
 
-      integrationSuccessfully &= integrator.second->addFactors(timeGyroMap,
-                                                               stateIDAccMap,
+      integrationSuccessfully &= integrator.second->addFactors(timeGyroMap_,
+                                                               stateIDAccMap_,
                                                                currentKeyIndexTimestampMap_,
                                                                statePair,
                                                                values_,
                                                                keyTimestampMap_,
                                                                relatedKeys_);
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: integrating measurement from " << integrator.first << " was "
-                                                                           << (integrationSuccessfully ? "successful"
-                                                                                                       : "failed!"));
+      FGO_LOG_TAGGED(LogModule::GRAPH, integrationSuccessfully ? LogLevel::INFO : LogLevel::ERROR,
+                     "GraphTimeCentric: integrated measurement", integrator.first,
+                     {"successful", double(integrationSuccessfully)});
     }
 
     if (paramPtr_->verbose)
@@ -569,8 +566,22 @@ namespace fgo::graph {
     // this function is then stand alone and independent of threading organization
     std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
 
-    solver_->update(*this, values_, keyTimestampMap_, gtsam::FactorIndices(), relatedKeys_);
-    gtsam::Values result = solver_->calculateEstimate();
+    if (fullBatchSmoother_)
+      fullBatchSmoother_->record(*this, values_, keyTimestampMap_);
+    gtsam::Values result;
+    try {
+      solver_->update(*this, values_, keyTimestampMap_, gtsam::FactorIndices(), relatedKeys_);
+      result = solver_->calculateEstimate();
+    }
+    catch (std::exception &ex) {
+      // e.g. an indeterminant linear system, the solver can't be used any more
+      RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "GraphTimeCentric: solver diverged with exception: " << ex.what());
+      isDiverged_ = true;
+      this->resetGraph();
+      return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
+    }
+    if (fullBatchSmoother_)
+      fullBatchSmoother_->updateEstimate(result);
     gtsam::Marginals marginals;
 
     currentKeyIndexTimestampMap_ = solver_->keyIndexTimestamps();
@@ -623,6 +634,15 @@ namespace fgo::graph {
     new_state.imuBias = result.at<gtsam::imuBias::ConstantBias>(B(nState_));
     //RCLCPP_INFO_STREAM(this->get_logger(), "Bias: " << lastOptimizedState_.imuBias);
 
+    if (!new_state.state.position().allFinite() || !new_state.state.velocity().allFinite() ||
+        !new_state.state.attitude().matrix().allFinite() || !new_state.imuBias.vector().allFinite()) {
+      RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "GraphTimeCentric: solver diverged to a non-finite state at "
+                                                 << std::fixed << new_state.timestamp.seconds());
+      isDiverged_ = true;
+      this->resetGraph();
+      return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
+    }
+
     new_state.accMeasured = accBuffer_.get_buffer_from_id(nState_ - 1);
 
     /*
@@ -631,27 +651,24 @@ namespace fgo::graph {
 
     bool fetchingResultsSuccessful = true;
     for (const auto &integrator: integratorMap_) {
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: starting fetching results for the integrator: " << integrator.first);
+      FGO_LOG_TAGGED(LogModule::GRAPH, LogLevel::INFO, "GraphTimeCentric: starting fetching results",
+                     integrator.first);
 
       fetchingResultsSuccessful &= integrator.second->fetchResult(result,
                                                                   marginals,
                                                                   currentKeyIndexTimestampMap_,
                                                                   new_state);
 
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "GraphTimeCentric: fetching results for the integrator " << integrator.first << " was "
-                                                                                  << (fetchingResultsSuccessful
-                                                                                      ? "successful" : "failed!"));
+      FGO_LOG_TAGGED(LogModule::GRAPH, fetchingResultsSuccessful ? LogLevel::INFO : LogLevel::ERROR,
+                     "GraphTimeCentric: fetched results", integrator.first,
+                     {"successful", double(fetchingResultsSuccessful)});
     }
 
     this->resetGraph();
     auto timeOpt = std::chrono::duration_cast<std::chrono::duration<double>>(
       std::chrono::system_clock::now() - start).count();
-    if (graphBaseParamPtr_->verbose) {
-      RCLCPP_INFO_STREAM(appPtr_->get_logger(),
-                         "Finished graph optimization, fetching results ..., TimeOpt: " << timeOpt);
-    }
+    if (graphBaseParamPtr_->verbose)
+      FGO_LOG_INFO(LogModule::SOLVER, "Finished graph optimization", {"timeOpt", timeOpt});
 
     return timeOpt;
   }
@@ -0,0 +1,170 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <cmath>
+#include "graph/IMUPreintegrationService.h"
+
+namespace fgo::graph {
+
+  void IMUPreintegrationService::initialize(
+    const boost::shared_ptr<gtsam::PreintegratedCombinedMeasurements::Params> &params,
+    const gtsam::imuBias::ConstantBias &bias,
+    double gridOrigin,
+    double gridPeriod,
+    const std::vector<fgo::data::IMUMeasurement> &measurements) {
+    std::lock_guard lg(mutex_);
+    params_ = params;
+    bias_ = bias;
+    gridOrigin_ = gridOrigin;
+    gridPeriod_ = gridPeriod;
+    firstOpenIndex_ = 1;
+    segments_.clear();
+    lastMeasurement_.reset();
+    for (const auto &meas: measurements)
+      add(meas);
+  }
+
+  void IMUPreintegrationService::reset() {
+    std::lock_guard lg(mutex_);
+    params_.reset();
+    segments_.clear();
+    firstOpenIndex_ = 1;
+    lastMeasurement_.reset();
+  }
+
+  bool IMUPreintegrationService::isInitialized() const {
+    std::lock_guard lg(mutex_);
+    return params_ != nullptr;
+  }
+
+  int64_t IMUPreintegrationService::segmentIndexOf(double timestamp) const {
+    auto index = static_cast<int64_t>(std::floor((timestamp - gridOrigin_) / gridPeriod_)) + 1;
+    // the grid times are compared exactly as the graph compares its state timestamps
+    while (timestamp >= gridTime(index))
+      index++;
+    while (timestamp < gridTime(index - 1))
+      index--;
+    return index;
+  }
+
+  IMUPreintegrationService::Segment &IMUPreintegrationService::segmentAt(int64_t index) {
+    if (segments_.empty())
+      segments_.push_back(Segment{index, gtsam::PreintegratedCombinedMeasurements(params_, bias_), {}});
+    while (segments_.back().index < index)
+      segments_.push_back(
+        Segment{segments_.back().index + 1, gtsam::PreintegratedCombinedMeasurements(params_, bias_), {}});
+    while (segments_.size() > MaxSegments)
+      segments_.pop_front();
+    return segments_[index - segments_.front().index];
+  }
+
+  void IMUPreintegrationService::integrate(Segment &segment, const Sample &sample) {
+    segment.pim.integrateMeasurement(sample.accLin, sample.gyro, sample.dt);
+    segment.samples.push_back(sample);
+  }
+
+  void IMUPreintegrationService::addMeasurement(const fgo::data::IMUMeasurement &meas) {
+    std::lock_guard lg(mutex_);
+    add(meas);
+  }
+
+  void IMUPreintegrationService::add(const fgo::data::IMUMeasurement &meas) {
+    const auto timestamp = meas.timestamp.seconds();
+    if (!params_ || meas.dt <= 0. || (lastMeasurement_ && timestamp <= lastMeasurement_->timestamp.seconds()))
+      return;
+    const auto index = std::max(segmentIndexOf(timestamp), firstOpenIndex_);
+    if (!segments_.empty() && index < segments_.front().index)
+      return;
+    integrate(segmentAt(index), Sample{timestamp, meas.dt, meas.accLin, meas.gyro});
+    lastMeasurement_ = meas;
+  }
+
+  void IMUPreintegrationService::setAnchor(double timestamp, const gtsam::imuBias::ConstantBias &bias) {
+    std::lock_guard lg(mutex_);
+    if (!params_)
+      return;
+    bias_ = bias;
+
+    const auto anchorIndex = static_cast<int64_t>(std::llround((timestamp - gridOrigin_) / gridPeriod_));
+    if (std::abs(gridTime(anchorIndex) - timestamp) > GridTolerance) {
+      // the anchor is not a state of the grid, e.g. if the states are created on the IMU, the grid restarts at it
+      std::vector<Sample> samples;
+      for (const auto &segment: segments_)
+        for (const auto &sample: segment.samples)
+          if (sample.timestamp > timestamp)
+            samples.push_back(sample);
+      segments_.clear();
+      gridOrigin_ = timestamp;
+      firstOpenIndex_ = 1;
+      for (const auto &sample: samples)
+        integrate(segmentAt(std::max<int64_t>(segmentIndexOf(sample.timestamp), 1)), sample);
+      return;
+    }
+
+    while (!segments_.empty() && segments_.front().index <= anchorIndex)
+      segments_.pop_front();
+    firstOpenIndex_ = std::max(firstOpenIndex_, anchorIndex + 1);
+    for (auto &segment: segments_) {
+      segment.pim.resetIntegrationAndSetBias(bias);
+      for (const auto &sample: segment.samples)
+        segment.pim.integrateMeasurement(sample.accLin, sample.gyro, sample.dt);
+    }
+  }
+
+  gtsam::NavState IMUPreintegrationService::predict(const gtsam::NavState &anchorState,
+                                                    const gtsam::imuBias::ConstantBias &bias) const {
+    std::lock_guard lg(mutex_);
+    auto state = anchorState;
+    for (const auto &segment: segments_) {
+      if (segment.samples.empty())
+        continue;
+      state = segment.pim.predict(state, bias);
+    }
+    return state;
+  }
+
+  bool IMUPreintegrationService::getSegment(double start, double end, gtsam::PreintegratedCombinedMeasurements &pim) {
+    std::lock_guard lg(mutex_);
+    if (!params_)
+      return false;
+    const auto startIndex = static_cast<int64_t>(std::llround((start - gridOrigin_) / gridPeriod_));
+    const auto endIndex = static_cast<int64_t>(std::llround((end - gridOrigin_) / gridPeriod_));
+    if (std::abs(gridTime(startIndex) - start) > GridTolerance || std::abs(gridTime(endIndex) - end) > GridTolerance ||
+        endIndex <= startIndex)
+      return false;
+    if (!segments_.empty() && startIndex + 1 < segments_.front().index)
+      return false;
+    firstOpenIndex_ = std::max(firstOpenIndex_, endIndex + 1);
+
+    if (endIndex == startIndex + 1) {
+      pim = segmentAt(endIndex).pim;
+      return true;
+    }
+    // states were skipped, the segments in between are merged
+    pim = gtsam::PreintegratedCombinedMeasurements(params_, bias_);
+    for (auto index = startIndex + 1; index <= endIndex; index++)
+      for (const auto &sample: segmentAt(index).samples)
+        pim.integrateMeasurement(sample.accLin, sample.gyro, sample.dt);
+    return true;
+  }
+
+  std::optional<fgo::data::IMUMeasurement> IMUPreintegrationService::lastMeasurement() const {
+    std::lock_guard lg(mutex_);
+    return lastMeasurement_;
+  }
+}
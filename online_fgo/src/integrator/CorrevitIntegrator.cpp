@@ -123,8 +123,6 @@ namespace fgo::integrator
                                                                                rclcpp::SystemDefaultsQoS(),
                                                                                [this](const irt_nav_msgs::msg::Correvit::ConstSharedPtr msg) -> void
                                                                                {
-        static double sumVelocity = 0;
-        static uint calcZeroVelocityCounter = 1;
         const auto ts = rclcpp::Time(msg->header.stamp.sec, msg->header.stamp.nanosec, RCL_ROS_TIME);
         auto data = Correvit();
         data.timestamp = ts.seconds();
@@ -134,10 +132,10 @@ namespace fgo::integrator
         data.vel_y_correvit = msg->vel_y_correvit;
         bufferCorrevit_.update_buffer(data, ts);
 
-        sumVelocity += msg->vel_correvit;
-        if(calcZeroVelocityCounter > 6)
+        sumVelocity_ += msg->vel_correvit;
+        if(calcZeroVelocityCounter_ > 6)
         {
-          const auto avgVelocity = abs(sumVelocity) / calcZeroVelocityCounter;
+          const auto avgVelocity = abs(sumVelocity_) / calcZeroVelocityCounter_;
 
           if(avgVelocity < paramPtr_->zeroVelocityThreshold)
           {
@@ -147,10 +145,10 @@ namespace fgo::integrator
           }
           else
             zeroVelocity_ = false;
-          calcZeroVelocityCounter = 0;
-          sumVelocity = 0.;
+          calcZeroVelocityCounter_ = 0;
+          sumVelocity_ = 0.;
        }
-       calcZeroVelocityCounter ++;
+       calcZeroVelocityCounter_ ++;
 
                                                                                });
     }
@@ -164,36 +162,34 @@ namespace fgo::integrator
                                    solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
                                    gtsam::KeyVector& relatedKeys) {
 
-      static auto firstCallTime = rosNodePtr_->now();
-      static auto fixedVelVar = paramPtr_->velVar * paramPtr_->velVarScale;
-      static auto baseToSensorTrans = sensorCalibManager_->getTransformationFromBase(sensorName_);
+      if(firstCallTime_.nanoseconds() == 0)
+        firstCallTime_ = rosNodePtr_->now();
+      const auto fixedVelVar = paramPtr_->velVar * paramPtr_->velVarScale;
+      const auto baseToSensorTrans = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
 
       if(!paramPtr_->integrateVelocity)
       {
         return true;
       }
 
-      if((rosNodePtr_->now() - firstCallTime).seconds() < paramPtr_->factorizeDelay)
+      if((rosNodePtr_->now() - firstCallTime_).seconds() < paramPtr_->factorizeDelay)
       {
         RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), std::fixed << "Correvit: delaying ");
         bufferCorrevit_.clean();
         return true;
       }
 
-      static gtsam::Key pose_key_j, vel_key_j, bias_key_j, omega_key_j,
+      gtsam::Key pose_key_j, vel_key_j, bias_key_j, omega_key_j,
              pose_key_i, vel_key_i,  bias_key_i, omega_key_i,
-             pose_key_sync, vel_key_sync,  bias_key_sync;
-      static uint64_t last_key_index = 0;
-      static boost::circular_buffer<CorrevitVelAngle> restCorrevitVelAngle(1000);
-      static boost::circular_buffer<Correvit> restCorrevit(1000);
-      static boost::circular_buffer<CorrevitPitchRoll> restCorrevitPitchRoll(1000);
+             vel_key_sync,  bias_key_sync;
+      gtsam::Key pose_key_sync = X(lastKeyIndex_);
 
       auto dataCorrevit = bufferCorrevit_.get_all_buffer_and_clean();
 
-      if(!restCorrevit.empty())
+      if(!restCorrevit_.empty())
       {
-        dataCorrevit.insert(dataCorrevit.begin(), restCorrevit.begin(), restCorrevit.end());
-        restCorrevit.clear();
+        dataCorrevit.insert(dataCorrevit.begin(), restCorrevit_.begin(), restCorrevit_.end());
+        restCorrevit_.clear();
       }
 
       /*
@@ -299,7 +295,7 @@ namespace fgo::integrator
           //std::cout << "Correvit lastKey: " << last_key_index << std::endl;
           //std::cout << "Correvit found omega: " << this_gyro << std::endl;
           //std::cout << "Correvit found omega: " << this_gyro_unbiased << std::endl;
-          if(last_key_index == gtsam::symbolIndex(pose_key_sync))
+          if(lastKeyIndex_ == gtsam::symbolIndex(pose_key_sync))
           {
             dataCorrevitIter ++;
             //RCLCPP_WARN_STREAM(appPtr_->get_logger(),
@@ -347,15 +343,27 @@ namespace fgo::integrator
         }*/
         else if(syncResult.status == StateMeasSyncStatus::CACHED)
         {
-          restCorrevit.push_back(*dataCorrevitIter);
+          restCorrevit_.push_back(*dataCorrevitIter);
         }
-        last_key_index = gtsam::symbolIndex(pose_key_sync);
+        lastKeyIndex_ = gtsam::symbolIndex(pose_key_sync);
         dataCorrevitIter ++;
       }
 
       return true;
     }
 
+    void CorrevitIntegrator::reset() {
+      firstCallTime_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
+      lastKeyIndex_ = 0;
+      restCorrevit_.clear();
+      sumVelocity_ = 0.;
+      calcZeroVelocityCounter_ = 1;
+      zeroVelocity_ = false;
+      bufferCorrevitVelAngle_.clean();
+      bufferCorrevit_.clean();
+      bufferCorrevitPitchRoll_.clean();
+    }
+
     bool CorrevitIntegrator::fetchResult(const gtsam::Values &result, const gtsam::Marginals &martinals,
                                          const solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
                                          data::State &optState) {
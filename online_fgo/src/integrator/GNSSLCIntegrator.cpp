@@ -84,6 +84,10 @@ namespace fgo::integrator {
     RosParameter<double> headingOffsetDeg("GNSSFGO." + integratorName_ + ".headingOffsetDeg", 0., node);
     paramPtr_->heading_offset_deg = headingOffsetDeg.value();
 
+    RosParameter<std::string> offlineDataChannel("GNSSFGO." + integratorName_ + ".offlineDataChannel",
+                                                 "reference_pva", node);
+    paramPtr_->offlineDataChannel = offlineDataChannel.value();
+
     RosParameter<std::string> attitudeFrame("GNSSFGO." + integratorName_ + ".attitudeFrame", "ned", *rosNodePtr_);
     auto attitudeFrameStr = attitudeFrame.value();
     setSensorFrameFromParam(attitudeFrameStr, paramPtr_->attitudeFrame, "GNSSLC");
@@ -318,19 +322,17 @@ namespace fgo::integrator {
       RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), std::fixed << integratorName_ + " not integrating ...");
       return true;
     }
-    static const auto baseToSensorTrans = sensorCalibManager_->getTransformationFromBase(sensorName_);
+    const auto baseToSensorTrans = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
 
-    static gtsam::Key pose_key_j, vel_key_j, omega_key_j, bias_key_j,
+    gtsam::Key pose_key_j, vel_key_j, omega_key_j, bias_key_j,
       pose_key_i, vel_key_i, omega_key_i, bias_key_i,
       pose_key_sync, vel_key_sync, bias_key_sync;
 
-    static boost::circular_buffer<fgo::data::PVASolution> restGNSSMeas(100);
-
     auto dataSensor = GNSSPVABuffer_.get_all_buffer_and_clean();
 
-    if (!restGNSSMeas.empty()) {
-      dataSensor.insert(dataSensor.begin(), restGNSSMeas.begin(), restGNSSMeas.end());
-      restGNSSMeas.clear();
+    if (!restGNSSMeas_.empty()) {
+      dataSensor.insert(dataSensor.begin(), restGNSSMeas_.begin(), restGNSSMeas_.end());
+      restGNSSMeas_.clear();
     }
 
     //RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
@@ -516,13 +518,24 @@ namespace fgo::integrator {
                                                    interpolator_, paramPtr_->attitudeType);
         }
       } else if (syncResult.status == StateMeasSyncStatus::CACHED) {
-        restGNSSMeas.push_back(*pvaIter);
+        restGNSSMeas_.push_back(*pvaIter);
       }
       pvaIter++;
     }
     return true;
   }
 
+  void GNSSLCIntegrator::reset() {
+    restGNSSMeas_.clear();
+    lastPVADelay_ = 0.;
+    lastPVATime_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
+    firstPVAMeasurement_ = true;
+    calcZeroVelocityCounter_ = 1;
+    sumVelocity_.setZero();
+    zeroVelocity_ = false;
+    GNSSPVABuffer_.clean();
+  }
+
   bool GNSSLCIntegrator::fetchResult(const gtsam::Values &result, const gtsam::Marginals &martinals,
                                      const solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
                                      data::State &optState) {
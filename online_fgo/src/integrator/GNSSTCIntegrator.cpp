@@ -17,9 +17,12 @@
 //
 
 #include "integrator/GNSSTCIntegrator.h"
+#include "utils/AsyncLogger.h"
 
 
 namespace fgo::integrator {
+  using fgo::utils::LogModule;
+
   void GNSSTCIntegrator::initialize(rclcpp::Node &node,
                                     graph::GraphBase &graphPtr,
                                     const std::string &integratorName,
@@ -37,8 +40,10 @@ namespace fgo::integrator {
     RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "sensorAntMainName: " << sensorAntMainName.value());
     RosParameter<std::string> sensorAntAuxName("GNSSFGO." + integratorName_ + ".sensorAntAux", node);
     RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "sensorAntAuxName: " << sensorAntAuxName.value());
-    baseToAntMainTrans_ = sensorCalibManager_->getTransformationFromBase(sensorAntMainName.value());
-    baseToAntAuxTrans_ = sensorCalibManager_->getTransformationFromBase(sensorAntAuxName.value());
+    antMainHandle_ = sensorCalibManager_->registerSensor(sensorAntMainName.value());
+    antAuxHandle_ = sensorCalibManager_->registerSensor(sensorAntAuxName.value());
+    baseToAntMainTrans_ = sensorCalibManager_->getTransformationFromBase(antMainHandle_);
+    baseToAntAuxTrans_ = sensorCalibManager_->getTransformationFromBase(antAuxHandle_);
 
 
     RosParameter<int> GNSSMeasurementFrequency("GNSSFGO." + integratorName_ + ".GNSSMeasurementFrequency", node);
@@ -237,22 +242,12 @@ namespace fgo::integrator {
     RosParameter<std::string> NLOSCSVFilePath("GNSSFGO." + integratorName_ + ".NLOSCSVFilePath", node);
 
     if (!NLOSCSVFilePath.value().empty()) {
-      rapidcsv::Document doc(NLOSCSVFilePath.value(), rapidcsv::LabelParams(0, -1));
-      const auto rowNum = doc.GetRowCount();
-      for (size_t i = 0; i < rowNum; i++) {
-        const auto tow = int(doc.GetCell<double>(0, i) * 10);
-        const auto prn = doc.GetCell<int>(1, i);
-        const auto isLOS = doc.GetCell<int>(2, i);
-
-        auto tsPos = LOSLoopUpTable_.find(tow);
-        if (tsPos == LOSLoopUpTable_.end()) {
-          std::map<int, bool> newLOSVec;
-          newLOSVec.insert(std::make_pair(prn, isLOS == 1));
-          LOSLoopUpTable_.insert(std::make_pair(tow, newLOSVec));
-        } else {
-          LOSLoopUpTable_[tow].insert(std::make_pair(prn, isLOS == 1));
-        }
-      }
+      if (LOSLookUpTable_.load(NLOSCSVFilePath.value()))
+        RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ + ": loaded NLOS look up table with "
+                             << LOSLookUpTable_.size() << " epochs");
+      else
+        RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), integratorName_ + ": can't load NLOS look up table "
+                              << NLOSCSVFilePath.value());
     }
 
     RCLCPP_INFO(rosNodePtr_->get_logger(), "--------------------- GNSSTCIntegrator initialized! ---------------------");
@@ -265,19 +260,16 @@ namespace fgo::integrator {
                                     gtsam::Values &values,
                                     fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
                                     gtsam::KeyVector &relatedKeys) {
-    static uint notifyCounter = paramPtr_->IMUMeasurementFrequency / paramPtr_->optFrequency;
-    static double halfStateBetweenTime = 1. / (double) notifyCounter / 2.;
+    const uint notifyCounter = paramPtr_->IMUMeasurementFrequency / paramPtr_->optFrequency;
+    const double halfStateBetweenTime = 1. / (double) notifyCounter / 2.;
 
-    static gtsam::Key pose_key_j, vel_key_j, bias_key_j, cbd_key_j,/*ddAmb_key_j,*/ omega_key_j, tdAmb_key_i,
+    gtsam::Key pose_key_j, vel_key_j, bias_key_j, cbd_key_j,/*ddAmb_key_j,*/ omega_key_j, tdAmb_key_i,
       pose_key_i, vel_key_i, bias_key_i, cbd_key_i,/*ddAmb_key_i,*/ omega_key_i, tdAmb_key_j,
       pose_key_sync, vel_key_sync, bias_key_sync, cbd_key_sync, omega_key_sync, tdAmb_key_sync;
-    static std::list<std::pair<uint32_t, bool>> notSlippedSatellites; //TODO not needed without DD
-    static uint consecutiveSyncs = 1;
-    static bool lastGNSSInterpolated = false;
-    static gtsam::Key lastStateJ = -1;
-    static boost::circular_buffer<fgo::data::GNSSMeasurement> restGNSSMeas(10);
-    static uint64_t lastPriorCbdNState = nState_;
     nState_ = currentKeyIndexTimestampMap.end()->first;
+    // the lever arms are taken once per epoch, so that all factors of an epoch use the same extrinsic
+    baseToAntMainTrans_ = sensorCalibManager_->getTransformationFromBase(antMainHandle_);
+    baseToAntAuxTrans_ = sensorCalibManager_->getTransformationFromBase(antAuxHandle_);
 
     auto dataSensor = gnssDataBuffer_.get_all_buffer_and_clean();
 
@@ -290,61 +282,95 @@ namespace fgo::integrator {
                                                                       gtsam::Vector2(
                                                                         std::pow(paramPtr_->constBiasStd, 2),
                                                                         std::pow(paramPtr_->constDriftStd, 2))));
-      lastPriorCbdNState = nState_;
       return true;
     }
 
     // we copy the data of last optimized state for safe, because this is used in imu cb.
-    if (!restGNSSMeas.empty()) {
-      dataSensor.insert(dataSensor.begin(), restGNSSMeas.begin(), restGNSSMeas.end());
-      restGNSSMeas.clear();
+    if (!restGNSSMeas_.empty()) {
+      dataSensor.insert(dataSensor.begin(), restGNSSMeas_.begin(), restGNSSMeas_.end());
+      restGNSSMeas_.clear();
     }
     //create GP interpolators for the factor
-    if (paramPtr_->gpType == fgo::data::GPModelType::WNOJ) {
-      interpolatorI_ = std::make_shared<fgo::models::GPWNOJInterpolator>(
-        gtsam::noiseModel::Diagonal::Variances(paramPtr_->QcGPInterpolatorFull), 0, 0,
-        paramPtr_->AutoDiffGPInterpolatedFactor, paramPtr_->GPInterpolatedFactorCalcJacobian);
-    } else if (paramPtr_->gpType == fgo::data::GPModelType::WNOA) {
-      interpolatorI_ = std::make_shared<fgo::models::GPWNOAInterpolator>(
-        gtsam::noiseModel::Diagonal::Variances(paramPtr_->QcGPInterpolatorFull), 0, 0,
-        paramPtr_->AutoDiffGPInterpolatedFactor, paramPtr_->GPInterpolatedFactorCalcJacobian);
-    } else {
+    interpolatorI_ = createInterpolator();
+    if (!interpolatorI_) {
       RCLCPP_WARN(rosNodePtr_->get_logger(), "NO gpType chosen. Please choose.");
       return false;
     }
 
-    auto gnssIter = dataSensor.begin();
-
-    while (gnssIter != dataSensor.end()) {
+    // the factor construction runs in three phases:
+    //  1. serial planning of the epochs, this only depends on the timestamps of the states
+    //  2. data-parallel construction of all per-satellite factors of all epochs into one flat vector
+    //  3. serial insertion of these factors and the stateful carrier phase factors in the order of the epochs, so the
+    //     graph is the same regardless of the number of threads
+    gnssEpochPlans_.clear();
+    size_t numSatelliteFactors = 0;
+    for (auto &gnssMeas: dataSensor) {
       // we iterate then though all gnss measurements, trying to find the corresponding one, this could be exhausted,
       // thus it must be considered carefully.
-      //RCLCPP_INFO(appPtr_->get_logger(), "1");
       // firstly, we check, whether there are gnss measurements, which are delayed and should be integrated in LAST optimization epochs!
+      GNSSEpochPlan plan;
+      plan.meas = &gnssMeas;
+      plan.correctedTime = gnssMeas.measMainAnt.timestamp.seconds() - gnssMeas.measMainAnt.delay;   // in double
+      FGO_LOG_INFO(LogModule::GNSS, "Current GNSS ts", {"ts", plan.correctedTime});
 
-      auto corrected_time_gnss_meas =
-        gnssIter->measMainAnt.timestamp.seconds() - gnssIter->measMainAnt.delay;   // in double
-      RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), std::fixed << "Current GNSS ts: " << corrected_time_gnss_meas);
+      plan.syncResult = findStateForMeasurement(currentKeyIndexTimestampMap, plan.correctedTime, paramPtr_);
+      const auto &syncResult = plan.syncResult;
 
-      auto current_pred_state = timePredStates.back().second; //graph::querryCurrentPredictedState(timePredStates, corrected_time_gnss_meas);
-
-      //this_gyro = current_pred_state.imuBias.correctGyroscope(this_gyro);
-
-      auto syncResult = findStateForMeasurement(currentKeyIndexTimestampMap, corrected_time_gnss_meas, paramPtr_);
-
-      RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "Found State I: " << std::fixed <<
-                                                                      syncResult.keyIndexI << " at: "
-                                                                      << syncResult.timestampI << " and J: "
-                                                                      << syncResult.keyIndexJ << " at: "
-                                                                      << syncResult.timestampJ
-                                                                      << " DurationToI: "
-                                                                      << syncResult.durationFromStateI);
+      FGO_LOG_INFO(LogModule::GNSS, "Found states", {"I", double(syncResult.keyIndexI)}, {"atI", syncResult.timestampI},
+                   {"J", double(syncResult.keyIndexJ)}, {"atJ", syncResult.timestampJ},
+                   {"durationToI", syncResult.durationFromStateI});
 
       if (!syncResult.foundI) {
         RCLCPP_WARN(rosNodePtr_->get_logger(), "State I or J couldn't be found in varIDTimestampMap.");
-        gnssIter++;
         continue;
       }
 
+      if (syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ||
+          syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_J) {
+        plan.omega = std::get<1>(findOmegaToMeasurement(plan.correctedTime, timestampGyroMap));
+        numSatelliteFactors = planSatelliteFactors(plan, numSatelliteFactors);
+      } else if (syncResult.status == StateMeasSyncStatus::INTERPOLATED && paramPtr_->addGPInterpolatedFactor) {
+        if (syncResult.durationFromStateI > halfStateBetweenTime)
+          plan.biasCbdKeyOffset = 1;
+        // each epoch gets its own interpolator, the factors built concurrently must not share a recalculated one
+        plan.interpolator = createInterpolator();
+        const double delta_t = syncResult.timestampJ - syncResult.timestampI;
+        if (paramPtr_->gpType == fgo::data::GPModelType::WNOJ) {
+          const auto [foundI, accI, foundJ, accJ] = findAccelerationToState(syncResult.keyIndexI, stateIDAccMap);
+          plan.interpolator->recalculate(delta_t, syncResult.durationFromStateI, accI, accJ);
+        } else
+          plan.interpolator->recalculate(delta_t, syncResult.durationFromStateI);
+        numSatelliteFactors = planSatelliteFactors(plan, numSatelliteFactors);
+      }
+      gnssEpochPlans_.emplace_back(plan);
+      //ToDo: Attention! Because the data timestamp in the container is monotone increasing,
+      // it makes no sense to iterate further if the current data is in front of the last state!
+      if (syncResult.status == StateMeasSyncStatus::CACHED)
+        break;
+    }
+
+    // the plans are not touched anymore, the inputs may point into them
+    satelliteFactorInputs_.resize(numSatelliteFactors);
+    for (const auto &plan: gnssEpochPlans_) {
+      for (size_t g = 0; g < plan.numGroups; g++) {
+        const auto &group = plan.groups[g];
+        for (auto i = group.begin; i < group.end; i++) {
+          satelliteFactorInputs_[i].obs = &(*group.obs)[i - group.begin];
+          satelliteFactorInputs_[i].plan = &plan;
+          satelliteFactorInputs_[i].group = &group;
+        }
+      }
+    }
+
+#pragma omp parallel for schedule(static) if (numSatelliteFactors > MinParallelSatelliteFactors)
+    for (size_t i = 0; i < numSatelliteFactors; i++)
+      buildSatelliteFactor(satelliteFactorInputs_[i]);
+
+    for (const auto &plan: gnssEpochPlans_) {
+      auto gnssIter = plan.meas;
+      const auto &syncResult = plan.syncResult;
+      auto current_pred_state = timePredStates.back().second; //graph::querryCurrentPredictedState(timePredStates, corrected_time_gnss_meas);
+
       pose_key_i = X(syncResult.keyIndexI);
       vel_key_i = V(syncResult.keyIndexI);
       omega_key_i = W(syncResult.keyIndexI);
@@ -366,8 +392,7 @@ namespace fgo::integrator {
       }
       if (syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ||
           syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_J) {
-        const auto [foundGyro, this_gyro] = findOmegaToMeasurement(corrected_time_gnss_meas, timestampGyroMap);
-        consecutiveSyncs++; //we were able to sync
+        consecutiveSyncs_++; //we were able to sync
         double time_synchronized;
         // now we found a state which is synchronized with the GNSS obs
         if (syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I) {
@@ -378,11 +403,9 @@ namespace fgo::integrator {
           omega_key_sync = omega_key_i;
           tdAmb_key_sync = tdAmb_key_i;
           time_synchronized = syncResult.timestampI;
-          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
-                             "[GNSSObs.] Found time synchronized state at I " << gtsam::symbolIndex(pose_key_sync)
-                                                                              <<
-                                                                              " with time difference: "
-                                                                              << syncResult.durationFromStateI);
+          FGO_LOG_INFO(LogModule::GNSS, "[GNSSObs.] Found time synchronized state at I",
+                       {"state", double(gtsam::symbolIndex(pose_key_sync))},
+                       {"timeDifference", syncResult.durationFromStateI});
         } else {
           pose_key_sync = pose_key_j;
           vel_key_sync = vel_key_j;
@@ -391,59 +414,16 @@ namespace fgo::integrator {
           omega_key_sync = omega_key_j;
           tdAmb_key_sync = tdAmb_key_j;
           time_synchronized = syncResult.timestampJ;
-          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
-                             "[GNSSObs.] Found time synchronized state at J " << gtsam::symbolIndex(pose_key_sync)
-                                                                              <<
-                                                                              " with time difference: "
-                                                                              << syncResult.durationFromStateI);
-        }
-
-        //PSEUDORANGE DOPPLER SYNCED
-        if (paramPtr_->usePseudoRangeDoppler &&
-            (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "PRDR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGNSSPrDrFactor(pose_key_sync, vel_key_sync, bias_key_sync, cbd_key_sync, gnssIter->measMainAnt.obs,
-                                  this_gyro, 1);
-        } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->usePseudoRange &&
-                   (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "PR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGNSSPrFactor(pose_key_sync, cbd_key_sync, gnssIter->measMainAnt.obs, 1);
-        } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->useDopplerRange) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "DR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGNSSDrFactor(pose_key_sync, vel_key_sync, cbd_key_sync, gnssIter->measMainAnt.obs, this_gyro, 1);
-        } else {
-          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), "No Pr Dr integrated!");
+          FGO_LOG_INFO(LogModule::GNSS, "[GNSSObs.] Found time synchronized state at J",
+                       {"state", double(gtsam::symbolIndex(pose_key_sync))},
+                       {"timeDifference", syncResult.durationFromStateI});
         }
 
-        if (paramPtr_->useDualAntenna && gnssIter->hasDualAntenna) {
-          if (paramPtr_->usePseudoRangeDoppler &&
-              (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "PRDR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGNSSPrDrFactor(pose_key_sync, vel_key_sync, bias_key_sync, cbd_key_sync, gnssIter->measAuxAnt.obs,
-                                    this_gyro, 2);
-          } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->usePseudoRange &&
-                     (paramPtr_->pseudorangeFactorTil == 0 ||
-                      paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "PR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGNSSPrFactor(pose_key_sync, cbd_key_sync, gnssIter->measAuxAnt.obs, 2);
-          } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->useDopplerRange) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "DR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGNSSDrFactor(pose_key_sync, vel_key_sync, cbd_key_sync, gnssIter->measAuxAnt.obs, this_gyro, 2);
-          } else {
-            RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), "Aux ant: No Pr Dr integrated!");
-          }
-        }
-
-        //DOUBLE DIFFERENCE PSEUDORANGE SYNCED
-        if (paramPtr_->usePseudoRangeDoppler && paramPtr_->useRTCMDD && gnssIter->hasRTK) {
-          this->addGNSSDDPrDrFactor(pose_key_sync, vel_key_sync, gnssIter->measRTCMDD.obs,
-                                    gnssIter->measRTCMDD.refSatGPS, gnssIter->measRTCMDD.basePosRTCM, this_gyro, 1);
-        }
-
-        if (paramPtr_->usePseudoRangeDoppler && paramPtr_->useDualAntenna && gnssIter->hasDualAntennaDD) {
-          this->addGNSSDDPrDrFactor(pose_key_sync, vel_key_sync, gnssIter->measDualAntennaDD.obs,
-                                    gnssIter->measDualAntennaDD.refSatGPS, gnssIter->measRTCMDD.basePosRTCM, this_gyro,
-                                    2);
+        //PSEUDORANGE DOPPLER AND DOUBLE DIFFERENCE PSEUDORANGE SYNCED
+        for (size_t g = 0; g < plan.numGroups; g++) {
+          FGO_LOG_INFO(LogModule::GNSS, "satellite factors", {"type", double(plan.groups[g].type)},
+                       {"n", double(plan.groups[g].end - plan.groups[g].begin)});
+          addSatelliteFactors(plan.groups[g]);
         }
 
         //DISABLED
@@ -452,9 +432,9 @@ namespace fgo::integrator {
                                   gnssIter->measRTCMDD.obs, gnssIter->measRTCMDD.refSatGPS,
                                   gnssIter->measRTCMDD.basePosRTCM, 1, current_pred_state);
           //because we create normal not GP we reset GP notSLippedlist
-          notSlippedSatellites.clear();
+          notSlippedSatellites_.clear();
           for (auto &obs: gnssIter->measRTCMDD.obs) {
-            notSlippedSatellites.emplace_back(obs.satId, false);
+            notSlippedSatellites_.emplace_back(obs.satId, false);
           }
           gtsam::Vector xVec;
           xVec.resize(gnssIter->measRTCMDD.obs.size());
@@ -467,10 +447,10 @@ namespace fgo::integrator {
 
         if (paramPtr_->useTDCarrierPhase) {
           //new Version of TDCP
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "TDNCP n: " << gnssIter->measMainAnt.obs.size());
+          FGO_LOG_INFO(LogModule::GNSS, "TDNCP", {"n", double(gnssIter->measMainAnt.obs.size())});
           this->addGPInterpolatedTDNormalCPFactor(pose_key_i, vel_key_i, omega_key_i, cbd_key_sync, pose_key_j,
                                                   vel_key_j, omega_key_j,
-                                                  gnssIter->measMainAnt.obs, consecutiveSyncs, time_synchronized,
+                                                  gnssIter->measMainAnt.obs, consecutiveSyncs_, time_synchronized,
                                                   interpolatorI_,
                                                   interpolatorJ_, delta_t, 0, syncResult.status, values,
                                                   keyTimestampMap); //TODO Time - TIme doesnt work atm hardcoded
@@ -478,7 +458,7 @@ namespace fgo::integrator {
       } else if (syncResult.status == StateMeasSyncStatus::INTERPOLATED && paramPtr_->addGPInterpolatedFactor) {
         //recalculate interpolator // set up interpolator
         //corrected_time_gnss_meas - timestampI;
-        RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GP delta: " << delta_t << " tau: " << taui);
+        FGO_LOG_INFO(LogModule::GNSS, "GP interpolation", {"delta", delta_t}, {"tau", taui});
         //ALSO NEEDED FOR DDCP TDCP, AND THATS IN SYNCED CASE AND IN NOT SYNCED CASE
         if (paramPtr_->gpType == fgo::data::GPModelType::WNOJ) {
           const auto [foundI, accI, foundJ, accJ] = findAccelerationToState(syncResult.keyIndexI, stateIDAccMap);
@@ -486,90 +466,31 @@ namespace fgo::integrator {
         } else
           interpolatorI_->recalculate(delta_t, taui);
 
-        // RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "accI.head(3): " << accI.head(3) << "\n" << accI.tail(3));
-
-
-
         // here, there is no time synchronized state found, we need to use GP interpolated GNSS factor with j-1 and j
-        consecutiveSyncs = 0; //we werent able to sync
-        lastGNSSInterpolated = false;
-        RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
-                           "[GNSSObs.] Found not synchronized between " << syncResult.keyIndexI << " and "
-                                                                        << syncResult.keyIndexJ <<
-                                                                        " with time difference: "
-                                                                        << syncResult.durationFromStateI);
-        uint32_t biasCbdKeyOffset = 0;
-        if (taui > halfStateBetweenTime)
-          biasCbdKeyOffset = 1;
-
-        //PSEUDORANGE DOPPLER GP
-        if (paramPtr_->usePseudoRangeDoppler &&
-            (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPPRDR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGPInterpolatedGNSSPrDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                                cbd_key_i, gnssIter->measMainAnt.obs, interpolatorI_, 1);
-        } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->usePseudoRange &&
-                   (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPPR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGPInterpolatedPrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                          cbd_key_i + biasCbdKeyOffset,
-                                          gnssIter->measMainAnt.obs, interpolatorI_, 1);
-        } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->useDopplerRange) {
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPDR1 n: " << gnssIter->measMainAnt.obs.size());
-          this->addGPInterpolatedDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                          cbd_key_i + biasCbdKeyOffset, gnssIter->measMainAnt.obs, interpolatorI_, 1);
-        } else {
-          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), "No Pr Dr integrated!");
-        }
-
-        if (paramPtr_->useDualAntenna && gnssIter->hasDualAntenna) {
-          if (paramPtr_->usePseudoRangeDoppler &&
-              (paramPtr_->pseudorangeFactorTil == 0 || paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPPRDR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGPInterpolatedGNSSPrDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j,
-                                                  omega_key_j,
-                                                  cbd_key_i + biasCbdKeyOffset, gnssIter->measMainAnt.obs,
-                                                  interpolatorI_, 2);
-          } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->usePseudoRange &&
-                     (paramPtr_->pseudorangeFactorTil == 0 ||
-                      paramPtr_->pseudorangeFactorTil >= syncResult.keyIndexJ)) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPPR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGPInterpolatedPrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                            cbd_key_i + biasCbdKeyOffset,
-                                            gnssIter->measAuxAnt.obs, interpolatorI_, 2);
-          } else if (!paramPtr_->usePseudoRangeDoppler && paramPtr_->useDopplerRange) {
-            RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "GPDR2 n: " << gnssIter->measAuxAnt.obs.size());
-            this->addGPInterpolatedDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                            cbd_key_i + biasCbdKeyOffset, gnssIter->measMainAnt.obs, interpolatorI_, 2);
-          } else {
-            RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), "Aux Ant: No Pr Dr integrated!");
-          }
-
+        consecutiveSyncs_ = 0; //we werent able to sync
+        lastGNSSInterpolated_ = false;
+        FGO_LOG_INFO(LogModule::GNSS, "[GNSSObs.] Found not synchronized", {"I", double(syncResult.keyIndexI)},
+                     {"J", double(syncResult.keyIndexJ)}, {"timeDifference", syncResult.durationFromStateI});
+
+        //PSEUDORANGE DOPPLER AND DOUBLE DIFFERENCE PSEUDORANGE GP
+        for (size_t g = 0; g < plan.numGroups; g++) {
+          FGO_LOG_INFO(LogModule::GNSS, "GP satellite factors", {"type", double(plan.groups[g].type)},
+                       {"n", double(plan.groups[g].end - plan.groups[g].begin)});
+          addSatelliteFactors(plan.groups[g]);
         }
 
-        //DOUBLE DIFFERENCE PSEUDORANGE GP
-        if (paramPtr_->useDDPseudoRange && paramPtr_->useRTCMDD && gnssIter->hasRTK) {
-          this->addGPInterpolatedDDPrDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                              gnssIter->measRTCMDD.obs, gnssIter->measRTCMDD.refSatGPS,
-                                              gnssIter->measRTCMDD.basePosRTCM, interpolatorI_, 1);
-        }
-        if (paramPtr_->useDDPseudoRange && paramPtr_->useDualAntenna && gnssIter->hasDualAntennaDD) {
-          this->addGPInterpolatedDDPrDrFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
-                                              gnssIter->measDualAntennaDD.obs, gnssIter->measDualAntennaDD.refSatGPS,
-                                              gnssIter->measRTCMDD.basePosRTCM, interpolatorI_, 2);
-        }
         //DOUBLE DIFFERENCE CARRIERPHASE
-        //resets if lastStateJ != keyIndexJ
+        //resets if lastStateJ_ != keyIndexJ
         //DISABLED
         if (paramPtr_->useDDCarrierPhase && paramPtr_->useRTCMDD && gnssIter->hasRTK && 0) {
           this->addGPInterpolatedDDCPFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j, omega_key_j,
                                             omega_key_j/*TODO put ambiguity key*/, gnssIter->measRTCMDD.obs,
                                             gnssIter->measRTCMDD.refSatGPS.refSatPos,
                                             gnssIter->measRTCMDD.basePosRTCM,
-                                            interpolatorI_, notSlippedSatellites, lastStateJ != syncResult.keyIndexJ);
+                                            interpolatorI_, notSlippedSatellites_, lastStateJ_ != syncResult.keyIndexJ);
         }
         //DISABLED
-        if (lastStateJ != syncResult.keyIndexJ && paramPtr_->useDDCarrierPhase && gnssIter->measRTCMDD.obs.size() &&
+        if (lastStateJ_ != syncResult.keyIndexJ && paramPtr_->useDDCarrierPhase && gnssIter->measRTCMDD.obs.size() &&
             0) {
           gtsam::Vector xVec;
           xVec.resize(gnssIter->measRTCMDD.obs.size());
@@ -582,15 +503,15 @@ namespace fgo::integrator {
         //TIME DIFFERENCE DD CARRIERPHASE
         if (paramPtr_->useTDCarrierPhase) {
           //new Version of TDCP
-          RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), "TDNCP n: " << gnssIter->measMainAnt.obs.size());
+          FGO_LOG_INFO(LogModule::GNSS, "TDNCP", {"n", double(gnssIter->measMainAnt.obs.size())});
           this->addGPInterpolatedTDNormalCPFactor(pose_key_i, vel_key_i, omega_key_i, //tdAmb_key_i,
-                                                  cbd_key_i + biasCbdKeyOffset, pose_key_j, vel_key_j,
+                                                  cbd_key_i + plan.biasCbdKeyOffset, pose_key_j, vel_key_j,
                                                   omega_key_j, gnssIter->measMainAnt.obs,
-                                                  consecutiveSyncs, syncResult.timestampJ, interpolatorI_,
+                                                  consecutiveSyncs_, syncResult.timestampJ, interpolatorI_,
                                                   interpolatorJ_,
                                                   delta_t, taui, syncResult.status,
                                                   values, keyTimestampMap,
-                                                  lastGNSSInterpolated); //TODO Time - TIme doesnt work atm hardcoded
+                                                  lastGNSSInterpolated_); //TODO Time - TIme doesnt work atm hardcoded
 
           /* old version of TDCP
           this->addGPInterpolatedTDCPFactor(pose_key_i, vel_key_i, omega_key_i, pose_key_j, vel_key_j,
@@ -600,16 +521,14 @@ namespace fgo::integrator {
         }
         //TIME DIFFERENCE CARRIERPHASE
 
-        lastStateJ = syncResult.keyIndexJ;
-        lastGNSSInterpolated = true;
+        lastStateJ_ = syncResult.keyIndexJ;
+        lastGNSSInterpolated_ = true;
       } else if (syncResult.status == StateMeasSyncStatus::CACHED) {
-        lastGNSSInterpolated = false;
+        lastGNSSInterpolated_ = false;
         RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), "[GNSSObs.] CAN not synchronize backup GNSS");
         // In this case, this gnss meas is in front of all imu meas, then we cache it
         // NOTICES: this shouldn't happen, if so, there must be sth wrong!
-        restGNSSMeas.push_back(*gnssIter);
-        //ToDo: Attention! Because the data timestamp in the container is monotone increasing,
-        // it makes no sense to iterate further if the current data is in front of the last state!
+        restGNSSMeas_.push_back(*gnssIter);
         break;
       }
 
@@ -617,12 +536,37 @@ namespace fgo::integrator {
       if (syncResult.stateJExist()) {
         interpolatorJ_ = interpolatorI_;
       }
-      gnssIter++;
     }
+    // the inputs point into dataSensor and hold the factors, keep only the capacity
+    satelliteFactorInputs_.clear();
+    gnssEpochPlans_.clear();
 
     return true;
   }
 
+  void GNSSTCIntegrator::reset() {
+    notSlippedSatellites_.clear();
+    gnssEpochPlans_.clear();
+    satelliteFactorInputs_.clear();
+    consecutiveSyncs_ = 1;
+    lastGNSSInterpolated_ = false;
+    lastStateJ_ = -1;
+    restGNSSMeas_.clear();
+    gnssTrackingState_.reset();
+    lastGNSSTime_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
+    lastGNSSDelay_ = 0.;
+    firstGNSSMeasurement_ = true;
+    calcZeroVelocityCounter_ = 1;
+    sumVelocity_.setZero();
+    lastDDCPRefSatID_ = 0;
+    tdcpRTCMEpoch_ = CarrierPhaseEpoch();
+    tdcpAuxEpoch_ = CarrierPhaseEpoch();
+    gpTDCPEpoch_ = CarrierPhaseEpoch{static_cast<uint>(-1)};
+    tdNormalCPEpoch_ = TDNormalCPEpoch();
+    zeroVelocity_ = false;
+    gnssDataBuffer_.clean();
+  }
+
   bool GNSSTCIntegrator::fetchResult(const gtsam::Values &result, const gtsam::Marginals &martinals,
                                      const solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
                                      data::State &optState) {
@@ -632,30 +576,26 @@ namespace fgo::integrator {
   }
 
   void GNSSTCIntegrator::onGNSSMsgCb(irt_nav_msgs::msg::GNSSObsPreProcessed::ConstSharedPtr gnssMsg) {
-    static rclcpp::Time last_gnss_time = rclcpp::Time(gnssMsg->header.stamp.sec, gnssMsg->header.stamp.nanosec,
-                                                      RCL_ROS_TIME);
-    static rclcpp::Time last_gnss_time_came = rosNodePtr_->now();
-    static auto start = rosNodePtr_->now();
-    static double lastDelay = 0.;
-    static uint64_t gnssCounter = 0;
     const auto thisGNSSTime = rclcpp::Time(gnssMsg->header.stamp.sec, gnssMsg->header.stamp.nanosec, RCL_ROS_TIME);
-    static bool first_measurement = true;
+    if (firstGNSSMeasurement_) {
+      lastGNSSTime_ = thisGNSSTime;
+      firstGNSSProcessingTime_ = rosNodePtr_->now();
+    }
 
     irt_nav_msgs::msg::SensorProcessingReport thisProcessingReport;
     thisProcessingReport.sensor_name = "GNSSTC";
     thisProcessingReport.ts_measurement = thisGNSSTime.seconds();
-    thisProcessingReport.ts_start_processing = start.seconds();
+    thisProcessingReport.ts_start_processing = firstGNSSProcessingTime_.seconds();
     thisProcessingReport.observation_available = true;
 
     delayCalculator_->setTOW(gnssMsg->gnss_obs_ant_main.time_receive);
     // we wait here for 0.001s so that the the integrator in delay calculator can set the new tow 1000000 nanosec = 0.001 sec
 
-    auto now_ = rosNodePtr_->now();
     auto start_time = std::chrono::system_clock::now();
 
     //change datatype
-    fgo::data::GNSSMeasurement gnssMeasurement = sensor::gnss::convertGNSSObservationMsg(*gnssMsg,
-                                                                                         paramPtr_); //convertGNSSMsg(gnssMsg);
+    fgo::data::GNSSMeasurement gnssMeasurement = sensor::gnss::convertGNSSObservationMsg(
+      *gnssMsg, paramPtr_, gnssTrackingState_, boost::none, LOSLookUpTable_.empty() ? nullptr : &LOSLookUpTable_);
     const auto measurement_delay = delayCalculator_->getDelay();
 
 
@@ -673,18 +613,18 @@ namespace fgo::integrator {
     //                  "Calculated delay: " << std::fixed << gnssMeasurement.measMainAnt.delay);
     //RCLCPP_WARN_STREAM(appPtr_->get_logger(), "Time passed: " << std::fixed << (appPtr_->now() - start).seconds() );
 
-   auto delayFromMsg = thisGNSSTime.seconds() - last_gnss_time.seconds() - 0.1; //
+   auto delayFromMsg = thisGNSSTime.seconds() - lastGNSSTime_.seconds() - 0.1; //
 
     // we check if we need to consider last delay
 
-    if (delayFromMsg < -0.001 && lastDelay > 0)
-      delayFromMsg += lastDelay;
+    if (delayFromMsg < -0.001 && lastGNSSDelay_ > 0)
+      delayFromMsg += lastGNSSDelay_;
 
     // + lastDelay;
     delayFromMsg = delayFromMsg > 0.3 ? gnssMeasurement.measMainAnt.delay : delayFromMsg;
 
-    if (first_measurement) {
-      first_measurement = false;
+    if (firstGNSSMeasurement_) {
+      firstGNSSMeasurement_ = false;
       delayFromMsg = 0.;
       gnssMeasurement.measMainAnt.delay = 0;
     }
@@ -707,9 +647,9 @@ namespace fgo::integrator {
     }
 
     if (abs(delayFromMsg) < 0.005 || delayFromMsg > 0.3)
-      lastDelay = 0.;
+      lastGNSSDelay_ = 0.;
     else
-      lastDelay = delayFromMsg;
+      lastGNSSDelay_ = delayFromMsg;
 
     //data saved in preprocessor
     auto correctedGNSSTimeNanoSec = int64_t(
@@ -739,8 +679,7 @@ namespace fgo::integrator {
                          "onGNSSMsgCb: cb takes " << duration_cb << "s, more than expected 0.1s");
     }
 
-    last_gnss_time = thisGNSSTime;
-    last_gnss_time_came = now_;
+    lastGNSSTime_ = thisGNSSTime;
 
     if (!graphPtr_->isGraphInitialized()) {
       graphPtr_->updateReferenceMeasurementTimestamp(gnssMsg->gnss_obs_ant_main.time_receive, correctedGNSSTime);
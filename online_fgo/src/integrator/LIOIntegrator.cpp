@@ -25,7 +25,7 @@ namespace fgo::integrator {
     RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
                        "--------------------- " << integratorName << ": start initialization... ---------------------");
 
-    integratorParamPtr_ = std::make_shared<IntegratorOdomParams>(integratorBaseParamPtr_);
+    integratorParamPtr_ = std::make_shared<IntegratorLIOParams>(integratorBaseParamPtr_);
 
     callbackGroupMap_.insert(
       std::make_pair("LIOSAM", rosNodePtr_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive)));
@@ -62,6 +62,22 @@ namespace fgo::integrator {
     integratorParamPtr_->robustParamOdomPose = robustParamOdomPose.value();
     integratorBaseParamPtr_->robustParamOdomPose = robustParamOdomPose.value();
 
+    ::utils::RosParameter<bool> useRegistrationInformation("GNSSFGO." + integratorName_ + ".useRegistrationInformation",
+                                                           true, *rosNodePtr_);
+    integratorParamPtr_->useRegistrationInformation = useRegistrationInformation.value();
+    ::utils::RosParameter<double> registrationPointVar("GNSSFGO." + integratorName_ + ".registrationPointVar", 0.04,
+                                                       *rosNodePtr_);
+    integratorParamPtr_->registrationPointVar = registrationPointVar.value();
+    ::utils::RosParameter<double> degenerateVarScale("GNSSFGO." + integratorName_ + ".degenerateVarScale", 1e4,
+                                                     *rosNodePtr_);
+    integratorParamPtr_->degenerateVarScale = std::max(1., degenerateVarScale.value());
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "LIOIntegrator useRegistrationInformation " << integratorParamPtr_->useRegistrationInformation
+                                                                   << " registrationPointVar "
+                                                                   << integratorParamPtr_->registrationPointVar
+                                                                   << " degenerateVarScale "
+                                                                   << integratorParamPtr_->degenerateVarScale);
+
     LIOSAM_ = std::make_shared<sensors::LiDAR::LIOSAM::LIOSAMOdometry>(node, integratorParamPtr_,
                                                                        callbackGroupMap_["LIOSAM"],
                                                                        callbackGroupMap_["LIOSAMLoop"],
@@ -70,6 +86,7 @@ namespace fgo::integrator {
                                                                        pubSensorReport_,
                                                                        sensorCalibManager_->getTransformationFromBase(
                                                                          sensorName_));
+    LIOSAM_->setPropagatedStatesQuery([this]() { return graphPtr_->getPredictedStates(); });
 
     if (integratorParamPtr_->gpType == fgo::data::GPModelType::WNOJ) {
       interpolatorI_ = std::make_shared<fgo::models::GPWNOJInterpolator>(
@@ -105,8 +122,6 @@ namespace fgo::integrator {
 
     //LIOSAM_->updateKeyIndexTimestampMap(currentKeyIndexTimestampMap);
 
-    static std::vector<fgo::data::Odom> dataSensorLocalBuffer;
-    static uint64_t counter = 0;
     auto dataSensor = LIOSAM_->getOdomAndClean();
 
     if (dataSensor.empty()) {
@@ -136,10 +151,7 @@ namespace fgo::integrator {
         numOdom_++;
         fgo::data::OdomResult this_result;
         //gtsam::SharedNoiseModel noise_model = gtsam::noiseModel::Diagonal::Variances(odom.noise);
-        const auto noise_model = graph::assignNoiseModel(integratorBaseParamPtr_->noiseModelOdomPose,
-                                                         odom.noise,
-                                                         integratorBaseParamPtr_->robustParamOdomPose,
-                                                         "odomBetweenFactor");
+        const auto noise_model = registrationNoiseModel(odom, odom.noise, "odomBetweenFactor");
 
         this_result.frameIndexCurrent = odom.frameIndexCurrent;
         this_result.frameIndexPrevious = odom.frameIndexPrevious;
@@ -286,8 +298,8 @@ namespace fgo::integrator {
         //{
         if (odom.queryOutputCurrent.keySynchronized) {
           //RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "LIOSAM: INTEGRATING SYNC. GLOBALPOSE!!!!!!");
-          this->addNavPoseFactor(X(odom.queryOutputCurrent.keyIndexI),
-                                 odom.poseToECEF, integratorParamPtr_->odomPoseVar);
+          this->addNavPoseFactor(X(odom.queryOutputCurrent.keyIndexI), odom.poseToECEF,
+                                 registrationNoiseModel(odom, integratorParamPtr_->odomPoseVar, "LiDARNavPoseFactor"));
         } else {
           //RCLCPP_ERROR_STREAM(appPtr_->get_logger(), "LIOSAM: INTEGRATING GPINTERPOLATED GLOBALPOSE!!!!!!");
           this->addGPinteporatedNavPoseFactor(X(odom.queryOutputCurrent.keyIndexI),
@@ -296,12 +308,14 @@ namespace fgo::integrator {
                                               X(odom.queryOutputCurrent.keyIndexJ),
                                               V(odom.queryOutputCurrent.keyIndexJ),
                                               W(odom.queryOutputCurrent.keyIndexJ),
-                                              odom.poseToECEF, integratorParamPtr_->odomPoseVar, interpolatorJ_);
+                                              odom.poseToECEF,
+                                              registrationNoiseModel(odom, integratorParamPtr_->odomPoseVar,
+                                                                     "LiDARNavPoseFactor"),
+                                              interpolatorJ_);
         }
         // }
 
       }
-      counter++;
     }
     return true;
   }
@@ -326,10 +340,7 @@ namespace fgo::integrator {
       keyIndexTimestampsMap.insert(std::make_pair(nState_, current_timestamp));
 
       if (integratorParamPtr_->integrateBetweenPose) {
-        const auto noise_model = graph::assignNoiseModel(integratorBaseParamPtr_->noiseModelOdomPose,
-                                                         odom.noise,
-                                                         integratorBaseParamPtr_->robustParamOdomPose,
-                                                         "odomBetweenFactor");
+        const auto noise_model = registrationNoiseModel(odom, odom.noise, "odomBetweenFactor");
 
         auto betweenFactor = boost::make_shared<fgo::factor::BetweenFactor<gtsam::Pose3>>(X(nState_ - 1),
                                                                                           X(nState_),
@@ -342,14 +353,43 @@ namespace fgo::integrator {
       }
 
       if (integratorParamPtr_->integrateGlobalPose) {
-        this->addNavPoseFactor(X(nState_),
-                               odom.poseToECEF, integratorParamPtr_->odomPoseVar);
+        this->addNavPoseFactor(X(nState_), odom.poseToECEF,
+                               registrationNoiseModel(odom, integratorParamPtr_->odomPoseVar, "LiDARNavPoseFactor"));
       }
 
     }
     return keyIndexTimestampsMap;
   }
 
+  gtsam::SharedNoiseModel LIOIntegrator::registrationNoiseModel(const fgo::data::Odom &odom,
+                                                                const gtsam::Vector6 &poseVar,
+                                                                const std::string &factorName) const {
+    if (!integratorParamPtr_->useRegistrationInformation || odom.registrationHessian.isZero() ||
+        !odom.registrationHessian.allFinite())
+      return graph::assignNoiseModel(integratorBaseParamPtr_->noiseModelOdomPose, poseVar,
+                                     integratorBaseParamPtr_->robustParamOdomPose, factorName);
+
+    // whitened with the configured variances, an eigenvalue of one is as confident as configured
+    const gtsam::Vector6 poseStd = poseVar.cwiseSqrt();
+    const gtsam::Matrix6 informationWhitened = poseStd.asDiagonal() * odom.registrationHessian *
+                                               poseStd.asDiagonal() / integratorParamPtr_->registrationPointVar;
+    const Eigen::SelfAdjointEigenSolver<gtsam::Matrix6> solver(informationWhitened);
+    const gtsam::Vector6 eigenvalues = solver.eigenvalues().cwiseMax(1. / integratorParamPtr_->degenerateVarScale)
+      .cwiseMin(1.);
+    const gtsam::Matrix6 information = poseStd.cwiseInverse().asDiagonal() * solver.eigenvectors() *
+                                       eigenvalues.asDiagonal() * solver.eigenvectors().transpose() *
+                                       poseStd.cwiseInverse().asDiagonal();
+
+    if (odom.numDegenerateDirections > 0)
+      RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(),
+                         integratorName_ << ": degenerate registration at " << std::fixed << odom.timestampCurrent
+                                         << " with " << odom.numDegenerateDirections
+                                         << " weak directions, whitened eigenvalues: "
+                                         << solver.eigenvalues().transpose());
+    return graph::assignNoiseModelFromInformation(integratorBaseParamPtr_->noiseModelOdomPose, information,
+                                                  integratorBaseParamPtr_->robustParamOdomPose, factorName);
+  }
+
   bool LIOIntegrator::fetchResult(const gtsam::Values &result, const gtsam::Marginals &martinals,
                                   const solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
                                   data::State &optState) {
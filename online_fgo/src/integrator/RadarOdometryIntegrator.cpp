@@ -0,0 +1,156 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include "integrator/RadarOdometryIntegrator.h"
+
+namespace fgo::integrator {
+  using ::utils::RosParameter;
+
+  void RadarOdometryIntegrator::initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr,
+                                           const std::string &integratorName, bool isPrimarySensor) {
+    IntegratorBase::initialize(node, graphPtr, integratorName, isPrimarySensor);
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << ": start initialization... ---------------------");
+
+    paramPtr_ = std::make_shared<IntegratorRadarOdometryParams>(integratorBaseParamPtr_);
+    initializeOdomParams(paramPtr_);
+    factorName_ = "RadarBetweenFactor";
+
+    RosParameter<std::string> radarChannel("GNSSFGO." + integratorName_ + ".radarChannel",
+                                           fgo::data::channel::Radar, *rosNodePtr_);
+    paramPtr_->radarChannel = radarChannel.value();
+
+    RosParameter<bool> useVelocityPrior("GNSSFGO." + integratorName_ + ".useVelocityPrior", true, *rosNodePtr_);
+    paramPtr_->useVelocityPrior = useVelocityPrior.value();
+
+    // frontend
+    const std::string prefix = "GNSSFGO." + integratorName_ + ".RadarOdometry.";
+    sensors::Radar::RadarOdometryParams roParams;
+
+    RosParameter<bool> azimuthAlongRows(prefix + "azimuthAlongRows", roParams.azimuthAlongRows, *rosNodePtr_);
+    roParams.azimuthAlongRows = azimuthAlongRows.value();
+    RosParameter<double> rangeResolution(prefix + "rangeResolution", roParams.rangeResolution, *rosNodePtr_);
+    roParams.rangeResolution = rangeResolution.value();
+    RosParameter<int> firstRangeBin(prefix + "firstRangeBin", roParams.firstRangeBin, *rosNodePtr_);
+    roParams.firstRangeBin = std::max(0, firstRangeBin.value());
+    RosParameter<double> azimuthOffset(prefix + "azimuthOffset", roParams.azimuthOffset, *rosNodePtr_);
+    roParams.azimuthOffset = azimuthOffset.value();
+    RosParameter<bool> clockwise(prefix + "clockwise", roParams.clockwise, *rosNodePtr_);
+    roParams.clockwise = clockwise.value();
+    RosParameter<double> scanPeriod(prefix + "scanPeriod", roParams.scanPeriod, *rosNodePtr_);
+    roParams.scanPeriod = scanPeriod.value();
+    RosParameter<double> timestampFraction(prefix + "timestampFraction", roParams.timestampFraction, *rosNodePtr_);
+    roParams.timestampFraction = std::clamp(timestampFraction.value(), 0., 1.);
+    RosParameter<int> kStrongest(prefix + "kStrongest", roParams.kStrongest, *rosNodePtr_);
+    roParams.kStrongest = std::max(1, kStrongest.value());
+    RosParameter<double> minIntensity(prefix + "minIntensity", roParams.minIntensity, *rosNodePtr_);
+    roParams.minIntensity = minIntensity.value();
+    RosParameter<double> minRange(prefix + "minRange", roParams.minRange, *rosNodePtr_);
+    roParams.minRange = minRange.value();
+    RosParameter<double> maxRange(prefix + "maxRange", roParams.maxRange, *rosNodePtr_);
+    roParams.maxRange = maxRange.value();
+    RosParameter<double> voxelSize(prefix + "voxelSize", roParams.voxelSize, *rosNodePtr_);
+    roParams.voxelSize = voxelSize.value();
+    RosParameter<int> maxIterations(prefix + "maxIterations", roParams.maxIterations, *rosNodePtr_);
+    roParams.maxIterations = maxIterations.value();
+    RosParameter<double> maxCorrespondenceDistance(prefix + "maxCorrespondenceDistance",
+                                                   roParams.maxCorrespondenceDistance, *rosNodePtr_);
+    roParams.maxCorrespondenceDistance = maxCorrespondenceDistance.value();
+    RosParameter<double> robustScale(prefix + "robustScale", roParams.robustScale, *rosNodePtr_);
+    roParams.robustScale = robustScale.value();
+    RosParameter<double> convergenceThreshold(prefix + "convergenceThreshold", roParams.convergenceThreshold,
+                                              *rosNodePtr_);
+    roParams.convergenceThreshold = convergenceThreshold.value();
+    RosParameter<int> motionCompensationIterations(prefix + "motionCompensationIterations",
+                                                   roParams.motionCompensationIterations, *rosNodePtr_);
+    roParams.motionCompensationIterations = motionCompensationIterations.value();
+    RosParameter<int> minCorrespondences(prefix + "minCorrespondences",
+                                         static_cast<int>(roParams.minCorrespondences), *rosNodePtr_);
+    roParams.minCorrespondences = static_cast<size_t>(std::max(3, minCorrespondences.value()));
+    RosParameter<double> unobservedVar(prefix + "unobservedVar", roParams.unobservedVar, *rosNodePtr_);
+    roParams.unobservedVar = unobservedVar.value();
+    RosParameter<int> numThreads(prefix + "numThreads", roParams.numThreads, *rosNodePtr_);
+    roParams.numThreads = numThreads.value();
+
+    radarOdometry_ = std::make_unique<sensors::Radar::RadarOdometry>(roParams);
+
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << " initialized with scans of "
+                                                << paramPtr_->radarChannel << "! ---------------------");
+  }
+
+  bool RadarOdometryIntegrator::addFactors(
+    const boost::circular_buffer<std::pair<double, gtsam::Vector3>> &timestampGyroMap,
+    const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap,
+    const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &currentKeyIndexTimestampMap,
+    std::vector<std::pair<rclcpp::Time, fgo::data::State>> &timePredStates,
+    gtsam::Values &values,
+    fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
+    gtsam::KeyVector &relatedKeys) {
+    if (paramPtr_->useVelocityPrior && !timePredStates.empty()) {
+      // body-centric velocity of the base resolved in the radar frame for the motion compensation of the next scans
+      const auto &state = timePredStates.back().second;
+      const gtsam::Vector6 twistBase = (gtsam::Vector6() << state.omega, state.state.bodyVelocity()).finished();
+      const auto baseFromSensor = sensorCalibManager_->getTransformationFromBase(sensorHandle_);
+      std::lock_guard lg(twistMutex_);
+      twistPredicted_ = baseFromSensor.inverse().AdjointMap() * twistBase;
+    }
+    addRelativePoseFactors(stateIDAccMap, currentKeyIndexTimestampMap, timePredStates, relatedKeys);
+    return true;
+  }
+
+  void RadarOdometryIntegrator::feedOfflineData(const fgo::data::MeasurementBatch &batch) {
+    for (const auto &scan: batch.get<cv_bridge::CvImage>(paramPtr_->radarChannel)) {
+      const auto timestamp = rclcpp::Time(scan.header.stamp, RCL_ROS_TIME);
+      std::optional<gtsam::Vector6> twistPrior;
+      {
+        std::lock_guard lg(twistMutex_);
+        twistPrior = twistPredicted_;
+      }
+
+      const auto tsStart = std::chrono::steady_clock::now();
+      const auto result = radarOdometry_->process(timestamp.seconds(), scan.image, twistPrior);
+      const auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tsStart).count();
+
+      if (duration > 0.25)
+        RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": radar odometry took " << duration
+                                                                      << "s, slower than 4 Hz");
+      if (!result) {
+        RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": no relative pose at " << std::fixed
+                                                                      << timestamp.seconds());
+        continue;
+      }
+      RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": relative pose at " << std::fixed
+                                                                    << timestamp.seconds() << " with "
+                                                                    << result->numFeatures << " features, "
+                                                                    << result->numCorrespondences
+                                                                    << " correspondences, rmse " << result->rmse
+                                                                    << " took " << duration << "s");
+      RelativePoseMeasurement odom;
+      odom.timestampPrevious = result->timestampPrevious;
+      odom.timestampCurrent = result->timestampCurrent;
+      odom.poseRelative = result->poseRelative;
+      odom.covariance = result->covariance;
+      odomBuffer_.update_buffer(odom, timestamp);
+    }
+  }
+}
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(fgo::integrator::RadarOdometryIntegrator, fgo::integrator::IntegratorBase)
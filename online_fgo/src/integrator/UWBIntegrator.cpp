@@ -0,0 +1,314 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include "integrator/UWBIntegrator.h"
+
+namespace fgo::integrator {
+  using ::utils::RosParameter;
+
+  void UWBIntegrator::initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr,
+                                 const std::string &integratorName, bool isPrimarySensor) {
+    IntegratorBase::initialize(node, graphPtr, integratorName, isPrimarySensor);
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << ": start initialization... ---------------------");
+
+    paramPtr_ = std::make_shared<IntegratorUWBParams>(integratorBaseParamPtr_);
+    uwbBuffer_.resize_buffer(1000);
+
+    RosParameter<bool> notIntegrating("GNSSFGO." + integratorName_ + ".notIntegrating", false, *rosNodePtr_);
+    paramPtr_->notIntegrating = notIntegrating.value();
+
+    RosParameter<std::string> offlineDataChannel("GNSSFGO." + integratorName_ + ".offlineDataChannel",
+                                                 fgo::data::channel::UWB, *rosNodePtr_);
+    paramPtr_->offlineDataChannel = offlineDataChannel.value();
+
+    RosParameter<double> rangeVar("GNSSFGO." + integratorName_ + ".rangeVar", paramPtr_->rangeVar, *rosNodePtr_);
+    paramPtr_->rangeVar = rangeVar.value();
+    RosParameter<double> minRange("GNSSFGO." + integratorName_ + ".minRange", paramPtr_->minRange, *rosNodePtr_);
+    paramPtr_->minRange = minRange.value();
+    RosParameter<double> maxRange("GNSSFGO." + integratorName_ + ".maxRange", paramPtr_->maxRange, *rosNodePtr_);
+    paramPtr_->maxRange = maxRange.value();
+
+    RosParameter<std::string> noiseModelRange("GNSSFGO." + integratorName_ + ".noiseModelRange", "cauchy",
+                                              *rosNodePtr_);
+    setNoiseModelFromParam(noiseModelRange.value(), paramPtr_->noiseModelRange, integratorName_);
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << " noiseModelRange: " << noiseModelRange.value());
+    RosParameter<double> robustParamRange("GNSSFGO." + integratorName_ + ".robustParamRange",
+                                          paramPtr_->robustParamRange, *rosNodePtr_);
+    paramPtr_->robustParamRange = robustParamRange.value();
+
+    RosParameter<double> anchorPositionVar("GNSSFGO." + integratorName_ + ".anchorPositionVar",
+                                           paramPtr_->anchorPositionVar, *rosNodePtr_);
+    paramPtr_->anchorPositionVar = anchorPositionVar.value();
+    RosParameter<double> estimatedAnchorPositionVar("GNSSFGO." + integratorName_ + ".estimatedAnchorPositionVar",
+                                                    paramPtr_->estimatedAnchorPositionVar, *rosNodePtr_);
+    paramPtr_->estimatedAnchorPositionVar = estimatedAnchorPositionVar.value();
+    RosParameter<bool> estimateBias("GNSSFGO." + integratorName_ + ".estimateBias", paramPtr_->estimateBias,
+                                    *rosNodePtr_);
+    paramPtr_->estimateBias = estimateBias.value();
+    RosParameter<double> biasVar("GNSSFGO." + integratorName_ + ".biasVar", paramPtr_->biasVar, *rosNodePtr_);
+    paramPtr_->biasVar = biasVar.value();
+
+    RosParameter<double> nlosInnovationThreshold("GNSSFGO." + integratorName_ + ".nlosInnovationThreshold",
+                                                 paramPtr_->nlosInnovationThreshold, *rosNodePtr_);
+    paramPtr_->nlosInnovationThreshold = nlosInnovationThreshold.value();
+    RosParameter<double> nlosVarScale("GNSSFGO." + integratorName_ + ".nlosVarScale", paramPtr_->nlosVarScale,
+                                      *rosNodePtr_);
+    paramPtr_->nlosVarScale = nlosVarScale.value();
+    RosParameter<double> maxInnovation("GNSSFGO." + integratorName_ + ".maxInnovation", paramPtr_->maxInnovation,
+                                       *rosNodePtr_);
+    paramPtr_->maxInnovation = maxInnovation.value();
+
+    // anchors, the positions are given either in ECEF or in ENU of an origin
+    RosParameter<std::vector<int64_t>> anchorIDs("GNSSFGO." + integratorName_ + ".anchorIDs",
+                                                 std::vector<int64_t>{}, *rosNodePtr_);
+    RosParameter<std::vector<double>> anchorPositions("GNSSFGO." + integratorName_ + ".anchorPositions",
+                                                      std::vector<double>{}, *rosNodePtr_);
+    RosParameter<std::vector<bool>> anchorEstimated("GNSSFGO." + integratorName_ + ".anchorEstimated",
+                                                    std::vector<bool>{}, *rosNodePtr_);
+    RosParameter<std::string> anchorFrame("GNSSFGO." + integratorName_ + ".anchorFrame", "ecef", *rosNodePtr_);
+    RosParameter<std::vector<double>> anchorOriginLLH("GNSSFGO." + integratorName_ + ".anchorOriginLLH",
+                                                      std::vector<double>{0., 0., 0.}, *rosNodePtr_);
+
+    const auto ids = anchorIDs.value();
+    const auto positions = anchorPositions.value();
+    const auto estimated = anchorEstimated.value();
+    const auto originLLHDeg = anchorOriginLLH.value();
+    const bool anchorsInENU = boost::algorithm::to_lower_copy(anchorFrame.value()) == "enu";
+    gtsam::Point3 originECEF = gtsam::Point3::Zero();
+    if (anchorsInENU && originLLHDeg.size() == 3)
+      originECEF = fgo::utils::llh2xyz(gtsam::Point3(originLLHDeg[0] * fgo::constants::deg2rad,
+                                                     originLLHDeg[1] * fgo::constants::deg2rad, originLLHDeg[2]));
+
+    if (positions.size() != 3 * ids.size())
+      RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": " << ids.size() << " anchors but "
+                                                                     << positions.size()
+                                                                     << " position entries, expected [x, y, z] per anchor!");
+    for (size_t i = 0; i < ids.size() && 3 * i + 2 < positions.size(); i++) {
+      UWBAnchor anchor;
+      anchor.id = static_cast<uint16_t>(ids[i]);
+      anchor.position = gtsam::Point3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+      if (anchorsInENU)
+        anchor.position = fgo::utils::enu2xyz(anchor.position, originECEF);
+      anchor.estimated = i < estimated.size() && estimated[i];
+      paramPtr_->anchors.emplace_back(anchor);
+      RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": anchor " << anchor.id << " at "
+                                                                    << std::fixed << anchor.position.transpose()
+                                                                    << (anchor.estimated ? " (estimated)" : ""));
+    }
+    this->reset();
+
+    RosParameter<std::string> uwbTopic("GNSSFGO." + integratorName_ + ".uwbTopic", "/uwb/ranges", *rosNodePtr_);
+    subUWB_ = rosNodePtr_->create_subscription<robognss_msgs::msg::UWB>(uwbTopic.value(),
+                                                                        rclcpp::SensorDataQoS(),
+                                                                        std::bind(&UWBIntegrator::onUWBMsgCb, this,
+                                                                                  std::placeholders::_1));
+
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << " initialized with " << anchorStates_.size()
+                                                << " anchors! ---------------------");
+  }
+
+  void UWBIntegrator::reset() {
+    uwbBuffer_.clean();
+    restUWB_.clear();
+    anchorStates_.clear();
+    for (const auto &anchor: paramPtr_->anchors) {
+      AnchorState state;
+      state.anchor = anchor;
+      state.position = anchor.position;
+      state.positionVar = anchor.estimated ? paramPtr_->estimatedAnchorPositionVar : paramPtr_->anchorPositionVar;
+      anchorStates_.insert_or_assign(anchor.id, state);
+    }
+  }
+
+  void UWBIntegrator::onUWBMsgCb(robognss_msgs::msg::UWB::ConstSharedPtr msg) {
+    const auto timestamp = rclcpp::Time(msg->header.stamp.sec, msg->header.stamp.nanosec, RCL_ROS_TIME);
+    for (const auto &meas: msg->meas) {
+      if (meas.range_status != robognss_msgs::msg::UWBMeas::RANGE_VALID ||
+          meas.anchor_type != robognss_msgs::msg::UWBMeas::STATIC)
+        continue;
+      fgo::data::UWBRange range;
+      range.timestamp = timestamp;
+      range.anchorID = meas.id;
+      range.range = meas.range;
+      uwbBuffer_.update_buffer(range, timestamp);
+    }
+  }
+
+  void UWBIntegrator::feedOfflineData(const fgo::data::MeasurementBatch &batch) {
+    for (const auto &range: batch.get<fgo::data::UWBRange>(paramPtr_->offlineDataChannel))
+      uwbBuffer_.update_buffer(range, range.timestamp);
+  }
+
+  void UWBIntegrator::insertAnchorStates(AnchorState &state, double timestamp, gtsam::Values &values) {
+    if (state.inGraph)
+      state.generation++;
+    const auto keyIndex = state.keyIndex();
+    values.insert(L(keyIndex), state.position);
+    values.insert(U(keyIndex), state.bias);
+    graphPtr_->emplace_shared<gtsam::PriorFactor<gtsam::Point3>>(
+      L(keyIndex), state.position, gtsam::noiseModel::Isotropic::Variance(3, state.positionVar));
+    graphPtr_->emplace_shared<gtsam::PriorFactor<gtsam::Vector1>>(
+      U(keyIndex), state.bias,
+      gtsam::noiseModel::Isotropic::Variance(1, paramPtr_->estimateBias ? paramPtr_->biasVar : 1e-8));
+    state.inGraph = true;
+    state.lastTimestamp = timestamp;
+  }
+
+  bool UWBIntegrator::addFactors(
+    const boost::circular_buffer<std::pair<double, gtsam::Vector3>> &timestampGyroMap,
+    const boost::circular_buffer<std::pair<size_t, gtsam::Vector6>> &stateIDAccMap,
+    const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &currentKeyIndexTimestampMap,
+    std::vector<std::pair<rclcpp::Time, fgo::data::State>> &timePredStates,
+    gtsam::Values &values,
+    fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestampMap,
+    gtsam::KeyVector &relatedKeys) {
+    if (paramPtr_->notIntegrating) {
+      RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), std::fixed << integratorName_ + " not integrating ...");
+      return true;
+    }
+
+    auto dataSensor = uwbBuffer_.get_all_buffer_and_clean();
+    if (!restUWB_.empty()) {
+      dataSensor.insert(dataSensor.begin(), restUWB_.begin(), restUWB_.end());
+      restUWB_.clear();
+    }
+    if (dataSensor.empty())
+      return true;
+
+    const auto lb = sensorCalibManager_->getTransformationFromBase(sensorHandle_).translation();
+    size_t numRanges = 0, numNLOS = 0, numRejected = 0;
+    for (const auto &range: dataSensor) {
+      const auto anchorIter = anchorStates_.find(range.anchorID);
+      if (anchorIter == anchorStates_.end()) {
+        RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": unknown anchor " << range.anchorID);
+        continue;
+      }
+      if (range.range < paramPtr_->minRange || range.range > paramPtr_->maxRange)
+        continue;
+      auto &anchor = anchorIter->second;
+      const double timestamp = range.timestamp.seconds();
+
+      const auto syncResult = findStateForMeasurement(currentKeyIndexTimestampMap, timestamp, paramPtr_);
+      if (syncResult.status == StateMeasSyncStatus::CACHED) {
+        restUWB_.emplace_back(range);
+        continue;
+      }
+      if (syncResult.status == StateMeasSyncStatus::DROPPED ||
+          (syncResult.status == StateMeasSyncStatus::INTERPOLATED && !paramPtr_->addGPInterpolatedFactor))
+        continue;
+      if (!checkStatePresentedInCurrentLag(syncResult.keyIndexI)) {
+        RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(),
+                            integratorName_ << ": not integrating range because state with id "
+                                            << syncResult.keyIndexI << " is not presented in current lag!");
+        continue;
+      }
+
+      // NLOS gating with the nearest predicted state, only if the anchor position is known well enough
+      double rangeVar = paramPtr_->rangeVar;
+      if (!timePredStates.empty() && std::sqrt(anchor.positionVar) < paramPtr_->nlosInnovationThreshold) {
+        const auto nearest = std::min_element(timePredStates.begin(), timePredStates.end(),
+                                              [timestamp](const auto &a, const auto &b) {
+                                                return std::abs(a.first.seconds() - timestamp) <
+                                                       std::abs(b.first.seconds() - timestamp);
+                                              });
+        const auto &state = nearest->second.state;
+        const gtsam::Point3 positionTag = state.position() + state.velocity() * (timestamp - nearest->first.seconds()) +
+                                          state.attitude().rotate(lb);
+        const double innovation = range.range - gtsam::distance3(positionTag, anchor.position) - anchor.bias(0);
+        if (std::abs(innovation) > paramPtr_->maxInnovation) {
+          numRejected++;
+          continue;
+        }
+        if (innovation > paramPtr_->nlosInnovationThreshold) {
+          rangeVar *= paramPtr_->nlosVarScale;
+          numNLOS++;
+        }
+      }
+
+      if (!anchor.inGraph || timestamp - anchor.lastTimestamp > paramPtr_->smootherLag)
+        insertAnchorStates(anchor, timestamp, values);
+      anchor.lastTimestamp = std::max(anchor.lastTimestamp, timestamp);
+      const auto anchorKey = L(anchor.keyIndex());
+      const auto biasKey = U(anchor.keyIndex());
+      // the anchor states stay in the lag as long as the anchor is observed
+      keyTimestampMap[anchorKey] = anchor.lastTimestamp;
+      keyTimestampMap[biasKey] = anchor.lastTimestamp;
+
+      const auto noiseModel = graph::assignNoiseModel(paramPtr_->noiseModelRange, gtsam::Vector1(rangeVar),
+                                                      paramPtr_->robustParamRange, "UWBRangeFactor");
+      if (syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ||
+          syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_J) {
+        const auto keyIndexSync = syncResult.status == StateMeasSyncStatus::SYNCHRONIZED_I ? syncResult.keyIndexI :
+                                  syncResult.keyIndexJ;
+        graphPtr_->emplace_shared<fgo::factor::UWBRangeFactor>(X(keyIndexSync), anchorKey, biasKey, range.range, lb,
+                                                               noiseModel, paramPtr_->AutoDiffNormalFactor);
+        relatedKeys.emplace_back(X(keyIndexSync));
+      } else {
+        const auto interpolator = createInterpolator(syncResult, stateIDAccMap);
+        if (!interpolator)
+          continue;
+        graphPtr_->emplace_shared<fgo::factor::GPInterpolatedUWBRangeFactor>(
+          X(syncResult.keyIndexI), V(syncResult.keyIndexI), W(syncResult.keyIndexI),
+          X(syncResult.keyIndexJ), V(syncResult.keyIndexJ), W(syncResult.keyIndexJ),
+          anchorKey, biasKey, range.range, lb, noiseModel, interpolator, paramPtr_->AutoDiffGPInterpolatedFactor);
+        relatedKeys.emplace_back(X(syncResult.keyIndexI));
+        relatedKeys.emplace_back(X(syncResult.keyIndexJ));
+      }
+      numRanges++;
+    }
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": integrated " << numRanges << " of "
+                                                                  << dataSensor.size() << " ranges, " << numNLOS
+                                                                  << " as NLOS, " << numRejected << " rejected, "
+                                                                  << restUWB_.size() << " cached");
+    return true;
+  }
+
+  bool UWBIntegrator::fetchResult(const gtsam::Values &result, const gtsam::Marginals &martinals,
+                                  const fgo::solvers::FixedLagSmoother::KeyIndexTimestampMap &keyIndexTimestampMap,
+                                  fgo::data::State &optState) {
+    for (auto &[id, anchor]: anchorStates_) {
+      if (!anchor.inGraph)
+        continue;
+      const auto anchorKey = L(anchor.keyIndex());
+      if (!result.exists(anchorKey)) {
+        // marginalized, the next observation starts a new generation of the anchor states
+        anchor.inGraph = false;
+        anchor.generation++;
+        continue;
+      }
+      anchor.position = result.at<gtsam::Point3>(anchorKey);
+      anchor.bias = result.at<gtsam::Vector1>(U(anchor.keyIndex()));
+      if (anchor.anchor.estimated) {
+        try {
+          anchor.positionVar = martinals.marginalCovariance(anchorKey).diagonal().maxCoeff();
+        }
+        catch (std::exception &ex) {
+          RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": no marginal of anchor " << id << ": "
+                                                                        << ex.what());
+        }
+      }
+    }
+    return true;
+  }
+}
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(fgo::integrator::UWBIntegrator, fgo::integrator::IntegratorBase)
@@ -0,0 +1,178 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include "integrator/VisualOdometryIntegrator.h"
+
+namespace fgo::integrator {
+  using ::utils::RosParameter;
+
+  namespace {
+    sensors::Camera::CameraIntrinsics toIntrinsics(const std::vector<double> &intrinsics,
+                                                   const std::vector<double> &distortion) {
+      sensors::Camera::CameraIntrinsics camera;
+      if (intrinsics.size() == 4) {
+        camera.fx = intrinsics[0];
+        camera.fy = intrinsics[1];
+        camera.cx = intrinsics[2];
+        camera.cy = intrinsics[3];
+      }
+      camera.distortion = distortion;
+      return camera;
+    }
+  }
+
+  void VisualOdometryIntegrator::initialize(rclcpp::Node &node, fgo::graph::GraphBase &graphPtr,
+                                            const std::string &integratorName, bool isPrimarySensor) {
+    IntegratorBase::initialize(node, graphPtr, integratorName, isPrimarySensor);
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << ": start initialization... ---------------------");
+
+    paramPtr_ = std::make_shared<IntegratorVisualOdometryParams>(integratorBaseParamPtr_);
+    initializeOdomParams(paramPtr_);
+    factorName_ = "VOBetweenFactor";
+
+    RosParameter<std::string> imageChannel("GNSSFGO." + integratorName_ + ".imageChannel",
+                                           fgo::data::channel::StereoPair, *rosNodePtr_);
+    paramPtr_->imageChannel = imageChannel.value();
+    paramPtr_->stereo = paramPtr_->imageChannel == fgo::data::channel::StereoPair;
+
+    RosParameter<std::string> rightSensorName("GNSSFGO." + integratorName_ + ".rightSensorName", "stereo_right",
+                                              *rosNodePtr_);
+    paramPtr_->rightSensorName = rightSensorName.value();
+
+    RosParameter<double> minSpeedMono("GNSSFGO." + integratorName_ + ".minSpeedMono", 0.5, *rosNodePtr_);
+    paramPtr_->minSpeedMono = minSpeedMono.value();
+
+    // frontend
+    const std::string prefix = "GNSSFGO." + integratorName_ + ".VisualOdometry.";
+    sensors::Camera::VisualOdometryParams voParams;
+    voParams.stereo = paramPtr_->stereo;
+
+    RosParameter<std::vector<double>> intrinsicsLeft(prefix + "intrinsicsLeft", *rosNodePtr_);
+    RosParameter<std::vector<double>> distortionLeft(prefix + "distortionLeft", std::vector<double>(4, 0.),
+                                                     *rosNodePtr_);
+    voParams.left = toIntrinsics(intrinsicsLeft.value(), distortionLeft.value());
+    if (voParams.stereo) {
+      RosParameter<std::vector<double>> intrinsicsRight(prefix + "intrinsicsRight", *rosNodePtr_);
+      RosParameter<std::vector<double>> distortionRight(prefix + "distortionRight", std::vector<double>(4, 0.),
+                                                        *rosNodePtr_);
+      voParams.right = toIntrinsics(intrinsicsRight.value(), distortionRight.value());
+      // T^right_left from the poses of both cameras in the base frame
+      voParams.rightFromLeft = sensorCalibManager_->getTransformationFromBase(paramPtr_->rightSensorName).inverse() *
+                               sensorCalibManager_->getTransformationFromBase(sensorHandle_);
+      RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << " stereo extrinsic T^right_left: "
+                                                                    << voParams.rightFromLeft);
+    }
+
+    if (!voParams.left.valid() || (voParams.stereo && !voParams.right.valid()))
+      RCLCPP_ERROR_STREAM(rosNodePtr_->get_logger(), integratorName_ << " has no valid camera intrinsics, "
+                                                                        "expected [fx, fy, cx, cy]!");
+
+    RosParameter<std::string> detector(prefix + "detector", "fast", *rosNodePtr_);
+    voParams.detector = detector.value() == "orb" ? sensors::Camera::FeatureDetectorType::ORB :
+                        sensors::Camera::FeatureDetectorType::FAST;
+    RosParameter<int> maxFeatures(prefix + "maxFeatures", voParams.maxFeatures, *rosNodePtr_);
+    voParams.maxFeatures = maxFeatures.value();
+    RosParameter<int> minTrackedFeatures(prefix + "minTrackedFeatures", voParams.minTrackedFeatures, *rosNodePtr_);
+    voParams.minTrackedFeatures = minTrackedFeatures.value();
+    RosParameter<int> gridRows(prefix + "gridRows", voParams.gridRows, *rosNodePtr_);
+    voParams.gridRows = std::max(1, gridRows.value());
+    RosParameter<int> gridCols(prefix + "gridCols", voParams.gridCols, *rosNodePtr_);
+    voParams.gridCols = std::max(1, gridCols.value());
+    RosParameter<int> fastThreshold(prefix + "fastThreshold", voParams.fastThreshold, *rosNodePtr_);
+    voParams.fastThreshold = fastThreshold.value();
+    RosParameter<double> minFeatureDistance(prefix + "minFeatureDistance", voParams.minFeatureDistance, *rosNodePtr_);
+    voParams.minFeatureDistance = minFeatureDistance.value();
+    RosParameter<int> kltWindowSize(prefix + "kltWindowSize", voParams.kltWindowSize, *rosNodePtr_);
+    voParams.kltWindowSize = kltWindowSize.value();
+    RosParameter<int> kltPyramidLevels(prefix + "kltPyramidLevels", voParams.kltPyramidLevels, *rosNodePtr_);
+    voParams.kltPyramidLevels = kltPyramidLevels.value();
+    RosParameter<double> kltMaxForwardBackwardError(prefix + "kltMaxForwardBackwardError",
+                                                    voParams.kltMaxForwardBackwardError, *rosNodePtr_);
+    voParams.kltMaxForwardBackwardError = kltMaxForwardBackwardError.value();
+    RosParameter<double> minDepth(prefix + "minDepth", voParams.minDepth, *rosNodePtr_);
+    voParams.minDepth = minDepth.value();
+    RosParameter<double> maxDepth(prefix + "maxDepth", voParams.maxDepth, *rosNodePtr_);
+    voParams.maxDepth = maxDepth.value();
+    RosParameter<double> maxStereoReprojectionError(prefix + "maxStereoReprojectionError",
+                                                    voParams.maxStereoReprojectionError, *rosNodePtr_);
+    voParams.maxStereoReprojectionError = maxStereoReprojectionError.value();
+    RosParameter<double> ransacReprojectionThreshold(prefix + "ransacReprojectionThreshold",
+                                                     voParams.ransacReprojectionThreshold, *rosNodePtr_);
+    voParams.ransacReprojectionThreshold = ransacReprojectionThreshold.value();
+    RosParameter<double> ransacConfidence(prefix + "ransacConfidence", voParams.ransacConfidence, *rosNodePtr_);
+    voParams.ransacConfidence = ransacConfidence.value();
+    RosParameter<int> ransacIterations(prefix + "ransacIterations", voParams.ransacIterations, *rosNodePtr_);
+    voParams.ransacIterations = ransacIterations.value();
+    RosParameter<int> minInliers(prefix + "minInliers", voParams.minInliers, *rosNodePtr_);
+    voParams.minInliers = minInliers.value();
+    RosParameter<double> pixelSigma(prefix + "pixelSigma", voParams.pixelSigma, *rosNodePtr_);
+    voParams.pixelSigma = pixelSigma.value();
+    RosParameter<int> numThreads(prefix + "numThreads", voParams.numThreads, *rosNodePtr_);
+    voParams.numThreads = numThreads.value();
+
+    visualOdometry_ = std::make_unique<sensors::Camera::VisualOdometry>(voParams);
+
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(),
+                       "--------------------- " << integratorName << " initialized with "
+                                                << (paramPtr_->stereo ? "stereo" : "monocular") << " images of "
+                                                << paramPtr_->imageChannel << "! ---------------------");
+  }
+
+  void VisualOdometryIntegrator::processImages(double timestamp, const cv::Mat &left, const cv::Mat &right) {
+    const auto tsStart = std::chrono::steady_clock::now();
+    const auto result = visualOdometry_->process(timestamp, left, right);
+    const auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tsStart).count();
+
+    if (!result) {
+      RCLCPP_WARN_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": no relative pose at " << std::fixed
+                                                                    << timestamp << " with "
+                                                                    << visualOdometry_->numFeatures()
+                                                                    << " features, took " << duration << "s");
+      return;
+    }
+    RCLCPP_INFO_STREAM(rosNodePtr_->get_logger(), integratorName_ << ": relative pose at " << std::fixed << timestamp
+                                                                  << " tracked " << result->numTracked << " inliers "
+                                                                  << result->numInliers << " took " << duration
+                                                                  << "s");
+    RelativePoseMeasurement odom;
+    odom.timestampPrevious = result->timestampPrevious;
+    odom.timestampCurrent = result->timestampCurrent;
+    odom.poseRelative = result->poseRelative;
+    odom.covariance = result->covariance;
+    odom.scaleObservable = result->scaleObservable;
+    odomBuffer_.update_buffer(odom, rclcpp::Time(static_cast<int64_t>(timestamp * 1e9), RCL_ROS_TIME));
+  }
+
+  void VisualOdometryIntegrator::feedOfflineData(const fgo::data::MeasurementBatch &batch) {
+    if (paramPtr_->stereo) {
+      for (const auto &pair: batch.get<fgo::data::StereoPair>(paramPtr_->imageChannel)) {
+        if (!pair.left)
+          continue;
+        processImages(pair.timestamp.seconds(), pair.left->image, pair.right ? pair.right->image : cv::Mat());
+      }
+    } else {
+      for (const auto &image: batch.get<cv_bridge::CvImage>(paramPtr_->imageChannel))
+        processImages(rclcpp::Time(image.header.stamp, RCL_ROS_TIME).seconds(), image.image);
+    }
+  }
+}
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(fgo::integrator::VisualOdometryIntegrator, fgo::integrator::IntegratorBase)
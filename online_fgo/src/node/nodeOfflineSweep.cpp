@@ -0,0 +1,52 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+//
+// Created by haoming on 18.10.26.
+//
+
+#include <rclcpp/rclcpp.hpp>
+#include "offline_process/LearningGP.h"
+#include "offline_process/OfflineSweepRunner.h"
+
+
+int main(int argc, char **argv) {
+  rclcpp::init(argc, argv);
+
+  if (rclcpp::ok()) {
+    // all parameters of the configuration files have to be known to the runner, as they form the base configuration
+    auto nodeOptions = rclcpp::NodeOptions()
+      .allow_undeclared_parameters(true)
+      .automatically_declare_parameters_from_overrides(true);
+    auto runner = std::make_shared<offline_process::OfflineSweepRunner>(nodeOptions);
+
+    // the dataset is read and parsed only once, all runs copy the parsed data blocks
+    utils::RosParameter<std::string> sensor_param_prefix("GNSSFGO.VehicleParameterPrefix", "GNSSFGO", *runner);
+    auto sensorCalibManager = std::make_shared<fgo::sensor::SensorCalibrationManager>(*runner,
+                                                                                      sensor_param_prefix.value());
+    std::shared_ptr<const fgo::dataset::DatasetBoreas> dataset =
+      offline_process::LearningGP::loadDatasetBoreas(*runner, sensorCalibManager);
+
+    const auto results = runner->run([&dataset](const rclcpp::NodeOptions &opt) {
+      return std::make_shared<offline_process::LearningGP>(opt, dataset);
+    });
+    runner->writeResultsToCSV(results);
+  }
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,307 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include "utils/GPUtils.h"
+#include "utils/Pose3Utils.h"
+#include "offline_process/GPHyperparameterLearner.h"
+
+namespace offline_process {
+
+  GPHyperparameterLearner::Statistics &GPHyperparameterLearner::Statistics::operator+=(const Statistics &other) {
+    mahalanobis += other.mahalanobis;
+    logDet += other.logDet;
+    count += other.count;
+    return *this;
+  }
+
+  size_t GPHyperparameterLearner::numBlocks() const {
+    return params_.gpType == fgo::data::GPModelType::WNOA ? 2 : 3;
+  }
+
+  std::vector<GPTrajectorySample> GPHyperparameterLearner::differentiate(const std::vector<double> &timestamps,
+                                                                         const std::vector<gtsam::Pose3> &poses) const {
+    const auto h = params_.differentiationWindow;
+    const auto n = std::min(timestamps.size(), poses.size());
+    const auto timeEnd = timestamps.begin() + static_cast<std::ptrdiff_t>(n);
+
+    // the samples at t - h and t + h, none if the window reaches over the borders or a gap in the trajectory
+    auto window = [&](size_t k, size_t &before, size_t &after) -> bool {
+      const auto itBefore = std::upper_bound(timestamps.begin(), timeEnd, timestamps[k] - h);
+      const auto itAfter = std::lower_bound(timestamps.begin(), timeEnd, timestamps[k] + h);
+      if (itBefore == timestamps.begin() || itAfter == timeEnd)
+        return false;
+      before = static_cast<size_t>(std::distance(timestamps.begin(), itBefore)) - 1;
+      after = static_cast<size_t>(std::distance(timestamps.begin(), itAfter));
+      return timestamps[k] - timestamps[before] <= 2. * h && timestamps[after] - timestamps[k] <= 2. * h;
+    };
+
+    std::vector<bool> hasVelocity(n, false);
+    std::vector<gtsam::Vector6> velocities(n, gtsam::Vector6::Zero());
+    for (size_t k = 0; k < n; k++) {
+      size_t before, after;
+      if (!window(k, before, after))
+        continue;
+      // central difference in the tangent space at sample k
+      velocities[k] = (gtsam::Pose3::Logmap(poses[k].between(poses[after])) -
+                       gtsam::Pose3::Logmap(poses[k].between(poses[before]))) /
+                      (timestamps[after] - timestamps[before]);
+      hasVelocity[k] = true;
+    }
+
+    std::vector<GPTrajectorySample> samples;
+    samples.reserve(n);
+    for (size_t k = 0; k < n; k++) {
+      size_t before, after;
+      if (!hasVelocity[k] || !window(k, before, after) || !hasVelocity[before] || !hasVelocity[after])
+        continue;
+      GPTrajectorySample sample;
+      sample.timestamp = timestamps[k];
+      sample.pose = poses[k];
+      sample.velocity = velocities[k];
+      sample.acceleration = (velocities[after] - velocities[before]) / (timestamps[after] - timestamps[before]);
+      samples.emplace_back(sample);
+    }
+    return samples;
+  }
+
+  std::vector<GPHyperparameterLearner::Transition>
+  GPHyperparameterLearner::buildTransitions(const std::vector<GPTrajectorySample> &trajectory) const {
+    std::vector<Transition> transitions;
+    if (trajectory.size() < 2)
+      return transitions;
+
+    // sample the trajectory on the state grid
+    const auto timeStart = trajectory.front().timestamp;
+    const auto tolerance = 0.25 * params_.stateInterval;
+    const GPTrajectorySample *last = nullptr;
+    for (size_t k = 0;; k++) {
+      const auto timestamp = timeStart + static_cast<double>(k) * params_.stateInterval;
+      if (timestamp > trajectory.back().timestamp + tolerance)
+        break;
+      auto it = std::lower_bound(trajectory.begin(), trajectory.end(), timestamp,
+                                 [](const GPTrajectorySample &sample, double t) { return sample.timestamp < t; });
+      if (it == trajectory.end() || (it != trajectory.begin() && timestamp - (it - 1)->timestamp < it->timestamp - timestamp))
+        it--;
+      if (std::abs(it->timestamp - timestamp) > tolerance) {
+        last = nullptr;
+        continue;
+      }
+      const auto &current = *it;
+      if (last && current.timestamp > last->timestamp) {
+        Transition transition;
+        transition.dt = current.timestamp - last->timestamp;
+        transition.pose = gtsam::Pose3::Logmap(last->pose.between(current.pose));
+        const auto Jinv = fgo::utils::rightJacobianPose3inv(transition.pose);
+        transition.velocityI = last->velocity;
+        transition.accelerationI = last->acceleration;
+        transition.velocityJ = Jinv * current.velocity;
+        transition.accelerationJ = Jinv * current.acceleration;
+        transitions.emplace_back(transition);
+      }
+      last = &current;
+    }
+    return transitions;
+  }
+
+  gtsam::Vector GPHyperparameterLearner::priorError(const Transition &t, size_t dim, double ad) const {
+    const auto d = static_cast<Eigen::Index>(dim);
+    const auto dt = t.dt;
+    switch (params_.gpType) {
+      case fgo::data::GPModelType::WNOA:
+        return (gtsam::Vector(2) << t.pose(d) - dt * t.velocityI(d),
+          t.velocityJ(d) - t.velocityI(d)).finished();
+      case fgo::data::GPModelType::WNOJ:
+      case fgo::data::GPModelType::WNOJFull:
+        return (gtsam::Vector(3) << t.pose(d) - dt * t.velocityI(d) - 0.5 * dt * dt * t.accelerationI(d),
+          t.velocityJ(d) - t.velocityI(d) - dt * t.accelerationI(d),
+          t.accelerationJ(d) - t.accelerationI(d)).finished();
+      case fgo::data::GPModelType::Singer:
+      case fgo::data::GPModelType::SingerFull:
+      default: {
+        // x_j - Phi(ad, dt) x_i, with the relative pose of state i being zero
+        const auto expon = std::exp(-ad * dt);
+        return (gtsam::Vector(3) << t.pose(d) - dt * t.velocityI(d) - (ad * dt - 1. + expon) / (ad * ad) * t.accelerationI(d),
+          t.velocityJ(d) - t.velocityI(d) - (1. - expon) / ad * t.accelerationI(d),
+          t.accelerationJ(d) - expon * t.accelerationI(d)).finished();
+      }
+    }
+  }
+
+  gtsam::Matrix GPHyperparameterLearner::unitCovariance(double dt, double ad) const {
+    const Eigen::Matrix<double, 1, 1> unitQc = Eigen::Matrix<double, 1, 1>::Ones();
+    switch (params_.gpType) {
+      case fgo::data::GPModelType::WNOA:
+        return fgo::utils::calcQ<1>(unitQc, dt);
+      case fgo::data::GPModelType::WNOJ:
+      case fgo::data::GPModelType::WNOJFull:
+        return fgo::utils::calcQ3<1>(unitQc, dt);
+      case fgo::data::GPModelType::Singer:
+      case fgo::data::GPModelType::SingerFull:
+      default: {
+        const gtsam::Matrix6 I = gtsam::Matrix6::Identity();
+        const auto Q = fgo::utils::calcQ<6>(I, (ad * I).eval(), dt);
+        gtsam::Matrix Q0(3, 3);
+        for (int row = 0; row < 3; row++)
+          for (int col = 0; col < 3; col++)
+            Q0(row, col) = Q(6 * row, 6 * col);
+        return Q0;
+      }
+    }
+  }
+
+  GPHyperparameterLearner::Statistics
+  GPHyperparameterLearner::accumulate(const std::vector<std::vector<Transition>> &segments, bool heldOut,
+                                      const gtsam::Vector6 &ad) const {
+    auto isHeldOut = [this](size_t segment) {
+      return params_.heldOutEvery > 0 && segment % params_.heldOutEvery == params_.heldOutEvery - 1;
+    };
+    return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, segments.size()), Statistics(),
+      [&](const tbb::blocked_range<size_t> &range, Statistics stat) -> Statistics {
+        for (auto s = range.begin(); s != range.end(); s++) {
+          if (isHeldOut(s) != heldOut)
+            continue;
+          for (const auto &transition: segments[s]) {
+            for (size_t dim = 0; dim < 6; dim++) {
+              const auto error = priorError(transition, dim, ad(static_cast<Eigen::Index>(dim)));
+              const Eigen::LLT<gtsam::Matrix> llt(unitCovariance(transition.dt, ad(static_cast<Eigen::Index>(dim))));
+              stat.mahalanobis(static_cast<Eigen::Index>(dim)) += error.dot(llt.solve(error));
+              stat.logDet(static_cast<Eigen::Index>(dim)) +=
+                2. * llt.matrixL().toDenseMatrix().diagonal().array().log().sum();
+            }
+            stat.count++;
+          }
+        }
+        return stat;
+      },
+      [](Statistics a, const Statistics &b) -> Statistics { return a += b; });
+  }
+
+  GPHyperparameterLearnerResult GPHyperparameterLearner::learn(const std::vector<GPTrajectorySample> &trajectory) const {
+    GPHyperparameterLearnerResult result;
+    const auto transitions = buildTransitions(trajectory);
+    if (transitions.empty())
+      return result;
+
+    std::vector<std::vector<Transition>> segments;
+    const auto timeStart = trajectory.front().timestamp;
+    double timeTransition = timeStart;
+    for (const auto &transition: transitions) {
+      const auto segment = static_cast<size_t>((timeTransition - timeStart) / params_.segmentDuration);
+      if (segments.size() <= segment)
+        segments.resize(segment + 1);
+      segments[segment].emplace_back(transition);
+      timeTransition += transition.dt;
+    }
+
+    const auto blocks = static_cast<double>(numBlocks());
+    // negative log likelihood of one dimension with the maximum likelihood qc
+    auto negLogLikelihood = [&](const Statistics &stat, Eigen::Index dim, double qc) {
+      const auto n = static_cast<double>(stat.count) * blocks;
+      return 0.5 * (n * std::log(2. * M_PI * qc) + stat.logDet(dim) + stat.mahalanobis(dim) / qc);
+    };
+
+    const bool isSinger = params_.gpType == fgo::data::GPModelType::Singer ||
+                          params_.gpType == fgo::data::GPModelType::SingerFull;
+    const auto candidates = isSinger ? params_.adCandidates : std::vector<double>{1.};
+    std::vector<double> bestNLL(6, std::numeric_limits<double>::max());
+    Statistics training;
+    for (const auto &candidate: candidates) {
+      const auto stat = accumulate(segments, false, gtsam::Vector6::Constant(candidate));
+      if (stat.count == 0)
+        return result;
+      for (Eigen::Index dim = 0; dim < 6; dim++) {
+        const auto qc = std::max(params_.minQc, stat.mahalanobis(dim) / (static_cast<double>(stat.count) * blocks));
+        const auto nll = negLogLikelihood(stat, dim, qc);
+        if (nll < bestNLL[dim]) {
+          bestNLL[dim] = nll;
+          result.qc(dim) = qc;
+          result.ad(dim) = candidate;
+        }
+      }
+      training.count = stat.count;
+    }
+
+    result.valid = true;
+    result.numTrainingTransitions = training.count;
+    double trainingNLL = 0.;
+    for (const auto &nll: bestNLL)
+      trainingNLL += nll;
+    result.trainingNegLogLikelihood = trainingNLL / static_cast<double>(training.count);
+
+    const auto heldOut = accumulate(segments, true, result.ad);
+    result.numHeldOutTransitions = heldOut.count;
+    if (heldOut.count > 0) {
+      double heldOutNLL = 0.;
+      for (Eigen::Index dim = 0; dim < 6; dim++)
+        heldOutNLL += negLogLikelihood(heldOut, dim, result.qc(dim));
+      result.heldOutNegLogLikelihood = heldOutNLL / static_cast<double>(heldOut.count);
+    }
+    return result;
+  }
+
+  void GPHyperparameterLearner::writeYAML(std::ostream &os, const GPHyperparameterLearnerResult &result) const {
+    std::string model;
+    switch (params_.gpType) {
+      case fgo::data::GPModelType::WNOA:
+        model = "WNOA";
+        break;
+      case fgo::data::GPModelType::WNOJ:
+      case fgo::data::GPModelType::WNOJFull:
+        model = "WNOJ";
+        break;
+      case fgo::data::GPModelType::Singer:
+      case fgo::data::GPModelType::SingerFull:
+      default:
+        model = "Singer";
+        break;
+    }
+    auto writeVector = [&os](const gtsam::Vector6 &vec) {
+      os << "[ ";
+      for (Eigen::Index i = 0; i < 6; i++)
+        os << vec(i) << (i < 5 ? ", " : " ");
+      os << "]\n";
+    };
+
+    const auto flags = os.flags();
+    os << std::scientific << std::setprecision(6);
+    os << "# GP-" << model << " hyperparameters learned from " << result.numTrainingTransitions
+       << " transitions with dt " << params_.stateInterval << " s\n";
+    os << "# negative log likelihood per transition: training " << result.trainingNegLogLikelihood
+       << ", held out (" << result.numHeldOutTransitions << " transitions) " << result.heldOutNegLogLikelihood << "\n";
+    os << "/**:\n"
+          "  ros__parameters:\n"
+          "    GNSSFGO:\n"
+          "      Optimizer:\n";
+    os << "        QcGP" << model << "MotionPriorFull: ";
+    writeVector(result.qc);
+    os << "        QcGP" << model << "InterpolatorFull: ";
+    writeVector(result.qc);
+    if (model == "Singer") {
+      os << "        adGPSinger: ";
+      writeVector(result.ad);
+    }
+    os.flags(flags);
+  }
+}
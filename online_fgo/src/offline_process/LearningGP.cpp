@@ -16,12 +16,16 @@
 //
 //
 
+#include <fstream>
+#include <sstream>
 #include "integrator/GNSSLCIntegrator.h"
 #include "integrator/GNSSTCIntegrator.h"
 #include "offline_process/LearningGP.h"
 
 namespace offline_process {
-  LearningGP::LearningGP(const rclcpp::NodeOptions &opt) : OfflineFGOBase("OfflineFGOGPLearning", opt) {
+  LearningGP::LearningGP(const rclcpp::NodeOptions &opt,
+                         const std::shared_ptr<const DatasetBoreas> &sharedDataset)
+    : OfflineFGOBase("OfflineFGOGPLearning", opt) {
     //Load databags
 
     RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: Starting the LearningGP Application ...");
@@ -31,7 +35,40 @@ namespace offline_process {
 
     RCLCPP_INFO_STREAM(this->get_logger(), "LearningGP: Data Container initializing");
 
-    auto data_param_boreas = std::make_shared<DatasetParam>(*this, "Boreas");
+    data_boreas_ = loadDatasetBoreas(*this, sensorCalibManager_, sharedDataset);
+
+    RCLCPP_INFO_STREAM(this->get_logger(), "Data Container initialized");
+
+    utils::RosParameter<bool> learnHyperparameters("GNSSFGO.LearningGP.enable", true, *this);
+    learnHyperparameters_ = learnHyperparameters.value();
+    if (learnHyperparameters_) {
+      learnerParams_.gpType = paramsPtr_->gpType;
+      learnerParams_.stateInterval = 1. / paramsPtr_->stateFrequency;
+      utils::RosParameter<double> differentiationWindow("GNSSFGO.LearningGP.differentiationWindow",
+                                                        learnerParams_.differentiationWindow, *this);
+      learnerParams_.differentiationWindow = differentiationWindow.value();
+      utils::RosParameter<double> segmentDuration("GNSSFGO.LearningGP.segmentDuration",
+                                                  learnerParams_.segmentDuration, *this);
+      learnerParams_.segmentDuration = segmentDuration.value();
+      utils::RosParameter<int> heldOutEvery("GNSSFGO.LearningGP.heldOutEvery",
+                                            static_cast<int>(learnerParams_.heldOutEvery), *this);
+      learnerParams_.heldOutEvery = static_cast<size_t>(std::max(0, heldOutEvery.value()));
+      utils::RosParameter<std::vector<double>> adCandidates("GNSSFGO.LearningGP.adCandidates",
+                                                            learnerParams_.adCandidates, *this);
+      learnerParams_.adCandidates = adCandidates.value();
+      utils::RosParameter<std::string> outputYAML("GNSSFGO.LearningGP.outputYAML", "", *this);
+      learnedHyperparametersYAML_ = outputYAML.value();
+      RCLCPP_INFO_STREAM(this->get_logger(), "LearningGP.outputYAML:" << learnedHyperparametersYAML_);
+    }
+    //paramsPtr_ = std::make_shared<gnss_fgo::GNSSFGOParams>();
+    this->startOfflineProcess(data_boreas_->timestamp_start.seconds(), data_boreas_->timestamp_end.seconds());
+    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: LearningGP Initialized ...");
+  }
+
+  std::unique_ptr<DatasetBoreas> LearningGP::loadDatasetBoreas(rclcpp::Node &node,
+                                                               const fgo::sensor::SensorCalibrationManager::Ptr &sensorCalibManager,
+                                                               const std::shared_ptr<const DatasetBoreas> &source) {
+    auto data_param_boreas = std::make_shared<DatasetParam>(node, "Boreas");
 
     data_param_boreas->topic_type_map = {
       {"/boreas/gps_gt",   fgo::data::DataType::Odometry},
@@ -51,13 +88,8 @@ namespace offline_process {
     //        {"/irt_gnss_preprocessing/gnss_obs_preprocessed", fgo::data::DataType::IRTGNSSObsPreProcessed},
     //};
 
-    data_boreas_ = std::make_unique<DatasetBoreas>(*this, data_param_boreas, sensorCalibManager_);
     //data_deloco_ = std::make_unique<DatadetDELoco>(*this, data_param_deloco);
-
-    RCLCPP_INFO_STREAM(this->get_logger(), "Data Container initialized");
-    //paramsPtr_ = std::make_shared<gnss_fgo::GNSSFGOParams>();
-    this->startOfflineProcess(data_boreas_->timestamp_start.seconds(), data_boreas_->timestamp_end.seconds());
-    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: LearningGP Initialized ...");
+    return std::make_unique<DatasetBoreas>(node, data_param_boreas, sensorCalibManager, source);
   }
 
   fgo::data::State LearningGP::getPriorState() {
@@ -75,19 +107,15 @@ namespace offline_process {
 
     auto data_batch = data_boreas_->getDataBefore(last_timestamp, true);
 
-    // ToDo: @Haoming, move the imu propagation into the IMUIntegrator
     RCLCPP_INFO_STREAM(this->get_logger(), "got imu of size " << data_batch.imu.size());
-    propagate_imu(data_batch.imu);
     RCLCPP_INFO_STREAM(this->get_logger(), "got gt of size " << data_batch.reference_pva.size());
     RCLCPP_INFO_STREAM(this->get_logger(), "got gps of size " << data_batch.gnss.size());
     RCLCPP_INFO_STREAM(this->get_logger(), "got lidar of size " << data_batch.lidar_raw.size());
     RCLCPP_INFO_STREAM(this->get_logger(), "got image of size " << data_batch.image.size());
-    auto gnss_integrator_base = graph_->getIntegrator("BoreasGNSSLCIntegrator");
-    auto gnss_integrator = reinterpret_cast<const std::shared_ptr<fgo::integrator::GNSSLCIntegrator>&>(gnss_integrator_base);
-    gnss_integrator->feedRAWData(data_batch.reference_pva, data_batch.reference_state);
-    for (const auto &pva: data_batch.reference_pva)
-      referenceBuffer_.update_buffer(pva, pva.timestamp);
-    return graph_->constructFactorGraphOnTime(stateTimestamps, data_batch.imu);
+    if (learnHyperparameters_)
+      learningReference_.insert(learningReference_.end(), data_batch.reference_pva.begin(),
+                                data_batch.reference_pva.end());
+    return feedDataBatch(stateTimestamps, data_batch);
   }
 
   StatusGraphConstruction LearningGP::feedDataDELoco(const vector<double> &stateTimestamps) {
@@ -95,16 +123,70 @@ namespace offline_process {
 
     // next step we get all data from the database
     auto data_batch = data_deloco_->getDataBefore(last_timestamp, true);
+    if (learnHyperparameters_)
+      learningReference_.insert(learningReference_.end(), data_batch.reference_pva.begin(),
+                                data_batch.reference_pva.end());
+    return feedDataBatch(stateTimestamps, data_batch);
+  }
 
-    // ToDo: @Haoming, move the imu propagation into the IMUIntegrator
+  void LearningGP::onOfflineProcessFinished() {
+    if (learnHyperparameters_)
+      this->learnHyperparameters();
+  }
 
-    propagate_imu(data_batch.imu);
-    //auto gnss = data_deloco_->getGNSSObservationBefore(last_timestamp, true);
-    auto gps_integrator_base = graph_->getIntegrator("IRTPVALCIntegrator");
-    auto gps_integrator = reinterpret_cast<const std::shared_ptr<fgo::integrator::GNSSLCIntegrator> &>(gps_integrator_base);
-    gps_integrator->feedRAWData(data_batch.reference_pva, data_batch.reference_state);
-    for (const auto &pva: data_batch.reference_pva)
-      referenceBuffer_.update_buffer(pva, pva.timestamp);
-    return graph_->constructFactorGraphOnTime(stateTimestamps, data_batch.imu);
+  void LearningGP::learnHyperparameters() {
+    if (learningReference_.empty()) {
+      RCLCPP_WARN(this->get_logger(), "LearningGP: no reference to learn the GP hyperparameters from");
+      return;
+    }
+    // the reference of consecutive batches may overlap at the batch borders
+    std::stable_sort(learningReference_.begin(), learningReference_.end(),
+                     [](const fgo::data::PVASolution &a, const fgo::data::PVASolution &b) {
+                       return a.timestamp.seconds() < b.timestamp.seconds();
+                     });
+
+    // the priors act on the base frame
+    const auto transBaseFromReference = sensorCalibManager_->getTransformationFromBase("reference").inverse();
+    std::vector<double> timestamps;
+    std::vector<gtsam::Pose3> poses;
+    timestamps.reserve(learningReference_.size());
+    poses.reserve(learningReference_.size());
+    for (const auto &pva: learningReference_) {
+      const auto timestamp = pva.timestamp.seconds();
+      if (!timestamps.empty() && timestamp <= timestamps.back())
+        continue;
+      timestamps.emplace_back(timestamp);
+      poses.emplace_back(gtsam::Pose3(pva.rot_ecef, pva.xyz_ecef) * transBaseFromReference);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const GPHyperparameterLearner learner(learnerParams_);
+    const auto result = learner.learn(learner.differentiate(timestamps, poses));
+    const auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start).count();
+    if (!result.valid) {
+      RCLCPP_WARN(this->get_logger(), "LearningGP: the reference is too short to learn the GP hyperparameters");
+      return;
+    }
+
+    RCLCPP_INFO_STREAM(this->get_logger(), "LearningGP: learned from " << result.numTrainingTransitions
+                                                                       << " transitions in " << duration << "s, qc: "
+                                                                       << result.qc.transpose() << " ad: "
+                                                                       << result.ad.transpose());
+    RCLCPP_INFO_STREAM(this->get_logger(), "LearningGP: negative log likelihood per transition, training: "
+      << result.trainingNegLogLikelihood << " held out (" << result.numHeldOutTransitions << "): "
+      << result.heldOutNegLogLikelihood);
+
+    std::ostringstream yaml;
+    learner.writeYAML(yaml, result);
+    RCLCPP_INFO_STREAM(this->get_logger(), "LearningGP: learned parameters\n" << yaml.str());
+    if (learnedHyperparametersYAML_.empty())
+      return;
+    std::ofstream file(learnedHyperparametersYAML_);
+    if (!file.is_open()) {
+      RCLCPP_ERROR_STREAM(this->get_logger(), "LearningGP: can't open " << learnedHyperparametersYAML_);
+      return;
+    }
+    file << yaml.str();
   }
 }
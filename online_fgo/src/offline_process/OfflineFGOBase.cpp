@@ -17,7 +17,11 @@
 //
 
 
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include "offline_process/OfflineFGOBase.h"
+#include "utils/Geodesy.h"
 
 namespace offline_process {
   offline_process::OfflineFGOBase::SignalHandlerType offline_process::OfflineFGOBase::old_sigint_handler_{SIG_ERR};
@@ -32,6 +36,68 @@ namespace offline_process {
       RCLCPP_ERROR(this->get_logger(), "initializeParameters went wrong. Please check the parameters in config.");
       return;
     }
+    utils::RosParameter<bool> interactive("GNSSFGO.Offline.interactive", true, *this);
+    interactive_ = interactive.value();
+    RCLCPP_WARN_STREAM(get_logger(), "Offline.interactive:" << (interactive_ ? "true" : "false"));
+
+    utils::RosParameter<bool> evaluation("GNSSFGO.Offline.Evaluation.enable", true, *this);
+    evaluation_ = evaluation.value();
+    if (evaluation_) {
+      utils::RosParameter<std::string> alignment("GNSSFGO.Offline.Evaluation.alignment", "none", *this);
+      if (alignment.value() == "se3")
+        evaluationParams_.alignment = fgo::utils::TrajectoryAlignment::SE3;
+      else if (alignment.value() == "sim3")
+        evaluationParams_.alignment = fgo::utils::TrajectoryAlignment::SIM3;
+      else
+        evaluationParams_.alignment = fgo::utils::TrajectoryAlignment::NONE;
+      utils::RosParameter<double> maxTimeDifference("GNSSFGO.Offline.Evaluation.maxTimeDifference", 0.05, *this);
+      evaluationParams_.maxTimeDifference = maxTimeDifference.value();
+      utils::RosParameter<double> maxReferenceGap("GNSSFGO.Offline.Evaluation.maxReferenceGap", 0.5, *this);
+      evaluationParams_.maxReferenceGap = maxReferenceGap.value();
+      utils::RosParameter<std::vector<double>> segmentLengths("GNSSFGO.Offline.Evaluation.segmentLengths",
+                                                              evaluationParams_.segmentLengths, *this);
+      evaluationParams_.segmentLengths = segmentLengths.value();
+      utils::RosParameter<bool> referenceHasAttitude("GNSSFGO.Offline.Evaluation.referenceHasAttitude", true, *this);
+      evaluationReferenceHasAttitude_ = referenceHasAttitude.value();
+      utils::RosParameter<std::string> outputFile("GNSSFGO.Offline.Evaluation.outputFile", "", *this);
+      evaluationOutputFile_ = outputFile.value();
+      RCLCPP_INFO_STREAM(get_logger(), "Offline.Evaluation.alignment:" << alignment.value());
+    }
+
+    // the fixed-lag pass runs as usual and provides the initial values for the full-batch optimization of the drive
+    utils::RosParameter<bool> fullBatchSmoothing("GNSSFGO.Offline.fullBatchSmoothing", false, *this);
+    fullBatchSmoothing_ = fullBatchSmoothing.value();
+    RCLCPP_INFO_STREAM(get_logger(), "Offline.fullBatchSmoothing:" << (fullBatchSmoothing_ ? "true" : "false"));
+    if (fullBatchSmoothing_) {
+      fgo::solvers::FullBatchSmootherParams fullBatchParams;
+      utils::RosParameter<bool> useGaussNewton("GNSSFGO.Offline.FullBatch.useGaussNewton", false, *this);
+      fullBatchParams.useGaussNewton = useGaussNewton.value();
+      utils::RosParameter<bool> nestedDissection("GNSSFGO.Offline.FullBatch.nestedDissection", true, *this);
+      fullBatchParams.nestedDissection = nestedDissection.value();
+      utils::RosParameter<int> maxIterations("GNSSFGO.Offline.FullBatch.maxIterations", 100, *this);
+      fullBatchParams.maxIterations = maxIterations.value();
+      utils::RosParameter<double> relativeErrorTol("GNSSFGO.Offline.FullBatch.relativeErrorTol", 1e-5, *this);
+      fullBatchParams.relativeErrorTol = relativeErrorTol.value();
+      utils::RosParameter<double> absoluteErrorTol("GNSSFGO.Offline.FullBatch.absoluteErrorTol", 1e-5, *this);
+      fullBatchParams.absoluteErrorTol = absoluteErrorTol.value();
+      utils::RosParameter<double> lambdaInitial("GNSSFGO.Offline.FullBatch.lambdaInitial", 1e-5, *this);
+      fullBatchParams.lambdaInitial = lambdaInitial.value();
+      utils::RosParameter<bool> verbose("GNSSFGO.Offline.FullBatch.verbose", false, *this);
+      fullBatchParams.verbose = verbose.value();
+      utils::RosParameter<std::string> outputCSV("GNSSFGO.Offline.FullBatch.outputCSV", "full_batch_trajectory.csv",
+                                                 *this);
+      fullBatchOutputCSV_ = outputCSV.value();
+      graph_->enableFullBatchSmoothing(fullBatchParams);
+    }
+
+    if (!interactive_) {
+      // headless process, e.g. in a parameter sweep: no keyboard, the loop starts as soon as the process is started
+      opt_mode_ = ProcessOptimizationMode::LOOP;
+      opt_condition_check_ = true;
+      RCLCPP_INFO(this->get_logger(), "---------------------  OfflineFGOBase initialized! --------------------- ");
+      return;
+    }
+
     install_signal_handlers();
 
     keyboard_handler_ = std::make_shared<KeyboardHandler>();
@@ -80,17 +146,41 @@ namespace offline_process {
       RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: deleting callback function " << cb_pair.first);
       keyboard_handler_->delete_key_press_callback(cb_pair.second);
     }
+    if (!interactive_)
+      return;
     process_deferred_signal();
     uninstall_signal_handlers();
 
   }
 
+  void OfflineFGOBase::waitForOfflineProcess() {
+    if (optThread_ && optThread_->joinable()) {
+      optThread_->join();
+      optThread_.reset();
+    }
+  }
+
+  void OfflineFGOBase::onErrorToReference(const irt_nav_msgs::msg::Error2GT &error) {
+    if (error.ref_mode != fgo::data::GNSSSolutionType::RTKFIX)
+      return;
+    std::lock_guard<std::mutex> lg(run_statistics_mut_);
+    run_statistics_.numErrorSamples++;
+    run_statistics_.sqPos2DErrorSum += error.pos_2d_error_geographic * error.pos_2d_error_geographic;
+    run_statistics_.sqPos3DErrorSum += error.pos_3d_error_geographic * error.pos_3d_error_geographic;
+    run_statistics_.pos2DErrorMax = std::max(run_statistics_.pos2DErrorMax, error.pos_2d_error_geographic);
+    run_statistics_.sqVel3DErrorSum += error.vel_3d_error * error.vel_3d_error;
+    if (error.yaw_error != std::numeric_limits<double>::max()) {
+      run_statistics_.numYawErrorSamples++;
+      run_statistics_.sqYawErrorSum += error.yaw_error * error.yaw_error;
+    }
+  }
+
   void OfflineFGOBase::offlineTimeCentricFGO(const double &time_start, const double &time_end) {
     // in this loop we simulate the time-centric fgo process using the trimmed dataset
     // the dataset should be TRIMMED in advance so that the first data is aligned with the prior state
 
-    static const auto time_offset_state = 1. / paramsPtr_->stateFrequency;
-    static const auto time_offset_optimization = 1. / paramsPtr_->optFrequency;
+    const auto time_offset_state = 1. / paramsPtr_->stateFrequency;
+    const auto time_offset_optimization = 1. / paramsPtr_->optFrequency;
 
     // we firstly initialize the graph using the prior_state queried while dataset setup
 
@@ -197,7 +287,9 @@ namespace offline_process {
     opt_states_map_.insert(std::make_pair(++opt_counter, state_id_timestamps));
 
     RCLCPP_WARN_STREAM(this->get_logger(), "OfflineFGO: Optimization: totally " << opt_states_map_.size()
-                                                                                << " epochs. \n Waiting for keyboard signal to start.... PRESS SPACE TO START...");
+                                                                                << " epochs.");
+    if (interactive_)
+      RCLCPP_WARN(this->get_logger(), "OfflineFGO: Waiting for keyboard signal to start.... PRESS SPACE TO START...");
     this->isStateInited_ = true;
     //MAIN LOOP
     opt_states_iter_ = opt_states_map_.begin();
@@ -261,6 +353,180 @@ namespace offline_process {
       if (opt_status_ == STOPPED)
         break;
     }
+
+    if (opt_states_iter_ == opt_states_map_.end()) {
+      std::lock_guard<std::mutex> lg(run_statistics_mut_);
+      run_statistics_.finished = true;
+    }
+
+    if (evaluation_)
+      evaluateTrajectory("fixed-lag", evaluationStates_);
+
+    if (fullBatchSmoothing_)
+      processFullBatch();
+
+    this->onOfflineProcessFinished();
+  }
+
+  void OfflineFGOBase::handleDivergence() {
+    isStateInited_ = false;
+    graph_->reset();
+    throw std::runtime_error("OfflineFGO: the graph diverged");
+  }
+
+  void OfflineFGOBase::processFullBatch() {
+    const auto start = std::chrono::steady_clock::now();
+    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: Starting full-batch optimization...");
+    const auto result = graph_->optimizeFullBatch();
+    const auto keyTimestamps = graph_->getFullBatchKeyTimestamps();
+    const auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start).count();
+
+    size_t numStates = 0;
+    for (const auto &key_timestamp: keyTimestamps)
+      if (gtsam::Symbol(key_timestamp.first).chr() == 'x')
+        numStates++;
+    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: Finished full-batch optimization of " << numStates
+                                                                                             << " states in "
+                                                                                             << duration << " s");
+    {
+      std::lock_guard<std::mutex> lg(run_statistics_mut_);
+      run_statistics_.numFullBatchStates = numStates;
+      run_statistics_.durationFullBatch = duration;
+    }
+
+    if (!fullBatchOutputCSV_.empty())
+      writeFullBatchTrajectory(result, keyTimestamps);
+
+    if (evaluation_) {
+      std::vector<fgo::data::State> states;
+      for (const auto &[key, timestamp]: keyTimestamps) {
+        const gtsam::Symbol symbol(key);
+        if (symbol.chr() != 'x' || !result.exists(key) || !result.exists(V(symbol.index())))
+          continue;
+        fgo::data::State state;
+        state.timestamp = rclcpp::Time(static_cast<int64_t>(timestamp * fgo::constants::sec2nanosec), RCL_ROS_TIME);
+        state.state = gtsam::NavState(result.at<gtsam::Pose3>(key), result.at<gtsam::Vector3>(V(symbol.index())));
+        if (result.exists(W(symbol.index())))
+          state.omega = result.at<gtsam::Vector3>(W(symbol.index()));
+        states.emplace_back(state);
+      }
+      evaluateTrajectory("full-batch", states);
+    }
+  }
+
+  std::vector<fgo::utils::TrajectorySample>
+  OfflineFGOBase::toLocalTrajectory(const std::vector<fgo::data::State> &states) const {
+    std::vector<fgo::utils::TrajectorySample> samples;
+    if (evaluationReference_.empty())
+      return samples;
+    const auto &origin = evaluationReference_.front().xyz_ecef;
+    const gtsam::Rot3 nRe(fgo::utils::geodesy::ecef2Frame(origin).nedRe());
+    const auto leverArm = sensorCalibManager_->getTransformationFromBase("reference").translation();
+    samples.reserve(states.size());
+    for (const auto &state: states) {
+      const auto &attitude = state.state.attitude();
+      fgo::utils::TrajectorySample sample;
+      sample.timestamp = state.timestamp.seconds();
+      sample.pose = gtsam::Pose3(nRe * attitude, nRe.rotate(state.state.position() + attitude.rotate(leverArm) - origin));
+      sample.velocity = nRe.rotate(state.state.v() + attitude.rotate(gtsam::skewSymmetric(-leverArm) * state.omega));
+      samples.emplace_back(sample);
+    }
+    return samples;
+  }
+
+  std::vector<fgo::utils::TrajectorySample>
+  OfflineFGOBase::toLocalTrajectory(const std::vector<fgo::data::PVASolution> &pvas) const {
+    std::vector<fgo::utils::TrajectorySample> samples;
+    if (pvas.empty())
+      return samples;
+    const auto &origin = pvas.front().xyz_ecef;
+    const gtsam::Rot3 nRe(fgo::utils::geodesy::ecef2Frame(origin).nedRe());
+    samples.reserve(pvas.size());
+    for (const auto &pva: pvas) {
+      fgo::utils::TrajectorySample sample;
+      sample.timestamp = pva.timestamp.seconds();
+      sample.pose = gtsam::Pose3(nRe * pva.rot_ecef, nRe.rotate(pva.xyz_ecef - origin));
+      // vel_n is resolved in the local NED frame of each sample, the trajectory is resolved at the origin
+      sample.velocity = nRe.rotate(pva.vel_ecef);
+      sample.hasAttitude = evaluationReferenceHasAttitude_;
+      sample.solutionType = pva.type;
+      samples.emplace_back(sample);
+    }
+    return samples;
+  }
+
+  void OfflineFGOBase::evaluateTrajectory(const std::string &name, const std::vector<fgo::data::State> &estimate) {
+    if (evaluationReference_.empty() || estimate.empty()) {
+      RCLCPP_WARN_STREAM(this->get_logger(), "OfflineFGO: no reference or estimate to evaluate the " << name
+                                                                                                     << " trajectory");
+      return;
+    }
+    // the reference of consecutive batches may overlap at the batch borders
+    std::stable_sort(evaluationReference_.begin(), evaluationReference_.end(),
+                     [](const fgo::data::PVASolution &a, const fgo::data::PVASolution &b) {
+                       return a.timestamp.seconds() < b.timestamp.seconds();
+                     });
+    const fgo::utils::TrajectoryEvaluator evaluator(evaluationParams_);
+    const auto evaluation = evaluator.evaluate(toLocalTrajectory(estimate), toLocalTrajectory(evaluationReference_));
+
+    const auto solutionTypeName = [](int type) -> std::string {
+      switch (type) {
+        case fgo::data::GNSSSolutionType::RTKFIX:
+          return "RTK fixed";
+        case fgo::data::GNSSSolutionType::RTKFLOAT:
+          return "RTK float";
+        case fgo::data::GNSSSolutionType::SINGLE:
+          return "SPP";
+        case fgo::data::GNSSSolutionType::NO_SOLUTION:
+          return "no solution";
+        default:
+          return std::to_string(type);
+      }
+    };
+    std::stringstream summary;
+    summary << "OfflineFGO: " << name << " ";
+    evaluation.writeSummary(summary, solutionTypeName);
+    RCLCPP_INFO_STREAM(this->get_logger(), summary.str());
+
+    if (!evaluationOutputFile_.empty()) {
+      std::ofstream file(evaluationOutputFile_, std::ios::out | std::ios::app);
+      if (!file.is_open()) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineFGO: can't open " << evaluationOutputFile_);
+        return;
+      }
+      file << summary.str() << "\n";
+    }
+  }
+
+  bool OfflineFGOBase::writeFullBatchTrajectory(const gtsam::Values &result,
+                                                const fgo::solvers::FixedLagSmoother::KeyTimestampMap &keyTimestamps) const {
+    std::ofstream file(fullBatchOutputCSV_, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+      RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineFGO: can't open " << fullBatchOutputCSV_);
+      return false;
+    }
+    file << "timestamp,x,y,z,qw,qx,qy,qz,vx,vy,vz,ba_x,ba_y,ba_z,bg_x,bg_y,bg_z\n";
+    file << std::fixed << std::setprecision(9);
+    for (const auto &[key, timestamp]: keyTimestamps) {
+      const gtsam::Symbol symbol(key);
+      if (symbol.chr() != 'x' || !result.exists(key))
+        continue;
+      const auto index = symbol.index();
+      const auto pose = result.at<gtsam::Pose3>(key);
+      const auto quat = pose.rotation().toQuaternion();
+      const gtsam::Vector3 vel = result.exists(V(index)) ? result.at<gtsam::Vector3>(V(index)) : gtsam::Vector3::Zero();
+      const auto bias = result.exists(B(index)) ? result.at<gtsam::imuBias::ConstantBias>(B(index))
+                                                : gtsam::imuBias::ConstantBias();
+      file << timestamp << ","
+           << pose.x() << "," << pose.y() << "," << pose.z() << ","
+           << quat.w() << "," << quat.x() << "," << quat.y() << "," << quat.z() << ","
+           << vel.x() << "," << vel.y() << "," << vel.z() << ","
+           << bias.accelerometer().x() << "," << bias.accelerometer().y() << "," << bias.accelerometer().z() << ","
+           << bias.gyroscope().x() << "," << bias.gyroscope().y() << "," << bias.gyroscope().z() << "\n";
+    }
+    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineFGO: full-batch trajectory written to " << fullBatchOutputCSV_);
+    return true;
   }
 
   void OfflineFGOBase::processSingleEpoch(const StateIDTimestampMap_t &state_id_timestamps) {
@@ -289,18 +555,46 @@ namespace offline_process {
       elapsedTimeFGO.num_new_factors = graph_->nrFactors();
       double timeOpt = this->optimize();
       isDoingPropagation_ = true;
+      if (evaluation_)
+        evaluationStates_.emplace_back(lastOptimizedState_);
       //double timeOpt = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::system_clock::now() - start).count();
       RCLCPP_INFO_STREAM(this->get_logger(), "Finished  optimization with a duration:" << timeOpt);
       elapsedTimeFGO.header.stamp = this->now();
       elapsedTimeFGO.duration_optimization = timeOpt;
       timerPub_->publish(elapsedTimeFGO);
+
+      std::lock_guard<std::mutex> lg(run_statistics_mut_);
+      run_statistics_.numOptimizations++;
+      run_statistics_.durationOptimizationSum += timeOpt;
+      run_statistics_.durationOptimizationMax = std::max(run_statistics_.durationOptimizationMax, timeOpt);
     } else if (constructGraphStatus == fgo::graph::StatusGraphConstruction::NO_OPTIMIZATION) {
       isDoingPropagation_ = false;
     }
+
+    std::lock_guard<std::mutex> lg(run_statistics_mut_);
+    run_statistics_.numEpochs++;
+    run_statistics_.durationConstructionSum += timeCFG;
+    run_statistics_.durationConstructionMax = std::max(run_statistics_.durationConstructionMax, timeCFG);
+  }
+
+  fgo::graph::StatusGraphConstruction OfflineFGOBase::feedDataBatch(const StateTimestamps_t &stateTimestamps,
+                                                                    const fgo::dataset::DataBatch &batch) {
+    propagate_imu(batch.imu);
+
+    fgo::data::MeasurementBatch measurements;
+    batch.collect(measurements);
+    for (const auto &[name, integrator]: graph_->getIntegrators())
+      integrator->feedOfflineData(measurements);
+
+    for (const auto &pva: batch.reference_pva)
+      referenceBuffer_.update_buffer(pva, pva.timestamp);
+    if (evaluation_)
+      evaluationReference_.insert(evaluationReference_.end(), batch.reference_pva.begin(), batch.reference_pva.end());
+    return graph_->constructFactorGraphOnTime(stateTimestamps, batch.imu);
   }
 
   void OfflineFGOBase::propagate_imu(const std::vector<fgo::data::IMUMeasurement> &imus) {
-    static const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
+    const auto transReferenceFromBase = sensorCalibManager_->getTransformationFromBase("reference");
 
     gtsam::Vector3 gravity_b = gtsam::Vector3::Zero();
     if (paramsPtr_->calibGravity) {
@@ -0,0 +1,182 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include "offline_process/OfflineSweepRunner.h"
+
+namespace offline_process {
+
+  namespace {
+    const std::string SweepPrefix = "Sweep.";
+
+    bool isValidRunName(const std::string &name) {
+      if (name.empty() || std::isdigit(static_cast<unsigned char>(name.front())))
+        return false;
+      return std::all_of(name.begin(), name.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+      });
+    }
+  }
+
+  OfflineSweepRunner::OfflineSweepRunner(const rclcpp::NodeOptions &opt) : rclcpp::Node("OfflineSweepRunner", opt) {
+    RCLCPP_INFO(this->get_logger(), "---------------------  OfflineSweepRunner initializing! --------------------- ");
+
+    utils::RosParameter<std::vector<std::string>> runs("Sweep.runs", std::vector<std::string>{}, *this);
+    utils::RosParameter<int> numWorkers("Sweep.numWorkers", 0, *this);
+    utils::RosParameter<std::string> outputCSV("Sweep.outputCSV", "offline_sweep.csv", *this);
+    outputCSV_ = outputCSV.value();
+    RCLCPP_INFO_STREAM(this->get_logger(), "Sweep.outputCSV: " << outputCSV_);
+
+    // everything that is not a sweep parameter belongs to the base configuration shared by all runs
+    const auto parameter_names = this->list_parameters({}, 0).names;
+    std::vector<std::string> base_names;
+    for (const auto &name: parameter_names) {
+      if (name.rfind(SweepPrefix, 0) != 0)
+        base_names.emplace_back(name);
+    }
+    baseParameters_ = this->get_parameters(base_names);
+    // the runs are processed without any keyboard interaction
+    baseParameters_.emplace_back("GNSSFGO.Offline.interactive", false);
+
+    auto run_names = runs.value();
+    if (run_names.empty()) {
+      RCLCPP_WARN(this->get_logger(), "OfflineSweepRunner: no runs given in Sweep.runs, processing the base configuration");
+      run_names.emplace_back("base");
+    }
+
+    for (const auto &run_name: run_names) {
+      if (!isValidRunName(run_name)) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineSweepRunner: skipping run with invalid name " << run_name
+                                                << ", only alphanumerics and underscores are allowed");
+        continue;
+      }
+      OfflineSweepRun run;
+      run.name = run_name;
+      const auto run_prefix = SweepPrefix + run_name + ".";
+      for (const auto &name: parameter_names) {
+        if (name.rfind(run_prefix, 0) == 0)
+          run.overrides.emplace_back(name.substr(run_prefix.size()), this->get_parameter(name).get_parameter_value());
+      }
+      RCLCPP_INFO_STREAM(this->get_logger(), "OfflineSweepRunner: run " << run.name << " with "
+                                             << run.overrides.size() << " overridden parameters");
+      for (const auto &param: run.overrides)
+        RCLCPP_INFO_STREAM(this->get_logger(), "    " << param.get_name() << ": " << param.value_to_string());
+      runs_.emplace_back(std::move(run));
+    }
+
+    // 0 lets the hardware decide
+    numWorkers_ = numWorkers.value() > 0 ? static_cast<size_t>(numWorkers.value()) :
+                  std::max<size_t>(1, std::thread::hardware_concurrency());
+    numWorkers_ = std::max<size_t>(1, std::min(numWorkers_, runs_.size()));
+    RCLCPP_INFO_STREAM(this->get_logger(), "Sweep.numWorkers: " << numWorkers_);
+
+    RCLCPP_INFO(this->get_logger(), "---------------------  OfflineSweepRunner initialized! --------------------- ");
+  }
+
+  rclcpp::NodeOptions OfflineSweepRunner::makeRunNodeOptions(const OfflineSweepRun &run) const {
+    // overrides given later take precedence while the parameters are declared
+    auto parameters = baseParameters_;
+    parameters.insert(parameters.end(), run.overrides.begin(), run.overrides.end());
+
+    // the runs must not pick up the global remapping and parameter files of this process, they are
+    // moved into their own namespace so that their topics don't mix up
+    std::string run_namespace = this->get_fully_qualified_name();
+    run_namespace += "/" + run.name;
+    return rclcpp::NodeOptions()
+      .use_global_arguments(false)
+      .arguments({"--ros-args", "-r", "__ns:=" + run_namespace})
+      .parameter_overrides(parameters)
+      .start_parameter_services(false)
+      .enable_rosout(false);
+  }
+
+  std::vector<OfflineSweepResult> OfflineSweepRunner::run(const ProcessFactory &factory) {
+    std::vector<OfflineSweepResult> results(runs_.size());
+    std::atomic_size_t next_run{0};
+
+    auto worker = [&]() -> void {
+      size_t run_index;
+      while ((run_index = next_run++) < runs_.size() && rclcpp::ok()) {
+        const auto &run = runs_[run_index];
+        auto &result = results[run_index];
+        result.name = run.name;
+        RCLCPP_INFO_STREAM(this->get_logger(), "OfflineSweepRunner: starting run " << run.name << " ("
+                                               << run_index + 1 << "/" << runs_.size() << ")");
+        try {
+          auto process = factory(this->makeRunNodeOptions(run));
+          process->waitForOfflineProcess();
+          result.statistics = process->getRunStatistics();
+        }
+        catch (const std::exception &ex) {
+          RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineSweepRunner: run " << run.name << " failed: " << ex.what());
+          result.statistics.failed = true;
+        }
+        RCLCPP_INFO_STREAM(this->get_logger(), "OfflineSweepRunner: run " << run.name << " done in "
+                                               << result.statistics.wallTime << "s, RMSE 2D: "
+                                               << result.statistics.rmsePos2D() << "m");
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < numWorkers_; i++)
+      workers.emplace_back(worker);
+    for (auto &w: workers)
+      w.join();
+    return results;
+  }
+
+  bool OfflineSweepRunner::writeResultsToCSV(const std::vector<OfflineSweepResult> &results) const {
+    std::ofstream file(outputCSV_, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+      RCLCPP_ERROR_STREAM(this->get_logger(), "OfflineSweepRunner: can't open " << outputCSV_);
+      return false;
+    }
+    file << "run,finished,failed,wall_time,num_epochs,num_optimizations,"
+            "construction_mean,construction_max,optimization_mean,optimization_max,"
+            "num_error_samples,rmse_pos_2d,rmse_pos_3d,max_pos_2d,rmse_vel_3d,rmse_yaw\n";
+    file << std::setprecision(9);
+    for (const auto &result: results) {
+      const auto &stat = result.statistics;
+      file << result.name << ","
+           << stat.finished << ","
+           << stat.failed << ","
+           << stat.wallTime << ","
+           << stat.numEpochs << ","
+           << stat.numOptimizations << ","
+           << stat.meanDurationConstruction() << ","
+           << stat.durationConstructionMax << ","
+           << stat.meanDurationOptimization() << ","
+           << stat.durationOptimizationMax << ","
+           << stat.numErrorSamples << ","
+           << stat.rmsePos2D() << ","
+           << stat.rmsePos3D() << ","
+           << stat.pos2DErrorMax << ","
+           << stat.rmseVel3D() << ","
+           << stat.rmseYaw() << "\n";
+    }
+    RCLCPP_INFO_STREAM(this->get_logger(), "OfflineSweepRunner: " << results.size() << " results written into "
+                                           << outputCSV_);
+    return file.good();
+  }
+
+}
@@ -74,25 +74,10 @@ namespace offline_process {
 
     auto data_batch = data_pohang_->getDataBefore(last_timestamp, true);
 
-    // ToDo: @Haoming, move the imu propagation into the IMUIntegrator
     RCLCPP_INFO_STREAM(this->get_logger(), "got imu of size " << data_batch.imu.size());
-    propagate_imu(data_batch.imu);
-    RCLCPP_INFO_STREAM(this->get_logger(), "imu propagated ");
-
     RCLCPP_INFO_STREAM(this->get_logger(), "got gt of size " << data_batch.reference_pva.size());
     RCLCPP_INFO_STREAM(this->get_logger(), "got gps of size " << data_batch.gnss.size());
-
-    auto gps_integrator_base = graph_->getIntegrator("PohangGNSSLCIntegrator");
-    auto gps_integrator = reinterpret_cast<const std::shared_ptr<fgo::integrator::GNSSLCIntegrator> &>(gps_integrator_base);
-    gps_integrator->feedRAWData(data_batch.reference_pva, data_batch.reference_state);
-    for (const auto &pva: data_batch.reference_pva)
-      referenceBuffer_.update_buffer(pva, pva.timestamp);
-
-    //auto beacon_integrator_base = graph_->getIntegrator("BeaconPohang");
-    //auto beacon_integrator = reinterpret_cast<const std::shared_ptr<fgo::integrator::BeaconIntegrator> &>(beacon_integrator_base);
-    //beacon_integrator->feedRAWData(data_batch.stereo_pair);
-    return graph_->constructFactorGraphOnTime(stateTimestamps, data_batch.imu);
-    return SUCCESSFUL;
+    return feedDataBatch(stateTimestamps, data_batch);
   }
 
   StatusGraphConstruction OfflineVisualFGO::feedDataOffline(const vector<double> &stateTimestamps) {
@@ -0,0 +1,419 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <opencv2/calib3d.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/blocked_range.h>
+#include <gtsam/geometry/Rot3.h>
+#include "sensor/camera/VisualOdometry.h"
+
+namespace sensors::Camera {
+
+  namespace {
+    /***
+     * linear triangulation of normalized image coordinates of two views
+     * @param a observation in view A
+     * @param b observation in view B
+     * @param bFromA T^B_A
+     * @return point in view A
+     */
+    std::optional<gtsam::Point3> triangulateLinear(const cv::Point2f &a, const cv::Point2f &b,
+                                                   const gtsam::Pose3 &bFromA) {
+      Eigen::Matrix<double, 3, 4> PA = Eigen::Matrix<double, 3, 4>::Zero();
+      PA.leftCols<3>().setIdentity();
+      Eigen::Matrix<double, 3, 4> PB;
+      PB << bFromA.rotation().matrix(), bFromA.translation();
+
+      Eigen::Matrix4d A;
+      A.row(0) = a.x * PA.row(2) - PA.row(0);
+      A.row(1) = a.y * PA.row(2) - PA.row(1);
+      A.row(2) = b.x * PB.row(2) - PB.row(0);
+      A.row(3) = b.y * PB.row(2) - PB.row(1);
+      const Eigen::JacobiSVD<Eigen::Matrix4d> svd(A, Eigen::ComputeFullV);
+      const Eigen::Vector4d X = svd.matrixV().col(3);
+      if (std::abs(X(3)) < 1e-12)
+        return std::nullopt;
+      return gtsam::Point3(X.head<3>() / X(3));
+    }
+
+    double reprojectionError(const gtsam::Point3 &point, const cv::Point2f &observation) {
+      return std::hypot(point.x() / point.z() - observation.x, point.y() / point.z() - observation.y);
+    }
+  }
+
+  VisualOdometry::VisualOdometry(const VisualOdometryParams &params) :
+    params_(params),
+    arena_(params.numThreads > 0 ? params.numThreads : static_cast<int>(tbb::task_arena::automatic)),
+    KLeft_(params.left.K()), distortionLeft_(params.left.distortion) {
+  }
+
+  void VisualOdometry::reset() {
+    hasPrevious_ = false;
+    timestampPrevious_ = 0.;
+    pyramidPrevious_.clear();
+    features_.clear();
+  }
+
+  cv::Mat VisualOdometry::toGray8(const cv::Mat &image) {
+    cv::Mat gray;
+    if (image.channels() == 3)
+      cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    else if (image.channels() == 4)
+      cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    else
+      gray = image;
+
+    if (gray.depth() == CV_8U)
+      return gray;
+
+    double minValue = 0., maxValue = 0.;
+    cv::minMaxLoc(gray, &minValue, &maxValue);
+    const auto range = std::max(maxValue - minValue, 1e-9);
+    cv::Mat gray8;
+    gray.convertTo(gray8, CV_8U, 255. / range, -minValue * 255. / range);
+    return gray8;
+  }
+
+  std::vector<cv::Mat> VisualOdometry::buildPyramid(const cv::Mat &image) const {
+    std::vector<cv::Mat> pyramid;
+    cv::buildOpticalFlowPyramid(image, pyramid, cv::Size(params_.kltWindowSize, params_.kltWindowSize),
+                                params_.kltPyramidLevels);
+    return pyramid;
+  }
+
+  std::vector<cv::Point2f> VisualOdometry::undistort(const std::vector<cv::Point2f> &pixels,
+                                                     const CameraIntrinsics &intrinsics) {
+    std::vector<cv::Point2f> normalized;
+    if (pixels.empty())
+      return normalized;
+    cv::undistortPoints(pixels, normalized, intrinsics.K(), intrinsics.distortion);
+    return normalized;
+  }
+
+  std::vector<uchar> VisualOdometry::track(const std::vector<cv::Mat> &pyramidFrom,
+                                           const std::vector<cv::Mat> &pyramidTo,
+                                           const std::vector<cv::Point2f> &from,
+                                           std::vector<cv::Point2f> &to) const {
+    std::vector<uchar> status(from.size(), 0);
+    if (from.empty())
+      return status;
+    if (to.size() != from.size())
+      to = from;
+
+    const cv::Size window(params_.kltWindowSize, params_.kltWindowSize);
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01);
+    std::vector<uchar> statusBackward;
+    std::vector<float> error;
+    cv::calcOpticalFlowPyrLK(pyramidFrom, pyramidTo, from, to, status, error, window, params_.kltPyramidLevels,
+                             criteria, cv::OPTFLOW_USE_INITIAL_FLOW);
+    auto backward = from;
+    cv::calcOpticalFlowPyrLK(pyramidTo, pyramidFrom, to, backward, statusBackward, error, window,
+                             params_.kltPyramidLevels, criteria, cv::OPTFLOW_USE_INITIAL_FLOW);
+
+    const auto &image = pyramidTo.front();
+    for (size_t i = 0; i < from.size(); i++) {
+      const auto &pt = to[i];
+      status[i] = status[i] && statusBackward[i] &&
+                  cv::norm(backward[i] - from[i]) <= params_.kltMaxForwardBackwardError &&
+                  pt.x >= 0.f && pt.y >= 0.f && pt.x < static_cast<float>(image.cols) &&
+                  pt.y < static_cast<float>(image.rows);
+    }
+    return status;
+  }
+
+  std::vector<cv::Point2f> VisualOdometry::detect(const cv::Mat &image, const std::vector<Feature> &existing) const {
+    std::vector<cv::Point2f> detected;
+    const auto numRequired = params_.maxFeatures - static_cast<int>(existing.size());
+    if (numRequired <= 0)
+      return detected;
+
+    const auto numCells = params_.gridRows * params_.gridCols;
+    const auto numPerCell = std::max(1, (numRequired + numCells - 1) / numCells);
+    const auto cellWidth = image.cols / params_.gridCols;
+    const auto cellHeight = image.rows / params_.gridRows;
+    // the detectors skip the border of an image, the cells are detected with a margin so that no gaps are left
+    const auto margin = params_.detector == FeatureDetectorType::ORB ? 31 : 3;
+
+    std::vector<std::vector<cv::KeyPoint>> cellKeypoints(numCells);
+    arena_.execute([&]() {
+      tbb::parallel_for(tbb::blocked_range<int>(0, numCells), [&](const tbb::blocked_range<int> &range) {
+        for (int cell = range.begin(); cell != range.end(); cell++) {
+          const cv::Rect core((cell % params_.gridCols) * cellWidth, (cell / params_.gridCols) * cellHeight,
+                              cellWidth, cellHeight);
+          const cv::Rect roi = cv::Rect(core.x - margin, core.y - margin, core.width + 2 * margin,
+                                        core.height + 2 * margin) & cv::Rect(0, 0, image.cols, image.rows);
+          std::vector<cv::KeyPoint> keypoints;
+          if (params_.detector == FeatureDetectorType::ORB) {
+            auto orb = cv::ORB::create(numPerCell * 2, 1.2f, 1, margin, 0, 2, cv::ORB::HARRIS_SCORE, margin,
+                                       params_.fastThreshold);
+            orb->detect(image(roi), keypoints);
+          } else
+            cv::FAST(image(roi), keypoints, params_.fastThreshold, true);
+
+          auto &cellKps = cellKeypoints[cell];
+          for (auto &kp: keypoints) {
+            kp.pt += cv::Point2f(static_cast<float>(roi.x), static_cast<float>(roi.y));
+            if (core.contains(cv::Point(cvRound(kp.pt.x), cvRound(kp.pt.y))))
+              cellKps.emplace_back(kp);
+          }
+          std::sort(cellKps.begin(), cellKps.end(), [](const cv::KeyPoint &a, const cv::KeyPoint &b) -> bool {
+            return a.response > b.response;
+          });
+        }
+      });
+    });
+
+    // enforce the min. distance to the tracked and the newly selected features
+    const auto radius = static_cast<int>(params_.minFeatureDistance);
+    cv::Mat mask(image.size(), CV_8UC1, cv::Scalar(255));
+    for (const auto &feature: existing)
+      cv::circle(mask, feature.pixel, radius, cv::Scalar(0), -1);
+
+    for (const auto &keypoints: cellKeypoints) {
+      int numSelected = 0;
+      for (const auto &kp: keypoints) {
+        if (numSelected >= numPerCell)
+          break;
+        const cv::Point pt(cvRound(kp.pt.x), cvRound(kp.pt.y));
+        if (pt.x < 0 || pt.y < 0 || pt.x >= mask.cols || pt.y >= mask.rows || !mask.at<uchar>(pt))
+          continue;
+        detected.emplace_back(kp.pt);
+        cv::circle(mask, pt, radius, cv::Scalar(0), -1);
+        numSelected++;
+      }
+    }
+    return detected;
+  }
+
+  void VisualOdometry::triangulate(const std::vector<cv::Mat> &pyramidLeft, const std::vector<cv::Mat> &pyramidRight) {
+    std::vector<cv::Point2f> pixelsLeft;
+    pixelsLeft.reserve(features_.size());
+    for (auto &feature: features_) {
+      feature.hasPoint = false;
+      pixelsLeft.emplace_back(feature.pixel);
+    }
+    std::vector<cv::Point2f> pixelsRight;
+    const auto status = track(pyramidLeft, pyramidRight, pixelsLeft, pixelsRight);
+    const auto normalizedLeft = undistort(pixelsLeft, params_.left);
+    const auto normalizedRight = undistort(pixelsRight, params_.right);
+    const auto maxErrorLeft = params_.maxStereoReprojectionError / params_.left.fx;
+    const auto maxErrorRight = params_.maxStereoReprojectionError / params_.right.fx;
+
+    for (size_t i = 0; i < features_.size(); i++) {
+      if (!status[i])
+        continue;
+      const auto point = triangulateLinear(normalizedLeft[i], normalizedRight[i], params_.rightFromLeft);
+      if (!point || point->z() < params_.minDepth || point->z() > params_.maxDepth)
+        continue;
+      const auto pointRight = params_.rightFromLeft.transformFrom(*point);
+      if (pointRight.z() <= 0. ||
+          reprojectionError(*point, normalizedLeft[i]) > maxErrorLeft ||
+          reprojectionError(pointRight, normalizedRight[i]) > maxErrorRight)
+        continue;
+      features_[i].point = cv::Point3f(static_cast<float>(point->x()), static_cast<float>(point->y()),
+                                       static_cast<float>(point->z()));
+      features_[i].hasPoint = true;
+    }
+  }
+
+  gtsam::Matrix6 VisualOdometry::reprojectionCovariance(const std::vector<gtsam::Point3> &points, double sigma) {
+    // the current camera is perturbed with T^{prev}_{cur} * Exp(xi), so a point p in it changes with [ [p]x, -I ]
+    gtsam::Matrix6 information = gtsam::Matrix6::Identity() * 1e-9;
+    for (const auto &p: points) {
+      const auto invZ = 1. / p.z();
+      Eigen::Matrix<double, 2, 3> JProjection;
+      JProjection << invZ, 0., -p.x() * invZ * invZ,
+        0., invZ, -p.y() * invZ * invZ;
+      Eigen::Matrix<double, 3, 6> JPoint;
+      JPoint << gtsam::skewSymmetric(p), -gtsam::I_3x3;
+      const Eigen::Matrix<double, 2, 6> J = JProjection * JPoint;
+      information.noalias() += J.transpose() * J;
+    }
+    return (information / (sigma * sigma)).inverse();
+  }
+
+  std::optional<VisualOdometryResult> VisualOdometry::solveStereo(const std::vector<Feature> &previous,
+                                                                  const std::vector<cv::Point2f> &tracked,
+                                                                  std::vector<uchar> &inliers) const {
+    std::vector<cv::Point3f> objectPoints;
+    std::vector<cv::Point2f> imagePoints;
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < previous.size(); i++) {
+      if (!previous[i].hasPoint)
+        continue;
+      objectPoints.emplace_back(previous[i].point);
+      imagePoints.emplace_back(tracked[i]);
+      indices.emplace_back(i);
+    }
+    if (static_cast<int>(objectPoints.size()) < params_.minInliers)
+      return std::nullopt;
+
+    cv::Mat rvec, tvec;
+    std::vector<int> inlierIndices;
+    if (!cv::solvePnPRansac(objectPoints, imagePoints, KLeft_, distortionLeft_, rvec, tvec, false,
+                            params_.ransacIterations, static_cast<float>(params_.ransacReprojectionThreshold),
+                            params_.ransacConfidence, inlierIndices, cv::SOLVEPNP_ITERATIVE) ||
+        static_cast<int>(inlierIndices.size()) < params_.minInliers)
+      return std::nullopt;
+
+    cv::Matx33d R;
+    cv::Rodrigues(rvec, R);
+    const gtsam::Pose3 curFromPrev(gtsam::Rot3(R(0, 0), R(0, 1), R(0, 2), R(1, 0), R(1, 1), R(1, 2),
+                                               R(2, 0), R(2, 1), R(2, 2)),
+                                   gtsam::Point3(tvec.at<double>(0), tvec.at<double>(1), tvec.at<double>(2)));
+
+    // features with a point which are not consistent with the pose are outliers, the others are kept
+    for (const auto &i: indices)
+      inliers[i] = 0;
+    std::vector<gtsam::Point3> inlierPoints;
+    inlierPoints.reserve(inlierIndices.size());
+    for (const auto &idx: inlierIndices) {
+      const auto &i = indices[static_cast<size_t>(idx)];
+      inliers[i] = 1;
+      const auto &pt = previous[i].point;
+      const auto pointCur = curFromPrev.transformFrom(gtsam::Point3(pt.x, pt.y, pt.z));
+      if (pointCur.z() > 0.)
+        inlierPoints.emplace_back(pointCur);
+    }
+
+    VisualOdometryResult result;
+    result.poseRelative = curFromPrev.inverse();
+    result.covariance = reprojectionCovariance(inlierPoints, params_.pixelSigma / params_.left.fx);
+    result.numInliers = inlierIndices.size();
+    return result;
+  }
+
+  std::optional<VisualOdometryResult> VisualOdometry::solveMono(const std::vector<Feature> &previous,
+                                                                const std::vector<cv::Point2f> &tracked,
+                                                                std::vector<uchar> &inliers) const {
+    if (static_cast<int>(previous.size()) < params_.minInliers)
+      return std::nullopt;
+    std::vector<cv::Point2f> pixelsPrevious;
+    pixelsPrevious.reserve(previous.size());
+    for (const auto &feature: previous)
+      pixelsPrevious.emplace_back(feature.pixel);
+    const auto normalizedPrevious = undistort(pixelsPrevious, params_.left);
+    const auto normalizedCurrent = undistort(tracked, params_.left);
+
+    const auto threshold = params_.ransacReprojectionThreshold / params_.left.fx;
+    cv::Mat mask;
+    const cv::Mat E = cv::findEssentialMat(normalizedPrevious, normalizedCurrent, 1., cv::Point2d(0., 0.),
+                                           cv::RANSAC, params_.ransacConfidence, threshold, mask);
+    if (E.rows != 3 || E.cols != 3)  // degenerate or multiple solutions
+      return std::nullopt;
+    cv::Mat R, t;
+    const auto numInliers = cv::recoverPose(E, normalizedPrevious, normalizedCurrent, R, t, 1., cv::Point2d(0., 0.),
+                                            mask);
+    if (numInliers < params_.minInliers)
+      return std::nullopt;
+
+    const gtsam::Pose3 curFromPrev(gtsam::Rot3(R.at<double>(0, 0), R.at<double>(0, 1), R.at<double>(0, 2),
+                                               R.at<double>(1, 0), R.at<double>(1, 1), R.at<double>(1, 2),
+                                               R.at<double>(2, 0), R.at<double>(2, 1), R.at<double>(2, 2)),
+                                   gtsam::Point3(t.at<double>(0), t.at<double>(1), t.at<double>(2)));
+
+    // the inliers are triangulated with the unit baseline for the covariance
+    std::vector<gtsam::Point3> inlierPoints;
+    for (size_t i = 0; i < previous.size(); i++) {
+      inliers[i] = mask.at<uchar>(static_cast<int>(i)) ? 1 : 0;
+      if (!inliers[i])
+        continue;
+      const auto point = triangulateLinear(normalizedPrevious[i], normalizedCurrent[i], curFromPrev);
+      if (!point || point->z() <= 0.)
+        continue;
+      const auto pointCur = curFromPrev.transformFrom(*point);
+      if (pointCur.z() > 0.)
+        inlierPoints.emplace_back(pointCur);
+    }
+
+    VisualOdometryResult result;
+    result.poseRelative = curFromPrev.inverse();
+    result.covariance = reprojectionCovariance(inlierPoints, params_.pixelSigma / params_.left.fx);
+    result.scaleObservable = false;
+    result.numInliers = static_cast<size_t>(numInliers);
+    return result;
+  }
+
+  std::optional<VisualOdometryResult> VisualOdometry::process(double timestamp, const cv::Mat &left,
+                                                              const cv::Mat &right) {
+    if (left.empty())
+      return std::nullopt;
+    const bool useStereo = params_.stereo && !right.empty();
+
+    std::vector<cv::Mat> pyramidLeft, pyramidRight;
+    arena_.execute([&]() {
+      tbb::parallel_invoke([&]() { pyramidLeft = buildPyramid(toGray8(left)); },
+                           [&]() { if (useStereo) pyramidRight = buildPyramid(toGray8(right)); });
+    });
+
+    std::optional<VisualOdometryResult> result;
+    if (hasPrevious_ && !features_.empty()) {
+      std::vector<cv::Point2f> pixelsPrevious, pixelsCurrent;
+      pixelsPrevious.reserve(features_.size());
+      for (const auto &feature: features_)
+        pixelsPrevious.emplace_back(feature.pixel);
+      const auto status = track(pyramidPrevious_, pyramidLeft, pixelsPrevious, pixelsCurrent);
+
+      std::vector<Feature> previous;
+      std::vector<cv::Point2f> tracked;
+      for (size_t i = 0; i < features_.size(); i++) {
+        if (!status[i])
+          continue;
+        previous.emplace_back(features_[i]);
+        tracked.emplace_back(pixelsCurrent[i]);
+      }
+
+      std::vector<uchar> inliers(previous.size(), 1);
+      result = params_.stereo ? solveStereo(previous, tracked, inliers) : solveMono(previous, tracked, inliers);
+      if (result) {
+        result->timestampPrevious = timestampPrevious_;
+        result->timestampCurrent = timestamp;
+        result->numTracked = tracked.size();
+      }
+
+      features_.clear();
+      for (size_t i = 0; i < previous.size(); i++) {
+        if (result && !inliers[i])
+          continue;
+        auto &feature = features_.emplace_back();
+        feature.pixel = tracked[i];
+      }
+    } else
+      features_.clear();
+
+    if (static_cast<int>(features_.size()) < params_.minTrackedFeatures) {
+      for (const auto &pixel: detect(pyramidLeft.front(), features_)) {
+        auto &feature = features_.emplace_back();
+        feature.pixel = pixel;
+      }
+    }
+
+    if (useStereo)
+      triangulate(pyramidLeft, pyramidRight);
+
+    pyramidPrevious_ = std::move(pyramidLeft);
+    timestampPrevious_ = timestamp;
+    hasPrevious_ = true;
+    return result;
+  }
+}
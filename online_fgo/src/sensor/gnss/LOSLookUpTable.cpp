@@ -0,0 +1,270 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <rclcpp/rclcpp.hpp>
+#include "sensor/gnss/LOSLookUpTable.h"
+#include "utils/rapidcsv.h"
+
+namespace fgo::sensor::gnss {
+
+  namespace {
+    constexpr char BinaryMagic[8] = {'F', 'G', 'O', 'L', 'O', 'S', '0', '2'};
+
+    // size and modification time [ns] of the CSV file a binary table has been converted from, zero if unknown
+    struct SourceStamp {
+      uint64_t size = 0;
+      int64_t modified = 0;
+
+      bool operator==(const SourceStamp &other) const {
+        return size == other.size && modified == other.modified;
+      }
+    };
+
+    struct BinaryHeader {
+      char magic[8];
+      uint32_t epochSize;
+      uint32_t maxPRN;
+      uint64_t numEpochs;
+      SourceStamp source;
+    };
+
+    std::optional<SourceStamp> sourceStampOf(const std::string &path) {
+      struct stat fileStat{};
+      if (::stat(path.c_str(), &fileStat) != 0)
+        return std::nullopt;
+      return SourceStamp{static_cast<uint64_t>(fileStat.st_size),
+                         static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec};
+    }
+
+    std::optional<BinaryHeader> readBinaryHeader(const std::string &path) {
+      std::FILE *file = std::fopen(path.c_str(), "rb");
+      if (!file)
+        return std::nullopt;
+      BinaryHeader header{};
+      const auto read = std::fread(&header, sizeof(header), 1, file);
+      std::fclose(file);
+      if (read != 1 || std::memcmp(header.magic, BinaryMagic, sizeof(BinaryMagic)) != 0)
+        return std::nullopt;
+      return header;
+    }
+
+    bool hasBinaryMagic(const std::string &path) {
+      return readBinaryHeader(path).has_value();
+    }
+
+    // the binary table has been converted from exactly this version of the CSV file
+    bool isConvertedFrom(const std::string &binaryPath, const std::string &sourcePath) {
+      const auto header = readBinaryHeader(binaryPath);
+      const auto source = sourceStampOf(sourcePath);
+      return header && source && header->source == *source;
+    }
+  }
+
+  LOSLookUpTable::~LOSLookUpTable() {
+    unmap();
+  }
+
+  void LOSLookUpTable::clear() {
+    unmap();
+    storage_.clear();
+    storage_.shrink_to_fit();
+    epochs_ = nullptr;
+    numEpochs_ = 0;
+    firstBucket_ = 0;
+    bucketBegin_.clear();
+  }
+
+  void LOSLookUpTable::unmap() {
+    if (mappedData_)
+      ::munmap(mappedData_, mappedSize_);
+    mappedData_ = nullptr;
+    mappedSize_ = 0;
+  }
+
+  bool LOSLookUpTable::load(const std::string &path) {
+    if (hasBinaryMagic(path))
+      return loadBinary(path);
+
+    const auto cachePath = path + ".bin";
+    if (isConvertedFrom(cachePath, path) && loadBinary(cachePath)) {
+      RCLCPP_INFO_STREAM(rclcpp::get_logger("online_fgo"), "LOSLookUpTable: mapped " << numEpochs_
+                           << " epochs from " << cachePath);
+      return true;
+    }
+
+    if (!loadCSV(path))
+      return false;
+    if (!saveBinary(cachePath, path))
+      RCLCPP_WARN_STREAM(rclcpp::get_logger("online_fgo"), "LOSLookUpTable: can't write binary table " << cachePath);
+    return true;
+  }
+
+  bool LOSLookUpTable::loadCSV(const std::string &path) {
+    clear();
+    try {
+      rapidcsv::Document doc(path, rapidcsv::LabelParams(0, -1));
+      const auto rowNum = doc.GetRowCount();
+      std::vector<std::tuple<int32_t, uint32_t, bool>> rows;
+      rows.reserve(rowNum);
+      for (size_t i = 0; i < rowNum; i++) {
+        const auto prn = doc.GetCell<int>(1, i);
+        if (prn < 0 || prn >= static_cast<int>(MaxPRN))
+          continue;
+        rows.emplace_back(toTick(doc.GetCell<double>(0, i)), static_cast<uint32_t>(prn), doc.GetCell<int>(2, i) == 1);
+      }
+      // the CSV is usually sorted already, stable_sort keeps the first label of duplicated entries first
+      std::stable_sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+        return std::get<0>(a) < std::get<0>(b);
+      });
+
+      for (const auto &[tick, prn, isLOS]: rows) {
+        if (storage_.empty() || storage_.back().tick != tick) {
+          storage_.emplace_back();
+          storage_.back().tick = tick;
+        }
+        auto &epoch = storage_.back();
+        const uint64_t bit = uint64_t(1) << (prn % 64);
+        if (epoch.labeled[prn / 64] & bit)
+          continue;  // keep the first label as the map-based table did
+        epoch.labeled[prn / 64] |= bit;
+        if (isLOS)
+          epoch.los[prn / 64] |= bit;
+      }
+    }
+    catch (const std::exception &ex) {
+      RCLCPP_ERROR_STREAM(rclcpp::get_logger("online_fgo"), "LOSLookUpTable: can't read " << path << ": "
+                            << ex.what());
+      clear();
+      return false;
+    }
+    epochs_ = storage_.data();
+    numEpochs_ = storage_.size();
+    buildIndex();
+    return true;
+  }
+
+  bool LOSLookUpTable::loadBinary(const std::string &path) {
+    clear();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat fileStat{};
+    if (::fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(BinaryHeader)) {
+      ::close(fd);
+      return false;
+    }
+    const auto fileSize = static_cast<size_t>(fileStat.st_size);
+    void *data = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+      return false;
+
+    BinaryHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    // numEpochs is compared by division, the product with the epoch size could overflow for a corrupted header
+    if (std::memcmp(header.magic, BinaryMagic, sizeof(BinaryMagic)) != 0 || header.epochSize != sizeof(Epoch) ||
+        header.maxPRN != MaxPRN || header.numEpochs > (fileSize - sizeof(BinaryHeader)) / sizeof(Epoch) ||
+        header.numEpochs > std::numeric_limits<uint32_t>::max()) {
+      ::munmap(data, fileSize);
+      return false;
+    }
+    const auto epochs = reinterpret_cast<const Epoch *>(static_cast<const char *>(data) + sizeof(BinaryHeader));
+    // the bucket index requires strictly increasing ticks as written by saveBinary()
+    const auto epochsEnd = epochs + header.numEpochs;
+    if (std::adjacent_find(epochs, epochsEnd, [](const Epoch &a, const Epoch &b) {
+      return a.tick >= b.tick;
+    }) != epochsEnd) {
+      RCLCPP_WARN_STREAM(rclcpp::get_logger("online_fgo"), "LOSLookUpTable: epochs in " << path << " are not sorted");
+      ::munmap(data, fileSize);
+      return false;
+    }
+    ::madvise(data, fileSize, MADV_WILLNEED);
+    mappedData_ = data;
+    mappedSize_ = fileSize;
+    epochs_ = epochs;
+    numEpochs_ = header.numEpochs;
+    buildIndex();
+    return true;
+  }
+
+  bool LOSLookUpTable::saveBinary(const std::string &path, const std::string &sourcePath) const {
+    BinaryHeader header{};
+    std::memcpy(header.magic, BinaryMagic, sizeof(BinaryMagic));
+    header.epochSize = sizeof(Epoch);
+    header.maxPRN = MaxPRN;
+    header.numEpochs = numEpochs_;
+    if (!sourcePath.empty()) {
+      const auto source = sourceStampOf(sourcePath);
+      if (!source)
+        return false;
+      header.source = *source;
+    }
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+      return false;
+    bool success = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (success && numEpochs_ > 0)
+      success = std::fwrite(epochs_, sizeof(Epoch), numEpochs_, file) == numEpochs_;
+    success &= std::fclose(file) == 0;
+    return success;
+  }
+
+  void LOSLookUpTable::buildIndex() {
+    bucketBegin_.clear();
+    if (numEpochs_ == 0)
+      return;
+    const auto bucketOf = [](int32_t tick) {
+      return tick >= 0 ? tick / BucketWidth : -((-tick + BucketWidth - 1) / BucketWidth);
+    };
+    firstBucket_ = bucketOf(epochs_[0].tick);
+    const auto numBuckets = static_cast<size_t>(bucketOf(epochs_[numEpochs_ - 1].tick) - firstBucket_ + 1);
+    bucketBegin_.resize(numBuckets + 1);
+    size_t epochIndex = 0;
+    for (size_t bucket = 0; bucket <= numBuckets; bucket++) {
+      const auto bucketStartTick = (firstBucket_ + static_cast<int32_t>(bucket)) * BucketWidth;
+      while (epochIndex < numEpochs_ && epochs_[epochIndex].tick < bucketStartTick)
+        epochIndex++;
+      bucketBegin_[bucket] = static_cast<uint32_t>(epochIndex);
+    }
+  }
+
+  const LOSLookUpTable::Epoch *LOSLookUpTable::findEpoch(double tow) const {
+    if (numEpochs_ == 0)
+      return nullptr;
+    const auto tick = toTick(tow);
+    const auto bucketTick = tick >= 0 ? tick / BucketWidth : -((-tick + BucketWidth - 1) / BucketWidth);
+    const auto bucket = static_cast<int64_t>(bucketTick) - firstBucket_;
+    if (bucket < 0 || bucket + 1 >= static_cast<int64_t>(bucketBegin_.size()))
+      return nullptr;
+    // a bucket holds at most BucketWidth epochs
+    for (auto i = bucketBegin_[bucket]; i < bucketBegin_[bucket + 1]; i++) {
+      if (epochs_[i].tick == tick)
+        return &epochs_[i];
+    }
+    return nullptr;
+  }
+}
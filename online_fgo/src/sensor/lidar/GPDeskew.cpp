@@ -0,0 +1,344 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "model/gp_interpolator/GPWNOAInterpolator.h"
+#include "model/gp_interpolator/GPWNOJInterpolator.h"
+#include "model/gp_interpolator/GPSingerInterpolator.h"
+#include "sensor/lidar/GPDeskew.h"
+
+namespace sensors::LiDAR::LIOSAM
+{
+  namespace {
+    bool hasField(const sensor_msgs::msg::PointCloud2 &cloud, const std::string &name) {
+      return std::any_of(cloud.fields.begin(), cloud.fields.end(),
+                         [&name](const sensor_msgs::msg::PointField &field) { return field.name == name; });
+    }
+  }
+
+  GPDeskew::GPDeskew(const GPDeskewParams &params, fgo::integrator::param::IntegratorBaseParamsPtr gpParamPtr,
+                     const gtsam::Pose3 &imuTl) :
+    params_(params), gpParamPtr_(std::move(gpParamPtr)), imuTl_(imuTl),
+    arena_(params.numThreads > 0 ? params.numThreads : static_cast<int>(tbb::task_arena::automatic)) {
+    params_.binDuration = std::max(1e-4, params_.binDuration);
+    params_.downsampleRate = std::max(1, params_.downsampleRate);
+  }
+
+  std::vector<GPDeskew::RawPoint> GPDeskew::projectCloud(const sensor_msgs::msg::PointCloud2 &cloud) const {
+    // the ouster cloud is converted into the velodyne format as in LIO-SAM
+    pcl::PointCloud<VelodynePointXYZIRT> raw;
+    if (params_.sensor == SensorType::OUSTER) {
+      pcl::PointCloud<OusterPointXYZIRT> ouster;
+      pcl::fromROSMsg(cloud, ouster);
+      raw.points.resize(ouster.size());
+      for (size_t i = 0; i < ouster.size(); i++) {
+        const auto &src = ouster.points[i];
+        auto &dst = raw.points[i];
+        dst.x = src.x;
+        dst.y = src.y;
+        dst.z = src.z;
+        dst.intensity = src.intensity;
+        dst.ring = src.ring;
+        dst.time = static_cast<float>(src.t * 1e-9);
+      }
+    } else
+      pcl::fromROSMsg(cloud, raw);
+
+    const float angleResolution = 360.f / static_cast<float>(params_.Horizon_SCAN);
+    std::vector<bool> occupied(params_.N_SCAN * params_.Horizon_SCAN, false);
+    std::vector<RawPoint> points;
+    points.reserve(raw.size());
+    for (const auto &p: raw.points) {
+      const Eigen::Vector3f point(p.x, p.y, p.z);
+      const float range = point.norm();
+      if (!std::isfinite(range) || range < params_.lidarMinRange || range > params_.lidarMaxRange)
+        continue;
+
+      const int row = p.ring;
+      if (row < 0 || row >= params_.N_SCAN || row % params_.downsampleRate != 0)
+        continue;
+
+      const float horizonAngle = std::atan2(p.x, p.y) * 180.f / static_cast<float>(M_PI);
+      int column = -static_cast<int>(std::round((horizonAngle - 90.f) / angleResolution)) + params_.Horizon_SCAN / 2;
+      if (column >= params_.Horizon_SCAN)
+        column -= params_.Horizon_SCAN;
+      if (column < 0 || column >= params_.Horizon_SCAN)
+        continue;
+
+      const int index = column + row * params_.Horizon_SCAN;
+      if (occupied[index])
+        continue;
+      occupied[index] = true;
+      points.push_back({point, p.intensity, range, index, static_cast<double>(p.time)});
+    }
+    return points;
+  }
+
+  std::shared_ptr<fgo::models::GPInterpolator> GPDeskew::createInterpolator() const {
+    const auto Qc = gtsam::noiseModel::Diagonal::Variances(gpParamPtr_->QcGPInterpolatorFull);
+    switch (gpParamPtr_->gpType) {
+      case fgo::data::GPModelType::WNOJ:
+      case fgo::data::GPModelType::WNOJFull:
+        return std::make_shared<fgo::models::GPWNOJInterpolator>(Qc, 0, 0, false, false);
+      case fgo::data::GPModelType::Singer:
+      case fgo::data::GPModelType::SingerFull:
+        return std::make_shared<fgo::models::GPSingerInterpolator>(Qc, gpParamPtr_->ad, 0, 0, false, false);
+      default:
+        return std::make_shared<fgo::models::GPWNOAInterpolator>(Qc, 0, 0, false, false);
+    }
+  }
+
+  std::optional<gtsam::Pose3> GPDeskew::queryPose(double timestamp, const GPDeskewStates &states,
+                                                  bool &fromOptimized) const {
+    fromOptimized = false;
+    const auto &optimized = states.optimized;
+    if (!optimized.empty()) {
+      const auto iterJ = optimized.lower_bound(timestamp);
+      if (iterJ == optimized.begin() && timestamp < iterJ->first)
+        return std::nullopt;  // before the window
+
+      if (iterJ != optimized.end()) {
+        fromOptimized = true;
+        if (iterJ->first == timestamp)
+          return iterJ->second.pose;
+
+        const auto iterI = std::prev(iterJ);
+        const auto &stateI = iterI->second;
+        const auto &stateJ = iterJ->second;
+        const double deltaT = iterJ->first - iterI->first;
+        const double tau = timestamp - iterI->first;
+
+        const auto interpolator = createInterpolator();
+        switch (gpParamPtr_->gpType) {
+          case fgo::data::GPModelType::WNOJ:
+          case fgo::data::GPModelType::WNOJFull:
+            interpolator->recalculate(deltaT, tau, stateI.acc, stateJ.acc);
+            break;
+          case fgo::data::GPModelType::Singer:
+          case fgo::data::GPModelType::SingerFull:
+            interpolator->recalculate(deltaT, tau, gpParamPtr_->ad, stateI.acc, stateJ.acc);
+            break;
+          default:
+            interpolator->recalculate(deltaT, tau);
+        }
+        return interpolator->interpolatePose(stateI.pose, stateI.vel, stateI.omega,
+                                             stateJ.pose, stateJ.vel, stateJ.omega);
+      }
+    }
+
+    // head of the window after the last optimized state, IMU propagation
+    const auto &propagated = states.propagated;
+    if (propagated.empty())
+      return std::nullopt;
+
+    const auto iterAfter = std::lower_bound(propagated.begin(), propagated.end(), timestamp,
+                                            [](const std::pair<rclcpp::Time, fgo::data::State> &pair, double t) {
+                                              return pair.first.seconds() < t;
+                                            });
+    if (iterAfter == propagated.end()) {
+      // extrapolated with the velocity of the last propagated state
+      const auto &[timeLast, stateLast] = propagated.back();
+      const double dt = timestamp - timeLast.seconds();
+      if (dt > params_.maxExtrapolation)
+        return std::nullopt;
+      const gtsam::Vector6 twist = (gtsam::Vector6() << stateLast.omega, stateLast.state.bodyVelocity()).finished();
+      return stateLast.state.pose().compose(gtsam::Pose3::Expmap(twist * dt));
+    }
+
+    if (iterAfter == propagated.begin()) {
+      if (iterAfter->first.seconds() - timestamp > params_.binDuration)
+        return std::nullopt;
+      return iterAfter->second.state.pose();
+    }
+
+    const auto iterBefore = std::prev(iterAfter);
+    const double timeBefore = iterBefore->first.seconds();
+    const double timeAfter = iterAfter->first.seconds();
+    const double alpha = timeAfter > timeBefore ? (timestamp - timeBefore) / (timeAfter - timeBefore) : 0.;
+    return iterBefore->second.state.pose().interpolateRt(iterAfter->second.state.pose(), alpha);
+  }
+
+  std::optional<lio_sam::msg::CloudInfo> GPDeskew::process(const sensor_msgs::msg::PointCloud2 &cloud,
+                                                           const GPDeskewStates &states,
+                                                           GPDeskewReport &report) const {
+    report = GPDeskewReport();
+    if (!hasField(cloud, params_.sensor == SensorType::OUSTER ? "t" : "time") || !hasField(cloud, "ring")) {
+      RCLCPP_ERROR(rclcpp::get_logger("online_fgo"),
+                   "GPDeskew: the point cloud has no per point timestamp or ring, it can't be deskewed!");
+      return std::nullopt;
+    }
+
+    const auto points = projectCloud(cloud);
+    if (points.empty())
+      return std::nullopt;
+    report.numPoints = points.size();
+
+    const double scanTimestamp = rclcpp::Time(cloud.header.stamp, RCL_ROS_TIME).seconds();
+    const auto [minPoint, maxPoint] = std::minmax_element(points.begin(), points.end(),
+                                                          [](const RawPoint &a, const RawPoint &b) {
+                                                            return a.time < b.time;
+                                                          });
+    const double timeStart = minPoint->time;
+    const double timeSpan = maxPoint->time - timeStart;
+    const auto numBins = std::max<size_t>(1, static_cast<size_t>(std::ceil(timeSpan / params_.binDuration)));
+    const double binDuration = timeSpan > 0. ? timeSpan / static_cast<double>(numBins) : params_.binDuration;
+    report.numBins = numBins;
+
+    // poses on the edges of the bins, the reference is the timestamp of the scan
+    bool referenceOptimized = false;
+    const auto poseReference = queryPose(scanTimestamp, states, referenceOptimized);
+    if (!poseReference)
+      return std::nullopt;
+
+    std::vector<std::optional<gtsam::Pose3>> posesEdge(numBins + 1);
+    std::vector<char> edgeOptimized(numBins + 1, 0);
+    arena_.execute([&]() {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, numBins + 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t k = range.begin(); k < range.end(); k++) {
+          bool fromOptimized = false;
+          posesEdge[k] = queryPose(scanTimestamp + timeStart + static_cast<double>(k) * binDuration, states,
+                                   fromOptimized);
+          edgeOptimized[k] = fromOptimized;
+        }
+      });
+    });
+
+    // relative poses of the LiDAR to its pose at the timestamp of the scan
+    const auto lidarReferenceInv = poseReference->compose(imuTl_).inverse();
+    std::vector<Eigen::Matrix3f> rotations(numBins + 1);
+    std::vector<Eigen::Vector3f> translations(numBins + 1);
+    for (size_t k = 0; k <= numBins; k++) {
+      if (!posesEdge[k])
+        return std::nullopt;
+      const auto poseRelative = lidarReferenceInv.compose(posesEdge[k]->compose(imuTl_));
+      rotations[k] = poseRelative.rotation().matrix().cast<float>();
+      translations[k] = poseRelative.translation().cast<float>();
+      if (k < numBins) {
+        if (edgeOptimized[k])
+          report.numBinsOptimized++;
+        else
+          report.numBinsPropagated++;
+      }
+    }
+
+    // the points are sorted into the bins
+    std::vector<size_t> binOfPoint(points.size());
+    std::vector<size_t> binOffsets(numBins + 1, 0);
+    for (size_t i = 0; i < points.size(); i++) {
+      const auto bin = std::min(numBins - 1, static_cast<size_t>((points[i].time - timeStart) / binDuration));
+      binOfPoint[i] = bin;
+      binOffsets[bin + 1]++;
+    }
+    for (size_t b = 0; b < numBins; b++)
+      binOffsets[b + 1] += binOffsets[b];
+    std::vector<size_t> order(points.size());
+    std::vector<size_t> fill(binOffsets.begin(), binOffsets.end() - 1);
+    for (size_t i = 0; i < points.size(); i++)
+      order[fill[binOfPoint[i]]++] = i;
+
+    // each bin is transformed with the poses of both edges as one batch and blended linearly
+    Eigen::Matrix3Xf deskewed(3, points.size());
+    arena_.execute([&]() {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, numBins), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t b = range.begin(); b < range.end(); b++) {
+          const size_t begin = binOffsets[b];
+          const auto size = static_cast<Eigen::Index>(binOffsets[b + 1] - begin);
+          if (size == 0)
+            continue;
+
+          const double timeBin = timeStart + static_cast<double>(b) * binDuration;
+          Eigen::Matrix3Xf batch(3, size);
+          Eigen::RowVectorXf alpha(size);
+          for (Eigen::Index i = 0; i < size; i++) {
+            const auto &point = points[order[begin + i]];
+            batch.col(i) = point.point;
+            alpha(i) = static_cast<float>(std::clamp((point.time - timeBin) / binDuration, 0., 1.));
+          }
+
+          const Eigen::Matrix3Xf pointsStart = (rotations[b] * batch).colwise() + translations[b];
+          const Eigen::Matrix3Xf pointsEnd = (rotations[b + 1] * batch).colwise() + translations[b + 1];
+          const Eigen::Matrix3Xf blended =
+            pointsStart + ((pointsEnd - pointsStart).array().rowwise() * alpha.array()).matrix();
+          for (Eigen::Index i = 0; i < size; i++)
+            deskewed.col(order[begin + i]) = blended.col(i);
+        }
+      });
+    });
+
+    // cloud info in the order of the range image as in the image projection of LIO-SAM
+    std::vector<int> pointOfPixel(params_.N_SCAN * params_.Horizon_SCAN, -1);
+    for (size_t i = 0; i < points.size(); i++)
+      pointOfPixel[points[i].index] = static_cast<int>(i);
+
+    lio_sam::msg::CloudInfo cloudInfo;
+    cloudInfo.header = cloud.header;
+    cloudInfo.header.frame_id = params_.lidarFrame;
+    cloudInfo.start_ring_index.assign(params_.N_SCAN, 0);
+    cloudInfo.end_ring_index.assign(params_.N_SCAN, 0);
+    cloudInfo.point_col_ind.reserve(points.size());
+    cloudInfo.point_range.reserve(points.size());
+
+    // the LiDAR pose at the timestamp of the scan in the map of LIO-SAM is the initial guess of the scan matching,
+    // its roll and pitch are blended into the result as the attitude of the IMU in the original image projection
+    cloudInfo.imu_available = false;
+    cloudInfo.odom_available = false;
+    if (states.localWorldInECEF) {
+      const auto poseLiDARLocal = states.localWorldInECEF->inverse().compose(poseReference->compose(imuTl_));
+      const auto rpy = poseLiDARLocal.rotation().rpy();
+      cloudInfo.imu_roll_init = static_cast<float>(rpy.x());
+      cloudInfo.imu_pitch_init = static_cast<float>(rpy.y());
+      cloudInfo.imu_yaw_init = static_cast<float>(rpy.z());
+      cloudInfo.imu_available = true;
+      cloudInfo.initial_guess_x = static_cast<float>(poseLiDARLocal.x());
+      cloudInfo.initial_guess_y = static_cast<float>(poseLiDARLocal.y());
+      cloudInfo.initial_guess_z = static_cast<float>(poseLiDARLocal.z());
+      cloudInfo.initial_guess_roll = cloudInfo.imu_roll_init;
+      cloudInfo.initial_guess_pitch = cloudInfo.imu_pitch_init;
+      cloudInfo.initial_guess_yaw = cloudInfo.imu_yaw_init;
+      cloudInfo.odom_available = true;
+    }
+
+    pcl::PointCloud<PointType> cloudDeskewed;
+    cloudDeskewed.reserve(points.size());
+    int count = 0;
+    for (int row = 0; row < params_.N_SCAN; row++) {
+      cloudInfo.start_ring_index[row] = count - 1 + 5;
+      for (int column = 0; column < params_.Horizon_SCAN; column++) {
+        const auto i = pointOfPixel[column + row * params_.Horizon_SCAN];
+        if (i < 0)
+          continue;
+        cloudInfo.point_col_ind.emplace_back(column);
+        cloudInfo.point_range.emplace_back(points[i].range);
+        PointType point;
+        point.x = deskewed(0, i);
+        point.y = deskewed(1, i);
+        point.z = deskewed(2, i);
+        point.intensity = points[i].intensity;
+        cloudDeskewed.push_back(point);
+        count++;
+      }
+      cloudInfo.end_ring_index[row] = count - 1 - 5;
+    }
+    pcl::toROSMsg(cloudDeskewed, cloudInfo.cloud_deskewed);
+    cloudInfo.cloud_deskewed.header = cloudInfo.header;
+    return cloudInfo;
+  }
+}
@@ -17,11 +17,14 @@
 //
 
 #include "sensor/lidar/LIOSAM.h"
+#include "utils/AsyncLogger.h"
 
 using namespace std::chrono_literals;
 
 namespace sensors::LiDAR::LIOSAM
 {
+    using fgo::utils::LogModule;
+
     void LIOSAMOdometry::laserCloudInfoHandler(const lio_sam::msg::CloudInfo::SharedPtr msg) {
       const auto timestampCloudInfo = rclcpp::Time(msg->header.stamp.sec, msg->header.stamp.nanosec, RCL_ROS_TIME);
       if(isFirstScan_)
@@ -56,23 +59,46 @@ namespace sensors::LiDAR::LIOSAM
       }
 
       if(!skipScan_ && (timestampCloudInfo.seconds() - timestampLastScan_ >= params_.mappingProcessInterval)) {
-        RCLCPP_WARN_STREAM(node_.get_logger(), "!!!!!!!!!!!!!!!!! NEW SCAN AT " << std::fixed <<timestampCloudInfo.seconds());
+        FGO_LOG_INFO(LogModule::LIDAR, "[LIOSAM]: new scan", {"at", timestampCloudInfo.seconds()});
         lidarInputBuffer_.update_buffer(*msg, timestampCloudInfo);
         timestampLastScan_ = timestampCloudInfo.seconds();
       }
     }
 
+    void LIOSAMOdometry::rawCloudHandler(const sensor_msgs::msg::PointCloud2::SharedPtr msg) {
+      const auto timestampCloud = rclcpp::Time(msg->header.stamp.sec, msg->header.stamp.nanosec, RCL_ROS_TIME);
+      GPDeskewStates states;
+      {
+        ExcutiveLockGuard lg(optPoseMutex_);
+        for (const auto &[id, timeStatePair]: optPoseIndexPairMap_)
+          states.optimized.emplace(timeStatePair.first.seconds(), timeStatePair.second);
+        if (!isFirstScan_)
+          states.localWorldInECEF = poseAnchorLocalWorldToECEF_;
+      }
+      if (propagatedStatesQuery_)
+        states.propagated = propagatedStatesQuery_();
+
+      const auto start = std::chrono::steady_clock::now();
+      GPDeskewReport report;
+      const auto cloudInfo = deskew_->process(*msg, states, report);
+      const auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if (!cloudInfo) {
+        RCLCPP_WARN_STREAM(node_.get_logger(), "LIOSAM: can't deskew the scan at " << std::fixed
+                                                 << timestampCloud.seconds() << ", the states don't cover the scan");
+        return;
+      }
+
+      FGO_LOG_DEBUG(LogModule::LIDAR, "[LIOSAM] deskewed scan", {"at", timestampCloud.seconds()},
+                    {"points", double(report.numPoints)}, {"bins", double(report.numBins)},
+                    {"binsOptimized", double(report.numBinsOptimized)},
+                    {"binsPropagated", double(report.numBinsPropagated)}, {"durationMs", duration});
+      pubDeskewedCloudInfo_->publish(*cloudInfo);
+    }
+
     void LIOSAMOdometry::processLidarInput() {
 
       while(rclcpp::ok())
       {
-          static size_t scanCounter = 1;  //
-          static bool skippedOptimization = false;
-          static nav_msgs::msg::Odometry odomIncremental;
-          static Eigen::Affine3d increOdomAffine; // incremental odometry in affine
-          static gtsam::Pose3 last_pose;
-          //static fgo::data::QueryStateOutput lastQueryStateOutput;
-          static gtsam::Pose3 lastIMUPoseTrue;
           rclcpp::sleep_for(10ms);
 
           if(isFirstScan_)
@@ -119,7 +145,8 @@ namespace sensors::LiDAR::LIOSAM
           const auto ts_processing_start = node_.now();
           thisProcessingReport.ts_start_processing = ts_processing_start.seconds();
 
-          RCLCPP_ERROR_STREAM(node_.get_logger(), "[LIOSAM]: process lidar frame at: " << std::fixed << timestampCloudInfo.seconds() << " current input size: " << lidarInputSize);
+          FGO_LOG_INFO(LogModule::LIDAR, "[LIOSAM]: process lidar frame", {"at", timestampCloudInfo.seconds()},
+                       {"inputSize", double(lidarInputSize)});
           odomInfoMsg_->header = cloudInfo.header;
 
           // extract time stamp
@@ -166,10 +193,8 @@ namespace sensors::LiDAR::LIOSAM
 
           const auto currentTimeSec = timestampCloudInfo_.seconds();
 
-          skippedOptimization = false;
-
-          RCLCPP_INFO_STREAM(node_.get_logger(), "[LIOSAM]: calculate odom for the SCAN at " << std::fixed << currentTimeSec
-                                                                                           << " . Current Map size: " << cloudKeyPoses3D_->size());
+          FGO_LOG_INFO(LogModule::LIDAR, "[LIOSAM]: calculate odom for the scan", {"at", currentTimeSec},
+                       {"mapSize", double(cloudKeyPoses3D_->size())});
           this->extractSurroundingKeyFrames();
           //RCLCPP_WARN(appPtr_.get_logger(), "ON LASER SCAN PROCESSING: Extracted surrounding key frames");
 
@@ -183,7 +208,7 @@ namespace sensors::LiDAR::LIOSAM
           thisProcessingReport.residual_information.emplace_back(deltaR);
           thisProcessingReport.residual_information.emplace_back(deltaT);
 
-          scanCounter ++;
+          scanCounter_ ++;
           if( !optimization_done) {
               RCLCPP_ERROR_STREAM(node_.get_logger(), " Invalid LIOSAM realtive pose, start again. Optimization done: " << optimization_done );
               //isFirstScan_ = true;
@@ -204,8 +229,8 @@ namespace sensors::LiDAR::LIOSAM
 
           incrementalOdometryAffineBack_ = trans2Affine3f(transformTobeMapped_);
 
-          static gtsam::Pose3 lTimu =  params_.T_lidar_in_IMU.inverse();
-          static gtsam::Rot3 imuRl = lTimu.rotation();
+          const gtsam::Pose3 lTimu =  params_.T_lidar_in_IMU.inverse();
+          const gtsam::Rot3 imuRl = lTimu.rotation();
           // lidar pose in local world frame
           gtsam::Pose3 poseFromLocal = pclPointTogtsamPose3(cloudKeyPoses6D_->points.back());
           gtsam::Pose3 poseToLocal = trans2gtsamPose(transformTobeMapped_);
@@ -301,6 +326,8 @@ namespace sensors::LiDAR::LIOSAM
 
           fgo::data::Odom odom;
           odom.noise = params_.LiDAROdomVariance;
+          odom.registrationHessian = this->registrationHessianInIMU(lTimu);
+          odom.numDegenerateDirections = numDegenerateDirections_;
           odom.poseFromLocalWorld = IMUPoseFromLocal;
           odom.poseFromECEF = poseFromECEF.transformPoseFrom(lTimu);
           odom.poseToLocalWorld = IMUPoseToLocal;
@@ -311,10 +338,11 @@ namespace sensors::LiDAR::LIOSAM
 
           odom.poseRelativeECEF = poseOdom; //gtsam::Pose3(gtsam::Rot3::RzRyRx(rpyIncreIMU), posIncreIMU); //odom.poseFromECEF.between(odom.poseToECEF);
 
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << " relative pos: " << odom.poseRelativeECEF.translation());
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << " relative pos: " << poseOdom.translation());
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << "relative ori: " << odom.poseRelativeECEF.rotation().rpy()* fgo::constants::rad2deg);
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << "relative ori: " << poseOdom.rotation().rpy() * fgo::constants::rad2deg);
+          FGO_LOG_DEBUG(LogModule::LIDAR, "[LIOSAM] relative pose", {"scan", double(scanCounter_)},
+                        {"x", poseOdom.x()}, {"y", poseOdom.y()}, {"z", poseOdom.z()},
+                        {"roll", poseOdom.rotation().roll() * fgo::constants::rad2deg},
+                        {"pitch", poseOdom.rotation().pitch() * fgo::constants::rad2deg},
+                        {"yaw", poseOdom.rotation().yaw() * fgo::constants::rad2deg});
 
 
           //odom.poseRelativeECEF = odom.poseFromECEF.between(odom.poseToECEF);
@@ -329,11 +357,13 @@ namespace sensors::LiDAR::LIOSAM
           const auto IMUPoseTo = imuStateBuffer_.get_buffer(timestampCloudInfo_).state.pose();
           const auto relativeTrue = lastQueryStateOutput_.poseIMUECEF.between(queryOutput.poseIMUECEF);
 
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << "relativePoseECEF IMU pos: " << relativeTrue.translation());
-          RCLCPP_WARN_STREAM(rclcpp::get_logger("gnss_fgo"), "[LIOSAM] scan " << scanCounter << std::fixed << "relativePoseECEF IMU ori: " << relativeTrue.rotation().rpy() * fgo::constants::rad2deg);
+          FGO_LOG_DEBUG(LogModule::LIDAR, "[LIOSAM] relative IMU pose", {"scan", double(scanCounter_)},
+                        {"x", relativeTrue.x()}, {"y", relativeTrue.y()}, {"z", relativeTrue.z()},
+                        {"roll", relativeTrue.rotation().roll() * fgo::constants::rad2deg},
+                        {"pitch", relativeTrue.rotation().pitch() * fgo::constants::rad2deg},
+                        {"yaw", relativeTrue.rotation().yaw() * fgo::constants::rad2deg});
 
           lastQueryStateOutput_ = queryOutput;
-          lastIMUPoseTrue = IMUPoseTo;
 
           timestampLastKeyPose_ = currentTimeSec;
 
@@ -344,9 +374,8 @@ namespace sensors::LiDAR::LIOSAM
               pubSensorReport_->publish(thisProcessingReport);
 
           keyPoseCounter_ ++;
-          last_pose = currentPose;
           lastOptFinished_ = false;
-          RCLCPP_WARN(node_.get_logger(), "ON LASER SCAN PROCESSING: Done");
+          FGO_LOG_INFO(LogModule::LIDAR, "[LIOSAM]: laser scan processing done");
       }
     }
 
@@ -792,6 +821,10 @@ namespace sensors::LiDAR::LIOSAM
       matAtB = matAt * matB;
       cv::solve(matAtA, matAtB, matX, cv::DECOMP_QR);
 
+      for (int i = 0; i < 6; i++)
+        for (int j = 0; j < 6; j++)
+          registrationHessian_(i, j) = matAtA.at<float>(i, j);
+
       if (iterCount == 0) {
 
         cv::Mat matE(1, 6, CV_32F, cv::Scalar::all(0));
@@ -802,13 +835,14 @@ namespace sensors::LiDAR::LIOSAM
         matV.copyTo(matV2);
 
         isDegenerate_ = false;
-        float eignThre[6] = {100., 100., 100., 100., 100., 100.};
+        numDegenerateDirections_ = 0;
         for (int i = 5; i >= 0; i--) {
-          if (matE.at<float>(0, i) < eignThre[i]) {
+          if (matE.at<float>(0, i) < params_.degeneracyEigenThreshold) {
             for (int j = 0; j < 6; j++) {
               matV2.at<float>(i, j) = 0;
             }
             isDegenerate_ = true;
+            numDegenerateDirections_++;
           } else {
             break;
           }
@@ -882,6 +916,30 @@ namespace sensors::LiDAR::LIOSAM
       return {false, deltaR, deltaT}; // keep optimizing
     }
 
+    gtsam::Matrix6 LIOSAMOdometry::registrationHessianInIMU(const gtsam::Pose3 &lTimu) const {
+      // the Hessian is of [roll, pitch, yaw, x, y, z] of transformTobeMapped_ with R = Rz(yaw) Ry(pitch) Rx(roll),
+      // the local coordinates of the LiDAR pose are xi = [R^T E d_rpy, R^T d_xyz] with the euler rates matrix E
+      const double roll = transformTobeMapped_[0], pitch = transformTobeMapped_[1], yaw = transformTobeMapped_[2];
+      if (std::abs(std::cos(pitch)) < 1e-6)
+        return gtsam::Matrix6::Zero();
+
+      const gtsam::Matrix3 Rt = gtsam::Rot3::RzRyRx(roll, pitch, yaw).matrix().transpose();
+      gtsam::Matrix3 E;
+      E << std::cos(yaw) * std::cos(pitch), -std::sin(yaw), 0.,
+           std::sin(yaw) * std::cos(pitch), std::cos(yaw), 0.,
+           -std::sin(pitch), 0., 1.;
+
+      gtsam::Matrix6 J = gtsam::Matrix6::Zero();
+      J.block<3, 3>(0, 0) = Rt * E;
+      J.block<3, 3>(3, 3) = Rt;
+      const gtsam::Matrix6 JInv = J.inverse();
+      const gtsam::Matrix6 hessianLiDAR = JInv.transpose() * registrationHessian_ * JInv;
+
+      // xi_lidar = Ad(lTimu) xi_imu for the IMU pose T_lidar * lTimu
+      const gtsam::Matrix6 adjoint = lTimu.AdjointMap();
+      return adjoint.transpose() * hessianLiDAR * adjoint;
+    }
+
     void LIOSAMOdometry::loopClosureThread() {
       this->performLoopClosure();
       this->visualizeLoopClosure();
@@ -917,7 +975,7 @@ namespace sensors::LiDAR::LIOSAM
         publishCloud(pubHistoryKeyFrames_, preKeyframeCloud, timestampCloudInfo_, params_.odometryFrame);
 
       // ICP
-      static pcl::IterativeClosestPoint<PointType , PointType> icp;
+      pcl::IterativeClosestPoint<PointType , PointType> icp;
 
       icp.setMaxCorrespondenceDistance(params_.historyKeyframeSearchRadius * 2);
       icp.setMaximumIterations(params_.icpMaxIterations);
@@ -0,0 +1,330 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (haoming.zhang@rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+#include <opencv2/imgproc.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+#include "model/gp_interpolator/GPWNOAInterpolator.h"
+#include "sensor/radar/RadarOdometry.h"
+
+namespace sensors::Radar {
+
+  namespace {
+    inline int64_t cellKey(int64_t ix, int64_t iy) {
+      return (ix << 32) ^ (iy & 0xffffffff);
+    }
+
+    /***
+     * hash grid of 2D points with the cell size of the search radius, the nearest neighbor is searched in the
+     * 3x3 cells around the query
+     */
+    class PointGrid2D {
+    public:
+      PointGrid2D(const std::vector<Eigen::Vector2d> &points, double cellSize) :
+        points_(points), cellSize_(cellSize) {
+        cells_.reserve(points.size());
+        for (size_t i = 0; i < points.size(); i++)
+          cells_[key(points[i])].emplace_back(i);
+      }
+
+      [[nodiscard]] std::optional<size_t> nearest(const Eigen::Vector2d &query, double maxDistance) const {
+        const auto ix = static_cast<int64_t>(std::floor(query.x() / cellSize_));
+        const auto iy = static_cast<int64_t>(std::floor(query.y() / cellSize_));
+        std::optional<size_t> best;
+        double minSqDistance = maxDistance * maxDistance;
+        for (int64_t dx = -1; dx <= 1; dx++) {
+          for (int64_t dy = -1; dy <= 1; dy++) {
+            const auto iter = cells_.find(cellKey(ix + dx, iy + dy));
+            if (iter == cells_.end())
+              continue;
+            for (const auto &idx: iter->second) {
+              const auto sqDistance = (points_[idx] - query).squaredNorm();
+              if (sqDistance < minSqDistance) {
+                minSqDistance = sqDistance;
+                best = idx;
+              }
+            }
+          }
+        }
+        return best;
+      }
+
+    private:
+      [[nodiscard]] int64_t key(const Eigen::Vector2d &point) const {
+        return cellKey(static_cast<int64_t>(std::floor(point.x() / cellSize_)),
+                       static_cast<int64_t>(std::floor(point.y() / cellSize_)));
+      }
+
+      const std::vector<Eigen::Vector2d> &points_;
+      double cellSize_;
+      std::unordered_map<int64_t, std::vector<size_t>> cells_;
+    };
+
+    // normal equations of the ICP in the local coordinates [x, y, theta] of gtsam::Pose2
+    struct NormalEquations {
+      gtsam::Matrix3 H = gtsam::Matrix3::Zero();
+      gtsam::Vector3 b = gtsam::Vector3::Zero();
+      double weightedSqError = 0.;
+      double sqError = 0.;
+      size_t count = 0;
+
+      NormalEquations &operator+=(const NormalEquations &other) {
+        H += other.H;
+        b += other.b;
+        weightedSqError += other.weightedSqError;
+        sqError += other.sqError;
+        count += other.count;
+        return *this;
+      }
+    };
+  }
+
+  RadarOdometry::RadarOdometry(const RadarOdometryParams &params) :
+    params_(params),
+    arena_(params.numThreads > 0 ? params.numThreads : static_cast<int>(tbb::task_arena::automatic)) {
+  }
+
+  void RadarOdometry::reset() {
+    hasPrevious_ = false;
+    timestampPrevious_ = 0.;
+    pointsPrevious_.clear();
+    twist_.setZero();
+  }
+
+  std::vector<RadarOdometry::Return> RadarOdometry::extractReturns(const cv::Mat &polar) const {
+    cv::Mat gray;
+    if (polar.channels() == 3)
+      cv::cvtColor(polar, gray, cv::COLOR_BGR2GRAY);
+    else
+      gray = polar;
+    if (!params_.azimuthAlongRows)
+      gray = gray.t();
+    if (params_.firstRangeBin > 0)
+      gray = gray.colRange(std::min(params_.firstRangeBin, gray.cols), gray.cols);
+
+    double scale = 1.;
+    if (gray.depth() == CV_8U)
+      scale = 1. / 255.;
+    else if (gray.depth() == CV_16U)
+      scale = 1. / 65535.;
+    cv::Mat intensity;
+    gray.convertTo(intensity, CV_32F, scale);
+
+    const auto numAzimuths = static_cast<size_t>(intensity.rows);
+    const auto minBin = std::max(0, static_cast<int>(params_.minRange / params_.rangeResolution));
+    const auto maxBin = std::min(intensity.cols, static_cast<int>(params_.maxRange / params_.rangeResolution) + 1);
+    const auto direction = params_.clockwise ? -1. : 1.;
+
+    std::vector<std::vector<Return>> azimuthReturns(numAzimuths);
+    arena_.execute([&]() {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, numAzimuths), [&](const tbb::blocked_range<size_t> &range) {
+        std::vector<std::pair<float, int>> candidates;
+        for (size_t azimuth = range.begin(); azimuth != range.end(); azimuth++) {
+          const auto *row = intensity.ptr<float>(static_cast<int>(azimuth));
+          candidates.clear();
+          for (int bin = minBin; bin < maxBin; bin++) {
+            if (row[bin] >= params_.minIntensity)
+              candidates.emplace_back(row[bin], bin);
+          }
+          const auto k = std::min(candidates.size(), static_cast<size_t>(std::max(0, params_.kStrongest)));
+          std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(k), candidates.end(),
+                            [](const auto &a, const auto &b) -> bool { return a.first > b.first; });
+
+          const auto angle = params_.azimuthOffset +
+                             direction * 2. * M_PI * static_cast<double>(azimuth) / static_cast<double>(numAzimuths);
+          const Eigen::Vector2d bearing(std::cos(angle), std::sin(angle));
+          auto &returns = azimuthReturns[azimuth];
+          for (size_t i = 0; i < k; i++) {
+            const auto distance = (candidates[i].second + 0.5) * params_.rangeResolution;
+            returns.push_back({distance * bearing, azimuth, candidates[i].first});
+          }
+        }
+      });
+    });
+
+    // the strongest return is kept per voxel
+    std::unordered_map<int64_t, Return> voxels;
+    for (const auto &returns: azimuthReturns) {
+      for (const auto &ret: returns) {
+        const auto key = cellKey(static_cast<int64_t>(std::floor(ret.point.x() / params_.voxelSize)),
+                                 static_cast<int64_t>(std::floor(ret.point.y() / params_.voxelSize)));
+        const auto [iter, inserted] = voxels.try_emplace(key, ret);
+        if (!inserted && iter->second.intensity < ret.intensity)
+          iter->second = ret;
+      }
+    }
+    std::vector<Return> returns;
+    returns.reserve(voxels.size());
+    for (const auto &[key, ret]: voxels)
+      returns.emplace_back(ret);
+    return returns;
+  }
+
+  std::vector<Eigen::Vector2d> RadarOdometry::deskew(const std::vector<Return> &returns,
+                                                     const gtsam::Vector6 &twist) const {
+    // constant body-centric velocity over the revolution, the scan starts at the identity
+    const auto period = params_.scanPeriod;
+    const gtsam::Pose3 poseEnd = gtsam::Pose3::Expmap(twist * period);
+    const gtsam::Vector3 omega = twist.head<3>();
+    const gtsam::Vector3 velStart = twist.tail<3>();
+    const gtsam::Vector3 velEnd = poseEnd.rotation().rotate(twist.tail<3>());
+    // the mean of the GP prior does not depend on Qc if both states follow the same constant velocity
+    fgo::models::GPWNOAInterpolator wnoa(gtsam::noiseModel::Isotropic::Sigma(6, 1.), period, 0., false, false);
+    fgo::models::GPInterpolator &interpolator = wnoa;
+
+    const auto interpolate = [&](double tau) -> gtsam::Pose3 {
+      interpolator.recalculate(period, tau);
+      return interpolator.interpolatePose(gtsam::Pose3(), velStart, omega, poseEnd, velEnd, omega);
+    };
+
+    std::vector<gtsam::Pose3> referenceFromAzimuth(numAzimuths_);
+    const auto referenceInverse = interpolate(params_.timestampFraction * period).inverse();
+    for (size_t azimuth = 0; azimuth < numAzimuths_; azimuth++)
+      referenceFromAzimuth[azimuth] = referenceInverse * interpolate(
+        static_cast<double>(azimuth) / static_cast<double>(numAzimuths_) * period);
+
+    std::vector<Eigen::Vector2d> points;
+    points.reserve(returns.size());
+    for (const auto &ret: returns) {
+      const auto point = referenceFromAzimuth[ret.azimuth].transformFrom(
+        gtsam::Point3(ret.point.x(), ret.point.y(), 0.));
+      points.emplace_back(point.head<2>());
+    }
+    return points;
+  }
+
+  std::optional<RadarOdometry::Alignment> RadarOdometry::align(const std::vector<Eigen::Vector2d> &source,
+                                                               const std::vector<Eigen::Vector2d> &target,
+                                                               const gtsam::Pose2 &initial) const {
+    if (source.size() < params_.minCorrespondences || target.size() < params_.minCorrespondences)
+      return std::nullopt;
+
+    const PointGrid2D grid(target, params_.maxCorrespondenceDistance);
+    const auto sqRobustScale = params_.robustScale * params_.robustScale;
+    gtsam::Pose2 pose = initial;
+    NormalEquations equations;
+
+    for (int iter = 0; iter < params_.maxIterations; iter++) {
+      const gtsam::Matrix2 R = pose.rotation().matrix();
+      const gtsam::Vector2 t = pose.translation();
+      equations = arena_.execute([&]() {
+        return tbb::parallel_reduce(
+          tbb::blocked_range<size_t>(0, source.size()), NormalEquations(),
+          [&](const tbb::blocked_range<size_t> &range, NormalEquations sum) -> NormalEquations {
+            for (size_t i = range.begin(); i != range.end(); i++) {
+              const Eigen::Vector2d &p = source[i];
+              const Eigen::Vector2d transformed = R * p + t;
+              const auto nearest = grid.nearest(transformed, params_.maxCorrespondenceDistance);
+              if (!nearest)
+                continue;
+              const Eigen::Vector2d residual = transformed - target[*nearest];
+              const auto sqError = residual.squaredNorm();
+              const auto weight = 1. / (1. + sqError / sqRobustScale);  // Cauchy
+              // the pose is perturbed with pose * Exp([dx, dy, dtheta])
+              Eigen::Matrix<double, 2, 3> J;
+              J.leftCols<2>() = R;
+              J.col(2) = R * Eigen::Vector2d(-p.y(), p.x());
+              sum.H.noalias() += weight * J.transpose() * J;
+              sum.b.noalias() += weight * J.transpose() * residual;
+              sum.weightedSqError += weight * sqError;
+              sum.sqError += sqError;
+              sum.count++;
+            }
+            return sum;
+          },
+          [](NormalEquations a, const NormalEquations &b) -> NormalEquations { return a += b; });
+      });
+
+      if (equations.count < params_.minCorrespondences)
+        return std::nullopt;
+      const gtsam::Vector3 delta = equations.H.ldlt().solve(-equations.b);
+      if (!delta.allFinite())
+        return std::nullopt;
+      pose = pose.compose(gtsam::Pose2::Expmap(delta));
+      if (delta.norm() < params_.convergenceThreshold)
+        break;
+    }
+
+    Alignment alignment;
+    alignment.pose = pose;
+    alignment.numCorrespondences = equations.count;
+    alignment.rmse = std::sqrt(equations.sqError / static_cast<double>(equations.count));
+    const auto sigmaSq = equations.weightedSqError / std::max(1., static_cast<double>(equations.count) - 3.);
+    alignment.covariance = sigmaSq * (equations.H + gtsam::Matrix3::Identity() * 1e-9).inverse();
+    return alignment;
+  }
+
+  std::optional<RadarOdometryResult> RadarOdometry::process(double timestamp, const cv::Mat &polar,
+                                                            const std::optional<gtsam::Vector6> &twistPrior) {
+    if (polar.empty())
+      return std::nullopt;
+    numAzimuths_ = static_cast<size_t>(params_.azimuthAlongRows ? polar.rows : polar.cols);
+    const auto returns = extractReturns(polar);
+    if (twistPrior)
+      twist_ = *twistPrior;
+    auto points = deskew(returns, twist_);
+
+    std::optional<RadarOdometryResult> result;
+    const auto dt = timestamp - timestampPrevious_;
+    if (hasPrevious_ && dt > 0.) {
+      // initial guess with the velocity used for the motion compensation
+      const auto motion = gtsam::Pose3::Expmap(twist_ * dt);
+      gtsam::Pose2 initial(motion.x(), motion.y(), motion.rotation().yaw());
+      std::optional<Alignment> alignment;
+      for (int iter = 0; iter < std::max(1, params_.motionCompensationIterations); iter++) {
+        alignment = align(points, pointsPrevious_, initial);
+        if (!alignment)
+          break;
+        initial = alignment->pose;
+        // refine the motion compensation with the matched planar motion
+        const gtsam::Vector3 planarTwist = gtsam::Pose2::Logmap(alignment->pose) / dt;
+        twist_ << 0., 0., planarTwist(2), planarTwist(0), planarTwist(1), 0.;
+        if (iter + 1 < params_.motionCompensationIterations)
+          points = deskew(returns, twist_);
+      }
+
+      if (alignment) {
+        result = RadarOdometryResult();
+        result->timestampPrevious = timestampPrevious_;
+        result->timestampCurrent = timestamp;
+        result->poseRelative = gtsam::Pose3(gtsam::Rot3::Rz(alignment->pose.theta()),
+                                            gtsam::Point3(alignment->pose.x(), alignment->pose.y(), 0.));
+        // Pose2 [x, y, theta] into Pose3 [omega, v], z, roll and pitch are not observed
+        result->covariance = gtsam::Matrix6::Identity() * params_.unobservedVar;
+        const std::array<int, 3> index = {3, 4, 2};
+        for (size_t i = 0; i < 3; i++)
+          for (size_t j = 0; j < 3; j++)
+            result->covariance(index[i], index[j]) = alignment->covariance(static_cast<int>(i), static_cast<int>(j));
+        result->twist = twist_;
+        result->numFeatures = points.size();
+        result->numCorrespondences = alignment->numCorrespondences;
+        result->rmse = alignment->rmse;
+      }
+    }
+
+    pointsPrevious_ = std::move(points);
+    timestampPrevious_ = timestamp;
+    hasPrevious_ = true;
+    return result;
+  }
+}
@@ -122,7 +122,6 @@ namespace fgo::solvers {
 
 /* ************************************************************************* */
     gtsam::KeyVector FixedLagSmoother::findKeysBefore(double timestamp) {
-      static double last_timestamp = timestamp;
         gtsam::KeyVector keys;
       //std::cout << "notMarginalizing_: " << notMarginalizing_ << std::endl;
         if(!notMarginalizing_)
@@ -136,7 +135,6 @@ namespace fgo::solvers {
           }
           notMarginalizing_ = false;
         }
-      last_timestamp = timestamp;
         return keys;
     }
 
@@ -0,0 +1,82 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <gtsam/config.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include "solver/FullBatchSmoother.h"
+
+namespace fgo::solvers {
+
+  void FullBatchSmoother::record(const gtsam::NonlinearFactorGraph &newFactors,
+                                 const gtsam::Values &newValues,
+                                 const FixedLagSmoother::KeyTimestampMap &newTimestamps) {
+    std::lock_guard lg(mutex_);
+    graph_.push_back(newFactors);
+    for (const auto &key_value: newValues) {
+      if (estimate_.exists(key_value.key))
+        estimate_.update(key_value.key, key_value.value);
+      else
+        estimate_.insert(key_value.key, key_value.value);
+    }
+    for (const auto &[key, timestamp]: newTimestamps)
+      timestamps_[key] = timestamp;
+  }
+
+  void FullBatchSmoother::updateEstimate(const gtsam::Values &estimate) {
+    std::lock_guard lg(mutex_);
+    for (const auto &key_value: estimate) {
+      if (estimate_.exists(key_value.key))
+        estimate_.update(key_value.key, key_value.value);
+    }
+  }
+
+  gtsam::Values FullBatchSmoother::optimize() {
+    std::lock_guard lg(mutex_);
+    if (graph_.empty())
+      return estimate_;
+
+    auto setCommonParams = [this](gtsam::NonlinearOptimizerParams &params) {
+      params.maxIterations = params_.maxIterations;
+      params.relativeErrorTol = params_.relativeErrorTol;
+      params.absoluteErrorTol = params_.absoluteErrorTol;
+      params.linearSolverType = gtsam::NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY;
+      params.orderingType = gtsam::Ordering::COLAMD;
+#ifdef GTSAM_SUPPORT_NESTED_DISSECTION
+      if (params_.nestedDissection)
+        params.orderingType = gtsam::Ordering::METIS;
+#endif
+      if (params_.verbose)
+        params.verbosity = gtsam::NonlinearOptimizerParams::ERROR;
+    };
+
+    if (params_.useGaussNewton) {
+      gtsam::GaussNewtonParams params;
+      setCommonParams(params);
+      estimate_ = gtsam::GaussNewtonOptimizer(graph_, estimate_, params).optimize();
+    } else {
+      gtsam::LevenbergMarquardtParams params;
+      setCommonParams(params);
+      params.lambdaInitial = params_.lambdaInitial;
+      if (params_.verbose)
+        params.verbosityLM = gtsam::LevenbergMarquardtParams::SUMMARY;
+      estimate_ = gtsam::LevenbergMarquardtOptimizer(graph_, estimate_, params).optimize();
+    }
+    return estimate_;
+  }
+}
@@ -0,0 +1,260 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include "utils/AsyncLogger.h"
+#include "utils/ROSParameter.h"
+
+namespace fgo::utils {
+
+  namespace {
+    constexpr char BinarySinkMagic[8] = {'F', 'G', 'O', 'L', 'O', 'G', '0', '1'};
+
+    LogLevel parseLevel(const std::string &level, LogLevel fallback) {
+      if (level == "debug" || level == "DEBUG")
+        return LogLevel::DEBUG;
+      if (level == "info" || level == "INFO")
+        return LogLevel::INFO;
+      if (level == "warn" || level == "WARN")
+        return LogLevel::WARN;
+      if (level == "error" || level == "ERROR")
+        return LogLevel::ERROR;
+      if (level == "off" || level == "OFF")
+        return LogLevel::OFF;
+      return fallback;
+    }
+
+    void writeString(std::FILE *file, const char *str) {
+      const auto len = static_cast<uint16_t>(std::min<size_t>(std::strlen(str), UINT16_MAX));
+      std::fwrite(&len, sizeof(len), 1, file);
+      std::fwrite(str, 1, len, file);
+    }
+  }
+
+  AsyncLogger &AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+  }
+
+  AsyncLogger::AsyncLogger() : cells_(new Cell[QueueCapacity]) {
+    for (size_t i = 0; i < QueueCapacity; i++)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    for (auto &level: levels_)
+      level.store(LogLevel::INFO, std::memory_order_relaxed);
+    thread_ = std::thread(&AsyncLogger::run, this);
+  }
+
+  AsyncLogger::~AsyncLogger() {
+    running_ = false;
+    wakeCondition_.notify_all();
+    if (thread_.joinable())
+      thread_.join();
+    std::lock_guard lock(sinkMutex_);
+    if (binarySink_)
+      std::fclose(binarySink_);
+  }
+
+  void AsyncLogger::configure(rclcpp::Node &node) {
+    for (size_t i = 0; i < static_cast<size_t>(LogModule::NUM_MODULES); i++) {
+      const auto module = static_cast<LogModule>(i);
+      RosParameter<std::string> level("GNSSFGO.Logging." + std::string(moduleName(module)) + "Level", "info", node);
+      setLevel(module, parseLevel(level.value(), LogLevel::INFO));
+    }
+    RosParameter<std::string> binarySink("GNSSFGO.Logging.binarySink", "", node);
+    if (!binarySink.value().empty()) {
+      if (openBinarySink(binarySink.value()))
+        RCLCPP_INFO_STREAM(node.get_logger(), "AsyncLogger: writing binary log into " << binarySink.value());
+      else
+        RCLCPP_ERROR_STREAM(node.get_logger(), "AsyncLogger: can't open binary log " << binarySink.value());
+    }
+  }
+
+  bool AsyncLogger::openBinarySink(const std::string &path) {
+    std::lock_guard lock(sinkMutex_);
+    if (binarySink_) {
+      std::fclose(binarySink_);
+      binarySink_ = nullptr;
+    }
+    if (path.empty())
+      return true;
+    binarySink_ = std::fopen(path.c_str(), "wb");
+    if (!binarySink_)
+      return false;
+    std::fwrite(BinarySinkMagic, 1, sizeof(BinarySinkMagic), binarySink_);
+    return true;
+  }
+
+  void AsyncLogger::log(LogModule module, LogLevel level, const char *what, std::string_view tag,
+                        std::initializer_list<LogField> fields) {
+    LogRecord record;
+    record.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    record.module = module;
+    record.level = level;
+    record.what = what;
+    const auto tagLength = std::min(tag.size(), LogRecord::MaxTagLength);
+    std::memcpy(record.tag, tag.data(), tagLength);
+    record.tag[tagLength] = '\0';
+    for (const auto &field: fields) {
+      if (record.numFields == LogRecord::MaxFields)
+        break;
+      record.fields[record.numFields++] = field;
+    }
+    if (tryPush(record))
+      enqueued_.fetch_add(1, std::memory_order_release);
+    else
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool AsyncLogger::tryPush(const LogRecord &record) {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      auto &cell = cells_[pos & (QueueCapacity - 1)];
+      const auto seq = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.record = record;
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0)
+        return false;  // full
+      else
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  bool AsyncLogger::tryPop(LogRecord &record) {
+    // single consumer, no CAS needed
+    const size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    auto &cell = cells_[pos & (QueueCapacity - 1)];
+    const auto seq = cell.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+      return false;  // empty
+    record = cell.record;
+    cell.sequence.store(pos + QueueCapacity, std::memory_order_release);
+    dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void AsyncLogger::flush() {
+    const auto target = enqueued_.load(std::memory_order_acquire);
+    std::unique_lock lock(wakeMutex_);
+    wakeCondition_.notify_all();
+    wakeCondition_.wait(lock, [&]() { return written_.load(std::memory_order_acquire) >= target || !running_; });
+    std::lock_guard sinkLock(sinkMutex_);
+    if (binarySink_)
+      std::fflush(binarySink_);
+  }
+
+  void AsyncLogger::run() {
+    LogRecord record;
+    uint64_t reportedDropped = 0;
+    while (true) {
+      bool processed = false;
+      while (tryPop(record)) {
+        processed = true;
+        const auto logger = rclcpp::get_logger(std::string("online_fgo.") + moduleName(record.module));
+        const auto text = formatRecord(record);
+        switch (record.level) {
+          case LogLevel::DEBUG:
+            RCLCPP_DEBUG(logger, "%s", text.c_str());
+            break;
+          case LogLevel::INFO:
+            RCLCPP_INFO(logger, "%s", text.c_str());
+            break;
+          case LogLevel::WARN:
+            RCLCPP_WARN(logger, "%s", text.c_str());
+            break;
+          default:
+            RCLCPP_ERROR(logger, "%s", text.c_str());
+            break;
+        }
+        writeBinary(record);
+        written_.fetch_add(1, std::memory_order_release);
+      }
+
+      const auto dropped = dropped_.load(std::memory_order_relaxed);
+      if (dropped != reportedDropped) {
+        RCLCPP_WARN(rclcpp::get_logger("online_fgo"), "AsyncLogger: queue full, dropped %lu records",
+                    static_cast<unsigned long>(dropped - reportedDropped));
+        reportedDropped = dropped;
+      }
+
+      std::unique_lock lock(wakeMutex_);
+      if (processed)
+        wakeCondition_.notify_all();  // wake up flush()
+      if (!running_ && dequeuePos_.load() == enqueuePos_.load())
+        break;
+      // producers never notify to keep the hot path free of syscalls, poll instead
+      wakeCondition_.wait_for(lock, std::chrono::milliseconds(5));
+    }
+  }
+
+  void AsyncLogger::writeBinary(const LogRecord &record) {
+    std::lock_guard lock(sinkMutex_);
+    if (!binarySink_)
+      return;
+    std::fwrite(&record.timestampNs, sizeof(record.timestampNs), 1, binarySink_);
+    const uint8_t header[3] = {static_cast<uint8_t>(record.module), static_cast<uint8_t>(record.level),
+                               record.numFields};
+    std::fwrite(header, 1, sizeof(header), binarySink_);
+    writeString(binarySink_, record.what);
+    writeString(binarySink_, record.tag);
+    for (size_t i = 0; i < record.numFields; i++) {
+      writeString(binarySink_, record.fields[i].name);
+      std::fwrite(&record.fields[i].value, sizeof(double), 1, binarySink_);
+    }
+  }
+
+  const char *AsyncLogger::moduleName(LogModule module) {
+    switch (module) {
+      case LogModule::GENERAL:
+        return "general";
+      case LogModule::GRAPH:
+        return "graph";
+      case LogModule::SOLVER:
+        return "solver";
+      case LogModule::IMU:
+        return "imu";
+      case LogModule::GNSS:
+        return "gnss";
+      case LogModule::LIDAR:
+        return "lidar";
+      case LogModule::INTEGRATOR:
+        return "integrator";
+      default:
+        return "unknown";
+    }
+  }
+
+  std::string AsyncLogger::formatRecord(const LogRecord &record) {
+    std::ostringstream ss;
+    if (record.tag[0] != '\0')
+      ss << "[" << record.tag << "] ";
+    ss << record.what << std::setprecision(15);
+    for (size_t i = 0; i < record.numFields; i++)
+      ss << (i == 0 ? " " : ", ") << record.fields[i].name << ": " << record.fields[i].value;
+    return ss.str();
+  }
+}
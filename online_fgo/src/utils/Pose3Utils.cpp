@@ -1,3 +1,4 @@
+#include <array>
 #include <cmath>
 #include "utils/Pose3Utils.h"
 
@@ -229,6 +230,48 @@ namespace fgo::utils {
     return Diff;
   }
 
+  /* ************************************************************************** */
+  namespace {
+    // d(sum_n coeffs[n] * curlyhat(xi)^n * x)/dxi using d(curlyhat(xi) * y)/dxi = -curlyhat(y)
+    // every power of curlyhat(xi) carries the rotation of xi, so the truncated series is accurate far beyond the
+    // rotations between two states
+    template<size_t N>
+    Matrix6 jacobianCurlyhatSeries(const std::array<double, N> &coeffs, const Vector6 &xi, const Vector6 &x) {
+      const Matrix6 ad = curlyhat(xi);
+      std::array<Vector6, N> adx;  // ad^m * x
+      adx[0] = x;
+      for (size_t m = 1; m < N; m++)
+        adx[m] = ad * adx[m - 1];
+
+      // d(ad^n * x) = -sum_{i<n} ad^i * curlyhat(ad^(n-1-i) * x), grouped by i and accumulated in Horner form
+      Matrix6 D = Matrix6::Zero();
+      for (size_t i = N - 1; i-- > 0;) {
+        Vector6 z = Vector6::Zero();
+        for (size_t n = i + 1; n < N; n++)
+          z += coeffs[n] * adx[n - 1 - i];
+        D = ad * D - curlyhat(z);
+      }
+      return D;
+    }
+  }
+
+  /* ************************************************************************** */
+  // Jr^-1(xi) = sum_n B_n / n! * (-ad)^n with the Bernoulli numbers B_n
+  Matrix6 jacobianRightJacobianPose3inv(const Vector6 &xi, const Vector6 &x) {
+    static constexpr std::array<double, 13> coeffs{1., 1. / 2., 1. / 12., 0., -1. / 720., 0., 1. / 30240., 0.,
+                                                   -1. / 1209600., 0., 1. / 47900160., 0., -691. / 1307674368000.};
+    return jacobianCurlyhatSeries(coeffs, xi, x);
+  }
+
+  /* ************************************************************************** */
+  // Jl(xi) = sum_n ad^n / (n + 1)!, see Barfoot14tro eq. (100)
+  Matrix6 jacobianLeftJacobianPose3(const Vector6 &xi, const Vector6 &x) {
+    static constexpr std::array<double, 13> coeffs{1., 1. / 2., 1. / 6., 1. / 24., 1. / 120., 1. / 720., 1. / 5040.,
+                                                   1. / 40320., 1. / 362880., 1. / 3628800., 1. / 39916800.,
+                                                   1. / 479001600., 1. / 6227020800.};
+    return jacobianCurlyhatSeries(coeffs, xi, x);
+  }
+
   /* ************************************************************************** */
   Matrix6 rightJacobianPose3(const Vector6 &xi) {
     const Vector3 w = xi.head<3>();
@@ -0,0 +1,248 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <Eigen/Geometry>
+#include "utils/TrajectoryEvaluator.h"
+
+namespace fgo::utils {
+
+  namespace {
+    constexpr double rad2deg = 180. / M_PI;
+
+    double wrapDegree(double angle) {
+      return std::remainder(angle, 360.);
+    }
+
+    void writeStatistics(std::ostream &os, const std::string &name, const ErrorStatistics &stat,
+                         const std::string &unit) {
+      os << "  " << std::left << std::setw(22) << name << std::right
+         << " n: " << std::setw(7) << stat.count
+         << " rmse: " << std::setw(10) << stat.rmse
+         << " mean: " << std::setw(10) << stat.mean
+         << " median: " << std::setw(10) << stat.median
+         << " max: " << std::setw(10) << stat.max << " " << unit << "\n";
+    }
+  }
+
+  ErrorStatistics ErrorStatistics::fromSamples(std::vector<double> samples) {
+    ErrorStatistics stat;
+    if (samples.empty())
+      return stat;
+    stat.count = samples.size();
+    double sum = 0., sqSum = 0.;
+    for (const auto &sample: samples) {
+      sum += sample;
+      sqSum += sample * sample;
+      stat.max = std::max(stat.max, sample);
+    }
+    const auto n = static_cast<double>(stat.count);
+    stat.mean = sum / n;
+    stat.rmse = std::sqrt(sqSum / n);
+    const auto mid = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() / 2);
+    std::nth_element(samples.begin(), mid, samples.end());
+    stat.median = *mid;
+    if (samples.size() % 2 == 0)
+      stat.median = 0.5 * (stat.median + *std::max_element(samples.begin(), mid));
+    return stat;
+  }
+
+  std::vector<std::pair<TrajectorySample, TrajectorySample>>
+  TrajectoryEvaluator::associate(const std::vector<TrajectorySample> &estimate,
+                                 const std::vector<TrajectorySample> &reference) const {
+    std::vector<std::pair<TrajectorySample, TrajectorySample>> pairs;
+    if (reference.empty())
+      return pairs;
+    pairs.reserve(estimate.size());
+
+    for (const auto &est: estimate) {
+      const auto itAfter = std::lower_bound(reference.begin(), reference.end(), est.timestamp,
+                                            [](const TrajectorySample &ref, double timestamp) -> bool {
+                                              return ref.timestamp < timestamp;
+                                            });
+      if (itAfter != reference.end() && itAfter->timestamp == est.timestamp) {
+        pairs.emplace_back(est, *itAfter);
+        continue;
+      }
+
+      if (itAfter == reference.begin() || itAfter == reference.end()) {
+        // outside of the reference, only an almost synchronous sample is accepted
+        const auto &nearest = itAfter == reference.end() ? reference.back() : reference.front();
+        if (std::abs(nearest.timestamp - est.timestamp) <= params_.maxTimeDifference)
+          pairs.emplace_back(est, nearest);
+        continue;
+      }
+
+      const auto itBefore = itAfter - 1;
+      const auto &nearest = (est.timestamp - itBefore->timestamp) < (itAfter->timestamp - est.timestamp) ?
+                            *itBefore : *itAfter;
+      const auto gap = itAfter->timestamp - itBefore->timestamp;
+      if (gap > params_.maxReferenceGap) {
+        if (std::abs(nearest.timestamp - est.timestamp) <= params_.maxTimeDifference)
+          pairs.emplace_back(est, nearest);
+        continue;
+      }
+
+      const auto coeff = (est.timestamp - itBefore->timestamp) / gap;
+      TrajectorySample ref;
+      ref.timestamp = est.timestamp;
+      ref.pose = gtsam::Pose3(itBefore->pose.rotation().slerp(coeff, itAfter->pose.rotation()),
+                              (1. - coeff) * itBefore->pose.translation() + coeff * itAfter->pose.translation());
+      ref.velocity = (1. - coeff) * itBefore->velocity + coeff * itAfter->velocity;
+      ref.hasAttitude = itBefore->hasAttitude && itAfter->hasAttitude;
+      ref.hasVelocity = itBefore->hasVelocity && itAfter->hasVelocity;
+      ref.solutionType = nearest.solutionType;
+      pairs.emplace_back(est, ref);
+    }
+    return pairs;
+  }
+
+  TrajectoryEvaluation TrajectoryEvaluator::evaluate(const std::vector<TrajectorySample> &estimate,
+                                                     const std::vector<TrajectorySample> &reference) const {
+    TrajectoryEvaluation evaluation;
+    evaluation.numEstimated = estimate.size();
+    auto pairs = associate(estimate, reference);
+    evaluation.numAssociated = pairs.size();
+    if (pairs.empty())
+      return evaluation;
+
+    // alignment of the estimate onto the reference
+    if (params_.alignment != TrajectoryAlignment::NONE && pairs.size() >= 3) {
+      Eigen::Matrix3Xd src(3, pairs.size()), dst(3, pairs.size());
+      for (size_t i = 0; i < pairs.size(); i++) {
+        src.col(static_cast<Eigen::Index>(i)) = pairs[i].first.pose.translation();
+        dst.col(static_cast<Eigen::Index>(i)) = pairs[i].second.pose.translation();
+      }
+      const Eigen::Matrix4d transform = Eigen::umeyama(src, dst, params_.alignment == TrajectoryAlignment::SIM3);
+      evaluation.alignmentScale = transform.block<3, 1>(0, 0).norm();
+      evaluation.alignmentRotation = gtsam::Rot3(transform.block<3, 3>(0, 0) / evaluation.alignmentScale);
+      evaluation.alignmentTranslation = transform.block<3, 1>(0, 3);
+      for (auto &[est, ref]: pairs) {
+        est.pose = gtsam::Pose3(evaluation.alignmentRotation * est.pose.rotation(),
+                                evaluation.alignmentScale * evaluation.alignmentRotation.rotate(est.pose.translation()) +
+                                evaluation.alignmentTranslation);
+        est.velocity = evaluation.alignmentScale * evaluation.alignmentRotation.rotate(est.velocity);
+      }
+    }
+
+    // absolute errors
+    std::vector<double> pos2D, pos3D, rot, heading, vel;
+    struct TypeSamples {
+      std::vector<double> pos2D, pos3D, heading, vel;
+    };
+    std::map<int, TypeSamples> typeSamples;
+    for (const auto &[est, ref]: pairs) {
+      auto &type = typeSamples[ref.solutionType];
+      const gtsam::Vector3 posError = est.pose.translation() - ref.pose.translation();
+      pos2D.emplace_back(posError.head<2>().norm());
+      pos3D.emplace_back(posError.norm());
+      type.pos2D.emplace_back(pos2D.back());
+      type.pos3D.emplace_back(pos3D.back());
+      if (est.hasAttitude && ref.hasAttitude) {
+        rot.emplace_back(gtsam::Rot3::Logmap(ref.pose.rotation().between(est.pose.rotation())).norm() * rad2deg);
+        heading.emplace_back(std::abs(wrapDegree((est.pose.rotation().yaw() - ref.pose.rotation().yaw()) * rad2deg)));
+        type.heading.emplace_back(heading.back());
+      }
+      if (est.hasVelocity && ref.hasVelocity) {
+        vel.emplace_back((est.velocity - ref.velocity).norm());
+        type.vel.emplace_back(vel.back());
+      }
+    }
+    evaluation.position2D = ErrorStatistics::fromSamples(std::move(pos2D));
+    evaluation.position3D = ErrorStatistics::fromSamples(std::move(pos3D));
+    evaluation.rotation = ErrorStatistics::fromSamples(std::move(rot));
+    evaluation.heading = ErrorStatistics::fromSamples(std::move(heading));
+    evaluation.velocity = ErrorStatistics::fromSamples(std::move(vel));
+    for (auto &[type, samples]: typeSamples) {
+      auto &stat = evaluation.bySolutionType[type];
+      stat.position2D = ErrorStatistics::fromSamples(std::move(samples.pos2D));
+      stat.position3D = ErrorStatistics::fromSamples(std::move(samples.pos3D));
+      stat.heading = ErrorStatistics::fromSamples(std::move(samples.heading));
+      stat.velocity = ErrorStatistics::fromSamples(std::move(samples.vel));
+    }
+
+    // relative errors over segments of the distance traveled along the reference
+    std::vector<double> distance(pairs.size(), 0.);
+    for (size_t i = 1; i < pairs.size(); i++)
+      distance[i] = distance[i - 1] + (pairs[i].second.pose.translation() - pairs[i - 1].second.pose.translation()).norm();
+
+    for (const auto &length: params_.segmentLengths) {
+      std::vector<double> transErrors, rotErrors;
+      for (size_t i = 0; i < pairs.size(); i++) {
+        const auto itEnd = std::lower_bound(distance.begin() + static_cast<std::ptrdiff_t>(i), distance.end(),
+                                            distance[i] + length);
+        if (itEnd == distance.end())
+          break;
+        const auto j = static_cast<size_t>(std::distance(distance.begin(), itEnd));
+        const auto &[estI, refI] = pairs[i];
+        const auto &[estJ, refJ] = pairs[j];
+        if (estI.hasAttitude && refI.hasAttitude && estJ.hasAttitude && refJ.hasAttitude) {
+          const auto error = refI.pose.between(refJ.pose).between(estI.pose.between(estJ.pose));
+          transErrors.emplace_back(error.translation().norm());
+          rotErrors.emplace_back(gtsam::Rot3::Logmap(error.rotation()).norm() * rad2deg);
+        } else {
+          const gtsam::Vector3 deltaEst = estJ.pose.translation() - estI.pose.translation();
+          const gtsam::Vector3 deltaRef = refJ.pose.translation() - refI.pose.translation();
+          transErrors.emplace_back((deltaEst - deltaRef).norm());
+        }
+      }
+      if (transErrors.empty())
+        continue;
+      auto &stat = evaluation.relative[length];
+      stat.translation = ErrorStatistics::fromSamples(std::move(transErrors));
+      stat.rotation = ErrorStatistics::fromSamples(std::move(rotErrors));
+      stat.driftPercent = stat.translation.mean / length * 100.;
+    }
+    return evaluation;
+  }
+
+  void TrajectoryEvaluation::writeSummary(std::ostream &os,
+                                          const std::function<std::string(int)> &solutionTypeName) const {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << std::fixed << std::setprecision(4);
+    os << "Trajectory evaluation: " << numAssociated << " of " << numEstimated << " estimated samples associated\n";
+    os << "  alignment scale: " << alignmentScale
+       << " translation: " << alignmentTranslation.transpose()
+       << " rotation (rpy, deg): " << (alignmentRotation.rpy() * rad2deg).transpose() << "\n";
+    writeStatistics(os, "ATE position 2D", position2D, "m");
+    writeStatistics(os, "ATE position 3D", position3D, "m");
+    writeStatistics(os, "ATE rotation", rotation, "deg");
+    writeStatistics(os, "heading", heading, "deg");
+    writeStatistics(os, "velocity", velocity, "m/s");
+    for (const auto &[length, stat]: relative) {
+      const auto name = "RPE " + std::to_string(static_cast<int>(length)) + " m";
+      writeStatistics(os, name + " trans.", stat.translation, "m");
+      writeStatistics(os, name + " rot.", stat.rotation, "deg");
+      os << "  " << std::left << std::setw(22) << (name + " drift") << std::right << " " << stat.driftPercent
+         << " %\n";
+    }
+    for (const auto &[type, stat]: bySolutionType) {
+      const auto name = solutionTypeName ? solutionTypeName(type) : std::to_string(type);
+      os << " solution type " << name << ":\n";
+      writeStatistics(os, "position 2D", stat.position2D, "m");
+      writeStatistics(os, "position 3D", stat.position3D, "m");
+      writeStatistics(os, "heading", stat.heading, "deg");
+      writeStatistics(os, "velocity", stat.velocity, "m/s");
+    }
+    os.flags(flags);
+    os.precision(precision);
+  }
+}
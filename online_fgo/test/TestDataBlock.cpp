@@ -0,0 +1,153 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dataset/Dataset.h"
+
+/*
+ * The lazy loading of a DataBlock is checked against a synthetic bag: every message has a header stamp, which keys the
+ * sample, and a receive time, which orders the bag. The loader reads the bag chunk by chunk as the BagReader does, so
+ * consecutive chunks must neither repeat nor skip messages, whatever the offset between both clocks is.
+ */
+
+namespace {
+  using fgo::dataset::DataBlock;
+  using fgo::dataset::DataChunk;
+
+  constexpr int64_t HeaderStart = 1'000'000'000'000;  // [ns]
+  constexpr int64_t Period = 10'000'000;              // [ns]
+  constexpr size_t NumMessages = 100;
+  constexpr double ChunkSize = 30.;                   // messages per chunk
+
+  struct BagMessage {
+    int64_t header_ns;
+    int64_t bag_ns;
+    int index;
+  };
+
+  // messages sorted by receive time, the receive time is the header stamp shifted by latency
+  std::vector<BagMessage> createBag(int64_t latency) {
+    std::vector<BagMessage> bag;
+    for (size_t i = 0; i < NumMessages; i++) {
+      const auto header = HeaderStart + static_cast<int64_t>(i) * Period;
+      bag.push_back({header, header + latency, static_cast<int>(i)});
+    }
+    return bag;
+  }
+
+  /***
+   * reads the bag from a receive time on until the budget is used up, messages received at the same time are kept in
+   * one chunk as in BagReader::readSinglePartialDataFromBag
+   */
+  DataChunk<int> readChunk(const std::vector<BagMessage> &bag, int64_t start, double max_size) {
+    DataChunk<int> chunk;
+    chunk.resume_nanosec = start;
+    size_t i = 0;
+    while (i < bag.size() && bag[i].bag_ns < start)
+      i++;
+    double used = 0.;
+    for (; i < bag.size(); i++) {
+      if (used >= max_size && bag[i].bag_ns != bag[i - 1].bag_ns)
+        break;
+      chunk.data.emplace(rclcpp::Time(bag[i].header_ns, RCL_ROS_TIME), bag[i].index);
+      chunk.resume_nanosec = bag[i].bag_ns + 1;
+      used += 1.;
+    }
+    chunk.has_next = i < bag.size();
+    return chunk;
+  }
+
+  struct TestBlock : DataBlock<int> {
+    explicit TestBlock(const std::vector<BagMessage> &bag)
+      : DataBlock<int>("Test", "/test", ChunkSize, [](int) { return rclcpp::Time(0, 0, RCL_ROS_TIME); }) {
+      // the first chunk starts at the beginning of the bag, only the following ones are under test
+      timestamp_start = rclcpp::Time(0, 0, RCL_ROS_TIME);
+      setCbLoadData([bag](int64_t start, double max_size, const std::string &) {
+        return readChunk(bag, start, max_size);
+      });
+    }
+
+    using DataBlock<int>::loadNextChunk;
+  };
+
+  // the loaded samples are the messages 0..n-1 in order, every message once
+  void expectContiguous(const TestBlock &block, size_t n) {
+    ASSERT_EQ(block.samples.size(), n);
+    for (size_t i = 0; i < n; i++) {
+      EXPECT_EQ(block.samples[i], static_cast<int>(i)) << "at sample " << i;
+      if (i > 0)
+        EXPECT_LT(block.timestamps[i - 1], block.timestamps[i]);
+    }
+  }
+
+  void checkTwoChunks(int64_t latency) {
+    TestBlock block(createBag(latency));
+    ASSERT_TRUE(block.loadNextChunk());
+    expectContiguous(block, static_cast<size_t>(ChunkSize));
+    ASSERT_TRUE(block.loadNextChunk());
+    expectContiguous(block, 2 * static_cast<size_t>(ChunkSize));
+    EXPECT_FALSE(block.fully_loaded);
+  }
+}
+
+TEST(DataBlock, ConsecutiveChunksWithoutLatency) {
+  checkTwoChunks(0);
+}
+
+// the receive time is later than the header stamp, resuming from the header stamp repeated messages
+TEST(DataBlock, ConsecutiveChunksReceivedLate) {
+  checkTwoChunks(3 * Period + Period / 2);
+}
+
+// the receive time is earlier than the header stamp, resuming from the header stamp skipped messages
+TEST(DataBlock, ConsecutiveChunksReceivedEarly) {
+  checkTwoChunks(-(3 * Period + Period / 2));
+}
+
+TEST(DataBlock, LoadsTheWholeBag) {
+  TestBlock block(createBag(2 * Period));
+  while (block.loadNextChunk()) {}
+  EXPECT_TRUE(block.fully_loaded);
+  expectContiguous(block, NumMessages);
+}
+
+// a sample stamped at the newest loaded stamp is a duplicate and dropped
+TEST(DataBlock, DropsSamplesNotNewerThanTheLoadedOnes) {
+  TestBlock block(createBag(0));
+  ASSERT_TRUE(block.loadNextChunk());
+  DataBlock<int>::DataMap overlap;
+  overlap.emplace(block.timestamps.back(), -1);
+  overlap.emplace(block.timestamps.back() + rclcpp::Duration::from_nanoseconds(1), static_cast<int>(ChunkSize));
+  block.appendData(std::move(overlap));
+  expectContiguous(block, static_cast<size_t>(ChunkSize) + 1);
+}
+
+// messages received at the same time aren't split between two chunks
+TEST(DataBlock, KeepsMessagesReceivedTogether) {
+  auto bag = createBag(0);
+  for (auto &message: bag)
+    message.bag_ns = HeaderStart + (message.index / 4) * 4 * Period;
+  TestBlock block(bag);
+  ASSERT_TRUE(block.loadNextChunk());
+  EXPECT_EQ(block.samples.size() % 4, 0u);
+  ASSERT_TRUE(block.loadNextChunk());
+  while (block.loadNextChunk()) {}
+  expectContiguous(block, NumMessages);
+}
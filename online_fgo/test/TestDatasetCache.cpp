@@ -0,0 +1,259 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <filesystem>
+#include <type_traits>
+#include <gtest/gtest.h>
+
+#include "dataset/DatasetCache.h"
+
+/*
+ * A cache file is written with the column writers of the CacheTraits and mapped again, the messages read back must
+ * equal the written ones, window by window as for the lazy loading.
+ */
+
+namespace {
+  using namespace fgo::dataset;
+
+  constexpr int64_t BagStart = 1'000'000'000'000;  // [ns]
+  constexpr int64_t Period = 10'000'000;           // [ns]
+  constexpr size_t NumMessages = 50;
+
+  const CacheSourceStamp Source{123456, 789};
+
+  // the header stamp differs from the receive time, which orders the column
+  rclcpp::Time headerTime(size_t i) {
+    return {BagStart - 3 * Period + static_cast<int64_t>(i) * Period, RCL_ROS_TIME};
+  }
+
+  int64_t bagTime(size_t i) {
+    return BagStart + static_cast<int64_t>(i) * Period;
+  }
+
+  std_msgs::msg::Header header(size_t i) {
+    std_msgs::msg::Header header;
+    const auto time = headerTime(i).nanoseconds();
+    header.stamp.sec = static_cast<int32_t>(time / 1'000'000'000);
+    header.stamp.nanosec = static_cast<uint32_t>(time % 1'000'000'000);
+    header.frame_id = "frame_" + std::to_string(i);
+    return header;
+  }
+
+  sensor_msgs::msg::Imu imu(size_t i) {
+    sensor_msgs::msg::Imu msg;
+    msg.header = header(i);
+    const auto v = static_cast<double>(i);
+    msg.orientation.x = 0.1 * v;
+    msg.orientation.w = 1.;
+    msg.angular_velocity.z = -v;
+    msg.linear_acceleration.x = 9.81 + v;
+    msg.orientation_covariance[0] = v;
+    msg.angular_velocity_covariance[4] = 2. * v;
+    msg.linear_acceleration_covariance[8] = 3. * v;
+    return msg;
+  }
+
+  sensor_msgs::msg::PointCloud2 cloud(size_t i) {
+    sensor_msgs::msg::PointCloud2 msg;
+    msg.header = header(i);
+    msg.height = 1;
+    msg.width = static_cast<uint32_t>(i + 1);
+    msg.point_step = 4;
+    msg.row_step = msg.point_step * msg.width;
+    msg.is_dense = true;
+    sensor_msgs::msg::PointField field;
+    field.name = "intensity";
+    field.offset = 0;
+    field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+    field.count = 1;
+    msg.fields.emplace_back(field);
+    msg.data.resize(msg.row_step);
+    for (size_t k = 0; k < msg.data.size(); k++)
+      msg.data[k] = static_cast<uint8_t>(i + k);
+    return msg;
+  }
+
+  sensor_msgs::msg::CompressedImage image(size_t i) {
+    sensor_msgs::msg::CompressedImage msg;
+    msg.header = header(i);
+    msg.format = "png";
+    msg.data.assign(i % 7 + 1, static_cast<uint8_t>(i));
+    return msg;
+  }
+
+  void expectHeaderEq(const std_msgs::msg::Header &expected, const std_msgs::msg::Header &actual) {
+    EXPECT_EQ(expected.stamp.sec, actual.stamp.sec);
+    EXPECT_EQ(expected.stamp.nanosec, actual.stamp.nanosec);
+    EXPECT_EQ(expected.frame_id, actual.frame_id);
+  }
+
+  void expectEq(const sensor_msgs::msg::Imu &expected, const sensor_msgs::msg::Imu &actual) {
+    expectHeaderEq(expected.header, actual.header);
+    EXPECT_EQ(expected.orientation.x, actual.orientation.x);
+    EXPECT_EQ(expected.orientation.w, actual.orientation.w);
+    EXPECT_EQ(expected.angular_velocity.z, actual.angular_velocity.z);
+    EXPECT_EQ(expected.linear_acceleration.x, actual.linear_acceleration.x);
+    EXPECT_EQ(expected.orientation_covariance, actual.orientation_covariance);
+    EXPECT_EQ(expected.angular_velocity_covariance, actual.angular_velocity_covariance);
+    EXPECT_EQ(expected.linear_acceleration_covariance, actual.linear_acceleration_covariance);
+  }
+
+  void expectEq(const sensor_msgs::msg::PointCloud2 &expected, const sensor_msgs::msg::PointCloud2 &actual) {
+    expectHeaderEq(expected.header, actual.header);
+    EXPECT_EQ(expected.height, actual.height);
+    EXPECT_EQ(expected.width, actual.width);
+    EXPECT_EQ(expected.point_step, actual.point_step);
+    EXPECT_EQ(expected.row_step, actual.row_step);
+    EXPECT_EQ(expected.is_dense, actual.is_dense);
+    ASSERT_EQ(expected.fields.size(), actual.fields.size());
+    for (size_t k = 0; k < expected.fields.size(); k++) {
+      EXPECT_EQ(expected.fields[k].name, actual.fields[k].name);
+      EXPECT_EQ(expected.fields[k].offset, actual.fields[k].offset);
+      EXPECT_EQ(expected.fields[k].datatype, actual.fields[k].datatype);
+      EXPECT_EQ(expected.fields[k].count, actual.fields[k].count);
+    }
+    EXPECT_EQ(expected.data, actual.data);
+  }
+
+  void expectEq(const sensor_msgs::msg::CompressedImage &expected, const sensor_msgs::msg::CompressedImage &actual) {
+    expectHeaderEq(expected.header, actual.header);
+    EXPECT_EQ(expected.format, actual.format);
+    EXPECT_EQ(expected.data, actual.data);
+  }
+
+  class DatasetCacheTest : public ::testing::Test {
+  protected:
+    std::string path_;
+
+    void SetUp() override {
+      path_ = (std::filesystem::temp_directory_path() /
+               ("fgo_dataset_cache_test_" + std::to_string(::getpid()) + ".cache")).string();
+      DatasetCacheWriter writer(path_, Source);
+      ASSERT_TRUE(writer.isOpen());
+      // the byte columns are streamed, so the topics are written one after another as in DatasetBase
+      writeTopic<sensor_msgs::msg::Imu>(writer, "/imu", imu);
+      writeTopic<sensor_msgs::msg::PointCloud2>(writer, "/lidar", cloud);
+      writeTopic<sensor_msgs::msg::CompressedImage>(writer, "/camera", image);
+      ASSERT_TRUE(writer.finalize());
+    }
+
+    void TearDown() override {
+      std::error_code ec;
+      std::filesystem::remove(path_, ec);
+    }
+
+    template<typename Message, typename Create>
+    static void writeTopic(DatasetCacheWriter &writer, const std::string &topic, const Create &create) {
+      typename CacheTraits<Message>::ColumnWriter column_writer(writer, topic);
+      for (size_t i = 0; i < NumMessages; i++)
+        column_writer.add(headerTime(i), create(i), bagTime(i));
+      column_writer.finish();
+    }
+
+    template<typename Message, typename Create>
+    static void checkRead(const DatasetCacheReader &reader, const std::string &topic, const Create &create) {
+      const auto messages = CacheTraits<Message>::read(reader, topic);
+      ASSERT_EQ(messages.size(), NumMessages) << topic;
+      for (size_t i = 0; i < NumMessages; i++) {
+        EXPECT_EQ(messages[i].first.nanoseconds(), headerTime(i).nanoseconds()) << topic << " message " << i;
+        expectEq(create(i), messages[i].second);
+      }
+    }
+
+    // consecutive windows starting at the resume time cover all messages once
+    template<typename Message, typename Create>
+    static void checkWindows(const DatasetCacheReader &reader, const std::string &topic, const Create &create,
+                             double max_size) {
+      size_t next = 0, num_windows = 0;
+      int64_t start = bagTime(0);
+      bool has_next = true;
+      while (has_next) {
+        int64_t resume = 0;
+        const auto messages = CacheTraits<Message>::readWindow(reader, topic, start, max_size, has_next, resume);
+        ASSERT_FALSE(messages.empty()) << topic << " window " << num_windows;
+        for (const auto &[time, msg]: messages) {
+          ASSERT_LT(next, NumMessages) << topic;
+          EXPECT_EQ(time.nanoseconds(), headerTime(next).nanoseconds()) << topic << " message " << next;
+          expectEq(create(next), msg);
+          next++;
+        }
+        EXPECT_EQ(resume, bagTime(next - 1) + 1) << topic;
+        start = resume;
+        num_windows++;
+      }
+      EXPECT_EQ(next, NumMessages) << topic;
+      EXPECT_GT(num_windows, 1u) << topic;
+    }
+  };
+}
+
+TEST_F(DatasetCacheTest, ReadsWrittenMessages) {
+  const auto reader = DatasetCacheReader::open(path_, Source);
+  ASSERT_TRUE(reader);
+  EXPECT_TRUE(reader->hasColumn("/imu"));
+  EXPECT_TRUE(reader->hasColumn("/lidar"));
+  EXPECT_TRUE(reader->hasColumn("/camera"));
+  checkRead<sensor_msgs::msg::Imu>(*reader, "/imu", imu);
+  checkRead<sensor_msgs::msg::PointCloud2>(*reader, "/lidar", cloud);
+  checkRead<sensor_msgs::msg::CompressedImage>(*reader, "/camera", image);
+}
+
+TEST_F(DatasetCacheTest, ReadsWindowsFromReceiveTime) {
+  const auto reader = DatasetCacheReader::open(path_, Source);
+  ASSERT_TRUE(reader);
+  checkWindows<sensor_msgs::msg::Imu>(*reader, "/imu", imu, 8 * sizeof(CachedIMURecord) * 1e-9);
+  checkWindows<sensor_msgs::msg::PointCloud2>(*reader, "/lidar", cloud, 100e-9);
+  checkWindows<sensor_msgs::msg::CompressedImage>(*reader, "/camera", image, 20e-9);
+
+  // a window starting after the last message is empty
+  bool has_next = true;
+  int64_t resume = 0;
+  const auto tail = CacheTraits<sensor_msgs::msg::Imu>::readWindow(*reader, "/imu", bagTime(NumMessages), 1.,
+                                                                     has_next, resume);
+  EXPECT_TRUE(tail.empty());
+  EXPECT_FALSE(has_next);
+  EXPECT_EQ(resume, bagTime(NumMessages));
+}
+
+TEST_F(DatasetCacheTest, ColumnsAreReadOnly) {
+  const auto reader = DatasetCacheReader::open(path_, Source);
+  ASSERT_TRUE(reader);
+  const auto records = reader->column<CachedIMURecord>("/imu");
+  const auto data = reader->blob("/lidar#data");
+  static_assert(std::is_const_v<typename decltype(records)::element_type>);
+  static_assert(std::is_const_v<typename decltype(data)::element_type>);
+  ASSERT_EQ(records.size(), NumMessages);
+  for (size_t i = 0; i < NumMessages; i++)
+    EXPECT_EQ(records[i].header.bag_time_ns, bagTime(i));
+
+  // a column is only returned for its own record type
+  EXPECT_TRUE(reader->column<CachedOdometryRecord>("/imu").empty());
+  EXPECT_TRUE(reader->column<CachedIMURecord>("/unknown").empty());
+  EXPECT_TRUE(reader->blob("/imu").empty());
+}
+
+TEST_F(DatasetCacheTest, RejectsOtherSource) {
+  EXPECT_FALSE(DatasetCacheReader::open(path_, CacheSourceStamp{Source.size + 1, Source.modified}));
+  EXPECT_FALSE(DatasetCacheReader::open(path_, CacheSourceStamp{Source.size, Source.modified + 1}));
+  EXPECT_FALSE(DatasetCacheReader::open(path_ + ".missing", Source));
+}
+
+TEST_F(DatasetCacheTest, RejectsTruncatedFile) {
+  std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 1);
+  EXPECT_FALSE(DatasetCacheReader::open(path_, Source));
+}
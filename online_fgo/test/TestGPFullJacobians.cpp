@@ -0,0 +1,230 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <array>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include <gtsam/base/numericalDerivative.h>
+
+#include "factor/motion/GPWNOJPriorFull.h"
+#include "factor/motion/GPSingerPriorFull.h"
+#include "model/gp_interpolator/GPWNOJInterpolatorFull.h"
+#include "model/gp_interpolator/GPSingerInterpolatorFull.h"
+
+/*
+ * The analytic Jacobians of the full WNOJ/Singer priors and interpolators are checked block by block against
+ * central differences on random states.
+ */
+
+namespace {
+  constexpr double Delta = 1e-5;
+  constexpr double Tolerance = 1e-6;  // relative
+  constexpr size_t NumSamples = 50;
+
+  struct GPState {
+    gtsam::Pose3 pose;
+    gtsam::Vector3 vel;    // in the navigation frame
+    gtsam::Vector3 omega;  // in the body frame
+    gtsam::Vector6 acc;
+  };
+
+  const std::array<std::string, 8> BlockNames = {"pose1", "vel1", "omega1", "acc1", "pose2", "vel2", "omega2", "acc2"};
+
+  class GPFullJacobianTest : public ::testing::Test {
+  protected:
+    std::mt19937 rng_{42};
+    std::uniform_real_distribution<double> uniform_{-1., 1.};
+    double dt_ = 0.2;
+    gtsam::SharedNoiseModel qc_ = gtsam::noiseModel::Diagonal::Variances(
+      (gtsam::Vector6() << 0.05, 0.05, 0.1, 1., 1., 0.5).finished());
+    gtsam::Matrix6 ad_ = (gtsam::Vector6() << 0.8, 0.8, 0.8, 0.5, 0.5, 0.5).finished().asDiagonal();
+
+    template<int N>
+    Eigen::Matrix<double, N, 1> random(double scale) {
+      return Eigen::Matrix<double, N, 1>::NullaryExpr([this, scale]() { return scale * uniform_(rng_); });
+    }
+
+    // two states dt_ apart with a plausible vehicle motion in between
+    std::pair<GPState, GPState> randomStatePair() {
+      GPState s1, s2;
+      s1.pose = gtsam::Pose3::Expmap((gtsam::Vector6() << random<3>(M_PI), random<3>(100.)).finished());
+      s1.vel = random<3>(10.);
+      s1.omega = random<3>(0.5);
+      s1.acc = random<6>(1.);
+      const gtsam::Vector6 twist = (gtsam::Vector6() << s1.omega, s1.pose.rotation().unrotate(s1.vel)).finished();
+      s2.pose = s1.pose.compose(gtsam::Pose3::Expmap(twist * dt_ + random<6>(0.05)));
+      s2.vel = s1.vel + random<3>(1.);
+      s2.omega = s1.omega + random<3>(0.1);
+      s2.acc = s1.acc + random<6>(0.5);
+      return {s1, s2};
+    }
+
+    // numerical Jacobians of f(pose1, vel1, omega1, acc1, pose2, vel2, omega2, acc2) w.r.t. all arguments
+    template<typename Y, typename Function>
+    static std::array<gtsam::Matrix, 8> numericalJacobians(const Function &f, const GPState &s1, const GPState &s2) {
+      using gtsam::Pose3;
+      using gtsam::Vector3;
+      using gtsam::Vector6;
+      return {
+        gtsam::numericalDerivative11<Y, Pose3>(
+          [&](const Pose3 &x) { return f(x, s1.vel, s1.omega, s1.acc, s2.pose, s2.vel, s2.omega, s2.acc); },
+          s1.pose, Delta),
+        gtsam::numericalDerivative11<Y, Vector3>(
+          [&](const Vector3 &x) { return f(s1.pose, x, s1.omega, s1.acc, s2.pose, s2.vel, s2.omega, s2.acc); },
+          s1.vel, Delta),
+        gtsam::numericalDerivative11<Y, Vector3>(
+          [&](const Vector3 &x) { return f(s1.pose, s1.vel, x, s1.acc, s2.pose, s2.vel, s2.omega, s2.acc); },
+          s1.omega, Delta),
+        gtsam::numericalDerivative11<Y, Vector6>(
+          [&](const Vector6 &x) { return f(s1.pose, s1.vel, s1.omega, x, s2.pose, s2.vel, s2.omega, s2.acc); },
+          s1.acc, Delta),
+        gtsam::numericalDerivative11<Y, Pose3>(
+          [&](const Pose3 &x) { return f(s1.pose, s1.vel, s1.omega, s1.acc, x, s2.vel, s2.omega, s2.acc); },
+          s2.pose, Delta),
+        gtsam::numericalDerivative11<Y, Vector3>(
+          [&](const Vector3 &x) { return f(s1.pose, s1.vel, s1.omega, s1.acc, s2.pose, x, s2.omega, s2.acc); },
+          s2.vel, Delta),
+        gtsam::numericalDerivative11<Y, Vector3>(
+          [&](const Vector3 &x) { return f(s1.pose, s1.vel, s1.omega, s1.acc, s2.pose, s2.vel, x, s2.acc); },
+          s2.omega, Delta),
+        gtsam::numericalDerivative11<Y, Vector6>(
+          [&](const Vector6 &x) { return f(s1.pose, s1.vel, s1.omega, s1.acc, s2.pose, s2.vel, s2.omega, x); },
+          s2.acc, Delta)
+      };
+    }
+
+    static void expectJacobiansNear(const std::array<gtsam::Matrix, 8> &numerical,
+                                    const std::array<gtsam::Matrix, 8> &analytic,
+                                    const std::string &what) {
+      for (size_t k = 0; k < 8; k++) {
+        ASSERT_EQ(numerical[k].rows(), analytic[k].rows()) << what << " " << BlockNames[k];
+        ASSERT_EQ(numerical[k].cols(), analytic[k].cols()) << what << " " << BlockNames[k];
+        const double error = (numerical[k] - analytic[k]).norm();
+        EXPECT_LE(error, Tolerance * std::max(1., numerical[k].norm()))
+                << what << " w.r.t. " << BlockNames[k] << "\nnumerical:\n" << numerical[k]
+                << "\nanalytic:\n" << analytic[k];
+      }
+    }
+
+    template<typename Prior>
+    void checkPrior(const Prior &prior, const std::string &what) {
+      const auto error = [&prior](const gtsam::Pose3 &p1, const gtsam::Vector3 &v1, const gtsam::Vector3 &w1,
+                                  const gtsam::Vector6 &a1, const gtsam::Pose3 &p2, const gtsam::Vector3 &v2,
+                                  const gtsam::Vector3 &w2, const gtsam::Vector6 &a2) -> gtsam::Vector {
+        return prior.evaluateError(p1, v1, w1, a1, p2, v2, w2, a2);
+      };
+      for (size_t i = 0; i < NumSamples; i++) {
+        const auto [s1, s2] = randomStatePair();
+        std::array<gtsam::Matrix, 8> H;
+        const gtsam::Vector value = prior.evaluateError(s1.pose, s1.vel, s1.omega, s1.acc,
+                                                        s2.pose, s2.vel, s2.omega, s2.acc,
+                                                        H[0], H[1], H[2], H[3], H[4], H[5], H[6], H[7]);
+        EXPECT_TRUE(gtsam::assert_equal(error(s1.pose, s1.vel, s1.omega, s1.acc,
+                                              s2.pose, s2.vel, s2.omega, s2.acc), value, 1e-12));
+        expectJacobiansNear(numericalJacobians<gtsam::Vector>(error, s1, s2), H, what);
+      }
+    }
+
+    template<typename Interpolator>
+    void checkInterpolator(Interpolator &interpolator, const std::string &what) {
+      for (const double tau: {0.02, 0.1, 0.17}) {
+        for (size_t i = 0; i < NumSamples; i++) {
+          const auto [s1, s2] = randomStatePair();
+          if constexpr (std::is_same_v<Interpolator, fgo::models::GPSingerInterpolatorFull>)
+            interpolator.recalculate(dt_, tau, ad_, s1.acc, s2.acc);
+          else
+            interpolator.recalculate(dt_, tau, s1.acc, s2.acc);
+
+          const auto pose = [&interpolator](const gtsam::Pose3 &p1, const gtsam::Vector3 &v1, const gtsam::Vector3 &w1,
+                                            const gtsam::Vector6 &a1, const gtsam::Pose3 &p2,
+                                            const gtsam::Vector3 &v2, const gtsam::Vector3 &w2,
+                                            const gtsam::Vector6 &a2) -> gtsam::Pose3 {
+            return interpolator.interpolatePose(p1, v1, w1, a1, p2, v2, w2, a2);
+          };
+          const auto velocity = [&interpolator](const gtsam::Pose3 &p1, const gtsam::Vector3 &v1,
+                                                const gtsam::Vector3 &w1, const gtsam::Vector6 &a1,
+                                                const gtsam::Pose3 &p2, const gtsam::Vector3 &v2,
+                                                const gtsam::Vector3 &w2, const gtsam::Vector6 &a2) -> gtsam::Vector6 {
+            return interpolator.interpolateVelocity(p1, v1, w1, a1, p2, v2, w2, a2);
+          };
+          const auto acceleration = [&interpolator](const gtsam::Pose3 &p1, const gtsam::Vector3 &v1,
+                                                    const gtsam::Vector3 &w1, const gtsam::Vector6 &a1,
+                                                    const gtsam::Pose3 &p2, const gtsam::Vector3 &v2,
+                                                    const gtsam::Vector3 &w2,
+                                                    const gtsam::Vector6 &a2) -> gtsam::Vector6 {
+            return interpolator.interpolateAcceleration(p1, v1, w1, a1, p2, v2, w2, a2);
+          };
+
+          std::array<gtsam::Matrix, 8> H;
+          const auto posePoint = interpolator.interpolatePose(s1.pose, s1.vel, s1.omega, s1.acc,
+                                                              s2.pose, s2.vel, s2.omega, s2.acc,
+                                                              H[0], H[1], H[2], H[3], H[4], H[5], H[6], H[7]);
+          EXPECT_TRUE(gtsam::assert_equal(pose(s1.pose, s1.vel, s1.omega, s1.acc,
+                                               s2.pose, s2.vel, s2.omega, s2.acc), posePoint, 1e-9));
+          expectJacobiansNear(numericalJacobians<gtsam::Pose3>(pose, s1, s2), H, what + " pose");
+
+          const gtsam::Vector6 velocityPoint = interpolator.interpolateVelocity(
+            s1.pose, s1.vel, s1.omega, s1.acc, s2.pose, s2.vel, s2.omega, s2.acc,
+            H[0], H[1], H[2], H[3], H[4], H[5], H[6], H[7]);
+          EXPECT_TRUE(gtsam::assert_equal(velocity(s1.pose, s1.vel, s1.omega, s1.acc,
+                                                   s2.pose, s2.vel, s2.omega, s2.acc), velocityPoint, 1e-9));
+          expectJacobiansNear(numericalJacobians<gtsam::Vector6>(velocity, s1, s2), H, what + " velocity");
+
+          const gtsam::Vector6 accelerationPoint = interpolator.interpolateAcceleration(
+            s1.pose, s1.vel, s1.omega, s1.acc, s2.pose, s2.vel, s2.omega, s2.acc,
+            H[0], H[1], H[2], H[3], H[4], H[5], H[6], H[7]);
+          EXPECT_TRUE(gtsam::assert_equal(acceleration(s1.pose, s1.vel, s1.omega, s1.acc,
+                                                       s2.pose, s2.vel, s2.omega, s2.acc), accelerationPoint, 1e-9));
+          expectJacobiansNear(numericalJacobians<gtsam::Vector6>(acceleration, s1, s2), H,
+                              what + " acceleration");
+        }
+      }
+    }
+  };
+}
+
+TEST_F(GPFullJacobianTest, WNOJPriorFull) {
+  for (const bool calcJacobian: {true, false}) {
+    const fgo::factor::GPWNOJPriorFull prior(0, 1, 2, 3, 4, 5, 6, 7, dt_, qc_, false, calcJacobian);
+    checkPrior(prior, std::string("GPWNOJPriorFull calcJacobian ") + (calcJacobian ? "on" : "off"));
+  }
+}
+
+TEST_F(GPFullJacobianTest, SingerPriorFull) {
+  for (const bool calcJacobian: {true, false}) {
+    const fgo::factor::GPSingerPriorFull prior(0, 1, 2, 3, 4, 5, 6, 7, dt_, qc_, ad_, false, calcJacobian);
+    checkPrior(prior, std::string("GPSingerPriorFull calcJacobian ") + (calcJacobian ? "on" : "off"));
+  }
+}
+
+TEST_F(GPFullJacobianTest, WNOJInterpolatorFull) {
+  for (const bool calcJacobian: {true, false}) {
+    fgo::models::GPWNOJInterpolatorFull interpolator(qc_, 0., 0., false, calcJacobian);
+    checkInterpolator(interpolator,
+                      std::string("GPWNOJInterpolatorFull calcJacobian ") + (calcJacobian ? "on" : "off"));
+  }
+}
+
+TEST_F(GPFullJacobianTest, SingerInterpolatorFull) {
+  for (const bool calcJacobian: {true, false}) {
+    fgo::models::GPSingerInterpolatorFull interpolator(qc_, ad_, 0., 0., false, calcJacobian);
+    checkInterpolator(interpolator,
+                      std::string("GPSingerInterpolatorFull calcJacobian ") + (calcJacobian ? "on" : "off"));
+  }
+}
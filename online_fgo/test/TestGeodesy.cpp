@@ -0,0 +1,254 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include <gtsam/base/numericalDerivative.h>
+
+#include "utils/Geodesy.h"
+#include "factor/gnss/PVTFactor.h"
+
+/*
+ * The geodesy module is checked against the closed form conversions it replaced, and its analytic Jacobians as well
+ * as the Jacobians of the PVTFactor are checked against central differences on random positions from the earth
+ * surface up to GNSS orbits.
+ */
+
+namespace {
+  using namespace fgo::utils;
+
+  constexpr size_t NumSamples = 500;
+
+  // the conversions of NavigationTools.h before they delegated to the geodesy module
+  namespace legacy {
+    // Heikkinen's closed form solution, Groves (C.29)
+    gtsam::Point3 xyz2llh(const gtsam::Point3 &p1) {
+      const double x2 = std::pow(p1.x(), 2);
+      const double y2 = std::pow(p1.y(), 2);
+      const double z2 = std::pow(p1.z(), 2);
+
+      const double e = std::sqrt(1.0 - ((geodesy::b / geodesy::a) * (geodesy::b / geodesy::a)));
+      const double b2 = std::pow(geodesy::b, 2);
+      const double e2 = std::pow(e, 2);
+      const double ep = e * (geodesy::a / geodesy::b);
+      const double r = std::sqrt(x2 + y2);
+      const double r2 = std::pow(r, 2);
+      const double E2 = std::pow(geodesy::a, 2) - std::pow(geodesy::b, 2);
+      const double F = 54 * b2 * z2;
+      const double G = r2 + (1 - e2) * z2 - e2 * E2;
+      const double c = (std::pow(e2, 2) * F * r2) / (std::pow(G, 3));
+      const double s = std::pow((1.0 + c + std::sqrt(c * c + 2 * c)), 1.0 / 3.0);
+
+      const double P = F / (3.0 * (s + 1 / s + 1) * (s + 1 / s + 1) * G * G);
+      const double Q = std::sqrt(1.0 + 2 * e2 * e2 * P);
+      const double ro = -(P * e2 * r) / (1 + Q) +
+                        std::sqrt((geodesy::a * geodesy::a / 2) * (1 + 1 / Q) - (P * (1 - e2) * z2) / (Q * (1 + Q)) -
+                                  P * r2 / 2);
+      const double tmp = std::pow((r - e2 * ro), 2);
+      const double U = std::sqrt(tmp + z2);
+      const double V = std::sqrt(tmp + (1 - e2) * z2);
+      const double zo = (b2 * p1.z()) / (geodesy::a * V);
+
+      const double height = U * (1.0 - b2 / (geodesy::a * V));
+      const double lat = std::atan((p1.z() + ep * ep * zo) / r);
+      const double temp = std::atan(p1.y() / p1.x());
+      double longitude;
+      if (p1.x() >= 0.0)
+        longitude = temp;
+      else if (p1.y() >= 0.0)
+        longitude = temp + M_PI;
+      else
+        longitude = temp - M_PI;
+      return {lat, longitude, height};
+    }
+
+    gtsam::Point3 llh2xyz(const gtsam::Point3 &llh) {
+      const double f = 1 - geodesy::b / geodesy::a;
+      const double ex2 = (2 - f) * f / (std::pow((1 - f), 2));
+      const double c = geodesy::a * std::sqrt(1 + ex2);
+      const double N = c / std::sqrt(1 + ex2 * std::pow(std::cos(llh.x()), 2));
+      return {(N + llh.z()) * std::cos(llh.x()) * std::cos(llh.y()),
+              (N + llh.z()) * std::cos(llh.x()) * std::sin(llh.y()),
+              (std::pow((1 - f), 2) * N + llh.z()) * std::sin(llh.x())};
+    }
+
+    gtsam::Matrix33 nedRe(const gtsam::Point3 &llh) {
+      const double sLat = std::sin(llh(0)), sLon = std::sin(llh(1));
+      const double cLat = std::cos(llh(0)), cLon = std::cos(llh(1));
+      return (gtsam::Matrix33() << -sLat * cLon, -sLat * sLon, cLat,
+        -sLon, cLon, 0.0,
+        -cLat * cLon, -cLat * sLon, -sLat).finished();
+    }
+
+    gtsam::Matrix33 enuRe(const gtsam::Point3 &llh) {
+      const double sLat = std::sin(llh(0)), sLon = std::sin(llh(1));
+      const double cLat = std::cos(llh(0)), cLon = std::cos(llh(1));
+      return (gtsam::Matrix33() << -sLon, cLon, 0.,
+        -sLat * cLon, -sLat * sLon, cLat,
+        cLat * cLon, cLat * sLon, sLat).finished();
+    }
+  }
+
+  class GeodesyTest : public ::testing::Test {
+  protected:
+    std::mt19937 rng_{42};
+    std::uniform_real_distribution<double> uniform_{-1., 1.};
+
+    template<int N>
+    Eigen::Matrix<double, N, 1> random(double scale) {
+      return Eigen::Matrix<double, N, 1>::NullaryExpr([this, scale]() { return scale * uniform_(rng_); });
+    }
+
+    // latitude within +-89 deg, height from below the geoid up to GNSS orbits
+    gtsam::Point3 randomLLH() {
+      const double height = std::uniform_real_distribution<double>(-100., 2.1e7)(rng_);
+      return {uniform_(rng_) * 89. * M_PI / 180., uniform_(rng_) * M_PI, height};
+    }
+
+    // relative to the norm of the expected value, absolute below a norm of one unless relative is set
+    static void expectNear(const gtsam::Matrix &expected, const gtsam::Matrix &actual, double tolerance,
+                           const std::string &what, bool relative = false) {
+      ASSERT_EQ(expected.rows(), actual.rows()) << what;
+      ASSERT_EQ(expected.cols(), actual.cols()) << what;
+      const double scale = relative ? expected.norm() : std::max(1., expected.norm());
+      EXPECT_LE((expected - actual).norm(), tolerance * scale)
+              << what << "\nexpected:\n" << expected << "\nactual:\n" << actual;
+    }
+
+    // the PVT factor with a measurement close to the state, so that the error stays small
+    void checkPVTFactor(fgo::factor::MeasurementFrame velocityFrame, const std::string &what) {
+      const gtsam::Vector3 lb(0.5, -0.2, 1.1);
+      const auto model = gtsam::noiseModel::Isotropic::Sigma(6, 1.);
+      for (size_t i = 0; i < NumSamples; i++) {
+        const auto llh = gtsam::Point3(uniform_(rng_) * 89. * M_PI / 180., uniform_(rng_) * M_PI,
+                                       std::uniform_real_distribution<double>(-100., 1e4)(rng_));
+        const gtsam::Pose3 pose(gtsam::Rot3::Expmap(random<3>(M_PI)), geodesy::frame2ECEF(geodesy::llh2Frame(llh)));
+        const gtsam::Vector3 vel = random<3>(30.);
+        const gtsam::Vector3 omega = random<3>(1.);
+        const fgo::factor::PVTFactor factor(1, 2, 3, pose.translation() + random<3>(2.), random<3>(30.), lb,
+                                            velocityFrame, model);
+
+        gtsam::Matrix H1, H2, H3;
+        const gtsam::Vector error = factor.evaluateError(pose, vel, omega, H1, H2, H3);
+        const auto f = [&factor](const gtsam::Pose3 &p, const gtsam::Vector3 &v,
+                                 const gtsam::Vector3 &w) -> gtsam::Vector6 {
+          return factor.evaluateError(p, v, w);
+        };
+        EXPECT_TRUE(gtsam::assert_equal(gtsam::Vector(f(pose, vel, omega)), error, 1e-12));
+
+        // the ECEF position is about 6e6 m, a larger step keeps the round-off of the differences small
+        constexpr double delta = 1e-3;
+        expectNear(gtsam::numericalDerivative11<gtsam::Vector6, gtsam::Pose3>(
+                     [&](const gtsam::Pose3 &x) { return f(x, vel, omega); }, pose, delta), H1, 1e-5, what + " H1");
+        expectNear(gtsam::numericalDerivative11<gtsam::Vector6, gtsam::Vector3>(
+                     [&](const gtsam::Vector3 &x) { return f(pose, x, omega); }, vel, delta), H2, 1e-5, what + " H2");
+        expectNear(gtsam::numericalDerivative11<gtsam::Vector6, gtsam::Vector3>(
+                     [&](const gtsam::Vector3 &x) { return f(pose, vel, x); }, omega, delta), H3, 1e-5, what + " H3");
+      }
+    }
+  };
+}
+
+TEST_F(GeodesyTest, Ecef2FrameMatchesHeikkinen) {
+  for (size_t i = 0; i < NumSamples; i++) {
+    const auto xyz = legacy::llh2xyz(randomLLH());
+    const auto expected = legacy::xyz2llh(xyz);
+    const auto frame = geodesy::ecef2Frame(xyz);
+    EXPECT_NEAR(frame.llh.x(), expected.x(), 1e-14) << "latitude at " << xyz.transpose();
+    EXPECT_NEAR(frame.llh.y(), expected.y(), 1e-14) << "longitude at " << xyz.transpose();
+    EXPECT_NEAR(frame.llh.z(), expected.z(), 1e-8) << "height at " << xyz.transpose();
+    expectNear(legacy::nedRe(expected), frame.nedRe(), 1e-14, "nedRe");
+    expectNear(legacy::enuRe(expected), frame.enuRe(), 1e-14, "enuRe");
+  }
+}
+
+TEST_F(GeodesyTest, Frame2ECEFMatchesClosedForm) {
+  for (size_t i = 0; i < NumSamples; i++) {
+    const auto llh = randomLLH();
+    const auto frame = geodesy::llh2Frame(llh);
+    expectNear(legacy::llh2xyz(llh), geodesy::frame2ECEF(frame), 1e-15, "frame2ECEF");
+    expectNear(legacy::nedRe(llh), frame.nedRe(), 1e-15, "nedRe");
+    expectNear(legacy::enuRe(llh), frame.enuRe(), 1e-15, "enuRe");
+  }
+}
+
+TEST_F(GeodesyTest, RoundTrip) {
+  for (size_t i = 0; i < NumSamples; i++) {
+    const auto llh = randomLLH();
+    const auto xyz = geodesy::frame2ECEF(geodesy::llh2Frame(llh));
+    const auto frame = geodesy::ecef2Frame(xyz);
+    EXPECT_NEAR(frame.llh.x(), llh.x(), 1e-14);
+    EXPECT_NEAR(frame.llh.y(), llh.y(), 1e-14);
+    EXPECT_NEAR(frame.llh.z(), llh.z(), 1e-8);
+    expectNear(xyz, geodesy::frame2ECEF(frame), 1e-15, "round trip");
+  }
+}
+
+TEST_F(GeodesyTest, BatchMatchesSingle) {
+  Eigen::Matrix3Xd xyz(3, NumSamples);
+  for (size_t i = 0; i < NumSamples; i++)
+    xyz.col(static_cast<Eigen::Index>(i)) = legacy::llh2xyz(randomLLH());
+  const auto batch = geodesy::ecef2FrameBatch(xyz);
+  const auto xyzBack = geodesy::llh2ECEFBatch(batch.llh);
+  ASSERT_EQ(batch.size(), NumSamples);
+  for (Eigen::Index i = 0; i < xyz.cols(); i++) {
+    const auto frame = geodesy::ecef2Frame(xyz.col(i));
+    expectNear(frame.llh, batch.frame(i).llh, 1e-15, "ecef2FrameBatch");
+    expectNear(frame.nedRe(), batch.frame(i).nedRe(), 1e-15, "ecef2FrameBatch nedRe");
+    expectNear(xyz.col(i), xyzBack.col(i), 1e-15, "llh2ECEFBatch");
+  }
+}
+
+TEST_F(GeodesyTest, RotateJacobiansWrtRef) {
+  for (size_t i = 0; i < NumSamples; i++) {
+    const auto ref = legacy::llh2xyz(randomLLH());
+    const gtsam::Vector3 t = random<3>(100.);
+    const auto frame = geodesy::ecef2Frame(ref);
+
+    // the rotation changes slowly with the reference position, a step of 1 m is well within the linear range
+    constexpr double delta = 1.;
+    const auto numericalENU = gtsam::numericalDerivative11<gtsam::Vector3, gtsam::Point3>(
+      [&t](const gtsam::Point3 &x) -> gtsam::Vector3 { return geodesy::ecef2Frame(x).enuRe() * t; }, ref, delta);
+    const auto numericalNED = gtsam::numericalDerivative11<gtsam::Vector3, gtsam::Point3>(
+      [&t](const gtsam::Point3 &x) -> gtsam::Vector3 { return geodesy::ecef2Frame(x).nedRe() * t; }, ref, delta);
+    // the Jacobians w.r.t. the reference scale with |t| / R, so they are compared relative to their norm
+    expectNear(numericalENU, geodesy::enuRotateJacobianWrtRef(frame, t), 1e-6, "enuRotateJacobianWrtRef", true);
+    expectNear(numericalNED, geodesy::nedRotateJacobianWrtRef(frame, t), 1e-6, "nedRotateJacobianWrtRef", true);
+
+    const gtsam::Matrix36 jacENU = geodesy::jacobianECEF2ENU(ref, t);
+    const gtsam::Matrix36 jacNED = geodesy::jacobianECEF2NED(ref, t);
+    expectNear(numericalENU, jacENU.leftCols<3>(), 1e-6, "jacobianECEF2ENU t_ref", true);
+    expectNear(numericalNED, jacNED.leftCols<3>(), 1e-6, "jacobianECEF2NED t_ref", true);
+    expectNear(frame.enuRe(), jacENU.rightCols<3>(), 1e-15, "jacobianECEF2ENU t");
+    expectNear(frame.nedRe(), jacNED.rightCols<3>(), 1e-15, "jacobianECEF2NED t");
+  }
+}
+
+TEST_F(GeodesyTest, PVTFactorJacobiansECEF) {
+  checkPVTFactor(fgo::factor::MeasurementFrame::ECEF, "ECEF");
+}
+
+TEST_F(GeodesyTest, PVTFactorJacobiansNED) {
+  checkPVTFactor(fgo::factor::MeasurementFrame::NED, "NED");
+}
+
+TEST_F(GeodesyTest, PVTFactorJacobiansENU) {
+  checkPVTFactor(fgo::factor::MeasurementFrame::ENU, "ENU");
+}
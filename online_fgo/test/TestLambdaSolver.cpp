@@ -0,0 +1,171 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <random>
+#include <gtest/gtest.h>
+
+#include "utils/LambdaAlgorithm.h"
+
+/*
+ * The LambdaSolver is checked against the reference MLAMBDA implementation lambda() on random float ambiguities
+ * with correlated covariances, and on constructed cases for the partial fixing and the search budget.
+ */
+
+namespace {
+  constexpr size_t NumSamples = 200;
+
+  class LambdaSolverTest : public ::testing::Test {
+  protected:
+    std::mt19937 rng_{42};
+    std::uniform_real_distribution<double> uniform_{-1., 1.};
+
+    // a strongly correlated covariance as the double differenced ambiguities of a short epoch have
+    Eigen::MatrixXd randomCovariance(int n) {
+      const Eigen::MatrixXd A = Eigen::MatrixXd::NullaryExpr(n, n, [this]() { return uniform_(rng_); });
+      return 0.5 * A * A.transpose() + 1e-3 * Eigen::MatrixXd::Identity(n, n);
+    }
+
+    Eigen::VectorXd randomFloat(int n) {
+      return Eigen::VectorXd::NullaryExpr(n, [this]() { return 20. * uniform_(rng_); });
+    }
+  };
+}
+
+TEST_F(LambdaSolverTest, MatchesReferenceImplementation) {
+  std::uniform_int_distribution<int> size(2, 12);
+  std::uniform_int_distribution<int> candidates(2, 5);
+  for (size_t i = 0; i < NumSamples; i++) {
+    const int n = size(rng_);
+    const int m = candidates(rng_);
+    const Eigen::VectorXd a = randomFloat(n);
+    const Eigen::MatrixXd Q = randomCovariance(n);
+
+    Eigen::MatrixXd F;
+    Eigen::VectorXd s;
+    ASSERT_EQ(fgo::utils::lambda(a, Q, F, s, m), 0);
+
+    fgo::utils::LambdaParams params;
+    params.numCandidates = m;
+    params.ratioThreshold = 0.;  // accept every ratio, so that the candidates are returned in the original space
+    params.partialFixing = false;
+    params.maxSearchLoops = 1000000;
+    fgo::utils::LambdaSolver solver(params);
+    const auto solution = solver.solve(a, Q);
+
+    ASSERT_EQ(solution.status, 0) << "sample " << i;
+    ASSERT_FALSE(solution.truncated) << "sample " << i;
+    ASSERT_TRUE(solution.fixed) << "sample " << i;
+    EXPECT_FALSE(solution.partial);
+    EXPECT_EQ(solution.numFixed, n);
+    ASSERT_EQ(solution.candidates.rows(), F.rows());
+    ASSERT_EQ(solution.candidates.cols(), F.cols());
+    EXPECT_LE((solution.candidates - F).cwiseAbs().maxCoeff(), 1e-6)
+            << "sample " << i << "\nsolver:\n" << solution.candidates << "\nreference:\n" << F;
+    ASSERT_EQ(solution.residuals.size(), s.size());
+    for (Eigen::Index k = 0; k < s.size(); k++)
+      EXPECT_NEAR(solution.residuals(k), s(k), 1e-9 * std::max(1., s(k))) << "sample " << i << " candidate " << k;
+    EXPECT_NEAR(solution.ratio, s(1) / s(0), 1e-9 * solution.ratio);
+    EXPECT_TRUE(solution.ambiguities.isApprox(F.col(0)));
+  }
+}
+
+TEST_F(LambdaSolverTest, RatioTest) {
+  // float solutions close to integers with a small variance pass, those between two integers fail
+  const int n = 6;
+  const Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+  const Eigen::VectorXd integers = (Eigen::VectorXd(n) << 3., -7., 12., 0., 5., -1.).finished();
+  fgo::utils::LambdaSolver solver;
+
+  const auto fixed = solver.solve(integers + Eigen::VectorXd::Constant(n, 0.01), Q);
+  EXPECT_EQ(fixed.status, 0);
+  EXPECT_TRUE(fixed.fixed);
+  EXPECT_FALSE(fixed.partial);
+  EXPECT_TRUE(fixed.ambiguities.isApprox(integers));
+
+  const auto floating = solver.solve(integers + Eigen::VectorXd::Constant(n, 0.5), Q);
+  EXPECT_EQ(floating.status, 0);
+  EXPECT_FALSE(floating.fixed);
+}
+
+TEST_F(LambdaSolverTest, PartialFixing) {
+  // four precise ambiguities close to integers and two imprecise ones between two integers
+  const int n = 6;
+  const Eigen::VectorXd variances = (Eigen::VectorXd(n) << 1e-4, 9., 1e-4, 1e-4, 9., 1e-4).finished();
+  const Eigen::MatrixXd Q = variances.asDiagonal();
+  const Eigen::VectorXd integers = (Eigen::VectorXd(n) << 3., -7., 12., 0., 5., -1.).finished();
+  Eigen::VectorXd a = integers + Eigen::VectorXd::Constant(n, 0.01);
+  a(1) += 0.49;
+  a(4) -= 0.51;
+
+  fgo::utils::LambdaParams params;
+  params.partialFixing = false;
+  EXPECT_FALSE(fgo::utils::LambdaSolver(params).solve(a, Q).fixed);
+
+  params.partialFixing = true;
+  params.minNumFixed = 4;
+  const auto solution = fgo::utils::LambdaSolver(params).solve(a, Q);
+  EXPECT_EQ(solution.status, 0);
+  ASSERT_TRUE(solution.fixed);
+  EXPECT_TRUE(solution.partial);
+  EXPECT_EQ(solution.numFixed, 4);
+  EXPECT_GE(solution.ratio, params.ratioThreshold);
+  // the precise ambiguities are fixed, the uncorrelated imprecise ones keep their float value
+  for (const int k: {0, 2, 3, 5})
+    EXPECT_NEAR(solution.ambiguities(k), integers(k), 1e-9) << "ambiguity " << k;
+  EXPECT_NEAR(solution.ambiguities(1), a(1), 1e-9);
+  EXPECT_NEAR(solution.ambiguities(4), a(4), 1e-9);
+
+  // the subset is not searched if it is smaller than allowed
+  params.minNumFixed = 5;
+  EXPECT_FALSE(fgo::utils::LambdaSolver(params).solve(a, Q).fixed);
+}
+
+TEST_F(LambdaSolverTest, TruncatedSearch) {
+  const int n = 12;
+  const Eigen::VectorXd a = randomFloat(n);
+  const Eigen::MatrixXd Q = randomCovariance(n);
+
+  fgo::utils::LambdaParams params;
+  params.ratioThreshold = 0.;
+  params.partialFixing = false;
+  params.maxSearchLoops = 1000000;
+  const auto complete = fgo::utils::LambdaSolver(params).solve(a, Q);
+  ASSERT_FALSE(complete.truncated);
+  ASSERT_TRUE(complete.fixed);
+
+  // the budget runs out before the ellipsoid has been exhausted, the result is never accepted then
+  params.maxSearchLoops = n;
+  const auto truncated = fgo::utils::LambdaSolver(params).solve(a, Q);
+  EXPECT_EQ(truncated.status, 0);
+  EXPECT_TRUE(truncated.truncated);
+  EXPECT_FALSE(truncated.fixed);
+
+  // the budget is shared by the subsets of the partial fixing, so no subset is accepted either
+  params.partialFixing = true;
+  params.minNumFixed = 1;
+  const auto partial = fgo::utils::LambdaSolver(params).solve(a, Q);
+  EXPECT_TRUE(partial.truncated);
+  EXPECT_FALSE(partial.fixed);
+}
+
+TEST_F(LambdaSolverTest, RejectsInvalidInput) {
+  fgo::utils::LambdaSolver solver;
+  EXPECT_EQ(solver.solve(Eigen::VectorXd(), Eigen::MatrixXd()).status, -1);
+  EXPECT_EQ(solver.solve(Eigen::VectorXd::Zero(3), Eigen::MatrixXd::Identity(2, 2)).status, -1);
+  EXPECT_EQ(solver.solve(Eigen::VectorXd::Zero(3), -Eigen::MatrixXd::Identity(3, 3)).status, -1);
+}
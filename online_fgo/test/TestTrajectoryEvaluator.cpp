@@ -0,0 +1,328 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "utils/TrajectoryEvaluator.h"
+
+/*
+ * The evaluation is checked on a synthetic reference trajectory: the estimate is the reference mapped by a known
+ * transform, optionally perturbed by known noise or known constant errors, so the association, the recovered alignment
+ * and the error statistics can be compared against closed-form values.
+ */
+
+namespace {
+  using fgo::utils::TrajectoryAlignment;
+  using fgo::utils::TrajectoryEvaluator;
+  using fgo::utils::TrajectoryEvaluatorParams;
+  using fgo::utils::TrajectorySample;
+
+  constexpr double Rate = 20.;          // [Hz] of the reference
+  constexpr double Duration = 120.;     // [s]
+  constexpr double Radius = 50.;        // [m]
+  constexpr double AngularRate = 0.1;   // [rad/s]
+  constexpr int TypeFixed = 4;
+  constexpr int TypeFloat = 5;
+
+  double rotationError(const gtsam::Rot3 &a, const gtsam::Rot3 &b) {
+    return gtsam::Rot3::Logmap(a.between(b)).norm();
+  }
+
+  /***
+   * circle with a vertical oscillation, heading along the tangent, fixed solution in the first half, the type
+   * changes between two samples without an estimated sample in between
+   */
+  std::vector<TrajectorySample> createReference() {
+    std::vector<TrajectorySample> reference;
+    const auto num = static_cast<size_t>(Duration * Rate);
+    for (size_t i = 0; i <= num; i++) {
+      const double t = static_cast<double>(i) / Rate;
+      const double angle = AngularRate * t;
+      TrajectorySample sample;
+      sample.timestamp = 1000. + t;
+      const gtsam::Point3 position(Radius * std::cos(angle), Radius * std::sin(angle), 2. * std::sin(0.5 * t));
+      sample.pose = gtsam::Pose3(gtsam::Rot3::Ypr(angle + M_PI_2, 0.02 * std::sin(t), 0.), position);
+      sample.velocity = gtsam::Vector3(-Radius * AngularRate * std::sin(angle), Radius * AngularRate * std::cos(angle),
+                                       std::cos(0.5 * t));
+      sample.solutionType = i <= num / 2 + 1 ? TypeFixed : TypeFloat;
+      reference.emplace_back(sample);
+    }
+    return reference;
+  }
+
+  /***
+   * estimate at half the rate of the reference and in between its samples, expressed in a frame in which the
+   * reference is mapped onto it by ref = scale * rot * est + trans
+   */
+  std::vector<TrajectorySample> createEstimate(const std::vector<TrajectorySample> &reference, const gtsam::Rot3 &rot,
+                                               const gtsam::Point3 &trans, double scale, double sigma,
+                                               std::mt19937 &rng) {
+    std::normal_distribution<double> noise(0., 1.);
+    std::vector<TrajectorySample> estimate;
+    for (size_t i = 0; i + 1 < reference.size(); i += 2) {
+      const auto &before = reference[i];
+      const auto &after = reference[i + 1];
+      TrajectorySample sample;
+      sample.timestamp = 0.5 * (before.timestamp + after.timestamp);
+      const gtsam::Rot3 attitude = before.pose.rotation().slerp(0.5, after.pose.rotation());
+      gtsam::Point3 position = 0.5 * (before.pose.translation() + after.pose.translation());
+      if (sigma > 0.)
+        position += sigma * gtsam::Point3(noise(rng), noise(rng), noise(rng));
+      sample.pose = gtsam::Pose3(rot.inverse() * attitude, rot.unrotate(position - trans) / scale);
+      sample.velocity = rot.unrotate(0.5 * (before.velocity + after.velocity)) / scale;
+      estimate.emplace_back(sample);
+    }
+    return estimate;
+  }
+
+  class TrajectoryEvaluatorTest : public ::testing::Test {
+  protected:
+    std::mt19937 rng_{42};
+    std::vector<TrajectorySample> reference_ = createReference();
+    const gtsam::Rot3 rot_ = gtsam::Rot3::Ypr(0.6, -0.05, 0.1);
+    const gtsam::Point3 trans_ = gtsam::Point3(120., -45., 8.);
+  };
+}
+
+TEST_F(TrajectoryEvaluatorTest, Association) {
+  TrajectoryEvaluatorParams params;
+  params.maxTimeDifference = 0.05;
+  params.maxReferenceGap = 0.5;
+  params.alignment = TrajectoryAlignment::NONE;
+  const TrajectoryEvaluator evaluator(params);
+
+  std::vector<TrajectorySample> reference(3);
+  reference[0].timestamp = 10.;
+  reference[0].pose = gtsam::Pose3(gtsam::Rot3::Yaw(0.), gtsam::Point3(0., 0., 0.));
+  reference[0].velocity = gtsam::Vector3(1., 0., 0.);
+  reference[0].solutionType = TypeFixed;
+  reference[1].timestamp = 10.2;
+  reference[1].pose = gtsam::Pose3(gtsam::Rot3::Yaw(0.4), gtsam::Point3(2., 4., -1.));
+  reference[1].velocity = gtsam::Vector3(3., 0., 0.);
+  reference[1].solutionType = TypeFloat;
+  reference[2].timestamp = 11.2;  // after a gap beyond maxReferenceGap
+  reference[2].pose = gtsam::Pose3(gtsam::Rot3::Yaw(0.4), gtsam::Point3(5., 4., -1.));
+  reference[2].solutionType = TypeFloat;
+
+  std::vector<TrajectorySample> estimate(8);
+  estimate[0].timestamp = 9.9;    // before the reference, too far
+  estimate[1].timestamp = 9.97;   // before the reference, close enough
+  estimate[2].timestamp = 10.;    // synchronous
+  estimate[3].timestamp = 10.05;  // interpolated, nearer to the first sample
+  estimate[4].timestamp = 10.15;  // interpolated, nearer to the second sample
+  estimate[5].timestamp = 10.23;  // in the gap, close to the second sample
+  estimate[6].timestamp = 10.7;   // in the gap, too far from both
+  estimate[7].timestamp = 11.3;   // after the reference, too far
+
+  const auto pairs = evaluator.associate(estimate, reference);
+  ASSERT_EQ(pairs.size(), 5u);
+  EXPECT_DOUBLE_EQ(pairs[0].first.timestamp, 9.97);
+  EXPECT_DOUBLE_EQ(pairs[0].second.timestamp, 10.);
+  EXPECT_DOUBLE_EQ(pairs[1].first.timestamp, 10.);
+  EXPECT_DOUBLE_EQ(pairs[1].second.timestamp, 10.);
+
+  const auto &interpolated = pairs[2].second;
+  EXPECT_DOUBLE_EQ(interpolated.timestamp, 10.05);
+  EXPECT_LT((interpolated.pose.translation() - gtsam::Point3(0.5, 1., -0.25)).norm(), 1e-9);
+  EXPECT_LT(rotationError(interpolated.pose.rotation(), gtsam::Rot3::Yaw(0.1)), 1e-9);
+  EXPECT_LT((interpolated.velocity - gtsam::Vector3(1.5, 0., 0.)).norm(), 1e-9);
+  EXPECT_EQ(interpolated.solutionType, TypeFixed);
+  EXPECT_EQ(pairs[3].second.solutionType, TypeFloat);
+  EXPECT_LT((pairs[3].second.pose.translation() - gtsam::Point3(1.5, 3., -0.75)).norm(), 1e-9);
+
+  // not interpolated over the gap but taken from the nearest sample
+  EXPECT_DOUBLE_EQ(pairs[4].first.timestamp, 10.23);
+  EXPECT_DOUBLE_EQ(pairs[4].second.timestamp, 10.2);
+
+  const auto evaluation = evaluator.evaluate(estimate, reference);
+  EXPECT_EQ(evaluation.numEstimated, estimate.size());
+  EXPECT_EQ(evaluation.numAssociated, pairs.size());
+}
+
+TEST_F(TrajectoryEvaluatorTest, SE3AlignmentWithoutNoise) {
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::SE3;
+  const TrajectoryEvaluator evaluator(params);
+  const auto estimate = createEstimate(reference_, rot_, trans_, 1., 0., rng_);
+  const auto evaluation = evaluator.evaluate(estimate, reference_);
+
+  EXPECT_EQ(evaluation.numAssociated, estimate.size());
+  EXPECT_LT(rotationError(evaluation.alignmentRotation, rot_), 1e-6);
+  EXPECT_LT((evaluation.alignmentTranslation - trans_).norm(), 1e-6);
+  EXPECT_NEAR(evaluation.alignmentScale, 1., 1e-9);
+  EXPECT_LT(evaluation.position3D.max, 1e-6);
+  EXPECT_LT(evaluation.rotation.max, 1e-6);
+  EXPECT_LT(evaluation.heading.max, 1e-6);
+  EXPECT_LT(evaluation.velocity.max, 1e-6);
+  ASSERT_FALSE(evaluation.relative.empty());
+  for (const auto &[length, stat]: evaluation.relative) {
+    EXPECT_LT(stat.translation.max, 1e-6) << length;
+    EXPECT_LT(stat.rotation.max, 1e-6) << length;
+  }
+}
+
+TEST_F(TrajectoryEvaluatorTest, SE3AlignmentWithNoise) {
+  constexpr double sigma = 0.2;
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::SE3;
+  const TrajectoryEvaluator evaluator(params);
+  const auto estimate = createEstimate(reference_, rot_, trans_, 1., sigma, rng_);
+  const auto evaluation = evaluator.evaluate(estimate, reference_);
+
+  EXPECT_LT(rotationError(evaluation.alignmentRotation, rot_), 0.2 * M_PI / 180.);
+  // the estimate is far from its origin, so the small rotation error is amplified in the translation
+  EXPECT_LT((evaluation.alignmentTranslation - trans_).norm(), 0.2);
+  EXPECT_NEAR(evaluation.alignmentScale, 1., 1e-9);
+  // isotropic noise: the 3D error is chi distributed with 3 and the 2D error with 2 degrees of freedom
+  EXPECT_NEAR(evaluation.position3D.rmse, std::sqrt(3.) * sigma, 0.1 * sigma);
+  EXPECT_NEAR(evaluation.position2D.rmse, std::sqrt(2.) * sigma, 0.1 * sigma);
+  EXPECT_NEAR(evaluation.position3D.mean, 2. * std::sqrt(2. / M_PI) * sigma, 0.1 * sigma);
+  EXPECT_NEAR(evaluation.position2D.mean, std::sqrt(M_PI / 2.) * sigma, 0.1 * sigma);
+  EXPECT_GE(evaluation.position3D.max, evaluation.position3D.rmse);
+}
+
+TEST_F(TrajectoryEvaluatorTest, Sim3AlignmentRecoversScale) {
+  constexpr double scale = 1.25;
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::SIM3;
+  const TrajectoryEvaluator evaluator(params);
+  const auto estimate = createEstimate(reference_, rot_, trans_, scale, 0., rng_);
+  const auto evaluation = evaluator.evaluate(estimate, reference_);
+
+  EXPECT_NEAR(evaluation.alignmentScale, scale, 1e-6);
+  EXPECT_LT(rotationError(evaluation.alignmentRotation, rot_), 1e-6);
+  EXPECT_LT((evaluation.alignmentTranslation - trans_).norm(), 1e-6);
+  EXPECT_LT(evaluation.position3D.max, 1e-6);
+  EXPECT_LT(evaluation.velocity.max, 1e-6);
+
+  // without the scale the same estimate leaves a residual error
+  params.alignment = TrajectoryAlignment::SE3;
+  const auto evaluationSE3 = TrajectoryEvaluator(params).evaluate(estimate, reference_);
+  EXPECT_NEAR(evaluationSE3.alignmentScale, 1., 1e-9);
+  EXPECT_GT(evaluationSE3.position3D.rmse, 1.);
+}
+
+TEST_F(TrajectoryEvaluatorTest, AbsoluteErrors) {
+  // known constant errors without alignment
+  const gtsam::Point3 positionError(0.3, 0.4, 1.2);
+  const double headingError = 2.;  // [deg]
+  const gtsam::Vector3 velocityError(0.1, -0.2, 0.2);
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::NONE;
+  const TrajectoryEvaluator evaluator(params);
+
+  auto estimate = createEstimate(reference_, gtsam::Rot3(), gtsam::Point3::Zero(), 1., 0., rng_);
+  for (auto &sample: estimate) {
+    sample.pose = gtsam::Pose3(gtsam::Rot3::Yaw(headingError * M_PI / 180.) * sample.pose.rotation(),
+                               sample.pose.translation() + positionError);
+    sample.velocity += velocityError;
+  }
+  const auto evaluation = evaluator.evaluate(estimate, reference_);
+
+  EXPECT_NEAR(evaluation.position2D.mean, 0.5, 1e-6);
+  EXPECT_NEAR(evaluation.position2D.rmse, 0.5, 1e-6);
+  EXPECT_NEAR(evaluation.position2D.median, 0.5, 1e-6);
+  EXPECT_NEAR(evaluation.position3D.rmse, 1.3, 1e-6);
+  EXPECT_NEAR(evaluation.position3D.max, 1.3, 1e-6);
+  EXPECT_NEAR(evaluation.heading.mean, headingError, 1e-3);
+  EXPECT_NEAR(evaluation.rotation.mean, headingError, 1e-3);
+  EXPECT_NEAR(evaluation.velocity.rmse, 0.3, 1e-6);
+  EXPECT_EQ(evaluation.heading.count, estimate.size());
+}
+
+TEST_F(TrajectoryEvaluatorTest, RelativeErrors) {
+  // straight line at 10 m/s, the estimate has a scale error of 1 %, which is the drift in each segment
+  constexpr double speed = 10.;
+  constexpr double scaleError = 0.01;
+  std::vector<TrajectorySample> reference, estimate;
+  for (size_t i = 0; i <= 1000; i++) {
+    TrajectorySample sample;
+    sample.timestamp = static_cast<double>(i) * 0.1;
+    sample.pose = gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(speed * sample.timestamp, 0., 0.));
+    sample.velocity = gtsam::Vector3(speed, 0., 0.);
+    reference.emplace_back(sample);
+    sample.pose = gtsam::Pose3(gtsam::Rot3(), (1. + scaleError) * sample.pose.translation());
+    estimate.emplace_back(sample);
+  }
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::NONE;
+  params.segmentLengths = {100., 200., 2000.};
+  const auto evaluation = TrajectoryEvaluator(params).evaluate(estimate, reference);
+
+  // the trajectory is shorter than the longest segment
+  ASSERT_EQ(evaluation.relative.size(), 2u);
+  for (const auto &length: {100., 200.}) {
+    const auto &stat = evaluation.relative.at(length);
+    // the segment ends at the first sample at or beyond its length, which is at most one step further
+    EXPECT_NEAR(stat.translation.mean, scaleError * length, scaleError * speed * 0.1 + 1e-6) << length;
+    EXPECT_NEAR(stat.driftPercent, scaleError * 100., scaleError * speed * 0.1 / length * 100. + 1e-6) << length;
+    EXPECT_LT(stat.rotation.max, 1e-9) << length;
+  }
+
+  // a constant offset doesn't change the relative errors
+  for (size_t i = 0; i < estimate.size(); i++)
+    estimate[i].pose = gtsam::Pose3(gtsam::Rot3(), reference[i].pose.translation() + gtsam::Point3(5., -3., 1.));
+  const auto evaluationOffset = TrajectoryEvaluator(params).evaluate(estimate, reference);
+  EXPECT_NEAR(evaluationOffset.position3D.mean, std::sqrt(35.), 1e-6);
+  for (const auto &[length, stat]: evaluationOffset.relative)
+    EXPECT_LT(stat.translation.max, 1e-6) << length;
+}
+
+TEST_F(TrajectoryEvaluatorTest, BreakdownBySolutionType) {
+  // noise of the float solution is larger by a known factor
+  constexpr double sigmaFixed = 0.02;
+  constexpr double sigmaFloat = 0.5;
+  TrajectoryEvaluatorParams params;
+  params.alignment = TrajectoryAlignment::NONE;
+  const TrajectoryEvaluator evaluator(params);
+
+  auto estimate = createEstimate(reference_, gtsam::Rot3(), gtsam::Point3::Zero(), 1., 0., rng_);
+  std::normal_distribution<double> noise(0., 1.);
+  const double lastFixed = reference_[reference_.size() / 2 + 1].timestamp;
+  size_t numFixed = 0;
+  for (auto &sample: estimate) {
+    const bool fixed = sample.timestamp < lastFixed;
+    numFixed += fixed;
+    const double sigma = fixed ? sigmaFixed : sigmaFloat;
+    sample.pose = gtsam::Pose3(sample.pose.rotation(), sample.pose.translation() +
+                                                       sigma * gtsam::Point3(noise(rng_), noise(rng_), noise(rng_)));
+  }
+  const auto evaluation = evaluator.evaluate(estimate, reference_);
+
+  ASSERT_EQ(evaluation.bySolutionType.size(), 2u);
+  const auto &fixed = evaluation.bySolutionType.at(TypeFixed);
+  const auto &floatSolution = evaluation.bySolutionType.at(TypeFloat);
+  EXPECT_EQ(fixed.position3D.count, numFixed);
+  EXPECT_EQ(floatSolution.position3D.count, estimate.size() - numFixed);
+  EXPECT_EQ(fixed.position2D.count + floatSolution.position2D.count, evaluation.position2D.count);
+  EXPECT_NEAR(fixed.position3D.rmse, std::sqrt(3.) * sigmaFixed, 0.15 * sigmaFixed);
+  EXPECT_NEAR(floatSolution.position3D.rmse, std::sqrt(3.) * sigmaFloat, 0.15 * sigmaFloat);
+  EXPECT_NEAR(fixed.position2D.rmse, std::sqrt(2.) * sigmaFixed, 0.15 * sigmaFixed);
+  EXPECT_NEAR(floatSolution.position2D.rmse, std::sqrt(2.) * sigmaFloat, 0.15 * sigmaFloat);
+  EXPECT_LT(fixed.heading.max, 1e-6);
+  EXPECT_LT(floatSolution.velocity.max, 1e-6);
+
+  // the overall rmse combines both types
+  const double expected = std::sqrt((std::pow(fixed.position3D.rmse, 2) * fixed.position3D.count +
+                                     std::pow(floatSolution.position3D.rmse, 2) * floatSolution.position3D.count) /
+                                    static_cast<double>(evaluation.position3D.count));
+  EXPECT_NEAR(evaluation.position3D.rmse, expected, 1e-9);
+}
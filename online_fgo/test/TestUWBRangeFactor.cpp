@@ -0,0 +1,216 @@
+//  Copyright 2022 Institute of Automatic Control RWTH Aachen University
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+//  Author: Haoming Zhang (h.zhang@irt.rwth-aachen.de)
+//
+//
+
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gtsam/base/numericalDerivative.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "factor/uwb/UWBRangeFactor.h"
+#include "factor/uwb/GPInterpolatedUWBRangeFactor.h"
+#include "model/gp_interpolator/GPWNOAInterpolator.h"
+
+/*
+ * The analytic Jacobians of the UWB range factors are checked against central differences on random states, and the
+ * tag trajectory and the range biases are estimated from simulated noisy ranges to known anchors.
+ */
+
+namespace {
+  using gtsam::symbol_shorthand::A;  // anchor position
+  using gtsam::symbol_shorthand::B;  // range bias of the anchor
+  using gtsam::symbol_shorthand::X;  // pose of the base
+
+  constexpr double Delta = 1e-5;
+  constexpr double Tolerance = 1e-6;  // relative
+  constexpr double GPTolerance = 1e-5;  // the interpolator differentiates its inverse right Jacobian numerically
+  constexpr size_t NumSamples = 50;
+  constexpr double RangeSigma = 0.02;  // [m]
+
+  const std::array<std::string, 8> BlockNames = {"pose1", "vel1", "omega1", "pose2", "vel2", "omega2", "anchor",
+                                                 "bias"};
+
+  void expectJacobianNear(const gtsam::Matrix &numerical, const gtsam::Matrix &analytic, const std::string &what,
+                          double tolerance = Tolerance) {
+    ASSERT_EQ(numerical.rows(), analytic.rows()) << what;
+    ASSERT_EQ(numerical.cols(), analytic.cols()) << what;
+    EXPECT_LE((numerical - analytic).norm(), tolerance * std::max(1., numerical.norm()))
+            << what << "\nnumerical:\n" << numerical << "\nanalytic:\n" << analytic;
+  }
+
+  class UWBRangeFactorTest : public ::testing::Test {
+  protected:
+    std::mt19937 rng_{42};
+    std::uniform_real_distribution<double> uniform_{-1., 1.};
+    const gtsam::Point3 leverArm_ = gtsam::Point3(0.3, -0.2, 0.5);
+    const gtsam::SharedNoiseModel rangeModel_ = gtsam::noiseModel::Isotropic::Sigma(1, RangeSigma);
+
+    template<int N>
+    Eigen::Matrix<double, N, 1> random(double scale) {
+      return Eigen::Matrix<double, N, 1>::NullaryExpr([this, scale]() { return scale * uniform_(rng_); });
+    }
+
+    gtsam::Pose3 randomPose() {
+      return gtsam::Pose3::Expmap((gtsam::Vector6() << random<3>(M_PI), random<3>(50.)).finished());
+    }
+  };
+}
+
+TEST_F(UWBRangeFactorTest, Jacobians) {
+  for (const bool useAutoDiff: {false, true}) {
+    const fgo::factor::UWBRangeFactor factor(X(0), A(0), B(0), 20., leverArm_, rangeModel_, useAutoDiff);
+    for (size_t i = 0; i < NumSamples; i++) {
+      const auto pose = randomPose();
+      const gtsam::Point3 anchor = pose.translation() + random<3>(30.);
+      const gtsam::Vector1 bias = random<1>(1.);
+
+      gtsam::Matrix H1, H2, H3;
+      const gtsam::Vector error = factor.evaluateError(pose, anchor, bias, H1, H2, H3);
+      const gtsam::Point3 tag = pose.transformFrom(leverArm_);
+      EXPECT_NEAR(error(0), (tag - anchor).norm() + bias(0) - 20., 1e-9);
+
+      const auto f = [&factor](const gtsam::Pose3 &p, const gtsam::Point3 &a,
+                               const gtsam::Vector1 &b) -> gtsam::Vector1 {
+        return factor.evaluateError(p, a, b);
+      };
+      const std::string what = useAutoDiff ? "autodiff " : "analytic ";
+      expectJacobianNear(gtsam::numericalDerivative31<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+        f, pose, anchor, bias, Delta), H1, what + "pose");
+      expectJacobianNear(gtsam::numericalDerivative32<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+        f, pose, anchor, bias, Delta), H2, what + "anchor");
+      expectJacobianNear(gtsam::numericalDerivative33<gtsam::Vector1, gtsam::Pose3, gtsam::Point3, gtsam::Vector1>(
+        f, pose, anchor, bias, Delta), H3, what + "bias");
+    }
+  }
+}
+
+TEST_F(UWBRangeFactorTest, GPInterpolatedJacobians) {
+  constexpr double dt = 0.2;
+  const auto qc = gtsam::noiseModel::Diagonal::Variances((gtsam::Vector6() << 0.05, 0.05, 0.1, 1., 1., 0.5).finished());
+  for (const double tau: {0.02, 0.1, 0.17}) {
+    const auto interpolator = std::make_shared<fgo::models::GPWNOAInterpolator>(qc, dt, tau);
+    const fgo::factor::GPInterpolatedUWBRangeFactor factor(X(0), gtsam::Symbol('v', 0), gtsam::Symbol('w', 0),
+                                                           X(1), gtsam::Symbol('v', 1), gtsam::Symbol('w', 1),
+                                                           A(0), B(0), 20., leverArm_, rangeModel_, interpolator);
+    for (size_t i = 0; i < NumSamples; i++) {
+      // two states dt apart with a plausible vehicle motion in between
+      const auto pose1 = randomPose();
+      const gtsam::Vector3 vel1 = random<3>(10.);
+      const gtsam::Vector3 omega1 = random<3>(0.5);
+      const gtsam::Vector6 twist = (gtsam::Vector6() << omega1, pose1.rotation().unrotate(vel1)).finished();
+      const auto pose2 = pose1.compose(gtsam::Pose3::Expmap(twist * dt + random<6>(0.05)));
+      const gtsam::Vector3 vel2 = vel1 + random<3>(1.);
+      const gtsam::Vector3 omega2 = omega1 + random<3>(0.1);
+      const gtsam::Point3 anchor = pose1.translation() + random<3>(30.);
+      const gtsam::Vector1 bias = random<1>(1.);
+
+      std::array<gtsam::Matrix, 8> H;
+      const gtsam::Vector error = factor.evaluateError(pose1, vel1, omega1, pose2, vel2, omega2, anchor, bias,
+                                                       H[0], H[1], H[2], H[3], H[4], H[5], H[6], H[7]);
+      const gtsam::Point3 tag = interpolator->interpolatePose(pose1, vel1, omega1, pose2, vel2, omega2)
+        .transformFrom(leverArm_);
+      EXPECT_NEAR(error(0), (tag - anchor).norm() + bias(0) - 20., 1e-9);
+
+      using gtsam::Pose3;
+      using gtsam::Point3;
+      using gtsam::Vector1;
+      using gtsam::Vector3;
+      const auto f = [&](const Pose3 &p1, const Vector3 &v1, const Vector3 &w1, const Pose3 &p2, const Vector3 &v2,
+                         const Vector3 &w2, const Point3 &a, const Vector1 &b) -> Vector1 {
+        return factor.evaluateError(p1, v1, w1, p2, v2, w2, a, b);
+      };
+      const std::array<gtsam::Matrix, 8> numerical = {
+        gtsam::numericalDerivative11<Vector1, Pose3>(
+          [&](const Pose3 &x) { return f(x, vel1, omega1, pose2, vel2, omega2, anchor, bias); }, pose1, Delta),
+        gtsam::numericalDerivative11<Vector1, Vector3>(
+          [&](const Vector3 &x) { return f(pose1, x, omega1, pose2, vel2, omega2, anchor, bias); }, vel1, Delta),
+        gtsam::numericalDerivative11<Vector1, Vector3>(
+          [&](const Vector3 &x) { return f(pose1, vel1, x, pose2, vel2, omega2, anchor, bias); }, omega1, Delta),
+        gtsam::numericalDerivative11<Vector1, Pose3>(
+          [&](const Pose3 &x) { return f(pose1, vel1, omega1, x, vel2, omega2, anchor, bias); }, pose2, Delta),
+        gtsam::numericalDerivative11<Vector1, Vector3>(
+          [&](const Vector3 &x) { return f(pose1, vel1, omega1, pose2, x, omega2, anchor, bias); }, vel2, Delta),
+        gtsam::numericalDerivative11<Vector1, Vector3>(
+          [&](const Vector3 &x) { return f(pose1, vel1, omega1, pose2, vel2, x, anchor, bias); }, omega2, Delta),
+        gtsam::numericalDerivative11<Vector1, Point3>(
+          [&](const Point3 &x) { return f(pose1, vel1, omega1, pose2, vel2, omega2, x, bias); }, anchor, Delta),
+        gtsam::numericalDerivative11<Vector1, Vector1>(
+          [&](const Vector1 &x) { return f(pose1, vel1, omega1, pose2, vel2, omega2, anchor, x); }, bias, Delta)
+      };
+      for (size_t k = 0; k < H.size(); k++)
+        expectJacobianNear(numerical[k], H[k], "tau " + std::to_string(tau) + " w.r.t. " + BlockNames[k],
+                           GPTolerance);
+    }
+  }
+}
+
+TEST_F(UWBRangeFactorTest, RecoversTagAndRangeBias) {
+  // anchors at different heights around the area of the tag, each with its own range bias
+  const std::vector<gtsam::Point3> anchors = {{-20., -20., 3.}, {20., -20., 0.5}, {20., 20., 4.},
+                                              {-20., 20., 1.}, {0., -25., 6.}, {0., 25., 2.5}};
+  const std::vector<double> biases = {0.3, -0.5, 0.8, 0.1, -0.2, 0.6};
+  constexpr size_t numPoses = 30;
+
+  std::normal_distribution<double> rangeNoise(0., RangeSigma);
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values initial;
+  std::vector<gtsam::Pose3> poses;
+
+  for (size_t a = 0; a < anchors.size(); a++) {
+    graph.emplace_shared<gtsam::PriorFactor<gtsam::Point3>>(A(a), anchors[a],
+                                                            gtsam::noiseModel::Isotropic::Sigma(3, 1e-3));
+    graph.emplace_shared<gtsam::PriorFactor<gtsam::Vector1>>(B(a), gtsam::Vector1::Zero(),
+                                                             gtsam::noiseModel::Isotropic::Sigma(1, 10.));
+    initial.insert(A(a), anchors[a]);
+    initial.insert(B(a), gtsam::Vector1::Zero());
+  }
+
+  // the attitude is known from elsewhere so that the lever arm can be resolved, the position is free
+  const auto attitudeModel = gtsam::noiseModel::Diagonal::Sigmas(
+    (gtsam::Vector6() << 1e-3, 1e-3, 1e-3, 1e3, 1e3, 1e3).finished());
+  for (size_t i = 0; i < numPoses; i++) {
+    // the tag drives on a circle
+    const double angle = 2. * M_PI * static_cast<double>(i) / numPoses;
+    const gtsam::Pose3 pose(gtsam::Rot3::Ypr(angle + M_PI_2, 0.05 * std::sin(angle), 0.),
+                            gtsam::Point3(10. * std::cos(angle), 10. * std::sin(angle), 1. + 0.5 * std::sin(angle)));
+    poses.emplace_back(pose);
+    graph.emplace_shared<gtsam::PriorFactor<gtsam::Pose3>>(X(i), pose, attitudeModel);
+    initial.insert(X(i), gtsam::Pose3(pose.rotation(), pose.translation() + random<3>(1.)));
+
+    const gtsam::Point3 tag = pose.transformFrom(leverArm_);
+    for (size_t a = 0; a < anchors.size(); a++) {
+      const double range = (tag - anchors[a]).norm() + biases[a] + rangeNoise(rng_);
+      graph.emplace_shared<fgo::factor::UWBRangeFactor>(X(i), A(a), B(a), range, leverArm_, rangeModel_);
+    }
+  }
+
+  const auto result = gtsam::LevenbergMarquardtOptimizer(graph, initial).optimize();
+  EXPECT_LT(graph.error(result), graph.error(initial));
+  for (size_t i = 0; i < numPoses; i++) {
+    const auto &estimate = result.at<gtsam::Pose3>(X(i));
+    EXPECT_LT((estimate.translation() - poses[i].translation()).norm(), 0.15) << "pose " << i;
+    EXPECT_LT(gtsam::Rot3::Logmap(estimate.rotation().between(poses[i].rotation())).norm(), 1e-2) << "pose " << i;
+  }
+  for (size_t a = 0; a < anchors.size(); a++)
+    EXPECT_NEAR(result.at<gtsam::Vector1>(B(a))(0), biases[a], 0.1) << "anchor " << a;
+}
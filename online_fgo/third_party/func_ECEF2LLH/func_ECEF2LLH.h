@@ -1,25 +0,0 @@
-//
-// File: func_ECEF2LLH.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-#ifndef FUNC_ECEF2LLH_H
-#define FUNC_ECEF2LLH_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void func_ECEF2LLH(double X, double Y, double Z, double *phi,
-                          double *lambda, double *h);
-
-#endif
-//
-// File trailer for func_ECEF2LLH.h
-//
-// [EOF]
-//
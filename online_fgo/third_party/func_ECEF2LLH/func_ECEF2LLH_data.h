@@ -1,21 +0,0 @@
-//
-// File: func_ECEF2LLH_data.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-#ifndef FUNC_ECEF2LLH_DATA_H
-#define FUNC_ECEF2LLH_DATA_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-#endif
-//
-// File trailer for func_ECEF2LLH_data.h
-//
-// [EOF]
-//
@@ -1,25 +0,0 @@
-//
-// File: func_ECEF2LLH_initialize.cpp
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-// Include Files
-#include "func_ECEF2LLH_initialize.h"
-#include "rt_nonfinite.h"
-
-// Function Definitions
-//
-// Arguments    : void
-// Return Type  : void
-//
-void func_ECEF2LLH_initialize()
-{
-}
-
-//
-// File trailer for func_ECEF2LLH_initialize.cpp
-//
-// [EOF]
-//
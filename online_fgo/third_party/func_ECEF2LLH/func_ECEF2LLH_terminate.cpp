@@ -1,25 +0,0 @@
-//
-// File: func_ECEF2LLH_terminate.cpp
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-// Include Files
-#include "func_ECEF2LLH_terminate.h"
-#include "rt_nonfinite.h"
-
-// Function Definitions
-//
-// Arguments    : void
-// Return Type  : void
-//
-void func_ECEF2LLH_terminate()
-{
-}
-
-//
-// File trailer for func_ECEF2LLH_terminate.cpp
-//
-// [EOF]
-//
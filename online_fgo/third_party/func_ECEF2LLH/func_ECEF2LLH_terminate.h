@@ -1,24 +0,0 @@
-//
-// File: func_ECEF2LLH_terminate.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-#ifndef FUNC_ECEF2LLH_TERMINATE_H
-#define FUNC_ECEF2LLH_TERMINATE_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void func_ECEF2LLH_terminate();
-
-#endif
-//
-// File trailer for func_ECEF2LLH_terminate.h
-//
-// [EOF]
-//
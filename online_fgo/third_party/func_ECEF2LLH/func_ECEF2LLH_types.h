@@ -1,19 +0,0 @@
-//
-// File: func_ECEF2LLH_types.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-#ifndef FUNC_ECEF2LLH_TYPES_H
-#define FUNC_ECEF2LLH_TYPES_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#endif
-//
-// File trailer for func_ECEF2LLH_types.h
-//
-// [EOF]
-//
@@ -1,35 +0,0 @@
-//
-// File: rt_defines.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 11:11:40
-//
-
-#ifndef RT_DEFINES_H
-#define RT_DEFINES_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-static const real_T RT_PI{3.14159265358979323846};
-static const real32_T RT_PIF{3.1415927F};
-static const real_T RT_LN_10{2.30258509299404568402};
-static const real32_T RT_LN_10F{2.3025851F};
-static const real_T RT_LOG10E{0.43429448190325182765};
-static const real32_T RT_LOG10EF{0.43429449F};
-static const real_T RT_E{2.7182818284590452354};
-static const real32_T RT_EF{2.7182817F};
-
-#ifdef __cplusplus
-}
-#endif
-#endif
-//
-// File trailer for rt_defines.h
-//
-// [EOF]
-//
@@ -1,26 +0,0 @@
-//
-// File: genJacobianECEF2ENU.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-#ifndef GENJACOBIANECEF2ENU_H
-#define GENJACOBIANECEF2ENU_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void genJacobianECEF2ENU(double x, double xref, double y, double yref,
-                                double z, double zref,
-                                creal_T b_genJacobianECEF2ENU[18]);
-
-#endif
-//
-// File trailer for genJacobianECEF2ENU.h
-//
-// [EOF]
-//
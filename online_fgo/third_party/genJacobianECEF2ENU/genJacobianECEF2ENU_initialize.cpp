@@ -1,25 +0,0 @@
-//
-// File: genJacobianECEF2ENU_initialize.cpp
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-// Include Files
-#include "genJacobianECEF2ENU_initialize.h"
-#include "rt_nonfinite.h"
-
-// Function Definitions
-//
-// Arguments    : void
-// Return Type  : void
-//
-void genJacobianECEF2ENU_initialize()
-{
-}
-
-//
-// File trailer for genJacobianECEF2ENU_initialize.cpp
-//
-// [EOF]
-//
@@ -1,24 +0,0 @@
-//
-// File: genJacobianECEF2ENU_initialize.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-#ifndef GENJACOBIANECEF2ENU_INITIALIZE_H
-#define GENJACOBIANECEF2ENU_INITIALIZE_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void genJacobianECEF2ENU_initialize();
-
-#endif
-//
-// File trailer for genJacobianECEF2ENU_initialize.h
-//
-// [EOF]
-//
@@ -1,24 +0,0 @@
-//
-// File: genJacobianECEF2ENU_terminate.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-#ifndef GENJACOBIANECEF2ENU_TERMINATE_H
-#define GENJACOBIANECEF2ENU_TERMINATE_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void genJacobianECEF2ENU_terminate();
-
-#endif
-//
-// File trailer for genJacobianECEF2ENU_terminate.h
-//
-// [EOF]
-//
@@ -1,19 +0,0 @@
-//
-// File: genJacobianECEF2ENU_types.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-#ifndef GENJACOBIANECEF2ENU_TYPES_H
-#define GENJACOBIANECEF2ENU_TYPES_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#endif
-//
-// File trailer for genJacobianECEF2ENU_types.h
-//
-// [EOF]
-//
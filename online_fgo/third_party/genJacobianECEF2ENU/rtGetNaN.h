@@ -1,29 +0,0 @@
-//
-// File: rtGetNaN.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:27:10
-//
-
-#ifndef RTGETNAN_H
-#define RTGETNAN_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-extern real_T rtGetNaN(void);
-extern real32_T rtGetNaNF(void);
-
-#ifdef __cplusplus
-}
-#endif
-#endif
-//
-// File trailer for rtGetNaN.h
-//
-// [EOF]
-//
@@ -1,26 +0,0 @@
-//
-// File: genJacobianECEF2NED.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:19:56
-//
-
-#ifndef GENJACOBIANECEF2NED_H
-#define GENJACOBIANECEF2NED_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void genJacobianECEF2NED(double x, double xref, double y, double yref,
-                                double z, double zref,
-                                creal_T b_genJacobianECEF2NED[18]);
-
-#endif
-//
-// File trailer for genJacobianECEF2NED.h
-//
-// [EOF]
-//
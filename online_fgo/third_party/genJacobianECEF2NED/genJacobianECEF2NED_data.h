@@ -1,21 +0,0 @@
-//
-// File: genJacobianECEF2NED_data.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:19:56
-//
-
-#ifndef GENJACOBIANECEF2NED_DATA_H
-#define GENJACOBIANECEF2NED_DATA_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-#endif
-//
-// File trailer for genJacobianECEF2NED_data.h
-//
-// [EOF]
-//
@@ -1,24 +0,0 @@
-//
-// File: genJacobianECEF2NED_initialize.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:19:56
-//
-
-#ifndef GENJACOBIANECEF2NED_INITIALIZE_H
-#define GENJACOBIANECEF2NED_INITIALIZE_H
-
-// Include Files
-#include "rtwtypes.h"
-#include <cstddef>
-#include <cstdlib>
-
-// Function Declarations
-extern void genJacobianECEF2NED_initialize();
-
-#endif
-//
-// File trailer for genJacobianECEF2NED_initialize.h
-//
-// [EOF]
-//
@@ -1,19 +0,0 @@
-//
-// File: genJacobianECEF2NED_types.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:19:56
-//
-
-#ifndef GENJACOBIANECEF2NED_TYPES_H
-#define GENJACOBIANECEF2NED_TYPES_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#endif
-//
-// File trailer for genJacobianECEF2NED_types.h
-//
-// [EOF]
-//
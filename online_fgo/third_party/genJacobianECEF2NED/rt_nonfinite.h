@@ -1,33 +0,0 @@
-//
-// File: rt_nonfinite.h
-//
-// MATLAB Coder version            : 5.6
-// C/C++ source code generated on  : 07-Jan-2024 18:19:56
-//
-
-#ifndef RT_NONFINITE_H
-#define RT_NONFINITE_H
-
-// Include Files
-#include "rtwtypes.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-extern real_T rtInf;
-extern real_T rtMinusInf;
-extern real_T rtNaN;
-extern real32_T rtInfF;
-extern real32_T rtMinusInfF;
-extern real32_T rtNaNF;
-
-#ifdef __cplusplus
-}
-#endif
-#endif
-//
-// File trailer for rt_nonfinite.h
-//
-// [EOF]
-//